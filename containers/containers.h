@@ -717,6 +717,14 @@ typedef enum
     *   arg2= VC_CONTAINER_FOURCC_T: codec variant to output */
    VC_CONTAINER_CONTROL_TRACK_PACKETIZE,
 
+   /** Have a writer output a fragmented file, so that data written so far
+    * stays playable and the file can be streamed while it is recorded.
+    * A new fragment is started at each keyframe of the first video track.
+    * Must be used before the track list is completed.\n
+    * Arguments:\n
+    *   arg1= uint32_t: maximum number of frames per fragment, 0 for no limit */
+   VC_CONTAINER_CONTROL_SET_FRAGMENTATION,
+
    /** Private user extensions must be above this number */
    VC_CONTAINER_CONTROL_USER_EXTENSIONS = 0x1000
 
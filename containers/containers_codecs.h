@@ -150,6 +150,11 @@ extern "C" {
 #define VC_CONTAINER_CODEC_USF         VC_FOURCC('u','s','f',' ')
 #define VC_CONTAINER_CODEC_VOBSUB      VC_FOURCC('v','s','u','b')
 
+/* Timed metadata */
+/** Text samples timed with the other tracks, e.g. per frame tracking results.
+ * The extradata holds the mime type of the samples as a nul terminated string. */
+#define VC_CONTAINER_CODEC_METADATA    VC_FOURCC('m','e','t','t')
+
 #define VC_CONTAINER_CODEC_UNKNOWN     VC_FOURCC('u','n','k','n')
 
 /* Codec variants */
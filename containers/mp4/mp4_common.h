@@ -45,6 +45,7 @@ typedef enum {
    MP4_BOX_TYPE_MINF              = VC_FOURCC('m','i','n','f'),
    MP4_BOX_TYPE_VMHD              = VC_FOURCC('v','m','h','d'),
    MP4_BOX_TYPE_SMHD              = VC_FOURCC('s','m','h','d'),
+   MP4_BOX_TYPE_NMHD              = VC_FOURCC('n','m','h','d'),
    MP4_BOX_TYPE_DINF              = VC_FOURCC('d','i','n','f'),
    MP4_BOX_TYPE_DREF              = VC_FOURCC('d','r','e','f'),
    MP4_BOX_TYPE_STBL              = VC_FOURCC('s','t','b','l'),
@@ -56,9 +57,18 @@ typedef enum {
    MP4_BOX_TYPE_STCO              = VC_FOURCC('s','t','c','o'),
    MP4_BOX_TYPE_CO64              = VC_FOURCC('c','o','6','4'),
    MP4_BOX_TYPE_STSS              = VC_FOURCC('s','t','s','s'),
+   MP4_BOX_TYPE_MVEX              = VC_FOURCC('m','v','e','x'),
+   MP4_BOX_TYPE_TREX              = VC_FOURCC('t','r','e','x'),
+   MP4_BOX_TYPE_MOOF              = VC_FOURCC('m','o','o','f'),
+   MP4_BOX_TYPE_MFHD              = VC_FOURCC('m','f','h','d'),
+   MP4_BOX_TYPE_TRAF              = VC_FOURCC('t','r','a','f'),
+   MP4_BOX_TYPE_TFHD              = VC_FOURCC('t','f','h','d'),
+   MP4_BOX_TYPE_TFDT              = VC_FOURCC('t','f','d','t'),
+   MP4_BOX_TYPE_TRUN              = VC_FOURCC('t','r','u','n'),
    MP4_BOX_TYPE_VIDE              = VC_FOURCC('v','i','d','e'),
    MP4_BOX_TYPE_SOUN              = VC_FOURCC('s','o','u','n'),
    MP4_BOX_TYPE_TEXT              = VC_FOURCC('t','e','x','t'),
+   MP4_BOX_TYPE_METT              = VC_FOURCC('m','e','t','t'),
    MP4_BOX_TYPE_FREE              = VC_FOURCC('f','r','e','e'),
    MP4_BOX_TYPE_SKIP              = VC_FOURCC('s','k','i','p'),
    MP4_BOX_TYPE_WIDE              = VC_FOURCC('w','i','d','e'),
@@ -78,6 +88,7 @@ typedef enum {
 
 typedef enum {
    MP4_BRAND_ISOM                 = VC_FOURCC('i','s','o','m'),
+   MP4_BRAND_ISO5                 = VC_FOURCC('i','s','o','5'),
    MP4_BRAND_MP42                 = VC_FOURCC('m','p','4','2'),
    MP4_BRAND_3GP4                 = VC_FOURCC('3','g','p','4'),
    MP4_BRAND_3GP5                 = VC_FOURCC('3','g','p','5'),
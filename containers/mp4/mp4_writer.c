@@ -47,6 +47,9 @@ Defines.
 
 #define MP4_64BITS_TIME 0 /* 0 to disable / 1 to enable */
 
+#define MP4_FRAGMENT_MAX_SIZE    (8*1024*1024) /* Data kept in memory before a fragment is forced */
+#define MP4_FRAGMENT_MAX_SAMPLES 4096
+
 /******************************************************************************
 Type definitions.
 ******************************************************************************/
@@ -69,8 +72,25 @@ typedef struct VC_CONTAINER_TRACK_MODULE_T
    int64_t first_pts;
    int64_t last_pts;
 
+   /* Layout of the track in the current fragment */
+   uint32_t fragment_samples;
+   int64_t fragment_dts;
+   int64_t fragment_offset;
+   int fragment_last;
+
 } VC_CONTAINER_TRACK_MODULE_T;
 
+typedef struct MP4_FRAGMENT_SAMPLE_T
+{
+   uint32_t offset;   /* Position of the data in the fragment buffer */
+   uint32_t size;
+   int64_t dts;
+   uint32_t duration; /* In MP4_TIMESCALE units, known once the fragment is complete */
+   uint8_t track;
+   bool keyframe;
+
+} MP4_FRAGMENT_SAMPLE_T;
+
 typedef struct VC_CONTAINER_MODULE_T
 {
    int box_level;
@@ -94,6 +114,22 @@ typedef struct VC_CONTAINER_MODULE_T
    int64_t prev_sample_dts;
 
    int64_t duration;
+
+   /* Fragmented output. Samples are buffered until the fragment is complete
+    * and then written as a moof box followed by an mdat box. */
+   bool fragmented;
+   uint32_t fragment_frames;
+   unsigned int fragment_track;
+   uint32_t fragment_track_samples;
+   uint32_t fragment_sequence;
+   uint32_t moof_size;
+
+   uint8_t *fragment_data;
+   uint32_t fragment_data_size;
+   uint32_t fragment_data_max;
+   MP4_FRAGMENT_SAMPLE_T *fragment_sample;
+   unsigned int fragment_samples;
+   unsigned int fragment_samples_max;
    /**/
 
 } VC_CONTAINER_MODULE_T;
@@ -114,6 +150,7 @@ static VC_CONTAINER_STATUS_T mp4_write_box_hdlr( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_minf( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_vmhd( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_smhd( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_nmhd( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_dinf( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_dref( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_stbl( VC_CONTAINER_T *p_ctx );
@@ -125,9 +162,19 @@ static VC_CONTAINER_STATUS_T mp4_write_box_stsz( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_stco( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_co64( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_stss( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_mvex( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_trex( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_moof( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_mfhd( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_traf( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_tfhd( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_tfdt( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_trun( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_vide( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_soun( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_write_box_mett( VC_CONTAINER_T *p_ctx );
 static VC_CONTAINER_STATUS_T mp4_write_box_esds( VC_CONTAINER_T *p_ctx );
+static VC_CONTAINER_STATUS_T mp4_writer_add_track_done( VC_CONTAINER_T *p_ctx );
 
 static struct {
   const MP4_BOX_TYPE_T type;
@@ -145,6 +192,7 @@ static struct {
    {MP4_BOX_TYPE_MINF, mp4_write_box_minf},
    {MP4_BOX_TYPE_VMHD, mp4_write_box_vmhd},
    {MP4_BOX_TYPE_SMHD, mp4_write_box_smhd},
+   {MP4_BOX_TYPE_NMHD, mp4_write_box_nmhd},
    {MP4_BOX_TYPE_DINF, mp4_write_box_dinf},
    {MP4_BOX_TYPE_DREF, mp4_write_box_dref},
    {MP4_BOX_TYPE_STBL, mp4_write_box_stbl},
@@ -156,8 +204,17 @@ static struct {
    {MP4_BOX_TYPE_STCO, mp4_write_box_stco},
    {MP4_BOX_TYPE_CO64, mp4_write_box_co64},
    {MP4_BOX_TYPE_STSS, mp4_write_box_stss},
+   {MP4_BOX_TYPE_MVEX, mp4_write_box_mvex},
+   {MP4_BOX_TYPE_TREX, mp4_write_box_trex},
+   {MP4_BOX_TYPE_MOOF, mp4_write_box_moof},
+   {MP4_BOX_TYPE_MFHD, mp4_write_box_mfhd},
+   {MP4_BOX_TYPE_TRAF, mp4_write_box_traf},
+   {MP4_BOX_TYPE_TFHD, mp4_write_box_tfhd},
+   {MP4_BOX_TYPE_TFDT, mp4_write_box_tfdt},
+   {MP4_BOX_TYPE_TRUN, mp4_write_box_trun},
    {MP4_BOX_TYPE_VIDE, mp4_write_box_vide},
    {MP4_BOX_TYPE_SOUN, mp4_write_box_soun},
+   {MP4_BOX_TYPE_METT, mp4_write_box_mett},
    {MP4_BOX_TYPE_ESDS, mp4_write_box_esds},
    {MP4_BOX_TYPE_UNKNOWN, 0}
 };
@@ -229,6 +286,8 @@ static VC_CONTAINER_STATUS_T mp4_write_box_ftyp( VC_CONTAINER_T *p_ctx )
    if(module->brand == MP4_BRAND_SKM2)
       WRITE_FOURCC(p_ctx, MP4_BRAND_SKM2, "compatible_brands");
    WRITE_FOURCC(p_ctx, MP4_BRAND_ISOM, "compatible_brands");
+   if(module->fragmented)
+      WRITE_FOURCC(p_ctx, MP4_BRAND_ISO5, "compatible_brands");
    WRITE_FOURCC(p_ctx, MP4_BRAND_MP42, "compatible_brands");
    WRITE_FOURCC(p_ctx, MP4_BRAND_3GP4, "compatible_brands");
 
@@ -252,6 +311,9 @@ static VC_CONTAINER_STATUS_T mp4_write_box_moov( VC_CONTAINER_T *p_ctx )
       if(status != VC_CONTAINER_SUCCESS) return status;
    }
 
+   if(module->fragmented)
+      status = mp4_write_box(p_ctx, MP4_BOX_TYPE_MVEX);
+
    return status;
 }
 
@@ -434,6 +496,7 @@ static VC_CONTAINER_STATUS_T mp4_write_box_hdlr( VC_CONTAINER_T *p_ctx )
    if(track->format->es_type == VC_CONTAINER_ES_TYPE_VIDEO) fourcc = VC_FOURCC('v','i','d','e');
    if(track->format->es_type == VC_CONTAINER_ES_TYPE_AUDIO) fourcc = VC_FOURCC('s','o','u','n');
    if(track->format->es_type == VC_CONTAINER_ES_TYPE_SUBPICTURE) fourcc = VC_FOURCC('t','e','x','t');
+   if(track->priv->module->fourcc == MP4_BOX_TYPE_METT) fourcc = VC_FOURCC('m','e','t','a');
 
    WRITE_U8(p_ctx,  0, "version");
    WRITE_U24(p_ctx, 0, "flags");
@@ -451,6 +514,8 @@ static VC_CONTAINER_STATUS_T mp4_write_box_hdlr( VC_CONTAINER_T *p_ctx )
    { handler_name = "Video Media Handler"; handler_size = sizeof("Video Media Handler"); }
    else if(track->format->es_type == VC_CONTAINER_ES_TYPE_AUDIO)
    { handler_name = "Audio Media Handler"; handler_size = sizeof("Audio Media Handler"); }
+   else if(track->priv->module->fourcc == MP4_BOX_TYPE_METT)
+   { handler_name = "Metadata Media Handler"; handler_size = sizeof("Metadata Media Handler"); }
    else if(track->format->es_type == VC_CONTAINER_ES_TYPE_SUBPICTURE)
    { handler_name = "Text Media Handler"; handler_size = sizeof("Text Media Handler"); }
    else { handler_name = ""; handler_size = sizeof(""); }
@@ -474,6 +539,8 @@ static VC_CONTAINER_STATUS_T mp4_write_box_minf( VC_CONTAINER_T *p_ctx )
       status = mp4_write_box(p_ctx, MP4_BOX_TYPE_VMHD);
    else if(track->format->es_type == VC_CONTAINER_ES_TYPE_AUDIO)
       status = mp4_write_box(p_ctx, MP4_BOX_TYPE_SMHD);
+   else if(track->priv->module->fourcc == MP4_BOX_TYPE_METT)
+      status = mp4_write_box(p_ctx, MP4_BOX_TYPE_NMHD);
 #if 0
    else if(track->format->es_type == VC_CONTAINER_ES_TYPE_SUBPICTURE)
       /*FIXME */;
@@ -514,6 +581,15 @@ static VC_CONTAINER_STATUS_T mp4_write_box_smhd( VC_CONTAINER_T *p_ctx )
    return STREAM_STATUS(p_ctx);
 }
 
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_nmhd( VC_CONTAINER_T *p_ctx )
+{
+   WRITE_U8(p_ctx,  0, "version");
+   WRITE_U24(p_ctx, 0, "flags");
+
+   return STREAM_STATUS(p_ctx);
+}
+
 /*****************************************************************************/
 static VC_CONTAINER_STATUS_T mp4_write_box_dinf( VC_CONTAINER_T *p_ctx )
 {
@@ -572,7 +648,8 @@ static VC_CONTAINER_STATUS_T mp4_write_box_stbl( VC_CONTAINER_T *p_ctx )
    else
       status = mp4_write_box(p_ctx, MP4_BOX_TYPE_CO64);
 
-   if(track->format->es_type == VC_CONTAINER_ES_TYPE_VIDEO)
+   /* Sync samples of a fragmented file are flagged in the fragments */
+   if(track->format->es_type == VC_CONTAINER_ES_TYPE_VIDEO && !module->fragmented)
    {
       status = mp4_write_box(p_ctx, MP4_BOX_TYPE_STSS);
       if(status != VC_CONTAINER_SUCCESS) return status;
@@ -597,6 +674,8 @@ static VC_CONTAINER_STATUS_T mp4_write_box_stsd( VC_CONTAINER_T *p_ctx )
       status = mp4_write_box_extended(p_ctx, MP4_BOX_TYPE_VIDE, track->priv->module->fourcc);
    else if(track->format->es_type == VC_CONTAINER_ES_TYPE_AUDIO)
       status = mp4_write_box_extended(p_ctx, MP4_BOX_TYPE_SOUN, track->priv->module->fourcc);
+   else if(track->priv->module->fourcc == MP4_BOX_TYPE_METT)
+      status = mp4_write_box(p_ctx, MP4_BOX_TYPE_METT);
 #if 0
    else if(track->format->es_type == VC_CONTAINER_ES_TYPE_SUBPICTURE)
       /*FIXME*/;
@@ -644,7 +723,7 @@ static VC_CONTAINER_STATUS_T mp4_write_box_stts( VC_CONTAINER_T *p_ctx )
    VC_CONTAINER_STATUS_T status = VC_CONTAINER_SUCCESS;
    VC_CONTAINER_PACKET_T sample;
    unsigned int entries = 0;
-   int64_t last_dts = 0, delta;
+   int64_t last_dts = -1, delta = 0, dts;
 
    WRITE_U8(p_ctx,  0, "version");
    WRITE_U24(p_ctx, 0, "flags");
@@ -662,21 +741,36 @@ static VC_CONTAINER_STATUS_T mp4_write_box_stts( VC_CONTAINER_T *p_ctx )
    vc_container_io_seek(module->temp.io, INT64_C(0));
    sample.dts = 0;
 
+   /* The delta of a sample is the time until the next sample, so each entry
+    * is written once the next sample is known. Times are rounded from the
+    * absolute dts so rounding errors do not add up. */
    status = mp4_writer_read_sample_from_temp(p_ctx, &sample);
    while(status == VC_CONTAINER_SUCCESS)
    {
       if(sample.track != module->current_track) goto skip;
 
-      delta = sample.dts * MP4_TIMESCALE / 1000000 - last_dts;
-      if(delta < 0) delta = 0;
-      WRITE_U32(p_ctx, 1, "sample_count");
-      WRITE_U32(p_ctx, delta, "sample_delta");
-      entries++;
-      last_dts += delta;
+      dts = sample.dts * MP4_TIMESCALE / 1000000;
+      if(last_dts >= 0)
+      {
+         delta = dts - last_dts;
+         if(delta < 0) delta = 0;
+         WRITE_U32(p_ctx, 1, "sample_count");
+         WRITE_U32(p_ctx, delta, "sample_delta");
+         entries++;
+      }
+      if(dts > last_dts) last_dts = dts;
 
      skip:
       status = mp4_writer_read_sample_from_temp(p_ctx, &sample);
    }
+
+   /* The last sample lasts as long as the one before it */
+   if(last_dts >= 0)
+   {
+      WRITE_U32(p_ctx, 1, "sample_count");
+      WRITE_U32(p_ctx, delta, "sample_delta");
+      entries++;
+   }
    vc_container_assert(entries == track_module->sample_table[MP4_SAMPLE_TABLE_STTS].entries);
 
    return STREAM_STATUS(p_ctx);
@@ -916,6 +1010,159 @@ static VC_CONTAINER_STATUS_T mp4_write_box_stss( VC_CONTAINER_T *p_ctx )
    return STREAM_STATUS(p_ctx);
 }
 
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_mvex( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_STATUS_T status = VC_CONTAINER_SUCCESS;
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+   unsigned int i;
+
+   for(i = 0; i < p_ctx->tracks_num; i++)
+   {
+      module->current_track = i;
+      status = mp4_write_box(p_ctx, MP4_BOX_TYPE_TREX);
+      if(status != VC_CONTAINER_SUCCESS) return status;
+   }
+
+   return status;
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_trex( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+
+   WRITE_U8(p_ctx,  0, "version");
+   WRITE_U24(p_ctx, 0, "flags");
+
+   WRITE_U32(p_ctx, module->current_track + 1, "track_ID");
+   WRITE_U32(p_ctx, 1, "default_sample_description_index");
+   WRITE_U32(p_ctx, 0, "default_sample_duration");
+   WRITE_U32(p_ctx, 0, "default_sample_size");
+   WRITE_U32(p_ctx, 0, "default_sample_flags");
+
+   return STREAM_STATUS(p_ctx);
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_moof( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_STATUS_T status = VC_CONTAINER_SUCCESS;
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+   unsigned int i;
+
+   status = mp4_write_box(p_ctx, MP4_BOX_TYPE_MFHD);
+   if(status != VC_CONTAINER_SUCCESS) return status;
+
+   for(i = 0; i < p_ctx->tracks_num; i++)
+   {
+      if(!p_ctx->tracks[i]->priv->module->fragment_samples) continue;
+
+      module->current_track = i;
+      status = mp4_write_box(p_ctx, MP4_BOX_TYPE_TRAF);
+      if(status != VC_CONTAINER_SUCCESS) return status;
+   }
+
+   return status;
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_mfhd( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+
+   WRITE_U8(p_ctx,  0, "version");
+   WRITE_U24(p_ctx, 0, "flags");
+   WRITE_U32(p_ctx, module->fragment_sequence, "sequence_number");
+
+   return STREAM_STATUS(p_ctx);
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_traf( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_STATUS_T status;
+
+   status = mp4_write_box(p_ctx, MP4_BOX_TYPE_TFHD);
+   if(status != VC_CONTAINER_SUCCESS) return status;
+
+   status = mp4_write_box(p_ctx, MP4_BOX_TYPE_TFDT);
+   if(status != VC_CONTAINER_SUCCESS) return status;
+
+   status = mp4_write_box(p_ctx, MP4_BOX_TYPE_TRUN);
+   if(status != VC_CONTAINER_SUCCESS) return status;
+
+   return status;
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_tfhd( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+
+   WRITE_U8(p_ctx,  0, "version");
+   WRITE_U24(p_ctx, 0x20000, "flags"); /* default-base-is-moof */
+   WRITE_U32(p_ctx, module->current_track + 1, "track_ID");
+
+   return STREAM_STATUS(p_ctx);
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_tfdt( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+   VC_CONTAINER_TRACK_MODULE_T *track_module = p_ctx->tracks[module->current_track]->priv->module;
+
+   WRITE_U8(p_ctx,  1, "version");
+   WRITE_U24(p_ctx, 0, "flags");
+   WRITE_U64(p_ctx, (track_module->fragment_dts - track_module->first_pts) * MP4_TIMESCALE / 1000000,
+             "base_media_decode_time");
+
+   return STREAM_STATUS(p_ctx);
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_trun( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+   VC_CONTAINER_TRACK_T *track = p_ctx->tracks[module->current_track];
+   VC_CONTAINER_TRACK_MODULE_T *track_module = track->priv->module;
+   unsigned int i, entries = 0;
+
+   WRITE_U8(p_ctx,  0, "version");
+   WRITE_U24(p_ctx, 0x701, "flags"); /* data offset, sample duration, size and flags */
+   WRITE_U32(p_ctx, track_module->fragment_samples, "sample_count");
+
+   /* The data of each track is contiguous in the mdat following the moof */
+   WRITE_U32(p_ctx, module->moof_size + 8 + track_module->fragment_offset, "data_offset");
+
+   if(module->null.refcount)
+   {
+      /* We're not actually writing the data, we just want the size */
+      WRITE_BYTES(p_ctx, 0, track_module->fragment_samples * 12);
+      return STREAM_STATUS(p_ctx);
+   }
+
+   for(i = 0; i < module->fragment_samples; i++)
+   {
+      MP4_FRAGMENT_SAMPLE_T *sample = &module->fragment_sample[i];
+      uint32_t flags = 0x2000000; /* does not depend on other samples */
+
+      if(sample->track != module->current_track) continue;
+
+      if(track->format->es_type == VC_CONTAINER_ES_TYPE_VIDEO && !sample->keyframe)
+         flags = 0x1010000; /* depends on other samples, not a sync sample */
+
+      WRITE_U32(p_ctx, sample->duration, "sample_duration");
+      WRITE_U32(p_ctx, sample->size, "sample_size");
+      WRITE_U32(p_ctx, flags, "sample_flags");
+      entries++;
+   }
+   vc_container_assert(entries == track_module->fragment_samples);
+
+   return STREAM_STATUS(p_ctx);
+}
+
 /*****************************************************************************/
 static VC_CONTAINER_STATUS_T mp4_write_box_vide_avcC( VC_CONTAINER_T *p_ctx )
 {
@@ -1067,6 +1314,27 @@ static VC_CONTAINER_STATUS_T mp4_write_box_soun( VC_CONTAINER_T *p_ctx )
    return STREAM_STATUS(p_ctx);
 }
 
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_write_box_mett( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+   VC_CONTAINER_TRACK_T *track = p_ctx->tracks[module->current_track];
+   const char *mime_format = "text/plain";
+   unsigned int i;
+
+   /* The mime type of the samples is passed as a string in the extradata */
+   if(track->format->extradata_size && !track->format->extradata[track->format->extradata_size - 1])
+      mime_format = (const char *)track->format->extradata;
+
+   for(i = 0; i < 6; i++) WRITE_U8(p_ctx, 0, "reserved");
+   WRITE_U16(p_ctx, 1, "data_reference_index");
+
+   WRITE_STRING(p_ctx, "", 1, "content_encoding");
+   WRITE_STRING(p_ctx, mime_format, strlen(mime_format) + 1, "mime_format");
+
+   return STREAM_STATUS(p_ctx);
+}
+
 /*****************************************************************************/
 static VC_CONTAINER_STATUS_T mp4_write_box_esds( VC_CONTAINER_T *p_ctx )
 {
@@ -1139,26 +1407,227 @@ static VC_CONTAINER_STATUS_T mp4_write_box_esds( VC_CONTAINER_T *p_ctx )
 }
 
 /*****************************************************************************/
-static VC_CONTAINER_STATUS_T mp4_writer_close( VC_CONTAINER_T *p_ctx )
+static uint32_t mp4_writer_fragment_duration( VC_CONTAINER_TRACK_MODULE_T *track_module,
+   int64_t dts, int64_t next_dts )
+{
+   /* Times are rounded from the start of the track so rounding errors do not add up */
+   int64_t duration = (next_dts - track_module->first_pts) * MP4_TIMESCALE / 1000000 -
+      (dts - track_module->first_pts) * MP4_TIMESCALE / 1000000;
+
+   if(duration < 0) duration = 0;
+   track_module->delta_timestamp = duration;
+   return (uint32_t)duration;
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_writer_write_fragment( VC_CONTAINER_T *p_ctx, int64_t end_dts )
+{
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+   VC_CONTAINER_STATUS_T status = VC_CONTAINER_SUCCESS;
+   int64_t offset = 0;
+   unsigned int i, j;
+
+   if(!module->fragment_samples) return VC_CONTAINER_SUCCESS;
+
+   for(i = 0; i < p_ctx->tracks_num; i++)
+   {
+      VC_CONTAINER_TRACK_MODULE_T *track_module = p_ctx->tracks[i]->priv->module;
+      track_module->fragment_samples = 0;
+      track_module->fragment_last = -1;
+   }
+
+   /* The duration of a sample is the time until the next sample of the same track */
+   for(i = 0; i < module->fragment_samples; i++)
+   {
+      MP4_FRAGMENT_SAMPLE_T *sample = &module->fragment_sample[i];
+      VC_CONTAINER_TRACK_MODULE_T *track_module = p_ctx->tracks[sample->track]->priv->module;
+
+      if(track_module->fragment_last >= 0)
+      {
+         MP4_FRAGMENT_SAMPLE_T *prev = &module->fragment_sample[track_module->fragment_last];
+         prev->duration = mp4_writer_fragment_duration(track_module, prev->dts, sample->dts);
+      }
+      else
+         track_module->fragment_dts = sample->dts;
+
+      track_module->fragment_last = i;
+      track_module->fragment_samples++;
+   }
+
+   /* The last samples last until the start of the next fragment. When that isn't
+    * known, they last as long as the sample before them. */
+   for(i = 0; i < p_ctx->tracks_num; i++)
+   {
+      VC_CONTAINER_TRACK_MODULE_T *track_module = p_ctx->tracks[i]->priv->module;
+      MP4_FRAGMENT_SAMPLE_T *last;
+
+      track_module->fragment_offset = offset;
+      if(!track_module->fragment_samples) continue;
+
+      last = &module->fragment_sample[track_module->fragment_last];
+      if(end_dts != VC_CONTAINER_TIME_UNKNOWN && end_dts > last->dts)
+         last->duration = mp4_writer_fragment_duration(track_module, last->dts, end_dts);
+      else
+         last->duration = (uint32_t)track_module->delta_timestamp;
+
+      for(j = 0; j < module->fragment_samples; j++)
+         if(module->fragment_sample[j].track == i)
+            offset += module->fragment_sample[j].size;
+   }
+
+   module->fragment_sequence++;
+
+   /* We need to find out the size of the moof to know where the data starts */
+   if(!vc_container_writer_extraio_enable(p_ctx, &module->null))
+   {
+      status = mp4_write_box(p_ctx, MP4_BOX_TYPE_MOOF);
+      module->moof_size = STREAM_POSITION(p_ctx);
+   }
+   vc_container_writer_extraio_disable(p_ctx, &module->null);
+   if(status != VC_CONTAINER_SUCCESS) return status;
+
+   status = mp4_write_box(p_ctx, MP4_BOX_TYPE_MOOF);
+   if(status != VC_CONTAINER_SUCCESS) return status;
+
+   WRITE_U32(p_ctx, (uint32_t)(offset + 8), "size");
+   WRITE_FOURCC(p_ctx, VC_FOURCC('m','d','a','t'), "type");
+   for(i = 0; i < p_ctx->tracks_num; i++)
+   {
+      for(j = 0; j < module->fragment_samples; j++)
+      {
+         MP4_FRAGMENT_SAMPLE_T *sample = &module->fragment_sample[j];
+         if(sample->track != i) continue;
+         WRITE_BYTES(p_ctx, module->fragment_data + sample->offset, sample->size);
+      }
+   }
+   status = STREAM_STATUS(p_ctx);
+
+   /* Make sure the complete fragment gets to the storage */
+   vc_container_io_control(p_ctx->priv->io, VC_CONTAINER_CONTROL_IO_FLUSH);
+
+   module->fragment_samples = 0;
+   module->fragment_data_size = 0;
+   module->fragment_track_samples = 0;
+   return status;
+}
+
+/*****************************************************************************/
+static bool mp4_writer_fragment_due( VC_CONTAINER_T *p_ctx, VC_CONTAINER_PACKET_T *packet )
+{
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+
+   if(!module->fragment_samples) return false;
+
+   /* Keep the memory used for buffering bounded */
+   if(module->fragment_data_size + packet->size > MP4_FRAGMENT_MAX_SIZE ||
+      module->fragment_samples >= MP4_FRAGMENT_MAX_SAMPLES)
+      return true;
+
+   if(packet->track != module->fragment_track || !module->fragment_track_samples)
+      return false;
+
+   return (packet->flags & VC_CONTAINER_PACKET_FLAG_KEYFRAME) ||
+      (module->fragment_frames && module->fragment_track_samples >= module->fragment_frames);
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_writer_write_fragmented( VC_CONTAINER_T *p_ctx,
+                                                          VC_CONTAINER_PACKET_T *packet )
 {
    VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+   VC_CONTAINER_TRACK_MODULE_T *track_module = p_ctx->tracks[packet->track]->priv->module;
+   MP4_FRAGMENT_SAMPLE_T *sample;
    VC_CONTAINER_STATUS_T status;
+
+   if(packet->flags & VC_CONTAINER_PACKET_FLAG_FRAME_START)
+   {
+      if(mp4_writer_fragment_due(p_ctx, packet))
+      {
+         status = mp4_writer_write_fragment(p_ctx, packet->pts);
+         if(status != VC_CONTAINER_SUCCESS) return status;
+      }
+
+      if(module->fragment_samples >= module->fragment_samples_max)
+      {
+         unsigned int max = module->fragment_samples_max ? module->fragment_samples_max * 2 : 64;
+         sample = realloc(module->fragment_sample, max * sizeof(*sample));
+         if(!sample) return VC_CONTAINER_ERROR_OUT_OF_MEMORY;
+         module->fragment_sample = sample;
+         module->fragment_samples_max = max;
+      }
+
+      sample = &module->fragment_sample[module->fragment_samples++];
+      sample->offset = module->fragment_data_size;
+      sample->size = 0;
+      sample->dts = packet->pts;
+      sample->duration = 0;
+      sample->track = packet->track;
+      sample->keyframe = false;
+
+      if(!track_module->samples) track_module->first_pts = packet->pts;
+      track_module->last_pts = packet->pts;
+      track_module->samples++;
+      if(packet->track == module->fragment_track) module->fragment_track_samples++;
+   }
+   else if(!module->fragment_samples)
+      return VC_CONTAINER_ERROR_INVALID_ARGUMENT; /* Not part of a frame */
+
+   if(module->fragment_data_size + packet->size > module->fragment_data_max)
+   {
+      uint32_t max = module->fragment_data_max ? module->fragment_data_max : 65536;
+      uint8_t *data;
+
+      while(max < module->fragment_data_size + packet->size) max *= 2;
+      data = realloc(module->fragment_data, max);
+      if(!data) return VC_CONTAINER_ERROR_OUT_OF_MEMORY;
+      module->fragment_data = data;
+      module->fragment_data_max = max;
+   }
+
+   sample = &module->fragment_sample[module->fragment_samples - 1];
+   memcpy(module->fragment_data + module->fragment_data_size, packet->data, packet->size);
+   module->fragment_data_size += packet->size;
+   sample->size += packet->size;
+   if(packet->flags & VC_CONTAINER_PACKET_FLAG_KEYFRAME) sample->keyframe = true;
+   p_ctx->size += packet->size;
+
+   return VC_CONTAINER_SUCCESS;
+}
+
+/*****************************************************************************/
+static VC_CONTAINER_STATUS_T mp4_writer_close( VC_CONTAINER_T *p_ctx )
+{
+   VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
+   VC_CONTAINER_STATUS_T status = VC_CONTAINER_SUCCESS;
    int64_t mdat_size;
 
-   mdat_size = STREAM_POSITION(p_ctx) - module->mdat_offset;
+   if(!module->tracks_add_done)
+      status = mp4_writer_add_track_done(p_ctx);
 
-   /* Write the moov box */
-   status = mp4_write_box(p_ctx, MP4_BOX_TYPE_MOOV);
+   if(module->fragmented && status == VC_CONTAINER_SUCCESS)
+   {
+      /* Everything but the last fragment is already in the file */
+      status = mp4_writer_write_fragment(p_ctx, VC_CONTAINER_TIME_UNKNOWN);
+   }
+   else if(status == VC_CONTAINER_SUCCESS)
+   {
+      mdat_size = STREAM_POSITION(p_ctx) - module->mdat_offset;
 
-   /* Finalise the mdat box */
-   SEEK(p_ctx, module->mdat_offset);
-   WRITE_U32(p_ctx, (uint32_t)mdat_size, "mdat size" );
+      /* Write the moov box */
+      status = mp4_write_box(p_ctx, MP4_BOX_TYPE_MOOV);
+
+      /* Finalise the mdat box */
+      SEEK(p_ctx, module->mdat_offset);
+      WRITE_U32(p_ctx, (uint32_t)mdat_size, "mdat size" );
+   }
 
    for(; p_ctx->tracks_num > 0; p_ctx->tracks_num--)
       vc_container_free_track(p_ctx, p_ctx->tracks[p_ctx->tracks_num-1]);
 
    vc_container_writer_extraio_delete(p_ctx, &module->temp);
    vc_container_writer_extraio_delete(p_ctx, &module->null);
+   free(module->fragment_data);
+   free(module->fragment_sample);
    free(module);
 
    return status;
@@ -1195,6 +1664,8 @@ static VC_CONTAINER_STATUS_T mp4_writer_add_track( VC_CONTAINER_T *p_ctx, VC_CON
    case VC_CONTAINER_CODEC_MP1V:   type = VC_FOURCC('m','p','e','g'); break;
    case VC_CONTAINER_CODEC_MP2V:   type = VC_FOURCC('m','p','e','g'); break;
 
+   case VC_CONTAINER_CODEC_METADATA: type = MP4_BOX_TYPE_METT; break;
+
    default: type = 0; break;
    }
 
@@ -1236,17 +1707,42 @@ static VC_CONTAINER_STATUS_T mp4_writer_add_track_done( VC_CONTAINER_T *p_ctx )
 {
    VC_CONTAINER_MODULE_T *module = p_ctx->priv->module;
    VC_CONTAINER_STATUS_T status = VC_CONTAINER_SUCCESS;
+   unsigned int i;
    if(module->tracks_add_done) return status;
 
-   /* We need to find out the size of the object we're going to write it. */
-   if(!vc_container_writer_extraio_enable(p_ctx, &module->null))
+   /* Fragments start on the keyframes of the first video track */
+   for(i = 0; i < p_ctx->tracks_num; i++)
+      if(p_ctx->tracks[i]->format->es_type == VC_CONTAINER_ES_TYPE_VIDEO) break;
+   module->fragment_track = i < p_ctx->tracks_num ? i : 0;
+
+   status = mp4_write_box(p_ctx, MP4_BOX_TYPE_FTYP);
+   if(status != VC_CONTAINER_SUCCESS) return status;
+
+   if(module->fragmented)
    {
+      /* The moov only describes the tracks, the samples go in the fragments */
       status = mp4_write_box(p_ctx, MP4_BOX_TYPE_MOOV);
-      module->moov_size = STREAM_POSITION(p_ctx);
-      p_ctx->size = module->moov_size;
+      p_ctx->size = STREAM_POSITION(p_ctx);
    }
-   vc_container_writer_extraio_disable(p_ctx, &module->null);
+   else
+   {
+      /* We need to find out the size of the object we're going to write it. */
+      if(!vc_container_writer_extraio_enable(p_ctx, &module->null))
+      {
+         status = mp4_write_box(p_ctx, MP4_BOX_TYPE_MOOV);
+         module->moov_size = STREAM_POSITION(p_ctx);
+         p_ctx->size = module->moov_size;
+      }
+      vc_container_writer_extraio_disable(p_ctx, &module->null);
 
+      /* Start the mdat box */
+      module->mdat_offset = STREAM_POSITION(p_ctx);
+      WRITE_U32(p_ctx, 0, "size");
+      WRITE_FOURCC(p_ctx, VC_FOURCC('m','d','a','t'), "type");
+      module->data_offset = STREAM_POSITION(p_ctx);
+   }
+
+   if(status == VC_CONTAINER_SUCCESS) status = STREAM_STATUS(p_ctx);
    if(status == VC_CONTAINER_SUCCESS) module->tracks_add_done = true;
    return status;
 }
@@ -1269,6 +1765,12 @@ static VC_CONTAINER_STATUS_T mp4_writer_control( VC_CONTAINER_T *p_ctx, VC_CONTA
    case VC_CONTAINER_CONTROL_TRACK_ADD_DONE:
       return mp4_writer_add_track_done(p_ctx);
 
+   case VC_CONTAINER_CONTROL_SET_FRAGMENTATION:
+      if(module->tracks_add_done) return VC_CONTAINER_ERROR_UNSUPPORTED_OPERATION;
+      module->fragmented = true;
+      module->fragment_frames = (uint32_t)va_arg(args, uint32_t);
+      return VC_CONTAINER_SUCCESS;
+
    default: return VC_CONTAINER_ERROR_UNSUPPORTED_OPERATION;
    }
 }
@@ -1332,6 +1834,9 @@ static VC_CONTAINER_STATUS_T mp4_writer_write( VC_CONTAINER_T *p_ctx,
       if(status != VC_CONTAINER_SUCCESS) return status;
    }
 
+   if(module->fragmented)
+      return mp4_writer_write_fragmented(p_ctx, packet);
+
    if(packet->flags & VC_CONTAINER_PACKET_FLAG_FRAME_START)
       ++module->samples; /* Switching to a new sample */
 
@@ -1373,6 +1878,7 @@ VC_CONTAINER_STATUS_T mp4_writer_open( VC_CONTAINER_T *p_ctx )
    VC_CONTAINER_STATUS_T status = VC_CONTAINER_ERROR_FORMAT_NOT_SUPPORTED;
    const char *extension = vc_uri_path_extension(p_ctx->priv->uri);
    VC_CONTAINER_MODULE_T *module = 0;
+   const char *fragment = 0;
    MP4_BRAND_T brand;
 
    /* Check if the user has specified a container */
@@ -1400,6 +1906,13 @@ VC_CONTAINER_STATUS_T mp4_writer_open( VC_CONTAINER_T *p_ctx )
    else brand = MP4_BRAND_ISOM;
    module->brand = brand;
 
+   /* Fragmented output can also be requested with a "fragment[=frames]" query */
+   if(vc_uri_find_query(p_ctx->priv->uri, 0, "fragment", &fragment))
+   {
+      module->fragmented = true;
+      if(fragment) module->fragment_frames = strtoul(fragment, 0, 10);
+   }
+
    /* Create a null i/o writer to help us out in writing our data */
    status = vc_container_writer_extraio_create_null(p_ctx, &module->null);
    if(status != VC_CONTAINER_SUCCESS) goto error;
@@ -1408,15 +1921,7 @@ VC_CONTAINER_STATUS_T mp4_writer_open( VC_CONTAINER_T *p_ctx )
    status = vc_container_writer_extraio_create_temp(p_ctx, &module->temp);
    if(status != VC_CONTAINER_SUCCESS) goto error;
 
-   status = mp4_write_box(p_ctx, MP4_BOX_TYPE_FTYP);
-   if(status != VC_CONTAINER_SUCCESS) goto error;
-
-   /* Start the mdat box */
-   module->mdat_offset = STREAM_POSITION(p_ctx);
-   WRITE_U32(p_ctx, 0, "size");
-   WRITE_FOURCC(p_ctx, VC_FOURCC('m','d','a','t'), "type");
-   module->data_offset = STREAM_POSITION(p_ctx);
-
+   /* The headers are written once all the tracks are known */
    p_ctx->priv->pf_close = mp4_writer_close;
    p_ctx->priv->pf_write = mp4_writer_write;
    p_ctx->priv->pf_control = mp4_writer_control;
@@ -1427,6 +1932,7 @@ VC_CONTAINER_STATUS_T mp4_writer_open( VC_CONTAINER_T *p_ctx )
    if(module)
    {
       if(module->null.io) vc_container_writer_extraio_delete(p_ctx, &module->null);
+      if(module->temp.io) vc_container_writer_extraio_delete(p_ctx, &module->temp);
       free(module);
    }
    return status;
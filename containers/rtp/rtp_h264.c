@@ -671,11 +671,13 @@ static VC_CONTAINER_STATUS_T h264_payload_handler(VC_CONTAINER_T *p_ctx,
       /* STAP-A packet: read NAL unit size and header from payload */
       stap_unit_header = BITS_READ_U32(p_ctx, payload, 24, "STAP unit header");
       extra->nal_unit_size = stap_unit_header >> 8;
-      if (extra->nal_unit_size > BITS_BYTES_AVAILABLE(p_ctx, payload))
+      /* The NAL unit size includes the header byte that has just been read */
+      if (!extra->nal_unit_size || extra->nal_unit_size - 1 > BITS_BYTES_AVAILABLE(p_ctx, payload))
       {
          LOG_ERROR(p_ctx, "H.264: STAP-A NAL unit size bigger than payload");
          return VC_CONTAINER_ERROR_FORMAT_INVALID;
       }
+      extra->nal_unit_size--;
       extra->header_bytes_to_write = 5;
       extra->nal_header = (uint8_t)stap_unit_header;
    }
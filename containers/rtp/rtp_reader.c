@@ -68,10 +68,10 @@ Configurable defines and constants.
 Defines and constants.
 ******************************************************************************/
 
-#define RTP_SCHEME                     "rtp:"
+#define RTP_SCHEME                     "rtp"
 
 /** The RTP PKT scheme is used with test pkt files */
-#define RTP_PKT_SCHEME                     "rtppkt:"
+#define RTP_PKT_SCHEME                     "rtppkt"
 
 /** \name RTP URI parameter names
  * @{ */
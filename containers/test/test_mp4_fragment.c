@@ -0,0 +1,346 @@
+/**
+ * \file test_mp4_fragment.c
+ * Test for the fragmented output mode of the mp4 writer.
+ *
+ * Writes a video track and a timed metadata track, then walks the boxes of
+ * the file and checks that every fragment describes exactly the samples that
+ * were written, starting on keyframes or after the configured number of
+ * frames. The file is also checked while it is still being written, since
+ * the complete fragments have to be usable if recording stops abruptly.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "containers/containers.h"
+#include "containers/containers_codecs.h"
+#include "containers/core/containers_common.h"
+#include "containers/core/containers_utils.h"
+#include "test_check.h"
+
+#define FRAMES         100
+#define FRAME_US       40000
+#define START_US       1000000
+#define GOP            25
+#define MAX_FRAMES     10
+#define PARTIAL_FRAMES 60
+
+static const uint8_t avcc[] = {
+   0x01, 0x64, 0x00, 0x1f, 0xff, 0xe1, 0x00, 0x04, 0x67, 0x64, 0x00, 0x1f,
+   0x01, 0x00, 0x04, 0x68, 0xee, 0x3c, 0x80
+};
+static const char mime[] = "application/json";
+
+static uint32_t frame_size(int frame)
+{
+   return 1000 + (frame * 37) % 3000;
+}
+
+static uint8_t frame_byte(int frame, uint32_t pos)
+{
+   return (uint8_t)(frame * 13 + pos * 7 + (pos >> 8));
+}
+
+static uint32_t be32(const uint8_t *p)
+{
+   return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static uint64_t be64(const uint8_t *p)
+{
+   return ((uint64_t)be32(p) << 32) | be32(p + 4);
+}
+
+/** Finds the next box of the given type in [*pos, end), returns its payload size or -1 */
+static long find_box(const uint8_t *data, long *pos, long end, const char *type)
+{
+   while (*pos + 8 <= end)
+   {
+      long size = be32(data + *pos), start = *pos;
+      if (size < 8 || start + size > end)
+         return -1;
+      *pos += size;
+      if (!memcmp(data + start + 4, type, 4))
+      {
+         *pos = start + 8;
+         return size - 8;
+      }
+   }
+   return -1;
+}
+
+typedef struct
+{
+   int frames[2];          /* Samples seen so far on each track */
+   int fragments;
+} PARSE_STATE_T;
+
+static void check_traf(const uint8_t *data, long moof, long traf, long end, PARSE_STATE_T *state, int *video)
+{
+   long pos = traf, box;
+   uint32_t track, count, flags, offset, i;
+   uint64_t base;
+
+   box = find_box(data, &pos, end, "tfhd");
+   CHECK(box >= 8, "traf without tfhd");
+   if (box < 8)
+      return;
+   CHECK((be32(data + pos) & 0xffffff) == 0x20000, "tfhd flags %x", be32(data + pos));
+   track = be32(data + pos + 4) - 1;
+   CHECK(track < 2, "Unexpected track_ID %u", track + 1);
+   if (track >= 2)
+      return;
+
+   pos = traf;
+   box = find_box(data, &pos, end, "tfdt");
+   CHECK(box == 12 && data[pos] == 1, "tfdt missing or not version 1");
+   if (box != 12)
+      return;
+   base = be64(data + pos + 4);
+   CHECK(base == (uint64_t)state->frames[track] * FRAME_US / 1000,
+         "Fragment %d track %u starts at %llu", state->fragments, track, (unsigned long long)base);
+
+   pos = traf;
+   box = find_box(data, &pos, end, "trun");
+   CHECK(box >= 12, "traf without trun");
+   if (box < 12)
+      return;
+   flags = be32(data + pos) & 0xffffff;
+   count = be32(data + pos + 4);
+   offset = be32(data + pos + 8);
+   CHECK(flags == 0x701, "trun flags %x", flags);
+   CHECK((long)(12 + count * 12) == box, "trun of %u samples is %ld bytes", count, box);
+   if (flags != 0x701 || (long)(12 + count * 12) != box)
+      return;
+
+   if (track == 0)
+      *video = count;
+
+   for (i = 0; i < count; i++)
+   {
+      const uint8_t *entry = data + pos + 12 + i * 12;
+      int frame = state->frames[track]++;
+      uint32_t size = be32(entry + 4), sample_flags = be32(entry + 8);
+
+      CHECK(be32(entry) == FRAME_US / 1000, "Track %u sample %d lasts %u", track, frame, be32(entry));
+      if (track == 0)
+      {
+         uint32_t j;
+         int keyframe = !(sample_flags & 0x10000);
+
+         CHECK(size == frame_size(frame), "Frame %d has %u bytes", frame, size);
+         CHECK(keyframe == (frame % GOP == 0), "Frame %d sync flag is wrong", frame);
+         CHECK(i == 0 || !keyframe, "Keyframe %d is not at the start of a fragment", frame);
+         for (j = 0; j < size && moof + offset + j < end; j++)
+            if (data[moof + offset + j] != frame_byte(frame, j))
+            {
+               CHECK(0, "Frame %d differs at %u", frame, j);
+               break;
+            }
+      }
+      else
+      {
+         char text[32];
+         int length = snprintf(text, sizeof(text), "{\"frame\":%d}", frame);
+         CHECK(size == (uint32_t)length && !memcmp(data + moof + offset, text, length),
+               "Metadata sample %d is wrong", frame);
+      }
+      offset += size;
+   }
+}
+
+/** Walks a fragmented file, returns the number of video frames it holds */
+static int check_file(const char *name, int complete)
+{
+   PARSE_STATE_T state;
+   uint8_t *data;
+   long size, pos = 0, box, moov;
+   int trex = 0;
+   FILE *file = fopen(name, "rb");
+
+   memset(&state, 0, sizeof(state));
+   CHECK(file != NULL, "Unable to open %s", name);
+   if (!file)
+      return 0;
+   fseek(file, 0, SEEK_END);
+   size = ftell(file);
+   fseek(file, 0, SEEK_SET);
+   data = malloc(size);
+   if (!data || fread(data, 1, size, file) != (size_t)size)
+   {
+      CHECK(0, "Unable to read %s", name);
+      fclose(file);
+      free(data);
+      return 0;
+   }
+   fclose(file);
+
+   CHECK(size >= 8 && !memcmp(data + 4, "ftyp", 4), "File does not start with ftyp");
+   moov = pos = be32(data);
+   box = find_box(data, &pos, size, "moov");
+   CHECK(box > 0 && pos == moov + 8, "No moov after the ftyp");
+   if (box > 0)
+   {
+      long end = pos + box;
+      box = find_box(data, &pos, end, "mvex");
+      CHECK(box > 0, "No mvex in the moov");
+      if (box > 0)
+         for (end = pos + box; find_box(data, &pos, end, "trex") == 24; pos += 24)
+            trex++;
+      pos = moov + 8 + be32(data + moov) - 8;
+   }
+   CHECK(trex == 2, "%d trex boxes", trex);
+
+   /* What follows are moof and mdat pairs only */
+   while (pos + 8 <= size)
+   {
+      long moof = pos, moof_end, mdat, traf;
+      int video = 0, start, expected;
+
+      if (be32(data + pos) < 8 || pos + (long)be32(data + pos) > size)
+         break;
+      box = find_box(data, &pos, size, "moof");
+      CHECK(box > 0 && pos == moof + 8, "Expected a moof at %ld", moof);
+      if (box <= 0 || pos != moof + 8)
+         break;
+      moof_end = pos + box;
+      mdat = moof_end;
+      CHECK(mdat + 8 <= size && !memcmp(data + mdat + 4, "mdat", 4), "No mdat after moof %d", state.fragments);
+      if (mdat + 8 > size || memcmp(data + mdat + 4, "mdat", 4))
+         break;
+      if (mdat + (long)be32(data + mdat) > size)
+      {
+         CHECK(!complete, "Fragment %d is truncated", state.fragments);
+         break;
+      }
+
+      box = find_box(data, &pos, moof_end, "mfhd");
+      CHECK(box == 8 && be32(data + pos + 4) == (uint32_t)state.fragments + 1,
+            "Fragment %d has the wrong sequence number", state.fragments);
+
+      for (pos = moof + 8; (box = find_box(data, &pos, moof_end, "traf")) > 0; pos = traf + box)
+      {
+         traf = pos;
+         check_traf(data, moof, traf, traf + box, &state, &video);
+      }
+
+      /* Fragments start on keyframes, or after MAX_FRAMES frames */
+      start = state.frames[0] - video;
+      expected = GOP - start % GOP < MAX_FRAMES ? GOP - start % GOP : MAX_FRAMES;
+      CHECK(video == expected, "Fragment %d has %d frames instead of %d", state.fragments, video, expected);
+      CHECK(state.frames[0] == state.frames[1], "Tracks differ after fragment %d", state.fragments);
+
+      state.fragments++;
+      pos = mdat + be32(data + mdat);
+   }
+   CHECK(pos == size || !complete, "Trailing data at %ld", pos);
+
+   free(data);
+   printf("%s: %d fragments, %d frames\n", complete ? "closed" : "recording", state.fragments, state.frames[0]);
+   return state.frames[0];
+}
+
+int main(int argc, char **argv)
+{
+   char name[] = "/tmp/test_mp4_fragment_XXXXXX.mp4";
+   VC_CONTAINER_T *ctx;
+   VC_CONTAINER_STATUS_T status;
+   VC_CONTAINER_ES_FORMAT_T *format;
+   VC_CONTAINER_PACKET_T packet;
+   static uint8_t data[4096];
+   int fd, frame;
+
+   VC_CONTAINER_PARAM_UNUSED(argc);
+   VC_CONTAINER_PARAM_UNUSED(argv);
+
+   fd = mkstemps(name, 4);
+   if (fd < 0)
+   {
+      fprintf(stderr, "Unable to create a temporary file\n");
+      return 1;
+   }
+   close(fd);
+
+   ctx = vc_container_open_writer(name, &status, 0, 0);
+   CHECK(ctx != NULL, "Unable to open the mp4 writer (%i)", status);
+   if (!ctx)
+      return error_count;
+
+   status = vc_container_control(ctx, VC_CONTAINER_CONTROL_SET_FRAGMENTATION, (uint32_t)MAX_FRAMES);
+   CHECK(status == VC_CONTAINER_SUCCESS, "Fragmentation not supported (%i)", status);
+
+   format = vc_container_format_create(sizeof(avcc));
+   format->es_type = VC_CONTAINER_ES_TYPE_VIDEO;
+   format->codec = VC_CONTAINER_CODEC_H264;
+   format->codec_variant = VC_FOURCC('a','v','c','C');
+   format->type->video.width = 640;
+   format->type->video.height = 480;
+   format->flags = VC_CONTAINER_ES_FORMAT_FLAG_FRAMED;
+   memcpy(format->extradata, avcc, sizeof(avcc));
+   format->extradata_size = sizeof(avcc);
+   status = vc_container_control(ctx, VC_CONTAINER_CONTROL_TRACK_ADD, format);
+   CHECK(status == VC_CONTAINER_SUCCESS, "Unable to add the video track (%i)", status);
+   vc_container_format_delete(format);
+
+   format = vc_container_format_create(sizeof(mime));
+   format->es_type = VC_CONTAINER_ES_TYPE_UNKNOWN;
+   format->codec = VC_CONTAINER_CODEC_METADATA;
+   format->flags = VC_CONTAINER_ES_FORMAT_FLAG_FRAMED;
+   memcpy(format->extradata, mime, sizeof(mime));
+   format->extradata_size = sizeof(mime);
+   status = vc_container_control(ctx, VC_CONTAINER_CONTROL_TRACK_ADD, format);
+   CHECK(status == VC_CONTAINER_SUCCESS, "Unable to add the metadata track (%i)", status);
+   vc_container_format_delete(format);
+
+   status = vc_container_control(ctx, VC_CONTAINER_CONTROL_TRACK_ADD_DONE);
+   CHECK(status == VC_CONTAINER_SUCCESS, "Unable to complete the track list (%i)", status);
+   status = vc_container_control(ctx, VC_CONTAINER_CONTROL_SET_FRAGMENTATION, (uint32_t)MAX_FRAMES);
+   CHECK(status != VC_CONTAINER_SUCCESS, "Fragmentation changed after the headers were written");
+
+   for (frame = 0; frame < FRAMES && !error_count; frame++)
+   {
+      uint32_t size = frame_size(frame), half = size / 2, i;
+
+      if (frame == PARTIAL_FRAMES)
+      {
+         /* Whatever is in the file so far has to stand on its own */
+         int frames = check_file(name, 0);
+         CHECK(frames >= PARTIAL_FRAMES - MAX_FRAMES && frames < PARTIAL_FRAMES,
+               "%d frames on disk after writing %d", frames, PARTIAL_FRAMES);
+      }
+
+      for (i = 0; i < size; i++)
+         data[i] = frame_byte(frame, i);
+
+      /* Frames come in more than one packet */
+      memset(&packet, 0, sizeof(packet));
+      packet.track = 0;
+      packet.pts = packet.dts = START_US + (int64_t)frame * FRAME_US;
+      packet.data = data;
+      packet.size = packet.buffer_size = half;
+      packet.flags = VC_CONTAINER_PACKET_FLAG_FRAME_START;
+      if (frame % GOP == 0)
+         packet.flags |= VC_CONTAINER_PACKET_FLAG_KEYFRAME;
+      vc_container_write(ctx, &packet);
+
+      packet.data = data + half;
+      packet.size = packet.buffer_size = size - half;
+      packet.flags = VC_CONTAINER_PACKET_FLAG_FRAME_END;
+      vc_container_write(ctx, &packet);
+
+      packet.track = 1;
+      packet.data = data;
+      packet.size = packet.buffer_size = snprintf((char *)data, sizeof(data), "{\"frame\":%d}", frame);
+      packet.flags = VC_CONTAINER_PACKET_FLAG_FRAME | VC_CONTAINER_PACKET_FLAG_KEYFRAME;
+      status = vc_container_write(ctx, &packet);
+      CHECK(status == VC_CONTAINER_SUCCESS, "Unable to write frame %d (%i)", frame, status);
+   }
+
+   vc_container_close(ctx);
+   CHECK(check_file(name, 1) == FRAMES, "Not all frames were found in the closed file");
+   unlink(name);
+
+   return test_result();
+}
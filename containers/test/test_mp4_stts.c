@@ -0,0 +1,147 @@
+/**
+ * \file test_mp4_stts.c
+ * Test for the sample timing written by the mp4 writer.
+ *
+ * Writes a video track whose frames do not come at a fixed rate, as with a
+ * camera that changes its framerate or drops frames, reads the file back
+ * and checks that every frame keeps its timestamp. Each sample lasts until
+ * the next one, so the timestamps must not drift or shift by one sample.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "containers/containers.h"
+#include "containers/containers_codecs.h"
+#include "containers/core/containers_common.h"
+#include "containers/core/containers_utils.h"
+#include "test_check.h"
+
+#define FRAMES   50
+#define START_US 1000000
+
+static const uint8_t avcc[] = {
+   0x01, 0x64, 0x00, 0x1f, 0xff, 0xe1, 0x00, 0x04, 0x67, 0x64, 0x00, 0x1f,
+   0x01, 0x00, 0x04, 0x68, 0xee, 0x3c, 0x80
+};
+
+/** Time of a frame, with frame intervals between 16 and 73 ms */
+static int64_t frame_dts(int frame)
+{
+   int64_t dts = START_US;
+   int i;
+
+   for (i = 0; i < frame; i++)
+      dts += (16 + (i * 23) % 58) * 1000;
+   return dts;
+}
+
+static int write_file(const char *name)
+{
+   VC_CONTAINER_T *ctx;
+   VC_CONTAINER_STATUS_T status;
+   VC_CONTAINER_ES_FORMAT_T *format;
+   VC_CONTAINER_PACKET_T packet;
+   uint8_t data[64];
+   int frame;
+
+   ctx = vc_container_open_writer(name, &status, 0, 0);
+   CHECK(ctx != NULL, "Unable to open the mp4 writer (%i)", status);
+   if (!ctx)
+      return -1;
+
+   format = vc_container_format_create(sizeof(avcc));
+   format->es_type = VC_CONTAINER_ES_TYPE_VIDEO;
+   format->codec = VC_CONTAINER_CODEC_H264;
+   format->codec_variant = VC_FOURCC('a','v','c','C');
+   format->type->video.width = 640;
+   format->type->video.height = 480;
+   format->flags = VC_CONTAINER_ES_FORMAT_FLAG_FRAMED;
+   memcpy(format->extradata, avcc, sizeof(avcc));
+   format->extradata_size = sizeof(avcc);
+   status = vc_container_control(ctx, VC_CONTAINER_CONTROL_TRACK_ADD, format);
+   CHECK(status == VC_CONTAINER_SUCCESS, "Unable to add the video track (%i)", status);
+   vc_container_format_delete(format);
+
+   for (frame = 0; frame < FRAMES; frame++)
+   {
+      memset(data, frame, sizeof(data));
+      memset(&packet, 0, sizeof(packet));
+      packet.pts = packet.dts = frame_dts(frame);
+      packet.data = data;
+      packet.size = packet.buffer_size = sizeof(data);
+      packet.flags = VC_CONTAINER_PACKET_FLAG_FRAME;
+      if (frame % 10 == 0)
+         packet.flags |= VC_CONTAINER_PACKET_FLAG_KEYFRAME;
+      status = vc_container_write(ctx, &packet);
+      CHECK(status == VC_CONTAINER_SUCCESS, "Unable to write frame %d (%i)", frame, status);
+   }
+
+   vc_container_close(ctx);
+   return 0;
+}
+
+static void check_file(const char *name)
+{
+   VC_CONTAINER_T *ctx;
+   VC_CONTAINER_STATUS_T status;
+   VC_CONTAINER_PACKET_T packet;
+   uint8_t data[64];
+   int64_t first = 0;
+   int frame = 0;
+
+   ctx = vc_container_open_reader(name, &status, 0, 0);
+   CHECK(ctx != NULL, "Unable to read back %s (%i)", name, status);
+   if (!ctx)
+      return;
+
+   while (1)
+   {
+      memset(&packet, 0, sizeof(packet));
+      packet.data = data;
+      packet.buffer_size = sizeof(data);
+      if (vc_container_read(ctx, &packet, 0) != VC_CONTAINER_SUCCESS)
+         break;
+      if (frame == FRAMES)
+      {
+         CHECK(0, "More than %d frames read back", FRAMES);
+         break;
+      }
+
+      CHECK(data[0] == frame, "Frame %d read back as frame %d", frame, data[0]);
+      if (!frame)
+         first = packet.dts;
+      CHECK(packet.dts - first == frame_dts(frame) - START_US,
+            "Frame %d at %lld us instead of %lld us", frame,
+            (long long)(packet.dts - first), (long long)(frame_dts(frame) - START_US));
+      frame++;
+   }
+   CHECK(frame == FRAMES, "%d frames read back instead of %d", frame, FRAMES);
+
+   vc_container_close(ctx);
+}
+
+int main(int argc, char **argv)
+{
+   char name[] = "/tmp/test_mp4_stts_XXXXXX.mp4";
+   int fd;
+
+   VC_CONTAINER_PARAM_UNUSED(argc);
+   VC_CONTAINER_PARAM_UNUSED(argv);
+
+   fd = mkstemps(name, 4);
+   if (fd < 0)
+   {
+      fprintf(stderr, "Unable to create a temporary file\n");
+      return 1;
+   }
+   close(fd);
+
+   if (write_file(name) == 0)
+      check_file(name);
+   unlink(name);
+
+   return test_result();
+}
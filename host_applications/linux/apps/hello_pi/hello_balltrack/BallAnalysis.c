@@ -1 +0,0 @@
-../../raspicam/BallAnalysis.c
\ No newline at end of file
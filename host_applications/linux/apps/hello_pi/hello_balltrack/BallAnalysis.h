@@ -1 +0,0 @@
-../../raspicam/BallAnalysis.h
\ No newline at end of file
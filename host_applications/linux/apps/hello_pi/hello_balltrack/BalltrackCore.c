@@ -1 +0,0 @@
-../../raspicam/BalltrackCore.c
\ No newline at end of file
@@ -1 +0,0 @@
-../../raspicam/BalltrackCore.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../raspicam/BalltrackUtil.c
\ No newline at end of file
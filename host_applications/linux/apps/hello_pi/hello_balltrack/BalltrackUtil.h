@@ -1 +0,0 @@
-../../raspicam/BalltrackUtil.h
\ No newline at end of file
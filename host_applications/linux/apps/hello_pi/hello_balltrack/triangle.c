@@ -44,7 +44,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "triangle.h"
 #include <pthread.h>
 
-#include "BalltrackCore.h"
+#include "Balltracker.h"
 
 // This has to be exactly the size of the file that is being played
 // TODO: Determine from file
@@ -68,6 +68,7 @@ typedef struct
    EGLSurface surface;
    EGLContext context;
    GLuint tex;
+   BALLTRACKER *tracker;
 } STATE_T;
 
 static void init_ogl(STATE_T *state);
@@ -188,7 +189,11 @@ static void init_ogl(STATE_T *state)
    //glMatrixMode(GL_MODELVIEW);
 
    printf("Initializing balltracking shaders.\n");
-   balltrack_core_init(0, 1);
+   // Frames come from the video decoder as an EGL image on a 2D texture
+   state->tracker = balltracker_create(&balltrack_backend_gles);
+   assert(state->tracker != NULL);
+   result = balltracker_init(state->tracker) == 0;
+   assert(EGL_FALSE != result);
 
    printf("OpenGL initialized.\n");
 }
@@ -234,7 +239,15 @@ static void redraw_scene(STATE_T *state)
    glRotatef(90.f, 0.f, 1.f, 0.f ); // bottom face normal along y axis
    glDrawArrays( GL_TRIANGLE_STRIP, 20, 4);
 #endif
-   balltrack_core_redraw(state->screen_width, state->screen_height, state->tex, GL_TEXTURE_2D);
+   BALLTRACK_FRAME frame;
+   memset(&frame, 0, sizeof(frame));
+   frame.width = IMAGE_SIZE_WIDTH;
+   frame.height = IMAGE_SIZE_HEIGHT;
+   frame.texture = state->tex;
+   frame.target = GL_TEXTURE_2D;
+   frame.view_width = state->screen_width;
+   frame.view_height = state->screen_height;
+   balltracker_process(state->tracker, &frame, NULL);
 
    eglSwapBuffers(state->display, state->surface);
 }
@@ -310,6 +323,7 @@ static void exit_func(void)
    eglSwapBuffers(state->display, state->surface);
 
    // Release OpenGL resources
+   balltracker_destroy(state->tracker);
    eglMakeCurrent( state->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
    eglDestroySurface( state->display, state->surface );
    eglDestroyContext( state->display, state->context );
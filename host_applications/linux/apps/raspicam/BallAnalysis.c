@@ -2,6 +2,8 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <math.h>
 
 // To communicate with the Python websocket server
 // we use a named pipe (FIFO) stored at
@@ -15,6 +17,9 @@
 // Constants
 static float goalWidth = 0.15f;
 static float goalHeight = 0.35f;
+// The goal mouth is modelled as a vertical line segment this far inside
+// the field bounds, spanning the goal height
+static float goalLineInset = 0.05f;
 
 
 // Ball history
@@ -25,12 +30,105 @@ static int ballCur = 0;
 
 static int frameNumber = 0;
 
+// Frames at the full rate each analysed frame stands for. The frame
+// counts below are at the full rate, see analysisFrames.
+static float frameScale = 1.0f;
+
 static FIELD field;
 
 static int ballMissing = 1000;
 
+// Filtered ball track (alpha-beta filter), positions in field coordinates
+// and velocity in units per frame
+static float trackAlpha = 0.7f;
+static float trackBeta = 0.4f;
+static POINT trackPos;
+static POINT trackVel;
+static int trackFrame = 0;
+static int trackLength = 0; // Consecutive frames the track has been updated
+
+// Goal line crossing state
+// Full rate frames without the ball after a crossing before the goal is confirmed
+static int goalConfirmFrames = 8;
+// Full rate frames after a crossing a provisional goal waits for the ball to disappear
+static int goalPendingFrames = 30;
+static int pendingGoal = 0;         // 1 or 2 like isInGoal, 0 if none
+static float pendingCrossing = 0.0f; // Interpolated frame number of the crossing
+static uint64_t pendingTime = 0;    // Time the provisional event was sent
+static float goalFrame = 0.0f;      // Frame number of the last goal
+
+// Camera timestamps of the last analysed frames, to find the time of a goal
+#define FRAME_PTS_COUNT 64
+static int ptsFrames[FRAME_PTS_COUNT];
+static int64_t framePts[FRAME_PTS_COUNT];
+
+// Latency statistics, printed with every confirmed goal
+static int statGoals = 0;
+static float statProvisionalFrames = 0.0f;
+static float statConfirmedFrames = 0.0f;
+
+static uint64_t analysis_time_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static analysis_event_fn eventCallback = 0;
+static void* eventCallbackData = 0;
+static const char* debugFifo = "/tmp/foos-debug.in";
+
+void analysis_set_event_callback(analysis_event_fn fn, void* userdata) {
+    eventCallback = fn;
+    eventCallbackData = userdata;
+}
+
+void analysis_set_debug_fifo(const char* path) {
+    debugFifo = path;
+}
+
+void analysis_set_frame_scale(float scale) {
+    frameScale = scale >= 1.0f ? scale : 1.0f;
+}
+
+// Number of analysed frames covering `frames` frames at the full rate, at least 1
+static int analysisFrames(int frames) {
+    int n = (int)ceilf(frames / frameScale);
+    return n > 0 ? n : 1;
+}
+
+float analysis_get_goal_frames_ago() {
+    return frameNumber - goalFrame;
+}
+
+void analysis_set_frame_pts(int64_t pts) {
+    ptsFrames[frameNumber % FRAME_PTS_COUNT] = frameNumber;
+    framePts[frameNumber % FRAME_PTS_COUNT] = pts;
+}
+
+static int64_t analysis_frame_pts(int frame) {
+    if (frame < 1 || frame > frameNumber || ptsFrames[frame % FRAME_PTS_COUNT] != frame)
+        return ANALYSIS_PTS_UNKNOWN;
+    return framePts[frame % FRAME_PTS_COUNT];
+}
+
+int64_t analysis_get_goal_pts() {
+    // The crossing is interpolated between two analysed frames
+    int frame = (int)goalFrame;
+    int64_t pts = analysis_frame_pts(frame);
+    if (pts == ANALYSIS_PTS_UNKNOWN || goalFrame == frame)
+        return pts;
+    int64_t next = analysis_frame_pts(frame + 1);
+    if (next == ANALYSIS_PTS_UNKNOWN)
+        return pts;
+    return pts + (int64_t)((goalFrame - frame) * (next - pts));
+}
+
 static int analysis_send_to_server(const char* str) {
-    int fd = open("/tmp/foos-debug.in", O_WRONLY | O_NONBLOCK);
+    if (eventCallback)
+        eventCallback(str, eventCallbackData);
+    if (!debugFifo)
+        return 0;
+    int fd = open(debugFifo, O_WRONLY | O_NONBLOCK);
     if (fd > 0) {
         write(fd, str, strlen(str));
         close(fd);
@@ -39,6 +137,12 @@ static int analysis_send_to_server(const char* str) {
     return 0;
 }
 
+// Events for the callback only, the server does not know them
+static void analysis_notify(const char* str) {
+    if (eventCallback)
+        eventCallback(str, eventCallbackData);
+}
+
 static int timeseriesfile = 0;
 
 int analysis_init() {
@@ -73,6 +177,87 @@ static int isInGoal(POINT ball) {
     return 0;
 }
 
+// Position of the goal line for goal 1 (left) or 2 (right)
+static float goalLineX(int goal) {
+    return goal == 1 ? field.xmin + goalLineInset : field.xmax - goalLineInset;
+}
+
+// Checks whether the segment from `a` to `b` crosses a goal line
+// towards the goal. Returns the goal (1 or 2) and sets `t` to the
+// fraction of the segment where it crosses, or returns 0.
+static int crossesGoalLine(POINT a, POINT b, float* t) {
+    float yAvg = 0.5f * (field.ymin + field.ymax);
+    for (int goal = 1; goal <= 2; ++goal) {
+        float lineX = goalLineX(goal);
+        float da = a.x - lineX;
+        float db = b.x - lineX;
+        // Must go from the field side to the goal side
+        int towards = (goal == 1) ? (da > 0.0f && db <= 0.0f) : (da < 0.0f && db >= 0.0f);
+        if (!towards)
+            continue;
+        float frac = da / (da - db);
+        float y = a.y + frac * (b.y - a.y);
+        if (y > yAvg - goalHeight && y < yAvg + goalHeight) {
+            *t = frac;
+            return goal;
+        }
+    }
+    return 0;
+}
+
+// Confidence in [0,1] that a crossing is a real goal: based on how long
+// the track has been stable and how fast the ball moves towards the goal
+static float crossingConfidence() {
+    float c = 0.4f;
+    if (trackLength >= 5)
+        c += 0.3f;
+    else
+        c += 0.06f * trackLength;
+    float vx = (trackVel.x < 0.0f ? -trackVel.x : trackVel.x) / frameScale;
+    // At least 1% of the field width per full rate frame counts as a shot
+    if (vx > 0.01f * (field.xmax - field.xmin))
+        c += 0.3f;
+    return c > 1.0f ? 1.0f : c;
+}
+
+static void sendGoal(int goal);
+
+static void sendProvisionalGoal(int goal, float crossing) {
+    pendingGoal = goal;
+    pendingCrossing = crossing;
+    pendingTime = analysis_time_us();
+    float confidence = crossingConfidence();
+    printf("Goal line crossed at frame %.2f, provisional goal %d after %.2f frames, confidence %.2f\n",
+            crossing, goal, frameNumber - crossing, confidence);
+    char buffer[128];
+    sprintf(buffer, "GOAL? %s %.2f\n", goal == 1 ? "RG" : "BG", confidence);
+    analysis_send_to_server(buffer);
+    statProvisionalFrames += frameNumber - crossing;
+}
+
+// Update the filtered track with a new detection
+static void updateTrack(POINT ball) {
+    int dt = frameNumber - trackFrame;
+    if (trackLength == 0 || dt <= 0 || dt > 3) {
+        // (Re)start the track
+        trackPos = ball;
+        trackVel.x = trackVel.y = 0.0f;
+        trackLength = 1;
+    } else {
+        POINT pred;
+        pred.x = trackPos.x + dt * trackVel.x;
+        pred.y = trackPos.y + dt * trackVel.y;
+        float rx = ball.x - pred.x;
+        float ry = ball.y - pred.y;
+        trackPos.x = pred.x + trackAlpha * rx;
+        trackPos.y = pred.y + trackAlpha * ry;
+        trackVel.x += (trackBeta / dt) * rx;
+        trackVel.y += (trackBeta / dt) * ry;
+        ++trackLength;
+    }
+    trackFrame = frameNumber;
+}
+
 static float distSq(POINT a, POINT b) {
     float dx = a.x - b.x;
     float dy = a.y - b.y;
@@ -142,7 +327,7 @@ int analysis_update(FIELD newField, POINT ball, int ballFound) {
     if (sendSAVE) {
         // Only send the SAVE if it does not get interrupted by a goal
         // within 20 frames
-        if (sendSAVE++ == 20) {
+        if (sendSAVE++ >= analysisFrames(20)) {
             analysis_send_to_server("SAVE\n");
             sendSAVE = 0;
         }
@@ -156,11 +341,47 @@ int analysis_update(FIELD newField, POINT ball, int ballFound) {
 
     int prevIdx = (ballCur == 0 ? historyCount - 1 : ballCur - 1);
     if (ballFound) {
-        if (ballMissing >= 30) {
+        if (ballMissing >= analysisFrames(30)) {
             printf("Ball was gone for %d frames.\n", ballMissing);
         }
+        int reappeared = ballMissing > 0;
         ballMissing = 0;
 
+        if (pendingGoal) {
+            float lineSide = ball.x - goalLineX(pendingGoal);
+            const char* reason = 0;
+            if (pendingGoal == 1 ? lineSide > 0.0f : lineSide < 0.0f) {
+                // The ball came back on the field, it was occluded and not in the goal
+                reason = "ball reappeared on the field";
+            } else if (reappeared) {
+                // The occlusion that would have confirmed the goal ended
+                reason = "ball reappeared behind the line";
+            } else if (frameNumber - pendingCrossing > analysisFrames(goalPendingFrames)) {
+                // The ball stays visible behind the line, it is not in the goal
+                reason = "ball did not disappear";
+            }
+            if (reason) {
+                printf("Provisional goal %d cancelled, %s\n", pendingGoal, reason);
+                analysis_send_to_server("GOAL CANCEL\n");
+                pendingGoal = 0;
+            }
+        }
+
+        // Check the filtered track for a goal line crossing between
+        // the previous and this frame
+        POINT prevPos = trackPos;
+        int prevFrame = trackFrame;
+        int hadTrack = trackLength > 0;
+        updateTrack(ball);
+        if (hadTrack && trackLength > 1 && !pendingGoal && frameNumber - lastGOAL >= analysisFrames(50)) {
+            float t;
+            int goal = crossesGoalLine(prevPos, trackPos, &t);
+            if (goal) {
+                sendSAVE = 0;
+                sendProvisionalGoal(goal, prevFrame + t * (frameNumber - prevFrame));
+            }
+        }
+
         balls[ballCur] = ball;
         ballFrames[ballCur] = frameNumber;
         ++ballCur;
@@ -169,14 +390,22 @@ int analysis_update(FIELD newField, POINT ball, int ballFound) {
         // This point and previous points should be at most 2 frames apart
         POINT prevBall = balls[prevIdx];
         int frameDiffs = frameNumber - ballFrames[prevIdx];
-        if (frameDiffs <= 20) {
+        if (frameDiffs <= analysisFrames(20)) {
             // Distance should be large ??
-            // At least x % of field width per frame
-            float distThreshold = ((float)frameDiffs) * 0.10f * (field.xmax - field.xmin);
+            // At least x % of field width per full rate frame
+            float fullFrames = frameDiffs * frameScale;
+            float distThreshold = fullFrames * 0.10f * (field.xmax - field.xmin);
             if (distSq(prevBall, ball) > distThreshold * distThreshold ) {
                 float yAvg = 0.5f * (field.ymin + field.ymax);
                 if (ball.y > yAvg - goalHeight && ball.y < yAvg + goalHeight && 
                         (ball.x < field.xmin + 3.0f * goalWidth || ball.x > field.xmax - 3.0f * goalWidth) ) {
+                    if (!sendSAVE) {
+                        // Speed in field widths per full rate frame
+                        char buffer[64];
+                        float speed = sqrtf(distSq(prevBall, ball)) / (fullFrames * (field.xmax - field.xmin));
+                        sprintf(buffer, "SHOT %.4f\n", speed);
+                        analysis_notify(buffer);
+                    }
                     sendSAVE = 1;
                 } else {
                     //analysis_send_to_server("FAST\n");
@@ -196,38 +425,78 @@ int analysis_update(FIELD newField, POINT ball, int ballFound) {
             }
         }
     } else {
-        if (ballMissing++ == 15) {
+        if (ballMissing == 0 && trackLength > 1 && !pendingGoal && frameNumber - lastGOAL >= analysisFrames(50)) {
+            // The ball just disappeared. Extrapolate the filtered track
+            // to this frame, it usually vanishes into the goal before it
+            // is seen behind the line.
+            POINT next;
+            int dt = frameNumber - trackFrame;
+            next.x = trackPos.x + dt * trackVel.x;
+            next.y = trackPos.y + dt * trackVel.y;
+            float t;
+            int goal = crossesGoalLine(trackPos, next, &t);
+            if (goal) {
+                sendSAVE = 0;
+                sendProvisionalGoal(goal, trackFrame + t * dt);
+            }
+        }
+        trackLength = 0;
+
+        ++ballMissing;
+        if (pendingGoal && ballMissing >= analysisFrames(goalConfirmFrames)) {
+            sendSAVE = 0;
+            lastGOAL = frameNumber;
+            statGoals++;
+            statConfirmedFrames += frameNumber - pendingCrossing;
+            printf("Goal confirmed %.2f frames (%.0f ms after provisional) after crossing. "
+                    "Average over %d goals: provisional %.2f, confirmed %.2f frames, "
+                    "previous detector 16 frames after last sighting\n",
+                    frameNumber - pendingCrossing, (analysis_time_us() - pendingTime) / 1000.0f,
+                    statGoals, statProvisionalFrames / statGoals, statConfirmedFrames / statGoals);
+            goalFrame = pendingCrossing;
+            sendGoal(pendingGoal);
+            pendingGoal = 0;
+        }
+
+        // Fallback for goals without a detected crossing,
+        // for example when the ball was lost before the goal line
+        if (ballMissing == analysisFrames(16)) {
             int goal = isInGoal(balls[prevIdx]);
             if (goal) {
                 sendSAVE = 0; // Dont send a potential SAVE
-                if (frameNumber - lastGOAL >= 50) { // Check if the last goal was at least 50 frames ago
+                if (frameNumber - lastGOAL >= analysisFrames(50)) { // Check if the last goal was at least 50 frames ago
                     lastGOAL = frameNumber;
-                    if (goal == 1) {
-                        printf("Goal for red!\n");
-                        analysis_send_to_server("RG\n");
-                    } else if (goal == 2) {
-                        printf("Goal for blue!\n");
-                        analysis_send_to_server("BG\n");
-                    }
-                    int player = getPlayerWhoScored(goal);
-                    if (player) {
-                        printf("TEST: Scored by \"bar\" %d\n", player);
-                        char buffer[128];
-                        sprintf(buffer, "SCOREDBY %d\n", player);
-                        analysis_send_to_server(buffer);
-                    }
+                    printf("Goal without goal line crossing\n");
+                    goalFrame = frameNumber - ballMissing;
+                    sendGoal(goal);
                 }
             }
-        }	
+        }
     }
     return 1;
 }
 
-// From BalltrackCore
-void draw_square(float xmin, float xmax, float ymin, float ymax, uint32_t color);
-void draw_line_strip(POINT* xys, int count, uint32_t color);
+static void sendGoal(int goal) {
+    if (goal == 1) {
+        printf("Goal for red!\n");
+        analysis_send_to_server("RG\n");
+    } else if (goal == 2) {
+        printf("Goal for blue!\n");
+        analysis_send_to_server("BG\n");
+    }
+    int player = getPlayerWhoScored(goal);
+    if (player) {
+        printf("TEST: Scored by \"bar\" %d\n", player);
+        char buffer[128];
+        sprintf(buffer, "SCOREDBY %d\n", player);
+        analysis_send_to_server(buffer);
+    }
+}
+
+int analysis_draw(const ANALYSIS_DRAW_OPS* ops) {
+    void (*draw_square)(float, float, float, float, uint32_t) = ops->square;
+    void (*draw_line_strip)(POINT*, int, uint32_t) = ops->line_strip;
 
-int analysis_draw() {
     // Draw green bounding box
     draw_square(field.xmin, field.xmax, field.ymin, field.ymax, 0xff00ff00);
     float yAvg = 0.5f * (field.ymin + field.ymax);
@@ -236,6 +505,15 @@ int analysis_draw() {
     draw_square(field.xmin, field.xmin + goalWidth, yAvg - goalHeight, yAvg + goalHeight, 0xff00ff00);
     draw_square(field.xmax - goalWidth, field.xmax, yAvg - goalHeight, yAvg + goalHeight, 0xff00ff00);
 
+    // Draw goal lines
+    POINT line[2];
+    for (int goal = 1; goal <= 2; ++goal) {
+        line[0].x = line[1].x = goalLineX(goal);
+        line[0].y = yAvg - goalHeight;
+        line[1].y = yAvg + goalHeight;
+        draw_line_strip(line, 2, pendingGoal == goal ? 0xff0000ff : 0xff00ffff);
+    }
+
     // Draw line for ball history
     // Be carefull with circular buffer
     draw_line_strip(&balls[0], ballCur, 0xffff0000);
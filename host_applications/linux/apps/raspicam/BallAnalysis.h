@@ -1,6 +1,8 @@
 #ifndef BALLANALYSIS_H
 #define BALLANALYSIS_H
 
+#include <stdint.h>
+
 // All coordinates are in [-1,1] range, the OpenGL standard
 
 typedef struct {
@@ -20,6 +22,44 @@ int analysis_init();
 // ballFound can be 0 or 1, dependinding on whether the ball was found
 int analysis_update(FIELD field, POINT ball, int ballFound);
 
-int analysis_draw();
+// Frames at the full framerate each analysed frame stands for, 1 by default.
+// Set it when the framerate drops or frames are skipped, the goal and shot
+// detection waits for the same time then. Speeds stay per full rate frame.
+void analysis_set_frame_scale(float scale);
+
+// Drawing primitives for the overlay, colors are 0xAABBGGRR.
+// BalltrackCore draws with GL, other backends can leave the overlay out.
+typedef struct {
+    void (*square)(float xmin, float xmax, float ymin, float ymax, uint32_t color);
+    void (*line_strip)(POINT* xys, int count, uint32_t color);
+} ANALYSIS_DRAW_OPS;
+
+int analysis_draw(const ANALYSIS_DRAW_OPS* ops);
+
+// Optional callback that receives every event sent to the server,
+// for example "SAVE\n" or "RG\n", and "SHOT <speed>\n" for shots on goal
+// with the speed in field widths per frame
+typedef void (*analysis_event_fn)(const char* event, void* userdata);
+void analysis_set_event_callback(analysis_event_fn fn, void* userdata);
+
+// Events are also written to the FIFO of the Python websocket server,
+// /tmp/foos-debug.in by default. NULL to only use the callback.
+void analysis_set_debug_fifo(const char* path);
+
+// Number of frames since the ball crossed the goal line for the last goal,
+// valid from the "RG\n" or "BG\n" event on. Can be fractional.
+float analysis_get_goal_frames_ago();
+
+// Timestamps are in the units of the frame source, INT64_MIN if unknown
+// like MMAL_TIME_UNKNOWN
+#define ANALYSIS_PTS_UNKNOWN INT64_MIN
+
+// Timestamp of the frame passed to the last analysis_update
+void analysis_set_frame_pts(int64_t pts);
+
+// Timestamp of the goal line crossing of the last goal, interpolated
+// between the analysed frames around it. Valid once analysis_set_frame_pts
+// has been called for the frame of the "RG\n" or "BG\n" event.
+int64_t analysis_get_goal_pts();
 
 #endif
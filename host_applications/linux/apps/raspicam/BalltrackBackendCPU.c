@@ -0,0 +1,56 @@
+#include "Balltracker.h"
+#include "BalltrackGrid.h"
+#include "BalltrackReference.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// The filter passes on the CPU with the reference model, for machines
+// without GL and for checking the GLES backend. The model only takes
+// frames of the camera size. Every frame is analysed right away, with
+// the full grid, and there is no overlay.
+
+static int separable;
+static BALLTRACK_GRID grid;
+static REFERENCE_TEXTURE gridTex;
+static uint8_t* gridRGBA;
+
+static void cpu_term(void) {
+    reference_texture_free(&gridTex);
+    free(gridRGBA);
+    gridRGBA = 0;
+}
+
+static int cpu_init(const BALLTRACK_CONFIG* config) {
+    separable = config->separable;
+    grid_init(&grid, REFERENCE_GRID_WIDTH, REFERENCE_GRID_HEIGHT);
+    gridRGBA = malloc(REFERENCE_GRID_WIDTH * REFERENCE_GRID_HEIGHT * 4);
+    if (!gridRGBA || reference_texture_init(&gridTex, REFERENCE_GRID_WIDTH, REFERENCE_GRID_HEIGHT) != 0) {
+        cpu_term();
+        return -1;
+    }
+    return 0;
+}
+
+static int cpu_track(const BALLTRACK_FRAME* frame, BALLTRACK_RESULT* result) {
+    if (!frame->rgba || frame->width != REFERENCE_SOURCE_WIDTH || frame->height != REFERENCE_SOURCE_HEIGHT) {
+        printf("The cpu backend needs %dx%d RGBA frames\n", REFERENCE_SOURCE_WIDTH, REFERENCE_SOURCE_HEIGHT);
+        return -1;
+    }
+    if (reference_grid(frame->rgba, separable, &gridTex) != 0)
+        return -1;
+    reference_texture_to_rgba(&gridTex, gridRGBA);
+    grid_analyse(&grid, (const uint32_t*)gridRGBA, 0, 0, grid.width, grid.height, 1);
+
+    result->analysed = 1;
+    result->delay = 0;
+    result->ball = grid.ball;
+    result->found = grid.found;
+    return 0;
+}
+
+const BALLTRACK_BACKEND balltrack_backend_cpu = {
+    .name = "cpu",
+    .init = cpu_init,
+    .track = cpu_track,
+    .term = cpu_term,
+};
@@ -0,0 +1,77 @@
+#include "Balltracker.h"
+#include "BalltrackCore.h"
+
+// The shader passes of BalltrackCore, in the GL context of the caller.
+// Frames are textures, or RGBA pixels that are uploaded to one.
+
+static GLuint uploadTex;
+static int uploadWidth;
+static int uploadHeight;
+
+static int gles_init(const BALLTRACK_CONFIG* config) {
+    balltrack_core_set_pipeline(config->pipeline);
+    balltrack_core_set_passes(config->separable, config->display);
+    // Decoded and uploaded frames are upside down compared to the camera
+    return balltrack_core_init(config->external_sampler, !config->external_sampler);
+}
+
+static GLuint gles_upload(const BALLTRACK_FRAME* frame) {
+    GLCHK(glActiveTexture(GL_TEXTURE0));
+    if (!uploadTex) {
+        GLCHK(glGenTextures(1, &uploadTex));
+        glBindTexture(GL_TEXTURE_2D, uploadTex);
+        GLCHK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GLCHK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GLCHK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GLCHK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    } else {
+        glBindTexture(GL_TEXTURE_2D, uploadTex);
+    }
+    if (frame->width != uploadWidth || frame->height != uploadHeight) {
+        GLCHK(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, frame->width, frame->height, 0,
+                    GL_RGBA, GL_UNSIGNED_BYTE, frame->rgba));
+        uploadWidth = frame->width;
+        uploadHeight = frame->height;
+    } else {
+        GLCHK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frame->width, frame->height,
+                    GL_RGBA, GL_UNSIGNED_BYTE, frame->rgba));
+    }
+    return uploadTex;
+}
+
+static int gles_track(const BALLTRACK_FRAME* frame, BALLTRACK_RESULT* result) {
+    GLuint tex = frame->texture;
+    GLuint target = frame->target ? frame->target : GL_TEXTURE_2D;
+    if (frame->rgba) {
+        tex = gles_upload(frame);
+        target = GL_TEXTURE_2D;
+    }
+
+    int width = frame->view_width ? frame->view_width : frame->width;
+    int height = frame->view_height ? frame->view_height : frame->height;
+    int rc = balltrack_core_redraw(width, height, tex, target);
+    if (rc != 0)
+        return rc;
+
+    const BALLTRACK_TIMINGS* timings = balltrack_core_get_timings();
+    result->analysed = timings->filtered;
+    result->delay = timings->delay;
+    result->found = balltrack_core_get_ball(&result->ball);
+    return 0;
+}
+
+static void gles_term(void) {
+    balltrack_core_print_stats();
+    if (uploadTex)
+        GLCHK(glDeleteTextures(1, &uploadTex));
+    uploadTex = 0;
+    uploadWidth = uploadHeight = 0;
+    balltrack_core_term();
+}
+
+const BALLTRACK_BACKEND balltrack_backend_gles = {
+    .name = "gles",
+    .init = gles_init,
+    .track = gles_track,
+    .term = gles_term,
+};
@@ -0,0 +1,154 @@
+// Tracker benchmark: runs the same frames through every combination of
+// backend, grid filter and readback pipeline, and prints one line per
+// combination with the time per frame and the accuracy against the
+// ground truth. The frames are read into memory first, so only the
+// tracker is timed, and every combination is measured by balltracker_run
+// in the same way.
+//
+// The GLES backend runs in a context without a window (BalltrackEGL.h),
+// on the Pi or, built with BALLTRACK_HEADLESS, on the system GL.
+
+#include "Balltracker.h"
+#include "BalltrackEGL.h"
+#include "BalltrackSource.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_WIDTH  640
+#define BENCH_HEIGHT 360
+
+typedef struct {
+    const BALLTRACK_BACKEND* backend;
+    int separable;
+    int pipeline;
+} BENCH_CASE;
+
+static const BENCH_CASE benchCases[] = {
+    { &balltrack_backend_gles, 0, 1 },
+    { &balltrack_backend_gles, 1, 1 },
+    { &balltrack_backend_gles, 0, 2 },
+    { &balltrack_backend_gles, 1, 2 },
+    { &balltrack_backend_gles, 1, 3 },
+    { &balltrack_backend_cpu,  0, 1 },
+    { &balltrack_backend_cpu,  1, 1 },
+};
+
+static BALLTRACK_SOURCE* open_source(const char* path, int width, int height, int yuv, int frames) {
+    if (!path)
+        return balltrack_source_synthetic(frames);
+    if (yuv)
+        return balltrack_source_open_yuv(path, width, height);
+    return balltrack_source_open_file(path, width, height);
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [options] [file|-]\n"
+           "  -size WxH      Raw RGBA frames of this size instead of PPM images\n"
+           "  -yuv WxH       Raw I420 frames of this size\n"
+           "  -frames N      Frames to read into memory, 60 by default\n"
+           "  -loops N       Times every combination runs over the frames, 1 by default\n"
+           "  -backend NAME  Only this backend, gles or cpu\n"
+           "  -display       Also run the display pass of the GLES backend\n"
+           "Without a file the frames are the synthetic table.\n", name);
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    const char* only = NULL;
+    int width = 0, height = 0, yuv = 0;
+    int frames = 60, loops = 1, display = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if ((!strcmp(argv[i], "-size") || !strcmp(argv[i], "-yuv")) && i + 1 < argc) {
+            yuv = !strcmp(argv[i], "-yuv");
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-frames") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-loops") && i + 1 < argc) {
+            loops = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-backend") && i + 1 < argc) {
+            only = argv[++i];
+        } else if (!strcmp(argv[i], "-display")) {
+            display = 1;
+        } else if (argv[i][0] != '-' || !strcmp(argv[i], "-")) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (frames <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    BALLTRACK_SOURCE* source = open_source(path, width, height, yuv, frames);
+    if (!source)
+        return 1;
+    source = balltrack_source_preload(source, frames, loops);
+    if (!source)
+        return 1;
+
+    BALLTRACK_EGL egl;
+    int rc = balltrack_egl_init(&egl, BENCH_WIDTH, BENCH_HEIGHT);
+    if (rc != 0) {
+        source->close(source);
+        return 1;
+    }
+
+    char lines[sizeof(benchCases) / sizeof(benchCases[0])][160];
+    int count = 0;
+    for (size_t i = 0; i < sizeof(benchCases) / sizeof(benchCases[0]); ++i) {
+        const BENCH_CASE* c = &benchCases[i];
+        if (only && strcmp(only, c->backend->name))
+            continue;
+
+        // Every case sees the same frames from the start
+        balltrack_source_rewind(source);
+        BALLTRACKER* tracker = balltracker_create(c->backend);
+        if (!tracker) {
+            rc = -1;
+            break;
+        }
+        BALLTRACK_CONFIG config;
+        balltracker_get_config(tracker, &config);
+        config.separable = c->separable;
+        config.pipeline = c->pipeline;
+        config.display = display && egl.surface != EGL_NO_SURFACE;
+        balltracker_set_config(tracker, &config);
+
+        int n = -1;
+        if (balltracker_init(tracker) == 0)
+            n = balltracker_run(tracker, source, 0);
+        BALLTRACKER_STATS stats;
+        balltracker_get_stats(tracker, &stats);
+        balltracker_destroy(tracker);
+        if (n <= 0) {
+            printf("%s backend failed\n", c->backend->name);
+            rc = -1;
+            continue;
+        }
+
+        double ms = stats.track_us / 1000.0 / stats.frames;
+        uint32_t hits = stats.truths - stats.misses;
+        int len = snprintf(lines[count], sizeof(lines[count]), "%-5s %-9s %8d %9.2f %7.1f %8u",
+                c->backend->name, c->separable ? "separable" : "fused", c->pipeline, ms,
+                ms > 0.0 ? 1000.0 / ms : 0.0, stats.analysed);
+        if (stats.truths)
+            snprintf(lines[count] + len, sizeof(lines[count]) - len, " %6u %9.4f %9.4f", stats.misses,
+                    hits ? stats.error_sum / hits : 0.0, stats.error_max);
+        ++count;
+    }
+
+    printf("\nbackend grid    pipeline  ms/frame     fps analysed missed mean err  max err\n");
+    for (int i = 0; i < count; ++i)
+        printf("%s\n", lines[i]);
+
+    balltrack_egl_term(&egl);
+    source->close(source);
+    return rc < 0 ? 1 : 0;
+}
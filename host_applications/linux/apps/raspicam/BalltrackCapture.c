@@ -0,0 +1,429 @@
+#include "BalltrackCapture.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t frame;
+    int valid;      // A frame was rendered into the slot
+    int frozen;     // Requested for a dump, not read back yet
+} CAPTURE_SLOT;
+
+typedef enum {
+    BUFFER_FREE = 0,
+    BUFFER_READING, // Handed to the render thread
+    BUFFER_QUEUED,  // Waiting for the writer
+    BUFFER_WRITING,
+} BUFFER_STATE;
+
+typedef struct {
+    uint8_t* pixels;
+    uint32_t frame;
+    int slot;
+    BUFFER_STATE state;
+} CAPTURE_BUFFER;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queued = PTHREAD_COND_INITIALIZER;
+
+static int enabled = 0;
+static CAPTURE_KIND kind;
+static CAPTURE_FORMAT format;
+static char prefix[256];
+static int width, height;
+
+static CAPTURE_SLOT* slots = 0;
+static int slotCount = 0;
+static int newest = -1;
+
+static CAPTURE_BUFFER buffers[CAPTURE_BUFFERS];
+static int reading = -1;    // Buffer handed out by capture_next_readback
+
+// Buffers waiting for the writer, in readback order
+static int queue[CAPTURE_BUFFERS];
+static int queueHead = 0, queueCount = 0;
+
+static pthread_t writer;
+static int running = 0;
+static uint8_t* pngBuffer = 0;
+static size_t pngSize = 0;
+
+static CAPTURE_STATS stats;
+
+// Frame numbers wrap, compare them by difference
+static int frame_before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+static int write_frame(CAPTURE_BUFFER* buffer) {
+    char filename[300];
+    const uint8_t* data = buffer->pixels;
+    size_t size = (size_t)width * height * 4;
+
+    if (format == CAPTURE_PNG) {
+        size = capture_encode_png(buffer->pixels, width, height, pngBuffer, pngSize);
+        if (!size)
+            return -1;
+        data = pngBuffer;
+    }
+
+    snprintf(filename, sizeof(filename), "%s%06u.%s", prefix, buffer->frame, format == CAPTURE_PNG ? "png" : "rgba");
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        printf("Capture: unable to open %s\n", filename);
+        return -1;
+    }
+    size_t written = fwrite(data, 1, size, f);
+    if (fclose(f) != 0 || written != size) {
+        printf("Capture: unable to write %s\n", filename);
+        return -1;
+    }
+    return 0;
+}
+
+static void* writer_thread(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        while (running && !queueCount)
+            pthread_cond_wait(&queued, &lock);
+        if (!queueCount)
+            break;
+
+        CAPTURE_BUFFER* buffer = &buffers[queue[queueHead]];
+        queueHead = (queueHead + 1) % CAPTURE_BUFFERS;
+        queueCount--;
+        buffer->state = BUFFER_WRITING;
+        pthread_mutex_unlock(&lock);
+
+        int rc = write_frame(buffer);
+
+        pthread_mutex_lock(&lock);
+        buffer->state = BUFFER_FREE;
+        if (rc == 0)
+            stats.written++;
+        else
+            stats.failed++;
+    }
+    pthread_mutex_unlock(&lock);
+    return 0;
+}
+
+int capture_init(int frames, CAPTURE_KIND captureKind, CAPTURE_FORMAT captureFormat, const char* filePrefix) {
+    if (enabled || frames < 1)
+        return -1;
+
+    kind = captureKind;
+    format = captureFormat;
+    strncpy(prefix, filePrefix, sizeof(prefix) - 1);
+    prefix[sizeof(prefix) - 1] = 0;
+    if (kind == CAPTURE_FILTER) {
+        width = CAPTURE_FILTER_WIDTH;
+        height = CAPTURE_FILTER_HEIGHT;
+    } else {
+        width = CAPTURE_SOURCE_WIDTH;
+        height = CAPTURE_SOURCE_HEIGHT;
+    }
+
+    slots = calloc(frames, sizeof(CAPTURE_SLOT));
+    if (!slots)
+        return -1;
+    slotCount = frames;
+    newest = -1;
+
+    memset(buffers, 0, sizeof(buffers));
+    for (int i = 0; i < CAPTURE_BUFFERS; ++i) {
+        buffers[i].pixels = malloc((size_t)width * height * 4);
+        if (!buffers[i].pixels)
+            goto fail;
+    }
+    if (format == CAPTURE_PNG) {
+        pngSize = capture_png_size(width, height);
+        pngBuffer = malloc(pngSize);
+        if (!pngBuffer)
+            goto fail;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    reading = -1;
+    queueHead = queueCount = 0;
+    running = 1;
+    if (pthread_create(&writer, 0, writer_thread, 0) != 0) {
+        running = 0;
+        goto fail;
+    }
+
+    enabled = 1;
+    return 0;
+
+fail:
+    for (int i = 0; i < CAPTURE_BUFFERS; ++i)
+        free(buffers[i].pixels);
+    free(pngBuffer);
+    free(slots);
+    pngBuffer = 0;
+    slots = 0;
+    return -1;
+}
+
+void capture_destroy() {
+    if (!enabled)
+        return;
+
+    pthread_mutex_lock(&lock);
+    running = 0;
+    pthread_cond_signal(&queued);
+    pthread_mutex_unlock(&lock);
+    pthread_join(writer, 0);
+
+    enabled = 0;
+    for (int i = 0; i < CAPTURE_BUFFERS; ++i)
+        free(buffers[i].pixels);
+    free(pngBuffer);
+    free(slots);
+    pngBuffer = 0;
+    slots = 0;
+}
+
+int capture_enabled() {
+    return enabled;
+}
+
+CAPTURE_KIND capture_get_kind() {
+    return kind;
+}
+
+int capture_get_slots() {
+    return slotCount;
+}
+
+void capture_get_size(int* w, int* h) {
+    *w = width;
+    *h = height;
+}
+
+int capture_begin_frame(uint32_t frame) {
+    int slot = -1;
+
+    pthread_mutex_lock(&lock);
+    // Frozen slots are skipped, so the ring is only in frame order until a dump
+    for (int i = 1; i <= slotCount; ++i) {
+        int s = (newest + i + slotCount) % slotCount;
+        if (!slots[s].frozen) {
+            slot = s;
+            break;
+        }
+    }
+    if (slot >= 0) {
+        slots[slot].frame = frame;
+        slots[slot].valid = 1;
+        newest = slot;
+        stats.captured++;
+    } else {
+        stats.missed++;
+    }
+    pthread_mutex_unlock(&lock);
+    return slot;
+}
+
+int capture_next_readback(uint8_t** pixels) {
+    int slot = -1, buffer = -1;
+
+    // The readback can as well wait for the next frame
+    if (pthread_mutex_trylock(&lock) != 0)
+        return -1;
+    for (int i = 0; i < CAPTURE_BUFFERS && reading < 0; ++i) {
+        if (buffers[i].state == BUFFER_FREE) {
+            buffer = i;
+            break;
+        }
+    }
+    if (buffer >= 0) {
+        // Oldest first, it is the next to be overwritten after it is unfrozen
+        for (int s = 0; s < slotCount; ++s) {
+            if (slots[s].frozen && (slot < 0 || frame_before(slots[s].frame, slots[slot].frame)))
+                slot = s;
+        }
+    }
+    if (slot >= 0) {
+        buffers[buffer].state = BUFFER_READING;
+        buffers[buffer].slot = slot;
+        buffers[buffer].frame = slots[slot].frame;
+        reading = buffer;
+        *pixels = buffers[buffer].pixels;
+    }
+    pthread_mutex_unlock(&lock);
+    return slot;
+}
+
+void capture_readback_done(int slot, uint32_t readback_us) {
+    pthread_mutex_lock(&lock);
+    if (reading >= 0 && buffers[reading].slot == slot) {
+        slots[slot].frozen = 0;
+        buffers[reading].state = BUFFER_QUEUED;
+        queue[(queueHead + queueCount) % CAPTURE_BUFFERS] = reading;
+        queueCount++;
+        reading = -1;
+        if (readback_us > stats.max_readback_us)
+            stats.max_readback_us = readback_us;
+        pthread_cond_signal(&queued);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+int capture_request(int count, int skip) {
+    int frozen = 0;
+
+    if (!enabled || count < 1 || skip < 0)
+        return 0;
+
+    pthread_mutex_lock(&lock);
+    if (newest >= 0) {
+        uint32_t last = slots[newest].frame - (uint32_t)skip;
+        uint32_t first = last - (uint32_t)count + 1;
+        for (int s = 0; s < slotCount; ++s) {
+            if (slots[s].valid && !slots[s].frozen &&
+                    !frame_before(slots[s].frame, first) && !frame_before(last, slots[s].frame)) {
+                slots[s].frozen = 1;
+                frozen++;
+            }
+        }
+        stats.requested += frozen;
+    }
+    pthread_mutex_unlock(&lock);
+    return frozen;
+}
+
+void capture_get_stats(CAPTURE_STATS* s) {
+    pthread_mutex_lock(&lock);
+    *s = stats;
+    pthread_mutex_unlock(&lock);
+}
+
+// PNG with stored (uncompressed) deflate blocks, so no zlib is needed.
+// A frame is written in well under a frame interval this way, compression
+// would take the writer longer than the ring takes to fill.
+#define DEFLATE_BLOCK 65535
+
+static uint32_t crcTable[256];
+
+static uint32_t png_crc(uint32_t crc, const uint8_t* data, size_t size) {
+    if (!crcTable[1]) {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            crcTable[n] = c;
+        }
+    }
+    for (size_t i = 0; i < size; ++i)
+        crc = crcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+// The sums can go 5552 bytes before they overflow 32 bits
+static void adler_update(uint32_t* s1, uint32_t* s2, const uint8_t* data, size_t size) {
+    while (size) {
+        size_t n = size < 5552 ? size : 5552;
+        size -= n;
+        while (n--) {
+            *s1 += *data++;
+            *s2 += *s1;
+        }
+        *s1 %= 65521;
+        *s2 %= 65521;
+    }
+}
+
+static uint8_t* put_be32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+    return p + 4;
+}
+
+size_t capture_png_size(int w, int h) {
+    size_t raw = (size_t)h * (w * 4 + 1);
+    size_t blocks = (raw + DEFLATE_BLOCK - 1) / DEFLATE_BLOCK;
+    // Signature, IHDR, IDAT with zlib header, blocks and adler32, IEND
+    return 8 + 25 + 12 + 2 + raw + 5 * blocks + 4 + 12;
+}
+
+size_t capture_encode_png(const uint8_t* rgba, int w, int h, uint8_t* out, size_t size) {
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    size_t raw = (size_t)h * (w * 4 + 1);
+    size_t total = capture_png_size(w, h);
+    uint32_t s1 = 1, s2 = 0;
+    uint8_t* p = out;
+
+    if (size < total)
+        return 0;
+
+    memcpy(p, signature, 8);
+    p += 8;
+
+    uint8_t* chunk = p;
+    p = put_be32(p, 13);
+    memcpy(p, "IHDR", 4);
+    p = put_be32(p + 4, w);
+    p = put_be32(p, h);
+    *p++ = 8;   // Bit depth
+    *p++ = 6;   // RGBA
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = 0;
+    p = put_be32(p, png_crc(0xffffffffu, chunk + 4, 17) ^ 0xffffffffu);
+
+    chunk = p;
+    p = put_be32(p, (uint32_t)(total - 8 - 25 - 12 - 12));
+    memcpy(p, "IDAT", 4);
+    p += 4;
+    *p++ = 0x78;
+    *p++ = 0x01;
+
+    // Rows are emitted top first, GL reads them bottom first
+    size_t left = raw;
+    int row = 0;
+    size_t column = 0;  // Bytes of the current row done, the filter byte included
+    while (left) {
+        size_t block = left < DEFLATE_BLOCK ? left : DEFLATE_BLOCK;
+        left -= block;
+        *p++ = left ? 0 : 1;
+        *p++ = block & 0xff;
+        *p++ = block >> 8;
+        *p++ = ~block & 0xff;
+        *p++ = (~block >> 8) & 0xff;
+        while (block) {
+            size_t n;
+            if (column == 0) {
+                *p = 0; // No filter
+                n = 1;
+            } else {
+                const uint8_t* src = rgba + ((size_t)(h - 1 - row) * w * 4) + column - 1;
+                n = w * 4 + 1 - column;
+                if (n > block)
+                    n = block;
+                memcpy(p, src, n);
+            }
+            adler_update(&s1, &s2, p, n);
+            p += n;
+            block -= n;
+            column += n;
+            if (column == (size_t)w * 4 + 1) {
+                column = 0;
+                row++;
+            }
+        }
+    }
+    p = put_be32(p, (s2 << 16) | s1);
+    p = put_be32(p, png_crc(0xffffffffu, chunk + 4, p - chunk - 4) ^ 0xffffffffu);
+
+    chunk = p;
+    p = put_be32(p, 0);
+    memcpy(p, "IEND", 4);
+    p = put_be32(p + 4, png_crc(0xffffffffu, chunk + 4, 4) ^ 0xffffffffu);
+
+    return p - out;
+}
@@ -0,0 +1,79 @@
+#ifndef BALLTRACKCAPTURE_H
+#define BALLTRACKCAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Capture ring for calibration dumps.
+//
+// The last few frames, either the camera source or the phase 1 filter
+// output, are kept on the GPU in a ring of preallocated textures that
+// BalltrackCore renders into every frame. A dump request freezes the
+// requested frames in the ring, after which the render thread reads back
+// at most one of them per frame into a preallocated buffer and a writer
+// thread saves it. Rendering never waits for the writer: when all
+// buffers are in use the readback waits for the next frame, and when all
+// slots are frozen new frames are not captured until they are read back.
+//
+// This file only does the bookkeeping and the writing, the GL side is in
+// BalltrackCore.c.
+
+typedef enum {
+    CAPTURE_SOURCE = 0,     // Camera frames, scaled to CAPTURE_SOURCE_WIDTH x CAPTURE_SOURCE_HEIGHT
+    CAPTURE_FILTER,         // Phase 1 filter output, two pixels packed in each RGBA pixel
+} CAPTURE_KIND;
+
+typedef enum {
+    CAPTURE_RAW = 0,        // RGBA bytes, bottom row first as read from GL
+    CAPTURE_PNG,            // RGBA PNG, top row first
+} CAPTURE_FORMAT;
+
+#define CAPTURE_SOURCE_WIDTH   640
+#define CAPTURE_SOURCE_HEIGHT  360
+#define CAPTURE_FILTER_WIDTH   320
+#define CAPTURE_FILTER_HEIGHT  360
+
+// Readback buffers between the render thread and the writer
+#define CAPTURE_BUFFERS        4
+
+typedef struct {
+    uint32_t captured;      // Frames rendered into the ring
+    uint32_t missed;        // Frames not captured because all slots were frozen
+    uint32_t requested;     // Frames frozen for dumps
+    uint32_t written;       // Frames written to files
+    uint32_t failed;        // Frames that could not be written
+    uint32_t max_readback_us; // Longest readback on the render thread
+} CAPTURE_STATS;
+
+// Set up the ring and start the writer thread, before the GL thread starts.
+// Files are named <prefix><frame>.rgba or .png.
+int capture_init(int frames, CAPTURE_KIND kind, CAPTURE_FORMAT format, const char* prefix);
+// Stops the writer after the frames already read back are written
+void capture_destroy();
+
+int capture_enabled();
+CAPTURE_KIND capture_get_kind();
+int capture_get_slots();
+void capture_get_size(int* width, int* height);
+
+// Render thread: slot to render frame `frame` into, or -1 to skip it
+int capture_begin_frame(uint32_t frame);
+// Render thread: frozen slot to read back now and the buffer to read it
+// into, or -1 if there is none or no free buffer
+int capture_next_readback(uint8_t** buffer);
+// Render thread: the slot was read into its buffer, hand it to the writer
+void capture_readback_done(int slot, uint32_t readback_us);
+
+// Any thread: dump `count` frames, ending `skip` captured frames before
+// the newest. Returns the number of frames that will be written.
+int capture_request(int count, int skip);
+
+void capture_get_stats(CAPTURE_STATS* stats);
+
+// Encode an RGBA image as PNG, bottom row first as read from GL.
+// Returns the size, or 0 if `size` is too small. capture_png_size gives
+// the size needed.
+size_t capture_png_size(int width, int height);
+size_t capture_encode_png(const uint8_t* rgba, int width, int height, uint8_t* out, size_t size);
+
+#endif /* BALLTRACKCAPTURE_H */
@@ -27,6 +27,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "BalltrackCore.h"
 #include "BallAnalysis.h"
+#include "BalltrackCapture.h"
+#include "BalltrackGrid.h"
 #include <string.h>
 
 // For writing to the FIFO python thing
@@ -50,23 +52,15 @@ static int height0 = 720;
 static int width1  = 640 / 2; // RGBA packs two pairs
 static int height1 = 360;
 
-#ifdef THREE_PHASES
-// -- From phase 1 to phase 2: dilate 'red' filter, do not erode 'orange filter' but rescale?
-// -- 4x4 pixels to 1 pixel (but sample 12x12 pixels to 1 pixel)
-static int width2  = 160 / 2; // RGBA packs two pairs
-static int height2 = 90;
-// -- From phase 2 to phase 3: average for easier cpu handling ???
-// -- 2x2 pixels to 1 pixel
-static int width3  = 80 / 2; // RGBA packs two pairs
-static int height3 = 45;
-#else
 // -- From phase 1 to phase 2: average
 // -- 8x8 pixels to 1 pixel (but sample 12x12 pixels to 1 pixel)
+// -- This is the grid that is read back. The downsampling is done in one
+// -- fused pass, or in a horizontal and a vertical pass (separable).
 static int width2  = 80 / 2; // RGBA packs two pairs
 static int height2 = 45;
-static int width3  = 80 / 2;
-static int height3 = 45;
-#endif
+// -- Separable phase 2: 8x1 pixels to 1 pixel (but sample 12x2)
+static int width2h  = 80 / 2; // RGBA packs two pairs
+static int height2h = 180;
 
 
 static GLfloat quad_varray[] = {
@@ -78,10 +72,31 @@ static GLuint quad_vbo; // vertex buffer object
 static GLuint fbo;      // frame buffer object for render-to-texture
 static GLuint rtt_tex1; // Texture for render-to-texture
 static GLuint rtt_tex2; // Texture for render-to-texture
-static GLuint rtt_tex3; // Texture for render-to-texture
+static GLuint rtt_tex2h; // Texture for render-to-texture, separable phase 2 only
+static GLuint rtt_ring[BALLTRACK_MAX_PIPELINE]; // Final filter targets, rtt_ring[0] is rtt_tex2
 static GLuint rtt_copytex;
+static GLuint* capture_tex; // Ring of the capture service, see BalltrackCapture.h
 
 static uint8_t* pixelbuffer; // For reading out result
+static BALLTRACK_GRID grid;  // Ball search in the result, see BalltrackGrid.h
+
+// Filter grid readback, see balltrack_core_set_pipeline
+static int pipelineDepth = 1;
+static int ringNext = 0;        // Target of the next filter passes
+static int ringShown = 0;       // Newest filter output, for the display pass
+// Targets rendered but not read back yet, oldest first. At most
+// pipelineDepth - 1, the remaining target takes the next filter passes.
+typedef struct {
+    int target;
+    uint64_t queued;            // When its passes were queued
+    uint32_t frame;
+} PENDING_READBACK;
+static PENDING_READBACK pending[BALLTRACK_MAX_PIPELINE];
+static int pendingCount = 0;
+
+// Render pass graph, see balltrack_core_set_passes
+static int separableGrid = 1;
+static int displayPass = 1;
 
 #define DEBUG 3
 // Autogenerated file containing all shaders
@@ -103,10 +118,18 @@ static SHADER_PROGRAM_T balltrack_shader_2 =
     .attribute_names = {"vertex"},
 };
 
-static SHADER_PROGRAM_T balltrack_shader_3 =
+static SHADER_PROGRAM_T balltrack_shader_2h =
+{
+    .vertex_source = (char*)vshader_vert,
+    .fragment_source = (char*)phase2_h_frag,
+    .uniform_names = {"tex", "tex_unit"},
+    .attribute_names = {"vertex"},
+};
+
+static SHADER_PROGRAM_T balltrack_shader_2v =
 {
     .vertex_source = (char*)vshader_vert,
-    .fragment_source = (char*)phase3_frag,
+    .fragment_source = (char*)phase2_v_frag,
     .uniform_names = {"tex", "tex_unit"},
     .attribute_names = {"vertex"},
 };
@@ -179,6 +202,17 @@ static GLuint createFilterTexture(int w, int h, GLint scaling) {
     return id;
 }
 
+// For sources that are plain GL_TEXTURE_2D. Replaces every
+// "samplerExternalOES" with "sampler2D         " and comments out the
+// extension directive, so drivers without the extension can build it.
+static void shader_use_sampler2D(char* source) {
+    char* pos = source;
+    while ((pos = strstr(pos, "samplerExternalOES")))
+        memcpy(pos, "sampler2D         ", 18);
+    if ((pos = strstr(source, "#extension GL_OES_EGL_image_external")))
+        memcpy(pos, "//", 2);
+}
+
 int balltrack_core_init(int externalSamplerExtension, int flipY)
 {
     int rc = 0;
@@ -187,22 +221,10 @@ int balltrack_core_init(int externalSamplerExtension, int flipY)
     printf("OpenGL renderer string: %s\n", glRenderer);
 
     if (externalSamplerExtension == 0) {
-        // Replace
-        // "samplerExternalOES"
-        // "sampler2D         "
-        char* pos = 0;
-        if ((pos = strstr(balltrack_shader_1.fragment_source, "samplerExternalOES"))){
-            memcpy(pos, "sampler2D         ", 18);
-        }
-        if ((pos = strstr(balltrack_shader_display.fragment_source, "samplerExternalOES"))){
-            memcpy(pos, "sampler2D         ", 18);
-        }
-        if ((pos = strstr(balltrack_shader_plain.fragment_source, "samplerExternalOES"))){
-            memcpy(pos, "sampler2D         ", 18);
-        }
-        if ((pos = strstr(balltrack_shader_diff.fragment_source, "samplerExternalOES"))){
-            memcpy(pos, "sampler2D         ", 18);
-        }
+        shader_use_sampler2D((char*)balltrack_shader_1.fragment_source);
+        shader_use_sampler2D((char*)balltrack_shader_display.fragment_source);
+        shader_use_sampler2D((char*)balltrack_shader_plain.fragment_source);
+        shader_use_sampler2D((char*)balltrack_shader_diff.fragment_source);
     }
 
     // Camera source is Y-flipped.
@@ -212,7 +234,6 @@ int balltrack_core_init(int externalSamplerExtension, int flipY)
         // Do not flip the render-to-texture textures ??
         //balltrack_shader_1.vertex_source = BALLTRACK_VSHADER_YFLIP_SOURCE;
         //balltrack_shader_2.vertex_source = BALLTRACK_VSHADER_YFLIP_SOURCE;
-        //balltrack_shader_3.vertex_source = BALLTRACK_VSHADER_YFLIP_SOURCE;
     }
 
     printf("Building shader `phase 1`\n");
@@ -231,13 +252,23 @@ int balltrack_core_init(int externalSamplerExtension, int flipY)
     if (rc != 0)
         goto end;
 
-    printf("Building shader `phase 3`\n");
-    rc = balltrack_build_shader_program(&balltrack_shader_3);
-    if (rc != 0)
-        goto end;
-    rc = shader_set_uniforms(&balltrack_shader_3, width2, height2, 1, 0);
-    if (rc != 0)
-        goto end;
+    if (separableGrid) {
+        printf("Building shader `phase 2 horizontal`\n");
+        rc = balltrack_build_shader_program(&balltrack_shader_2h);
+        if (rc != 0)
+            goto end;
+        rc = shader_set_uniforms(&balltrack_shader_2h, width1, height1, 1, 0);
+        if (rc != 0)
+            goto end;
+
+        printf("Building shader `phase 2 vertical`\n");
+        rc = balltrack_build_shader_program(&balltrack_shader_2v);
+        if (rc != 0)
+            goto end;
+        rc = shader_set_uniforms(&balltrack_shader_2v, width2h, height2h, 1, 0);
+        if (rc != 0)
+            goto end;
+    }
 
     printf("Building shader `display`\n");
     rc = balltrack_build_shader_program(&balltrack_shader_display);
@@ -248,7 +279,7 @@ int balltrack_core_init(int externalSamplerExtension, int flipY)
 #elif DEBUG == 2
     rc = shader_set_uniforms(&balltrack_shader_display, width2, height2, 1, 1);
 #else
-    rc = shader_set_uniforms(&balltrack_shader_display, width3, height3, 1, 1);
+    rc = shader_set_uniforms(&balltrack_shader_display, width2, height2, 1, 1);
 #endif
     if (rc != 0)
         goto end;
@@ -280,8 +311,10 @@ int balltrack_core_init(int externalSamplerExtension, int flipY)
         goto end;
     GLCHK(glUniform1i(balltrack_shader_diff.uniform_locations[1], 1)); // Texture unit
 
+    grid_init(&grid, width2, height2);
+
     // Buffer to read out pixels from last texture
-    uint32_t buffer_size = width3 * height3 * 4;
+    uint32_t buffer_size = width2 * height2 * 4;
     pixelbuffer = calloc(buffer_size, 1);
     if (!pixelbuffer) {
         rc = -1;
@@ -290,14 +323,13 @@ int balltrack_core_init(int externalSamplerExtension, int flipY)
 
     printf("Generating framebuffer object\n");
     // Create frame buffer object for render-to-texture
-    GLCHK(glGenFramebuffersOES(1, &fbo));
-    GLCHK(glBindFramebufferOES(GL_FRAMEBUFFER_OES, fbo));
-    GLCHK(glBindFramebufferOES(GL_FRAMEBUFFER_OES, 0)); // unbind it
+    GLCHK(glGenFramebuffers(1, &fbo));
+    GLCHK(glBindFramebuffer(GL_FRAMEBUFFER, fbo));
+    GLCHK(glBindFramebuffer(GL_FRAMEBUFFER, 0)); // unbind it
 
     printf("Creating render-to-texture targets\n");
     GLint tex1scaling = GL_LINEAR;
     GLint tex2scaling = GL_LINEAR;
-    GLint tex3scaling = GL_NEAREST;
 #if DEBUG == 1
     tex1scaling = GL_NEAREST;
 #elif DEBUG == 2
@@ -305,14 +337,31 @@ int balltrack_core_init(int externalSamplerExtension, int flipY)
 #endif
     rtt_tex1 = createFilterTexture(width1, height1, tex1scaling);
     rtt_tex2 = createFilterTexture(width2, height2, tex2scaling);
-#ifdef THREE_PHASES
-    rtt_tex3 = createFilterTexture(width3, height3, tex3scaling);
-#else
-    (void)tex3scaling;
-    rtt_tex3 = rtt_tex2; // hmmmm....
-#endif
+    // Sampled with GL_LINEAR by the vertical pass
+    if (separableGrid)
+        rtt_tex2h = createFilterTexture(width2h, height2h, GL_LINEAR);
     rtt_copytex = createFilterTexture(width0, height0, GL_NEAREST);
 
+    // Extra final targets for the pipelined readback
+    rtt_ring[0] = rtt_tex2;
+    for (int i = 1; i < pipelineDepth; ++i)
+        rtt_ring[i] = createFilterTexture(width2, height2, tex2scaling);
+    if (pipelineDepth > 1)
+        printf("Filter grid readback pipelined over %d targets\n", pipelineDepth);
+
+    if (capture_enabled()) {
+        int w, h, count = capture_get_slots();
+        capture_get_size(&w, &h);
+        printf("Creating %d capture textures of %dx%d\n", count, w, h);
+        capture_tex = calloc(count, sizeof(GLuint));
+        if (!capture_tex) {
+            rc = -1;
+            goto end;
+        }
+        for (int i = 0; i < count; ++i)
+            capture_tex[i] = createFilterTexture(w, h, GL_NEAREST);
+    }
+
     printf("Creating vertex-buffer object\n");
     GLCHK(glGenBuffers(1, &quad_vbo));
     GLCHK(glBindBuffer(GL_ARRAY_BUFFER, quad_vbo));
@@ -327,7 +376,7 @@ end:
 }
 
 // x,y are coordinates in [-1,1]x[-1,1] range
-void draw_line_strip(POINT* xys, int count, uint32_t color) {
+static void draw_line_strip(POINT* xys, int count, uint32_t color) {
     if (count == 0)
         return;
 
@@ -350,7 +399,7 @@ void draw_line_strip(POINT* xys, int count, uint32_t color) {
 }
 
 // x,y are coordinates in [-1,1]x[-1,1] range
-void draw_square(float xmin, float xmax, float ymin, float ymax, uint32_t color) {
+static void draw_square(float xmin, float xmax, float ymin, float ymax, uint32_t color) {
     // Draw a square
     POINT vertexBuffer[5];
     vertexBuffer[0].x = xmin;
@@ -366,13 +415,15 @@ void draw_square(float xmin, float xmax, float ymin, float ymax, uint32_t color)
     draw_line_strip(vertexBuffer, 5, color);
 }
 
+static const ANALYSIS_DRAW_OPS overlay_ops = { draw_square, draw_line_strip };
+
 // If target_tex is zero, then target is the screen
 static int render_pass(SHADER_PROGRAM_T* shader, GLuint source_type, GLuint source_tex, GLuint target_tex, int targetWidth, int targetHeight) {
     GLCHK(glUseProgram(shader->program));
     if (target_tex) {
         // Enable Render-to-texture and set the output texture
-        GLCHK(glBindFramebufferOES(GL_FRAMEBUFFER_OES, fbo));
-        GLCHK(glFramebufferTexture2DOES(GL_FRAMEBUFFER_OES, GL_COLOR_ATTACHMENT0_OES, GL_TEXTURE_2D, target_tex, 0));
+        GLCHK(glBindFramebuffer(GL_FRAMEBUFFER, fbo));
+        GLCHK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target_tex, 0));
         GLCHK(glViewport(0, 0, targetWidth, targetHeight));
         // According to the open source GL driver for the VC4 chip,
         // [ https://github.com/anholt/mesa/wiki/VC4-Performance-Tricks ],
@@ -380,7 +431,7 @@ static int render_pass(SHADER_PROGRAM_T* shader, GLuint source_type, GLuint sour
         glClear(GL_COLOR_BUFFER_BIT);
     } else {
         // Unset frame buffer object. Now draw to screen
-        GLCHK(glBindFramebufferOES(GL_FRAMEBUFFER_OES, 0));
+        GLCHK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
         GLCHK(glViewport(0, 0, targetWidth, targetHeight));
         glClear(GL_COLOR_BUFFER_BIT); // See above comment
     }
@@ -398,167 +449,207 @@ static int render_pass(SHADER_PROGRAM_T* shader, GLuint source_type, GLuint sour
 
 static int frameNumber = 0;
 
+// Tracker load plan, see balltrack_core_set_plan
+static int filterDivider = 1;
+static int roiMode = 0;
+
+static BALLTRACK_TIMINGS timings;
+// GLES2 has no timer queries, so GPU idle time is estimated on the CPU:
+// after a glReadPixels of the frame just queued the GPU has nothing left
+// to do until the next pass is queued. In the pipelined mode the passes
+// of the current frame are queued before the readback of the previous
+// one, so that time is not counted. A driver that flushes everything on
+// any readback shows up as a readback stall as long as the synchronous one.
+static BALLTRACK_STATS stats;
+static uint64_t statsFirst;
+
 static int balltrack_readout(int width, int height) {
     // Read texture
     // It packs two pixels into one:
     // RGBA is red,green,red,green filter values for neighbouring pixels
-    if (pixelbuffer) {
-        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixelbuffer);
-        if (glGetError() == GL_NO_ERROR) {
-            // pixelbuffer[i*height + j] is i pixels from bottom and j from left
-            int gxmin = (int)(0.45f * 2.0f * width);
-            int gxmax = (int)(0.55f * 2.0f * width);
-            int gymin = (int)(0.45f * height);
-            int gymax = (int)(0.55f * height);
-
-            uint32_t* ptr = (uint32_t*)pixelbuffer;
-            for (int i = 0; i < height; ++i) {
-                for (int j = 0; j < width; ++j) {
-                    // R,G,B,A = FF, 00, FF, FF
-                    uint32_t rgba = *ptr++;
-                    //int R1 = (rgba      ) & 0xff;
-                    int G1 = (rgba >>  8) & 0xff;
-                    //int R2 = (rgba >> 16) & 0xff;
-                    int G2 = (rgba >> 24) & 0xff;
-
-                    int y = i;
-                    int x1 = 2*j;
-                    int x2 = 2*j + 1;
-                    // This part could be optimized...
-                    // - y min/max check only once
-                    // - if x1<gxmin then x2 does not need to be checked
-                    // - ...
-                    if (G1 > 140) {
-                        if (x1 < gxmin) gxmin = x1;
-                        if (x1 > gxmax) gxmax = x1;
-                        if (y < gymin) gymin = y;
-                        if (y > gymax) gymax = y;
-                    }
-                    if (G2 > 140) {
-                        if (x2 < gxmin) gxmin = x2;
-                        if (x2 > gxmax) gxmax = x2;
-                        if (y < gymin) gymin = y;
-                        if (y > gymax) gymax = y;
-                    }
-                }
-            }
-            gxmin -= 4;
-            gxmax += 4;
-            gymin -= 3;
-            gymax += 3;
-            if (gxmin < 0) gxmin = 0;
-            if (gymin < 0) gymin = 0;
-            if (gxmax > 2*width-1) gxmax = 2*width - 1;
-            if (gymax > height) gymax = height;
-
-            // Map to [-1,1]
-            FIELD field;
-            field.xmin = gxmin / ((float)width) - 1.0f;
-            field.xmax = gxmax / ((float)width) - 1.0f;
-            field.ymin = (2.0f * gymin) / ((float)height) - 1.0f;
-            field.ymax = (2.0f * gymax) / ((float)height) - 1.0f;
-
-            // Find the max orange intensity
-            uint32_t maxx = 0, maxy = 0;
-            uint32_t maxR = 0;
-            ptr = (uint32_t*)pixelbuffer;
-            for (int i = 0; i < height; ++i) {
-                for (int j = 0; j < width; ++j) {
-                    // R,G,B,A = FF, 00, FF, FF
-                    uint32_t rgba = *ptr++;
-                    int R1 = (rgba      ) & 0xff;
-                    //int G1 = (rgba >>  8) & 0xff;
-                    int R2 = (rgba >> 16) & 0xff;
-                    //int G2 = (rgba >> 24) & 0xff;
-                    int y = i;
-                    int x1 = 2*j;
-                    int x2 = 2*j + 1;
-                    if ( y < gymin || y > gymax ) continue;
-                    if ( x1 < gxmin || x2 > gxmax ) continue;
-                    if (R1 > maxR) {
-                        maxx = x1;
-                        maxy = y;
-                        maxR = R1;
-                    }
-                    if (R2 > maxR) {
-                        maxx = x2;
-                        maxy = y;
-                        maxR = R2;
-                    }
-                }
-            }
-            // Take weighted average near the maximum
-            int searchImin = maxy - 4;
-            int searchImax = maxy + 4;
-            int searchJmin = maxx/2 - 3;
-            int searchJmax = (maxx+1)/2 + 3;
-            if (searchImin < 0) searchImin = 0;
-            if (searchJmin < 0) searchJmin = 0;
-            if (searchImax > height) searchImax = height;
-            if (searchJmax > width ) searchJmax = width;
-
-            uint32_t avgx = 0, avgy = 0;
-            uint32_t weight = 0;
-            uint32_t count = 0;
-            ptr = (uint32_t*)pixelbuffer;
-            for (int i = searchImin; i < searchImax; ++i) {
-                for (int j = searchJmin; j < searchJmax; ++j) {
-                    // R,G,B,A = FF, 00, FF, FF
-                    uint32_t rgba = ptr[i * width + j];
-                    int R1 = (rgba      ) & 0xff;
-                    //int G1 = (rgba >>  8) & 0xff;
-                    int R2 = (rgba >> 16) & 0xff;
-                    //int G2 = (rgba >> 24) & 0xff;
-                    int y = i;
-                    int x1 = 2*j;
-                    int x2 = 2*j + 1;
-                    avgx += x1 * R1;
-                    avgy += y  * R1;
-                    weight += R1;
-                    avgx += x2 * R2;
-                    avgy += y  * R2;
-                    weight += R2;
-                    count++;
-                }
-            }
-
-            int threshold1 = 30;
-            int threshold2 = 60;
-
-            // avgx, avgy are the bottom-left corner of the macropixels
-            // Shift them by half a pixel to fix
-            // Then, map them to [-1,1] range
-            float x = 0.5f + (((float)avgx) / ((float)weight));
-            float y = 0.5f + (((float)avgy) / ((float)weight));
-            POINT ball;
-            ball.x = x / ((float)width) - 1.0f;
-            ball.y = (2.0f * y) / ((float)height) - 1.0f;
-
-            if (maxR > threshold1 && weight > threshold2) {
-                analysis_update(field, ball, 1);
-            } else {
-                analysis_update(field, ball, 0);
-            }
-        } else {
-            printf("glReadPixels failed!");
-        }
+    if (!pixelbuffer)
+        return 0;
+
+    // The rectangle that is read back, in packed grid coordinates
+    int x0, y0, w, h;
+    int fullReadout = grid_window(&grid, frameNumber, roiMode, &x0, &y0, &w, &h);
+
+    uint64_t t0 = balltrack_time_us();
+    glReadPixels(x0, y0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixelbuffer);
+    if (glGetError() != GL_NO_ERROR) {
+        printf("glReadPixels failed!");
+        return 0;
+    }
+    uint64_t t1 = balltrack_time_us();
+
+    grid_analyse(&grid, (uint32_t*)pixelbuffer, x0, y0, w, h, fullReadout);
+
+    uint64_t t2 = balltrack_time_us();
+    timings.readout_us = (uint32_t)(t1 - t0);
+    timings.analysis_us = (uint32_t)(t2 - t1);
+    return 0;
+}
+
+// Keep this frame in the capture ring. Filter output is copied from
+// rtt_tex1 while it is still attached after the phase 1 pass.
+static void balltrack_capture_store(GLuint srctype, GLuint srctex) {
+    int slot = capture_begin_frame(frameNumber);
+    if (slot < 0)
+        return;
+
+    if (capture_get_kind() == CAPTURE_FILTER) {
+        GLCHK(glActiveTexture(GL_TEXTURE0));
+        GLCHK(glBindTexture(GL_TEXTURE_2D, capture_tex[slot]));
+        GLCHK(glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width1, height1));
+    } else {
+        render_pass(&balltrack_shader_plain, srctype, srctex, capture_tex[slot], CAPTURE_SOURCE_WIDTH, CAPTURE_SOURCE_HEIGHT);
+    }
+}
+
+// Read back at most one frozen capture frame per rendered frame. Its
+// rendering was finished frames ago, so this costs the copy only.
+static void balltrack_capture_readback() {
+    uint8_t* pixels;
+    int slot = capture_next_readback(&pixels);
+    if (slot < 0)
+        return;
+
+    int w, h;
+    capture_get_size(&w, &h);
+    uint64_t t0 = balltrack_time_us();
+    GLCHK(glBindFramebuffer(GL_FRAMEBUFFER, fbo));
+    GLCHK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, capture_tex[slot], 0));
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    if (glGetError() != GL_NO_ERROR)
+        printf("Capture: glReadPixels failed!\n");
+    capture_readback_done(slot, (uint32_t)(balltrack_time_us() - t0));
+}
+
+static void delete_shader(SHADER_PROGRAM_T* shader) {
+    if (!shader->program)
+        return;
+    GLCHK(glDeleteProgram(shader->program));
+    GLCHK(glDeleteShader(shader->vs));
+    GLCHK(glDeleteShader(shader->fs));
+    shader->program = shader->vs = shader->fs = 0;
+}
+
+void balltrack_core_term()
+{
+    delete_shader(&balltrack_shader_1);
+    delete_shader(&balltrack_shader_2);
+    delete_shader(&balltrack_shader_2h);
+    delete_shader(&balltrack_shader_2v);
+    delete_shader(&balltrack_shader_display);
+    delete_shader(&balltrack_shader_fixedcolor);
+    delete_shader(&balltrack_shader_plain);
+    delete_shader(&balltrack_shader_diff);
+
+    GLCHK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GLCHK(glDeleteFramebuffers(1, &fbo));
+    GLCHK(glDeleteBuffers(1, &quad_vbo));
+    // rtt_ring[0] is rtt_tex2
+    for (int i = 1; i < pipelineDepth; ++i)
+        GLCHK(glDeleteTextures(1, &rtt_ring[i]));
+    GLCHK(glDeleteTextures(1, &rtt_tex1));
+    GLCHK(glDeleteTextures(1, &rtt_tex2));
+    if (rtt_tex2h)
+        GLCHK(glDeleteTextures(1, &rtt_tex2h));
+    GLCHK(glDeleteTextures(1, &rtt_copytex));
+    if (capture_tex) {
+        GLCHK(glDeleteTextures(capture_get_slots(), capture_tex));
+        free(capture_tex);
     }
+    free(pixelbuffer);
+
+    fbo = quad_vbo = rtt_tex1 = rtt_tex2 = rtt_tex2h = rtt_copytex = 0;
+    memset(rtt_ring, 0, sizeof(rtt_ring));
+    capture_tex = 0;
+    pixelbuffer = 0;
+    ringNext = ringShown = 0;
+    pendingCount = 0;
+    frameNumber = 0;
+    memset(&timings, 0, sizeof(timings));
+    memset(&stats, 0, sizeof(stats));
+}
+
+int balltrack_core_set_pipeline(int targets) {
+    if (targets < 1)
+        targets = 1;
+    if (targets > BALLTRACK_MAX_PIPELINE)
+        targets = BALLTRACK_MAX_PIPELINE;
+    pipelineDepth = targets;
     return 0;
 }
 
+int balltrack_core_get_pipeline() {
+    return pipelineDepth;
+}
+
+int balltrack_core_set_passes(int separable, int display) {
+    separableGrid = separable;
+    displayPass = display;
+    return 0;
+}
+
+int balltrack_core_set_plan(int divider, int roi) {
+    if (divider < 1)
+        divider = 1;
+    filterDivider = divider;
+    roiMode = roi;
+    return 0;
+}
+
+const BALLTRACK_TIMINGS* balltrack_core_get_timings() {
+    return &timings;
+}
+
+void balltrack_core_get_stats(BALLTRACK_STATS* out) {
+    *out = stats;
+}
+
+void balltrack_core_print_stats() {
+    if (stats.frames < 2)
+        return;
+    double seconds = stats.elapsed_us / 1000000.0;
+    double analysed = stats.analysed ? (double)stats.analysed : 1.0;
+    printf("Tracker %s readback: %u frames in %.1f s (%.1f fps), %u analysed\n",
+            pipelineDepth > 1 ? "pipelined" : "synchronous",
+            stats.frames, seconds, seconds > 0.0 ? (stats.frames - 1) / seconds : 0.0, stats.analysed);
+    printf("  latency %.2f ms, readback stall %.2f ms, redraw %.2f ms, GPU idle %.1f%% (estimated)\n",
+            stats.latency_us / analysed / 1000.0, stats.readout_us / analysed / 1000.0,
+            stats.redraw_us / (double)stats.frames / 1000.0,
+            stats.elapsed_us ? 100.0 * stats.idle_us / stats.elapsed_us : 0.0);
+}
+
+int balltrack_core_get_ball(POINT* ball) {
+    if (ball)
+        *ball = grid.ball;
+    return grid.found;
+}
+
+void balltrack_core_get_grid_size(int* width, int* height) {
+    *width = width2;
+    *height = height2;
+}
+
+int balltrack_core_read_grid(uint8_t* rgba) {
+    GLCHK(glBindFramebuffer(GL_FRAMEBUFFER, fbo));
+    GLCHK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rtt_ring[ringShown], 0));
+    glReadPixels(0, 0, width2, height2, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    return glGetError() == GL_NO_ERROR ? 0 : -1;
+}
+
 // Same but called from video player version
 int balltrack_core_redraw(int width, int height, GLuint srctex, GLuint srctype)
 {
     ++frameNumber;
     // Width,height is the size of the preview window
+    uint64_t start = balltrack_time_us();
 
-#ifdef DO_FRAMEDUMP
-    if (frameNumber == 60) {
-        render_pass(&balltrack_shader_plain, srctype, srctex, 0, width, height);
-        dump_frame(width, height, "framedump.tga");
-        printf("Frame dumped to framedump.tga\n");
-    }
-#endif
+    // Before any new work is queued, so it does not wait for this frame
+    if (capture_tex)
+        balltrack_capture_readback();
 
 #if DO_DIFF
     // Diff with previous
@@ -570,29 +661,88 @@ int balltrack_core_redraw(int width, int height, GLuint srctex, GLuint srctype)
     render_pass(&balltrack_shader_plain, srctype, srctex, rtt_copytex, width0, height0);
 #endif
 
-    // First pass: hue filter into smaller texture
-    render_pass(&balltrack_shader_1, srctype,       srctex,   rtt_tex1, width1, height1);
-    // Second pass: dilate red players
-    render_pass(&balltrack_shader_2, GL_TEXTURE_2D, rtt_tex1, rtt_tex2, width2, height2);
-#ifdef THREE_PHASES
-    // Third pass: downsample
-    render_pass(&balltrack_shader_3, GL_TEXTURE_2D, rtt_tex2, rtt_tex3, width3, height3);
-#endif
-    // Readout result
-    balltrack_readout(width3, height3);
-    // Third pass: render to screen
-    GLCHK(glActiveTexture(GL_TEXTURE1));
+    if (capture_tex && capture_get_kind() == CAPTURE_SOURCE)
+        balltrack_capture_store(srctype, srctex);
+
+    uint64_t t0 = balltrack_time_us();
+    int queued = -1;
+    timings.filtered = 0;
+    timings.filter_us = timings.readout_us = timings.analysis_us = 0;
+    if (frameNumber % filterDivider == 0) {
+        GLuint target = rtt_ring[ringNext];
+        // First pass: hue filter into smaller texture
+        render_pass(&balltrack_shader_1, srctype,       srctex,   rtt_tex1, width1, height1);
+        if (capture_tex && capture_get_kind() == CAPTURE_FILTER)
+            balltrack_capture_store(srctype, srctex);
+        // Second pass: downsample to the grid
+        if (separableGrid) {
+            render_pass(&balltrack_shader_2h, GL_TEXTURE_2D, rtt_tex1,  rtt_tex2h, width2h, height2h);
+            render_pass(&balltrack_shader_2v, GL_TEXTURE_2D, rtt_tex2h, target,    width2,  height2);
+        } else {
+            render_pass(&balltrack_shader_2, GL_TEXTURE_2D, rtt_tex1, target, width2, height2);
+        }
+        // Only measures command submission, the GPU work is
+        // waited for by glReadPixels in the readout
+        timings.filter_us = (uint32_t)(balltrack_time_us() - t0);
+        queued = ringNext;
+        ringShown = ringNext;
+        ringNext = (ringNext + 1) % pipelineDepth;
+    }
+
+    if (pipelineDepth == 1 && queued >= 0) {
+        // Readout result, the target is still attached
+        balltrack_readout(width2, height2);
+        timings.filtered = 1;
+        timings.delay = 0;
+        timings.latency_us = (uint32_t)(balltrack_time_us() - t0);
+        // Nothing queued until the display pass
+        stats.idle_us += timings.analysis_us;
+    } else if (pendingCount > 0 && (queued < 0 || pendingCount == pipelineDepth - 1)) {
+        // Oldest filtered frame, finished while the newer ones were queued.
+        // Frames without filter passes read back one as well, so the
+        // results do not fall further behind.
+        GLCHK(glBindFramebuffer(GL_FRAMEBUFFER, fbo));
+        GLCHK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rtt_ring[pending[0].target], 0));
+        balltrack_readout(width2, height2);
+        timings.filtered = 1;
+        timings.delay = frameNumber - pending[0].frame;
+        timings.latency_us = (uint32_t)(balltrack_time_us() - pending[0].queued);
+        --pendingCount;
+        memmove(pending, pending + 1, pendingCount * sizeof(pending[0]));
+    }
+    if (pipelineDepth > 1 && queued >= 0) {
+        pending[pendingCount].target = queued;
+        pending[pendingCount].queued = t0;
+        pending[pendingCount].frame = frameNumber;
+        ++pendingCount;
+    }
+
+    uint64_t t1 = balltrack_time_us();
+    // Last pass: render to screen, not needed without a preview window
+    if (displayPass) {
+        GLCHK(glActiveTexture(GL_TEXTURE1));
 #if DEBUG == 1
-    GLCHK(glBindTexture(GL_TEXTURE_2D, rtt_tex1));
-#elif DEBUG == 2
-    GLCHK(glBindTexture(GL_TEXTURE_2D, rtt_tex2));
+        GLCHK(glBindTexture(GL_TEXTURE_2D, rtt_tex1));
 #else
-    GLCHK(glBindTexture(GL_TEXTURE_2D, rtt_tex3));
+        GLCHK(glBindTexture(GL_TEXTURE_2D, rtt_ring[ringShown]));
 #endif
-    render_pass(&balltrack_shader_display, srctype, srctex, 0, width, height);
+        render_pass(&balltrack_shader_display, srctype, srctex, 0, width, height);
 
-    analysis_draw();
+        analysis_draw(&overlay_ops);
+    }
+    uint64_t end = balltrack_time_us();
+    timings.display_us = (uint32_t)(end - t1);
+
+    if (!stats.frames)
+        statsFirst = start;
+    ++stats.frames;
+    stats.elapsed_us = start - statsFirst;
+    stats.redraw_us += end - start;
+    if (timings.filtered) {
+        ++stats.analysed;
+        stats.readout_us += timings.readout_us;
+        stats.latency_us += timings.latency_us;
+    }
 
     return 0;
 }
-
@@ -31,8 +31,62 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define BALLTRACKCORE_H
 
 #include "BalltrackUtil.h"
+#include "BallAnalysis.h"
+
+// Time spent in each stage of the last frame, in microseconds
+typedef struct {
+    uint32_t filter_us;   // Offscreen filter passes (command submission only)
+    uint32_t readout_us;  // glReadPixels, includes waiting for the GPU
+    uint32_t analysis_us; // Search in the filter grid and BallAnalysis
+    uint32_t display_us;  // Display pass and overlay
+    uint32_t latency_us;  // From queuing the filter passes to the end of the analysis
+    int filtered;         // Zero if no filter result was analysed this frame
+    int delay;            // Frames between the analysed frame and this one
+} BALLTRACK_TIMINGS;
+
+// Totals since the first frame, for comparing readback modes
+typedef struct {
+    uint32_t frames;      // Frames drawn
+    uint32_t analysed;    // Filter results analysed
+    uint64_t elapsed_us;  // First to last frame
+    uint64_t redraw_us;   // CPU time in balltrack_core_redraw
+    uint64_t readout_us;  // CPU blocked in glReadPixels of the filter grid
+    uint64_t latency_us;  // Sum of the latencies of the analysed frames
+    uint64_t idle_us;     // Estimated time the GPU had no work queued, see BalltrackCore.c
+} BALLTRACK_STATS;
 
 int balltrack_core_init(int externalSamplerExtension, int flipY);
 int balltrack_core_redraw(int width, int height, GLuint srctex, GLuint srctype);
+// Deletes the GL objects, in the same context. The settings below are
+// kept, so balltrack_core_init can be called again with new ones.
+void balltrack_core_term();
+
+// Run the filter passes only every `divider` frames, and read back only
+// a window around the last ball position when `roi` is nonzero.
+int balltrack_core_set_plan(int divider, int roi);
+// Filter grid readback. With 1 target the grid is read back right after
+// the filter passes are queued, which waits for the GPU to finish them.
+// With N > 1 the passes render into a ring of N targets and the grid of
+// the filtered frame N - 1 filtered frames back is read back instead,
+// later but without stalling the GPU. More targets give a slow GPU more
+// time at the cost of latency. Call before balltrack_core_init.
+#define BALLTRACK_MAX_PIPELINE 4
+int balltrack_core_set_pipeline(int targets);
+int balltrack_core_get_pipeline();
+// Render pass graph, call before balltrack_core_init. With `separable`
+// the 12x12 grid filter runs as a horizontal and a vertical pass instead
+// of one fused pass. Without `display` the camera frame and overlay are
+// not drawn, for when there is no preview window.
+int balltrack_core_set_passes(int separable, int display);
+const BALLTRACK_TIMINGS* balltrack_core_get_timings();
+void balltrack_core_get_stats(BALLTRACK_STATS* stats);
+void balltrack_core_print_stats();
+// Returns nonzero if the ball was found in the last analysed frame
+int balltrack_core_get_ball(POINT* ball);
+
+// Whole filter grid of the last filtered frame, RGBA as in the readout,
+// bottom row first. Waits for the GPU, so for tools and not per frame.
+void balltrack_core_get_grid_size(int* width, int* height);
+int balltrack_core_read_grid(uint8_t* rgba);
 
 #endif /* BALLTRACKCORE_H */
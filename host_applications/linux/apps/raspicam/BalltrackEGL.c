@@ -0,0 +1,95 @@
+#include "BalltrackEGL.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+typedef EGLDisplay (*get_platform_display_fn)(EGLenum platform, void* native_display, const EGLint* attrib_list);
+
+static int has_extension(const char* extensions, const char* name) {
+    size_t len = strlen(name);
+    const char* pos = extensions;
+    while (pos && (pos = strstr(pos, name))) {
+        if ((pos == extensions || pos[-1] == ' ') && (pos[len] == ' ' || pos[len] == 0))
+            return 1;
+        pos += len;
+    }
+    return 0;
+}
+
+int balltrack_egl_init(BALLTRACK_EGL* egl, int width, int height) {
+    static const EGLint pbufferConfig[] = {
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_NONE
+    };
+    static const EGLint anyConfig[] = {
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_NONE
+    };
+    static const EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+    const EGLint pbufferAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    EGLConfig config;
+    EGLint count = 0;
+
+    egl->display = EGL_NO_DISPLAY;
+    egl->context = EGL_NO_CONTEXT;
+    egl->surface = EGL_NO_SURFACE;
+
+    // Without a window system the surfaceless platform always works, the
+    // default display needs X or a render node that Mesa can pick
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (clientExtensions && has_extension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        get_platform_display_fn getPlatformDisplay =
+            (get_platform_display_fn)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            egl->display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (egl->display == EGL_NO_DISPLAY)
+        egl->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (egl->display == EGL_NO_DISPLAY || !eglInitialize(egl->display, NULL, NULL)) {
+        printf("Unable to initialise EGL: 0x%x\n", eglGetError());
+        return -1;
+    }
+    eglBindAPI(EGL_OPENGL_ES_API);
+
+    int pbuffer = eglChooseConfig(egl->display, pbufferConfig, &config, 1, &count) && count > 0;
+    if (!pbuffer && !(eglChooseConfig(egl->display, anyConfig, &config, 1, &count) && count > 0)) {
+        printf("No EGL config for OpenGL ES 2\n");
+        return -1;
+    }
+    egl->context = eglCreateContext(egl->display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (egl->context == EGL_NO_CONTEXT) {
+        printf("Unable to create an OpenGL ES 2 context: 0x%x\n", eglGetError());
+        return -1;
+    }
+    if (pbuffer)
+        egl->surface = eglCreatePbufferSurface(egl->display, config, pbufferAttribs);
+    if (egl->surface == EGL_NO_SURFACE &&
+            !has_extension(eglQueryString(egl->display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        printf("Neither a pbuffer nor a surfaceless context is available\n");
+        return -1;
+    }
+    if (!eglMakeCurrent(egl->display, egl->surface, egl->surface, egl->context)) {
+        printf("Unable to make the context current: 0x%x\n", eglGetError());
+        return -1;
+    }
+    printf("EGL %s, %s\n", eglQueryString(egl->display, EGL_VERSION),
+            egl->surface == EGL_NO_SURFACE ? "surfaceless" : "pbuffer");
+    return 0;
+}
+
+void balltrack_egl_term(BALLTRACK_EGL* egl) {
+    if (egl->display == EGL_NO_DISPLAY)
+        return;
+    eglMakeCurrent(egl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (egl->surface != EGL_NO_SURFACE)
+        eglDestroySurface(egl->display, egl->surface);
+    if (egl->context != EGL_NO_CONTEXT)
+        eglDestroyContext(egl->display, egl->context);
+    eglTerminate(egl->display);
+}
@@ -0,0 +1,20 @@
+#ifndef BALLTRACKEGL_H
+#define BALLTRACKEGL_H
+
+#include <EGL/egl.h>
+
+// OpenGL ES 2 context without a window, for the tools that run the GLES
+// backend on files. Uses the Mesa surfaceless platform when it is there,
+// with a pbuffer of width x height as the default framebuffer for the
+// display pass, or no surface at all if there is no pbuffer config.
+
+typedef struct {
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;     // Pbuffer, or EGL_NO_SURFACE if surfaceless
+} BALLTRACK_EGL;
+
+int balltrack_egl_init(BALLTRACK_EGL* egl, int width, int height);
+void balltrack_egl_term(BALLTRACK_EGL* egl);
+
+#endif /* BALLTRACKEGL_H */
@@ -0,0 +1,179 @@
+#include "BalltrackGovernor.h"
+#include "BalltrackCore.h"
+#include <math.h>
+#include <stdio.h>
+
+// Per profile settings
+typedef struct {
+    const char* name;
+    int framerateNum;   // Framerate is maxFramerate * num / 4
+    int filterDivider;  // See balltrack_core_set_plan
+    int roi;
+} GOVERNOR_SETTINGS;
+
+static const GOVERNOR_SETTINGS profiles[GOVERNOR_PROFILE_COUNT] = {
+    { "idle",  2, 2, 0 },
+    { "serve", 3, 1, 1 },
+    { "rally", 4, 1, 1 },
+};
+
+// Hysteresis, in microseconds unless noted otherwise
+// Ball speed in field units ([-1,1] coordinates) per second
+#define RALLY_SPEED         1.5f
+#define SERVE_SPEED         0.5f
+#define BALL_SEEN_FRAMES    3           // Analysed frames with ball before leaving IDLE
+#define RALLY_TO_SERVE_US   3000000     // Slow ball for this long
+#define SERVE_TO_IDLE_US    10000000    // No ball for this long
+
+// Number of frames after a switch before the settled timings are logged
+#define SETTLE_FRAMES 50
+
+static int enabled = 0;
+static int maxFramerate = 0;
+static governor_set_framerate_fn setFramerate = 0;
+static void* setFramerateData = 0;
+
+static GOVERNOR_PROFILE profile = GOVERNOR_RALLY;
+
+static uint64_t lastFrameTime = 0;
+static uint64_t lastBallTime = 0;
+static uint64_t lastFastTime = 0;
+static POINT lastBall;
+static int lastBallValid = 0;
+static int ballSeenCount = 0;
+static float speed = 0.0f;
+
+// Exponential moving averages, in microseconds
+static float avgInterval = 0.0f;
+static float avgTracker = 0.0f;
+
+// Measurement of the last switch
+static int settleCount = -1;
+static float switchInterval = 0.0f;
+static float switchTracker = 0.0f;
+static GOVERNOR_PROFILE switchFrom;
+
+static int profile_framerate(GOVERNOR_PROFILE p) {
+    int fps = (maxFramerate * profiles[p].framerateNum) / 4;
+    return fps < 1 ? 1 : fps;
+}
+
+static void governor_apply(GOVERNOR_PROFILE p) {
+    const GOVERNOR_SETTINGS* s = &profiles[p];
+    balltrack_core_set_plan(s->filterDivider, s->roi);
+    // The analysis runs at framerateNum / 4 of the rally rate, divided by the filter
+    analysis_set_frame_scale(4.0f * s->filterDivider / s->framerateNum);
+    if (setFramerate)
+        setFramerate(setFramerateData, profile_framerate(p));
+}
+
+static void governor_switch(GOVERNOR_PROFILE p, uint64_t now) {
+    printf("Governor: %s -> %s (%d fps), frame interval %.1f ms, tracker %.2f ms, speed %.2f\n",
+            profiles[profile].name, profiles[p].name, profile_framerate(p),
+            avgInterval / 1000.0f, avgTracker / 1000.0f, speed);
+    switchFrom = profile;
+    switchInterval = avgInterval;
+    switchTracker = avgTracker;
+    settleCount = SETTLE_FRAMES;
+    profile = p;
+    // Restart the hysteresis timers from the switch
+    lastFastTime = now;
+    lastBallTime = now;
+    lastBallValid = 0;
+    ballSeenCount = 0;
+    governor_apply(p);
+}
+
+int governor_init(int maxFps, governor_set_framerate_fn fn, void* userdata) {
+    enabled = 1;
+    maxFramerate = maxFps > 0 ? maxFps : 30;
+    setFramerate = fn;
+    setFramerateData = userdata;
+    profile = GOVERNOR_RALLY;
+    lastFrameTime = 0;
+    lastBallValid = 0;
+    settleCount = -1;
+    // Start at full rate, it will go down when nothing happens
+    balltrack_core_set_plan(profiles[profile].filterDivider, profiles[profile].roi);
+    analysis_set_frame_scale(1.0f);
+    return 0;
+}
+
+GOVERNOR_PROFILE governor_get_profile() {
+    return profile;
+}
+
+int governor_update() {
+    if (!enabled)
+        return 0;
+
+    uint64_t now = balltrack_time_us();
+    if (lastFrameTime == 0) {
+        lastFrameTime = lastBallTime = lastFastTime = now;
+        return 0;
+    }
+    float interval = (float)(now - lastFrameTime);
+    lastFrameTime = now;
+
+    const BALLTRACK_TIMINGS* t = balltrack_core_get_timings();
+    float tracker = (float)(t->filter_us + t->readout_us + t->analysis_us + t->display_us);
+    if (avgInterval == 0.0f) {
+        avgInterval = interval;
+        avgTracker = tracker;
+    } else {
+        avgInterval = 0.9f * avgInterval + 0.1f * interval;
+        avgTracker = 0.9f * avgTracker + 0.1f * tracker;
+    }
+
+    if (settleCount > 0 && --settleCount == 0) {
+        printf("Governor: settled in %s after %s, frame interval %.1f ms (%+.1f ms), tracker %.2f ms (%+.2f ms)\n",
+                profiles[profile].name, profiles[switchFrom].name,
+                avgInterval / 1000.0f, (avgInterval - switchInterval) / 1000.0f,
+                avgTracker / 1000.0f, (avgTracker - switchTracker) / 1000.0f);
+    }
+
+    // Nothing new to decide on frames where the filter was skipped
+    if (!t->filtered)
+        return 0;
+
+    POINT ball;
+    if (balltrack_core_get_ball(&ball)) {
+        if (lastBallValid) {
+            float dt = (now - lastBallTime) / 1000000.0f;
+            float dx = ball.x - lastBall.x;
+            float dy = ball.y - lastBall.y;
+            if (dt > 0.0f)
+                speed = 0.7f * speed + 0.3f * (sqrtf(dx * dx + dy * dy) / dt);
+        }
+        lastBall = ball;
+        lastBallValid = 1;
+        lastBallTime = now;
+        ++ballSeenCount;
+    } else {
+        lastBallValid = 0;
+        ballSeenCount = 0;
+        speed = 0.0f;
+    }
+    if (speed > SERVE_SPEED)
+        lastFastTime = now;
+
+    switch (profile) {
+        case GOVERNOR_IDLE:
+            if (ballSeenCount >= BALL_SEEN_FRAMES)
+                governor_switch(speed > RALLY_SPEED ? GOVERNOR_RALLY : GOVERNOR_SERVE, now);
+            break;
+        case GOVERNOR_SERVE:
+            if (speed > RALLY_SPEED)
+                governor_switch(GOVERNOR_RALLY, now);
+            else if (now - lastBallTime > SERVE_TO_IDLE_US)
+                governor_switch(GOVERNOR_IDLE, now);
+            break;
+        case GOVERNOR_RALLY:
+            if (now - lastFastTime > RALLY_TO_SERVE_US)
+                governor_switch(GOVERNOR_SERVE, now);
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef BALLTRACKGOVERNOR_H
+#define BALLTRACKGOVERNOR_H
+
+// Adaptive load governor for the tracker.
+//
+// Picks one of three profiles based on what is happening on the table:
+//   IDLE   no ball seen for a while: low framerate, filter every other frame
+//   SERVE  ball visible but slow: reduced framerate, ROI readout
+//   RALLY  ball moving fast: full framerate, ROI readout
+// Switching up is fast, switching down is slow (hysteresis), so a short
+// pause in a rally does not drop the framerate.
+
+typedef enum {
+    GOVERNOR_IDLE = 0,
+    GOVERNOR_SERVE,
+    GOVERNOR_RALLY,
+    GOVERNOR_PROFILE_COUNT
+} GOVERNOR_PROFILE;
+
+// Called from the render thread whenever the camera framerate should change
+typedef void (*governor_set_framerate_fn)(void* userdata, int framerate);
+
+// maxFramerate is the framerate requested on the command line,
+// used as the RALLY framerate. The other profiles are derived from it.
+int governor_init(int maxFramerate, governor_set_framerate_fn setFramerate, void* userdata);
+
+// Call once per rendered frame, after balltrack_core_redraw
+int governor_update();
+
+GOVERNOR_PROFILE governor_get_profile();
+
+#endif
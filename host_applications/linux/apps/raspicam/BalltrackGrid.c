@@ -0,0 +1,189 @@
+#include "BalltrackGrid.h"
+
+void grid_init(BALLTRACK_GRID* grid, int width, int height) {
+    grid->width = width;
+    grid->height = height;
+    grid->gxmin = grid->gxmax = grid->gymin = grid->gymax = 0;
+    grid->roiValid = 0;
+    grid->roiX = grid->roiY = 0;
+    grid->ball.x = grid->ball.y = 0.0f;
+    grid->found = 0;
+}
+
+int grid_window(const BALLTRACK_GRID* grid, uint32_t frame, int roi, int* x0, int* y0, int* w, int* h) {
+    *x0 = 0;
+    *y0 = 0;
+    *w = grid->width;
+    *h = grid->height;
+    if (!roi || !grid->roiValid || (frame % GRID_FIELD_REFRESH) == 0)
+        return 1;
+
+    *x0 = grid->roiX - GRID_ROI_HALF_WIDTH;
+    *y0 = grid->roiY - GRID_ROI_HALF_HEIGHT;
+    if (*x0 < 0) *x0 = 0;
+    if (*y0 < 0) *y0 = 0;
+    *w = 2 * GRID_ROI_HALF_WIDTH + 1;
+    *h = 2 * GRID_ROI_HALF_HEIGHT + 1;
+    if (*x0 + *w > grid->width) *w = grid->width - *x0;
+    if (*y0 + *h > grid->height) *h = grid->height - *y0;
+    return 0;
+}
+
+static void grid_find_field(BALLTRACK_GRID* grid, const uint32_t* ptr) {
+    int width = grid->width;
+    int height = grid->height;
+    int gxmin = (int)(0.45f * 2.0f * width);
+    int gxmax = (int)(0.55f * 2.0f * width);
+    int gymin = (int)(0.45f * height);
+    int gymax = (int)(0.55f * height);
+
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            // R,G,B,A = FF, 00, FF, FF
+            uint32_t rgba = *ptr++;
+            //int R1 = (rgba      ) & 0xff;
+            int G1 = (rgba >>  8) & 0xff;
+            //int R2 = (rgba >> 16) & 0xff;
+            int G2 = (rgba >> 24) & 0xff;
+
+            int y = i;
+            int x1 = 2*j;
+            int x2 = 2*j + 1;
+            // This part could be optimized...
+            // - y min/max check only once
+            // - if x1<gxmin then x2 does not need to be checked
+            // - ...
+            if (G1 > 140) {
+                if (x1 < gxmin) gxmin = x1;
+                if (x1 > gxmax) gxmax = x1;
+                if (y < gymin) gymin = y;
+                if (y > gymax) gymax = y;
+            }
+            if (G2 > 140) {
+                if (x2 < gxmin) gxmin = x2;
+                if (x2 > gxmax) gxmax = x2;
+                if (y < gymin) gymin = y;
+                if (y > gymax) gymax = y;
+            }
+        }
+    }
+    gxmin -= 4;
+    gxmax += 4;
+    gymin -= 3;
+    gymax += 3;
+    if (gxmin < 0) gxmin = 0;
+    if (gymin < 0) gymin = 0;
+    if (gxmax > 2*width-1) gxmax = 2*width - 1;
+    if (gymax > height) gymax = height;
+
+    grid->gxmin = gxmin;
+    grid->gxmax = gxmax;
+    grid->gymin = gymin;
+    grid->gymax = gymax;
+}
+
+void grid_analyse(BALLTRACK_GRID* grid, const uint32_t* pixels, int x0, int y0, int w, int h, int full) {
+    int width = grid->width;
+    int height = grid->height;
+
+    const uint32_t* ptr = pixels;
+    if (full)
+        grid_find_field(grid, ptr);
+    int gxmin = grid->gxmin, gxmax = grid->gxmax;
+    int gymin = grid->gymin, gymax = grid->gymax;
+
+    // Map to [-1,1]
+    FIELD field;
+    field.xmin = gxmin / ((float)width) - 1.0f;
+    field.xmax = gxmax / ((float)width) - 1.0f;
+    field.ymin = (2.0f * gymin) / ((float)height) - 1.0f;
+    field.ymax = (2.0f * gymax) / ((float)height) - 1.0f;
+
+    // Find the max orange intensity
+    uint32_t maxx = 0, maxy = 0;
+    uint32_t maxR = 0;
+    for (int i = y0; i < y0 + h; ++i) {
+        if ( i < gymin || i > gymax ) continue;
+        ptr = pixels + (i - y0) * w;
+        for (int j = x0; j < x0 + w; ++j) {
+            // R,G,B,A = FF, 00, FF, FF
+            uint32_t rgba = *ptr++;
+            int R1 = (rgba      ) & 0xff;
+            //int G1 = (rgba >>  8) & 0xff;
+            int R2 = (rgba >> 16) & 0xff;
+            //int G2 = (rgba >> 24) & 0xff;
+            int y = i;
+            int x1 = 2*j;
+            int x2 = 2*j + 1;
+            if ( x1 < gxmin || x2 > gxmax ) continue;
+            if (R1 > maxR) {
+                maxx = x1;
+                maxy = y;
+                maxR = R1;
+            }
+            if (R2 > maxR) {
+                maxx = x2;
+                maxy = y;
+                maxR = R2;
+            }
+        }
+    }
+    // Take weighted average near the maximum
+    int searchImin = maxy - 4;
+    int searchImax = maxy + 4;
+    int searchJmin = maxx/2 - 3;
+    int searchJmax = (maxx+1)/2 + 3;
+    if (searchImin < y0) searchImin = y0;
+    if (searchJmin < x0) searchJmin = x0;
+    if (searchImax > y0 + h) searchImax = y0 + h;
+    if (searchJmax > x0 + w) searchJmax = x0 + w;
+
+    uint32_t avgx = 0, avgy = 0;
+    uint32_t weight = 0;
+    uint32_t count = 0;
+    for (int i = searchImin; i < searchImax; ++i) {
+        for (int j = searchJmin; j < searchJmax; ++j) {
+            // R,G,B,A = FF, 00, FF, FF
+            uint32_t rgba = pixels[(i - y0) * w + (j - x0)];
+            int R1 = (rgba      ) & 0xff;
+            //int G1 = (rgba >>  8) & 0xff;
+            int R2 = (rgba >> 16) & 0xff;
+            //int G2 = (rgba >> 24) & 0xff;
+            int y = i;
+            int x1 = 2*j;
+            int x2 = 2*j + 1;
+            avgx += x1 * R1;
+            avgy += y  * R1;
+            weight += R1;
+            avgx += x2 * R2;
+            avgy += y  * R2;
+            weight += R2;
+            count++;
+        }
+    }
+
+    int threshold1 = 30;
+    int threshold2 = 60;
+
+    // avgx, avgy are the bottom-left corner of the macropixels
+    // Shift them by half a pixel to fix
+    // Then, map them to [-1,1] range
+    float x = 0.5f + (((float)avgx) / ((float)weight));
+    float y = 0.5f + (((float)avgy) / ((float)weight));
+    POINT ball;
+    ball.x = x / ((float)width) - 1.0f;
+    ball.y = (2.0f * y) / ((float)height) - 1.0f;
+
+    if (maxR > threshold1 && weight > threshold2) {
+        analysis_update(field, ball, 1);
+        grid->ball = ball;
+        grid->found = 1;
+        grid->roiX = maxx / 2;
+        grid->roiY = maxy;
+        grid->roiValid = 1;
+    } else {
+        analysis_update(field, ball, 0);
+        grid->found = 0;
+        grid->roiValid = 0;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef BALLTRACKGRID_H
+#define BALLTRACKGRID_H
+
+#include <stdint.h>
+#include "BallAnalysis.h"
+
+// Search for the ball in the filter grid, shared by the GLES backend
+// (BalltrackCore.c) and the CPU backend.
+//
+// The grid packs two pixels into one RGBA pixel: red,green,red,green
+// filter values for neighbouring pixels. Row 0 is the bottom row, as read
+// by glReadPixels. The field bounds and the region of interest are kept
+// between frames.
+
+// Region of interest readout.
+// A window of the filter grid around the last ball position is read back
+// instead of the full grid. The field bounds are refreshed with a full
+// readout every GRID_FIELD_REFRESH frames and whenever the ball is lost.
+#define GRID_ROI_HALF_WIDTH   6  // In packed (two-pixel) units
+#define GRID_ROI_HALF_HEIGHT  8
+#define GRID_FIELD_REFRESH    16
+
+typedef struct {
+    int width;              // Grid size in packed pixels
+    int height;
+    int gxmin, gxmax, gymin, gymax; // Field bounds in grid pixels
+    int roiValid;
+    int roiX, roiY;         // Packed grid coordinates of last ball
+    POINT ball;             // Last ball position in [-1,1]
+    int found;              // Ball found in the last analysed grid
+} BALLTRACK_GRID;
+
+void grid_init(BALLTRACK_GRID* grid, int width, int height);
+
+// Rectangle of the grid to read back for frame `frame`, in packed grid
+// coordinates. Returns nonzero if it is the full grid.
+int grid_window(const BALLTRACK_GRID* grid, uint32_t frame, int roi, int* x0, int* y0, int* w, int* h);
+
+// Search the rectangle that was read back, pixels[i*w + j] being (y0 + i)
+// pixels from the bottom and (x0 + j) from the left, and pass the result
+// to BallAnalysis. `full` as returned by grid_window.
+void grid_analyse(BALLTRACK_GRID* grid, const uint32_t* pixels, int x0, int y0, int w, int h, int full);
+
+#endif /* BALLTRACKGRID_H */
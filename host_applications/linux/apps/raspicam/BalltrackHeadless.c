@@ -0,0 +1,212 @@
+// Headless tracker: runs the tracker on frames from a file, in an EGL
+// context without a window. Built against the system libEGL and
+// libGLESv2 (for example Mesa with llvmpipe) instead of the Broadcom
+// libraries, so the shader pipeline can be run, benchmarked and compared
+// against the CPU reference model (BalltrackReference.h) on any Linux box.
+//
+// Frames come from one of the sources in BalltrackSource.h: PPM images,
+// raw RGBA or I420 frames, or the synthetic table with its ground truth.
+
+#include "Balltracker.h"
+#include "BalltrackCore.h"
+#include "BalltrackEGL.h"
+#include "BalltrackReference.h"
+#include "BalltrackSource.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Size of the default framebuffer, for the display pass
+#define PREVIEW_WIDTH  640
+#define PREVIEW_HEIGHT 360
+
+// Difference between the grid read back from GL and the reference model
+typedef struct {
+    uint32_t grids;
+    uint32_t maxDiff;
+    uint64_t bytes;
+    uint64_t offBytes;      // Bytes that differ by more than COMPARE_SLACK
+} COMPARE_STATS;
+
+#define COMPARE_SLACK 2
+
+static void compare_grid(const uint8_t* frame, int separable, COMPARE_STATS* stats) {
+    int w, h;
+    balltrack_core_get_grid_size(&w, &h);
+    size_t size = (size_t)w * h * 4;
+    uint8_t* gl = malloc(size);
+    uint8_t* ref = malloc(size);
+    REFERENCE_TEXTURE grid;
+    if (!gl || !ref || reference_texture_init(&grid, w, h) != 0) {
+        free(gl);
+        free(ref);
+        return;
+    }
+
+    if (balltrack_core_read_grid(gl) == 0 && reference_grid(frame, separable, &grid) == 0) {
+        reference_texture_to_rgba(&grid, ref);
+        for (size_t i = 0; i < size; ++i) {
+            uint32_t d = gl[i] > ref[i] ? gl[i] - ref[i] : ref[i] - gl[i];
+            if (d > stats->maxDiff)
+                stats->maxDiff = d;
+            if (d > COMPARE_SLACK)
+                ++stats->offBytes;
+        }
+        stats->bytes += size;
+        ++stats->grids;
+    }
+
+    reference_texture_free(&grid);
+    free(gl);
+    free(ref);
+}
+
+typedef struct {
+    BALLTRACK_EGL* egl;
+    int quiet;
+    int compare;            // Only in the synchronous mode the grid belongs to this frame
+    int separable;
+    COMPARE_STATS cmp;
+    uint64_t stageUs[4];
+} HEADLESS_SINK;
+
+static void headless_frame(const BALLTRACK_FRAME* frame, const BALLTRACK_RESULT* result, void* userdata) {
+    HEADLESS_SINK* sink = userdata;
+    if (sink->egl->surface != EGL_NO_SURFACE)
+        eglSwapBuffers(sink->egl->display, sink->egl->surface);
+
+    const BALLTRACK_TIMINGS* t = balltrack_core_get_timings();
+    sink->stageUs[0] += t->filter_us;
+    sink->stageUs[1] += t->readout_us;
+    sink->stageUs[2] += t->analysis_us;
+    sink->stageUs[3] += t->display_us;
+    if (!sink->quiet && result->analysed) {
+        if (result->found)
+            printf("frame %lld: ball at %.3f %.3f\n", (long long)result->pts, result->ball.x, result->ball.y);
+        else
+            printf("frame %lld: no ball\n", (long long)result->pts);
+    }
+    if (sink->compare) {
+        if (frame->width != REFERENCE_SOURCE_WIDTH || frame->height != REFERENCE_SOURCE_HEIGHT) {
+            printf("The reference model needs %dx%d frames, not %dx%d\n",
+                    REFERENCE_SOURCE_WIDTH, REFERENCE_SOURCE_HEIGHT, frame->width, frame->height);
+            sink->compare = 0;
+        } else {
+            compare_grid(frame->rgba, sink->separable, &sink->cmp);
+        }
+    }
+}
+
+static void usage(const char* name) {
+    printf("Usage: %s [options] <file|-|synthetic>\n"
+           "  -size WxH      Raw RGBA frames of this size instead of PPM images\n"
+           "  -yuv WxH       Raw I420 frames of this size\n"
+           "  -frames N      Stop after N frames\n"
+           "  -pipeline N    Read the grid back from a ring of N targets, see raspiballs -pipeline\n"
+           "  -fused         One fused phase 2 pass instead of the separable passes\n"
+           "  -display       Also run the display pass, into a pbuffer\n"
+           "  -compare       Compare every grid with the CPU reference model (1280x720 frames)\n"
+           "  -quiet         Only print the totals\n"
+           "The synthetic table has 300 frames unless -frames is given.\n", name);
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    int width = 0, height = 0, yuv = 0;
+    int maxFrames = 0, display = 0;
+    BALLTRACK_CONFIG config;
+    HEADLESS_SINK sink;
+
+    memset(&sink, 0, sizeof(sink));
+    memset(&config, 0, sizeof(config));
+    config.pipeline = 1;
+    config.separable = 1;
+    for (int i = 1; i < argc; ++i) {
+        if ((!strcmp(argv[i], "-size") || !strcmp(argv[i], "-yuv")) && i + 1 < argc) {
+            yuv = !strcmp(argv[i], "-yuv");
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-frames") && i + 1 < argc) {
+            maxFrames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-pipeline") && i + 1 < argc) {
+            config.pipeline = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-fused")) {
+            config.separable = 0;
+        } else if (!strcmp(argv[i], "-display")) {
+            display = 1;
+        } else if (!strcmp(argv[i], "-compare")) {
+            sink.compare = 1;
+        } else if (!strcmp(argv[i], "-quiet")) {
+            sink.quiet = 1;
+        } else if (argv[i][0] != '-' || !strcmp(argv[i], "-")) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    BALLTRACK_SOURCE* source;
+    if (!strcmp(path, "synthetic"))
+        source = balltrack_source_synthetic(maxFrames ? maxFrames : 300);
+    else if (yuv)
+        source = balltrack_source_open_yuv(path, width, height);
+    else
+        source = balltrack_source_open_file(path, width, height);
+    if (!source)
+        return 1;
+
+    BALLTRACK_EGL egl;
+    BALLTRACKER* tracker = NULL;
+    int rc = balltrack_egl_init(&egl, PREVIEW_WIDTH, PREVIEW_HEIGHT);
+    if (rc != 0)
+        goto end;
+    // The display pass draws to the default framebuffer
+    config.display = display && egl.surface != EGL_NO_SURFACE;
+
+    tracker = balltracker_create(&balltrack_backend_gles);
+    if (!tracker) {
+        rc = -1;
+        goto end;
+    }
+    balltracker_set_config(tracker, &config);
+    rc = balltracker_init(tracker);
+    if (rc != 0)
+        goto end;
+
+    BALLTRACK_SINK headless = { headless_frame, NULL, &sink, NULL };
+    sink.egl = &egl;
+    sink.separable = config.separable;
+    if (sink.compare && config.pipeline > 1) {
+        printf("Compare: only with -pipeline 1\n");
+        sink.compare = 0;
+    }
+    balltracker_add_sink(tracker, &headless);
+
+    int frames = balltracker_run(tracker, source, maxFrames);
+    rc = frames < 0 ? -1 : 0;
+
+    balltracker_print_stats(tracker);
+    if (frames > 0) {
+        printf("Stages per frame: filter %.2f ms, readback %.2f ms, analysis %.2f ms, display %.2f ms\n",
+                sink.stageUs[0] / 1000.0 / frames, sink.stageUs[1] / 1000.0 / frames,
+                sink.stageUs[2] / 1000.0 / frames, sink.stageUs[3] / 1000.0 / frames);
+    }
+    if (sink.cmp.grids) {
+        printf("Compare: %u grids, max difference %u/255, %.3f%% of the bytes off by more than %d\n",
+                sink.cmp.grids, sink.cmp.maxDiff, 100.0 * sink.cmp.offBytes / sink.cmp.bytes, COMPARE_SLACK);
+    }
+    balltracker_remove_sink(tracker, &headless);
+
+end:
+    balltracker_destroy(tracker);
+    balltrack_egl_term(&egl);
+    source->close(source);
+    return rc < 0 ? 1 : 0;
+}
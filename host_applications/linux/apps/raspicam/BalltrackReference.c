@@ -0,0 +1,213 @@
+#include "BalltrackReference.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+int reference_texture_init(REFERENCE_TEXTURE* tex, int width, int height) {
+    tex->width = width;
+    tex->height = height;
+    tex->data = calloc((size_t)width * height * 4, sizeof(float));
+    return tex->data ? 0 : -1;
+}
+
+void reference_texture_free(REFERENCE_TEXTURE* tex) {
+    free(tex->data);
+    tex->data = 0;
+}
+
+void reference_texture_from_rgba(REFERENCE_TEXTURE* tex, const uint8_t* rgba) {
+    size_t count = (size_t)tex->width * tex->height * 4;
+    for (size_t i = 0; i < count; ++i)
+        tex->data[i] = rgba[i] * (1.0f / 255.0f);
+}
+
+static uint8_t to_unorm8(float x) {
+    if (x <= 0.0f)
+        return 0;
+    if (x >= 1.0f)
+        return 255;
+    return (uint8_t)(x * 255.0f + 0.5f);
+}
+
+void reference_texture_to_rgba(const REFERENCE_TEXTURE* tex, uint8_t* rgba) {
+    size_t count = (size_t)tex->width * tex->height * 4;
+    for (size_t i = 0; i < count; ++i)
+        rgba[i] = to_unorm8(tex->data[i]);
+}
+
+static const float* texel(const REFERENCE_TEXTURE* tex, int x, int y) {
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x > tex->width - 1) x = tex->width - 1;
+    if (y > tex->height - 1) y = tex->height - 1;
+    return tex->data + 4 * ((size_t)y * tex->width + x);
+}
+
+void reference_sample(const REFERENCE_TEXTURE* tex, float u, float v, float* rgba) {
+    float x = u * tex->width - 0.5f;
+    float y = v * tex->height - 0.5f;
+    int x0 = (int)floorf(x);
+    int y0 = (int)floorf(y);
+    float fx = x - x0;
+    float fy = y - y0;
+
+    const float* t00 = texel(tex, x0,     y0);
+    const float* t10 = texel(tex, x0 + 1, y0);
+    const float* t01 = texel(tex, x0,     y0 + 1);
+    const float* t11 = texel(tex, x0 + 1, y0 + 1);
+    for (int c = 0; c < 4; ++c) {
+        float bottom = t00[c] + fx * (t10[c] - t00[c]);
+        float top    = t01[c] + fx * (t11[c] - t01[c]);
+        rgba[c] = bottom + fy * (top - bottom);
+    }
+}
+
+// Write one fragment into an RGBA8 render target
+static void store(REFERENCE_TEXTURE* out, int x, int y, const float* rgba) {
+    float* dst = out->data + 4 * ((size_t)y * out->width + x);
+    for (int c = 0; c < 4; ++c)
+        dst[c] = to_unorm8(rgba[c]) * (1.0f / 255.0f);
+}
+
+// getFilter() of phase1.frag
+static void get_filter(const float* col, float* filter) {
+    float value = fmaxf(col[0], fmaxf(col[1], col[2]));
+    float chroma = value - fminf(col[0], fminf(col[1], col[2]));
+    float sat = (value > 0.0f ? (chroma / value) : 0.0f);
+    float ballfilter = 0.0f;
+    float greenfilter = 0.0f;
+    if (col[0] == value) {
+        if (sat > 0.35f && value > 0.15f && value < 0.95f) {
+            float hue = (col[1] - col[2]) / chroma;
+            if (hue > 0.70f)
+                ballfilter = 1.0f;
+        }
+    } else if (col[1] == value) {
+        float hue = (col[2] - col[0]) / chroma;
+        if (hue > 0.0f && hue < 0.9f && sat > 0.15f && value > 0.10f && value < 0.70f)
+            greenfilter = 1.0f;
+    }
+    filter[0] = ballfilter;
+    filter[1] = greenfilter;
+}
+
+void reference_phase1(const REFERENCE_TEXTURE* source, REFERENCE_TEXTURE* out) {
+    float unitx = 1.0f / source->width;
+    for (int y = 0; y < out->height; ++y) {
+        float v = (y + 0.5f) / out->height;
+        for (int x = 0; x < out->width; ++x) {
+            float u = (x + 0.5f) / out->width;
+            float col1[4], col2[4], frag[4];
+            reference_sample(source, u - unitx, v, col1);
+            reference_sample(source, u + unitx, v, col2);
+            get_filter(col1, &frag[0]);
+            get_filter(col2, &frag[2]);
+            store(out, x, y, frag);
+        }
+    }
+}
+
+static void accumulate(float* sum, const REFERENCE_TEXTURE* tex, float u, float v) {
+    float col[4];
+    reference_sample(tex, u, v, col);
+    for (int c = 0; c < 4; ++c)
+        sum[c] += col[c];
+}
+
+// Two packed outputs from two sums over packed inputs
+static void store_pair(REFERENCE_TEXTURE* out, int x, int y, const float* avg1, const float* avg2, float scale) {
+    float frag[4];
+    frag[0] = scale * (avg1[0] + avg1[2]);
+    frag[1] = scale * (avg1[1] + avg1[3]);
+    frag[2] = scale * (avg2[0] + avg2[2]);
+    frag[3] = scale * (avg2[1] + avg2[3]);
+    store(out, x, y, frag);
+}
+
+void reference_phase2(const REFERENCE_TEXTURE* phase1, REFERENCE_TEXTURE* out) {
+    float unitx = 1.0f / phase1->width;
+    float unity = 1.0f / phase1->height;
+    for (int y = 0; y < out->height; ++y) {
+        float v = (y + 0.5f) / out->height;
+        for (int x = 0; x < out->width; ++x) {
+            float u = (x + 0.5f) / out->width;
+            float avg1[4] = {0}, avg2[4] = {0}, avgboth[4] = {0};
+            for (int j = -5; j <= 5; j += 2) {
+                accumulate(avgboth, phase1, u, v + j * unity);
+                for (int i = -4; i <= -2; i += 2)
+                    accumulate(avg1, phase1, u + i * unitx, v + j * unity);
+                for (int i = 2; i <= 4; i += 2)
+                    accumulate(avg2, phase1, u + i * unitx, v + j * unity);
+            }
+            for (int c = 0; c < 4; ++c) {
+                avg1[c] += avgboth[c];
+                avg2[c] += avgboth[c];
+            }
+            store_pair(out, x, y, avg1, avg2, 1.0f / 36.0f);
+        }
+    }
+}
+
+void reference_phase2_h(const REFERENCE_TEXTURE* phase1, REFERENCE_TEXTURE* out) {
+    float unitx = 1.0f / phase1->width;
+    for (int y = 0; y < out->height; ++y) {
+        float v = (y + 0.5f) / out->height;
+        for (int x = 0; x < out->width; ++x) {
+            float u = (x + 0.5f) / out->width;
+            float avg1[4] = {0}, avg2[4] = {0};
+            accumulate(avg1, phase1, u, v);
+            memcpy(avg2, avg1, sizeof(avg2));
+            accumulate(avg1, phase1, u - 4 * unitx, v);
+            accumulate(avg1, phase1, u - 2 * unitx, v);
+            accumulate(avg2, phase1, u + 2 * unitx, v);
+            accumulate(avg2, phase1, u + 4 * unitx, v);
+            store_pair(out, x, y, avg1, avg2, 1.0f / 6.0f);
+        }
+    }
+}
+
+void reference_phase2_v(const REFERENCE_TEXTURE* phase2h, REFERENCE_TEXTURE* out) {
+    float unity = 1.0f / phase2h->height;
+    for (int y = 0; y < out->height; ++y) {
+        float v = (y + 0.5f) / out->height;
+        for (int x = 0; x < out->width; ++x) {
+            float u = (x + 0.5f) / out->width;
+            float avg[4] = {0};
+            accumulate(avg, phase2h, u, v - 2 * unity);
+            accumulate(avg, phase2h, u, v);
+            accumulate(avg, phase2h, u, v + 2 * unity);
+            for (int c = 0; c < 4; ++c)
+                avg[c] *= 1.0f / 3.0f;
+            store(out, x, y, avg);
+        }
+    }
+}
+
+int reference_grid(const uint8_t* rgba, int separable, REFERENCE_TEXTURE* grid) {
+    REFERENCE_TEXTURE source, phase1, phase2h = {0};
+    int rc = -1;
+
+    if (reference_texture_init(&source, REFERENCE_SOURCE_WIDTH, REFERENCE_SOURCE_HEIGHT) != 0)
+        return -1;
+    if (reference_texture_init(&phase1, REFERENCE_PHASE1_WIDTH, REFERENCE_PHASE1_HEIGHT) != 0)
+        goto end_source;
+    if (separable && reference_texture_init(&phase2h, REFERENCE_PHASE2H_WIDTH, REFERENCE_PHASE2H_HEIGHT) != 0)
+        goto end_phase1;
+
+    reference_texture_from_rgba(&source, rgba);
+    reference_phase1(&source, &phase1);
+    if (separable) {
+        reference_phase2_h(&phase1, &phase2h);
+        reference_phase2_v(&phase2h, grid);
+    } else {
+        reference_phase2(&phase1, grid);
+    }
+    rc = 0;
+
+    reference_texture_free(&phase2h);
+end_phase1:
+    reference_texture_free(&phase1);
+end_source:
+    reference_texture_free(&source);
+    return rc;
+}
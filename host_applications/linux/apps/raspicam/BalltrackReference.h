@@ -0,0 +1,55 @@
+#ifndef BALLTRACKREFERENCE_H
+#define BALLTRACKREFERENCE_H
+
+#include <stdint.h>
+
+// CPU reference model of the filter passes in balltrackshaders/.
+//
+// Every pass is a direct port of its fragment shader, evaluated at the
+// center of each output pixel, with GL_LINEAR sampling and clamp-to-edge
+// as the GPU does it. Render targets are RGBA8, so the output of every
+// pass is rounded to 8 bits. This way a grid read back on the Pi, or the
+// grid of a captured frame, can be checked against the model off-device,
+// and changes to the pass graph can be checked against each other.
+//
+// Like GL textures, images are stored bottom row first. That is also the
+// order of glReadPixels and of raw capture dumps (see BalltrackCapture.h).
+
+// Sizes of the render targets, as in BalltrackCore.c.
+// Phase 1 and the grid pack two pixels in each RGBA pixel.
+#define REFERENCE_SOURCE_WIDTH   1280
+#define REFERENCE_SOURCE_HEIGHT  720
+#define REFERENCE_PHASE1_WIDTH   (640 / 2)
+#define REFERENCE_PHASE1_HEIGHT  360
+#define REFERENCE_PHASE2H_WIDTH  (80 / 2)
+#define REFERENCE_PHASE2H_HEIGHT 180
+#define REFERENCE_GRID_WIDTH     (80 / 2)
+#define REFERENCE_GRID_HEIGHT    45
+
+typedef struct {
+    int width;
+    int height;
+    float* data;    // RGBA in [0,1], bottom row first
+} REFERENCE_TEXTURE;
+
+int reference_texture_init(REFERENCE_TEXTURE* tex, int width, int height);
+void reference_texture_free(REFERENCE_TEXTURE* tex);
+void reference_texture_from_rgba(REFERENCE_TEXTURE* tex, const uint8_t* rgba);
+// As glReadPixels with GL_RGBA, GL_UNSIGNED_BYTE would return it
+void reference_texture_to_rgba(const REFERENCE_TEXTURE* tex, uint8_t* rgba);
+
+// texture2D() on a GL_LINEAR, GL_CLAMP_TO_EDGE texture
+void reference_sample(const REFERENCE_TEXTURE* tex, float u, float v, float* rgba);
+
+// The passes. The output texture sets the size that is rendered.
+void reference_phase1(const REFERENCE_TEXTURE* source, REFERENCE_TEXTURE* out);     // phase1.frag
+void reference_phase2(const REFERENCE_TEXTURE* phase1, REFERENCE_TEXTURE* out);     // phase2.frag
+void reference_phase2_h(const REFERENCE_TEXTURE* phase1, REFERENCE_TEXTURE* out);   // phase2_h.frag
+void reference_phase2_v(const REFERENCE_TEXTURE* phase2h, REFERENCE_TEXTURE* out);  // phase2_v.frag
+
+// Camera frame (RGBA8, REFERENCE_SOURCE_WIDTH x REFERENCE_SOURCE_HEIGHT)
+// to the grid that BalltrackCore reads back, with the fused or the
+// separable phase 2. `grid` has to be initialised to the grid size.
+int reference_grid(const uint8_t* rgba, int separable, REFERENCE_TEXTURE* grid);
+
+#endif /* BALLTRACKREFERENCE_H */
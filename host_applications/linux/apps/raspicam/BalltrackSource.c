@@ -0,0 +1,363 @@
+#include "BalltrackSource.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    BALLTRACK_SOURCE source;
+    FILE* file;
+    int raw;                // Raw RGBA instead of PPM
+    int yuv;                // Raw I420
+    int width;
+    int height;
+    int64_t frame;
+    uint8_t* rgba;
+    uint8_t* line;          // One PPM row, or one I420 frame
+} FILE_SOURCE;
+
+// Next token of a PPM header, skipping whitespace and comments
+static int ppm_read_int(FILE* file, int* value) {
+    int c;
+    do {
+        c = fgetc(file);
+        if (c == '#') {
+            while (c != '\n' && c != EOF)
+                c = fgetc(file);
+        }
+    } while (c != EOF && isspace(c));
+    if (c == EOF || !isdigit(c))
+        return -1;
+    *value = 0;
+    while (c != EOF && isdigit(c)) {
+        *value = *value * 10 + (c - '0');
+        c = fgetc(file);
+    }
+    // The single whitespace after the header is part of it
+    return isspace(c) ? 0 : -1;
+}
+
+static int ppm_read(FILE_SOURCE* src) {
+    int c = fgetc(src->file);
+    if (c == EOF)
+        return 0;
+    int width, height, maxval;
+    if (c != 'P' || fgetc(src->file) != '6' || ppm_read_int(src->file, &width) ||
+            ppm_read_int(src->file, &height) || ppm_read_int(src->file, &maxval) || maxval != 255) {
+        printf("Input is not a stream of 8-bit binary PPM images\n");
+        return -1;
+    }
+    if (!src->rgba) {
+        src->width = width;
+        src->height = height;
+        src->rgba = malloc((size_t)width * height * 4);
+        src->line = malloc((size_t)width * 3);
+        if (!src->rgba || !src->line)
+            return -1;
+    } else if (width != src->width || height != src->height) {
+        printf("Frame size changed from %dx%d to %dx%d\n", src->width, src->height, width, height);
+        return -1;
+    }
+    uint8_t* dst = src->rgba;
+    for (int y = 0; y < height; ++y) {
+        if (fread(src->line, 3, width, src->file) != (size_t)width)
+            return -1;
+        for (int x = 0; x < width; ++x) {
+            *dst++ = src->line[3 * x];
+            *dst++ = src->line[3 * x + 1];
+            *dst++ = src->line[3 * x + 2];
+            *dst++ = 255;
+        }
+    }
+    return 1;
+}
+
+static int file_read(BALLTRACK_SOURCE* source, BALLTRACK_FRAME* frame) {
+    FILE_SOURCE* src = (FILE_SOURCE*)source;
+    int rc;
+    if (src->raw || src->yuv) {
+        size_t size = (size_t)src->width * src->height * (src->yuv ? 3 : 8) / 2;
+        size_t n = fread(src->yuv ? src->line : src->rgba, 1, size, src->file);
+        rc = n == 0 ? 0 : (n == size ? 1 : -1);
+        if (rc == 1 && src->yuv)
+            balltrack_yuv_to_rgba(src->line, src->width, src->height, src->rgba);
+    } else {
+        rc = ppm_read(src);
+    }
+    if (rc != 1)
+        return rc;
+
+    frame->width = src->width;
+    frame->height = src->height;
+    frame->rgba = src->rgba;
+    frame->pts = src->frame++;
+    return 1;
+}
+
+static void file_close(BALLTRACK_SOURCE* source) {
+    FILE_SOURCE* src = (FILE_SOURCE*)source;
+    if (src->file && src->file != stdin)
+        fclose(src->file);
+    free(src->rgba);
+    free(src->line);
+    free(src);
+}
+
+static FILE_SOURCE* file_open(const char* path) {
+    FILE_SOURCE* src = calloc(1, sizeof(FILE_SOURCE));
+    if (!src)
+        return 0;
+    src->source.read = file_read;
+    src->source.close = file_close;
+    src->file = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+    if (!src->file) {
+        printf("Unable to open %s\n", path);
+        free(src);
+        return 0;
+    }
+    return src;
+}
+
+BALLTRACK_SOURCE* balltrack_source_open_file(const char* path, int width, int height) {
+    FILE_SOURCE* src = file_open(path);
+    if (!src)
+        return 0;
+    if (width > 0 && height > 0) {
+        src->raw = 1;
+        src->width = width;
+        src->height = height;
+        src->rgba = malloc((size_t)width * height * 4);
+        if (!src->rgba) {
+            file_close(&src->source);
+            return 0;
+        }
+    }
+    return &src->source;
+}
+
+BALLTRACK_SOURCE* balltrack_source_open_yuv(const char* path, int width, int height) {
+    if (width <= 0 || height <= 0 || (width & 1) || (height & 1)) {
+        printf("I420 frames need an even width and height\n");
+        return 0;
+    }
+    FILE_SOURCE* src = file_open(path);
+    if (!src)
+        return 0;
+    src->yuv = 1;
+    src->width = width;
+    src->height = height;
+    src->rgba = malloc((size_t)width * height * 4);
+    src->line = malloc((size_t)width * height * 3 / 2);
+    if (!src->rgba || !src->line) {
+        file_close(&src->source);
+        return 0;
+    }
+    return &src->source;
+}
+
+static uint8_t clamp8(int x) {
+    return x < 0 ? 0 : (x > 255 ? 255 : x);
+}
+
+void balltrack_yuv_to_rgba(const uint8_t* yuv, int width, int height, uint8_t* rgba) {
+    const uint8_t* py = yuv;
+    const uint8_t* pu = yuv + width * height;
+    const uint8_t* pv = pu + (width / 2) * (height / 2);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            // BT.601 limited range, 8 bit fixed point
+            int c = 298 * (py[y * width + x] - 16);
+            int d = pu[(y / 2) * (width / 2) + x / 2] - 128;
+            int e = pv[(y / 2) * (width / 2) + x / 2] - 128;
+            *rgba++ = clamp8((c + 409 * e + 128) >> 8);
+            *rgba++ = clamp8((c - 100 * d - 208 * e + 128) >> 8);
+            *rgba++ = clamp8((c + 516 * d + 128) >> 8);
+            *rgba++ = 255;
+        }
+    }
+}
+
+// Synthetic table: dark border, green field, two red players, and a
+// yellow-orange ball that bounces off the field edges
+#define SYNTH_WIDTH        1280
+#define SYNTH_HEIGHT       720
+#define SYNTH_FIELD_XMIN   100
+#define SYNTH_FIELD_XMAX   1180
+#define SYNTH_FIELD_YMIN   60
+#define SYNTH_FIELD_YMAX   660
+#define SYNTH_BALL_RADIUS  10
+
+typedef struct {
+    BALLTRACK_SOURCE source;
+    int frames;
+    int frame;
+    float x, y;             // Ball center in pixels
+    float vx, vy;           // Pixels per frame
+    uint8_t* background;
+    uint8_t* rgba;
+} SYNTH_SOURCE;
+
+static void synth_pixel(uint8_t* p, uint8_t r, uint8_t g, uint8_t b) {
+    p[0] = r;
+    p[1] = g;
+    p[2] = b;
+    p[3] = 255;
+}
+
+static void synth_background(uint8_t* rgba) {
+    for (int y = 0; y < SYNTH_HEIGHT; ++y) {
+        for (int x = 0; x < SYNTH_WIDTH; ++x) {
+            uint8_t* p = rgba + 4 * (y * SYNTH_WIDTH + x);
+            if ((x >= 300 && x < 330 && y >= 200 && y < 260) || (x >= 900 && x < 930 && y >= 400 && y < 460))
+                synth_pixel(p, 200, 30, 40);
+            else if (x >= SYNTH_FIELD_XMIN && x < SYNTH_FIELD_XMAX && y >= SYNTH_FIELD_YMIN && y < SYNTH_FIELD_YMAX)
+                synth_pixel(p, 40, 140, 60);
+            else
+                synth_pixel(p, 20, 20, 20);
+        }
+    }
+}
+
+// Draws the ball, or restores the background under it
+static void synth_ball(SYNTH_SOURCE* src, int draw) {
+    int r = SYNTH_BALL_RADIUS;
+    int cx = (int)src->x, cy = (int)src->y;
+    for (int y = cy - r; y <= cy + r; ++y) {
+        for (int x = cx - r; x <= cx + r; ++x) {
+            size_t offset = 4 * ((size_t)y * SYNTH_WIDTH + x);
+            int dx = x - cx, dy = y - cy;
+            if (!draw)
+                memcpy(src->rgba + offset, src->background + offset, 4);
+            else if (dx * dx + dy * dy <= r * r)
+                synth_pixel(src->rgba + offset, 230, 180, 30);
+        }
+    }
+}
+
+static int synth_read(BALLTRACK_SOURCE* source, BALLTRACK_FRAME* frame) {
+    SYNTH_SOURCE* src = (SYNTH_SOURCE*)source;
+    if (src->frames && src->frame >= src->frames)
+        return 0;
+
+    if (src->frame > 0) {
+        synth_ball(src, 0);
+        float xmin = SYNTH_FIELD_XMIN + SYNTH_BALL_RADIUS, xmax = SYNTH_FIELD_XMAX - SYNTH_BALL_RADIUS - 1;
+        float ymin = SYNTH_FIELD_YMIN + SYNTH_BALL_RADIUS, ymax = SYNTH_FIELD_YMAX - SYNTH_BALL_RADIUS - 1;
+        src->x += src->vx;
+        src->y += src->vy;
+        if (src->x < xmin) { src->x = 2 * xmin - src->x; src->vx = -src->vx; }
+        if (src->x > xmax) { src->x = 2 * xmax - src->x; src->vx = -src->vx; }
+        if (src->y < ymin) { src->y = 2 * ymin - src->y; src->vy = -src->vy; }
+        if (src->y > ymax) { src->y = 2 * ymax - src->y; src->vy = -src->vy; }
+    }
+    synth_ball(src, 1);
+
+    frame->width = SYNTH_WIDTH;
+    frame->height = SYNTH_HEIGHT;
+    frame->rgba = src->rgba;
+    frame->pts = src->frame++;
+    // Center of the ball pixels, first row at -1 like the grid
+    frame->has_truth = 1;
+    frame->truth.x = 2.0f * ((int)src->x + 0.5f) / SYNTH_WIDTH - 1.0f;
+    frame->truth.y = 2.0f * ((int)src->y + 0.5f) / SYNTH_HEIGHT - 1.0f;
+    return 1;
+}
+
+static void synth_close(BALLTRACK_SOURCE* source) {
+    SYNTH_SOURCE* src = (SYNTH_SOURCE*)source;
+    free(src->background);
+    free(src->rgba);
+    free(src);
+}
+
+BALLTRACK_SOURCE* balltrack_source_synthetic(int frames) {
+    SYNTH_SOURCE* src = calloc(1, sizeof(SYNTH_SOURCE));
+    if (!src)
+        return 0;
+    src->source.read = synth_read;
+    src->source.close = synth_close;
+    src->frames = frames;
+    src->x = 600.0f;
+    src->y = 300.0f;
+    src->vx = 13.0f;
+    src->vy = 7.0f;
+    src->background = malloc(SYNTH_WIDTH * SYNTH_HEIGHT * 4);
+    src->rgba = malloc(SYNTH_WIDTH * SYNTH_HEIGHT * 4);
+    if (!src->background || !src->rgba) {
+        synth_close(&src->source);
+        return 0;
+    }
+    synth_background(src->background);
+    memcpy(src->rgba, src->background, SYNTH_WIDTH * SYNTH_HEIGHT * 4);
+    return &src->source;
+}
+
+typedef struct {
+    BALLTRACK_SOURCE source;
+    BALLTRACK_FRAME* frames;
+    uint8_t** pixels;
+    int count;
+    int loops;
+    int next;               // Over all loops
+} PRELOAD_SOURCE;
+
+static int preload_read(BALLTRACK_SOURCE* source, BALLTRACK_FRAME* frame) {
+    PRELOAD_SOURCE* src = (PRELOAD_SOURCE*)source;
+    if (!src->count || src->next >= src->count * src->loops)
+        return 0;
+    *frame = src->frames[src->next % src->count];
+    frame->pts = src->next++;
+    return 1;
+}
+
+static void preload_close(BALLTRACK_SOURCE* source) {
+    PRELOAD_SOURCE* src = (PRELOAD_SOURCE*)source;
+    for (int i = 0; i < src->count; ++i)
+        free(src->pixels[i]);
+    free(src->pixels);
+    free(src->frames);
+    free(src);
+}
+
+void balltrack_source_rewind(BALLTRACK_SOURCE* preloaded) {
+    ((PRELOAD_SOURCE*)preloaded)->next = 0;
+}
+
+BALLTRACK_SOURCE* balltrack_source_preload(BALLTRACK_SOURCE* source, int count, int loops) {
+    PRELOAD_SOURCE* src = calloc(1, sizeof(PRELOAD_SOURCE));
+    if (src) {
+        src->frames = calloc(count, sizeof(BALLTRACK_FRAME));
+        src->pixels = calloc(count, sizeof(uint8_t*));
+    }
+    if (!src || !src->frames || !src->pixels)
+        goto error;
+    src->source.read = preload_read;
+    src->source.close = preload_close;
+    src->loops = loops > 0 ? loops : 1;
+
+    while (src->count < count) {
+        BALLTRACK_FRAME frame;
+        memset(&frame, 0, sizeof(frame));
+        int rc = source->read(source, &frame);
+        if (rc < 0)
+            goto error;
+        if (rc == 0)
+            break;
+        size_t size = (size_t)frame.width * frame.height * 4;
+        uint8_t* copy = malloc(size);
+        if (!copy)
+            goto error;
+        memcpy(copy, frame.rgba, size);
+        frame.rgba = copy;
+        src->pixels[src->count] = copy;
+        src->frames[src->count++] = frame;
+    }
+    source->close(source);
+    return &src->source;
+
+error:
+    source->close(source);
+    if (src)
+        preload_close(&src->source);
+    return 0;
+}
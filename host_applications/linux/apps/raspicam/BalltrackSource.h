@@ -0,0 +1,35 @@
+#ifndef BALLTRACKSOURCE_H
+#define BALLTRACKSOURCE_H
+
+#include "Balltracker.h"
+
+// Frame sources for balltracker_run. All of them return RGBA frames with
+// the first row at t=0, which is the order of the camera texture.
+// Close them with source->close(source).
+
+// A stream of binary PPM images, as written by
+//   ffmpeg -i video.h264 -s 1280x720 -f image2pipe -vcodec ppm -
+// or raw RGBA frames if width and height are given, such as the raw
+// capture dumps of raspiballs -capture. "-" is stdin.
+BALLTRACK_SOURCE* balltrack_source_open_file(const char* path, int width, int height);
+
+// Raw I420 frames, as written by raspividyuv or
+//   ffmpeg -i video.h264 -f rawvideo -pix_fmt yuv420p -
+// converted with BT.601 limited range like the camera texture.
+BALLTRACK_SOURCE* balltrack_source_open_yuv(const char* path, int width, int height);
+
+// A table with a ball bouncing around the field, with the ball position
+// as ground truth. Frames are 1280x720. Ends after `frames` frames.
+BALLTRACK_SOURCE* balltrack_source_synthetic(int frames);
+
+// Reads up to `count` frames of `source` into memory and closes it. The
+// new source repeats them `loops` times, so the source does not count
+// in timings.
+BALLTRACK_SOURCE* balltrack_source_preload(BALLTRACK_SOURCE* source, int count, int loops);
+// Starts a preloaded source over from its first frame
+void balltrack_source_rewind(BALLTRACK_SOURCE* preloaded);
+
+// I420 to RGBA, for the YUV source
+void balltrack_yuv_to_rgba(const uint8_t* yuv, int width, int height, uint8_t* rgba);
+
+#endif /* BALLTRACKSOURCE_H */
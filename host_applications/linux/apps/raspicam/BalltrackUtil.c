@@ -1,7 +1,7 @@
 // Mostly taken from RaspiTexUtil
 #include "BalltrackUtil.h"
-#include "tga.h"
 #include <stdio.h>
+#include <time.h>
 
 /**
  * Takes a description of shader program, compiles it and gets the locations
@@ -79,9 +79,10 @@ int balltrack_build_shader_program(SHADER_PROGRAM_T *p)
         p->uniform_locations[i] = glGetUniformLocation(p->program, p->uniform_names[i]);
         if (p->uniform_locations[i] == -1)
         {
-            printf("Failed to get location for uniform %s\n",
+            // Compilers may drop uniforms the shader does not use, such as
+            // tex_unit in display.frag. Setting location -1 is a no-op.
+            printf("No location for uniform %s, it is unused\n",
                   p->uniform_names[i]);
-            goto fail;
         }
         else {
             //printf("Uniform for %s is %d\n", p->uniform_names[i], p->uniform_locations[i]);
@@ -101,43 +102,8 @@ fail:
     return -1;
 }
 
-static void brga_to_rgba(uint8_t *buffer, size_t size)
-{
-   uint8_t* out = buffer;
-   uint8_t* end = buffer + size;
-
-   while (out < end)
-   {
-      uint8_t tmp = out[0];
-      out[0] = out[2];
-      out[2] = tmp;
-      out += 4;
-   }
+uint64_t balltrack_time_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
 }
-
-int dump_frame(int width, int height, const char* filename) {
-    FILE* output_file = fopen(filename, "wb");
-    if (!output_file)
-        return 1;
-
-    uint8_t* buffer = NULL;
-    size_t size = width * height * 4;
-    buffer = calloc(size, 1);
-    if (!buffer) {
-        fclose(output_file);
-        return 1;
-    }
-
-    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
-    if (glGetError() == GL_NO_ERROR) {
-        brga_to_rgba(buffer, size);
-        write_tga(output_file, width, height, buffer, size);
-    }
-
-    fflush(output_file);
-    fclose(output_file);
-    free(buffer);
-
-    return 0;
-}
-
@@ -4,11 +4,11 @@
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 #include <GLES2/gl2.h>
-#include <GLES/gl.h>
-#include <GLES/glext.h>
+#include <GLES2/gl2ext.h>
 //#include "interface/khronos/include/EGL/eglext_brcm.h"
 
 #include <stdio.h>
+#include <stdint.h>
 
 //#define CHECK_GL_ERRORS
 #ifdef CHECK_GL_ERRORS
@@ -53,6 +53,7 @@ typedef struct SHADER_PROGRAM_T
 
 int balltrack_build_shader_program(SHADER_PROGRAM_T *p);
 
-int dump_frame(int width, int height, const char* filename);
+// Monotonic timestamp in microseconds, for timing the tracker stages
+uint64_t balltrack_time_us();
 
 #endif /* BALLTRACKUTIL_H */
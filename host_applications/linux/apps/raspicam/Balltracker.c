@@ -0,0 +1,213 @@
+#include "Balltracker.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct BALLTRACKER_T {
+    const BALLTRACK_BACKEND* backend;
+    BALLTRACK_CONFIG config;
+    int initialised;
+
+    pthread_mutex_t lock;   // For the sinks, which are added from other threads
+    BALLTRACK_SINK* sinks;
+
+    // Of the last frames, because a result can be for an earlier frame
+    int64_t pts[BALLTRACKER_MAX_DELAY];
+    int hasTruth[BALLTRACKER_MAX_DELAY];
+    POINT truth[BALLTRACKER_MAX_DELAY];
+
+    BALLTRACKER_STATS stats;
+};
+
+static uint64_t tracker_time_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+BALLTRACKER* balltracker_create(const BALLTRACK_BACKEND* backend) {
+    BALLTRACKER* tracker = calloc(1, sizeof(BALLTRACKER));
+    if (!tracker)
+        return 0;
+    tracker->backend = backend;
+    tracker->config.pipeline = 1;
+    tracker->config.separable = 1;
+    tracker->config.display = 1;
+    pthread_mutex_init(&tracker->lock, 0);
+    return tracker;
+}
+
+void balltracker_destroy(BALLTRACKER* tracker) {
+    if (!tracker)
+        return;
+    balltracker_term(tracker);
+    pthread_mutex_destroy(&tracker->lock);
+    free(tracker);
+}
+
+void balltracker_get_config(const BALLTRACKER* tracker, BALLTRACK_CONFIG* config) {
+    *config = tracker->config;
+}
+
+int balltracker_set_config(BALLTRACKER* tracker, const BALLTRACK_CONFIG* config) {
+    if (tracker->initialised) {
+        printf("Tracker: the config can only be changed before init\n");
+        return -1;
+    }
+    tracker->config = *config;
+    return 0;
+}
+
+void balltracker_add_sink(BALLTRACKER* tracker, BALLTRACK_SINK* sink) {
+    pthread_mutex_lock(&tracker->lock);
+    sink->next = tracker->sinks;
+    tracker->sinks = sink;
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+void balltracker_remove_sink(BALLTRACKER* tracker, BALLTRACK_SINK* sink) {
+    pthread_mutex_lock(&tracker->lock);
+    for (BALLTRACK_SINK** pos = &tracker->sinks; *pos; pos = &(*pos)->next) {
+        if (*pos == sink) {
+            *pos = sink->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+static void tracker_event(const char* event, void* userdata) {
+    BALLTRACKER* tracker = userdata;
+    pthread_mutex_lock(&tracker->lock);
+    for (BALLTRACK_SINK* sink = tracker->sinks; sink; sink = sink->next) {
+        if (sink->event)
+            sink->event(event, sink->userdata);
+    }
+    pthread_mutex_unlock(&tracker->lock);
+}
+
+int balltracker_init(BALLTRACKER* tracker) {
+    if (tracker->initialised)
+        return 0;
+    printf("Tracker: %s backend\n", tracker->backend->name);
+    int rc = tracker->backend->init(&tracker->config);
+    if (rc != 0)
+        return rc;
+    analysis_set_event_callback(tracker_event, tracker);
+    memset(&tracker->stats, 0, sizeof(tracker->stats));
+    memset(tracker->hasTruth, 0, sizeof(tracker->hasTruth));
+    tracker->initialised = 1;
+    return 0;
+}
+
+void balltracker_term(BALLTRACKER* tracker) {
+    if (!tracker->initialised)
+        return;
+    analysis_set_event_callback(0, 0);
+    tracker->backend->term();
+    tracker->initialised = 0;
+}
+
+int balltracker_process(BALLTRACKER* tracker, const BALLTRACK_FRAME* frame, BALLTRACK_RESULT* result) {
+    BALLTRACK_RESULT local;
+    if (!result)
+        result = &local;
+    memset(result, 0, sizeof(*result));
+    if (!tracker->initialised)
+        return -1;
+
+    memmove(tracker->pts + 1, tracker->pts, sizeof(tracker->pts) - sizeof(tracker->pts[0]));
+    memmove(tracker->hasTruth + 1, tracker->hasTruth, sizeof(tracker->hasTruth) - sizeof(tracker->hasTruth[0]));
+    memmove(tracker->truth + 1, tracker->truth, sizeof(tracker->truth) - sizeof(tracker->truth[0]));
+    tracker->pts[0] = frame->pts;
+    tracker->hasTruth[0] = frame->has_truth;
+    tracker->truth[0] = frame->truth;
+
+    uint64_t t0 = tracker_time_us();
+    int rc = tracker->backend->track(frame, result);
+    result->track_us = (uint32_t)(tracker_time_us() - t0);
+    if (rc != 0)
+        return rc;
+
+    int delay = result->delay;
+    if (delay < 0 || delay >= BALLTRACKER_MAX_DELAY)
+        delay = 0;
+    result->pts = tracker->pts[delay];
+    result->has_truth = tracker->hasTruth[delay];
+    result->truth = tracker->truth[delay];
+    if (result->analysed)
+        analysis_set_frame_pts(result->pts);
+
+    BALLTRACKER_STATS* stats = &tracker->stats;
+    ++stats->frames;
+    stats->track_us += result->track_us;
+    if (result->analysed) {
+        ++stats->analysed;
+        if (result->found)
+            ++stats->found;
+        if (result->has_truth) {
+            ++stats->truths;
+            if (result->found) {
+                float dx = result->ball.x - result->truth.x;
+                float dy = result->ball.y - result->truth.y;
+                float error = sqrtf(dx * dx + dy * dy);
+                stats->error_sum += error;
+                if (error > stats->error_max)
+                    stats->error_max = error;
+            } else {
+                ++stats->misses;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&tracker->lock);
+    for (BALLTRACK_SINK* sink = tracker->sinks; sink; sink = sink->next) {
+        if (sink->frame)
+            sink->frame(frame, result, sink->userdata);
+    }
+    pthread_mutex_unlock(&tracker->lock);
+    return 0;
+}
+
+int balltracker_run(BALLTRACKER* tracker, BALLTRACK_SOURCE* source, int max_frames) {
+    int frames = 0;
+    while (!max_frames || frames < max_frames) {
+        BALLTRACK_FRAME frame;
+        memset(&frame, 0, sizeof(frame));
+        uint64_t t0 = tracker_time_us();
+        int n = source->read(source, &frame);
+        tracker->stats.source_us += tracker_time_us() - t0;
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            break;
+        if (balltracker_process(tracker, &frame, 0) != 0)
+            return -1;
+        ++frames;
+    }
+    return frames;
+}
+
+void balltracker_get_stats(const BALLTRACKER* tracker, BALLTRACKER_STATS* stats) {
+    *stats = tracker->stats;
+}
+
+void balltracker_print_stats(const BALLTRACKER* tracker) {
+    const BALLTRACKER_STATS* stats = &tracker->stats;
+    if (!stats->frames)
+        return;
+    printf("Tracker %s: %u frames, %u analysed, ball found in %u, %.2f ms per frame",
+            tracker->backend->name, stats->frames, stats->analysed, stats->found,
+            stats->track_us / 1000.0 / stats->frames);
+    if (stats->source_us)
+        printf(", source %.2f ms", stats->source_us / 1000.0 / stats->frames);
+    printf("\n");
+    if (stats->truths) {
+        uint32_t hits = stats->truths - stats->misses;
+        printf("  ground truth: %u missed of %u, mean error %.4f, max %.4f\n", stats->misses, stats->truths,
+                hits ? stats->error_sum / hits : 0.0, stats->error_max);
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef BALLTRACKER_H
+#define BALLTRACKER_H
+
+#include <stdint.h>
+#include "BallAnalysis.h"
+
+// The ball tracker as used by raspiballs, hello_balltrack and the tools:
+//
+//   frame source  ->  detection backend  ->  sinks
+//
+// A source produces frames: camera or decoder EGL images are passed in
+// per frame with balltracker_process, files and synthetic scenes are
+// pulled with balltracker_run (see BalltrackSource.h). The backend finds
+// the ball in a frame: the GLES backend runs the shader passes of
+// BalltrackCore, the CPU backend the reference model of the same passes.
+// Both search the grid with BalltrackGrid and feed BallAnalysis, so the
+// results and events are the same on every path. Sinks receive the result
+// of every frame and the BallAnalysis events.
+//
+// BallAnalysis and BalltrackCore keep global state, so only one tracker
+// can be initialised at a time. Everything except adding and removing
+// sinks has to happen on the thread that owns the GL context.
+
+// Results can be this many frames late, see balltrack_core_set_pipeline:
+// BALLTRACK_MAX_PIPELINE - 1 filtered frames, every other frame when idle
+#define BALLTRACKER_MAX_DELAY 8
+
+typedef struct {
+    int width;
+    int height;
+    const uint8_t* rgba;    // RGBA8 rows, first row at t=0, or NULL for a texture
+    uint32_t texture;       // GL texture, GLES backend only
+    uint32_t target;        // GL_TEXTURE_2D or GL_TEXTURE_EXTERNAL_OES
+    int view_width;         // Size of the display pass, zero for the frame size
+    int view_height;
+    int64_t pts;            // Passed through to the result
+    int has_truth;          // Nonzero if `truth` is the real ball position
+    POINT truth;            // In [-1,1] range like the results
+} BALLTRACK_FRAME;
+
+typedef struct {
+    int analysed;           // Zero if no new grid was analysed for this frame
+    int delay;              // Frames between the analysed frame and this one
+    int64_t pts;            // Of the analysed frame
+    POINT ball;             // Last ball position
+    int found;              // Ball found in the analysed frame
+    int has_truth;          // Ground truth of the analysed frame
+    POINT truth;
+    uint32_t track_us;      // Time in the backend for this frame
+} BALLTRACK_RESULT;
+
+typedef struct {
+    int external_sampler;   // GLES: textures are GL_TEXTURE_EXTERNAL_OES
+    int pipeline;           // GLES: readback targets, see balltrack_core_set_pipeline
+    int separable;          // Separable grid filter, see balltrack_core_set_passes
+    int display;            // GLES: draw the frame and overlay
+} BALLTRACK_CONFIG;
+
+typedef struct {
+    const char* name;
+    int (*init)(const BALLTRACK_CONFIG* config);
+    // Sets analysed, delay, ball and found of `result`
+    int (*track)(const BALLTRACK_FRAME* frame, BALLTRACK_RESULT* result);
+    void (*term)(void);
+} BALLTRACK_BACKEND;
+
+extern const BALLTRACK_BACKEND balltrack_backend_gles;  // BalltrackBackendGLES.c
+extern const BALLTRACK_BACKEND balltrack_backend_cpu;   // BalltrackBackendCPU.c
+
+// Both callbacks are optional. Events are BallAnalysis events such as
+// "RG\n", sent while the frame they were found in is processed and before
+// its `frame` callback.
+typedef struct BALLTRACK_SINK {
+    void (*frame)(const BALLTRACK_FRAME* frame, const BALLTRACK_RESULT* result, void* userdata);
+    void (*event)(const char* event, void* userdata);
+    void* userdata;
+    struct BALLTRACK_SINK* next;    // Used by the tracker
+} BALLTRACK_SINK;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t analysed;
+    uint32_t found;
+    uint64_t track_us;      // Time in the backend
+    uint64_t source_us;     // Time reading frames in balltracker_run
+    uint32_t truths;        // Analysed frames with a ground truth
+    uint32_t misses;        // Of those, frames where the ball was not found
+    double error_sum;       // Distance to the ground truth of the found balls
+    float error_max;
+} BALLTRACKER_STATS;
+
+typedef struct BALLTRACKER_T BALLTRACKER;
+
+// Source of frames for balltracker_run. `read` returns 1 with the next
+// frame, 0 at the end and -1 on errors; the pixels stay valid until the
+// next read.
+typedef struct BALLTRACK_SOURCE_T {
+    int (*read)(struct BALLTRACK_SOURCE_T* source, BALLTRACK_FRAME* frame);
+    void (*close)(struct BALLTRACK_SOURCE_T* source);
+} BALLTRACK_SOURCE;
+
+BALLTRACKER* balltracker_create(const BALLTRACK_BACKEND* backend);
+void balltracker_destroy(BALLTRACKER* tracker);
+
+// Defaults are one readback target, the separable filter and the display
+// pass on 2D textures. Set the config before balltracker_init.
+void balltracker_get_config(const BALLTRACKER* tracker, BALLTRACK_CONFIG* config);
+int balltracker_set_config(BALLTRACKER* tracker, const BALLTRACK_CONFIG* config);
+
+// The sink has to stay valid until it is removed
+void balltracker_add_sink(BALLTRACKER* tracker, BALLTRACK_SINK* sink);
+void balltracker_remove_sink(BALLTRACKER* tracker, BALLTRACK_SINK* sink);
+
+int balltracker_init(BALLTRACKER* tracker);
+void balltracker_term(BALLTRACKER* tracker);
+
+// Track one frame. `result` can be NULL.
+int balltracker_process(BALLTRACKER* tracker, const BALLTRACK_FRAME* frame, BALLTRACK_RESULT* result);
+// Track the frames of `source`, at most `max_frames` if nonzero.
+// Returns the number of frames, or -1 on errors.
+int balltracker_run(BALLTRACKER* tracker, BALLTRACK_SOURCE* source, int max_frames);
+
+void balltracker_get_stats(const BALLTRACKER* tracker, BALLTRACKER_STATS* stats);
+void balltracker_print_stats(const BALLTRACKER* tracker);
+
+#endif /* BALLTRACKER_H */
@@ -59,10 +59,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <memory.h>
 #include <sysexits.h>
+#include <poll.h>
+#include <unistd.h>
 
 #include <sys/types.h>
+#include <sys/time.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -80,11 +84,25 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "interface/mmal/util/mmal_default_components.h"
 #include "interface/mmal/util/mmal_connection.h"
 #include "interface/mmal/mmal_parameters_camera.h"
+#include "interface/mmal/mmal_trace.h"
 
 #include "RaspiCamControl.h"
 #include "RaspiPreview.h"
 #include "RaspiCLI.h"
 #include "RaspiTex.h"
+#include "BalltrackGovernor.h"
+#include "BalltrackCapture.h"
+#include "Balltracker.h"
+#include "BalltrackCore.h"
+#include "BallAnalysis.h"
+#include "gl_scenes/balltrack.h"
+#include "RaspiReplay.h"
+#include "RaspiHighlights.h"
+#include "RaspiRtp.h"
+#include "RaspiWebSocket.h"
+#include "RaspiTrackerState.h"
+#include "RaspiWriter.h"
+#include "RaspiPortStats.h"
 
 #include <semaphore.h>
 
@@ -115,6 +133,25 @@ const int MAX_BITRATE_LEVEL42 = 62500000; // 62.5Mbits/s
 /// Interval at which we check for an failure abort during capture
 const int ABORT_INTERVAL = 100; // ms
 
+/// Replay clip written on SAVE and goal events, unless set with -replay-file
+#define REPLAY_DEFAULT_FILENAME "/dev/shm/replay/replay.h264"
+/// UNIX socket for replay requests, see RaspiReplay.c for the commands. Its
+/// directory is created private to the user. Requests write next to the
+/// replay clip.
+#define REPLAY_CONTROL_SOCKET "/tmp/raspiballs/replay.sock"
+/// Smallest staging buffer of the encoder file writer
+#define WRITER_MIN_SIZE (4 * 1024 * 1024)
+/// Disk space reserved for the output file when not segmenting
+#define WRITER_PREALLOC_SECONDS 10
+/// Length of the replay clip written on tracker events
+#define REPLAY_CLIP_MS 1400
+/// Default length of the slow motion part of goal replays
+#define REPLAY_SLOWMO_WINDOW_MS 1000
+/// Default part of the frame interval that an access unit is sent over with rtp://
+#define RTP_DEFAULT_PACE 50
+/// Frames dumped from the capture ring are written to this prefix and the frame number
+#define CAPTURE_DEFAULT_PREFIX "/dev/shm/capture_"
+
 
 /// Capture/Pause switch method
 /// Simply capture for time specified
@@ -143,21 +180,19 @@ typedef struct
    FILE *file_handle;                   /// File handle to write buffer data to.
    RASPIVID_STATE *pstate;              /// pointer to our state in case required in callback
    int abort;                           /// Set to 1 in callback if an error occurs to attempt to abort the capture
-   char *cb_buff;                       /// Circular buffer
-   int   cb_len;                        /// Length of buffer
-   int   cb_wptr;                       /// Current write pointer
-   int   cb_wrap;                       /// Has buffer wrapped at least once?
-   int   cb_data;                       /// Valid bytes in buffer
-#define IFRAME_BUFSIZE (60*1000)
-   int   iframe_buff[IFRAME_BUFSIZE];          /// buffer of iframe pointers
-   int   iframe_buff_wpos;
-   int   iframe_buff_rpos;
-   char  header_bytes[29];
-   int  header_wptr;
    FILE *imv_file_handle;               /// File handle to write inline motion vectors to.
    FILE *raw_file_handle;               /// File handle to write raw data to.
    int  flush_buffers;
    FILE *pts_file_handle;               /// File timestamps
+   RASPIREPLAY_T *replay;               /// In-process replay ring, NULL if disabled
+   RASPIWRITER_T *writer;               /// Writes video, imv and pts data off the callback thread
+   RASPIHIGHLIGHT_T *highlights;        /// Index of tracker events in the recording, NULL if disabled
+   uint64_t segment_bytes;              /// Video bytes written to the current segment
+   int64_t header_offset;               /// Segment offset of SPS/PPS headers not yet followed by a frame, -1 if none
+   int frame_started;                   /// The encoder is part way through a frame
+   int video_dropping;                  /// The writer dropped video, skip it up to the next keyframe
+   RASPIRTP_T *rtp;                     /// RTP output for an rtp:// filename, NULL if not used
+   int sdp_written;                     /// The session description has been written
 } PORT_USERDATA;
 
 /** Possible raw output formats
@@ -236,6 +271,39 @@ struct RASPIVID_STATE_S
    int64_t lasttime;
 
    bool netListen;
+   int governor;                        /// Adapt framerate and tracker load to the game state
+   int replayTime;                      /// Seconds of video kept for replays, 0 to disable
+   char *replay_filename;               /// Replay clip written on SAVE and goal events
+   int slowmo;                          /// Goal replays play this many times slower, 0 or 1 for normal speed
+   int slowmo_window;                   /// Milliseconds around the goal played in slow motion
+   int slowmo_goal;                     /// A goal replay waits for the timestamp of the goal
+   int slowmo_due;                      /// Goal replay waits for the encoder to pass the end of slowmo_clip
+   RASPIREPLAY_SLOWMO_T slowmo_clip;    /// Slow motion part of the pending goal replay
+   char *highlights_filename;           /// Index of tracker events in the recording
+   int highlight_count;                 /// Events waiting for the timestamp of their frame
+   RASPIHIGHLIGHT_TYPE_T highlight_type[4];
+   int highlight_team[4];
+   float highlight_speed[4];
+   int rtpPace;                         /// Percentage of the frame interval to spread RTP packets over
+   char *sdp_filename;                  /// Session description of the RTP output
+   int websocketPort;                   /// Port of the event WebSocket server, 0 to disable
+   RASPIWS_T *websocket;                /// Event WebSocket server, NULL if disabled
+   VCOS_MUTEX_T command_lock;           /// Protects the WebSocket commands below
+   int capture_command;                 /// Posted START (1) or STOP (0), -1 if none
+   int replay_command;                  /// Posted REPLAY
+   char *state_name;                    /// Shared memory segment of the tracker state, NULL to disable
+   RASPISTATE_T *tracker_state;         /// Writer of that segment
+   RASPISTATE_RECORD_T state_record;    /// Totals so far and the events of the next frame
+   int captureFrames;                   /// Frames kept in the capture ring, 0 to disable
+   int captureFilter;                   /// Capture the phase 1 filter output instead of the camera
+   int capturePng;                      /// Write captured frames as PNG instead of raw RGBA
+   int captureGoal;                     /// Frames before each goal to dump, 0 to disable
+   int pipeline;                        /// Filter grid readback targets, 1 for synchronous readback
+   int gridPasses;                      /// Filter grid downsample passes, 1 fused or 2 separable
+   int portStatsInterval;               /// Milliseconds between port statistics tables, 0 to disable
+   RASPIPORTSTATS_T *port_stats;        /// Prints those tables
+   char *mmal_trace_filename;           /// MMAL buffer flow trace written on exit, NULL to disable
+   BALLTRACK_SINK tracker_sink;         /// Frame and event callbacks of the tracker
 };
 
 
@@ -326,6 +394,24 @@ static void display_valid_parameters(char *app_name);
 #define CommandRaw          32
 #define CommandRawFormat    33
 #define CommandNetListen    34
+#define CommandGovernor     35
+#define CommandReplay       36
+#define CommandReplayFile   37
+#define CommandSlowmo       38
+#define CommandSlowmoWindow 39
+#define CommandHighlights   40
+#define CommandRtpPace      41
+#define CommandSdp          42
+#define CommandWebSocket    43
+#define CommandState        44
+#define CommandCapture      45
+#define CommandCaptureFilter 46
+#define CommandCapturePng   47
+#define CommandCaptureGoal  48
+#define CommandPipeline     49
+#define CommandGridPasses   50
+#define CommandPortStats    51
+#define CommandMmalTrace    52
 
 static COMMAND_LIST cmdline_commands[] =
 {
@@ -335,6 +421,7 @@ static COMMAND_LIST cmdline_commands[] =
    { CommandBitrate,       "-bitrate",    "b",  "Set bitrate. Use bits per second (e.g. 10MBits/s would be -b 10000000)", 1 },
    { CommandOutput,        "-output",     "o",  "Output filename <filename> (to write to stdout, use '-o -').\n"
          "\t\t  Connect to a remote IPv4 host (e.g. tcp://192.168.1.2:1234, udp://192.168.1.2:1234)\n"
+         "\t\t  Send as RTP to a host or multicast group (e.g. rtp://192.168.1.2:5004), use with -ih\n"
          "\t\t  To listen on a TCP port (IPv4) and wait for an incoming connection use -l\n"
          "\t\t  (e.g. raspivid -l -o tcp://0.0.0.0:3333 -> bind to all network interfaces, raspivid -l -o tcp://192.168.1.1:3333 -> bind to a certain local IPv4)", 1 },
    { CommandVerbose,       "-verbose",    "v",  "Output verbose information during run", 0 },
@@ -367,6 +454,24 @@ static COMMAND_LIST cmdline_commands[] =
    { CommandRaw,           "-raw",        "r",  "Output filename <filename> for raw video", 1 },
    { CommandRawFormat,     "-raw-format", "rf", "Specify output format for raw video. Default is yuv", 1},
    { CommandNetListen,     "-listen",     "l", "Listen on a TCP socket", 0},
+   { CommandGovernor,      "-governor",   "gov","Lower framerate and tracker load when the ball is idle", 0},
+   { CommandReplay,        "-replay",     "rp", "Keep the last <seconds> of video in memory for replays", 1},
+   { CommandReplayFile,    "-replay-file","rpf","Replay clip <filename> written on SAVE and goal events, as MP4 if it ends in .mp4", 1},
+   { CommandSlowmo,        "-slowmo",     "smo","Play goal replays <factor> (2-4) times slower, use with a high framerate mode", 1},
+   { CommandSlowmoWindow,  "-slowmo-window","smw","Milliseconds around the goal played in slow motion", 1},
+   { CommandHighlights,    "-highlights", "hl", "Append goals, saves and shots in the recording to index <filename>", 1},
+   { CommandRtpPace,       "-rtp-pace",   "rtpp","Spread the RTP packets of a frame over <percent> of the frame interval, 0 to send at once. Default 50", 1},
+   { CommandSdp,           "-sdp",        "sdp","Write the session description of the RTP output to <filename>", 1},
+   { CommandWebSocket,     "-websocket",  "ws", "Serve tracker events on WebSocket <port> (8420 for the web interface)", 1},
+   { CommandState,         "-state",      "st", "Publish the tracker state in shared memory <name> (" RASPISTATE_DEFAULT_NAME " for raspiballstate)", 1},
+   { CommandCapture,       "-capture",    "cap","Keep the last <frames> frames on the GPU for dumps to " CAPTURE_DEFAULT_PREFIX "*", 1},
+   { CommandCaptureFilter, "-capturefilter", "capf", "Capture the phase 1 filter output instead of the camera frames", 0},
+   { CommandCapturePng,    "-capturepng", "capp","Write captured frames as PNG instead of raw RGBA", 0},
+   { CommandCaptureGoal,   "-capturegoal","capg","Dump the <frames> captured frames before each goal", 1},
+   { CommandPipeline,      "-pipeline",   "pipe","Read back the filter grid <targets> - 1 filtered frames late from a ring of <targets> (2-4), 1 to wait for each frame", 1},
+   { CommandGridPasses,    "-gridpasses", "gp", "Downsample to the filter grid in <passes>: 1 fused pass, 2 separable passes (default)", 1},
+   { CommandPortStats,     "-portstats",  "ps", "Print the MMAL port rates and latencies every <ms> to stderr", 1},
+   { CommandMmalTrace,     "-mmaltrace",  "mtr","Trace the MMAL buffer flow to <filename> on exit, for mmaltrace to turn into Chrome trace JSON", 1},
 };
 
 static int cmdline_commands_size = sizeof(cmdline_commands) / sizeof(cmdline_commands[0]);
@@ -443,6 +548,32 @@ static void default_status(RASPIVID_STATE *state)
    state->save_pts = 0;
 
    state->netListen = false;
+   state->governor = 0;
+   state->replayTime = 0;
+   state->replay_filename = REPLAY_DEFAULT_FILENAME;
+   state->slowmo = 0;
+   state->slowmo_window = REPLAY_SLOWMO_WINDOW_MS;
+   state->slowmo_goal = 0;
+   state->slowmo_due = 0;
+   state->highlights_filename = NULL;
+   state->highlight_count = 0;
+   state->rtpPace = RTP_DEFAULT_PACE;
+   state->sdp_filename = NULL;
+   state->websocketPort = 0;
+   state->capture_command = -1;
+   state->replay_command = 0;
+   state->websocket = NULL;
+   state->state_name = NULL;
+   state->tracker_state = NULL;
+   state->captureFrames = 0;
+   state->captureFilter = 0;
+   state->capturePng = 0;
+   state->captureGoal = 0;
+   state->pipeline = 1;
+   state->gridPasses = 2;
+   state->portStatsInterval = 0;
+   state->port_stats = NULL;
+   state->mmal_trace_filename = NULL;
 
 
    // Setup preview window defaults
@@ -905,6 +1036,192 @@ static int parse_cmdline(int argc, const char **argv, RASPIVID_STATE *state)
          break;
       }
 
+      case CommandGovernor:
+      {
+         state->governor = 1;
+
+         break;
+      }
+
+      case CommandReplay:
+      {
+         if (sscanf(argv[i + 1], "%u", &state->replayTime) == 1)
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandReplayFile:
+      {
+         int len = strlen(argv[i + 1]);
+         if (len)
+         {
+            state->replay_filename = malloc(len + 1);
+            vcos_assert(state->replay_filename);
+            if (state->replay_filename)
+               strncpy(state->replay_filename, argv[i + 1], len+1);
+            i++;
+         }
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandSlowmo:
+      {
+         if (sscanf(argv[i + 1], "%u", &state->slowmo) == 1 && state->slowmo >= 1 && state->slowmo <= 4)
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandSlowmoWindow:
+      {
+         if (sscanf(argv[i + 1], "%u", &state->slowmo_window) == 1 && state->slowmo_window > 0)
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandHighlights:
+      {
+         int len = strlen(argv[i + 1]);
+         if (len)
+         {
+            state->highlights_filename = malloc(len + 1);
+            vcos_assert(state->highlights_filename);
+            if (state->highlights_filename)
+               strncpy(state->highlights_filename, argv[i + 1], len+1);
+            i++;
+         }
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandRtpPace:
+      {
+         if (sscanf(argv[i + 1], "%d", &state->rtpPace) == 1 && state->rtpPace >= 0 && state->rtpPace <= 100)
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandWebSocket:
+      {
+         if (sscanf(argv[i + 1], "%d", &state->websocketPort) == 1 && state->websocketPort > 0 && state->websocketPort < 65536)
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandCapture:
+      {
+         if (sscanf(argv[i + 1], "%d", &state->captureFrames) == 1 && state->captureFrames > 0)
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandCaptureFilter:
+         state->captureFilter = 1;
+         break;
+
+      case CommandCapturePng:
+         state->capturePng = 1;
+         break;
+
+      case CommandCaptureGoal:
+      {
+         if (sscanf(argv[i + 1], "%d", &state->captureGoal) == 1 && state->captureGoal > 0)
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandPipeline:
+      {
+         if (sscanf(argv[i + 1], "%d", &state->pipeline) == 1 && state->pipeline >= 1 &&
+             state->pipeline <= BALLTRACK_MAX_PIPELINE)
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandGridPasses:
+      {
+         if (sscanf(argv[i + 1], "%d", &state->gridPasses) == 1 && (state->gridPasses == 1 || state->gridPasses == 2))
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandPortStats:
+      {
+         if (sscanf(argv[i + 1], "%d", &state->portStatsInterval) == 1 && state->portStatsInterval > 0)
+            i++;
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandMmalTrace:
+      {
+         int len = strlen(argv[i + 1]);
+         if (len)
+         {
+            state->mmal_trace_filename = malloc(len + 1);
+            vcos_assert(state->mmal_trace_filename);
+            if (state->mmal_trace_filename)
+               strncpy(state->mmal_trace_filename, argv[i + 1], len+1);
+            i++;
+         }
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandState:
+      {
+         int len = strlen(argv[i + 1]);
+         if (len > 1 && argv[i + 1][0] == '/' && !strchr(argv[i + 1] + 1, '/'))
+         {
+            state->state_name = malloc(len + 1);
+            vcos_assert(state->state_name);
+            if (state->state_name)
+               strncpy(state->state_name, argv[i + 1], len + 1);
+            i++;
+         }
+         else
+            valid = 0;
+         break;
+      }
+
+      case CommandSdp:
+      {
+         int len = strlen(argv[i + 1]);
+         if (len)
+         {
+            state->sdp_filename = malloc(len + 1);
+            vcos_assert(state->sdp_filename);
+            if (state->sdp_filename)
+               strncpy(state->sdp_filename, argv[i + 1], len+1);
+            i++;
+         }
+         else
+            valid = 0;
+         break;
+      }
+
       default:
       {
          // Try parsing for any image specific parameters
@@ -946,7 +1263,7 @@ static int parse_cmdline(int argc, const char **argv, RASPIVID_STATE *state)
    state->raspitex_state.preview_y       = state->preview_parameters.previewWindow.y;
    state->raspitex_state.preview_width   = state->preview_parameters.previewWindow.width;
    state->raspitex_state.preview_height  = state->preview_parameters.previewWindow.height;
-   state->raspitex_state.opacity         = state->preview_parameters.opacity;
+   state->raspitex_state.opacity         = state->preview_parameters.wantPreview ? state->preview_parameters.opacity : 0;
    state->raspitex_state.verbose         = state->verbose;
 
    if (!valid)
@@ -1074,8 +1391,10 @@ static void camera_control_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buf
  * Open a file based on the settings in state
  *
  * @param state Pointer to state
+ * @param filename Filename, a format string with the segment number in segment mode
+ * @param segment Segment number to open
  */
-static FILE *open_filename(RASPIVID_STATE *pState, char *filename)
+static FILE *open_segment_filename(RASPIVID_STATE *pState, char *filename, int segment)
 {
    FILE *new_handle = NULL;
    char *tempname = NULL;
@@ -1083,7 +1402,7 @@ static FILE *open_filename(RASPIVID_STATE *pState, char *filename)
    if (pState->segmentSize || pState->splitWait)
    {
       // Create a new filename string
-      asprintf(&tempname, filename, pState->segmentNumber);
+      asprintf(&tempname, filename, segment);
       filename = tempname;
    }
 
@@ -1223,6 +1542,84 @@ static FILE *open_filename(RASPIVID_STATE *pState, char *filename)
    return new_handle;
 }
 
+/**
+ * Open a file for the current segment
+ *
+ * @param state Pointer to state
+ */
+static FILE *open_filename(RASPIVID_STATE *pState, char *filename)
+{
+   return open_segment_filename(pState, filename, pState->segmentNumber);
+}
+
+/**
+ * Create the RTP sender for an rtp://host:port output
+ *
+ * @param address The filename after rtp://
+ */
+static RASPIRTP_T *open_rtp(RASPIVID_STATE *pState, const char *address)
+{
+   const char *port = strrchr(address, ':');
+   char host[64];
+   RASPIRTP_T *rtp;
+
+   if (!port || port == address || port - address >= (int)sizeof(host) || !port[1])
+   {
+      fprintf(stderr, "%s is not a valid host:port, use something like rtp://192.168.1.2:5004\n", address);
+      return NULL;
+   }
+   memcpy(host, address, port - address);
+   host[port - address] = '\0';
+
+   rtp = raspirtp_create(host, port + 1, RASPIRTP_DEFAULT_MTU);
+   if (rtp)
+      raspirtp_set_pacing(rtp, pState->rtpPace);
+   return rtp;
+}
+
+/**
+ * Write the session description of the RTP output once the stream headers
+ * have been sent
+ */
+static void write_sdp(PORT_USERDATA *pData)
+{
+   char sdp[1024];
+   FILE *file;
+
+   if (raspirtp_get_sdp(pData->rtp, sdp, sizeof(sdp)) != 0)
+      return;
+
+   pData->sdp_written = 1;
+   file = fopen(pData->pstate->sdp_filename, "w");
+   if (!file || fputs(sdp, file) == EOF)
+      vcos_log_error("Unable to write %s", pData->pstate->sdp_filename);
+   if (file)
+      fclose(file);
+}
+
+/**
+ * Opens the file of a stream for a new segment, called by the writer
+ * thread on segment rollover. Streams written to stdout are kept.
+ */
+static FILE *writer_open_segment(void *userdata, RASPIWRITER_STREAM_T stream, int segment)
+{
+   RASPIVID_STATE *pState = (RASPIVID_STATE *)userdata;
+   char *filename = NULL;
+
+   switch (stream)
+   {
+   case RASPIWRITER_VIDEO: filename = pState->filename; break;
+   case RASPIWRITER_IMV: filename = pState->imv_filename; break;
+   case RASPIWRITER_PTS: filename = pState->pts_filename; break;
+   default: break;
+   }
+
+   if (!filename || filename[0] == '-')
+      return NULL;
+
+   return open_segment_filename(pState, filename, segment);
+}
+
 /**
  * Update any annotation data specific to the video.
  * This simply passes on the setting from cli, or
@@ -1292,87 +1689,46 @@ static void encoder_buffer_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buf
       int bytes_written = buffer->length;
       int64_t current_time = vcos_getmicrosecs64()/1000;
 
-      vcos_assert(pData->file_handle);
+      vcos_assert(pData->file_handle || pData->replay || pData->rtp);
       if(pData->pstate->inlineMotionVectors) vcos_assert(pData->imv_file_handle);
 
-      if (pData->cb_buff)
+      if (pData->replay && buffer->length && !(buffer->flags & MMAL_BUFFER_HEADER_FLAG_CODECSIDEINFO))
       {
-         int space_in_buff = pData->cb_len - pData->cb_wptr;
-         int copy_to_end = space_in_buff > buffer->length ? buffer->length : space_in_buff;
-         int copy_to_start = buffer->length - copy_to_end;
-
-         if(buffer->flags & MMAL_BUFFER_HEADER_FLAG_CONFIG)
-         {
-            if(pData->header_wptr + buffer->length > sizeof(pData->header_bytes))
-            {
-               vcos_log_error("Error in header bytes\n");
-            }
-            else
-            {
-               // These are the header bytes, save them for final output
-               mmal_buffer_header_mem_lock(buffer);
-               memcpy(pData->header_bytes + pData->header_wptr, buffer->data, buffer->length);
-               mmal_buffer_header_mem_unlock(buffer);
-               pData->header_wptr += buffer->length;
-            }
-         }
-         else if((buffer->flags & MMAL_BUFFER_HEADER_FLAG_CODECSIDEINFO))
-         {
-            // Do something with the inline motion vectors...
-         }
-         else
-         {
-            static int frame_start = -1;
-            int i;
+         int flags = 0;
 
-            if(frame_start == -1)
-               frame_start = pData->cb_wptr;
+         if (buffer->flags & MMAL_BUFFER_HEADER_FLAG_KEYFRAME)
+            flags |= RASPIREPLAY_FLAG_KEYFRAME;
+         if (buffer->flags & MMAL_BUFFER_HEADER_FLAG_FRAME_END)
+            flags |= RASPIREPLAY_FLAG_FRAME_END;
+         if (buffer->flags & MMAL_BUFFER_HEADER_FLAG_CONFIG)
+            flags |= RASPIREPLAY_FLAG_CONFIG;
 
-            if(buffer->flags & MMAL_BUFFER_HEADER_FLAG_KEYFRAME)
-            {
-               pData->iframe_buff[pData->iframe_buff_wpos] = frame_start;
-               pData->iframe_buff_wpos = (pData->iframe_buff_wpos + 1) % IFRAME_BUFSIZE;
-            }
-
-            if(buffer->flags & MMAL_BUFFER_HEADER_FLAG_FRAME_END)
-               frame_start = -1;
+         mmal_buffer_header_mem_lock(buffer);
+         raspireplay_add(pData->replay, buffer->data, buffer->length, buffer->pts, flags);
+         mmal_buffer_header_mem_unlock(buffer);
+      }
 
-            // If we overtake the iframe rptr then move the rptr along
-            if((pData->iframe_buff_rpos + 1) % IFRAME_BUFSIZE != pData->iframe_buff_wpos)
-            {
-               while(
-                  (
-                     pData->cb_wptr <= pData->iframe_buff[pData->iframe_buff_rpos] &&
-                    (pData->cb_wptr + buffer->length) > pData->iframe_buff[pData->iframe_buff_rpos]
-                  ) ||
-                  (
-                    (pData->cb_wptr > pData->iframe_buff[pData->iframe_buff_rpos]) &&
-                    (pData->cb_wptr + buffer->length) > (pData->iframe_buff[pData->iframe_buff_rpos] + pData->cb_len)
-                  )
-               )
-                  pData->iframe_buff_rpos = (pData->iframe_buff_rpos + 1) % IFRAME_BUFSIZE;
-            }
+      if (pData->rtp && buffer->length && !(buffer->flags & MMAL_BUFFER_HEADER_FLAG_CODECSIDEINFO))
+      {
+         int flags = 0;
 
-            mmal_buffer_header_mem_lock(buffer);
-            // We are pushing data into a circular buffer
-            memcpy(pData->cb_buff + pData->cb_wptr, buffer->data, copy_to_end);
-            memcpy(pData->cb_buff, buffer->data + copy_to_end, copy_to_start);
-            mmal_buffer_header_mem_unlock(buffer);
+         if (buffer->flags & MMAL_BUFFER_HEADER_FLAG_FRAME_END)
+            flags |= RASPIRTP_FLAG_FRAME_END;
+         if (buffer->flags & MMAL_BUFFER_HEADER_FLAG_CONFIG)
+            flags |= RASPIRTP_FLAG_CONFIG;
 
-            if((pData->cb_wptr + buffer->length) > pData->cb_len)
-               pData->cb_wrap = 1;
+         // Packetized and queued for the sender thread, never blocks
+         mmal_buffer_header_mem_lock(buffer);
+         raspirtp_send(pData->rtp, buffer->data, buffer->length, buffer->pts == MMAL_TIME_UNKNOWN ? -1 : buffer->pts, flags);
+         mmal_buffer_header_mem_unlock(buffer);
 
-            pData->cb_wptr = (pData->cb_wptr + buffer->length) % pData->cb_len;
+         if (pData->pstate->sdp_filename && !pData->sdp_written && (flags & RASPIRTP_FLAG_FRAME_END))
+            write_sdp(pData);
+      }
 
-            for(i = pData->iframe_buff_rpos; i != pData->iframe_buff_wpos; i = (i + 1) % IFRAME_BUFSIZE)
-            {
-               int p = pData->iframe_buff[i];
-               if(pData->cb_buff[p] != 0 || pData->cb_buff[p+1] != 0 || pData->cb_buff[p+2] != 0 || pData->cb_buff[p+3] != 1)
-               {
-                  vcos_log_error("Error in iframe list\n");
-               }
-            }
-         }
+      if (!pData->writer)
+      {
+         // Nothing to write, the data is kept in the replay ring
       }
       else
       {
@@ -1384,8 +1740,6 @@ static void encoder_buffer_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buf
              ((pData->pstate->segmentSize && current_time > base_time + pData->pstate->segmentSize) ||
               (pData->pstate->splitWait && pData->pstate->splitNow)))
          {
-            FILE *new_handle;
-
             base_time = current_time;
 
             pData->pstate->splitNow = 0;
@@ -1395,61 +1749,73 @@ static void encoder_buffer_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buf
             if (pData->pstate->segmentWrap && pData->pstate->segmentNumber > pData->pstate->segmentWrap)
                pData->pstate->segmentNumber = 1;
 
-            if (pData->pstate->filename && pData->pstate->filename[0] != '-')
+            // The new files are opened by the writer thread, after everything
+            // queued for the current segment has been written
+            raspiwriter_split(pData->writer, pData->pstate->segmentNumber);
+            pData->segment_bytes = 0;
+         }
+         if (buffer->length)
+         {
+            // The data is copied to the writer, so the buffer goes back to the encoder right away
+            mmal_buffer_header_mem_lock(buffer);
+            if(buffer->flags & MMAL_BUFFER_HEADER_FLAG_CODECSIDEINFO)
             {
-               new_handle = open_filename(pData->pstate, pData->pstate->filename);
-
-               if (new_handle)
+               if(pData->pstate->inlineMotionVectors)
                {
-                  fclose(pData->file_handle);
-                  pData->file_handle = new_handle;
+                  if (raspiwriter_write(pData->writer, RASPIWRITER_IMV, buffer->data, buffer->length) < 0)
+                     bytes_written = 0;
                }
             }
-
-            if (pData->pstate->imv_filename && pData->pstate->imv_filename[0] != '-')
+            else
             {
-               new_handle = open_filename(pData->pstate, pData->pstate->imv_filename);
-
-               if (new_handle)
+               int is_config = (buffer->flags & MMAL_BUFFER_HEADER_FLAG_CONFIG) != 0;
+               int queued = 1;
+
+               // A dropped buffer breaks the stream until the next keyframe, so drop up to there
+               if (pData->video_dropping &&
+                   (is_config || (!pData->frame_started && (buffer->flags & MMAL_BUFFER_HEADER_FLAG_KEYFRAME))))
+                  pData->video_dropping = 0;
+               if (!pData->video_dropping)
                {
-                  fclose(pData->imv_file_handle);
-                  pData->imv_file_handle = new_handle;
+                  queued = raspiwriter_write(pData->writer, RASPIWRITER_VIDEO, buffer->data, buffer->length);
+                  if (queued < 0)
+                     bytes_written = 0;
+                  else if (queued > 0)
+                     pData->video_dropping = 1;
                }
-            }
-
-            if (pData->pstate->pts_filename && pData->pstate->pts_filename[0] != '-')
-            {
-               new_handle = open_filename(pData->pstate, pData->pstate->pts_filename);
-
-               if (new_handle)
+               else
                {
-                  fclose(pData->pts_file_handle);
-                  pData->pts_file_handle = new_handle;
+                  raspiwriter_skip(pData->writer, buffer->length);
                }
-            }
-         }
-         if (buffer->length)
-         {
-            mmal_buffer_header_mem_lock(buffer);
-            if(buffer->flags & MMAL_BUFFER_HEADER_FLAG_CODECSIDEINFO)
-            {
-               if(pData->pstate->inlineMotionVectors)
+
+               if (pData->highlights && queued == 0)
                {
-                  bytes_written = fwrite(buffer->data, 1, buffer->length, pData->imv_file_handle);
-                  if(pData->flush_buffers) fflush(pData->imv_file_handle);
+                  // Keyframes are indexed at their headers, so a clip cut from there decodes
+                  if (is_config)
+                  {
+                     if (pData->header_offset < 0)
+                        pData->header_offset = pData->segment_bytes;
+                  }
+                  else
+                  {
+                     if (!pData->frame_started && (buffer->flags & MMAL_BUFFER_HEADER_FLAG_KEYFRAME))
+                        raspihighlight_keyframe(pData->highlights, pData->pstate->segmentNumber,
+                                                pData->header_offset >= 0 ? pData->header_offset : pData->segment_bytes,
+                                                buffer->pts);
+                     pData->header_offset = -1;
+                  }
+                  pData->segment_bytes += buffer->length;
                }
-               else
+               else if (queued != 0)
                {
-                  //We do not want to save inlineMotionVectors...
-                  bytes_written = buffer->length;
+                  // Headers before a dropped frame do not start a clip
+                  pData->header_offset = -1;
                }
-            }
-            else
-            {
-               bytes_written = fwrite(buffer->data, 1, buffer->length, pData->file_handle);
-               if(pData->flush_buffers) fflush(pData->file_handle);
+               if (!is_config)
+                  pData->frame_started = !(buffer->flags & MMAL_BUFFER_HEADER_FLAG_FRAME_END);
 
-               if(pData->pstate->save_pts &&
+               // Timestamps only for frames that made it into the file
+               if(pData->pstate->save_pts && queued == 0 &&
                   (buffer->flags & MMAL_BUFFER_HEADER_FLAG_FRAME_END ||
                    buffer->flags == 0 ||
                    buffer->flags & MMAL_BUFFER_HEADER_FLAG_KEYFRAME) &&
@@ -1458,10 +1824,13 @@ static void encoder_buffer_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buf
                   if(buffer->pts != MMAL_TIME_UNKNOWN && buffer->pts != pData->pstate->lasttime)
                   {
                     int64_t pts;
+                    char line[32];
+                    int len;
                     if(pData->pstate->frame==0)pData->pstate->starttime=buffer->pts;
                     pData->pstate->lasttime=buffer->pts;
                     pts = buffer->pts - pData->pstate->starttime;
-                    fprintf(pData->pts_file_handle,"%lld.%03lld\n", pts/1000, pts%1000);
+                    len = snprintf(line, sizeof(line), "%lld.%03lld\n", pts/1000, pts%1000);
+                    raspiwriter_write(pData->writer, RASPIWRITER_PTS, line, len);
                     pData->pstate->frame++;
                   }
                }
@@ -1469,9 +1838,9 @@ static void encoder_buffer_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buf
 
             mmal_buffer_header_mem_unlock(buffer);
 
-            if (bytes_written != buffer->length)
+            if (bytes_written != buffer->length || raspiwriter_failed(pData->writer))
             {
-               vcos_log_error("Failed to write buffer data (%d from %d)- aborting", bytes_written, buffer->length);
+               vcos_log_error("Failed to write buffer data (%d bytes)- aborting", buffer->length);
                pData->abort = 1;
             }
          }
@@ -1829,6 +2198,303 @@ error:
    return status;
 }
 
+/**
+ * Governor callback to change the camera framerate while running.
+ * Called from the GL render thread.
+ *
+ * @param userdata Pointer to our state
+ * @param framerate New framerate in fps
+ */
+static void governor_set_framerate(void *userdata, int framerate)
+{
+   RASPIVID_STATE *state = (RASPIVID_STATE *)userdata;
+   MMAL_PARAMETER_FPS_RANGE_T fps_range = {{MMAL_PARAMETER_FPS_RANGE, sizeof(fps_range)},
+                                                { framerate, 1 }, { framerate, 1 }};
+   MMAL_STATUS_T status;
+
+   if (!state->camera_component)
+      return;
+
+   status = mmal_port_parameter_set(state->camera_component->output[MMAL_CAMERA_VIDEO_PORT], &fps_range.hdr);
+   if (status == MMAL_SUCCESS)
+      status = mmal_port_parameter_set(state->camera_component->output[MMAL_CAMERA_PREVIEW_PORT], &fps_range.hdr);
+
+   if (status != MMAL_SUCCESS)
+      vcos_log_error("Unable to set framerate to %d fps", framerate);
+}
+
+/**
+ * Have the replay export thread write a replay clip of at least REPLAY_CLIP_MS
+ *
+ * @param state Pointer to our state
+ * @param duration_us Clip length, raised to REPLAY_CLIP_MS if shorter
+ * @param slowmo Part of the clip to slow down, or NULL
+ */
+static void replay_write(RASPIVID_STATE *state, int64_t duration_us, const RASPIREPLAY_SLOWMO_T *slowmo)
+{
+   if (duration_us < REPLAY_CLIP_MS * 1000)
+      duration_us = REPLAY_CLIP_MS * 1000;
+
+   if (raspireplay_request_file(state->callback_data.replay, state->replay_filename, duration_us, slowmo) < 0)
+      vcos_log_error("Unable to write replay to %s", state->replay_filename);
+}
+
+/**
+ * Replay export callback, tells the WebSocket clients a new clip is there.
+ * Called from the replay export thread.
+ *
+ * @param userdata Pointer to our state
+ * @param filename The clip
+ * @param result Result of the export, negative on failure
+ */
+static void replay_done_callback(void *userdata, const char *filename, int result)
+{
+   RASPIVID_STATE *state = (RASPIVID_STATE *)userdata;
+
+   if (result >= 0 && state->websocket)
+      raspiws_post(state->websocket, "REPLAY");
+}
+
+/**
+ * WebSocket command callback. Start, stop and replay are left to the main
+ * loop, see run_websocket_commands. A dump request saves the frames in the
+ * capture ring.
+ * Called from the WebSocket server thread.
+ *
+ * @param userdata Pointer to our state
+ * @param command The command
+ */
+static void websocket_command_callback(void *userdata, RASPIWS_COMMAND_T command)
+{
+   RASPIVID_STATE *state = (RASPIVID_STATE *)userdata;
+
+   switch (command)
+   {
+   case RASPIWS_COMMAND_START:
+   case RASPIWS_COMMAND_STOP:
+      vcos_mutex_lock(&state->command_lock);
+      state->capture_command = command == RASPIWS_COMMAND_START;
+      vcos_mutex_unlock(&state->command_lock);
+      break;
+
+   case RASPIWS_COMMAND_REPLAY:
+      vcos_mutex_lock(&state->command_lock);
+      state->replay_command = 1;
+      vcos_mutex_unlock(&state->command_lock);
+      break;
+
+   case RASPIWS_COMMAND_DUMP:
+   {
+      char reply[32];
+
+      if (!state->captureFrames)
+      {
+         vcos_log_error("Dump requested without a capture ring, use -capture");
+         break;
+      }
+      snprintf(reply, sizeof(reply), "DUMP %d", capture_request(state->captureFrames, 0));
+      raspiws_post(state->websocket, reply);
+      break;
+   }
+   }
+}
+
+/**
+ * Run the commands posted by the WebSocket thread. Start and stop resume
+ * and pause the capture, so the tracker idles while nobody is watching. A
+ * replay request writes a replay clip, the clients are told when it is
+ * there. Called from the main thread while it waits.
+ *
+ * @param state Pointer to our state
+ */
+static void run_websocket_commands(RASPIVID_STATE *state)
+{
+   int capture, replay;
+
+   if (!state->websocket)
+      return;
+
+   vcos_mutex_lock(&state->command_lock);
+   capture = state->capture_command;
+   replay = state->replay_command;
+   state->capture_command = -1;
+   state->replay_command = 0;
+   vcos_mutex_unlock(&state->command_lock);
+
+   if (capture >= 0)
+   {
+      if (state->verbose)
+         fprintf(stderr, "WebSocket: %s video capture\n", capture ? "Starting" : "Pausing");
+      if (mmal_port_parameter_set_boolean(state->camera_component->output[MMAL_CAMERA_VIDEO_PORT],
+                                          MMAL_PARAMETER_CAPTURE, capture) != MMAL_SUCCESS)
+         vcos_log_error("Unable to %s capture", capture ? "start" : "stop");
+      else
+         state->bCapturing = capture;
+   }
+
+   if (replay)
+   {
+      if (!state->callback_data.replay)
+         vcos_log_error("Replay requested without a replay buffer, use -replay");
+      else
+         replay_write(state, 0, NULL);
+   }
+}
+
+/**
+ * Tracker event callback, exports a replay clip on SAVE and goal events.
+ * With slow motion enabled, goal replays are left to the frame callback,
+ * which knows the timestamp of the goal frame. Events for the highlight
+ * index also wait for the timestamp of their frame.
+ * Called from the GL render thread.
+ *
+ * @param event Event string as sent to the websocket server
+ * @param userdata Pointer to our state
+ */
+static void tracker_event_callback(const char *event, void *userdata)
+{
+   RASPIVID_STATE *state = (RASPIVID_STATE *)userdata;
+   int n = state->highlight_count;
+   RASPIHIGHLIGHT_TYPE_T type;
+   int team;
+   float speed;
+
+   if (state->callback_data.highlights && n < (int)(sizeof(state->highlight_type) / sizeof(state->highlight_type[0])) &&
+       raspihighlight_parse_event(event, &state->highlight_type[n], &state->highlight_team[n], &state->highlight_speed[n]))
+      state->highlight_count++;
+
+   if (state->tracker_state && raspihighlight_parse_event(event, &type, &team, &speed))
+   {
+      RASPISTATE_RECORD_T *record = &state->state_record;
+
+      if (type == RASPIHIGHLIGHT_GOAL)
+      {
+         record->events |= team == 1 ? RASPISTATE_EVENT_GOAL_RED : RASPISTATE_EVENT_GOAL_BLUE;
+         record->goals[team == 1 ? 0 : 1]++;
+      }
+      else if (type == RASPIHIGHLIGHT_SAVE)
+      {
+         record->events |= RASPISTATE_EVENT_SAVE;
+         record->saves++;
+      }
+      else
+      {
+         record->events |= RASPISTATE_EVENT_SHOT;
+         record->shots++;
+         record->speed = speed;
+      }
+   }
+
+   if (state->captureGoal && (!strcmp(event, "RG\n") || !strcmp(event, "BG\n")))
+      capture_request(state->captureGoal, (int)(analysis_get_goal_frames_ago() + 0.5f));
+
+   // SHOT is not part of the event protocol of the web interface
+   if (state->websocket && strncmp(event, "SHOT ", 5))
+      raspiws_post(state->websocket, event);
+
+   if (!state->callback_data.replay)
+      return;
+
+   if (state->slowmo > 1 && (!strcmp(event, "RG\n") || !strcmp(event, "BG\n")))
+      state->slowmo_goal = 1;
+   else if (!strcmp(event, "SAVE\n") || !strcmp(event, "RG\n") || !strcmp(event, "BG\n"))
+      replay_write(state, 0, NULL);
+}
+
+/**
+ * Publish the tracker state of a frame to the shared memory segment
+ *
+ * @param state Pointer to our state
+ * @param pts Camera timestamp of the frame
+ * @param ball Last ball position
+ * @param found Nonzero if the ball was found on this frame
+ */
+static void tracker_state_publish(RASPIVID_STATE *state, int64_t pts, const POINT *ball, int found)
+{
+   RASPISTATE_RECORD_T *record = &state->state_record;
+   struct timeval tv;
+
+   gettimeofday(&tv, NULL);
+   record->pts = pts;
+   record->time = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+   record->x = ball->x;
+   record->y = ball->y;
+   record->found = found;
+
+   raspistate_publish(state->tracker_state, record);
+   record->events = 0;
+}
+
+/**
+ * Tracker frame callback, publishes the tracker state, indexes the events
+ * of the frame, keeps the ball positions for the metadata track of MP4
+ * replays and writes slow motion goal replays once the frames after the
+ * goal are in. Called from the GL render thread.
+ *
+ * @param frame Preview frame that was just drawn
+ * @param result Last ball position, with the camera timestamp of its frame
+ * @param userdata Pointer to our state
+ */
+static void tracker_frame_callback(const BALLTRACK_FRAME *frame, const BALLTRACK_RESULT *result, void *userdata)
+{
+   RASPIVID_STATE *state = (RASPIVID_STATE *)userdata;
+   RASPIREPLAY_T *replay = state->callback_data.replay;
+   int64_t pts = result->pts;
+   const POINT *ball = &result->ball;
+   int found = result->found;
+   int i;
+
+   // No preview buffer yet
+   if (frame->pts == MMAL_TIME_UNKNOWN)
+      return;
+
+   if (state->tracker_state)
+      tracker_state_publish(state, pts, ball, found);
+
+   // The events of this frame came before it was reported
+   for (i = 0; i < state->highlight_count; i++)
+      raspihighlight_add(state->callback_data.highlights, state->highlight_type[i], state->highlight_team[i],
+                         pts, state->highlight_speed[i]);
+   state->highlight_count = 0;
+
+   if (!replay)
+      return;
+
+   raspireplay_add_ball(replay, pts, ball->x, ball->y, found);
+
+   if (state->slowmo_goal)
+   {
+      // The tracker has the timestamp of this frame by now
+      int64_t goal_pts = analysis_get_goal_pts();
+      int64_t half = (int64_t)state->slowmo_window * 500;
+
+      state->slowmo_goal = 0;
+      if (goal_pts == ANALYSIS_PTS_UNKNOWN)
+      {
+         replay_write(state, 0, NULL);
+         return;
+      }
+
+      state->slowmo_clip.start_pts = goal_pts - half;
+      state->slowmo_clip.end_pts = goal_pts + half;
+      state->slowmo_clip.factor = state->slowmo;
+      state->slowmo_due = 1;
+   }
+
+   // The encoder output lags the preview, so wait for the end of the
+   // slow motion part to be in the ring
+   if (state->slowmo_due)
+   {
+      int64_t last_pts = raspireplay_last_pts(replay);
+
+      if (last_pts != MMAL_TIME_UNKNOWN && last_pts >= state->slowmo_clip.end_pts)
+      {
+         state->slowmo_due = 0;
+         replay_write(state, last_pts - state->slowmo_clip.start_pts, &state->slowmo_clip);
+      }
+   }
+}
+
 /**
  * Destroy the camera component
  *
@@ -2348,7 +3014,8 @@ static void signal_handler(int signal_number)
 }
 
 /**
- * Pause for specified time, but return early if detect an abort request
+ * Pause for specified time, but return early if detect an abort request.
+ * WebSocket commands are run while pausing.
  *
  * @param state Pointer to state control struct
  * @param pause Time in ms to pause
@@ -2366,6 +3033,7 @@ static int pause_and_test_abort(RASPIVID_STATE *state, int pause)
    for (wait = 0; wait < pause; wait+= ABORT_INTERVAL)
    {
       vcos_sleep(ABORT_INTERVAL);
+      run_websocket_commands(state);
       if (state->callback_data.abort)
          return 1;
    }
@@ -2406,8 +3074,11 @@ static int wait_for_next_change(RASPIVID_STATE *state)
    {
       // We never return from this. Expect a ctrl-c to exit.
       while (1)
+      {
          // Have a sleep so we don't hog the CPU.
-         vcos_sleep(10000);
+         vcos_sleep(ABORT_INTERVAL);
+         run_websocket_commands(state);
+      }
 
       return 0;
    }
@@ -2429,12 +3100,25 @@ static int wait_for_next_change(RASPIVID_STATE *state)
 
    case WAIT_METHOD_KEYPRESS:
    {
+      static int line_start = 1;
       char ch;
 
       if (state->verbose)
          fprintf(stderr, "Press Enter to %s, X then ENTER to exit, [i,o,r] then ENTER to change zoom\n", state->bCapturing ? "pause" : "capture");
 
+      // Run WebSocket commands until a line is typed. The rest of a
+      // line is already buffered by stdio.
+      if (line_start && state->websocket)
+      {
+         struct pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+         int ready;
+
+         while ((ready = poll(&fd, 1, ABORT_INTERVAL)) == 0 || (ready < 0 && errno == EINTR))
+            run_websocket_commands(state);
+      }
+
       ch = getchar();
+      line_start = ch == '\n';
       if (ch == 'x' || ch == 'X')
          return 0;
       else if (ch == 'i' || ch == 'I')
@@ -2491,7 +3175,17 @@ static int wait_for_next_change(RASPIVID_STATE *state)
          fprintf(stderr, "Waiting for SIGUSR1 to %s\n", state->bCapturing ? "pause" : "capture");
       }
 
-      result = sigwait( &waitset, &sig );
+      if (state->websocket)
+      {
+         // Run WebSocket commands until the signal comes
+         struct timespec interval = { 0, ABORT_INTERVAL * 1000000L };
+
+         while ((sig = sigtimedwait( &waitset, NULL, &interval )) < 0 && (errno == EAGAIN || errno == EINTR))
+            run_websocket_commands(state);
+         result = sig < 0 ? -1 : 0;
+      }
+      else
+         result = sigwait( &waitset, &sig );
 
       if (state->verbose && result != 0)
          fprintf(stderr, "Bad signal received - error %d\n", errno);
@@ -2560,6 +3254,22 @@ int main(int argc, const char **argv)
 
 
    raspitex_init(&state.raspitex_state);
+   {
+      BALLTRACKER *tracker = balltrack_get_tracker();
+      BALLTRACK_CONFIG config;
+
+      balltracker_get_config(tracker, &config);
+      config.pipeline = state.pipeline;
+      config.separable = state.gridPasses == 2;
+      // The GL window stays, but without a preview nothing is drawn in it
+      config.display = state.preview_parameters.wantPreview;
+      balltracker_set_config(tracker, &config);
+   }
+
+   // Only the camera framerate is changed at runtime, the encoder keeps
+   // the timestamps so the recording plays back at the right speed
+   if (state.governor)
+      governor_init(state.framerate, governor_set_framerate, &state);
 
    // OK, we have a nice set of parameters. Now set up our components
    // We have three components. Camera, Preview and encoder.
@@ -2729,12 +3439,16 @@ int main(int argc, const char **argv)
                // Ensure we don't upset the output stream with diagnostics/info
                state.verbose = 0;
             }
+            else if (!strncmp("rtp://", state.filename, 6))
+            {
+               state.callback_data.rtp = open_rtp(&state, state.filename + 6);
+            }
             else
             {
                state.callback_data.file_handle = open_filename(&state, state.filename);
             }
 
-            if (!state.callback_data.file_handle)
+            if (!state.callback_data.file_handle && !state.callback_data.rtp)
             {
                // Notify user, carry on but discarding encoded output buffers
                vcos_log_error("%s: Error opening output file: %s\nNo output file will be generated\n", __func__, state.filename);
@@ -2830,27 +3544,159 @@ int main(int argc, const char **argv)
             }
             else
             {
+               // The circular buffer is a replay ring that is written out on exit
                int count = state.bitrate * (state.timeout / 1000) / 8;
 
-               state.callback_data.cb_buff = (char *) malloc(count);
-               if(state.callback_data.cb_buff == NULL)
+               state.callback_data.replay = raspireplay_create(count);
+               if(state.callback_data.replay == NULL)
                {
                   vcos_log_error("%s: Unable to allocate circular buffer for %d seconds at %.1f Mbits\n", __func__, state.timeout / 1000, (double)state.bitrate/1000000.0);
                   goto error;
                }
+            }
+         }
+
+         if (state.replayTime && state.callback_data.replay)
+         {
+            vcos_log_error("%s: Error, replay buffer can not be combined with circular buffer mode\n", __func__);
+            goto error;
+         }
+         else if (state.replayTime)
+         {
+            // Twice the nominal size, keyframes and VBR can go well over the bitrate
+            int bitrate = state.bitrate ? state.bitrate : MAX_BITRATE_LEVEL4;
+            int count = 2 * (bitrate / 8) * state.replayTime;
+
+            state.callback_data.replay = raspireplay_create(count);
+            if (!state.callback_data.replay)
+            {
+               vcos_log_error("%s: Unable to allocate replay buffer for %d seconds\n", __func__, state.replayTime);
+               goto error;
+            }
+
+            {
+               // Control requests write their clips next to ours
+               char replay_dir[256];
+               char *slash;
+
+               strncpy(replay_dir, state.replay_filename, sizeof(replay_dir) - 1);
+               replay_dir[sizeof(replay_dir) - 1] = 0;
+               slash = strrchr(replay_dir, '/');
+               if (slash)
+                  *slash = 0;
                else
-               {
-                  state.callback_data.cb_len = count;
-                  state.callback_data.cb_wptr = 0;
-                  state.callback_data.cb_wrap = 0;
-                  state.callback_data.cb_data = 0;
-                  state.callback_data.iframe_buff_wpos = 0;
-                  state.callback_data.iframe_buff_rpos = 0;
-                  state.callback_data.header_wptr = 0;
-               }
+                  strcpy(replay_dir, ".");
+               raspireplay_start_control(state.callback_data.replay, REPLAY_CONTROL_SOCKET, replay_dir);
+            }
+            raspireplay_start_exporter(state.callback_data.replay, replay_done_callback, &state);
+            raspireplay_set_format(state.callback_data.replay, state.width, state.height);
+         }
+
+         if (state.callback_data.file_handle && !state.bCircularBuffer)
+         {
+            // Stage about two seconds of video, so slow storage does not stall the encoder
+            int bitrate = state.bitrate ? state.bitrate : MAX_BITRATE_LEVEL4;
+            int size = 2 * (bitrate / 8);
+
+            if (size < WRITER_MIN_SIZE)
+               size = WRITER_MIN_SIZE;
+
+            state.callback_data.writer = raspiwriter_create(size, writer_open_segment, &state);
+            if (!state.callback_data.writer)
+            {
+               vcos_log_error("%s: Unable to create the file writer\n", __func__);
+               goto error;
+            }
+
+            // Reserve room for a whole segment, or a few seconds when not segmenting
+            if (state.segmentSize)
+               raspiwriter_set_prealloc(state.callback_data.writer, (int64_t)(bitrate / 8) * state.segmentSize / 1000 * 5 / 4);
+            else
+               raspiwriter_set_prealloc(state.callback_data.writer, (int64_t)(bitrate / 8) * WRITER_PREALLOC_SECONDS);
+            raspiwriter_set_flush(state.callback_data.writer, state.callback_data.flush_buffers);
+
+            raspiwriter_set_file(state.callback_data.writer, RASPIWRITER_VIDEO, state.callback_data.file_handle);
+            raspiwriter_set_file(state.callback_data.writer, RASPIWRITER_IMV, state.callback_data.imv_file_handle);
+            raspiwriter_set_file(state.callback_data.writer, RASPIWRITER_PTS, state.callback_data.pts_file_handle);
+         }
+
+         if (state.highlights_filename)
+         {
+            if (!state.callback_data.writer || state.filename[0] == '-' || strstr(state.filename, "://"))
+            {
+               vcos_log_error("%s: Error, the highlight index needs a recording to a file\n", __func__);
+               goto error;
+            }
+
+            // Segmented recordings store the pattern, the index has the segment numbers
+            state.callback_data.highlights = raspihighlight_open(state.highlights_filename, state.filename);
+            if (!state.callback_data.highlights)
+            {
+               vcos_log_error("%s: Unable to open highlight index %s\n", __func__, state.highlights_filename);
+               goto error;
+            }
+            state.callback_data.header_offset = -1;
+         }
+
+         if (state.websocketPort)
+         {
+            vcos_mutex_create(&state.command_lock, "RaspiBalls commands");
+            state.websocket = raspiws_create(state.websocketPort, RASPIWS_HEARTBEAT_MS, websocket_command_callback, &state);
+            if (!state.websocket)
+            {
+               vcos_log_error("%s: Unable to start the WebSocket server on port %d\n", __func__, state.websocketPort);
+               vcos_mutex_delete(&state.command_lock);
+               goto error;
             }
          }
 
+         if (state.mmal_trace_filename && mmal_trace_start(0, 0) != MMAL_SUCCESS)
+            vcos_log_error("%s: MMAL tracing is not available\n", __func__);
+
+         if (state.portStatsInterval)
+         {
+            MMAL_COMPONENT_T *components[] = { state.camera_component, state.splitter_component,
+               state.encoder_component, state.preview_parameters.preview_component };
+
+            state.port_stats = raspiportstats_create(components, sizeof(components) / sizeof(components[0]),
+                                                     state.portStatsInterval, stderr);
+            if (!state.port_stats)
+            {
+               vcos_log_error("%s: Unable to start the port statistics\n", __func__);
+               goto error;
+            }
+         }
+
+         if (state.state_name)
+         {
+            state.tracker_state = raspistate_create(state.state_name);
+            if (!state.tracker_state)
+            {
+               vcos_log_error("%s: Unable to create tracker state %s: %s\n", __func__, state.state_name, strerror(errno));
+               goto error;
+            }
+         }
+
+         // Before the GL thread starts, it creates the textures of the ring
+         if (state.captureFrames)
+         {
+            if (capture_init(state.captureFrames, state.captureFilter ? CAPTURE_FILTER : CAPTURE_SOURCE,
+                             state.capturePng ? CAPTURE_PNG : CAPTURE_RAW, CAPTURE_DEFAULT_PREFIX) != 0)
+            {
+               vcos_log_error("%s: Unable to set up the capture ring\n", __func__);
+               goto error;
+            }
+         }
+
+         if (state.replayTime || state.callback_data.highlights || state.websocket || state.tracker_state ||
+             state.captureGoal)
+         {
+            state.tracker_sink.frame = tracker_frame_callback;
+            state.tracker_sink.event = tracker_event_callback;
+            state.tracker_sink.userdata = &state;
+            balltracker_add_sink(balltrack_get_tracker(), &state.tracker_sink);
+         }
+
          // Set up our userdata - this is passed though to the callback where we need the information.
          encoder_output_port->userdata = (struct MMAL_PORT_USERDATA_T *)&state.callback_data;
 
@@ -2887,41 +3733,38 @@ int main(int argc, const char **argv)
          }
          else
          {
-            // Only encode stuff if we have a filename and it opened
+            // Only encode stuff if we have a filename and it opened, or keep a replay buffer
             // Note we use the copy in the callback, as the call back MIGHT change the file handle
-            if (state.callback_data.file_handle)
+            if (state.callback_data.file_handle || state.callback_data.replay || state.callback_data.rtp)
             {
                int running = 1;
 
                // Send all the buffers to the encoder output port
                {
-                  int num = mmal_queue_length(state.encoder_pool->queue);
-                  int q;
-                  for (q=0;q<num;q++)
-                  {
-                     MMAL_BUFFER_HEADER_T *buffer = mmal_queue_get(state.encoder_pool->queue);
+                  MMAL_BUFFER_HEADER_T *buffers = mmal_queue_get_batch(state.encoder_pool->queue, 0);
 
-                     if (!buffer)
-                        vcos_log_error("Unable to get a required buffer %d from pool queue", q);
+                  if (!buffers)
+                     vcos_log_error("Unable to get the buffers from pool queue");
 
-                     if (mmal_port_send_buffer(encoder_output_port, buffer)!= MMAL_SUCCESS)
-                        vcos_log_error("Unable to send a buffer to encoder output port (%d)", q);
+                  if (mmal_port_send_buffers(encoder_output_port, &buffers) != MMAL_SUCCESS)
+                  {
+                     vcos_log_error("Unable to send the buffers to encoder output port");
+                     mmal_queue_put_batch(state.encoder_pool->queue, buffers);
                   }
                }
 
                // Send all the buffers to the splitter output port
-               if (state.raw_output) {
-                  int num = mmal_queue_length(state.splitter_pool->queue);
-                  int q;
-                  for (q = 0; q < num; q++)
-                  {
-                     MMAL_BUFFER_HEADER_T *buffer = mmal_queue_get(state.splitter_pool->queue);
+               if (state.raw_output)
+               {
+                  MMAL_BUFFER_HEADER_T *buffers = mmal_queue_get_batch(state.splitter_pool->queue, 0);
 
-                     if (!buffer)
-                        vcos_log_error("Unable to get a required buffer %d from pool queue", q);
+                  if (!buffers)
+                     vcos_log_error("Unable to get the buffers from pool queue");
 
-                     if (mmal_port_send_buffer(splitter_output_port, buffer)!= MMAL_SUCCESS)
-                        vcos_log_error("Unable to send a buffer to splitter output port (%d)", q);
+                  if (mmal_port_send_buffers(splitter_output_port, &buffers) != MMAL_SUCCESS)
+                  {
+                     vcos_log_error("Unable to send the buffers to splitter output port");
+                     mmal_queue_put_batch(state.splitter_pool->queue, buffers);
                   }
                }
 
@@ -2981,7 +3824,10 @@ int main(int argc, const char **argv)
                {
                   // timeout = 0 so run forever
                   while(1)
+                  {
                      vcos_sleep(ABORT_INTERVAL);
+                     run_websocket_commands(&state);
+                  }
                }
             }
          }
@@ -2992,24 +3838,12 @@ int main(int argc, const char **argv)
          vcos_log_error("%s: Failed to connect camera to preview", __func__);
       }
 
-      if(state.bCircularBuffer)
+      if(state.bCircularBuffer && state.callback_data.replay)
       {
-         int copy_from_end, copy_from_start;
-
-         copy_from_end = state.callback_data.cb_len - state.callback_data.iframe_buff[state.callback_data.iframe_buff_rpos];
-         copy_from_start = state.callback_data.cb_len - copy_from_end;
-         copy_from_start = state.callback_data.cb_wptr < copy_from_start ? state.callback_data.cb_wptr : copy_from_start;
-         if(!state.callback_data.cb_wrap)
-         {
-            copy_from_start = state.callback_data.cb_wptr;
-            copy_from_end = 0;
-         }
-
-         fwrite(state.callback_data.header_bytes, 1, state.callback_data.header_wptr, state.callback_data.file_handle);
-         // Save circular buffer
-         fwrite(state.callback_data.cb_buff + state.callback_data.iframe_buff[state.callback_data.iframe_buff_rpos], 1, copy_from_end, state.callback_data.file_handle);
-         fwrite(state.callback_data.cb_buff, 1, copy_from_start, state.callback_data.file_handle);
-         if(state.callback_data.flush_buffers) fflush(state.callback_data.file_handle);
+         // Save circular buffer, starting at the oldest keyframe
+         fflush(state.callback_data.file_handle);
+         if (raspireplay_export(state.callback_data.replay, fileno(state.callback_data.file_handle), 0) < 0)
+            vcos_log_error("%s: Unable to save circular buffer\n", __func__);
       }
 
 error:
@@ -3019,6 +3853,17 @@ error:
       if (state.verbose)
          fprintf(stderr, "Closing down\n");
 
+      // Before the components go away, with the table of the last interval
+      raspiportstats_destroy(state.port_stats);
+      state.port_stats = NULL;
+
+      if (state.mmal_trace_filename)
+      {
+         mmal_trace_stop();
+         if (mmal_trace_write(state.mmal_trace_filename) == MMAL_SUCCESS && state.verbose)
+            fprintf(stderr, "MMAL trace written to %s\n", state.mmal_trace_filename);
+      }
+
       raspitex_stop(&state.raspitex_state);
       raspitex_destroy(&state.raspitex_state);
 
@@ -3036,6 +3881,44 @@ error:
       if (state.splitter_connection)
          mmal_connection_destroy(state.splitter_connection);
 
+      // The ports are disabled, so nothing is queued anymore. Write out what
+      // is left and take back the files of the last segment.
+      if (state.callback_data.writer)
+      {
+         RASPIWRITER_STATS_T stats;
+
+         raspiwriter_drain(state.callback_data.writer);
+         raspiwriter_get_stats(state.callback_data.writer, &stats);
+         if (state.verbose || stats.stalls || stats.dropped)
+            fprintf(stderr, "Writer: %llu bytes in %llu writes for %llu buffers, %d segments, high water %d bytes, "
+                    "slowest write %u us, %d stalls for %llu us, %d buffers of %llu bytes dropped\n",
+                    (unsigned long long)stats.bytes, (unsigned long long)stats.writes, (unsigned long long)stats.jobs,
+                    stats.segments, stats.high_water, stats.max_write_us, stats.stalls, (unsigned long long)stats.stall_us,
+                    stats.dropped, (unsigned long long)stats.dropped_bytes);
+
+         state.callback_data.file_handle = raspiwriter_get_file(state.callback_data.writer, RASPIWRITER_VIDEO);
+         state.callback_data.imv_file_handle = raspiwriter_get_file(state.callback_data.writer, RASPIWRITER_IMV);
+         state.callback_data.pts_file_handle = raspiwriter_get_file(state.callback_data.writer, RASPIWRITER_PTS);
+         raspiwriter_destroy(state.callback_data.writer);
+         state.callback_data.writer = NULL;
+      }
+
+      if (state.callback_data.rtp)
+      {
+         RASPIRTP_STATS_T stats;
+
+         raspirtp_drain(state.callback_data.rtp);
+         raspirtp_get_stats(state.callback_data.rtp, &stats);
+         if (state.verbose || stats.dropped_frames || stats.send_errors)
+            fprintf(stderr, "RTP: %llu frames in %llu packets (%u STAP-A, %u FU-A), %llu bytes in %llu sendmmsg calls, "
+                    "%u frames dropped, %u send errors, high water %d packets, slowest frame %u us\n",
+                    (unsigned long long)stats.frames, (unsigned long long)stats.packets, stats.stap_packets,
+                    stats.fu_packets, (unsigned long long)stats.bytes, (unsigned long long)stats.send_calls,
+                    stats.dropped_frames, stats.send_errors, stats.high_water, stats.max_frame_us);
+         raspirtp_destroy(state.callback_data.rtp);
+         state.callback_data.rtp = NULL;
+      }
+
       // Can now close our file. Note disabling ports may flush buffers which causes
       // problems if we have already closed the file!
       if (state.callback_data.file_handle && state.callback_data.file_handle != stdout)
@@ -3047,6 +3930,58 @@ error:
       if (state.callback_data.raw_file_handle && state.callback_data.raw_file_handle != stdout)
          fclose(state.callback_data.raw_file_handle);
 
+      balltracker_remove_sink(balltrack_get_tracker(), &state.tracker_sink);
+
+      // Clips still being written are announced to the WebSocket clients
+      if (state.callback_data.replay)
+         raspireplay_stop_exporter(state.callback_data.replay);
+
+      // Before the components go, commands use the camera and the replay ring
+      if (state.websocket)
+      {
+         RASPIWS_STATS_T stats;
+
+         raspiws_get_stats(state.websocket, &stats);
+         if (state.verbose)
+            fprintf(stderr, "WebSocket: %llu connections, %llu events in %llu messages, %u events dropped, "
+                    "%u slow clients, latency %.0f us average, %u us max\n",
+                    (unsigned long long)stats.connections, (unsigned long long)stats.events,
+                    (unsigned long long)stats.messages, stats.dropped_events, stats.slow_clients,
+                    stats.events ? (double)stats.total_latency_us / stats.events : 0.0, stats.max_latency_us);
+         raspiws_destroy(state.websocket);
+         state.websocket = NULL;
+         vcos_mutex_delete(&state.command_lock);
+      }
+
+      // Readers see the segment as closed, and it is unlinked
+      raspistate_destroy(state.tracker_state);
+      state.tracker_state = NULL;
+
+      // After the GL thread and the WebSocket server, the last ones to use the ring
+      if (capture_enabled())
+      {
+         CAPTURE_STATS stats;
+
+         capture_get_stats(&stats);
+         if (state.verbose)
+            fprintf(stderr, "Capture: %u frames captured, %u missed, %u requested, %u written, %u failed, "
+                    "readback %u us max\n", stats.captured, stats.missed, stats.requested, stats.written,
+                    stats.failed, stats.max_readback_us);
+         capture_destroy();
+      }
+
+      if (state.callback_data.replay)
+      {
+         raspireplay_destroy(state.callback_data.replay);
+         state.callback_data.replay = NULL;
+      }
+
+      if (state.callback_data.highlights)
+      {
+         raspihighlight_close(state.callback_data.highlights);
+         state.callback_data.highlights = NULL;
+      }
+
       /* Disable components */
       if (state.encoder_component)
          mmal_component_disable(state.encoder_component);
@@ -0,0 +1,579 @@
+/**
+ * \file RaspiHighlights.c
+ * Append-only index of tracker events in recorded video, see RaspiHighlights.h
+ *
+ * The encoder callback reports every keyframe with its segment and offset,
+ * the last few are kept in a small ring. Tracker events, which arrive on
+ * the GL thread, are stored with the newest keyframe at or before their
+ * timestamp. Each entry is a single write to a file opened with O_APPEND,
+ * and so is the game record written when the index is opened.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include "interface/vcos/vcos.h"
+
+#include "RaspiHighlights.h"
+
+static VCOS_LOG_CAT_T raspihighlight_log_category;
+#define VCOS_LOG_CATEGORY (&raspihighlight_log_category)
+
+/// Recent keyframes kept to match events against, the tracker runs a few frames ahead of the encoder at most
+#define KEYFRAME_COUNT 16
+
+typedef struct
+{
+   uint32_t segment;
+   uint64_t offset;
+   int64_t pts;
+} KEYFRAME_T;
+
+struct RASPIHIGHLIGHT_S
+{
+   VCOS_MUTEX_T lock;
+   int fd;
+
+   KEYFRAME_T keyframes[KEYFRAME_COUNT];
+   int keyframe_head;               /// Next keyframe to write
+   int keyframe_count;
+
+   uint32_t game;
+   uint32_t count[RASPIHIGHLIGHT_TYPES];
+};
+
+/**
+ * Check that a video filename has at most one conversion, a %d for the
+ * segment number, so it can be used as a format string.
+ */
+static int valid_video_pattern(const char *video)
+{
+   const char *p = video;
+   int conversions = 0;
+
+   while ((p = strchr(p, '%')) != NULL)
+   {
+      p++;
+      if (*p == '%')
+      {
+         p++;
+         continue;
+      }
+      while (*p >= '0' && *p <= '9')
+         p++;
+      if (*p != 'd' || ++conversions > 1)
+         return 0;
+   }
+   return 1;
+}
+
+/**
+ * Read the last entry of an existing index and drop a partial one.
+ *
+ * @return Number of complete entries, or -1 if the file is not an index
+ */
+static int check_index(int fd, const char *filename, RASPIHIGHLIGHT_ENTRY_T *last)
+{
+   RASPIHIGHLIGHT_HEADER_T header;
+   struct stat st;
+   off_t entries;
+
+   if (fstat(fd, &st) != 0)
+      return -1;
+   if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+       header.magic != RASPIHIGHLIGHT_MAGIC || header.version != RASPIHIGHLIGHT_VERSION ||
+       header.header_size != sizeof(header) || header.entry_size != sizeof(RASPIHIGHLIGHT_ENTRY_T))
+   {
+      vcos_log_error("%s is not a highlight index", filename);
+      return -1;
+   }
+
+   entries = (st.st_size - (off_t)sizeof(header)) / (off_t)sizeof(RASPIHIGHLIGHT_ENTRY_T);
+   if ((off_t)sizeof(header) + entries * (off_t)sizeof(RASPIHIGHLIGHT_ENTRY_T) != st.st_size)
+   {
+      vcos_log_warn("dropping partial entry at the end of %s", filename);
+      if (ftruncate(fd, sizeof(header) + entries * sizeof(RASPIHIGHLIGHT_ENTRY_T)) != 0)
+         return -1;
+   }
+
+   if (entries && pread(fd, last, sizeof(*last), sizeof(header) + (entries - 1) * sizeof(*last)) != sizeof(*last))
+      return -1;
+
+   return (int)entries;
+}
+
+/// Name of the game record file of an index
+static int games_filename(const char *filename, char *games, size_t size)
+{
+   return snprintf(games, size, "%s" RASPIHIGHLIGHT_GAMES_SUFFIX, filename) < (int)size ? 0 : -1;
+}
+
+/**
+ * Open the game record file of an index for appending and read the number
+ * of its last game, dropping a partial record at the end.
+ *
+ * @param create The index was just created, records of an older index of that name are dropped
+ * @return The file descriptor, or -1 on failure
+ */
+static int open_games(const char *filename, int create, uint32_t *last_game)
+{
+   char name[PATH_MAX];
+   RASPIHIGHLIGHT_GAME_T record;
+   struct stat st;
+   off_t records;
+   int fd;
+
+   *last_game = 0;
+   if (games_filename(filename, name, sizeof(name)) != 0)
+   {
+      vcos_log_error("index name %s is too long", filename);
+      return -1;
+   }
+
+   fd = open(name, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC | (create ? O_TRUNC : 0), 0644);
+   if (fd < 0 || fstat(fd, &st) != 0)
+   {
+      vcos_log_error("unable to open %s (%s)", name, strerror(errno));
+      if (fd >= 0)
+         close(fd);
+      return -1;
+   }
+
+   records = st.st_size / (off_t)sizeof(record);
+   if (records * (off_t)sizeof(record) != st.st_size)
+   {
+      vcos_log_warn("dropping partial game record at the end of %s", name);
+      if (ftruncate(fd, records * sizeof(record)) != 0)
+      {
+         close(fd);
+         return -1;
+      }
+   }
+   if (records && pread(fd, &record, sizeof(record), (records - 1) * sizeof(record)) == sizeof(record))
+      *last_game = record.game;
+
+   return fd;
+}
+
+/**
+ * Open a highlight index for appending, creating it if needed. Events
+ * added to it belong to a new game, recorded to the given video files.
+ *
+ * @param filename Index file
+ * @param video Filename of the recorded video, with %d for the segment number if segmented
+ * @return The index, or NULL on failure
+ */
+RASPIHIGHLIGHT_T *raspihighlight_open(const char *filename, const char *video)
+{
+   RASPIHIGHLIGHT_T *highlight;
+   RASPIHIGHLIGHT_ENTRY_T last;
+   RASPIHIGHLIGHT_GAME_T record;
+   struct timeval tv;
+   uint32_t last_game;
+   int entries = 0, create = 0, games_fd;
+
+   vcos_log_register("RaspiHighlights", VCOS_LOG_CATEGORY);
+
+   if (!valid_video_pattern(video) || strlen(video) >= sizeof(record.video))
+   {
+      vcos_log_error("video filename %s can not be stored in a highlight index", video);
+      return NULL;
+   }
+
+   highlight = calloc(1, sizeof(*highlight));
+   if (!highlight)
+      return NULL;
+
+   highlight->fd = open(filename, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+   if (highlight->fd < 0)
+   {
+      vcos_log_error("unable to open %s (%s)", filename, strerror(errno));
+      free(highlight);
+      return NULL;
+   }
+
+   if (lseek(highlight->fd, 0, SEEK_END) == 0)
+   {
+      RASPIHIGHLIGHT_HEADER_T header;
+
+      create = 1;
+      memset(&header, 0, sizeof(header));
+      header.magic = RASPIHIGHLIGHT_MAGIC;
+      header.version = RASPIHIGHLIGHT_VERSION;
+      header.header_size = sizeof(header);
+      header.entry_size = sizeof(RASPIHIGHLIGHT_ENTRY_T);
+      strncpy(header.video, video, sizeof(header.video) - 1);
+      if (write(highlight->fd, &header, sizeof(header)) != sizeof(header))
+      {
+         vcos_log_error("unable to write %s (%s)", filename, strerror(errno));
+         goto error;
+      }
+   }
+   else
+   {
+      entries = check_index(highlight->fd, filename, &last);
+      if (entries < 0)
+         goto error;
+   }
+
+   // A game without events still has its record, and its number is not reused
+   games_fd = open_games(filename, create, &last_game);
+   if (games_fd < 0)
+      goto error;
+   highlight->game = (entries && last.game > last_game ? last.game : last_game) + 1;
+
+   gettimeofday(&tv, NULL);
+   memset(&record, 0, sizeof(record));
+   record.game = highlight->game;
+   record.time = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+   memcpy(record.video, video, strlen(video) + 1);
+   if (write(games_fd, &record, sizeof(record)) != sizeof(record))
+   {
+      vcos_log_error("unable to write the game record of %s (%s)", filename, strerror(errno));
+      close(games_fd);
+      goto error;
+   }
+   close(games_fd);
+
+   if (vcos_mutex_create(&highlight->lock, "RaspiHighlights") != VCOS_SUCCESS)
+      goto error;
+
+   return highlight;
+
+error:
+   close(highlight->fd);
+   free(highlight);
+   return NULL;
+}
+
+void raspihighlight_close(RASPIHIGHLIGHT_T *highlight)
+{
+   if (!highlight)
+      return;
+
+   fsync(highlight->fd);
+   close(highlight->fd);
+   vcos_mutex_delete(&highlight->lock);
+   free(highlight);
+}
+
+/**
+ * Record a keyframe of the video. Called from the encoder callback.
+ *
+ * @param segment Segment number of the video file
+ * @param offset Offset of the keyframe in the segment file, or of the SPS/PPS headers before it
+ * @param pts Camera timestamp of the keyframe
+ */
+void raspihighlight_keyframe(RASPIHIGHLIGHT_T *highlight, uint32_t segment, uint64_t offset, int64_t pts)
+{
+   KEYFRAME_T *keyframe;
+
+   vcos_mutex_lock(&highlight->lock);
+   keyframe = &highlight->keyframes[highlight->keyframe_head];
+   keyframe->segment = segment;
+   keyframe->offset = offset;
+   keyframe->pts = pts;
+   highlight->keyframe_head = (highlight->keyframe_head + 1) % KEYFRAME_COUNT;
+   if (highlight->keyframe_count < KEYFRAME_COUNT)
+      highlight->keyframe_count++;
+   vcos_mutex_unlock(&highlight->lock);
+}
+
+/**
+ * Append an event to the index. Events before the first keyframe are
+ * dropped, there is no video to point them to.
+ *
+ * @param type Event type
+ * @param team 1 red, 2 blue for goals, 0 otherwise
+ * @param pts Camera timestamp of the frame the event was detected on
+ * @param speed Ball speed of shots, 0 otherwise
+ * @return 0 on success, -1 on failure
+ */
+int raspihighlight_add(RASPIHIGHLIGHT_T *highlight, RASPIHIGHLIGHT_TYPE_T type, int team, int64_t pts, float speed)
+{
+   RASPIHIGHLIGHT_ENTRY_T entry;
+   KEYFRAME_T *keyframe = NULL;
+   struct timeval tv;
+   int i, result = 0;
+
+   if (type < 0 || type >= RASPIHIGHLIGHT_TYPES)
+      return -1;
+
+   gettimeofday(&tv, NULL);
+
+   vcos_mutex_lock(&highlight->lock);
+
+   // Newest keyframe at or before the event, or the oldest one we have
+   for (i = 1; i <= highlight->keyframe_count; i++)
+   {
+      keyframe = &highlight->keyframes[(highlight->keyframe_head - i + KEYFRAME_COUNT) % KEYFRAME_COUNT];
+      if (keyframe->pts <= pts)
+         break;
+   }
+
+   if (!keyframe)
+   {
+      vcos_mutex_unlock(&highlight->lock);
+      vcos_log_info("event before the first keyframe, not indexed");
+      return -1;
+   }
+
+   highlight->count[type]++;
+
+   memset(&entry, 0, sizeof(entry));
+   entry.pts = pts;
+   entry.time = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+   entry.keyframe_pts = keyframe->pts;
+   entry.keyframe_offset = keyframe->offset;
+   entry.segment = keyframe->segment;
+   entry.game = highlight->game;
+   memcpy(entry.count, highlight->count, sizeof(entry.count));
+   entry.type = type;
+   entry.team = team;
+   entry.speed = speed;
+
+   // O_APPEND makes this a single append, a crash leaves at most a partial entry
+   if (write(highlight->fd, &entry, sizeof(entry)) != sizeof(entry))
+   {
+      vcos_log_error("unable to write highlight (%s)", strerror(errno));
+      result = -1;
+   }
+
+   vcos_mutex_unlock(&highlight->lock);
+
+   return result;
+}
+
+/**
+ * Map a tracker event string, as passed to the analysis event callback,
+ * to an event type.
+ *
+ * @return 1 if the event is indexed, 0 otherwise
+ */
+int raspihighlight_parse_event(const char *event, RASPIHIGHLIGHT_TYPE_T *type, int *team, float *speed)
+{
+   *team = 0;
+   *speed = 0.0f;
+
+   if (!strcmp(event, "RG\n") || !strcmp(event, "BG\n"))
+   {
+      *type = RASPIHIGHLIGHT_GOAL;
+      *team = event[0] == 'R' ? 1 : 2;
+      return 1;
+   }
+   if (!strcmp(event, "SAVE\n"))
+   {
+      *type = RASPIHIGHLIGHT_SAVE;
+      return 1;
+   }
+   if (sscanf(event, "SHOT %f", speed) == 1)
+   {
+      *type = RASPIHIGHLIGHT_SHOT;
+      return 1;
+   }
+   return 0;
+}
+
+/**
+ * Map an index file read-only for queries
+ *
+ * @return 0 on success, -1 on failure
+ */
+int raspihighlight_map(const char *filename, RASPIHIGHLIGHT_INDEX_T *index)
+{
+   char games[PATH_MAX];
+   struct stat st;
+   int fd;
+
+   vcos_log_register("RaspiHighlights", VCOS_LOG_CATEGORY);
+   memset(index, 0, sizeof(*index));
+
+   fd = open(filename, O_RDONLY | O_CLOEXEC);
+   if (fd < 0)
+   {
+      vcos_log_error("unable to open %s (%s)", filename, strerror(errno));
+      return -1;
+   }
+   if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(RASPIHIGHLIGHT_HEADER_T))
+   {
+      vcos_log_error("%s is not a highlight index", filename);
+      close(fd);
+      return -1;
+   }
+
+   index->map_size = st.st_size;
+   index->map = mmap(NULL, index->map_size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if (index->map == MAP_FAILED)
+   {
+      vcos_log_error("unable to map %s (%s)", filename, strerror(errno));
+      index->map = NULL;
+      return -1;
+   }
+
+   index->header = (const RASPIHIGHLIGHT_HEADER_T *)index->map;
+   if (index->header->magic != RASPIHIGHLIGHT_MAGIC || index->header->version != RASPIHIGHLIGHT_VERSION ||
+       index->header->header_size != sizeof(RASPIHIGHLIGHT_HEADER_T) ||
+       index->header->entry_size != sizeof(RASPIHIGHLIGHT_ENTRY_T))
+   {
+      vcos_log_error("%s is not a highlight index", filename);
+      raspihighlight_unmap(index);
+      return -1;
+   }
+
+   // A partial entry still being written is ignored
+   index->entries = (const RASPIHIGHLIGHT_ENTRY_T *)((const uint8_t *)index->map + sizeof(RASPIHIGHLIGHT_HEADER_T));
+   index->count = (int)((index->map_size - sizeof(RASPIHIGHLIGHT_HEADER_T)) / sizeof(RASPIHIGHLIGHT_ENTRY_T));
+
+   // Older indexes have no game records, their games all use the header
+   if (games_filename(filename, games, sizeof(games)) == 0 && (fd = open(games, O_RDONLY | O_CLOEXEC)) >= 0)
+   {
+      if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(RASPIHIGHLIGHT_GAME_T))
+      {
+         index->games_map_size = st.st_size;
+         index->games_map = mmap(NULL, index->games_map_size, PROT_READ, MAP_SHARED, fd, 0);
+         if (index->games_map == MAP_FAILED)
+         {
+            vcos_log_warn("unable to map %s (%s)", games, strerror(errno));
+            index->games_map = NULL;
+         }
+         else
+         {
+            index->games = (const RASPIHIGHLIGHT_GAME_T *)index->games_map;
+            index->game_count = (int)(index->games_map_size / sizeof(RASPIHIGHLIGHT_GAME_T));
+         }
+      }
+      close(fd);
+   }
+   return 0;
+}
+
+void raspihighlight_unmap(RASPIHIGHLIGHT_INDEX_T *index)
+{
+   if (index->map)
+      munmap(index->map, index->map_size);
+   if (index->games_map)
+      munmap(index->games_map, index->games_map_size);
+   memset(index, 0, sizeof(*index));
+}
+
+/**
+ * Find the n-th event of a type in a game, for example the 3rd goal of
+ * game 7. Binary search on (game, count of the type).
+ *
+ * @param n Event number in the game, starting at 1
+ * @return Entry number, or -1 if there is no such event
+ */
+int raspihighlight_find_event(const RASPIHIGHLIGHT_INDEX_T *index, uint32_t game, RASPIHIGHLIGHT_TYPE_T type, uint32_t n)
+{
+   int lo = 0, hi = index->count;
+
+   if (type < 0 || type >= RASPIHIGHLIGHT_TYPES)
+      return -1;
+
+   // First entry with (game, count) >= (game, n)
+   while (lo < hi)
+   {
+      int mid = lo + (hi - lo) / 2;
+      const RASPIHIGHLIGHT_ENTRY_T *entry = &index->entries[mid];
+
+      if (entry->game < game || (entry->game == game && entry->count[type] < n))
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   // The first entry with the count is the event itself
+   if (lo < index->count && index->entries[lo].game == game &&
+       index->entries[lo].count[type] == n && index->entries[lo].type == type)
+      return lo;
+   return -1;
+}
+
+/**
+ * Find the last event at or before a timestamp in a game. Binary search
+ * on (game, pts).
+ *
+ * @return Entry number, or -1 if the game has no event before pts
+ */
+int raspihighlight_find_pts(const RASPIHIGHLIGHT_INDEX_T *index, uint32_t game, int64_t pts)
+{
+   int lo = 0, hi = index->count;
+
+   // First entry with (game, pts) > (game, pts)
+   while (lo < hi)
+   {
+      int mid = lo + (hi - lo) / 2;
+      const RASPIHIGHLIGHT_ENTRY_T *entry = &index->entries[mid];
+
+      if (entry->game < game || (entry->game == game && entry->pts <= pts))
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   if (lo > 0 && index->entries[lo - 1].game == game)
+      return lo - 1;
+   return -1;
+}
+
+/**
+ * Game record of a game, the last one if the game was opened more than
+ * once. Binary search on the game number.
+ *
+ * @return The record, or NULL if the game has none
+ */
+static const RASPIHIGHLIGHT_GAME_T *find_game(const RASPIHIGHLIGHT_INDEX_T *index, uint32_t game)
+{
+   int lo = 0, hi = index->game_count;
+
+   // First record with a game number > game
+   while (lo < hi)
+   {
+      int mid = lo + (hi - lo) / 2;
+
+      if (index->games[mid].game <= game)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   if (lo > 0 && index->games[lo - 1].game == game)
+      return &index->games[lo - 1];
+   return NULL;
+}
+
+/**
+ * Name of the segment file an entry points into, in the video files of
+ * the entry's game
+ */
+void raspihighlight_segment_filename(const RASPIHIGHLIGHT_INDEX_T *index, const RASPIHIGHLIGHT_ENTRY_T *entry,
+                                     char *filename, int size)
+{
+   const RASPIHIGHLIGHT_GAME_T *game = find_game(index, entry->game);
+   char video[sizeof(index->header->video) + 1];
+
+   if (game)
+   {
+      memcpy(video, game->video, sizeof(game->video));
+      video[sizeof(game->video)] = 0;
+   }
+   else
+   {
+      memcpy(video, index->header->video, sizeof(index->header->video));
+      video[sizeof(index->header->video)] = 0;
+   }
+
+   if (valid_video_pattern(video))
+      snprintf(filename, size, video, (int)entry->segment);
+   else
+      snprintf(filename, size, "%s", video);
+}
@@ -0,0 +1,109 @@
+#ifndef RASPIHIGHLIGHTS_H_
+#define RASPIHIGHLIGHTS_H_
+
+#include <stdint.h>
+
+/**
+ * Append-only index of tracker events in recorded video.
+ *
+ * Every goal, save and shot is appended to the index file as one fixed
+ * size entry, with the camera timestamp of the event, the segment file it
+ * was recorded in and the byte offset of the keyframe before it in that
+ * segment, including the SPS/PPS headers in front of it. A clip of an
+ * event can be cut from the segment file starting at that offset.
+ *
+ * Each run of raspiballs that appends to an index is a new game, and may
+ * record to other video files than the games before it. Every game
+ * appends a game record with its video filename to a second file, named
+ * after the index with RASPIHIGHLIGHT_GAMES_SUFFIX appended. Indexes without
+ * it, or games missing from it, use the video filename of the header.
+ *
+ * Entries
+ * also count the events of each type in their game so far, so the index
+ * is sorted both on (game, count of a type) and on (game, timestamp), and
+ * "the 3rd goal of game 7" is a binary search in the mapped file.
+ *
+ * Entries are written in host byte order. A partial entry at the end of
+ * the file, from a crash during a write, is dropped when the index is
+ * opened again.
+ */
+
+#define RASPIHIGHLIGHT_MAGIC   0x49484252   /// "RBHI"
+#define RASPIHIGHLIGHT_VERSION 1
+#define RASPIHIGHLIGHT_GAMES_SUFFIX ".games"
+
+/// Event types
+typedef enum
+{
+   RASPIHIGHLIGHT_GOAL = 0,
+   RASPIHIGHLIGHT_SAVE,
+   RASPIHIGHLIGHT_SHOT,
+   RASPIHIGHLIGHT_TYPES
+} RASPIHIGHLIGHT_TYPE_T;
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t header_size;            /// Bytes before the first entry
+   uint32_t entry_size;
+   char video[240];                 /// Video filename, with %d for the segment number if segmented
+} RASPIHIGHLIGHT_HEADER_T;
+
+typedef struct
+{
+   int64_t pts;                     /// Camera timestamp of the frame the event was detected on
+   int64_t time;                    /// Wall clock time of the event, microseconds since the epoch
+   int64_t keyframe_pts;            /// Camera timestamp of the keyframe before the event
+   uint64_t keyframe_offset;        /// Offset of that keyframe (or its headers) in the segment file
+   uint32_t segment;                /// Segment number of the video file
+   uint32_t game;                   /// Game number, starting at 1
+   uint32_t count[RASPIHIGHLIGHT_TYPES]; /// Events of each type in the game so far, this one included
+   uint8_t type;                    /// RASPIHIGHLIGHT_TYPE_T
+   uint8_t team;                    /// 1 red, 2 blue for goals, 0 otherwise
+   uint16_t reserved0;
+   float speed;                     /// Ball speed of shots in field widths per frame, 0 otherwise
+   uint32_t reserved1;              /// Pads the entry to 64 bytes
+} RASPIHIGHLIGHT_ENTRY_T;
+
+/// Game record, one for every time the index was opened for appending
+typedef struct
+{
+   uint32_t game;                   /// Game number
+   uint32_t reserved0;
+   int64_t time;                    /// Wall clock time the game started, microseconds since the epoch
+   char video[240];                 /// Video filename of the game, with %d for the segment number if segmented
+} RASPIHIGHLIGHT_GAME_T;
+
+typedef struct RASPIHIGHLIGHT_S RASPIHIGHLIGHT_T;
+
+RASPIHIGHLIGHT_T *raspihighlight_open(const char *filename, const char *video);
+void raspihighlight_close(RASPIHIGHLIGHT_T *highlight);
+
+void raspihighlight_keyframe(RASPIHIGHLIGHT_T *highlight, uint32_t segment, uint64_t offset, int64_t pts);
+int raspihighlight_add(RASPIHIGHLIGHT_T *highlight, RASPIHIGHLIGHT_TYPE_T type, int team, int64_t pts, float speed);
+int raspihighlight_parse_event(const char *event, RASPIHIGHLIGHT_TYPE_T *type, int *team, float *speed);
+
+/// Read-only view of an index file
+typedef struct
+{
+   const RASPIHIGHLIGHT_HEADER_T *header;
+   const RASPIHIGHLIGHT_ENTRY_T *entries;
+   int count;
+   void *map;
+   size_t map_size;
+   const RASPIHIGHLIGHT_GAME_T *games; /// Game records in game order, NULL if there are none
+   int game_count;
+   void *games_map;
+   size_t games_map_size;
+} RASPIHIGHLIGHT_INDEX_T;
+
+int raspihighlight_map(const char *filename, RASPIHIGHLIGHT_INDEX_T *index);
+void raspihighlight_unmap(RASPIHIGHLIGHT_INDEX_T *index);
+
+int raspihighlight_find_event(const RASPIHIGHLIGHT_INDEX_T *index, uint32_t game, RASPIHIGHLIGHT_TYPE_T type, uint32_t n);
+int raspihighlight_find_pts(const RASPIHIGHLIGHT_INDEX_T *index, uint32_t game, int64_t pts);
+void raspihighlight_segment_filename(const RASPIHIGHLIGHT_INDEX_T *index, const RASPIHIGHLIGHT_ENTRY_T *entry,
+                                     char *filename, int size);
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * \file RaspiHighlightsQuery.c
+ * Command line tool to find tracker events in recorded video through the
+ * highlight index written by raspiballs -highlights, see RaspiHighlights.h
+ *
+ * The index is mapped and searched, the video files are not opened.
+ *
+ * Usage:
+ *   raspihighlights <index>                          List all events
+ *   raspihighlights <index> goal|save|shot <game> <n> The n-th event of a type in a game
+ *   raspihighlights <index> at <game> <ms>           The last event at or before a time in a game
+ *
+ * Game 0 is the last game in the index. Each result is printed with the
+ * segment file and the byte offset to cut a clip from.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "interface/vcos/vcos.h"
+
+#include "RaspiHighlights.h"
+
+static const char *type_names[RASPIHIGHLIGHT_TYPES] = { "goal", "save", "shot" };
+
+static void print_entry(const RASPIHIGHLIGHT_INDEX_T *index, const RASPIHIGHLIGHT_ENTRY_T *entry)
+{
+   char filename[512];
+
+   raspihighlight_segment_filename(index, entry, filename, sizeof(filename));
+
+   printf("game %u %s %u", entry->game, entry->type < RASPIHIGHLIGHT_TYPES ? type_names[entry->type] : "?",
+          entry->type < RASPIHIGHLIGHT_TYPES ? entry->count[entry->type] : 0);
+   if (entry->team)
+      printf(" (%s)", entry->team == 1 ? "red" : "blue");
+   if (entry->type == RASPIHIGHLIGHT_SHOT)
+      printf(" speed %.3f", entry->speed);
+   printf(" at %lld.%03lld s: %s offset %llu, keyframe at %lld.%03lld s\n",
+          (long long)(entry->pts / 1000000), (long long)(entry->pts / 1000 % 1000), filename,
+          (unsigned long long)entry->keyframe_offset,
+          (long long)(entry->keyframe_pts / 1000000), (long long)(entry->keyframe_pts / 1000 % 1000));
+}
+
+static void usage(const char *name)
+{
+   fprintf(stderr, "Usage:\n"
+           "  %s <index>                           List all events\n"
+           "  %s <index> goal|save|shot <game> <n> The n-th event of a type in a game\n"
+           "  %s <index> at <game> <ms>            The last event at or before a time in a game\n"
+           "Game 0 is the last game in the index.\n", name, name, name);
+}
+
+int main(int argc, char **argv)
+{
+   RASPIHIGHLIGHT_INDEX_T index;
+   uint32_t game;
+   int i, result = -1;
+
+   if (argc != 2 && argc != 5)
+   {
+      usage(argv[0]);
+      return 1;
+   }
+
+   vcos_init();
+
+   if (raspihighlight_map(argv[1], &index) != 0)
+      return 1;
+
+   if (argc == 2)
+   {
+      for (i = 0; i < index.count; i++)
+         print_entry(&index, &index.entries[i]);
+      raspihighlight_unmap(&index);
+      return 0;
+   }
+
+   game = strtoul(argv[3], NULL, 10);
+   if (!game && index.count)
+      game = index.entries[index.count - 1].game;
+
+   if (!strcmp(argv[2], "at"))
+   {
+      result = raspihighlight_find_pts(&index, game, strtoll(argv[4], NULL, 10) * 1000);
+   }
+   else
+   {
+      for (i = 0; i < RASPIHIGHLIGHT_TYPES; i++)
+         if (!strcmp(argv[2], type_names[i]))
+            break;
+      if (i == RASPIHIGHLIGHT_TYPES)
+      {
+         usage(argv[0]);
+         raspihighlight_unmap(&index);
+         return 1;
+      }
+      result = raspihighlight_find_event(&index, game, (RASPIHIGHLIGHT_TYPE_T)i, strtoul(argv[4], NULL, 10));
+   }
+
+   if (result >= 0)
+      print_entry(&index, &index.entries[result]);
+   else
+      fprintf(stderr, "No such event in game %u\n", game);
+
+   raspihighlight_unmap(&index);
+   return result >= 0 ? 0 : 2;
+}
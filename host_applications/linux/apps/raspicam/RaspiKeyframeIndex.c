@@ -0,0 +1,108 @@
+/**
+ * \file RaspiKeyframeIndex.c
+ * Ring of keyframe positions for the circular and replay buffers.
+ */
+
+#include <stdlib.h>
+
+#include "RaspiKeyframeIndex.h"
+
+/**
+ * Initialise an empty index
+ *
+ * @param index Index to initialise
+ * @param size Maximum number of keyframes, the oldest are dropped beyond that
+ * @return 0 on success, -1 if out of memory
+ */
+int raspikeyframe_index_init(RASPIKEYFRAME_INDEX_T *index, int size)
+{
+   index->entries = calloc(size, sizeof(RASPIKEYFRAME_T));
+   index->size = index->entries ? size : 0;
+   index->head = 0;
+   index->count = 0;
+   return index->entries ? 0 : -1;
+}
+
+void raspikeyframe_index_free(RASPIKEYFRAME_INDEX_T *index)
+{
+   free(index->entries);
+   index->entries = NULL;
+   index->size = index->head = index->count = 0;
+}
+
+/**
+ * Add a keyframe. Offsets must be increasing. If the index is full the
+ * oldest keyframe is dropped.
+ */
+void raspikeyframe_index_push(RASPIKEYFRAME_INDEX_T *index, int64_t offset, int64_t pts, int has_header)
+{
+   RASPIKEYFRAME_T *entry = &index->entries[index->head];
+
+   entry->offset = offset;
+   entry->pts = pts;
+   entry->has_header = has_header;
+
+   index->head = (index->head + 1) % index->size;
+   if (index->count < index->size)
+      index->count++;
+}
+
+/**
+ * Drop keyframes that start before oldest_valid, i.e. that have been
+ * (partly) overwritten by the stream buffer.
+ *
+ * Each keyframe is dropped once, so this is amortised O(1) per call.
+ */
+void raspikeyframe_index_trim(RASPIKEYFRAME_INDEX_T *index, int64_t oldest_valid)
+{
+   while (index->count && raspikeyframe_index_get(index, 0)->offset < oldest_valid)
+      index->count--;
+}
+
+/**
+ * Find the newest keyframe with a timestamp at or before pts, using a
+ * binary search since keyframe timestamps are increasing. An unknown
+ * timestamp (MMAL_TIME_UNKNOWN) compares as older than any other.
+ *
+ * @return The keyframe, the oldest keyframe if all are newer, or NULL if empty
+ */
+RASPIKEYFRAME_T *raspikeyframe_index_find(RASPIKEYFRAME_INDEX_T *index, int64_t pts)
+{
+   int lo = 0, hi = index->count - 1;
+
+   if (!index->count)
+      return NULL;
+
+   while (lo < hi)
+   {
+      int mid = (lo + hi + 1) / 2;
+      if (raspikeyframe_index_get(index, mid)->pts <= pts)
+         lo = mid;
+      else
+         hi = mid - 1;
+   }
+
+   return raspikeyframe_index_get(index, lo);
+}
+
+/**
+ * Find the oldest entry at or after a stream offset, using a binary search
+ * since offsets are increasing.
+ *
+ * @return Position of the entry for raspikeyframe_index_get, or the count if there is none
+ */
+int raspikeyframe_index_find_offset(RASPIKEYFRAME_INDEX_T *index, int64_t offset)
+{
+   int lo = 0, hi = index->count;
+
+   while (lo < hi)
+   {
+      int mid = (lo + hi) / 2;
+      if (raspikeyframe_index_get(index, mid)->offset < offset)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return lo;
+}
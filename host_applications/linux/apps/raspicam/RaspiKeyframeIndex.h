@@ -0,0 +1,57 @@
+#ifndef RASPIKEYFRAMEINDEX_H_
+#define RASPIKEYFRAMEINDEX_H_
+
+#include <stdint.h>
+
+/**
+ * Ring of keyframe positions in a circular stream buffer.
+ *
+ * Positions are absolute byte offsets since the start of the stream, so
+ * they never wrap. Entries are pushed in stream order and dropped from the
+ * old end once the buffer has overwritten them, which makes both updates
+ * amortised O(1). The index does not lock, the owner of the stream buffer
+ * is expected to.
+ *
+ * The replay ring also keeps one of these for every frame, with has_header
+ * marking the keyframes.
+ */
+typedef struct
+{
+   int64_t offset;                  /// Absolute stream offset of the keyframe
+   int64_t pts;                     /// Timestamp of the keyframe
+   int has_header;                  /// Whether SPS/PPS headers directly precede it
+} RASPIKEYFRAME_T;
+
+typedef struct
+{
+   RASPIKEYFRAME_T *entries;
+   int size;                        /// Capacity of entries
+   int head;                        /// Next entry to write
+   int count;                       /// Valid entries before head
+} RASPIKEYFRAME_INDEX_T;
+
+int raspikeyframe_index_init(RASPIKEYFRAME_INDEX_T *index, int size);
+void raspikeyframe_index_free(RASPIKEYFRAME_INDEX_T *index);
+
+void raspikeyframe_index_push(RASPIKEYFRAME_INDEX_T *index, int64_t offset, int64_t pts, int has_header);
+void raspikeyframe_index_trim(RASPIKEYFRAME_INDEX_T *index, int64_t oldest_valid);
+
+/// Number of keyframes in the index
+static inline int raspikeyframe_index_count(const RASPIKEYFRAME_INDEX_T *index)
+{
+   return index->count;
+}
+
+/// The i-th oldest keyframe, i must be smaller than the count
+static inline RASPIKEYFRAME_T *raspikeyframe_index_get(RASPIKEYFRAME_INDEX_T *index, int i)
+{
+   int idx = index->head - index->count + i;
+   if (idx < 0)
+      idx += index->size;
+   return &index->entries[idx];
+}
+
+RASPIKEYFRAME_T *raspikeyframe_index_find(RASPIKEYFRAME_INDEX_T *index, int64_t pts);
+int raspikeyframe_index_find_offset(RASPIKEYFRAME_INDEX_T *index, int64_t offset);
+
+#endif
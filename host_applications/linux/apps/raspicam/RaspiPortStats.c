@@ -0,0 +1,84 @@
+/**
+ * \file RaspiPortStats.c
+ * Periodic table of the MMAL port statistics, see RaspiPortStats.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "interface/vcos/vcos.h"
+#include "interface/mmal/util/mmal_util_stats.h"
+
+#include "RaspiPortStats.h"
+
+struct RASPIPORTSTATS_S
+{
+   VCOS_SEMAPHORE_T stop;           /// Posted to end the thread
+   VCOS_THREAD_T thread;
+
+   MMAL_COMPONENT_T *components[RASPIPORTSTATS_MAX_COMPONENTS];
+   int count;
+   int interval_ms;
+   FILE *out;
+};
+
+static void *portstats_worker(void *arg)
+{
+   RASPIPORTSTATS_T *stats = arg;
+
+   while (vcos_semaphore_wait_timeout(&stats->stop, stats->interval_ms) != VCOS_SUCCESS)
+   {
+      mmal_util_dump_port_latency(stats->out, stats->components, stats->count, MMAL_TRUE);
+      fprintf(stats->out, "\n");
+      fflush(stats->out);
+   }
+   return NULL;
+}
+
+RASPIPORTSTATS_T *raspiportstats_create(MMAL_COMPONENT_T **components, int count, int interval_ms, FILE *out)
+{
+   RASPIPORTSTATS_T *stats = calloc(1, sizeof(RASPIPORTSTATS_T));
+   int i;
+
+   if (!stats)
+      return NULL;
+
+   for (i = 0; i < count && stats->count < RASPIPORTSTATS_MAX_COMPONENTS; i++)
+   {
+      if (components[i])
+         stats->components[stats->count++] = components[i];
+   }
+   stats->interval_ms = interval_ms;
+   stats->out = out;
+
+   if (mmal_util_enable_port_latency(stats->components, stats->count, MMAL_TRUE) != MMAL_SUCCESS)
+      fprintf(out, "Not collecting the statistics of buffers coming back from all ports\n");
+
+   if (vcos_semaphore_create(&stats->stop, "portstats-stop", 0) != VCOS_SUCCESS)
+      goto error_stop;
+   if (vcos_thread_create(&stats->thread, "portstats", NULL, portstats_worker, stats) != VCOS_SUCCESS)
+      goto error_thread;
+
+   return stats;
+
+error_thread:
+   vcos_semaphore_delete(&stats->stop);
+error_stop:
+   free(stats);
+   return NULL;
+}
+
+void raspiportstats_destroy(RASPIPORTSTATS_T *stats)
+{
+   if (!stats)
+      return;
+
+   vcos_semaphore_post(&stats->stop);
+   vcos_thread_join(&stats->thread, NULL);
+
+   mmal_util_dump_port_latency(stats->out, stats->components, stats->count, MMAL_TRUE);
+   fflush(stats->out);
+
+   vcos_semaphore_delete(&stats->stop);
+   free(stats);
+}
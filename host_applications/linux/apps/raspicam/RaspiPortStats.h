@@ -0,0 +1,35 @@
+#ifndef RASPIPORTSTATS_H_
+#define RASPIPORTSTATS_H_
+
+#include <stdio.h>
+
+#include "interface/mmal/mmal.h"
+
+/**
+ * Periodic table of the MMAL port statistics of the pipeline.
+ *
+ * A thread prints the statistics the MMAL core keeps for every port of
+ * the components, see mmal_util_dump_port_latency, and resets them, so
+ * each table covers one interval. That shows which component adds the
+ * latency or drops the frame rate.
+ *
+ * The host core only sees the buffers exchanged with the host. Ports of
+ * tunnelled connections between VideoCore components, such as camera to
+ * splitter, fall back to the counters VideoCore keeps, which only give the
+ * buffer count, the frame rate and the longest interval.
+ */
+typedef struct RASPIPORTSTATS_S RASPIPORTSTATS_T;
+
+/// Most components in the table
+#define RASPIPORTSTATS_MAX_COMPONENTS 8
+
+/**
+ * Start printing a table of `components` to `out` every `interval_ms`.
+ * NULL components are left out. They must stay until the table is
+ * destroyed.
+ */
+RASPIPORTSTATS_T *raspiportstats_create(MMAL_COMPONENT_T **components, int count, int interval_ms, FILE *out);
+/// Stop the thread and print the table of the last interval
+void raspiportstats_destroy(RASPIPORTSTATS_T *stats);
+
+#endif
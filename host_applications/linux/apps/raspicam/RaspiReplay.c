@@ -0,0 +1,1343 @@
+/**
+ * \file RaspiReplay.c
+ * In-process H264 replay ring with keyframe index.
+ *
+ * All stream positions are kept as absolute 64 bit byte offsets since the
+ * start of the stream. The ring holds the bytes in
+ * [write_pos - size, write_pos), so an offset is still valid as long as it
+ * is not smaller than write_pos - size. This makes overtake checks trivial,
+ * also for readers that write out a clip without holding the lock.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#include "interface/vcos/vcos.h"
+#include "interface/mmal/mmal.h"
+#include "containers/containers.h"
+#include "containers/containers_codecs.h"
+
+#include "RaspiReplay.h"
+#include "RaspiKeyframeIndex.h"
+
+static VCOS_LOG_CAT_T raspireplay_log_category;
+#define VCOS_LOG_CATEGORY (&raspireplay_log_category)
+
+/// Number of keyframes that can be indexed. At an intra period of 10
+/// frames at 40fps this covers more than four minutes.
+#define KEYFRAME_INDEX_SIZE 1024
+
+/// Maximum size of the SPS/PPS headers
+#define HEADER_SIZE 128
+
+/// Bytes of ring per entry in the frame index, with a minimum of
+/// FRAME_INDEX_MIN entries. Frames are rarely smaller than this.
+#define FRAME_INDEX_BYTES 4096
+#define FRAME_INDEX_MIN   1024
+
+/// Number of tracker results kept, a few seconds at the highest framerate
+#define BALL_RING_SIZE 1024
+
+/// Mime type of the ball track samples in MP4 clips
+#define BALL_TRACK_MIME "application/json"
+
+/// A tracker result for one preview frame
+typedef struct
+{
+   int64_t pts;
+   float x, y;                      /// Ball position in [-1,1] coordinates
+   int found;
+} BALL_T;
+
+struct RASPIREPLAY_S
+{
+   VCOS_MUTEX_T lock;
+
+   uint8_t *data;                   /// The ring
+   int size;                        /// Size of the ring in bytes
+   int64_t write_pos;               /// Absolute offset of the next byte
+
+   RASPIKEYFRAME_INDEX_T index;     /// Keyframes still in the ring
+   RASPIKEYFRAME_INDEX_T frames;    /// Every complete frame still in the ring, for MP4 export
+
+   int64_t frame_start;             /// Start of the frame being received, -1 if none
+   int64_t frame_pts;               /// Timestamp of the frame being received
+   int frame_is_key;                /// Frame being received has been indexed
+   int64_t config_start;            /// Start of inline headers before this frame, -1 if none
+   int64_t frame_end;               /// End of the last complete frame
+   int64_t last_pts;                /// Timestamp of the last complete frame
+
+   uint8_t header[HEADER_SIZE];     /// Last SPS/PPS headers seen
+   int header_len;
+   int header_complete;             /// Next config buffer starts new headers
+
+   BALL_T balls[BALL_RING_SIZE];    /// Latest tracker results, in pts order
+   int ball_head;
+   int ball_count;
+
+   int width, height;               /// Video size for MP4 export
+
+   VCOS_THREAD_T control_thread;
+   int control_fd;
+   char control_path[108];
+   char control_dir[256];           /// Directory REPLAY requests write into, empty if none
+   int control_running;
+
+   VCOS_THREAD_T export_thread;     /// Writes requested clips off the caller's thread
+   VCOS_SEMAPHORE_T export_work;
+   int export_running;
+   int export_pending;              /// A request waits in the fields below
+   char export_filename[256];
+   int64_t export_duration;
+   RASPIREPLAY_SLOWMO_T export_slowmo;
+   int export_has_slowmo;
+   RASPIREPLAY_DONE_FN_T export_done;
+   void *export_userdata;
+};
+
+/**
+ * Create a replay ring
+ *
+ * @param size Size of the ring in bytes
+ * @return The ring, or NULL on failure
+ */
+RASPIREPLAY_T *raspireplay_create(int size)
+{
+   RASPIREPLAY_T *replay = calloc(1, sizeof(RASPIREPLAY_T));
+
+   if (!replay)
+      return NULL;
+
+   replay->data = malloc(size);
+   if (!replay->data || raspikeyframe_index_init(&replay->index, KEYFRAME_INDEX_SIZE) != 0 ||
+       raspikeyframe_index_init(&replay->frames, size / FRAME_INDEX_BYTES > FRAME_INDEX_MIN ?
+                                size / FRAME_INDEX_BYTES : FRAME_INDEX_MIN) != 0 ||
+       vcos_mutex_create(&replay->lock, "replay") != VCOS_SUCCESS)
+   {
+      raspikeyframe_index_free(&replay->frames);
+      raspikeyframe_index_free(&replay->index);
+      free(replay->data);
+      free(replay);
+      return NULL;
+   }
+
+   vcos_log_register("RaspiReplay", VCOS_LOG_CATEGORY);
+
+   replay->size = size;
+   replay->frame_start = -1;
+   replay->config_start = -1;
+   replay->last_pts = MMAL_TIME_UNKNOWN;
+   replay->header_complete = 1;
+   replay->control_fd = -1;
+
+   return replay;
+}
+
+void raspireplay_destroy(RASPIREPLAY_T *replay)
+{
+   if (!replay)
+      return;
+
+   raspireplay_stop_control(replay);
+   raspireplay_stop_exporter(replay);
+   vcos_log_unregister(VCOS_LOG_CATEGORY);
+   vcos_mutex_delete(&replay->lock);
+   raspikeyframe_index_free(&replay->frames);
+   raspikeyframe_index_free(&replay->index);
+   free(replay->data);
+   free(replay);
+}
+
+/// Set the video size, used for the MP4 track header
+void raspireplay_set_format(RASPIREPLAY_T *replay, int width, int height)
+{
+   vcos_mutex_lock(&replay->lock);
+   replay->width = width;
+   replay->height = height;
+   vcos_mutex_unlock(&replay->lock);
+}
+
+/**
+ * Add the tracker result for a frame, stored with MP4 clips as a timed
+ * metadata track. Called from the GL thread.
+ *
+ * @param pts Camera timestamp of the analysed frame
+ * @param x,y Ball position in [-1,1] coordinates
+ * @param found Whether the ball was found
+ */
+void raspireplay_add_ball(RASPIREPLAY_T *replay, int64_t pts, float x, float y, int found)
+{
+   BALL_T *ball;
+
+   if (pts == MMAL_TIME_UNKNOWN)
+      return;
+
+   vcos_mutex_lock(&replay->lock);
+   ball = &replay->balls[replay->ball_head];
+   ball->pts = pts;
+   ball->x = x;
+   ball->y = y;
+   ball->found = found;
+   replay->ball_head = (replay->ball_head + 1) % BALL_RING_SIZE;
+   if (replay->ball_count < BALL_RING_SIZE)
+      replay->ball_count++;
+   vcos_mutex_unlock(&replay->lock);
+}
+
+/**
+ * Get the timestamp of a recent tracker result, for example to find the
+ * frame a goal was scored in from the number of frames since.
+ *
+ * @param results_ago 0 for the newest result, 1 for the one before it...
+ * @return Camera timestamp of the result, or MMAL_TIME_UNKNOWN if it is not kept
+ */
+int64_t raspireplay_ball_pts(RASPIREPLAY_T *replay, int results_ago)
+{
+   int64_t pts = MMAL_TIME_UNKNOWN;
+
+   vcos_mutex_lock(&replay->lock);
+   if (results_ago >= 0 && results_ago < replay->ball_count)
+      pts = replay->balls[(replay->ball_head - 1 - results_ago + BALL_RING_SIZE) % BALL_RING_SIZE].pts;
+   vcos_mutex_unlock(&replay->lock);
+
+   return pts;
+}
+
+/**
+ * Get the timestamp of the newest complete frame in the ring, for example
+ * to wait until the encoder has caught up with a tracker event.
+ *
+ * @return Camera timestamp of the frame, or MMAL_TIME_UNKNOWN if there is none
+ */
+int64_t raspireplay_last_pts(RASPIREPLAY_T *replay)
+{
+   int64_t pts;
+
+   vcos_mutex_lock(&replay->lock);
+   pts = replay->last_pts;
+   vcos_mutex_unlock(&replay->lock);
+
+   return pts;
+}
+
+#ifndef NDEBUG
+/**
+ * Check that every indexed keyframe still starts with a start code.
+ * O(keyframes), so only done in debug builds.
+ */
+static void verify_index(RASPIREPLAY_T *replay)
+{
+   int i, j;
+
+   for (i = 0; i < raspikeyframe_index_count(&replay->index); i++)
+   {
+      static const uint8_t start_code[4] = {0, 0, 0, 1};
+      int64_t offset = raspikeyframe_index_get(&replay->index, i)->offset;
+
+      for (j = 0; j < 4; j++)
+      {
+         if (replay->data[(offset + j) % replay->size] != start_code[j])
+         {
+            vcos_log_error("Error in iframe list at offset %lld", (long long)offset);
+            break;
+         }
+      }
+   }
+}
+#endif
+
+/**
+ * Add encoder output to the ring. Called from the encoder callback.
+ *
+ * @param replay The ring
+ * @param data Buffer data
+ * @param length Buffer length
+ * @param pts Buffer timestamp, or MMAL_TIME_UNKNOWN
+ * @param flags RASPIREPLAY_FLAG_* flags of the buffer
+ */
+void raspireplay_add(RASPIREPLAY_T *replay, const uint8_t *data, int length, int64_t pts, int flags)
+{
+   int offset, copy_to_end;
+
+   if (length <= 0 || length > replay->size)
+      return;
+
+   vcos_mutex_lock(&replay->lock);
+
+   if (replay->frame_start < 0 && !(flags & RASPIREPLAY_FLAG_CONFIG))
+      replay->frame_pts = pts;
+
+   if (flags & RASPIREPLAY_FLAG_CONFIG)
+   {
+      if (replay->header_complete)
+      {
+         replay->header_len = 0;
+         replay->header_complete = 0;
+      }
+      if (replay->header_len + length <= HEADER_SIZE)
+      {
+         memcpy(replay->header + replay->header_len, data, length);
+         replay->header_len += length;
+      }
+      if (replay->config_start < 0)
+         replay->config_start = replay->write_pos;
+   }
+   else
+   {
+      replay->header_complete = 1;
+
+      if (replay->frame_start < 0)
+         replay->frame_start = replay->write_pos;
+
+      if ((flags & RASPIREPLAY_FLAG_KEYFRAME) && !replay->frame_is_key)
+      {
+         int has_header = replay->config_start >= 0;
+
+         raspikeyframe_index_push(&replay->index, has_header ? replay->config_start : replay->frame_start,
+                                  pts, has_header);
+         replay->frame_is_key = 1;
+      }
+      replay->config_start = -1;
+   }
+
+   offset = (int)(replay->write_pos % replay->size);
+   copy_to_end = replay->size - offset;
+   if (copy_to_end > length)
+      copy_to_end = length;
+   memcpy(replay->data + offset, data, copy_to_end);
+   memcpy(replay->data, data + copy_to_end, length - copy_to_end);
+   replay->write_pos += length;
+
+   if ((flags & RASPIREPLAY_FLAG_FRAME_END) && !(flags & RASPIREPLAY_FLAG_CONFIG))
+   {
+      raspikeyframe_index_push(&replay->frames, replay->frame_start, replay->frame_pts, replay->frame_is_key);
+      replay->frame_end = replay->write_pos;
+      if (pts != MMAL_TIME_UNKNOWN)
+         replay->last_pts = pts;
+      replay->frame_start = -1;
+      replay->frame_is_key = 0;
+   }
+
+   // Drop keyframes that have been overwritten
+   raspikeyframe_index_trim(&replay->index, replay->write_pos - replay->size);
+   raspikeyframe_index_trim(&replay->frames, replay->write_pos - replay->size);
+
+#ifndef NDEBUG
+   verify_index(replay);
+#endif
+
+   vcos_mutex_unlock(&replay->lock);
+}
+
+/**
+ * Find the keyframe a clip of duration_us starts at. Called with the lock held.
+ *
+ * @return The keyframe, or NULL if there is none
+ */
+static RASPIKEYFRAME_T *clip_start(RASPIREPLAY_T *replay, int64_t duration_us)
+{
+   if (!raspikeyframe_index_count(&replay->index))
+      return NULL;
+
+   if (duration_us <= 0 || replay->last_pts == MMAL_TIME_UNKNOWN)
+      return raspikeyframe_index_get(&replay->index, 0);
+
+   return raspikeyframe_index_find(&replay->index, replay->last_pts - duration_us);
+}
+
+/**
+ * Map a camera timestamp to the timeline of a clip with a slow motion
+ * part. Frames before it keep their time, frames after it are delayed by
+ * the time the slow motion adds.
+ */
+static int64_t slowmo_pts(const RASPIREPLAY_SLOWMO_T *slowmo, int64_t pts)
+{
+   if (!slowmo || slowmo->factor <= 1 || pts <= slowmo->start_pts)
+      return pts;
+   if (pts < slowmo->end_pts)
+      return slowmo->start_pts + (pts - slowmo->start_pts) * slowmo->factor;
+   return pts + (slowmo->end_pts - slowmo->start_pts) * (slowmo->factor - 1);
+}
+
+/**
+ * Copy the timestamps of the frames in [start, end). Called with the lock
+ * held. Frames without a timestamp get one a frame after the previous one.
+ *
+ * @return Array of timestamps to free, or NULL on failure
+ */
+static int64_t *clip_pts(RASPIREPLAY_T *replay, int64_t start, int64_t end, int *frames)
+{
+   int count = raspikeyframe_index_count(&replay->frames);
+   int i = raspikeyframe_index_find_offset(&replay->frames, start);
+   int64_t *pts = malloc((count - i + 1) * sizeof(int64_t));
+   int n = 0;
+
+   if (!pts)
+      return NULL;
+
+   for (; i < count; i++)
+   {
+      RASPIKEYFRAME_T *entry = raspikeyframe_index_get(&replay->frames, i);
+
+      if (entry->offset >= end)
+         break;
+      if (entry->pts != MMAL_TIME_UNKNOWN)
+         pts[n] = entry->pts;
+      else if (n >= 2)
+         pts[n] = 2 * pts[n - 1] - pts[n - 2];
+      else
+         pts[n] = n ? pts[n - 1] : 0;
+      n++;
+   }
+
+   *frames = n;
+   return pts;
+}
+
+/**
+ * Write a clip to a file descriptor, optionally returning the timestamps
+ * of its frames.
+ */
+static int export_clip(RASPIREPLAY_T *replay, int fd, int64_t duration_us, int64_t **pts, int *frames)
+{
+   struct iovec iov[3];
+   uint8_t header[HEADER_SIZE];
+   int iovcnt = 0;
+   int64_t start, end;
+   int offset, length, total, overtaken;
+   RASPIKEYFRAME_T *entry;
+
+   vcos_mutex_lock(&replay->lock);
+
+   entry = clip_start(replay, duration_us);
+   if (!entry)
+   {
+      vcos_mutex_unlock(&replay->lock);
+      vcos_log_error("no keyframe in buffer");
+      return -1;
+   }
+
+   start = entry->offset;
+   end = replay->frame_end;
+   if (end <= start)
+   {
+      vcos_mutex_unlock(&replay->lock);
+      vcos_log_error("no complete frame after keyframe");
+      return -1;
+   }
+
+   if (!entry->has_header && replay->header_len)
+   {
+      memcpy(header, replay->header, replay->header_len);
+      iov[iovcnt].iov_base = header;
+      iov[iovcnt].iov_len = replay->header_len;
+      iovcnt++;
+   }
+
+   if (pts)
+   {
+      *pts = clip_pts(replay, start, end, frames);
+      if (!*pts)
+      {
+         vcos_mutex_unlock(&replay->lock);
+         return -1;
+      }
+   }
+
+   offset = (int)(start % replay->size);
+   length = (int)(end - start);
+   iov[iovcnt].iov_base = replay->data + offset;
+   iov[iovcnt].iov_len = length < replay->size - offset ? length : replay->size - offset;
+   length -= iov[iovcnt].iov_len;
+   iovcnt++;
+   if (length)
+   {
+      iov[iovcnt].iov_base = replay->data;
+      iov[iovcnt].iov_len = length;
+      iovcnt++;
+   }
+
+   vcos_mutex_unlock(&replay->lock);
+
+   // The encoder keeps writing while we send the clip. Nothing we send is
+   // touched unless the writer overtakes `start`, which is checked below.
+   total = 0;
+   while (iovcnt)
+   {
+      ssize_t written = writev(fd, iov, iovcnt);
+
+      if (written < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         vcos_log_error("write failed (%s)", strerror(errno));
+         if (pts)
+         {
+            free(*pts);
+            *pts = NULL;
+         }
+         return -1;
+      }
+      total += written;
+
+      // Partial write, skip what has been written
+      while (iovcnt && (size_t)written >= iov[0].iov_len)
+      {
+         written -= iov[0].iov_len;
+         memmove(&iov[0], &iov[1], (iovcnt - 1) * sizeof(iov[0]));
+         iovcnt--;
+      }
+      if (iovcnt)
+      {
+         iov[0].iov_base = (uint8_t *)iov[0].iov_base + written;
+         iov[0].iov_len -= written;
+      }
+   }
+
+   vcos_mutex_lock(&replay->lock);
+   overtaken = start < replay->write_pos - replay->size;
+   vcos_mutex_unlock(&replay->lock);
+
+   if (overtaken)
+   {
+      vcos_log_error("buffer overtaken while exporting, clip is corrupt");
+      if (pts)
+      {
+         free(*pts);
+         *pts = NULL;
+      }
+      return -1;
+   }
+
+   return total;
+}
+
+/**
+ * Write a clip to a file descriptor. The clip starts at the newest
+ * keyframe that is at least duration_us before the last complete frame
+ * (or the oldest keyframe if the ring is shorter) and ends at the last
+ * complete frame.
+ *
+ * @param replay The ring
+ * @param fd File or socket to write to
+ * @param duration_us Requested clip length in microseconds, 0 for all
+ * @return Number of bytes written, or -1 on failure
+ */
+int raspireplay_export(RASPIREPLAY_T *replay, int fd, int64_t duration_us)
+{
+   return export_clip(replay, fd, duration_us, NULL, NULL);
+}
+
+/**
+ * Build the avcC decoder configuration from Annex B SPS/PPS headers
+ *
+ * @return Size of the configuration, or -1 if the headers are incomplete
+ */
+static int make_avcc(const uint8_t *header, int header_len, uint8_t *avcc, int avcc_size)
+{
+   const uint8_t *sps = NULL, *pps = NULL;
+   int sps_len = 0, pps_len = 0, pos = 0, len;
+
+   while (pos < header_len)
+   {
+      int start, end;
+
+      // Skip the start code
+      while (pos < header_len && header[pos] == 0)
+         pos++;
+      if (pos >= header_len || header[pos] != 1)
+         break;
+      start = ++pos;
+
+      for (end = start; end + 2 < header_len; end++)
+         if (header[end] == 0 && header[end + 1] == 0 && header[end + 2] <= 1)
+            break;
+      if (end + 2 >= header_len)
+         end = header_len;
+
+      if ((header[start] & 0x1f) == 7 && !sps)
+      {
+         sps = header + start;
+         sps_len = end - start;
+      }
+      else if ((header[start] & 0x1f) == 8 && !pps)
+      {
+         pps = header + start;
+         pps_len = end - start;
+      }
+      pos = end;
+   }
+
+   len = 11 + sps_len + pps_len;
+   if (!sps || !pps || sps_len < 4 || len > avcc_size)
+      return -1;
+
+   avcc[0] = 1;                     // configurationVersion
+   avcc[1] = sps[1];                // AVCProfileIndication
+   avcc[2] = sps[2];                // profile_compatibility
+   avcc[3] = sps[3];                // AVCLevelIndication
+   avcc[4] = 0xff;                  // 4 byte NAL unit lengths
+   avcc[5] = 0xe1;                  // One SPS
+   avcc[6] = sps_len >> 8;
+   avcc[7] = sps_len & 0xff;
+   memcpy(avcc + 8, sps, sps_len);
+   avcc[8 + sps_len] = 1;           // One PPS
+   avcc[9 + sps_len] = pps_len >> 8;
+   avcc[10 + sps_len] = pps_len & 0xff;
+   memcpy(avcc + 11 + sps_len, pps, pps_len);
+
+   return len;
+}
+
+/**
+ * Convert the Annex B NAL units of a frame to 4 byte length prefixed
+ * ones. SPS, PPS and access unit delimiters are dropped, they are in the
+ * avcC configuration. out must hold at least len + len / 3 bytes.
+ *
+ * @return Size of the converted frame
+ */
+static int annexb_to_avc(const uint8_t *in, int len, uint8_t *out)
+{
+   int pos = 0, out_len = 0;
+
+   while (pos < len)
+   {
+      int start, end, type;
+
+      while (pos < len && in[pos] == 0)
+         pos++;
+      if (pos >= len || in[pos] != 1)
+         break;
+      start = ++pos;
+
+      for (end = start; end + 2 < len; end++)
+         if (in[end] == 0 && in[end + 1] == 0 && in[end + 2] <= 1)
+            break;
+      if (end + 2 >= len)
+         end = len;
+
+      type = in[start] & 0x1f;
+      if (end > start && type != 7 && type != 8 && type != 9)
+      {
+         int nal_len = end - start;
+
+         out[out_len++] = nal_len >> 24;
+         out[out_len++] = nal_len >> 16;
+         out[out_len++] = nal_len >> 8;
+         out[out_len++] = nal_len;
+         memcpy(out + out_len, in + start, nal_len);
+         out_len += nal_len;
+      }
+      pos = end;
+   }
+
+   return out_len;
+}
+
+/**
+ * Find the tracker result for a frame. Called with the lock held.
+ *
+ * @param pts Timestamp of the frame
+ * @param tolerance Largest timestamp difference that still matches
+ * @return The closest result, or NULL if none is close enough
+ */
+static BALL_T *find_ball(RASPIREPLAY_T *replay, int64_t pts, int64_t tolerance)
+{
+   int lo = 0, hi = replay->ball_count - 1, first, i;
+   BALL_T *best = NULL;
+
+   if (!replay->ball_count)
+      return NULL;
+
+   first = replay->ball_head - replay->ball_count;
+   if (first < 0)
+      first += BALL_RING_SIZE;
+
+   // Newest result at or before pts, then compare with the one after it
+   while (lo < hi)
+   {
+      int mid = (lo + hi + 1) / 2;
+      if (replay->balls[(first + mid) % BALL_RING_SIZE].pts <= pts)
+         lo = mid;
+      else
+         hi = mid - 1;
+   }
+
+   for (i = lo; i <= lo + 1 && i < replay->ball_count; i++)
+   {
+      BALL_T *ball = &replay->balls[(first + i) % BALL_RING_SIZE];
+      int64_t diff = ball->pts > pts ? ball->pts - pts : pts - ball->pts;
+
+      if (diff <= tolerance && (!best || diff < (best->pts > pts ? best->pts - pts : pts - best->pts)))
+         best = ball;
+   }
+
+   return best;
+}
+
+/**
+ * Write a clip as MP4, with the frame timestamps from the encoder and the
+ * tracker results as a timed metadata track of JSON samples. The clip is
+ * the same as for raspireplay_export.
+ *
+ * Frames are copied out of the ring and written one at a time, so memory
+ * use is bounded by the largest frame. The sample tables are kept in a
+ * temporary file by the MP4 writer.
+ *
+ * @param replay The ring
+ * @param uri File to write, must end in .mp4
+ * @param duration_us Requested clip length in microseconds, 0 for all
+ * @param slowmo Part of the clip to slow down, or NULL
+ * @return Number of frames written, or -1 on failure
+ */
+int raspireplay_export_mp4(RASPIREPLAY_T *replay, const char *uri, int64_t duration_us,
+                           const RASPIREPLAY_SLOWMO_T *slowmo)
+{
+   VC_CONTAINER_T *writer = NULL;
+   VC_CONTAINER_STATUS_T status;
+   VC_CONTAINER_ES_FORMAT_T format;
+   VC_CONTAINER_ES_SPECIFIC_FORMAT_T type;
+   VC_CONTAINER_PACKET_T packet;
+   uint8_t header[HEADER_SIZE], avcc[HEADER_SIZE + 16];
+   uint8_t *frame = NULL, *sample = NULL;
+   int frame_size = 0, header_len, avcc_len, width, height;
+   int count, i, written = 0;
+   int64_t start, end, next, first_pts = MMAL_TIME_UNKNOWN, pts = 0, frame_us = 0;
+   RASPIKEYFRAME_T *entry;
+
+   vcos_mutex_lock(&replay->lock);
+   entry = clip_start(replay, duration_us);
+   if (!entry)
+   {
+      vcos_mutex_unlock(&replay->lock);
+      vcos_log_error("no keyframe in buffer");
+      return -1;
+   }
+   start = entry->offset;
+   end = replay->frame_end;
+   header_len = replay->header_len;
+   memcpy(header, replay->header, header_len);
+   width = replay->width;
+   height = replay->height;
+   vcos_mutex_unlock(&replay->lock);
+
+   avcc_len = make_avcc(header, header_len, avcc, sizeof(avcc));
+   if (avcc_len < 0)
+   {
+      vcos_log_error("no SPS/PPS headers for MP4 export");
+      return -1;
+   }
+
+   writer = vc_container_open_writer(uri, &status, 0, 0);
+   if (!writer)
+   {
+      vcos_log_error("unable to open MP4 writer for %s (%d)", uri, status);
+      return -1;
+   }
+
+   memset(&format, 0, sizeof(format));
+   memset(&type, 0, sizeof(type));
+   format.type = &type;
+   format.es_type = VC_CONTAINER_ES_TYPE_VIDEO;
+   format.codec = VC_CONTAINER_CODEC_H264;
+   format.codec_variant = VC_FOURCC('a','v','c','C');
+   format.flags = VC_CONTAINER_ES_FORMAT_FLAG_FRAMED;
+   format.extradata = avcc;
+   format.extradata_size = avcc_len;
+   type.video.width = type.video.visible_width = width;
+   type.video.height = type.video.visible_height = height;
+   status = vc_container_control(writer, VC_CONTAINER_CONTROL_TRACK_ADD, &format);
+
+   if (status == VC_CONTAINER_SUCCESS)
+   {
+      memset(&format, 0, sizeof(format));
+      memset(&type, 0, sizeof(type));
+      format.type = &type;
+      format.es_type = VC_CONTAINER_ES_TYPE_UNKNOWN;
+      format.codec = VC_CONTAINER_CODEC_METADATA;
+      format.flags = VC_CONTAINER_ES_FORMAT_FLAG_FRAMED;
+      format.extradata = (uint8_t *)BALL_TRACK_MIME;
+      format.extradata_size = sizeof(BALL_TRACK_MIME);
+      status = vc_container_control(writer, VC_CONTAINER_CONTROL_TRACK_ADD, &format);
+   }
+   if (status == VC_CONTAINER_SUCCESS)
+      status = vc_container_control(writer, VC_CONTAINER_CONTROL_TRACK_ADD_DONE);
+   if (status != VC_CONTAINER_SUCCESS)
+   {
+      vcos_log_error("unable to add MP4 tracks (%d)", status);
+      vc_container_close(writer);
+      return -1;
+   }
+
+   next = start;
+   while (1)
+   {
+      int64_t frame_start, frame_end;
+      int length, offset, copy_to_end, keyframe, sample_len;
+      char meta[64];
+      BALL_T *ball;
+
+      // The index moves on while we write, so find each frame by its offset
+      vcos_mutex_lock(&replay->lock);
+      count = raspikeyframe_index_count(&replay->frames);
+      i = raspikeyframe_index_find_offset(&replay->frames, next);
+      if (i >= count || raspikeyframe_index_get(&replay->frames, i)->offset >= end)
+      {
+         vcos_mutex_unlock(&replay->lock);
+         break;
+      }
+
+      entry = raspikeyframe_index_get(&replay->frames, i);
+      frame_start = entry->offset;
+      // Either the frame has been overwritten or dropped from the index
+      if (frame_start < replay->write_pos - replay->size || (written && frame_start != next))
+      {
+         vcos_mutex_unlock(&replay->lock);
+         vcos_log_error("buffer overtaken while exporting, clip is incomplete");
+         written = -1;
+         break;
+      }
+
+      keyframe = entry->has_header;
+      if (entry->pts != MMAL_TIME_UNKNOWN)
+      {
+         if (first_pts == MMAL_TIME_UNKNOWN)
+            first_pts = entry->pts;
+         else if (entry->pts - first_pts > pts)
+            frame_us = entry->pts - first_pts - pts;
+         pts = entry->pts - first_pts;
+      }
+      else
+         pts += frame_us;
+      frame_end = i + 1 < count ? raspikeyframe_index_get(&replay->frames, i + 1)->offset : replay->frame_end;
+      if (frame_end > end)
+         frame_end = end;
+      length = (int)(frame_end - frame_start);
+      next = frame_end;
+
+      if (length > frame_size)
+      {
+         free(frame);
+         free(sample);
+         frame_size = length;
+         frame = malloc(frame_size);
+         sample = malloc(frame_size + frame_size / 3 + 4);
+         if (!frame || !sample)
+         {
+            vcos_mutex_unlock(&replay->lock);
+            vcos_log_error("out of memory exporting MP4");
+            written = -1;
+            break;
+         }
+      }
+
+      offset = (int)(frame_start % replay->size);
+      copy_to_end = replay->size - offset;
+      if (copy_to_end > length)
+         copy_to_end = length;
+      memcpy(frame, replay->data + offset, copy_to_end);
+      memcpy(frame + copy_to_end, replay->data, length - copy_to_end);
+
+      ball = first_pts == MMAL_TIME_UNKNOWN ? NULL :
+             find_ball(replay, first_pts + pts, frame_us ? frame_us / 2 : 20000);
+      if (ball && ball->found)
+         snprintf(meta, sizeof(meta), "{\"x\":%.4f,\"y\":%.4f}", ball->x, ball->y);
+      else
+         snprintf(meta, sizeof(meta), "{}");
+      vcos_mutex_unlock(&replay->lock);
+
+      sample_len = annexb_to_avc(frame, length, sample);
+
+      memset(&packet, 0, sizeof(packet));
+      packet.data = sample;
+      packet.size = packet.buffer_size = sample_len;
+      packet.pts = packet.dts = first_pts == MMAL_TIME_UNKNOWN ? pts :
+                                slowmo_pts(slowmo, first_pts + pts) - slowmo_pts(slowmo, first_pts);
+      packet.track = 0;
+      packet.flags = VC_CONTAINER_PACKET_FLAG_FRAME_START | VC_CONTAINER_PACKET_FLAG_FRAME_END;
+      if (keyframe)
+         packet.flags |= VC_CONTAINER_PACKET_FLAG_KEYFRAME;
+      status = vc_container_write(writer, &packet);
+
+      if (status == VC_CONTAINER_SUCCESS)
+      {
+         packet.data = (uint8_t *)meta;
+         packet.size = packet.buffer_size = strlen(meta);
+         packet.track = 1;
+         packet.flags = VC_CONTAINER_PACKET_FLAG_FRAME_START | VC_CONTAINER_PACKET_FLAG_FRAME_END |
+                        VC_CONTAINER_PACKET_FLAG_KEYFRAME;
+         status = vc_container_write(writer, &packet);
+      }
+      if (status != VC_CONTAINER_SUCCESS)
+      {
+         vcos_log_error("MP4 write failed (%d)", status);
+         written = -1;
+         break;
+      }
+
+      written++;
+   }
+
+   if (vc_container_close(writer) != VC_CONTAINER_SUCCESS)
+      written = -1;
+   free(frame);
+   free(sample);
+
+   if (written == 0)
+   {
+      vcos_log_error("no complete frame after keyframe");
+      return -1;
+   }
+
+   return written;
+}
+
+/**
+ * Write the timestamps of a raw clip as a timecode file for mkvmerge,
+ * in the format of the -pts option of raspiballs.
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int write_timecodes(const char *filename, const int64_t *pts, int frames,
+                           const RASPIREPLAY_SLOWMO_T *slowmo)
+{
+   char tmpname[PATH_MAX];
+   FILE *file;
+   int i, result = 0;
+
+   if (snprintf(tmpname, sizeof(tmpname), "%s.tmp", filename) >= (int)sizeof(tmpname))
+   {
+      vcos_log_error("timecode file name %s is too long", filename);
+      return -1;
+   }
+   file = fopen(tmpname, "w");
+   if (!file)
+   {
+      vcos_log_error("unable to open %s", tmpname);
+      return -1;
+   }
+
+   fprintf(file, "# timecode format v2\n");
+   for (i = 0; i < frames; i++)
+   {
+      int64_t t = slowmo_pts(slowmo, pts[i]) - slowmo_pts(slowmo, pts[0]);
+      fprintf(file, "%lld.%03lld\n", (long long)(t / 1000), (long long)(t % 1000));
+   }
+
+   if (fclose(file) != 0 || rename(tmpname, filename) != 0)
+      result = -1;
+   if (result)
+      unlink(tmpname);
+   return result;
+}
+
+/**
+ * Write a clip to a file. The clip is written to a temporary file that is
+ * renamed when complete, so a player never sees a partial clip. Files
+ * ending in .mp4 are written as MP4, all others as raw H264.
+ *
+ * Raw H264 has no timestamps, so a slow motion raw clip comes with a
+ * timecode file named after the clip with .pts appended.
+ *
+ * @param slowmo Part of the clip to slow down, or NULL
+ * @return Number of bytes (raw) or frames (MP4) written, or -1 on failure
+ */
+int raspireplay_export_file(RASPIREPLAY_T *replay, const char *filename, int64_t duration_us,
+                            const RASPIREPLAY_SLOWMO_T *slowmo)
+{
+   char tmpname[PATH_MAX];
+   const char *ext = strrchr(filename, '.');
+   int64_t *pts = NULL;
+   int fd, result, frames = 0;
+
+   if (ext && !strcasecmp(ext, ".mp4"))
+   {
+      // The MP4 writer picks the format from the extension
+      if (snprintf(tmpname, sizeof(tmpname), "%s.tmp.mp4", filename) >= (int)sizeof(tmpname))
+      {
+         vcos_log_error("clip name %s is too long", filename);
+         return -1;
+      }
+      result = raspireplay_export_mp4(replay, tmpname, duration_us, slowmo);
+      if (result < 0 || rename(tmpname, filename) != 0)
+      {
+         unlink(tmpname);
+         return -1;
+      }
+      return result;
+   }
+
+   if (snprintf(tmpname, sizeof(tmpname), "%s.tmp", filename) >= (int)sizeof(tmpname))
+   {
+      vcos_log_error("clip name %s is too long", filename);
+      return -1;
+   }
+
+   fd = open(tmpname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+   if (fd < 0)
+   {
+      vcos_log_error("unable to open %s", tmpname);
+      return -1;
+   }
+
+   result = export_clip(replay, fd, duration_us, slowmo ? &pts : NULL, &frames);
+   close(fd);
+
+   if (result >= 0 && pts)
+   {
+      char ptsname[PATH_MAX];
+
+      if (snprintf(ptsname, sizeof(ptsname), "%s.pts", filename) >= (int)sizeof(ptsname) ||
+          write_timecodes(ptsname, pts, frames, slowmo) != 0)
+         result = -1;
+   }
+   free(pts);
+
+   if (result < 0 || rename(tmpname, filename) != 0)
+   {
+      unlink(tmpname);
+      return -1;
+   }
+
+   return result;
+}
+
+static void *export_worker(void *arg)
+{
+   RASPIREPLAY_T *replay = arg;
+
+   while (1)
+   {
+      char filename[256];
+      int64_t duration_us;
+      RASPIREPLAY_SLOWMO_T slowmo;
+      int has_slowmo, pending, running, result;
+
+      vcos_semaphore_wait(&replay->export_work);
+
+      vcos_mutex_lock(&replay->lock);
+      pending = replay->export_pending;
+      replay->export_pending = 0;
+      memcpy(filename, replay->export_filename, sizeof(filename));
+      duration_us = replay->export_duration;
+      slowmo = replay->export_slowmo;
+      has_slowmo = replay->export_has_slowmo;
+      running = replay->export_running;
+      vcos_mutex_unlock(&replay->lock);
+
+      if (!pending)
+      {
+         if (!running)
+            break;
+         continue;
+      }
+
+      result = raspireplay_export_file(replay, filename, duration_us, has_slowmo ? &slowmo : NULL);
+      if (result < 0)
+         vcos_log_error("unable to write replay to %s", filename);
+      if (replay->export_done)
+         replay->export_done(replay->export_userdata, filename, result);
+   }
+
+   return NULL;
+}
+
+/**
+ * Start a thread that writes the clips asked for with
+ * raspireplay_request_file, so callers such as the GL thread never wait
+ * for the file system.
+ *
+ * @param done Called from the export thread after each clip, or NULL
+ * @param userdata Passed to done
+ * @return 0 on success, -1 on failure
+ */
+int raspireplay_start_exporter(RASPIREPLAY_T *replay, RASPIREPLAY_DONE_FN_T done, void *userdata)
+{
+   if (vcos_semaphore_create(&replay->export_work, "replay-export", 0) != VCOS_SUCCESS)
+   {
+      vcos_log_error("unable to create export semaphore");
+      return -1;
+   }
+
+   replay->export_done = done;
+   replay->export_userdata = userdata;
+   replay->export_running = 1;
+   if (vcos_thread_create(&replay->export_thread, "replay-export", NULL, export_worker, replay) != VCOS_SUCCESS)
+   {
+      vcos_log_error("unable to start export thread");
+      replay->export_running = 0;
+      vcos_semaphore_delete(&replay->export_work);
+      return -1;
+   }
+
+   return 0;
+}
+
+/// Stop the export thread, after it has written the clip it is on
+void raspireplay_stop_exporter(RASPIREPLAY_T *replay)
+{
+   if (!replay->export_running)
+      return;
+
+   vcos_mutex_lock(&replay->lock);
+   replay->export_pending = 0;
+   replay->export_running = 0;
+   vcos_mutex_unlock(&replay->lock);
+   vcos_semaphore_post(&replay->export_work);
+   vcos_thread_join(&replay->export_thread, NULL);
+   vcos_semaphore_delete(&replay->export_work);
+}
+
+/**
+ * Ask the export thread to write a clip with raspireplay_export_file.
+ * Returns at once. A request that has not been started yet is replaced by
+ * a newer one. Can be called from any thread.
+ *
+ * @param slowmo Part of the clip to slow down, or NULL
+ * @return 0 if the request was queued, -1 without an export thread
+ */
+int raspireplay_request_file(RASPIREPLAY_T *replay, const char *filename, int64_t duration_us,
+                             const RASPIREPLAY_SLOWMO_T *slowmo)
+{
+   int replaced;
+
+   vcos_mutex_lock(&replay->lock);
+   if (!replay->export_running)
+   {
+      vcos_mutex_unlock(&replay->lock);
+      return -1;
+   }
+   replaced = replay->export_pending;
+   strncpy(replay->export_filename, filename, sizeof(replay->export_filename) - 1);
+   replay->export_filename[sizeof(replay->export_filename) - 1] = 0;
+   replay->export_duration = duration_us;
+   replay->export_has_slowmo = slowmo != NULL;
+   if (slowmo)
+      replay->export_slowmo = *slowmo;
+   replay->export_pending = 1;
+   vcos_mutex_unlock(&replay->lock);
+
+   // One post per queued request, the worker finds the newest in the slot
+   if (!replaced)
+      vcos_semaphore_post(&replay->export_work);
+   return 0;
+}
+
+/**
+ * Build the path of a file for a REPLAY request. Only plain names are
+ * taken, so a client cannot write outside the replay directory.
+ *
+ * @return 0 on success, -1 if the name is refused
+ */
+static int control_filename(RASPIREPLAY_T *replay, const char *name, char *path, int size)
+{
+   if (!replay->control_dir[0] || !name[0] || name[0] == '.' || strchr(name, '/'))
+      return -1;
+   if (snprintf(path, size, "%s/%s", replay->control_dir, name) >= size)
+      return -1;
+   return 0;
+}
+
+/**
+ * Handle one control connection. Commands are single lines:
+ *   REPLAY <ms> <filename>   Write the last <ms> to a file in the replay directory,
+ *                            answers OK <bytes> or ERROR
+ *   STREAM <ms>              Write the last <ms> to this connection and close it
+ */
+static void control_handle(RASPIREPLAY_T *replay, int fd)
+{
+   char line[300];
+   char filename[256];
+   char path[512];
+   char reply[64];
+   int len = 0, ms, result;
+
+   // Read one line
+   while (len < (int)sizeof(line) - 1)
+   {
+      ssize_t r = read(fd, line + len, sizeof(line) - 1 - len);
+      if (r <= 0)
+         break;
+      len += r;
+      if (memchr(line, '\n', len))
+         break;
+   }
+   line[len] = 0;
+
+   if (sscanf(line, "REPLAY %d %255s", &ms, filename) == 2)
+   {
+      if (control_filename(replay, filename, path, sizeof(path)) == 0)
+         result = raspireplay_export_file(replay, path, (int64_t)ms * 1000, NULL);
+      else
+      {
+         vcos_log_error("refused replay file name %s", filename);
+         result = -1;
+      }
+      if (result >= 0)
+         snprintf(reply, sizeof(reply), "OK %d\n", result);
+      else
+         snprintf(reply, sizeof(reply), "ERROR\n");
+      if (write(fd, reply, strlen(reply)) < 0)
+         vcos_log_error("unable to reply on control socket");
+   }
+   else if (sscanf(line, "STREAM %d", &ms) == 1)
+   {
+      raspireplay_export(replay, fd, (int64_t)ms * 1000);
+   }
+   else
+   {
+      vcos_log_error("unknown control command %s", line);
+   }
+}
+
+static void *control_worker(void *arg)
+{
+   RASPIREPLAY_T *replay = arg;
+
+   while (replay->control_running)
+   {
+      int fd = accept(replay->control_fd, NULL, NULL);
+
+      if (fd < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         break;
+      }
+
+      control_handle(replay, fd);
+      close(fd);
+   }
+
+   return NULL;
+}
+
+/**
+ * Create the directory of the control socket, or check an existing one,
+ * so that only this user can reach the socket.
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int control_socket_dir(const char *socket_path)
+{
+   char dir[108];
+   char *slash;
+   struct stat st;
+
+   strncpy(dir, socket_path, sizeof(dir) - 1);
+   dir[sizeof(dir) - 1] = 0;
+   slash = strrchr(dir, '/');
+   if (!slash || slash == dir)
+   {
+      vcos_log_error("control socket %s needs a directory of its own", socket_path);
+      return -1;
+   }
+   *slash = 0;
+
+   if (mkdir(dir, 0700) != 0 && errno != EEXIST)
+   {
+      vcos_log_error("unable to create %s", dir);
+      return -1;
+   }
+
+   if (lstat(dir, &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != geteuid() ||
+       (st.st_mode & (S_IRWXG | S_IRWXO)))
+   {
+      vcos_log_error("%s is not a private directory of this user", dir);
+      return -1;
+   }
+
+   return 0;
+}
+
+/**
+ * Start a thread that serves replay requests on a UNIX socket. The socket
+ * is created in a directory only this user can access, and REPLAY requests
+ * can only write into replay_dir.
+ *
+ * @param replay The ring
+ * @param socket_path Path of the socket to create
+ * @param replay_dir Directory REPLAY requests write into, NULL to refuse them
+ * @return 0 on success, -1 on failure
+ */
+int raspireplay_start_control(RASPIREPLAY_T *replay, const char *socket_path, const char *replay_dir)
+{
+   struct sockaddr_un addr;
+
+   // A truncated path would bind or write somewhere else
+   if (strlen(socket_path) >= sizeof(addr.sun_path) || strlen(socket_path) >= sizeof(replay->control_path))
+   {
+      vcos_log_error("control socket path %s is too long", socket_path);
+      return -1;
+   }
+   if (replay_dir && strlen(replay_dir) >= sizeof(replay->control_dir))
+   {
+      vcos_log_error("replay directory %s is too long", replay_dir);
+      return -1;
+   }
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   memcpy(addr.sun_path, socket_path, strlen(socket_path) + 1);
+   memcpy(replay->control_path, socket_path, strlen(socket_path) + 1);
+   replay->control_dir[0] = 0;
+   if (replay_dir)
+      memcpy(replay->control_dir, replay_dir, strlen(replay_dir) + 1);
+
+   if (control_socket_dir(addr.sun_path) != 0)
+      return -1;
+
+   replay->control_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (replay->control_fd < 0)
+   {
+      vcos_log_error("unable to create control socket");
+      return -1;
+   }
+
+   unlink(socket_path);
+   if (bind(replay->control_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+       chmod(socket_path, 0600) < 0 || listen(replay->control_fd, 4) < 0)
+   {
+      vcos_log_error("unable to listen on %s", socket_path);
+      close(replay->control_fd);
+      replay->control_fd = -1;
+      return -1;
+   }
+
+   replay->control_running = 1;
+   if (vcos_thread_create(&replay->control_thread, "replay-control", NULL, control_worker, replay) != VCOS_SUCCESS)
+   {
+      vcos_log_error("unable to start control thread");
+      replay->control_running = 0;
+      close(replay->control_fd);
+      replay->control_fd = -1;
+      return -1;
+   }
+
+   return 0;
+}
+
+void raspireplay_stop_control(RASPIREPLAY_T *replay)
+{
+   if (!replay->control_running)
+      return;
+
+   replay->control_running = 0;
+   // Wakes up the accept in the control thread
+   shutdown(replay->control_fd, SHUT_RDWR);
+   vcos_thread_join(&replay->control_thread, NULL);
+   close(replay->control_fd);
+   replay->control_fd = -1;
+   unlink(replay->control_path);
+}
@@ -0,0 +1,69 @@
+#ifndef RASPIREPLAY_H_
+#define RASPIREPLAY_H_
+
+#include <stdint.h>
+
+/**
+ * In-process replay buffer for the encoded H264 stream.
+ *
+ * Keeps the last few seconds of encoder output in a preallocated ring
+ * together with an index of the keyframes in it. A clip that starts at a
+ * keyframe can be exported to a file or socket with a single writev, so
+ * replays do not need segment files on disk.
+ *
+ * Data is added from the encoder callback, exports can come from any
+ * other thread (control socket thread). Threads that must not block, such
+ * as the GL thread on tracker events, hand clips to an export thread with
+ * raspireplay_request_file.
+ *
+ * Clips can also be exported as MP4 with the encoder timestamps and a
+ * second track holding the tracker result of every frame.
+ *
+ * For slow motion replays the camera runs at a high framerate and a part
+ * of the clip is stretched in time on export. Only timestamps change, the
+ * encoded frames are written as they are.
+ */
+typedef struct RASPIREPLAY_S RASPIREPLAY_T;
+
+/// Flags for raspireplay_add
+#define RASPIREPLAY_FLAG_KEYFRAME  1   /// Buffer is part of a keyframe
+#define RASPIREPLAY_FLAG_FRAME_END 2   /// Buffer ends a frame
+#define RASPIREPLAY_FLAG_CONFIG    4   /// Buffer holds SPS/PPS headers
+
+/// Part of a clip that is played back slower
+typedef struct
+{
+   int64_t start_pts;               /// Camera timestamp where slow motion starts
+   int64_t end_pts;                 /// Camera timestamp where it ends
+   int factor;                      /// Times slower than real time, 1 for none
+} RASPIREPLAY_SLOWMO_T;
+
+/// Called from the export thread when a requested clip has been written,
+/// with the result of raspireplay_export_file
+typedef void (*RASPIREPLAY_DONE_FN_T)(void *userdata, const char *filename, int result);
+
+RASPIREPLAY_T *raspireplay_create(int size);
+void raspireplay_destroy(RASPIREPLAY_T *replay);
+
+void raspireplay_set_format(RASPIREPLAY_T *replay, int width, int height);
+
+void raspireplay_add(RASPIREPLAY_T *replay, const uint8_t *data, int length, int64_t pts, int flags);
+void raspireplay_add_ball(RASPIREPLAY_T *replay, int64_t pts, float x, float y, int found);
+int64_t raspireplay_ball_pts(RASPIREPLAY_T *replay, int results_ago);
+int64_t raspireplay_last_pts(RASPIREPLAY_T *replay);
+
+int raspireplay_export(RASPIREPLAY_T *replay, int fd, int64_t duration_us);
+int raspireplay_export_mp4(RASPIREPLAY_T *replay, const char *uri, int64_t duration_us,
+                           const RASPIREPLAY_SLOWMO_T *slowmo);
+int raspireplay_export_file(RASPIREPLAY_T *replay, const char *filename, int64_t duration_us,
+                            const RASPIREPLAY_SLOWMO_T *slowmo);
+
+int raspireplay_start_exporter(RASPIREPLAY_T *replay, RASPIREPLAY_DONE_FN_T done, void *userdata);
+void raspireplay_stop_exporter(RASPIREPLAY_T *replay);
+int raspireplay_request_file(RASPIREPLAY_T *replay, const char *filename, int64_t duration_us,
+                             const RASPIREPLAY_SLOWMO_T *slowmo);
+
+int raspireplay_start_control(RASPIREPLAY_T *replay, const char *socket_path, const char *replay_dir);
+void raspireplay_stop_control(RASPIREPLAY_T *replay);
+
+#endif
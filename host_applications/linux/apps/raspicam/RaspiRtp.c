@@ -0,0 +1,826 @@
+/**
+ * \file RaspiRtp.c
+ * RTP sender for the H264 encoder output, see RaspiRtp.h
+ *
+ * Packets are built in place in a ring of MTU sized slots. Slot positions
+ * are absolute counts, the ring holds [tail, head). The producer only
+ * publishes head at the end of an access unit, so the sender thread
+ * always sees whole access units, the last packet of each carrying the
+ * RTP marker bit.
+ */
+
+// sendmmsg needs GNU extensions
+#ifndef _GNU_SOURCE
+   #define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "interface/vcos/vcos.h"
+
+#include "RaspiRtp.h"
+
+static VCOS_LOG_CAT_T raspirtp_log_category;
+#define VCOS_LOG_CATEGORY (&raspirtp_log_category)
+
+/// Packets in the ring, a 1080p keyframe is well under 256 packets
+#define SLOT_COUNT 1024
+
+/// Largest RTP packet, an Ethernet MTU less the IPv4 and UDP headers
+#define MAX_PACKET (RASPIRTP_DEFAULT_MTU - 28)
+
+#define RTP_HEADER 12
+
+/// Largest access unit that is collected before packetizing
+#define MAX_FRAME (2 * 1024 * 1024)
+
+/// Packets per sendmmsg call
+#define BATCH 32
+
+/// Bursts an access unit is split into when pacing
+#define PACE_STEPS 8
+
+/// Longest time an access unit is spread over
+#define MAX_PACE_US 40000
+
+/// Most NAL units aggregated into one STAP-A packet
+#define MAX_AGGREGATE 16
+
+#define NAL_TYPE_MASK 0x1f
+#define NAL_NRI_MASK  0x60
+#define NAL_SPS       7
+#define NAL_PPS       8
+#define NAL_STAP_A    24
+#define NAL_FU_A      28
+
+#define FU_START      0x80
+#define FU_END        0x40
+
+typedef struct
+{
+   int length;                      /// RTP packet length
+   int marker;                      /// Last packet of an access unit
+   int pace_us;                     /// Time to spread the access unit over, on the marker packet
+   int64_t queued_us;               /// Time the access unit was queued, on the marker packet
+   uint8_t data[MAX_PACKET];
+} SLOT_T;
+
+struct RASPIRTP_S
+{
+   VCOS_MUTEX_T lock;
+   VCOS_SEMAPHORE_T work;           /// Posted for every queued access unit
+   VCOS_THREAD_T thread;
+
+   int sock;
+   int max_packet;
+   char host[64];
+   char port[16];
+
+   SLOT_T *slots;
+   uint64_t head;                   /// Next slot to fill, published at the end of access units
+   uint64_t tail;                   /// Next slot to send
+   int running;
+   int pace_percent;                /// Part of the frame interval an access unit is spread over
+
+   // Producer state, only used by the encoder callback
+   uint8_t *frame;                  /// Access unit being collected
+   int frame_len;
+   int frame_size;
+   int64_t last_pts;
+   int frame_us;                    /// Measured frame interval
+   uint32_t timestamp;              /// RTP timestamp of the last access unit
+   uint32_t timestamp_base;
+   uint32_t ssrc;
+   uint16_t seq;
+
+   // Parameter sets for the stream description, protected by the lock
+   uint8_t sps[128];
+   int sps_len;
+   uint8_t pps[128];
+   int pps_len;
+
+   RASPIRTP_STATS_T stats;
+};
+
+static uint32_t random_u32(void)
+{
+   uint32_t value;
+   int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+
+   if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value))
+      value = (uint32_t)(vcos_getmicrosecs64() * 2654435761u) ^ (uint32_t)getpid();
+   if (fd >= 0)
+      close(fd);
+   return value;
+}
+
+/**
+ * Send packets [from, to) of the ring, BATCH packets per system call
+ */
+static void send_packets(RASPIRTP_T *rtp, uint64_t from, uint64_t to)
+{
+   struct mmsghdr msgs[BATCH];
+   struct iovec iov[BATCH];
+   uint32_t calls = 0, errors = 0;
+   uint64_t bytes = 0;
+
+   while (from < to)
+   {
+      int count = to - from > BATCH ? BATCH : (int)(to - from);
+      int i, sent = 0;
+
+      memset(msgs, 0, sizeof(msgs[0]) * count);
+      for (i = 0; i < count; i++)
+      {
+         SLOT_T *slot = &rtp->slots[(from + i) % SLOT_COUNT];
+
+         iov[i].iov_base = slot->data;
+         iov[i].iov_len = slot->length;
+         msgs[i].msg_hdr.msg_iov = &iov[i];
+         msgs[i].msg_hdr.msg_iovlen = 1;
+         bytes += slot->length;
+      }
+
+      while (sent < count)
+      {
+         int result = sendmmsg(rtp->sock, msgs + sent, count - sent, 0);
+
+         calls++;
+         if (result < 0)
+         {
+            if (errno == EINTR)
+               continue;
+            // Nothing to retry for a live stream, the receiver conceals the loss
+            errors += count - sent;
+            break;
+         }
+         sent += result;
+      }
+
+      from += count;
+   }
+
+   vcos_mutex_lock(&rtp->lock);
+   rtp->stats.send_calls += calls;
+   rtp->stats.send_errors += errors;
+   rtp->stats.bytes += bytes;
+   vcos_mutex_unlock(&rtp->lock);
+}
+
+/**
+ * Send one access unit, spread over pace_us in PACE_STEPS bursts
+ */
+static void send_frame(RASPIRTP_T *rtp, uint64_t start, uint64_t end, int pace_us)
+{
+   int count = (int)(end - start);
+   int steps = pace_us > 0 ? (count < PACE_STEPS ? count : PACE_STEPS) : 1;
+   struct timespec t0;
+   int step;
+
+   clock_gettime(CLOCK_MONOTONIC, &t0);
+
+   for (step = 0; step < steps; step++)
+   {
+      if (step)
+      {
+         struct timespec t = t0;
+         long ns = t.tv_nsec + (long)pace_us * step / steps * 1000;
+
+         t.tv_sec += ns / 1000000000;
+         t.tv_nsec = ns % 1000000000;
+         while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR)
+            ;
+      }
+      send_packets(rtp, start + (uint64_t)count * step / steps, start + (uint64_t)count * (step + 1) / steps);
+   }
+}
+
+static void *sender_thread(void *arg)
+{
+   RASPIRTP_T *rtp = (RASPIRTP_T *)arg;
+
+   while (1)
+   {
+      uint64_t head, tail;
+      int running;
+
+      vcos_semaphore_wait(&rtp->work);
+
+      vcos_mutex_lock(&rtp->lock);
+      head = rtp->head;
+      tail = rtp->tail;
+      running = rtp->running;
+      vcos_mutex_unlock(&rtp->lock);
+
+      while (tail < head)
+      {
+         uint64_t end = tail, i;
+         SLOT_T *last;
+         int64_t delay;
+         uint32_t stap = 0, fu = 0;
+
+         while (!rtp->slots[end % SLOT_COUNT].marker)
+            end++;
+         last = &rtp->slots[end % SLOT_COUNT];
+         end++;
+
+         // Only pace when there is no backlog, latency comes first
+         send_frame(rtp, tail, end, end < head ? 0 : last->pace_us);
+         delay = vcos_getmicrosecs64() - last->queued_us;
+
+         // The slots stay ours until the tail moves past them
+         for (i = tail; i < end; i++)
+         {
+            int type = rtp->slots[i % SLOT_COUNT].data[RTP_HEADER] & NAL_TYPE_MASK;
+
+            stap += type == NAL_STAP_A;
+            fu += type == NAL_FU_A;
+         }
+
+         vcos_mutex_lock(&rtp->lock);
+         rtp->tail = end;
+         rtp->stats.frames++;
+         rtp->stats.packets += end - tail;
+         rtp->stats.stap_packets += stap;
+         rtp->stats.fu_packets += fu;
+         if (delay > rtp->stats.max_frame_us)
+            rtp->stats.max_frame_us = (uint32_t)delay;
+         head = rtp->head;
+         vcos_mutex_unlock(&rtp->lock);
+
+         tail = end;
+      }
+
+      if (!running)
+         break;
+   }
+
+   return NULL;
+}
+
+/**
+ * Create a sender for a host and port. Multicast addresses work as well.
+ *
+ * @param mtu Largest IP packet, RASPIRTP_DEFAULT_MTU or smaller for tunnels
+ * @return The sender, or NULL on failure
+ */
+RASPIRTP_T *raspirtp_create(const char *host, const char *port, int mtu)
+{
+   struct addrinfo hints, *addrs = NULL, *addr;
+   RASPIRTP_T *rtp;
+   int sndbuf = 1024 * 1024;
+
+   vcos_log_register("RaspiRtp", VCOS_LOG_CATEGORY);
+
+   if (mtu <= 28 + RTP_HEADER + 2 || mtu > RASPIRTP_DEFAULT_MTU)
+      mtu = RASPIRTP_DEFAULT_MTU;
+
+   rtp = calloc(1, sizeof(*rtp));
+   if (!rtp)
+      return NULL;
+   rtp->sock = -1;
+   rtp->max_packet = mtu - 28;
+   rtp->pace_percent = 50;
+   rtp->last_pts = -1;
+   rtp->frame_us = 1000000 / 30;
+   rtp->ssrc = random_u32();
+   rtp->seq = (uint16_t)random_u32();
+   rtp->stats.next_seq = rtp->seq;
+   rtp->timestamp_base = random_u32();
+   rtp->timestamp = rtp->timestamp_base;
+   strncpy(rtp->host, host, sizeof(rtp->host) - 1);
+   strncpy(rtp->port, port, sizeof(rtp->port) - 1);
+
+   memset(&hints, 0, sizeof(hints));
+   hints.ai_family = AF_UNSPEC;
+   hints.ai_socktype = SOCK_DGRAM;
+   if (getaddrinfo(host, port, &hints, &addrs) != 0)
+   {
+      vcos_log_error("unable to resolve %s:%s", host, port);
+      free(rtp);
+      return NULL;
+   }
+
+   for (addr = addrs; addr; addr = addr->ai_next)
+   {
+      rtp->sock = socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC, addr->ai_protocol);
+      if (rtp->sock < 0)
+         continue;
+      if (connect(rtp->sock, addr->ai_addr, addr->ai_addrlen) == 0)
+         break;
+      close(rtp->sock);
+      rtp->sock = -1;
+   }
+   freeaddrinfo(addrs);
+
+   if (rtp->sock < 0)
+   {
+      vcos_log_error("unable to connect to %s:%s (%s)", host, port, strerror(errno));
+      free(rtp);
+      return NULL;
+   }
+
+   // Room for a keyframe, a full socket buffer drops packets
+   setsockopt(rtp->sock, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+   rtp->slots = malloc(SLOT_COUNT * sizeof(SLOT_T));
+   rtp->frame_size = 256 * 1024;
+   rtp->frame = malloc(rtp->frame_size);
+   if (!rtp->slots || !rtp->frame)
+      goto error;
+
+   if (vcos_mutex_create(&rtp->lock, "RaspiRtp") != VCOS_SUCCESS)
+      goto error;
+   if (vcos_semaphore_create(&rtp->work, "RaspiRtp-work", 0) != VCOS_SUCCESS)
+   {
+      vcos_mutex_delete(&rtp->lock);
+      goto error;
+   }
+
+   rtp->running = 1;
+   if (vcos_thread_create(&rtp->thread, "RaspiRtp", NULL, sender_thread, rtp) != VCOS_SUCCESS)
+   {
+      vcos_semaphore_delete(&rtp->work);
+      vcos_mutex_delete(&rtp->lock);
+      goto error;
+   }
+
+   return rtp;
+
+error:
+   close(rtp->sock);
+   free(rtp->slots);
+   free(rtp->frame);
+   free(rtp);
+   return NULL;
+}
+
+/**
+ * Send what is queued and stop the sender
+ */
+void raspirtp_destroy(RASPIRTP_T *rtp)
+{
+   void *result;
+
+   if (!rtp)
+      return;
+
+   vcos_mutex_lock(&rtp->lock);
+   rtp->running = 0;
+   vcos_mutex_unlock(&rtp->lock);
+   vcos_semaphore_post(&rtp->work);
+   vcos_thread_join(&rtp->thread, &result);
+
+   vcos_semaphore_delete(&rtp->work);
+   vcos_mutex_delete(&rtp->lock);
+   close(rtp->sock);
+   free(rtp->slots);
+   free(rtp->frame);
+   free(rtp);
+}
+
+/**
+ * Set the part of the frame interval, in percent, that an access unit is
+ * spread over. 0 sends every access unit as one burst.
+ */
+void raspirtp_set_pacing(RASPIRTP_T *rtp, int pace_percent)
+{
+   rtp->pace_percent = pace_percent < 0 ? 0 : pace_percent > 100 ? 100 : pace_percent;
+}
+
+/**
+ * Find the next NAL unit in Annex-B data
+ *
+ * @param pos Position to search from, updated to the end of the NAL unit
+ * @param nal_len Returns the NAL unit length, without start code and trailing zeros
+ * @return Start of the NAL unit header, or NULL if there are no more
+ */
+static const uint8_t *next_nal(const uint8_t *data, int length, int *pos, int *nal_len)
+{
+   int i = *pos, start, end;
+
+   // Start code
+   while (i + 3 <= length && !(data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1))
+      i++;
+   if (i + 3 > length)
+      return NULL;
+   start = i + 3;
+
+   // Next start code or the end of the data
+   for (i = start; i + 3 <= length; i++)
+      if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+         break;
+   end = i + 3 <= length ? i : length;
+   *pos = end;
+
+   // NAL units never end in zero bytes, those belong to the next start code
+   while (end > start && data[end - 1] == 0)
+      end--;
+   if (end == start)
+      return next_nal(data, length, pos, nal_len);
+
+   *nal_len = end - start;
+   return data + start;
+}
+
+/**
+ * Start a new packet of the current access unit
+ *
+ * @return The packet, or NULL if the ring is full
+ */
+static SLOT_T *new_packet(RASPIRTP_T *rtp, uint64_t *head, uint64_t tail)
+{
+   SLOT_T *slot;
+   uint8_t *p;
+
+   if (*head - tail >= SLOT_COUNT)
+      return NULL;
+
+   slot = &rtp->slots[*head % SLOT_COUNT];
+   (*head)++;
+
+   p = slot->data;
+   p[0] = 0x80;                     // Version 2
+   p[1] = RASPIRTP_PAYLOAD_TYPE;
+   p[2] = rtp->seq >> 8;
+   p[3] = rtp->seq & 0xff;
+   p[4] = rtp->timestamp >> 24;
+   p[5] = (rtp->timestamp >> 16) & 0xff;
+   p[6] = (rtp->timestamp >> 8) & 0xff;
+   p[7] = rtp->timestamp & 0xff;
+   p[8] = rtp->ssrc >> 24;
+   p[9] = (rtp->ssrc >> 16) & 0xff;
+   p[10] = (rtp->ssrc >> 8) & 0xff;
+   p[11] = rtp->ssrc & 0xff;
+   rtp->seq++;
+
+   slot->length = RTP_HEADER;
+   slot->marker = 0;
+   return slot;
+}
+
+/**
+ * Send the aggregated NAL units, as a single NAL unit packet if there is
+ * only one
+ *
+ * @return 0 on success, -1 if the ring is full
+ */
+static int flush_aggregate(RASPIRTP_T *rtp, uint64_t *head, uint64_t tail,
+                           const uint8_t **nals, const int *lens, int *count)
+{
+   SLOT_T *slot;
+   uint8_t nri = 0;
+   int i;
+
+   if (!*count)
+      return 0;
+
+   slot = new_packet(rtp, head, tail);
+   if (!slot)
+      return -1;
+
+   if (*count == 1)
+   {
+      memcpy(slot->data + slot->length, nals[0], lens[0]);
+      slot->length += lens[0];
+   }
+   else
+   {
+      uint8_t *p = slot->data + slot->length;
+
+      p++;
+      for (i = 0; i < *count; i++)
+      {
+         if ((nals[i][0] & NAL_NRI_MASK) > nri)
+            nri = nals[i][0] & NAL_NRI_MASK;
+         *p++ = lens[i] >> 8;
+         *p++ = lens[i] & 0xff;
+         memcpy(p, nals[i], lens[i]);
+         p += lens[i];
+      }
+      slot->data[slot->length] = nri | NAL_STAP_A;
+      slot->length = p - slot->data;
+   }
+
+   *count = 0;
+   return 0;
+}
+
+/// Keep a parameter set for the stream description
+static void save_parameter_set(RASPIRTP_T *rtp, const uint8_t *nal, int len)
+{
+   int type = nal[0] & NAL_TYPE_MASK;
+
+   if (len > (int)sizeof(rtp->sps))
+      return;
+
+   vcos_mutex_lock(&rtp->lock);
+   if (type == NAL_SPS)
+   {
+      memcpy(rtp->sps, nal, len);
+      rtp->sps_len = len;
+   }
+   else
+   {
+      memcpy(rtp->pps, nal, len);
+      rtp->pps_len = len;
+   }
+   vcos_mutex_unlock(&rtp->lock);
+}
+
+/**
+ * Packetize the collected access unit into the ring and hand it to the
+ * sender thread
+ *
+ * @return 0 on success, -1 if the access unit was dropped
+ */
+static int packetize(RASPIRTP_T *rtp, int64_t pts)
+{
+   const uint8_t *nals[MAX_AGGREGATE];
+   int lens[MAX_AGGREGATE];
+   int count = 0, aggregate_len = 0, pos = 0, nal_len, payload = rtp->max_packet - RTP_HEADER;
+   uint64_t head, tail, start;
+   uint16_t seq = rtp->seq;
+   const uint8_t *nal;
+   SLOT_T *last;
+
+   vcos_mutex_lock(&rtp->lock);
+   head = start = rtp->head;
+   tail = rtp->tail;
+   vcos_mutex_unlock(&rtp->lock);
+
+   // 90 kHz timestamps from the capture time, or a frame after the last
+   if (pts >= 0)
+   {
+      if (rtp->last_pts >= 0 && pts > rtp->last_pts && pts - rtp->last_pts < 1000000)
+         rtp->frame_us = (int)(pts - rtp->last_pts);
+      rtp->last_pts = pts;
+      rtp->timestamp = rtp->timestamp_base + (uint32_t)(pts * 9 / 100);
+   }
+   else
+   {
+      rtp->timestamp += (uint32_t)(rtp->frame_us * 9 / 100);
+   }
+
+   while ((nal = next_nal(rtp->frame, rtp->frame_len, &pos, &nal_len)) != NULL)
+   {
+      int type = nal[0] & NAL_TYPE_MASK;
+
+      if (type == NAL_SPS || type == NAL_PPS)
+         save_parameter_set(rtp, nal, nal_len);
+
+      // Small NAL units go into a STAP-A packet with a 1 byte header and 2 byte sizes
+      if (nal_len + 2 <= payload - 1)
+      {
+         if (count == MAX_AGGREGATE || 1 + aggregate_len + 2 + nal_len > payload)
+         {
+            if (flush_aggregate(rtp, &head, tail, nals, lens, &count) != 0)
+               goto full;
+            aggregate_len = 0;
+         }
+         nals[count] = nal;
+         lens[count++] = nal_len;
+         aggregate_len += 2 + nal_len;
+         continue;
+      }
+
+      if (flush_aggregate(rtp, &head, tail, nals, lens, &count) != 0)
+         goto full;
+      aggregate_len = 0;
+
+      if (nal_len <= payload)
+      {
+         SLOT_T *slot = new_packet(rtp, &head, tail);
+
+         if (!slot)
+            goto full;
+         memcpy(slot->data + slot->length, nal, nal_len);
+         slot->length += nal_len;
+      }
+      else
+      {
+         // FU-A, the NAL header is split over the indicator and the FU header
+         int offset = 1;
+
+         while (offset < nal_len)
+         {
+            SLOT_T *slot = new_packet(rtp, &head, tail);
+            int chunk = nal_len - offset < payload - 2 ? nal_len - offset : payload - 2;
+            uint8_t *p;
+
+            if (!slot)
+               goto full;
+            p = slot->data + slot->length;
+            p[0] = (nal[0] & ~NAL_TYPE_MASK) | NAL_FU_A;
+            p[1] = nal[0] & NAL_TYPE_MASK;
+            if (offset == 1)
+               p[1] |= FU_START;
+            if (offset + chunk == nal_len)
+               p[1] |= FU_END;
+            memcpy(p + 2, nal + offset, chunk);
+            slot->length += 2 + chunk;
+            offset += chunk;
+         }
+      }
+   }
+
+   if (flush_aggregate(rtp, &head, tail, nals, lens, &count) != 0)
+      goto full;
+
+   if (head == start)
+      return 0;
+
+   last = &rtp->slots[(head - 1) % SLOT_COUNT];
+   last->data[1] |= 0x80;
+   last->marker = 1;
+   last->queued_us = vcos_getmicrosecs64();
+   last->pace_us = rtp->frame_us * rtp->pace_percent / 100;
+   if (last->pace_us > MAX_PACE_US)
+      last->pace_us = MAX_PACE_US;
+
+   vcos_mutex_lock(&rtp->lock);
+   rtp->head = head;
+   if ((int)(head - rtp->tail) > rtp->stats.high_water)
+      rtp->stats.high_water = (int)(head - rtp->tail);
+   rtp->stats.next_seq = rtp->seq;
+   vcos_mutex_unlock(&rtp->lock);
+
+   vcos_semaphore_post(&rtp->work);
+   return 0;
+
+full:
+   // Nothing was published, forget the packets of this access unit
+   rtp->seq = seq;
+   vcos_mutex_lock(&rtp->lock);
+   rtp->stats.dropped_frames++;
+   vcos_mutex_unlock(&rtp->lock);
+   return -1;
+}
+
+/**
+ * Queue encoder output. Data is collected until the end of an access
+ * unit, then packetized and sent by the sender thread. Called from the
+ * encoder callback.
+ *
+ * @param pts Capture timestamp in microseconds, negative if unknown
+ * @param flags RASPIRTP_FLAG_FRAME_END and RASPIRTP_FLAG_CONFIG
+ * @return 0 on success, -1 if data was dropped
+ */
+int raspirtp_send(RASPIRTP_T *rtp, const uint8_t *data, int length, int64_t pts, int flags)
+{
+   int result = 0;
+
+   if (rtp->frame_len + length > rtp->frame_size)
+   {
+      int size = rtp->frame_size;
+      uint8_t *frame;
+
+      while (size < rtp->frame_len + length && size < MAX_FRAME)
+         size *= 2;
+      frame = size >= rtp->frame_len + length ? realloc(rtp->frame, size) : NULL;
+      if (!frame)
+      {
+         vcos_log_error("access unit too large, dropped");
+         rtp->frame_len = 0;
+         vcos_mutex_lock(&rtp->lock);
+         rtp->stats.dropped_frames++;
+         vcos_mutex_unlock(&rtp->lock);
+         return -1;
+      }
+      rtp->frame = frame;
+      rtp->frame_size = size;
+   }
+
+   memcpy(rtp->frame + rtp->frame_len, data, length);
+   rtp->frame_len += length;
+
+   // Headers are sent in front of the access unit that follows them
+   if ((flags & RASPIRTP_FLAG_CONFIG) || !(flags & RASPIRTP_FLAG_FRAME_END))
+      return 0;
+
+   result = packetize(rtp, pts);
+   rtp->frame_len = 0;
+   return result;
+}
+
+/**
+ * Wait until everything queued has been sent
+ */
+void raspirtp_drain(RASPIRTP_T *rtp)
+{
+   while (1)
+   {
+      int empty;
+
+      vcos_mutex_lock(&rtp->lock);
+      empty = rtp->tail == rtp->head;
+      vcos_mutex_unlock(&rtp->lock);
+      if (empty)
+         break;
+      vcos_sleep(1);
+   }
+}
+
+static int base64_encode(const uint8_t *data, int length, char *out, int size)
+{
+   static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+   int i, n = 0;
+
+   if (size < (length + 2) / 3 * 4 + 1)
+      return -1;
+
+   for (i = 0; i < length; i += 3)
+   {
+      uint32_t v = data[i] << 16 | (i + 1 < length ? data[i + 1] << 8 : 0) | (i + 2 < length ? data[i + 2] : 0);
+
+      out[n++] = table[(v >> 18) & 0x3f];
+      out[n++] = table[(v >> 12) & 0x3f];
+      out[n++] = i + 1 < length ? table[(v >> 6) & 0x3f] : '=';
+      out[n++] = i + 2 < length ? table[v & 0x3f] : '=';
+   }
+   out[n] = 0;
+   return n;
+}
+
+/// sprop-parameter-sets value, from the last SPS and PPS sent
+static int sprop_parameter_sets(RASPIRTP_T *rtp, char *sprop, int size, char *profile)
+{
+   int n, result = -1;
+
+   vcos_mutex_lock(&rtp->lock);
+   if (rtp->sps_len >= 4 && rtp->pps_len)
+   {
+      n = base64_encode(rtp->sps, rtp->sps_len, sprop, size);
+      if (n >= 0 && n + 1 < size)
+      {
+         sprop[n++] = ',';
+         if (base64_encode(rtp->pps, rtp->pps_len, sprop + n, size - n) >= 0)
+            result = 0;
+      }
+      sprintf(profile, "%02x%02x%02x", rtp->sps[1], rtp->sps[2], rtp->sps[3]);
+   }
+   vcos_mutex_unlock(&rtp->lock);
+
+   return result;
+}
+
+/**
+ * URI to receive the stream with the containers RTP reader, for example
+ * with containers_rtp_decoder. Available once the headers have been sent.
+ *
+ * @return 0 on success, -1 if the headers have not been sent yet
+ */
+int raspirtp_get_uri(RASPIRTP_T *rtp, char *uri, int size)
+{
+   char sprop[400], profile[8];
+
+   if (sprop_parameter_sets(rtp, sprop, sizeof(sprop), profile) != 0)
+      return -1;
+
+   snprintf(uri, size, "rtp://:%s?rtppt=%d&mime-type=video/H264&sprop-parameter-sets=%s&ssrc=%08x",
+            rtp->port, RASPIRTP_PAYLOAD_TYPE, sprop, rtp->ssrc);
+   return 0;
+}
+
+/**
+ * Session description for players. Available once the headers have been sent.
+ *
+ * @return 0 on success, -1 if the headers have not been sent yet
+ */
+int raspirtp_get_sdp(RASPIRTP_T *rtp, char *sdp, int size)
+{
+   char sprop[400], profile[8];
+   const char *family = strchr(rtp->host, ':') ? "IP6" : "IP4";
+
+   if (sprop_parameter_sets(rtp, sprop, sizeof(sprop), profile) != 0)
+      return -1;
+
+   snprintf(sdp, size,
+            "v=0\r\n"
+            "o=- %u 0 IN %s %s\r\n"
+            "s=raspiballs\r\n"
+            "c=IN %s %s\r\n"
+            "t=0 0\r\n"
+            "m=video %s RTP/AVP %d\r\n"
+            "a=rtpmap:%d H264/90000\r\n"
+            "a=fmtp:%d packetization-mode=1;profile-level-id=%s;sprop-parameter-sets=%s\r\n",
+            rtp->ssrc, family, rtp->host, family, rtp->host, rtp->port, RASPIRTP_PAYLOAD_TYPE,
+            RASPIRTP_PAYLOAD_TYPE, RASPIRTP_PAYLOAD_TYPE, profile, sprop);
+   return 0;
+}
+
+void raspirtp_get_stats(RASPIRTP_T *rtp, RASPIRTP_STATS_T *stats)
+{
+   vcos_mutex_lock(&rtp->lock);
+   *stats = rtp->stats;
+   vcos_mutex_unlock(&rtp->lock);
+}
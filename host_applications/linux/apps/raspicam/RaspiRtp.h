@@ -0,0 +1,60 @@
+#ifndef RASPIRTP_H_
+#define RASPIRTP_H_
+
+#include <stdint.h>
+
+/**
+ * RTP sender for the H264 encoder output (RFC 6184, packetization mode 1).
+ *
+ * The encoder callback hands over Annex-B data as it comes. Each access
+ * unit is collected, split into NAL units and packetized: NAL units that
+ * fit are sent as they are or aggregated into STAP-A packets (SPS, PPS
+ * and SEI in front of a keyframe), larger ones are fragmented into FU-A
+ * packets. The packets go into a ring and return right away.
+ *
+ * A sender thread sends each access unit with sendmmsg, spread over part
+ * of the frame interval so a keyframe does not arrive as one burst that
+ * overflows the buffers of a switch or access point. When frames queue
+ * up the pacing is skipped to catch up, and when the ring is full whole
+ * access units are dropped rather than delaying the stream.
+ *
+ * The stream can be received with the containers RTP reader, using the
+ * URI from raspirtp_get_uri(), or with players through the SDP from
+ * raspirtp_get_sdp().
+ */
+typedef struct RASPIRTP_S RASPIRTP_T;
+
+/// Flags for raspirtp_send, matching the encoder buffer flags
+#define RASPIRTP_FLAG_FRAME_END  1  /// Last data of an access unit
+#define RASPIRTP_FLAG_CONFIG     2  /// SPS/PPS headers, sent with the next access unit
+
+#define RASPIRTP_DEFAULT_MTU     1500
+#define RASPIRTP_PAYLOAD_TYPE    96
+
+typedef struct
+{
+   uint64_t frames;                 /// Access units sent
+   uint64_t packets;                /// RTP packets sent
+   uint64_t bytes;                  /// RTP bytes sent, without IP and UDP headers
+   uint64_t send_calls;             /// sendmmsg calls
+   uint32_t stap_packets;           /// STAP-A packets among them
+   uint32_t fu_packets;             /// FU-A packets among them
+   uint32_t dropped_frames;         /// Access units dropped because the ring was full
+   uint32_t send_errors;            /// Packets the socket refused
+   int high_water;                  /// Most packets waiting in the ring
+   uint32_t max_frame_us;           /// Longest time from queueing an access unit to sending its last packet
+   uint16_t next_seq;               /// Sequence number of the next packet
+} RASPIRTP_STATS_T;
+
+RASPIRTP_T *raspirtp_create(const char *host, const char *port, int mtu);
+void raspirtp_destroy(RASPIRTP_T *rtp);
+
+void raspirtp_set_pacing(RASPIRTP_T *rtp, int pace_percent);
+int raspirtp_send(RASPIRTP_T *rtp, const uint8_t *data, int length, int64_t pts, int flags);
+void raspirtp_drain(RASPIRTP_T *rtp);
+
+int raspirtp_get_uri(RASPIRTP_T *rtp, char *uri, int size);
+int raspirtp_get_sdp(RASPIRTP_T *rtp, char *sdp, int size);
+void raspirtp_get_stats(RASPIRTP_T *rtp, RASPIRTP_STATS_T *stats);
+
+#endif
@@ -1998,7 +1998,7 @@ int main(int argc, const char **argv)
                }
                else if (output_file)
                {
-                  int num, q;
+                  MMAL_BUFFER_HEADER_T *buffers;
 
                   // Must do this before the encoder output port is enabled since
                   // once enabled no further exif data is accepted
@@ -2037,17 +2037,15 @@ int main(int argc, const char **argv)
                   status = mmal_port_enable(encoder_output_port, encoder_buffer_callback);
 
                   // Send all the buffers to the encoder output port
-                  num = mmal_queue_length(state.encoder_pool->queue);
+                  buffers = mmal_queue_get_batch(state.encoder_pool->queue, 0);
 
-                  for (q=0;q<num;q++)
-                  {
-                     MMAL_BUFFER_HEADER_T *buffer = mmal_queue_get(state.encoder_pool->queue);
-
-                     if (!buffer)
-                        vcos_log_error("Unable to get a required buffer %d from pool queue", q);
+                  if (!buffers)
+                     vcos_log_error("Unable to get the buffers from pool queue");
 
-                     if (mmal_port_send_buffer(encoder_output_port, buffer)!= MMAL_SUCCESS)
-                        vcos_log_error("Unable to send a buffer to encoder output port (%d)", q);
+                  if (mmal_port_send_buffers(encoder_output_port, &buffers) != MMAL_SUCCESS)
+                  {
+                     vcos_log_error("Unable to send the buffers to encoder output port");
+                     mmal_queue_put_batch(state.encoder_pool->queue, buffers);
                   }
 
                   if (state.burstCaptureMode && frame==1)
@@ -1355,7 +1355,7 @@ int main(int argc, const char **argv)
 
             if (output_file)
             {
-               int num, q;
+               MMAL_BUFFER_HEADER_T *buffers;
 
                // There is a possibility that shutter needs to be set each loop.
                if (mmal_status_to_int(mmal_port_parameter_set_uint32(state.camera_component->control, MMAL_PARAMETER_SHUTTER_SPEED, state.camera_parameters.shutter_speed) != MMAL_SUCCESS))
@@ -1363,17 +1363,15 @@ int main(int argc, const char **argv)
 
 
                // Send all the buffers to the camera output port
-               num = mmal_queue_length(state.camera_pool->queue);
+               buffers = mmal_queue_get_batch(state.camera_pool->queue, 0);
 
-               for (q=0;q<num;q++)
-               {
-                  MMAL_BUFFER_HEADER_T *buffer = mmal_queue_get(state.camera_pool->queue);
-
-                  if (!buffer)
-                     vcos_log_error("Unable to get a required buffer %d from pool queue", q);
+               if (!buffers)
+                  vcos_log_error("Unable to get the buffers from pool queue");
 
-                  if (mmal_port_send_buffer(camera_still_port, buffer)!= MMAL_SUCCESS)
-                     vcos_log_error("Unable to send a buffer to camera output port (%d)", q);
+               if (mmal_port_send_buffers(camera_still_port, &buffers) != MMAL_SUCCESS)
+               {
+                  vcos_log_error("Unable to send the buffers to camera output port");
+                  mmal_queue_put_batch(state.camera_pool->queue, buffers);
                }
 
                if (state.burstCaptureMode && frame==1)
@@ -418,7 +418,7 @@ static void *preview_worker(void *arg)
 {
    RASPITEX_STATE* state = arg;
    MMAL_PORT_T *preview_port = state->preview_port;
-   MMAL_BUFFER_HEADER_T *buf;
+   MMAL_BUFFER_HEADER_T *buf, *bufs;
    MMAL_STATUS_T st;
    int rc;
 
@@ -435,13 +435,12 @@ static void *preview_worker(void *arg)
    while (state->preview_stop == 0)
    {
       /* Send empty buffers to camera preview port */
-      while ((buf = mmal_queue_get(state->preview_pool->queue)) != NULL)
+      bufs = mmal_queue_get_batch(state->preview_pool->queue, 0);
+      st = mmal_port_send_buffers(preview_port, &bufs);
+      if (st != MMAL_SUCCESS)
       {
-         st = mmal_port_send_buffer(preview_port, buf);
-         if (st != MMAL_SUCCESS)
-         {
-            vcos_log_error("Failed to send buffer to %s", preview_port->name);
-         }
+         vcos_log_error("Failed to send buffer to %s", preview_port->name);
+         mmal_queue_put_batch(state->preview_pool->queue, bufs);
       }
       /* Process returned buffers */
       if (preview_process_returned_bufs(state) != 0)
@@ -453,8 +452,11 @@ static void *preview_worker(void *arg)
 
 end:
    /* Make sure all buffers are returned on exit */
-   while ((buf = mmal_queue_get(state->preview_queue)) != NULL)
-      mmal_buffer_header_release(buf);
+   for (bufs = mmal_queue_get_batch(state->preview_queue, 0); bufs; bufs = buf)
+   {
+      buf = bufs->next;
+      mmal_buffer_header_release(bufs);
+   }
 
    /* Tear down GL */
    state->ops.gl_term(state);
@@ -548,8 +550,9 @@ int raspitex_configure_preview_port(RASPITEX_STATE *state,
       goto end;
    }
 
-   /* Place filled buffers from the preview port in a queue to render */
-   state->preview_queue = mmal_queue_create();
+   /* Place filled buffers from the preview port in a queue to render. Only
+    * the preview worker takes them out, so the queue needs no lock. */
+   state->preview_queue = mmal_queue_create_with_type(MMAL_QUEUE_TYPE_MPSC);
    if (! state->preview_queue)
    {
       vcos_log_error("Error allocating queue");
@@ -0,0 +1,492 @@
+/**
+ * \file RaspiTrackerState.c
+ * Tracker state in a POSIX shared memory segment, see RaspiTrackerState.h
+ *
+ * Both the latest record and the ring slots are seqlocks. The writer marks
+ * a slot as being written, fills it and then stores its frame number; a
+ * reader copies a slot and only keeps the copy if the frame number it
+ * wanted was there both before and after. The writer never looks at the
+ * readers apart from the waiters count.
+ *
+ * The segment is created 0644 and readers map it read-only, so only the
+ * writer can change the records. The waiters count is the only thing
+ * readers write, it has a segment of its own that any local reader can
+ * write to.
+ *
+ * This file does not use vcos, so readers only need libc.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <linux/futex.h>
+
+#include "RaspiTrackerState.h"
+
+/// Attempts to read the latest record while the writer is in the middle of it
+#define LATEST_RETRIES 100000
+
+struct RASPISTATE_S
+{
+   RASPISTATE_HEADER_T *header;
+   RASPISTATE_RECORD_T *ring;
+   uint32_t *waiters;               /// Readers sleeping on the futex, in the waiters segment
+   size_t size;
+   uint32_t mask;
+   int writer;                      /// Nonzero for the writer, which unlinks the segment
+   char name[64];
+};
+
+static int futex(uint32_t *addr, int op, uint32_t value, const struct timespec *timeout)
+{
+   return syscall(SYS_futex, addr, op, value, timeout, NULL, 0);
+}
+
+static size_t segment_size(void)
+{
+   return sizeof(RASPISTATE_HEADER_T) + RASPISTATE_RING_SIZE * sizeof(RASPISTATE_RECORD_T);
+}
+
+static void waiters_name(const char *name, char *buffer, size_t size)
+{
+   snprintf(buffer, size, "%s%s", name, RASPISTATE_WAITERS_SUFFIX);
+}
+
+/**
+ * Map the waiters segment of a state segment, creating it for the writer.
+ *
+ * @return The waiters count, or NULL with errno set
+ */
+static uint32_t *waiters_map(const char *name, int create)
+{
+   char path[sizeof(((RASPISTATE_T *)0)->name) + sizeof(RASPISTATE_WAITERS_SUFFIX)];
+   void *map;
+   int fd;
+
+   waiters_name(name, path, sizeof(path));
+   if (create)
+   {
+      shm_unlink(path);
+      fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0666);
+      // Not limited by the umask, readers of other users count themselves too
+      if (fd >= 0 && (fchmod(fd, 0666) < 0 || ftruncate(fd, sizeof(uint32_t)) < 0))
+      {
+         close(fd);
+         shm_unlink(path);
+         return NULL;
+      }
+   }
+   else
+   {
+      fd = shm_open(path, O_RDWR, 0);
+   }
+   if (fd < 0)
+      return NULL;
+
+   map = mmap(NULL, sizeof(uint32_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED)
+   {
+      if (create)
+         shm_unlink(path);
+      return NULL;
+   }
+   return (uint32_t *)map;
+}
+
+static void waiters_unlink(const char *name)
+{
+   char path[sizeof(((RASPISTATE_T *)0)->name) + sizeof(RASPISTATE_WAITERS_SUFFIX)];
+
+   waiters_name(name, path, sizeof(path));
+   shm_unlink(path);
+}
+
+/**
+ * Map a state segment and its waiters segment. The writer maps the segment
+ * read-write, readers map it read-only.
+ *
+ * @param writable Nonzero to map the segment read-write
+ * @param create Nonzero for a new segment, its waiters segment is created too
+ */
+static RASPISTATE_T *state_map(const char *name, int fd, int writable, int create)
+{
+   RASPISTATE_T *state;
+   struct stat st;
+   void *map;
+
+   if (fstat(fd, &st) < 0)
+      return NULL;
+
+   if (!create && (size_t)st.st_size < sizeof(RASPISTATE_HEADER_T))
+   {
+      errno = EINVAL;
+      return NULL;
+   }
+
+   state = calloc(1, sizeof(*state));
+   if (!state)
+      return NULL;
+
+   state->size = create ? segment_size() : (size_t)st.st_size;
+   map = mmap(NULL, state->size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+   if (map == MAP_FAILED)
+   {
+      free(state);
+      return NULL;
+   }
+
+   state->waiters = waiters_map(name, create);
+   if (!state->waiters)
+   {
+      munmap(map, state->size);
+      free(state);
+      return NULL;
+   }
+
+   state->header = (RASPISTATE_HEADER_T *)map;
+   state->writer = create;
+   strncpy(state->name, name, sizeof(state->name) - 1);
+   return state;
+}
+
+static void state_unmap(RASPISTATE_T *state)
+{
+   munmap(state->waiters, sizeof(uint32_t));
+   munmap(state->header, state->size);
+   free(state);
+}
+
+static void wake_readers(RASPISTATE_T *state)
+{
+   RASPISTATE_HEADER_T *header = state->header;
+
+   __atomic_store_n(&header->futex, header->futex + 1, __ATOMIC_SEQ_CST);
+   if (__atomic_load_n(state->waiters, __ATOMIC_SEQ_CST))
+      futex(&header->futex, FUTEX_WAKE, INT_MAX, NULL);
+}
+
+/**
+ * Open an existing segment and check its header. Only the writer maps it
+ * read-write, to close a segment left by an earlier run.
+ */
+static RASPISTATE_T *state_open(const char *name, int writer)
+{
+   RASPISTATE_T *state;
+   RASPISTATE_HEADER_T *header;
+   int fd;
+
+   fd = shm_open(name, writer ? O_RDWR : O_RDONLY, 0);
+   if (fd < 0)
+      return NULL;
+
+   state = state_map(name, fd, writer, 0);
+   close(fd);
+   if (!state)
+      return NULL;
+
+   header = state->header;
+   if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != RASPISTATE_MAGIC ||
+       header->version != RASPISTATE_VERSION ||
+       header->header_size != sizeof(RASPISTATE_HEADER_T) ||
+       header->record_size != sizeof(RASPISTATE_RECORD_T) ||
+       !header->ring_size || (header->ring_size & (header->ring_size - 1)) ||
+       state->size < header->header_size + (size_t)header->ring_size * header->record_size)
+   {
+      state_unmap(state);
+      errno = EINVAL;
+      return NULL;
+   }
+
+   state->ring = (RASPISTATE_RECORD_T *)(header + 1);
+   state->mask = header->ring_size - 1;
+   return state;
+}
+
+/**
+ * Create the segment, replacing one left by an earlier run. Fails with
+ * EBUSY if the writer of the existing segment is still running.
+ *
+ * @param name Name of the segment, starting with a slash
+ * @return The writer, or NULL with errno set
+ */
+RASPISTATE_T *raspistate_create(const char *name)
+{
+   RASPISTATE_T *state;
+   RASPISTATE_HEADER_T *header;
+   int fd;
+
+   // Read-write, it was left by an earlier writer of the same user
+   state = state_open(name, 1);
+   if (state)
+   {
+      // Readers of the old segment keep their mapping, tell them it is done
+      if (!raspistate_closed(state))
+      {
+         raspistate_close(state);
+         errno = EBUSY;
+         return NULL;
+      }
+      __atomic_store_n(&state->header->closed, 1, __ATOMIC_SEQ_CST);
+      wake_readers(state);
+      raspistate_close(state);
+   }
+   shm_unlink(name);
+
+   fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+   if (fd < 0)
+      return NULL;
+
+   if (ftruncate(fd, segment_size()) < 0)
+   {
+      close(fd);
+      shm_unlink(name);
+      return NULL;
+   }
+
+   state = state_map(name, fd, 1, 1);
+   close(fd);
+   if (!state)
+   {
+      shm_unlink(name);
+      waiters_unlink(name);
+      return NULL;
+   }
+
+   header = state->header;
+   header->version = RASPISTATE_VERSION;
+   header->header_size = sizeof(RASPISTATE_HEADER_T);
+   header->record_size = sizeof(RASPISTATE_RECORD_T);
+   header->ring_size = RASPISTATE_RING_SIZE;
+   header->pid = getpid();
+   state->ring = (RASPISTATE_RECORD_T *)(header + 1);
+   state->mask = RASPISTATE_RING_SIZE - 1;
+   __atomic_store_n(&header->magic, RASPISTATE_MAGIC, __ATOMIC_RELEASE);
+
+   return state;
+}
+
+/**
+ * Publish the record of the next frame, to the latest record and the ring.
+ * Makes no system call unless a reader is sleeping in raspistate_wait.
+ *
+ * @param state The writer
+ * @param record The record, its frame number is filled in here
+ */
+void raspistate_publish(RASPISTATE_T *state, const RASPISTATE_RECORD_T *record)
+{
+   RASPISTATE_HEADER_T *header = state->header;
+   RASPISTATE_RECORD_T *slot;
+   RASPISTATE_RECORD_T copy = *record;
+   uint32_t frame = header->head + 1;
+   uint32_t seq = header->seq;
+
+   // The slot still holds frame - RASPISTATE_RING_SIZE, mark it as in flux first
+   slot = &state->ring[frame & state->mask];
+   __atomic_store_n(&slot->frame, 0, __ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+   copy.frame = 0;
+   memcpy(slot, &copy, sizeof(copy));
+   __atomic_store_n(&slot->frame, frame, __ATOMIC_RELEASE);
+
+   __atomic_store_n(&header->seq, seq + 1, __ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+   copy.frame = frame;
+   memcpy(&header->latest, &copy, sizeof(copy));
+   __atomic_store_n(&header->seq, seq + 2, __ATOMIC_RELEASE);
+
+   __atomic_store_n(&header->head, frame, __ATOMIC_RELEASE);
+   wake_readers(state);
+}
+
+/**
+ * Mark the segment as closed, wake all readers and remove the segment.
+ * Readers keep their mapping until they close it.
+ */
+void raspistate_destroy(RASPISTATE_T *state)
+{
+   if (!state)
+      return;
+
+   __atomic_store_n(&state->header->closed, 1, __ATOMIC_SEQ_CST);
+   wake_readers(state);
+   shm_unlink(state->name);
+   waiters_unlink(state->name);
+   state_unmap(state);
+}
+
+/**
+ * Open the segment for reading.
+ *
+ * @param name Name of the segment, starting with a slash
+ * @return The reader, or NULL with errno set if there is no valid segment
+ */
+RASPISTATE_T *raspistate_open(const char *name)
+{
+   return state_open(name, 0);
+}
+
+void raspistate_close(RASPISTATE_T *state)
+{
+   if (state)
+      state_unmap(state);
+}
+
+/**
+ * Copy the latest record.
+ *
+ * @return 1 if there is one, 0 if no frame was published yet, -1 if the
+ *         writer stopped in the middle of publishing
+ */
+int raspistate_latest(RASPISTATE_T *state, RASPISTATE_RECORD_T *record)
+{
+   RASPISTATE_HEADER_T *header = state->header;
+   int i;
+
+   for (i = 0; i < LATEST_RETRIES; i++)
+   {
+      uint32_t seq = __atomic_load_n(&header->seq, __ATOMIC_ACQUIRE);
+
+      if (seq & 1)
+      {
+         sched_yield();
+         continue;
+      }
+
+      memcpy(record, &header->latest, sizeof(*record));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&header->seq, __ATOMIC_RELAXED) == seq)
+         return record->frame != 0;
+   }
+
+   return -1;
+}
+
+/**
+ * Copy records from the ring, oldest first. Records that were overwritten
+ * before they were read are skipped, which shows as a gap in the frame
+ * numbers.
+ *
+ * @param state The reader
+ * @param next The frame to start at, 0 for the oldest one in the ring.
+ *             Set to the frame after the last one read.
+ * @param records Where to copy the records to
+ * @param max Size of records
+ * @return Number of records copied
+ */
+int raspistate_read(RASPISTATE_T *state, uint32_t *next, RASPISTATE_RECORD_T *records, int max)
+{
+   RASPISTATE_HEADER_T *header = state->header;
+   // The slot after head may be in flux, so only ring_size - 1 frames are readable
+   uint32_t window = state->mask;
+   uint32_t head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+   uint32_t frame = *next;
+   int count = 0;
+
+   if (!frame)
+      frame = head > window ? head - window + 1 : 1;
+
+   while (count < max && (int32_t)(head - frame) >= 0)
+   {
+      RASPISTATE_RECORD_T *slot;
+
+      if (head - frame >= window)
+         frame = head - window + 1;
+
+      slot = &state->ring[frame & state->mask];
+      if (__atomic_load_n(&slot->frame, __ATOMIC_ACQUIRE) == frame)
+      {
+         memcpy(&records[count], slot, sizeof(*slot));
+         __atomic_thread_fence(__ATOMIC_ACQUIRE);
+         if (__atomic_load_n(&slot->frame, __ATOMIC_RELAXED) == frame)
+         {
+            records[count++].frame = frame;
+            frame++;
+            continue;
+         }
+      }
+
+      // Overwritten while we were looking, catch up with the writer
+      head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+   }
+
+   *next = frame;
+   return count;
+}
+
+/**
+ * Sleep until a frame after the given one is published.
+ *
+ * @param state The reader
+ * @param frame The last frame seen, usually from raspistate_latest or the
+ *              next frame of raspistate_read minus one
+ * @param timeout_ms Longest time to wait, negative to wait forever
+ * @return 1 if there is a newer frame, 0 on timeout, -1 if the writer has gone
+ */
+int raspistate_wait(RASPISTATE_T *state, uint32_t frame, int timeout_ms)
+{
+   RASPISTATE_HEADER_T *header = state->header;
+   struct timespec deadline, now, remaining;
+
+   clock_gettime(CLOCK_MONOTONIC, &deadline);
+   deadline.tv_sec += timeout_ms / 1000;
+   deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+   if (deadline.tv_nsec >= 1000000000L)
+   {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+   }
+
+   for (;;)
+   {
+      uint32_t value = __atomic_load_n(&header->futex, __ATOMIC_SEQ_CST);
+
+      if ((int32_t)(__atomic_load_n(&header->head, __ATOMIC_ACQUIRE) - frame) > 0)
+         return 1;
+      if (__atomic_load_n(&header->closed, __ATOMIC_ACQUIRE))
+         return -1;
+
+      if (timeout_ms >= 0)
+      {
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         remaining.tv_sec = deadline.tv_sec - now.tv_sec;
+         remaining.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+         if (remaining.tv_nsec < 0)
+         {
+            remaining.tv_sec--;
+            remaining.tv_nsec += 1000000000L;
+         }
+         if (remaining.tv_sec < 0)
+            return raspistate_closed(state) ? -1 : 0;
+      }
+
+      // A publish after value was read changes the futex, so the wait returns at once
+      __atomic_add_fetch(state->waiters, 1, __ATOMIC_SEQ_CST);
+      futex(&header->futex, FUTEX_WAIT, value, timeout_ms >= 0 ? &remaining : NULL);
+      __atomic_sub_fetch(state->waiters, 1, __ATOMIC_SEQ_CST);
+   }
+}
+
+/**
+ * @return Nonzero if the writer closed the segment or is no longer running
+ */
+int raspistate_closed(RASPISTATE_T *state)
+{
+   RASPISTATE_HEADER_T *header = state->header;
+
+   if (__atomic_load_n(&header->closed, __ATOMIC_ACQUIRE))
+      return 1;
+
+   return kill((pid_t)header->pid, 0) < 0 && errno == ESRCH;
+}
@@ -0,0 +1,88 @@
+#ifndef RASPITRACKERSTATE_H_
+#define RASPITRACKERSTATE_H_
+
+#include <stdint.h>
+
+/**
+ * Tracker state in a POSIX shared memory segment, for any number of local
+ * readers next to raspiballs.
+ *
+ * The segment holds a header, the latest record behind a seqlock and a
+ * ring of the last RASPISTATE_RING_SIZE per-frame records. There is one
+ * writer, which never blocks and never waits for readers: publishing a
+ * frame is a few stores into the mapping. Readers that fall behind lose
+ * the oldest records, which they see as a gap in the frame numbers.
+ *
+ * Readers can also sleep on a futex in the header until the next frame
+ * instead of polling. Sleeping readers announce themselves in a second,
+ * writable segment of the same name with RASPISTATE_WAITERS_SUFFIX, the
+ * writer only makes the wake up system call while there is one. Everything
+ * else is only writable by the writer; readers map it read-only.
+ *
+ * Link with libraspiballstate to read the segment, see raspiballstate for
+ * an example.
+ */
+
+#define RASPISTATE_MAGIC        0x53544252   /// "RBTS"
+#define RASPISTATE_VERSION      2
+#define RASPISTATE_DEFAULT_NAME "/raspiballs"
+#define RASPISTATE_RING_SIZE    1024         /// Must be a power of two
+#define RASPISTATE_WAITERS_SUFFIX ".waiters" /// Segment with the count of sleeping readers
+
+/// Bits in RASPISTATE_RECORD_T events
+#define RASPISTATE_EVENT_GOAL_RED   (1 << 0)
+#define RASPISTATE_EVENT_GOAL_BLUE  (1 << 1)
+#define RASPISTATE_EVENT_SAVE       (1 << 2)
+#define RASPISTATE_EVENT_SHOT       (1 << 3)
+
+typedef struct
+{
+   uint32_t frame;                  /// Frame number from 1, wraps after 2^32 frames
+   uint32_t events;                 /// RASPISTATE_EVENT_* bits of the events on this frame
+   int64_t pts;                     /// Camera timestamp of the frame
+   int64_t time;                    /// Wall clock time of the record, microseconds since the epoch
+   float x;                         /// Ball position in [-1,1], the last known one if not found
+   float y;
+   uint32_t found;                  /// Nonzero if the ball was found on this frame
+   uint32_t goals[2];               /// Goals of red and blue so far
+   uint32_t saves;                  /// Saves so far
+   uint32_t shots;                  /// Shots on goal so far
+   float speed;                     /// Speed of the last shot in field widths per frame
+   uint32_t reserved[2];            /// Pads the record to 64 bytes
+} RASPISTATE_RECORD_T;
+
+typedef struct
+{
+   uint32_t magic;                  /// Written last, after the rest of the segment is set up
+   uint32_t version;
+   uint32_t header_size;            /// Bytes before the ring
+   uint32_t record_size;
+   uint32_t ring_size;              /// Records in the ring
+   uint32_t pid;                    /// Process id of the writer
+   uint32_t closed;                 /// Set when the writer has gone
+   uint32_t reserved0[9];
+   uint32_t head;                   /// Records published, the last one is frame head
+   uint32_t futex;                  /// Bumped after every publish and on close, readers sleep on it
+   uint32_t reserved1[14];          /// Keeps head in a cache line of its own
+   uint32_t seq;                    /// Seqlock of latest, odd while it is written
+   uint32_t reserved2[15];
+   RASPISTATE_RECORD_T latest;
+} RASPISTATE_HEADER_T;
+
+typedef struct RASPISTATE_S RASPISTATE_T;
+
+/// Writer side, used by raspiballs
+RASPISTATE_T *raspistate_create(const char *name);
+void raspistate_publish(RASPISTATE_T *state, const RASPISTATE_RECORD_T *record);
+void raspistate_destroy(RASPISTATE_T *state);
+
+/// Reader side
+RASPISTATE_T *raspistate_open(const char *name);
+void raspistate_close(RASPISTATE_T *state);
+
+int raspistate_latest(RASPISTATE_T *state, RASPISTATE_RECORD_T *record);
+int raspistate_read(RASPISTATE_T *state, uint32_t *next, RASPISTATE_RECORD_T *records, int max);
+int raspistate_wait(RASPISTATE_T *state, uint32_t frame, int timeout_ms);
+int raspistate_closed(RASPISTATE_T *state);
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * \file RaspiTrackerStateQuery.c
+ * Command line reader of the tracker state published by raspiballs -state,
+ * see RaspiTrackerState.h
+ *
+ * Usage:
+ *   raspiballstate [name]       Print the latest record
+ *   raspiballstate ring [name]  Print all records in the ring
+ *   raspiballstate follow [name] Print every frame as it is published, until raspiballs stops
+ *
+ * The name defaults to RASPISTATE_DEFAULT_NAME.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "RaspiTrackerState.h"
+
+/// Records copied from the ring at a time
+#define READ_BATCH 64
+
+static void print_record(const RASPISTATE_RECORD_T *record)
+{
+   printf("frame %u at %lld.%03lld s: ball %s %.3f %.3f, goals %u-%u, saves %u, shots %u",
+          record->frame, (long long)(record->pts / 1000000), (long long)(record->pts / 1000 % 1000),
+          record->found ? "at" : "lost, last at", record->x, record->y,
+          record->goals[0], record->goals[1], record->saves, record->shots);
+   if (record->events & RASPISTATE_EVENT_GOAL_RED)
+      printf(", red goal");
+   if (record->events & RASPISTATE_EVENT_GOAL_BLUE)
+      printf(", blue goal");
+   if (record->events & RASPISTATE_EVENT_SAVE)
+      printf(", save");
+   if (record->events & RASPISTATE_EVENT_SHOT)
+      printf(", shot at speed %.3f", record->speed);
+   printf("\n");
+}
+
+static void usage(const char *name)
+{
+   fprintf(stderr, "Usage:\n"
+           "  %s [name]         Print the latest record\n"
+           "  %s ring [name]    Print all records in the ring\n"
+           "  %s follow [name]  Print every frame as it is published\n"
+           "The name defaults to %s.\n", name, name, name, RASPISTATE_DEFAULT_NAME);
+}
+
+int main(int argc, char **argv)
+{
+   RASPISTATE_T *state;
+   RASPISTATE_RECORD_T records[READ_BATCH];
+   const char *command = NULL, *name = RASPISTATE_DEFAULT_NAME;
+   uint32_t next = 0;
+   int i, n, result = 0;
+
+   if (argc > 1 && (!strcmp(argv[1], "ring") || !strcmp(argv[1], "follow")))
+      command = argv[1];
+   if (argc > (command ? 3 : 2) || (argc > 1 && argv[1][0] == '-'))
+   {
+      usage(argv[0]);
+      return 1;
+   }
+   if (argc > (command ? 2 : 1))
+      name = argv[argc - 1];
+
+   state = raspistate_open(name);
+   if (!state)
+   {
+      fprintf(stderr, "Unable to open tracker state %s: %s\n", name, strerror(errno));
+      return 1;
+   }
+
+   if (!command)
+   {
+      n = raspistate_latest(state, records);
+      if (n > 0)
+         print_record(records);
+      else
+         fprintf(stderr, n ? "Tracker state is inconsistent\n" : "No frames yet\n");
+      result = n > 0 ? 0 : 2;
+   }
+   else if (!strcmp(command, "ring"))
+   {
+      while ((n = raspistate_read(state, &next, records, READ_BATCH)) > 0)
+         for (i = 0; i < n; i++)
+            print_record(&records[i]);
+   }
+   else
+   {
+      uint32_t last;
+
+      // Start at the newest frame
+      if (raspistate_latest(state, records) > 0)
+         next = records[0].frame;
+      last = next ? next - 1 : 0;
+
+      for (;;)
+      {
+         n = raspistate_read(state, &next, records, READ_BATCH);
+         for (i = 0; i < n; i++)
+         {
+            if (last && records[i].frame != last + 1)
+               printf("(%u frames lost)\n", records[i].frame - last - 1);
+            last = records[i].frame;
+            print_record(&records[i]);
+         }
+         fflush(stdout);
+
+         if (raspistate_wait(state, next - 1, 1000) < 0)
+            break;
+      }
+   }
+
+   raspistate_close(state);
+   return result;
+}
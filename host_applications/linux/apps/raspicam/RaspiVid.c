@@ -2867,33 +2867,30 @@ int main(int argc, const char **argv)
 
                // Send all the buffers to the encoder output port
                {
-                  int num = mmal_queue_length(state.encoder_pool->queue);
-                  int q;
-                  for (q=0;q<num;q++)
-                  {
-                     MMAL_BUFFER_HEADER_T *buffer = mmal_queue_get(state.encoder_pool->queue);
+                  MMAL_BUFFER_HEADER_T *buffers = mmal_queue_get_batch(state.encoder_pool->queue, 0);
 
-                     if (!buffer)
-                        vcos_log_error("Unable to get a required buffer %d from pool queue", q);
+                  if (!buffers)
+                     vcos_log_error("Unable to get the buffers from pool queue");
 
-                     if (mmal_port_send_buffer(encoder_output_port, buffer)!= MMAL_SUCCESS)
-                        vcos_log_error("Unable to send a buffer to encoder output port (%d)", q);
+                  if (mmal_port_send_buffers(encoder_output_port, &buffers) != MMAL_SUCCESS)
+                  {
+                     vcos_log_error("Unable to send the buffers to encoder output port");
+                     mmal_queue_put_batch(state.encoder_pool->queue, buffers);
                   }
                }
 
                // Send all the buffers to the splitter output port
-               if (state.raw_output) {
-                  int num = mmal_queue_length(state.splitter_pool->queue);
-                  int q;
-                  for (q = 0; q < num; q++)
-                  {
-                     MMAL_BUFFER_HEADER_T *buffer = mmal_queue_get(state.splitter_pool->queue);
+               if (state.raw_output)
+               {
+                  MMAL_BUFFER_HEADER_T *buffers = mmal_queue_get_batch(state.splitter_pool->queue, 0);
 
-                     if (!buffer)
-                        vcos_log_error("Unable to get a required buffer %d from pool queue", q);
+                  if (!buffers)
+                     vcos_log_error("Unable to get the buffers from pool queue");
 
-                     if (mmal_port_send_buffer(splitter_output_port, buffer)!= MMAL_SUCCESS)
-                        vcos_log_error("Unable to send a buffer to splitter output port (%d)", q);
+                  if (mmal_port_send_buffers(splitter_output_port, &buffers) != MMAL_SUCCESS)
+                  {
+                     vcos_log_error("Unable to send the buffers to splitter output port");
+                     mmal_queue_put_batch(state.splitter_pool->queue, buffers);
                   }
                }
 
@@ -1559,17 +1559,15 @@ int main(int argc, const char **argv)
 
                // Send all the buffers to the camera video port
                {
-                  int num = mmal_queue_length(state.camera_pool->queue);
-                  int q;
-                  for (q=0;q<num;q++)
-                  {
-                     MMAL_BUFFER_HEADER_T *buffer = mmal_queue_get(state.camera_pool->queue);
+                  MMAL_BUFFER_HEADER_T *buffers = mmal_queue_get_batch(state.camera_pool->queue, 0);
 
-                     if (!buffer)
-                        vcos_log_error("Unable to get a required buffer %d from pool queue", q);
+                  if (!buffers)
+                     vcos_log_error("Unable to get the buffers from pool queue");
 
-                     if (mmal_port_send_buffer(camera_video_port, buffer)!= MMAL_SUCCESS)
-                        vcos_log_error("Unable to send a buffer to camera video port (%d)", q);
+                  if (mmal_port_send_buffers(camera_video_port, &buffers) != MMAL_SUCCESS)
+                  {
+                     vcos_log_error("Unable to send the buffers to camera video port");
+                     mmal_queue_put_batch(state.camera_pool->queue, buffers);
                   }
                }
 
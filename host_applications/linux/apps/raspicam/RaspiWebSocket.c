@@ -0,0 +1,922 @@
+/**
+ * \file RaspiWebSocket.c
+ * WebSocket server for tracker events, see RaspiWebSocket.h
+ *
+ * Only what the foosball clients need of RFC 6455 is implemented: the
+ * opening handshake, unfragmented text messages, ping and close. Each
+ * client has an input buffer for partial requests and frames, and an
+ * output buffer that only fills up when the socket would block.
+ */
+
+// accept4 and strcasestr need GNU extensions
+#ifndef _GNU_SOURCE
+   #define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "interface/vcos/vcos.h"
+
+#include "RaspiWebSocket.h"
+
+static VCOS_LOG_CAT_T raspiws_log_category;
+#define VCOS_LOG_CATEGORY (&raspiws_log_category)
+
+/// Events waiting for the server thread
+#define EVENT_SLOTS 256
+
+/// Longest event text
+#define EVENT_SIZE 128
+
+#define MAX_CLIENTS 64
+
+/// Longest handshake request or client frame
+#define INPUT_SIZE 4096
+
+/// Output a client may fall behind by before it is dropped
+#define OUTPUT_LIMIT (64 * 1024)
+
+/// Interval for the heartbeat check when idle
+#define POLL_MS 250
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+#define OPCODE_TEXT  0x1
+#define OPCODE_CLOSE 0x8
+#define OPCODE_PING  0x9
+#define OPCODE_PONG  0xa
+
+/// epoll data of the listening socket and the eventfd, clients are 2 + slot
+#define KEY_LISTEN 0
+#define KEY_EVENT  1
+
+typedef struct
+{
+   int64_t time_us;                 /// Time the event was posted
+   int length;
+   char text[EVENT_SIZE];
+} EVENT_T;
+
+typedef struct
+{
+   int fd;                          /// -1 once closed, the slot is freed after the epoll batch
+   int open;                        /// Handshake completed
+   int closing;                     /// Close once the output is written
+   int want_write;                  /// Registered for EPOLLOUT
+   int input_len;
+   uint8_t input[INPUT_SIZE + 1];
+   uint8_t *output;
+   int output_len;
+   int output_size;
+} CLIENT_T;
+
+struct RASPIWS_S
+{
+   VCOS_MUTEX_T lock;
+   VCOS_THREAD_T thread;
+   int listen_fd;
+   int epoll_fd;
+   int event_fd;
+   int port;
+   int heartbeat_ms;
+   RASPIWS_COMMAND_FN command_fn;
+   void *userdata;
+
+   // Protected by the lock
+   EVENT_T events[EVENT_SLOTS];
+   uint32_t head;                   /// Next event to post
+   uint32_t tail;                   /// Next event to broadcast
+   int running;
+   RASPIWS_STATS_T stats;
+
+   // Server thread only
+   CLIENT_T *clients[MAX_CLIENTS];
+   int64_t last_heartbeat_us;       /// -1 until the first heartbeat
+   int heartbeat_expired;
+};
+
+static uint32_t rol(uint32_t value, int bits)
+{
+   return (value << bits) | (value >> (32 - bits));
+}
+
+static void sha1_block(uint32_t *h, const uint8_t *block)
+{
+   uint32_t w[80], a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+   int i;
+
+   for (i = 0; i < 16; i++)
+      w[i] = (uint32_t)block[4 * i] << 24 | block[4 * i + 1] << 16 | block[4 * i + 2] << 8 | block[4 * i + 3];
+   for (i = 16; i < 80; i++)
+      w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+   for (i = 0; i < 80; i++)
+   {
+      uint32_t f, k, t;
+
+      if (i < 20)
+      {
+         f = (b & c) | (~b & d);
+         k = 0x5a827999;
+      }
+      else if (i < 40)
+      {
+         f = b ^ c ^ d;
+         k = 0x6ed9eba1;
+      }
+      else if (i < 60)
+      {
+         f = (b & c) | (b & d) | (c & d);
+         k = 0x8f1bbcdc;
+      }
+      else
+      {
+         f = b ^ c ^ d;
+         k = 0xca62c1d6;
+      }
+      t = rol(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rol(b, 30);
+      b = a;
+      a = t;
+   }
+
+   h[0] += a;
+   h[1] += b;
+   h[2] += c;
+   h[3] += d;
+   h[4] += e;
+}
+
+/// SHA-1, only used for the handshake
+static void sha1(const uint8_t *data, int length, uint8_t *digest)
+{
+   uint32_t h[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+   uint64_t bits = (uint64_t)length * 8;
+   int total = ((length + 8) / 64 + 1) * 64;
+   uint8_t block[64];
+   int offset, i;
+
+   for (offset = 0; offset < total; offset += 64)
+   {
+      for (i = 0; i < 64; i++)
+      {
+         int pos = offset + i;
+
+         if (pos < length)
+            block[i] = data[pos];
+         else if (pos == length)
+            block[i] = 0x80;
+         else if (pos >= total - 8)
+            block[i] = (uint8_t)(bits >> (8 * (total - 1 - pos)));
+         else
+            block[i] = 0;
+      }
+      sha1_block(h, block);
+   }
+
+   for (i = 0; i < 20; i++)
+      digest[i] = (uint8_t)(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+static void base64_encode(const uint8_t *data, int length, char *out)
+{
+   static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+   int i;
+
+   for (i = 0; i < length; i += 3)
+   {
+      uint32_t v = data[i] << 16 | (i + 1 < length ? data[i + 1] << 8 : 0) | (i + 2 < length ? data[i + 2] : 0);
+
+      *out++ = table[(v >> 18) & 0x3f];
+      *out++ = table[(v >> 12) & 0x3f];
+      *out++ = i + 1 < length ? table[(v >> 6) & 0x3f] : '=';
+      *out++ = i + 2 < length ? table[v & 0x3f] : '=';
+   }
+   *out = 0;
+}
+
+static void set_write_interest(RASPIWS_T *ws, int slot, int want_write)
+{
+   CLIENT_T *client = ws->clients[slot];
+   struct epoll_event ev;
+
+   if (client->want_write == want_write)
+      return;
+
+   memset(&ev, 0, sizeof(ev));
+   ev.events = EPOLLIN | EPOLLRDHUP | (want_write ? EPOLLOUT : 0);
+   ev.data.u64 = 2 + slot;
+   epoll_ctl(ws->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev);
+   client->want_write = want_write;
+}
+
+static void close_client(RASPIWS_T *ws, int slot)
+{
+   CLIENT_T *client = ws->clients[slot];
+   int remaining;
+
+   if (client->fd < 0)
+      return;
+
+   epoll_ctl(ws->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+   close(client->fd);
+   client->fd = -1;
+
+   if (!client->open)
+      return;
+   client->open = 0;
+
+   vcos_mutex_lock(&ws->lock);
+   remaining = --ws->stats.clients;
+   vcos_mutex_unlock(&ws->lock);
+
+   // Like the Python server, tracking stops when nobody is watching
+   if (!remaining)
+   {
+      vcos_log_info("last client left, stopping");
+      if (ws->command_fn)
+         ws->command_fn(ws->userdata, RASPIWS_COMMAND_STOP);
+   }
+}
+
+/// Free the slots of clients closed during an epoll batch
+static void reap_clients(RASPIWS_T *ws)
+{
+   int i;
+
+   for (i = 0; i < MAX_CLIENTS; i++)
+   {
+      if (ws->clients[i] && ws->clients[i]->fd < 0)
+      {
+         free(ws->clients[i]->output);
+         free(ws->clients[i]);
+         ws->clients[i] = NULL;
+      }
+   }
+}
+
+/**
+ * Write as much of the pending output as the socket takes
+ */
+static void flush_client(RASPIWS_T *ws, int slot)
+{
+   CLIENT_T *client = ws->clients[slot];
+   int written = 0;
+
+   while (written < client->output_len)
+   {
+      ssize_t result = send(client->fd, client->output + written, client->output_len - written, MSG_NOSIGNAL);
+
+      if (result < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         if (errno != EAGAIN && errno != EWOULDBLOCK)
+         {
+            close_client(ws, slot);
+            return;
+         }
+         break;
+      }
+      written += result;
+   }
+
+   memmove(client->output, client->output + written, client->output_len - written);
+   client->output_len -= written;
+
+   if (!client->output_len && client->closing)
+      close_client(ws, slot);
+   else
+      set_write_interest(ws, slot, client->output_len > 0);
+}
+
+/**
+ * Send data to a client. It is written right away when nothing is pending,
+ * and only what the socket does not take is buffered.
+ *
+ * @return Bytes accepted, 0 if the client was dropped
+ */
+static int send_client(RASPIWS_T *ws, int slot, const uint8_t *data, int length)
+{
+   CLIENT_T *client = ws->clients[slot];
+   int written = 0;
+
+   if (client->fd < 0)
+      return 0;
+
+   if (!client->output_len)
+   {
+      while (written < length)
+      {
+         ssize_t result = send(client->fd, data + written, length - written, MSG_NOSIGNAL);
+
+         if (result < 0)
+         {
+            if (errno == EINTR)
+               continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+               close_client(ws, slot);
+               return 0;
+            }
+            break;
+         }
+         written += result;
+      }
+      if (written == length)
+         return length;
+   }
+
+   if (client->output_len + length - written > OUTPUT_LIMIT)
+   {
+      vcos_log_warn("client too slow, dropped");
+      vcos_mutex_lock(&ws->lock);
+      ws->stats.slow_clients++;
+      vcos_mutex_unlock(&ws->lock);
+      close_client(ws, slot);
+      return 0;
+   }
+
+   if (client->output_len + length - written > client->output_size)
+   {
+      int size = client->output_size ? client->output_size : 4096;
+      uint8_t *output;
+
+      while (size < client->output_len + length - written)
+         size *= 2;
+      output = realloc(client->output, size);
+      if (!output)
+      {
+         close_client(ws, slot);
+         return 0;
+      }
+      client->output = output;
+      client->output_size = size;
+   }
+
+   memcpy(client->output + client->output_len, data + written, length - written);
+   client->output_len += length - written;
+   set_write_interest(ws, slot, 1);
+   return length;
+}
+
+/// Server frame, never masked
+static int make_frame(uint8_t *frame, int opcode, const uint8_t *payload, int length)
+{
+   int header = 2;
+
+   frame[0] = 0x80 | opcode;
+   if (length < 126)
+   {
+      frame[1] = length;
+   }
+   else
+   {
+      frame[1] = 126;
+      frame[2] = length >> 8;
+      frame[3] = length & 0xff;
+      header = 4;
+   }
+   memcpy(frame + header, payload, length);
+   return header + length;
+}
+
+static void handle_command(RASPIWS_T *ws, const char *text, int length)
+{
+   RASPIWS_COMMAND_T command;
+
+   vcos_mutex_lock(&ws->lock);
+   ws->stats.commands++;
+   vcos_mutex_unlock(&ws->lock);
+
+   if (length == 9 && !memcmp(text, "heartbeat", 9))
+   {
+      ws->last_heartbeat_us = vcos_getmicrosecs64();
+      ws->heartbeat_expired = 0;
+      return;
+   }
+
+   if (length == 5 && !memcmp(text, "start", 5))
+      command = RASPIWS_COMMAND_START;
+   else if (length == 4 && !memcmp(text, "stop", 4))
+      command = RASPIWS_COMMAND_STOP;
+   else if (length == 6 && !memcmp(text, "replay", 6))
+      command = RASPIWS_COMMAND_REPLAY;
+   else if (length == 4 && !memcmp(text, "dump", 4))
+      command = RASPIWS_COMMAND_DUMP;
+   else
+   {
+      vcos_log_info("client said: %.*s", length > 200 ? 200 : length, text);
+      return;
+   }
+
+   if (ws->command_fn)
+      ws->command_fn(ws->userdata, command);
+}
+
+/**
+ * Answer the opening handshake once the request is complete
+ *
+ * @return Bytes of input used, 0 if the request is not complete yet
+ */
+static int handle_handshake(RASPIWS_T *ws, int slot)
+{
+   CLIENT_T *client = ws->clients[slot];
+   char *request = (char *)client->input, *end, *key;
+   char response[256], accept[32], buffer[128];
+   uint8_t digest[20];
+   int length;
+
+   client->input[client->input_len] = 0;
+   end = strstr(request, "\r\n\r\n");
+   if (!end)
+      return 0;
+
+   key = strcasestr(request, "\r\nSec-WebSocket-Key:");
+   if (strncmp(request, "GET ", 4) || !key || key > end)
+   {
+      static const char bad_request[] = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+
+      send_client(ws, slot, (const uint8_t *)bad_request, sizeof(bad_request) - 1);
+      client->closing = 1;
+      return end + 4 - request;
+   }
+
+   key += 20;
+   while (*key == ' ' || *key == '\t')
+      key++;
+   length = strcspn(key, " \t\r\n");
+   if (length > 64)
+      length = 64;
+   memcpy(buffer, key, length);
+   memcpy(buffer + length, WS_GUID, sizeof(WS_GUID) - 1);
+   sha1((const uint8_t *)buffer, length + sizeof(WS_GUID) - 1, digest);
+   base64_encode(digest, sizeof(digest), accept);
+
+   length = snprintf(response, sizeof(response),
+                     "HTTP/1.1 101 Switching Protocols\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+   if (send_client(ws, slot, (const uint8_t *)response, length))
+   {
+      client->open = 1;
+      vcos_mutex_lock(&ws->lock);
+      ws->stats.clients++;
+      ws->stats.connections++;
+      vcos_mutex_unlock(&ws->lock);
+   }
+
+   return end + 4 - request;
+}
+
+/**
+ * Handle one client frame
+ *
+ * @return Bytes of input used, 0 if the frame is not complete yet, -1 to drop the client
+ */
+static int handle_frame(RASPIWS_T *ws, int slot)
+{
+   CLIENT_T *client = ws->clients[slot];
+   uint8_t *p = client->input, *payload, frame[4 + 125];
+   int opcode, header = 2, i;
+   uint64_t length;
+
+   if (client->input_len < 2)
+      return 0;
+
+   opcode = p[0] & 0x0f;
+   length = p[1] & 0x7f;
+
+   // Clients must mask their frames
+   if (!(p[1] & 0x80))
+      return -1;
+
+   if (length == 126)
+   {
+      if (client->input_len < 4)
+         return 0;
+      length = p[2] << 8 | p[3];
+      header = 4;
+   }
+   else if (length == 127)
+   {
+      if (client->input_len < 10)
+         return 0;
+      for (i = 0, length = 0; i < 8; i++)
+         length = length << 8 | p[2 + i];
+      header = 10;
+   }
+
+   if (length > INPUT_SIZE - header - 4)
+      return -1;
+   if (client->input_len < header + 4 + (int)length)
+      return 0;
+
+   payload = p + header + 4;
+   for (i = 0; i < (int)length; i++)
+      payload[i] ^= p[header + i % 4];
+
+   switch (opcode)
+   {
+   case OPCODE_TEXT:
+      // Commands are never fragmented
+      if (p[0] & 0x80)
+         handle_command(ws, (const char *)payload, (int)length);
+      break;
+
+   case OPCODE_PING:
+      if (length <= 125)
+         send_client(ws, slot, frame, make_frame(frame, OPCODE_PONG, payload, (int)length));
+      break;
+
+   case OPCODE_CLOSE:
+      if (length <= 125)
+         send_client(ws, slot, frame, make_frame(frame, OPCODE_CLOSE, payload, length >= 2 ? 2 : 0));
+      client->closing = 1;
+      break;
+
+   default:
+      // Pongs, binary data and continuations are not used
+      break;
+   }
+
+   return header + 4 + (int)length;
+}
+
+static void read_client(RASPIWS_T *ws, int slot)
+{
+   CLIENT_T *client = ws->clients[slot];
+
+   while (client->fd >= 0 && !client->closing)
+   {
+      ssize_t result = recv(client->fd, client->input + client->input_len, INPUT_SIZE - client->input_len, 0);
+      int used;
+
+      if (result < 0 && errno == EINTR)
+         continue;
+      if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+         break;
+      if (result <= 0)
+      {
+         close_client(ws, slot);
+         return;
+      }
+      client->input_len += result;
+
+      while (client->fd >= 0 && !client->closing && client->input_len)
+      {
+         used = client->open ? handle_frame(ws, slot) : handle_handshake(ws, slot);
+         if (used < 0)
+         {
+            close_client(ws, slot);
+            return;
+         }
+         if (!used)
+            break;
+         memmove(client->input, client->input + used, client->input_len - used);
+         client->input_len -= used;
+      }
+
+      // A request or frame that does not fit
+      if (client->input_len == INPUT_SIZE)
+      {
+         close_client(ws, slot);
+         return;
+      }
+   }
+
+   if (client->fd >= 0 && client->closing && !client->output_len)
+      close_client(ws, slot);
+}
+
+static void accept_clients(RASPIWS_T *ws)
+{
+   while (1)
+   {
+      struct epoll_event ev;
+      int fd = accept4(ws->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      int one = 1, slot;
+
+      if (fd < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         break;
+      }
+
+      for (slot = 0; slot < MAX_CLIENTS; slot++)
+         if (!ws->clients[slot])
+            break;
+      if (slot == MAX_CLIENTS || !(ws->clients[slot] = calloc(1, sizeof(CLIENT_T))))
+      {
+         vcos_log_warn("too many clients");
+         close(fd);
+         continue;
+      }
+
+      // Events are small and latency matters
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+      ws->clients[slot]->fd = fd;
+      memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN | EPOLLRDHUP;
+      ev.data.u64 = 2 + slot;
+      if (epoll_ctl(ws->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+      {
+         close(fd);
+         free(ws->clients[slot]);
+         ws->clients[slot] = NULL;
+      }
+   }
+}
+
+/**
+ * Broadcast the events in the ring to all open clients
+ */
+static void broadcast_events(RASPIWS_T *ws)
+{
+   while (1)
+   {
+      uint8_t frame[4 + EVENT_SIZE];
+      uint32_t messages = 0;
+      int length, i;
+      int64_t latency;
+      EVENT_T event;
+
+      vcos_mutex_lock(&ws->lock);
+      if (ws->tail == ws->head)
+      {
+         vcos_mutex_unlock(&ws->lock);
+         break;
+      }
+      event = ws->events[ws->tail % EVENT_SLOTS];
+      ws->tail++;
+      vcos_mutex_unlock(&ws->lock);
+
+      length = make_frame(frame, OPCODE_TEXT, (const uint8_t *)event.text, event.length);
+      for (i = 0; i < MAX_CLIENTS; i++)
+         if (ws->clients[i] && ws->clients[i]->open && send_client(ws, i, frame, length))
+            messages++;
+
+      latency = vcos_getmicrosecs64() - event.time_us;
+
+      vcos_mutex_lock(&ws->lock);
+      ws->stats.events++;
+      ws->stats.messages += messages;
+      ws->stats.bytes += (uint64_t)messages * length;
+      ws->stats.total_latency_us += latency;
+      if (latency > ws->stats.max_latency_us)
+         ws->stats.max_latency_us = (uint32_t)latency;
+      vcos_mutex_unlock(&ws->lock);
+   }
+}
+
+static void check_heartbeat(RASPIWS_T *ws)
+{
+   if (ws->last_heartbeat_us < 0 || ws->heartbeat_expired ||
+       vcos_getmicrosecs64() - ws->last_heartbeat_us < (int64_t)ws->heartbeat_ms * 1000)
+      return;
+
+   ws->heartbeat_expired = 1;
+   vcos_log_warn("no heartbeat for %d ms, stopping", ws->heartbeat_ms);
+   if (ws->command_fn)
+      ws->command_fn(ws->userdata, RASPIWS_COMMAND_STOP);
+}
+
+static void *server_thread(void *arg)
+{
+   RASPIWS_T *ws = (RASPIWS_T *)arg;
+   struct epoll_event evs[32];
+
+   while (1)
+   {
+      int count, i, running;
+
+      count = epoll_wait(ws->epoll_fd, evs, sizeof(evs) / sizeof(evs[0]), POLL_MS);
+
+      vcos_mutex_lock(&ws->lock);
+      running = ws->running;
+      vcos_mutex_unlock(&ws->lock);
+      if (!running)
+         break;
+
+      for (i = 0; i < count; i++)
+      {
+         uint64_t key = evs[i].data.u64;
+
+         if (key == KEY_LISTEN)
+         {
+            accept_clients(ws);
+         }
+         else if (key == KEY_EVENT)
+         {
+            uint64_t value;
+
+            if (read(ws->event_fd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+               vcos_log_error("eventfd read failed (%s)", strerror(errno));
+            broadcast_events(ws);
+         }
+         else
+         {
+            int slot = (int)(key - 2);
+
+            if (!ws->clients[slot] || ws->clients[slot]->fd < 0)
+               continue;
+            if (evs[i].events & EPOLLOUT)
+               flush_client(ws, slot);
+            if (ws->clients[slot]->fd >= 0 && (evs[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+               read_client(ws, slot);
+         }
+      }
+
+      reap_clients(ws);
+      check_heartbeat(ws);
+   }
+
+   return NULL;
+}
+
+/**
+ * Start the server
+ *
+ * @param port TCP port to listen on, 0 for any free port
+ * @param heartbeat_ms Time without heartbeats after which tracking stops
+ * @param fn Called on the server thread for start, stop and replay
+ * @return The server, or NULL on failure
+ */
+RASPIWS_T *raspiws_create(int port, int heartbeat_ms, RASPIWS_COMMAND_FN fn, void *userdata)
+{
+   struct sockaddr_in addr;
+   socklen_t addr_len = sizeof(addr);
+   struct epoll_event ev;
+   RASPIWS_T *ws;
+   int one = 1;
+
+   vcos_log_register("RaspiWebSocket", VCOS_LOG_CATEGORY);
+
+   ws = calloc(1, sizeof(*ws));
+   if (!ws)
+      return NULL;
+   ws->heartbeat_ms = heartbeat_ms > 0 ? heartbeat_ms : RASPIWS_HEARTBEAT_MS;
+   ws->command_fn = fn;
+   ws->userdata = userdata;
+   ws->last_heartbeat_us = -1;
+   ws->epoll_fd = ws->event_fd = -1;
+
+   ws->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+   if (ws->listen_fd < 0)
+      goto error;
+   setsockopt(ws->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_ANY);
+   addr.sin_port = htons(port);
+   if (bind(ws->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(ws->listen_fd, 16) != 0 ||
+       getsockname(ws->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0)
+   {
+      vcos_log_error("unable to listen on port %d (%s)", port, strerror(errno));
+      goto error;
+   }
+   ws->port = ntohs(addr.sin_port);
+
+   ws->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+   ws->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+   if (ws->epoll_fd < 0 || ws->event_fd < 0)
+      goto error;
+
+   memset(&ev, 0, sizeof(ev));
+   ev.events = EPOLLIN;
+   ev.data.u64 = KEY_LISTEN;
+   if (epoll_ctl(ws->epoll_fd, EPOLL_CTL_ADD, ws->listen_fd, &ev) != 0)
+      goto error;
+   ev.data.u64 = KEY_EVENT;
+   if (epoll_ctl(ws->epoll_fd, EPOLL_CTL_ADD, ws->event_fd, &ev) != 0)
+      goto error;
+
+   if (vcos_mutex_create(&ws->lock, "RaspiWebSocket") != VCOS_SUCCESS)
+      goto error;
+
+   ws->running = 1;
+   if (vcos_thread_create(&ws->thread, "RaspiWebSocket", NULL, server_thread, ws) != VCOS_SUCCESS)
+   {
+      vcos_mutex_delete(&ws->lock);
+      goto error;
+   }
+
+   return ws;
+
+error:
+   if (ws->listen_fd >= 0)
+      close(ws->listen_fd);
+   if (ws->epoll_fd >= 0)
+      close(ws->epoll_fd);
+   if (ws->event_fd >= 0)
+      close(ws->event_fd);
+   free(ws);
+   return NULL;
+}
+
+/**
+ * Stop the server and close all clients. The command callback is not
+ * called anymore once this returns.
+ */
+void raspiws_destroy(RASPIWS_T *ws)
+{
+   uint64_t value = 1;
+   void *result;
+   int i;
+
+   if (!ws)
+      return;
+
+   vcos_mutex_lock(&ws->lock);
+   ws->running = 0;
+   vcos_mutex_unlock(&ws->lock);
+   if (write(ws->event_fd, &value, sizeof(value)) < 0)
+      vcos_log_error("eventfd write failed (%s)", strerror(errno));
+   vcos_thread_join(&ws->thread, &result);
+
+   for (i = 0; i < MAX_CLIENTS; i++)
+   {
+      if (ws->clients[i])
+      {
+         if (ws->clients[i]->fd >= 0)
+            close(ws->clients[i]->fd);
+         free(ws->clients[i]->output);
+         free(ws->clients[i]);
+      }
+   }
+
+   close(ws->listen_fd);
+   close(ws->epoll_fd);
+   close(ws->event_fd);
+   vcos_mutex_delete(&ws->lock);
+   free(ws);
+}
+
+/**
+ * The port the server listens on, useful when it was created with port 0
+ */
+int raspiws_get_port(RASPIWS_T *ws)
+{
+   return ws->port;
+}
+
+/**
+ * Queue an event for all clients. A trailing newline, as sent to the FIFO,
+ * is not part of the message. Does not block, may be called from any
+ * thread.
+ *
+ * @return 0 on success, -1 if the ring was full and the event was dropped
+ */
+int raspiws_post(RASPIWS_T *ws, const char *event)
+{
+   uint64_t value = 1;
+   int length = strlen(event), result = 0;
+   EVENT_T *slot;
+
+   while (length && (event[length - 1] == '\n' || event[length - 1] == '\r'))
+      length--;
+   if (length > EVENT_SIZE)
+      length = EVENT_SIZE;
+
+   vcos_mutex_lock(&ws->lock);
+   if (ws->head - ws->tail >= EVENT_SLOTS)
+   {
+      ws->stats.dropped_events++;
+      result = -1;
+   }
+   else
+   {
+      slot = &ws->events[ws->head % EVENT_SLOTS];
+      slot->time_us = vcos_getmicrosecs64();
+      slot->length = length;
+      memcpy(slot->text, event, length);
+      ws->head++;
+   }
+   vcos_mutex_unlock(&ws->lock);
+
+   if (!result && write(ws->event_fd, &value, sizeof(value)) < 0)
+      vcos_log_error("eventfd write failed (%s)", strerror(errno));
+   return result;
+}
+
+void raspiws_get_stats(RASPIWS_T *ws, RASPIWS_STATS_T *stats)
+{
+   vcos_mutex_lock(&ws->lock);
+   *stats = ws->stats;
+   vcos_mutex_unlock(&ws->lock);
+}
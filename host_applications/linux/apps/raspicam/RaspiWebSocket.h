@@ -0,0 +1,60 @@
+#ifndef RASPIWEBSOCKET_H_
+#define RASPIWEBSOCKET_H_
+
+#include <stdint.h>
+
+/**
+ * WebSocket server for tracker events, in place of the FIFO and
+ * pythonwebsocket/balltrack_websocket.py.
+ *
+ * Events are posted to a ring from the tracker thread, which only copies
+ * the text and wakes the server thread through an eventfd. The server
+ * thread runs an epoll loop over the listening socket and all clients,
+ * and broadcasts every event as a text message to each client that has
+ * completed the handshake. Clients that do not keep up are dropped
+ * rather than buffering without limit.
+ *
+ * The commands of the Python server are accepted from clients:
+ * "start", "stop", "replay" and "heartbeat", and "dump" to save the frames
+ * in the capture ring. All but heartbeat are passed to the command
+ * callback, on the server thread. A stop is also
+ * sent when the last client leaves, and when heartbeats were received but
+ * none came within the heartbeat timeout.
+ */
+typedef struct RASPIWS_S RASPIWS_T;
+
+typedef enum
+{
+   RASPIWS_COMMAND_START,
+   RASPIWS_COMMAND_STOP,
+   RASPIWS_COMMAND_REPLAY,
+   RASPIWS_COMMAND_DUMP,
+} RASPIWS_COMMAND_T;
+
+typedef void (*RASPIWS_COMMAND_FN)(void *userdata, RASPIWS_COMMAND_T command);
+
+#define RASPIWS_DEFAULT_PORT     8420
+#define RASPIWS_HEARTBEAT_MS     5000
+
+typedef struct
+{
+   int clients;                     /// Clients with a completed handshake
+   uint64_t connections;            /// Handshakes completed
+   uint64_t events;                 /// Events broadcast
+   uint32_t dropped_events;         /// Events lost because the ring was full
+   uint64_t messages;               /// Messages sent, one per event and client
+   uint64_t bytes;                  /// Bytes written to clients
+   uint32_t slow_clients;           /// Clients dropped because their output backed up
+   uint32_t commands;               /// Commands received
+   uint32_t max_latency_us;         /// Longest time from posting an event to writing it to all clients
+   uint64_t total_latency_us;       /// Sum of those times, for the average
+} RASPIWS_STATS_T;
+
+RASPIWS_T *raspiws_create(int port, int heartbeat_ms, RASPIWS_COMMAND_FN fn, void *userdata);
+void raspiws_destroy(RASPIWS_T *ws);
+
+int raspiws_get_port(RASPIWS_T *ws);
+int raspiws_post(RASPIWS_T *ws, const char *event);
+void raspiws_get_stats(RASPIWS_T *ws, RASPIWS_STATS_T *stats);
+
+#endif
@@ -0,0 +1,506 @@
+/**
+ * \file RaspiWriter.c
+ * Asynchronous writer for the encoder output, see RaspiWriter.h
+ *
+ * The staging ring is written by a single producer, the encoder callback.
+ * Data positions are absolute byte counts, the ring holds [tail, head).
+ * Each queued buffer is a job that records where its data is, segment
+ * rollovers are jobs without data.
+ */
+
+// fallocate needs GNU extensions
+#ifndef _GNU_SOURCE
+   #define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "interface/vcos/vcos.h"
+
+#include "RaspiWriter.h"
+
+static VCOS_LOG_CAT_T raspiwriter_log_category;
+#define VCOS_LOG_CATEGORY (&raspiwriter_log_category)
+
+/// Maximum number of queued buffers
+#define JOB_COUNT 1024
+
+/// Largest single write after merging buffers
+#define MAX_MERGE (1024 * 1024)
+
+typedef enum
+{
+   JOB_DATA,
+   JOB_SPLIT
+} JOB_TYPE_T;
+
+typedef struct
+{
+   JOB_TYPE_T type;
+   RASPIWRITER_STREAM_T stream;
+   uint64_t offset;                 /// Absolute position of the data in the ring
+   int length;
+   int segment;                     /// New segment number for JOB_SPLIT
+} JOB_T;
+
+struct RASPIWRITER_S
+{
+   VCOS_MUTEX_T lock;
+   VCOS_SEMAPHORE_T work;           /// Posted for every queued job
+   VCOS_SEMAPHORE_T space;          /// Posted when the writer frees space for a waiting producer
+   VCOS_THREAD_T thread;
+
+   uint8_t *data;                   /// Staging ring
+   int size;
+   uint64_t head;                   /// Absolute position of the next byte to queue
+   uint64_t tail;                   /// Absolute position of the next byte to write
+
+   JOB_T jobs[JOB_COUNT];
+   unsigned int job_head;
+   unsigned int job_tail;
+
+   FILE *files[RASPIWRITER_STREAMS];
+   RASPIWRITER_OPEN_FN_T open_fn;
+   void *userdata;
+   int64_t prealloc;                /// Bytes to preallocate for each video file
+   int flush;                       /// Flush after every write
+
+   int running;
+   int waiting;                     /// Producer waits for space
+   int blocking;                    /// Wait for space instead of dropping buffers
+   int failed;                      /// Set by the writer thread, read by the producer, under the lock
+
+   RASPIWRITER_STATS_T stats;
+};
+
+/// Reserves disk space for a new video file, so appending does not
+/// have to allocate blocks. The file size is not changed.
+static void preallocate(RASPIWRITER_T *writer, FILE *file)
+{
+   struct stat st;
+   int fd;
+
+   if (!file || writer->prealloc <= 0)
+      return;
+
+   fd = fileno(file);
+   if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+   {
+      // Not supported on every file system, then we just do without
+      if (fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, writer->prealloc) != 0)
+         vcos_log_trace("fallocate not supported");
+   }
+}
+
+/// Writes data from the ring, returns the time it took in microseconds
+static uint32_t write_data(RASPIWRITER_T *writer, RASPIWRITER_STREAM_T stream, uint64_t offset, int length)
+{
+   FILE *file = writer->files[stream];
+   int start = (int)(offset % writer->size);
+   int first = length < writer->size - start ? length : writer->size - start;
+   int64_t t0;
+   size_t written;
+
+   if (!file || writer->failed)
+      return 0;
+
+   t0 = vcos_getmicrosecs64();
+   written = fwrite(writer->data + start, 1, first, file);
+   if (first < length)
+      written += fwrite(writer->data, 1, length - first, file);
+   if (writer->flush)
+      fflush(file);
+
+   if (written != (size_t)length)
+   {
+      vcos_log_error("Failed to write buffer data (%d from %d)", (int)written, length);
+      vcos_mutex_lock(&writer->lock);
+      writer->failed = 1;
+      vcos_mutex_unlock(&writer->lock);
+   }
+
+   return (uint32_t)(vcos_getmicrosecs64() - t0);
+}
+
+static void split(RASPIWRITER_T *writer, int segment)
+{
+   int stream;
+
+   if (!writer->open_fn)
+      return;
+
+   for (stream = 0; stream < RASPIWRITER_STREAMS; stream++)
+   {
+      FILE *file;
+
+      if (!writer->files[stream])
+         continue;
+
+      file = writer->open_fn(writer->userdata, stream, segment);
+      if (file)
+      {
+         if (writer->files[stream] != stdout)
+            fclose(writer->files[stream]);
+         writer->files[stream] = file;
+         if (stream == RASPIWRITER_VIDEO)
+         {
+            preallocate(writer, file);
+            vcos_mutex_lock(&writer->lock);
+            writer->stats.segments++;
+            vcos_mutex_unlock(&writer->lock);
+         }
+      }
+   }
+}
+
+static void *writer_worker(void *arg)
+{
+   RASPIWRITER_T *writer = arg;
+
+   while (1)
+   {
+      unsigned int job_tail, job_head;
+      int running;
+
+      vcos_semaphore_wait(&writer->work);
+
+      vcos_mutex_lock(&writer->lock);
+      job_tail = writer->job_tail;
+      job_head = writer->job_head;
+      running = writer->running;
+      vcos_mutex_unlock(&writer->lock);
+
+      if (job_tail == job_head)
+      {
+         if (!running)
+            break;
+         continue;
+      }
+
+      while (job_tail != job_head)
+      {
+         JOB_T *job = &writer->jobs[job_tail % JOB_COUNT];
+         uint64_t end = writer->tail;
+         int written = 0;
+         uint32_t elapsed = 0;
+
+         if (job->type == JOB_SPLIT)
+         {
+            split(writer, job->segment);
+            job_tail++;
+         }
+         else
+         {
+            // Merge following buffers for the same file into one write
+            RASPIWRITER_STREAM_T stream = job->stream;
+            uint64_t offset = job->offset;
+            int length = job->length;
+
+            job_tail++;
+            while (job_tail != job_head)
+            {
+               JOB_T *next = &writer->jobs[job_tail % JOB_COUNT];
+               if (next->type != JOB_DATA || next->stream != stream ||
+                   next->offset != offset + length || length + next->length > MAX_MERGE)
+                  break;
+               length += next->length;
+               job_tail++;
+            }
+
+            elapsed = write_data(writer, stream, offset, length);
+            written = length;
+            end = offset + length;
+         }
+
+         // Hand the space back to the producer
+         vcos_mutex_lock(&writer->lock);
+         writer->tail = end;
+         writer->job_tail = job_tail;
+         if (written)
+         {
+            writer->stats.bytes += written;
+            writer->stats.writes++;
+            if (elapsed > writer->stats.max_write_us)
+               writer->stats.max_write_us = elapsed;
+         }
+         if (writer->waiting)
+         {
+            writer->waiting = 0;
+            vcos_semaphore_post(&writer->space);
+         }
+         vcos_mutex_unlock(&writer->lock);
+      }
+   }
+
+   return NULL;
+}
+
+/**
+ * Create a writer and start its thread
+ *
+ * @param size Size of the staging ring in bytes
+ * @param open_fn Called to open new files on segment rollover, may be NULL
+ * @param userdata Passed to open_fn
+ * @return The writer, or NULL on failure
+ */
+RASPIWRITER_T *raspiwriter_create(int size, RASPIWRITER_OPEN_FN_T open_fn, void *userdata)
+{
+   RASPIWRITER_T *writer = calloc(1, sizeof(RASPIWRITER_T));
+
+   if (!writer)
+      return NULL;
+
+   writer->data = malloc(size);
+   if (!writer->data)
+      goto error_data;
+   if (vcos_mutex_create(&writer->lock, "writer") != VCOS_SUCCESS)
+      goto error_data;
+   if (vcos_semaphore_create(&writer->work, "writer-work", 0) != VCOS_SUCCESS)
+      goto error_work;
+   if (vcos_semaphore_create(&writer->space, "writer-space", 0) != VCOS_SUCCESS)
+      goto error_space;
+
+   vcos_log_register("RaspiWriter", VCOS_LOG_CATEGORY);
+
+   writer->size = size;
+   writer->open_fn = open_fn;
+   writer->userdata = userdata;
+   writer->running = 1;
+
+   if (vcos_thread_create(&writer->thread, "encoder-writer", NULL, writer_worker, writer) != VCOS_SUCCESS)
+      goto error_thread;
+
+   return writer;
+
+error_thread:
+   vcos_log_unregister(VCOS_LOG_CATEGORY);
+   vcos_semaphore_delete(&writer->space);
+error_space:
+   vcos_semaphore_delete(&writer->work);
+error_work:
+   vcos_mutex_delete(&writer->lock);
+error_data:
+   free(writer->data);
+   free(writer);
+   return NULL;
+}
+
+/**
+ * Write out everything still queued, stop the thread and free the writer.
+ * The files are not closed, get them with raspiwriter_get_file first.
+ */
+void raspiwriter_destroy(RASPIWRITER_T *writer)
+{
+   if (!writer)
+      return;
+
+   vcos_mutex_lock(&writer->lock);
+   writer->running = 0;
+   vcos_mutex_unlock(&writer->lock);
+   vcos_semaphore_post(&writer->work);
+   vcos_thread_join(&writer->thread, NULL);
+
+   vcos_log_unregister(VCOS_LOG_CATEGORY);
+   vcos_semaphore_delete(&writer->space);
+   vcos_semaphore_delete(&writer->work);
+   vcos_mutex_delete(&writer->lock);
+   free(writer->data);
+   free(writer);
+}
+
+/**
+ * Set the file for a stream. Only call before queueing data for it, later
+ * files are opened by the writer thread on segment rollover.
+ */
+void raspiwriter_set_file(RASPIWRITER_T *writer, RASPIWRITER_STREAM_T stream, FILE *file)
+{
+   vcos_mutex_lock(&writer->lock);
+   writer->files[stream] = file;
+   if (stream == RASPIWRITER_VIDEO)
+      preallocate(writer, file);
+   vcos_mutex_unlock(&writer->lock);
+}
+
+/// Current file of a stream, only valid once the writer is idle
+FILE *raspiwriter_get_file(RASPIWRITER_T *writer, RASPIWRITER_STREAM_T stream)
+{
+   return writer->files[stream];
+}
+
+/// Set how many bytes to preallocate for each new video file
+void raspiwriter_set_prealloc(RASPIWRITER_T *writer, int64_t bytes)
+{
+   writer->prealloc = bytes;
+}
+
+/// Flush the files after every write, for lower latency
+void raspiwriter_set_flush(RASPIWRITER_T *writer, int flush)
+{
+   writer->flush = flush;
+}
+
+/// Wait for space instead of dropping buffers when the staging ring is full
+void raspiwriter_set_blocking(RASPIWRITER_T *writer, int blocking)
+{
+   vcos_mutex_lock(&writer->lock);
+   writer->blocking = blocking;
+   vcos_mutex_unlock(&writer->lock);
+}
+
+/// Whether there is room for length bytes and a job, keeping spare jobs back. Called with the lock held.
+static int has_space(RASPIWRITER_T *writer, int length, unsigned int spare_jobs)
+{
+   return writer->head + length - writer->tail <= (uint64_t)writer->size &&
+          writer->job_head - writer->job_tail + spare_jobs < JOB_COUNT;
+}
+
+/// Waits until there is room for length bytes and a job. Called with the lock held.
+static void wait_for_space(RASPIWRITER_T *writer, int length)
+{
+   int64_t t0 = 0;
+
+   while (!has_space(writer, length, 0))
+   {
+      if (!t0)
+      {
+         t0 = vcos_getmicrosecs64();
+         writer->stats.stalls++;
+      }
+      writer->waiting = 1;
+      vcos_mutex_unlock(&writer->lock);
+      vcos_semaphore_wait(&writer->space);
+      vcos_mutex_lock(&writer->lock);
+   }
+
+   if (t0)
+      writer->stats.stall_us += vcos_getmicrosecs64() - t0;
+}
+
+/**
+ * Queue data for a stream. The data is copied, so the caller can release
+ * its buffer when this returns. If the staging ring is full the whole
+ * buffer is dropped, unless the writer is blocking, then this waits for
+ * space. A job is always kept back for raspiwriter_split.
+ *
+ * @return 0 on success, 1 if the buffer was dropped, -1 if the data can never fit
+ */
+int raspiwriter_write(RASPIWRITER_T *writer, RASPIWRITER_STREAM_T stream, const void *data, int length)
+{
+   JOB_T *job;
+   int start, first, queued;
+
+   if (length <= 0)
+      return 0;
+   if (length > writer->size)
+      return -1;
+
+   vcos_mutex_lock(&writer->lock);
+   if (writer->blocking)
+   {
+      wait_for_space(writer, length);
+   }
+   else if (!has_space(writer, length, 1))
+   {
+      writer->stats.dropped++;
+      writer->stats.dropped_bytes += length;
+      vcos_mutex_unlock(&writer->lock);
+      return 1;
+   }
+
+   start = (int)(writer->head % writer->size);
+   first = length < writer->size - start ? length : writer->size - start;
+   memcpy(writer->data + start, data, first);
+   memcpy(writer->data, (const uint8_t *)data + first, length - first);
+
+   job = &writer->jobs[writer->job_head % JOB_COUNT];
+   job->type = JOB_DATA;
+   job->stream = stream;
+   job->offset = writer->head;
+   job->length = length;
+   writer->job_head++;
+   writer->head += length;
+
+   writer->stats.jobs++;
+   queued = (int)(writer->head - writer->tail);
+   if (queued > writer->stats.high_water)
+      writer->stats.high_water = queued;
+
+   vcos_mutex_unlock(&writer->lock);
+   vcos_semaphore_post(&writer->work);
+   return 0;
+}
+
+/**
+ * Count a buffer the caller dropped without queueing it, such as the rest
+ * of a video stream up to the next keyframe after a dropped buffer.
+ */
+void raspiwriter_skip(RASPIWRITER_T *writer, int length)
+{
+   vcos_mutex_lock(&writer->lock);
+   writer->stats.dropped++;
+   writer->stats.dropped_bytes += length;
+   vcos_mutex_unlock(&writer->lock);
+}
+
+/**
+ * Queue a segment rollover. The writer thread opens the new files through
+ * the open function once everything queued before has been written.
+ * Only waits when the last spare job already holds a rollover.
+ */
+int raspiwriter_split(RASPIWRITER_T *writer, int segment)
+{
+   JOB_T *job;
+
+   vcos_mutex_lock(&writer->lock);
+   wait_for_space(writer, 0);
+
+   job = &writer->jobs[writer->job_head % JOB_COUNT];
+   job->type = JOB_SPLIT;
+   job->segment = segment;
+   job->length = 0;
+   writer->job_head++;
+
+   vcos_mutex_unlock(&writer->lock);
+   vcos_semaphore_post(&writer->work);
+   return 0;
+}
+
+/**
+ * Wait until everything queued so far has been written, so that the files
+ * and statistics are final. Must not be called while data is still queued
+ * from another thread.
+ */
+void raspiwriter_drain(RASPIWRITER_T *writer)
+{
+   vcos_mutex_lock(&writer->lock);
+   while (writer->job_tail != writer->job_head)
+   {
+      writer->waiting = 1;
+      vcos_mutex_unlock(&writer->lock);
+      vcos_semaphore_wait(&writer->space);
+      vcos_mutex_lock(&writer->lock);
+   }
+   vcos_mutex_unlock(&writer->lock);
+}
+
+/// Nonzero once a write has failed
+int raspiwriter_failed(RASPIWRITER_T *writer)
+{
+   int failed;
+
+   vcos_mutex_lock(&writer->lock);
+   failed = writer->failed;
+   vcos_mutex_unlock(&writer->lock);
+   return failed;
+}
+
+void raspiwriter_get_stats(RASPIWRITER_T *writer, RASPIWRITER_STATS_T *stats)
+{
+   vcos_mutex_lock(&writer->lock);
+   *stats = writer->stats;
+   vcos_mutex_unlock(&writer->lock);
+}
@@ -0,0 +1,70 @@
+#ifndef RASPIWRITER_H_
+#define RASPIWRITER_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * Asynchronous writer for the encoder output.
+ *
+ * The encoder callback copies buffer data into a staging ring and returns
+ * the buffer to the encoder right away. A writer thread drains the ring,
+ * merging consecutive data for the same file into single writes, and
+ * handles segment rollover so that opening and closing files never blocks
+ * the MMAL callback thread.
+ *
+ * When storage cannot keep up the staging ring fills and whole buffers
+ * are dropped, so the encoder and the camera never wait for the storage.
+ * Dropped buffers are counted in the statistics. With
+ * raspiwriter_set_blocking the callback waits for space instead, and those
+ * stalls are counted.
+ */
+typedef struct RASPIWRITER_S RASPIWRITER_T;
+
+/// Output streams of the writer
+typedef enum
+{
+   RASPIWRITER_VIDEO = 0,           /// Encoded video
+   RASPIWRITER_IMV,                 /// Inline motion vectors
+   RASPIWRITER_PTS,                 /// Timestamps text file
+   RASPIWRITER_STREAMS
+} RASPIWRITER_STREAM_T;
+
+/**
+ * Called from the writer thread on segment rollover to open the new file
+ * for a stream. Returns NULL to keep writing to the current file.
+ */
+typedef FILE *(*RASPIWRITER_OPEN_FN_T)(void *userdata, RASPIWRITER_STREAM_T stream, int segment);
+
+typedef struct
+{
+   uint64_t bytes;                  /// Bytes written
+   uint64_t writes;                 /// Write calls, after merging
+   uint64_t jobs;                   /// Buffers queued by the callback
+   int high_water;                  /// Most bytes waiting in the staging ring
+   int stalls;                      /// Times the callback had to wait for space, blocking only
+   uint64_t stall_us;               /// Total time the callback waited
+   int dropped;                     /// Buffers dropped because the ring was full
+   uint64_t dropped_bytes;          /// Bytes of the dropped buffers
+   uint32_t max_write_us;           /// Slowest single write
+   int segments;                    /// Segment files opened by the writer thread
+} RASPIWRITER_STATS_T;
+
+RASPIWRITER_T *raspiwriter_create(int size, RASPIWRITER_OPEN_FN_T open_fn, void *userdata);
+void raspiwriter_destroy(RASPIWRITER_T *writer);
+
+void raspiwriter_set_file(RASPIWRITER_T *writer, RASPIWRITER_STREAM_T stream, FILE *file);
+FILE *raspiwriter_get_file(RASPIWRITER_T *writer, RASPIWRITER_STREAM_T stream);
+void raspiwriter_set_prealloc(RASPIWRITER_T *writer, int64_t bytes);
+void raspiwriter_set_flush(RASPIWRITER_T *writer, int flush);
+void raspiwriter_set_blocking(RASPIWRITER_T *writer, int blocking);
+
+int raspiwriter_write(RASPIWRITER_T *writer, RASPIWRITER_STREAM_T stream, const void *data, int length);
+int raspiwriter_split(RASPIWRITER_T *writer, int segment);
+void raspiwriter_skip(RASPIWRITER_T *writer, int length);
+void raspiwriter_drain(RASPIWRITER_T *writer);
+
+int raspiwriter_failed(RASPIWRITER_T *writer);
+void raspiwriter_get_stats(RASPIWRITER_T *writer, RASPIWRITER_STATS_T *stats);
+
+#endif
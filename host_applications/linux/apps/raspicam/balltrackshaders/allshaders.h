@@ -0,0 +1,1121 @@
+// This file was autogenerated. See Makefile for details.
+unsigned char diff_frag[] = {
+  0x23, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x47,
+  0x4c, 0x5f, 0x4f, 0x45, 0x53, 0x5f, 0x45, 0x47, 0x4c, 0x5f, 0x69, 0x6d,
+  0x61, 0x67, 0x65, 0x5f, 0x65, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c,
+  0x20, 0x3a, 0x20, 0x72, 0x65, 0x71, 0x75, 0x69, 0x72, 0x65, 0x0a, 0x70,
+  0x72, 0x65, 0x63, 0x69, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x6d, 0x65, 0x64,
+  0x69, 0x75, 0x6d, 0x70, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x3b, 0x0a,
+  0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d, 0x70,
+  0x6c, 0x65, 0x72, 0x45, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c, 0x4f,
+  0x45, 0x53, 0x20, 0x74, 0x65, 0x78, 0x31, 0x3b, 0x0a, 0x75, 0x6e, 0x69,
+  0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72,
+  0x32, 0x44, 0x20, 0x74, 0x65, 0x78, 0x32, 0x3b, 0x0a, 0x76, 0x61, 0x72,
+  0x79, 0x69, 0x6e, 0x67, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20, 0x74, 0x65,
+  0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x0a, 0x76, 0x6f, 0x69,
+  0x64, 0x20, 0x6d, 0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f, 0x69, 0x64, 0x29,
+  0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20,
+  0x63, 0x6f, 0x6c, 0x31, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75,
+  0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x31, 0x2c, 0x20, 0x74,
+  0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x63, 0x6f, 0x6c, 0x32, 0x20,
+  0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28,
+  0x74, 0x65, 0x78, 0x32, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f,
+  0x72, 0x64, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63,
+  0x34, 0x20, 0x64, 0x69, 0x66, 0x66, 0x20, 0x3d, 0x20, 0x63, 0x6f, 0x6c,
+  0x31, 0x20, 0x2d, 0x20, 0x63, 0x6f, 0x6c, 0x32, 0x3b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x64, 0x69, 0x73, 0x74,
+  0x20, 0x3d, 0x20, 0x64, 0x6f, 0x74, 0x28, 0x64, 0x69, 0x66, 0x66, 0x2c,
+  0x20, 0x64, 0x69, 0x66, 0x66, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x69, 0x66, 0x20, 0x28, 0x64, 0x69, 0x73, 0x74, 0x20, 0x3e, 0x20, 0x30,
+  0x2e, 0x32, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c,
+  0x6f, 0x72, 0x20, 0x3d, 0x20, 0x76, 0x65, 0x63, 0x34, 0x28, 0x31, 0x2e,
+  0x30, 0x2c, 0x20, 0x31, 0x2e, 0x30, 0x2c, 0x20, 0x30, 0x2c, 0x20, 0x31,
+  0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x65,
+  0x6c, 0x73, 0x65, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c,
+  0x6f, 0x72, 0x20, 0x3d, 0x20, 0x30, 0x2e, 0x32, 0x20, 0x2a, 0x20, 0x63,
+  0x6f, 0x6c, 0x31, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f,
+  0x6c, 0x6f, 0x72, 0x2e, 0x61, 0x20, 0x3d, 0x20, 0x31, 0x2e, 0x30, 0x3b,
+  0x0a, 0x7d, 0x0a, 0x0a, 0x00
+};
+unsigned int diff_frag_len = 473;
+unsigned char display_frag[] = {
+  0x23, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x47,
+  0x4c, 0x5f, 0x4f, 0x45, 0x53, 0x5f, 0x45, 0x47, 0x4c, 0x5f, 0x69, 0x6d,
+  0x61, 0x67, 0x65, 0x5f, 0x65, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c,
+  0x20, 0x3a, 0x20, 0x72, 0x65, 0x71, 0x75, 0x69, 0x72, 0x65, 0x0a, 0x70,
+  0x72, 0x65, 0x63, 0x69, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x6d, 0x65, 0x64,
+  0x69, 0x75, 0x6d, 0x70, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x3b, 0x0a,
+  0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d, 0x70,
+  0x6c, 0x65, 0x72, 0x45, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c, 0x4f,
+  0x45, 0x53, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x63, 0x61, 0x6d, 0x65, 0x72,
+  0x61, 0x3b, 0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x76,
+  0x65, 0x63, 0x32, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74,
+  0x3b, 0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61,
+  0x6d, 0x70, 0x6c, 0x65, 0x72, 0x32, 0x44, 0x20, 0x74, 0x65, 0x78, 0x5f,
+  0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x3b, 0x0a, 0x76, 0x61, 0x72, 0x79,
+  0x69, 0x6e, 0x67, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20, 0x74, 0x65, 0x78,
+  0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x76, 0x6f, 0x69, 0x64, 0x20,
+  0x6d, 0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f, 0x69, 0x64, 0x29, 0x20, 0x7b,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x63, 0x6f,
+  0x6c, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32,
+  0x44, 0x28, 0x74, 0x65, 0x78, 0x5f, 0x63, 0x61, 0x6d, 0x65, 0x72, 0x61,
+  0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x66, 0x69,
+  0x6c, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32,
+  0x44, 0x28, 0x74, 0x65, 0x78, 0x5f, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72,
+  0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20, 0x66, 0x69, 0x6c, 0x2e,
+  0x72, 0x67, 0x20, 0x69, 0x73, 0x20, 0x72, 0x65, 0x64, 0x2f, 0x67, 0x72,
+  0x65, 0x65, 0x6e, 0x20, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x20, 0x66,
+  0x6f, 0x72, 0x20, 0x60, 0x6c, 0x65, 0x66, 0x74, 0x20, 0x70, 0x69, 0x78,
+  0x65, 0x6c, 0x27, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20, 0x66,
+  0x69, 0x6c, 0x2e, 0x62, 0x61, 0x20, 0x69, 0x73, 0x20, 0x72, 0x65, 0x64,
+  0x2f, 0x67, 0x72, 0x65, 0x65, 0x6e, 0x20, 0x66, 0x69, 0x6c, 0x74, 0x65,
+  0x72, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x60, 0x72, 0x69, 0x67, 0x68, 0x74,
+  0x20, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x27, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x72, 0x2c, 0x20, 0x67, 0x3b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x20, 0x6d, 0x6f, 0x64,
+  0x28, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x78, 0x2c,
+  0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x2e, 0x78, 0x29,
+  0x20, 0x3c, 0x20, 0x30, 0x2e, 0x35, 0x20, 0x2a, 0x20, 0x74, 0x65, 0x78,
+  0x5f, 0x75, 0x6e, 0x69, 0x74, 0x2e, 0x78, 0x20, 0x29, 0x20, 0x7b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x72, 0x20, 0x3d, 0x20,
+  0x66, 0x69, 0x6c, 0x2e, 0x72, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x67, 0x20, 0x3d, 0x20, 0x66, 0x69, 0x6c, 0x2e, 0x67,
+  0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x65, 0x6c, 0x73, 0x65,
+  0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x72,
+  0x20, 0x3d, 0x20, 0x66, 0x69, 0x6c, 0x2e, 0x62, 0x3b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x67, 0x20, 0x3d, 0x20, 0x66, 0x69,
+  0x6c, 0x2e, 0x61, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x2f, 0x2f, 0x69, 0x66, 0x20, 0x28, 0x72, 0x20, 0x3e,
+  0x20, 0x30, 0x2e, 0x33, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x2f, 0x2f, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61,
+  0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x20, 0x3d, 0x20, 0x30, 0x2e, 0x37,
+  0x20, 0x2a, 0x20, 0x63, 0x6f, 0x6c, 0x20, 0x2b, 0x20, 0x30, 0x2e, 0x33,
+  0x20, 0x2a, 0x20, 0x76, 0x65, 0x63, 0x34, 0x28, 0x31, 0x2e, 0x30, 0x2c,
+  0x20, 0x30, 0x2e, 0x30, 0x2c, 0x20, 0x31, 0x2e, 0x30, 0x2c, 0x20, 0x31,
+  0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x7d,
+  0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x69, 0x66, 0x20, 0x28, 0x67, 0x20,
+  0x3e, 0x20, 0x30, 0x2e, 0x37, 0x35, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x2f, 0x2f, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46,
+  0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x20, 0x3d, 0x20, 0x30,
+  0x2e, 0x39, 0x20, 0x2a, 0x20, 0x63, 0x6f, 0x6c, 0x20, 0x2b, 0x20, 0x30,
+  0x2e, 0x31, 0x20, 0x2a, 0x20, 0x76, 0x65, 0x63, 0x34, 0x28, 0x30, 0x2e,
+  0x30, 0x2c, 0x20, 0x31, 0x2e, 0x30, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x2c,
+  0x20, 0x31, 0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f,
+  0x2f, 0x7d, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x7b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x2f, 0x2f, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46,
+  0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x20, 0x3d, 0x20, 0x63,
+  0x6f, 0x6c, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x7d, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61,
+  0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x20, 0x3d, 0x20, 0x30, 0x2e, 0x33,
+  0x20, 0x2a, 0x20, 0x63, 0x6f, 0x6c, 0x20, 0x2b, 0x20, 0x30, 0x2e, 0x37,
+  0x20, 0x2a, 0x20, 0x76, 0x65, 0x63, 0x34, 0x28, 0x72, 0x2c, 0x72, 0x2c,
+  0x72, 0x2c, 0x31, 0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72,
+  0x20, 0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x3b, 0x0a, 0x7d, 0x0a, 0x00
+};
+unsigned int display_frag_len = 899;
+unsigned char fixedcolor_frag[] = {
+  0x70, 0x72, 0x65, 0x63, 0x69, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x6d, 0x65,
+  0x64, 0x69, 0x75, 0x6d, 0x70, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x3b,
+  0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x76, 0x65, 0x63,
+  0x34, 0x20, 0x63, 0x6f, 0x6c, 0x3b, 0x0a, 0x76, 0x61, 0x72, 0x79, 0x69,
+  0x6e, 0x67, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20, 0x74, 0x65, 0x78, 0x63,
+  0x6f, 0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x6d,
+  0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f, 0x69, 0x64, 0x29, 0x20, 0x7b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43,
+  0x6f, 0x6c, 0x6f, 0x72, 0x20, 0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x3b, 0x0a,
+  0x7d, 0x0a, 0x00
+};
+unsigned int fixedcolor_frag_len = 111;
+unsigned char phase1_frag[] = {
+  0x2f, 0x2f, 0x20, 0x54, 0x68, 0x65, 0x20, 0x6f, 0x75, 0x74, 0x70, 0x75,
+  0x74, 0x20, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x20, 0x63, 0x6f, 0x6f, 0x72,
+  0x64, 0x69, 0x6e, 0x61, 0x74, 0x65, 0x20, 0x28, 0x3d, 0x74, 0x65, 0x78,
+  0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x20, 0x69, 0x73, 0x20, 0x61, 0x6c,
+  0x77, 0x61, 0x79, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63, 0x65, 0x6e,
+  0x74, 0x65, 0x72, 0x20, 0x6f, 0x66, 0x20, 0x61, 0x6e, 0x20, 0x6f, 0x75,
+  0x74, 0x70, 0x75, 0x74, 0x20, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x2e, 0x0a,
+  0x0a, 0x2f, 0x2f, 0x20, 0x42, 0x61, 0x6c, 0x6c, 0x74, 0x72, 0x61, 0x63,
+  0x6b, 0x20, 0x73, 0x68, 0x61, 0x64, 0x65, 0x72, 0x20, 0x66, 0x69, 0x72,
+  0x73, 0x74, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x0a, 0x2f, 0x2f, 0x20,
+  0x54, 0x6f, 0x20, 0x70, 0x61, 0x63, 0x6b, 0x20, 0x74, 0x6f, 0x20, 0x70,
+  0x61, 0x69, 0x72, 0x73, 0x20, 0x69, 0x6e, 0x74, 0x6f, 0x20, 0x61, 0x6e,
+  0x20, 0x52, 0x47, 0x42, 0x41, 0x20, 0x77, 0x65, 0x20, 0x68, 0x61, 0x76,
+  0x65, 0x20, 0x69, 0x6e, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x2d, 0x64,
+  0x69, 0x72, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x3a, 0x0a, 0x2f, 0x2f,
+  0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3a, 0x30, 0x20,
+  0x20, 0x31, 0x20, 0x20, 0x32, 0x20, 0x20, 0x33, 0x20, 0x20, 0x34, 0x0a,
+  0x2f, 0x2f, 0x20, 0x49, 0x6e, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20,
+  0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d,
+  0x7c, 0x20, 0x20, 0x65, 0x61, 0x63, 0x68, 0x20, 0x69, 0x73, 0x20, 0x73,
+  0x69, 0x7a, 0x65, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74,
+  0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64,
+  0x3a, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+  0x73, 0x3a, 0x20, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d,
+  0x2a, 0x2d, 0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x4f, 0x75, 0x74, 0x70,
+  0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x52, 0x47, 0x20, 0x20, 0x20,
+  0x20, 0x42, 0x41, 0x0a, 0x2f, 0x2f, 0x20, 0x46, 0x6f, 0x72, 0x20, 0x74,
+  0x68, 0x65, 0x20, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x64, 0x69,
+  0x72, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x69, 0x74, 0x20, 0x69,
+  0x73, 0x20, 0x73, 0x69, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x3a, 0x0a, 0x2f,
+  0x2f, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3a, 0x30,
+  0x20, 0x20, 0x31, 0x20, 0x20, 0x32, 0x0a, 0x2f, 0x2f, 0x20, 0x49, 0x6e,
+  0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f,
+  0x72, 0x64, 0x3a, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x0a, 0x2f,
+  0x2f, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x3a, 0x20, 0x7c,
+  0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x0a, 0x0a, 0x2f, 0x2f, 0x20, 0x42,
+  0x61, 0x6c, 0x6c, 0x20, 0x68, 0x75, 0x65, 0x20, 0x6c, 0x6f, 0x77, 0x65,
+  0x72, 0x20, 0x62, 0x6f, 0x75, 0x6e, 0x64, 0x20, 0x69, 0x73, 0x20, 0x69,
+  0x6d, 0x70, 0x6f, 0x72, 0x74, 0x61, 0x6e, 0x74, 0x20, 0x74, 0x6f, 0x20,
+  0x64, 0x69, 0x73, 0x74, 0x69, 0x6e, 0x67, 0x75, 0x69, 0x73, 0x68, 0x20,
+  0x66, 0x72, 0x6f, 0x6d, 0x20, 0x72, 0x65, 0x64, 0x20, 0x70, 0x6c, 0x61,
+  0x79, 0x65, 0x72, 0x73, 0x0a, 0x2f, 0x2f, 0x20, 0x42, 0x61, 0x6c, 0x6c,
+  0x20, 0x73, 0x61, 0x74, 0x20, 0x6c, 0x6f, 0x77, 0x65, 0x72, 0x20, 0x62,
+  0x6f, 0x75, 0x6e, 0x64, 0x20, 0x69, 0x73, 0x20, 0x69, 0x6d, 0x70, 0x6f,
+  0x72, 0x74, 0x61, 0x6e, 0x74, 0x20, 0x74, 0x6f, 0x20, 0x64, 0x69, 0x73,
+  0x74, 0x69, 0x6e, 0x67, 0x75, 0x69, 0x73, 0x68, 0x20, 0x69, 0x74, 0x20,
+  0x66, 0x72, 0x6f, 0x6d, 0x20, 0x70, 0x75, 0x72, 0x65, 0x20, 0x77, 0x68,
+  0x69, 0x74, 0x65, 0x0a, 0x2f, 0x2f, 0x0a, 0x2f, 0x2f, 0x20, 0x54, 0x68,
+  0x65, 0x73, 0x65, 0x20, 0x28, 0x48, 0x75, 0x65, 0x2c, 0x53, 0x61, 0x74,
+  0x75, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x2c, 0x56, 0x61, 0x6c, 0x75,
+  0x65, 0x29, 0x20, 0x74, 0x75, 0x70, 0x6c, 0x65, 0x73, 0x20, 0x61, 0x72,
+  0x65, 0x20, 0x61, 0x6c, 0x6c, 0x20, 0x69, 0x6e, 0x20, 0x72, 0x61, 0x6e,
+  0x67, 0x65, 0x20, 0x5b, 0x30, 0x2d, 0x33, 0x36, 0x30, 0x5d, 0x78, 0x5b,
+  0x30, 0x2c, 0x31, 0x30, 0x30, 0x5d, 0x78, 0x5b, 0x30, 0x2c, 0x31, 0x30,
+  0x30, 0x5d, 0x0a, 0x2f, 0x2f, 0x20, 0x54, 0x68, 0x69, 0x73, 0x20, 0x69,
+  0x73, 0x20, 0x61, 0x6c, 0x6c, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x76,
+  0x69, 0x64, 0x65, 0x6f, 0x2e, 0x20, 0x4e, 0x6f, 0x74, 0x20, 0x61, 0x6c,
+  0x77, 0x61, 0x79, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x61, 0x6d,
+  0x65, 0x20, 0x61, 0x73, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x63, 0x61,
+  0x6d, 0x65, 0x72, 0x61, 0x2e, 0x0a, 0x2f, 0x2f, 0x20, 0x4e, 0x6f, 0x72,
+  0x6d, 0x61, 0x6c, 0x20, 0x62, 0x61, 0x6c, 0x6c, 0x3a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x31,
+  0x36, 0x2d, 0x32, 0x30, 0x2c, 0x20, 0x35, 0x30, 0x2d, 0x37, 0x30, 0x2c,
+  0x20, 0x37, 0x30, 0x2d, 0x38, 0x30, 0x29, 0x0a, 0x2f, 0x2f, 0x20, 0x46,
+  0x61, 0x73, 0x74, 0x20, 0x62, 0x6c, 0x75, 0x72, 0x20, 0x62, 0x61, 0x6c,
+  0x6c, 0x20, 0x69, 0x6e, 0x20, 0x6c, 0x69, 0x67, 0x68, 0x74, 0x3a, 0x20,
+  0x28, 0x3f, 0x2d, 0x36, 0x30, 0x20, 0x2c, 0x20, 0x31, 0x35, 0x2b, 0x20,
+  0x20, 0x2c, 0x20, 0x35, 0x30, 0x2b, 0x29, 0x0a, 0x2f, 0x2f, 0x20, 0x42,
+  0x61, 0x6c, 0x6c, 0x20, 0x69, 0x6e, 0x20, 0x67, 0x6f, 0x61, 0x6c, 0x3a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x28, 0x31, 0x37, 0x2d, 0x33, 0x30, 0x2c, 0x20, 0x36, 0x30, 0x2d, 0x38,
+  0x30, 0x2c, 0x20, 0x33, 0x30, 0x2d, 0x35, 0x30, 0x29, 0x0a, 0x2f, 0x2f,
+  0x20, 0x42, 0x61, 0x6c, 0x6c, 0x20, 0x69, 0x6e, 0x20, 0x67, 0x6f, 0x61,
+  0x6c, 0x20, 0x64, 0x61, 0x72, 0x6b, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x28, 0x31, 0x36, 0x2d, 0x32, 0x34, 0x2c, 0x20, 0x37, 0x35,
+  0x2d, 0x39, 0x35, 0x2c, 0x20, 0x31, 0x34, 0x2d, 0x32, 0x31, 0x29, 0x20,
+  0x6c, 0x6f, 0x77, 0x20, 0x56, 0x61, 0x6c, 0x75, 0x65, 0x21, 0x0a, 0x2f,
+  0x2f, 0x20, 0x42, 0x61, 0x6c, 0x6c, 0x20, 0x6f, 0x6e, 0x20, 0x77, 0x68,
+  0x69, 0x74, 0x65, 0x20, 0x63, 0x6f, 0x72, 0x6e, 0x65, 0x72, 0x3a, 0x20,
+  0x20, 0x20, 0x20, 0x28, 0x20, 0x39, 0x2d, 0x31, 0x32, 0x2c, 0x20, 0x36,
+  0x35, 0x2d, 0x38, 0x35, 0x2c, 0x20, 0x34, 0x30, 0x2d, 0x35, 0x35, 0x29,
+  0x0a, 0x2f, 0x2f, 0x20, 0x52, 0x65, 0x64, 0x20, 0x70, 0x6c, 0x61, 0x79,
+  0x65, 0x72, 0x20, 0x65, 0x64, 0x67, 0x65, 0x73, 0x3a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x3f, 0x2d, 0x31, 0x35, 0x20, 0x2c,
+  0x20, 0x35, 0x30, 0x2d, 0x37, 0x30, 0x2c, 0x20, 0x33, 0x35, 0x2d, 0x35,
+  0x34, 0x29, 0x0a, 0x2f, 0x2f, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x34, 0x37, 0x20, 0x20,
+  0x20, 0x2c, 0x20, 0x34, 0x32, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x33, 0x31,
+  0x29, 0x0a, 0x2f, 0x2f, 0x20, 0x52, 0x65, 0x64, 0x20, 0x70, 0x6c, 0x61,
+  0x79, 0x65, 0x72, 0x20, 0x73, 0x70, 0x69, 0x6e, 0x6e, 0x69, 0x6e, 0x67,
+  0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x20, 0x32, 0x35, 0x20, 0x20,
+  0x2c, 0x20, 0x35, 0x30, 0x20, 0x20, 0x20, 0x2c, 0x20, 0x35, 0x30, 0x29,
+  0x20, 0x20, 0x20, 0x3a, 0x28, 0x0a, 0x2f, 0x2f, 0x0a, 0x2f, 0x2f, 0x20,
+  0x46, 0x6f, 0x72, 0x20, 0x74, 0x68, 0x65, 0x20, 0x72, 0x65, 0x70, 0x6c,
+  0x61, 0x79, 0x20, 0x76, 0x69, 0x64, 0x65, 0x6f, 0x2c, 0x20, 0x73, 0x65,
+  0x70, 0x65, 0x72, 0x61, 0x74, 0x69, 0x6e, 0x67, 0x20, 0x74, 0x68, 0x65,
+  0x20, 0x48, 0x75, 0x65, 0x20, 0x61, 0x73, 0x20, 0x20, 0x30, 0x2e, 0x31,
+  0x38, 0x20, 0x3c, 0x20, 0x6e, 0x65, 0x75, 0x74, 0x72, 0x61, 0x6c, 0x20,
+  0x3c, 0x20, 0x30, 0x2e, 0x32, 0x35, 0x20, 0x69, 0x73, 0x20, 0x66, 0x69,
+  0x6e, 0x65, 0x2e, 0x0a, 0x2f, 0x2f, 0x20, 0x46, 0x6f, 0x72, 0x20, 0x74,
+  0x68, 0x65, 0x20, 0x63, 0x61, 0x6d, 0x65, 0x72, 0x61, 0x2c, 0x20, 0x74,
+  0x68, 0x65, 0x20, 0x62, 0x6f, 0x75, 0x6e, 0x64, 0x20, 0x68, 0x61, 0x73,
+  0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x6d, 0x75, 0x63, 0x68, 0x20,
+  0x6c, 0x6f, 0x77, 0x65, 0x72, 0x2e, 0x20, 0x4c, 0x69, 0x6b, 0x65, 0x20,
+  0x20, 0x30, 0x2e, 0x30, 0x36, 0x20, 0x3c, 0x20, 0x6e, 0x65, 0x75, 0x74,
+  0x72, 0x61, 0x6c, 0x20, 0x3c, 0x20, 0x30, 0x2e, 0x31, 0x34, 0x0a, 0x2f,
+  0x2f, 0x0a, 0x2f, 0x2f, 0x20, 0x59, 0x65, 0x6c, 0x6c, 0x6f, 0x77, 0x20,
+  0x62, 0x61, 0x6c, 0x6c, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x76, 0x69,
+  0x64, 0x65, 0x6f, 0x3a, 0x20, 0x28, 0x34, 0x35, 0x2d, 0x36, 0x30, 0x2c,
+  0x20, 0x35, 0x30, 0x2d, 0x37, 0x30, 0x2c, 0x20, 0x35, 0x30, 0x2d, 0x38,
+  0x30, 0x29, 0x0a, 0x2f, 0x2f, 0x20, 0x59, 0x65, 0x6c, 0x6c, 0x6f, 0x77,
+  0x20, 0x62, 0x61, 0x6c, 0x6c, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x66,
+  0x72, 0x61, 0x6d, 0x65, 0x64, 0x75, 0x6d, 0x70, 0x3a, 0x20, 0x28, 0x35,
+  0x30, 0x2c, 0x35, 0x33, 0x2c, 0x38, 0x34, 0x29, 0x0a, 0x2f, 0x2f, 0x20,
+  0x59, 0x65, 0x6c, 0x6c, 0x6f, 0x77, 0x20, 0x62, 0x61, 0x6c, 0x6c, 0x20,
+  0x66, 0x72, 0x6f, 0x6d, 0x20, 0x66, 0x72, 0x61, 0x6d, 0x65, 0x64, 0x75,
+  0x6d, 0x70, 0x20, 0x6e, 0x65, 0x61, 0x72, 0x20, 0x64, 0x61, 0x72, 0x6b,
+  0x20, 0x67, 0x6f, 0x61, 0x6c, 0x3a, 0x20, 0x28, 0x34, 0x38, 0x2d, 0x35,
+  0x33, 0x2c, 0x20, 0x35, 0x30, 0x2d, 0x36, 0x35, 0x2c, 0x20, 0x32, 0x32,
+  0x2d, 0x33, 0x37, 0x29, 0x0a, 0x2f, 0x2f, 0x0a, 0x2f, 0x2f, 0x20, 0x46,
+  0x69, 0x65, 0x6c, 0x64, 0x3a, 0x20, 0x28, 0x31, 0x32, 0x35, 0x2d, 0x31,
+  0x37, 0x35, 0x2c, 0x20, 0x31, 0x35, 0x2d, 0x37, 0x35, 0x2c, 0x20, 0x31,
+  0x33, 0x2d, 0x37, 0x30, 0x29, 0x0a, 0x2f, 0x2f, 0x20, 0x52, 0x65, 0x73,
+  0x63, 0x61, 0x6c, 0x69, 0x6e, 0x67, 0x20, 0x74, 0x61, 0x62, 0x6c, 0x65,
+  0x0a, 0x2f, 0x2f, 0x20, 0x48, 0x75, 0x65, 0x20, 0x5b, 0x30, 0x2d, 0x33,
+  0x36, 0x30, 0x5d, 0x20, 0x3a, 0x20, 0x34, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x36, 0x20, 0x20, 0x20, 0x20, 0x37, 0x20, 0x20, 0x20, 0x20, 0x20, 0x38,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x39, 0x20, 0x20, 0x20, 0x20, 0x20, 0x31,
+  0x30, 0x20, 0x20, 0x20, 0x20, 0x31, 0x31, 0x20, 0x20, 0x20, 0x20, 0x31,
+  0x32, 0x20, 0x20, 0x20, 0x31, 0x34, 0x20, 0x20, 0x20, 0x20, 0x31, 0x35,
+  0x20, 0x20, 0x20, 0x20, 0x31, 0x36, 0x20, 0x20, 0x20, 0x20, 0x31, 0x37,
+  0x20, 0x20, 0x20, 0x20, 0x31, 0x38, 0x20, 0x20, 0x20, 0x34, 0x35, 0x0a,
+  0x2f, 0x2f, 0x20, 0x48, 0x75, 0x65, 0x20, 0x5b, 0x30, 0x2d, 0x36, 0x5d,
+  0x20, 0x20, 0x20, 0x3a, 0x20, 0x30, 0x2e, 0x30, 0x36, 0x37, 0x20, 0x30,
+  0x2e, 0x31, 0x30, 0x20, 0x30, 0x2e, 0x31, 0x31, 0x37, 0x20, 0x30, 0x2e,
+  0x31, 0x33, 0x33, 0x20, 0x30, 0x2e, 0x31, 0x35, 0x30, 0x20, 0x30, 0x2e,
+  0x31, 0x36, 0x37, 0x20, 0x30, 0x2e, 0x31, 0x38, 0x33, 0x20, 0x30, 0x2e,
+  0x32, 0x30, 0x20, 0x30, 0x2e, 0x32, 0x33, 0x33, 0x20, 0x30, 0x2e, 0x32,
+  0x35, 0x30, 0x20, 0x30, 0x2e, 0x32, 0x36, 0x37, 0x20, 0x30, 0x2e, 0x32,
+  0x38, 0x33, 0x20, 0x30, 0x2e, 0x33, 0x30, 0x20, 0x30, 0x2e, 0x37, 0x35,
+  0x0a, 0x23, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x73, 0x69, 0x6f, 0x6e, 0x20,
+  0x47, 0x4c, 0x5f, 0x4f, 0x45, 0x53, 0x5f, 0x45, 0x47, 0x4c, 0x5f, 0x69,
+  0x6d, 0x61, 0x67, 0x65, 0x5f, 0x65, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61,
+  0x6c, 0x20, 0x3a, 0x20, 0x72, 0x65, 0x71, 0x75, 0x69, 0x72, 0x65, 0x0a,
+  0x70, 0x72, 0x65, 0x63, 0x69, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x6d, 0x65,
+  0x64, 0x69, 0x75, 0x6d, 0x70, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x3b,
+  0x0a, 0x0a, 0x76, 0x65, 0x63, 0x32, 0x20, 0x67, 0x65, 0x74, 0x46, 0x69,
+  0x6c, 0x74, 0x65, 0x72, 0x28, 0x76, 0x65, 0x63, 0x34, 0x20, 0x63, 0x6f,
+  0x6c, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20,
+  0x57, 0x65, 0x20, 0x75, 0x73, 0x65, 0x20, 0x61, 0x20, 0x70, 0x69, 0x65,
+  0x63, 0x65, 0x77, 0x69, 0x73, 0x65, 0x20, 0x64, 0x65, 0x66, 0x69, 0x6e,
+  0x69, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x48, 0x75,
+  0x65, 0x2e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20, 0x57, 0x65,
+  0x20, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x75, 0x74,
+  0x65, 0x20, 0x74, 0x77, 0x6f, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65,
+  0x20, 0x74, 0x68, 0x72, 0x65, 0x65, 0x20, 0x70, 0x61, 0x72, 0x74, 0x73,
+  0x2e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20, 0x54, 0x68, 0x65,
+  0x20, 0x60, 0x72, 0x65, 0x64, 0x20, 0x70, 0x69, 0x65, 0x63, 0x65, 0x27,
+  0x20, 0x6c, 0x69, 0x65, 0x73, 0x20, 0x69, 0x6e, 0x20, 0x5b, 0x2d, 0x31,
+  0x2c, 0x31, 0x5d, 0x2e, 0x20, 0x54, 0x68, 0x65, 0x20, 0x67, 0x72, 0x65,
+  0x65, 0x6e, 0x20, 0x69, 0x6e, 0x20, 0x5b, 0x31, 0x2c, 0x33, 0x5d, 0x2e,
+  0x20, 0x54, 0x68, 0x65, 0x20, 0x62, 0x6c, 0x75, 0x65, 0x20, 0x69, 0x6e,
+  0x20, 0x5b, 0x33, 0x2c, 0x35, 0x5d, 0x2e, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x2f, 0x2f, 0x20, 0x4d, 0x75, 0x6c, 0x74, 0x69, 0x70, 0x6c, 0x79, 0x20,
+  0x62, 0x79, 0x20, 0x36, 0x30, 0x20, 0x74, 0x6f, 0x20, 0x67, 0x65, 0x74,
+  0x20, 0x64, 0x65, 0x67, 0x72, 0x65, 0x65, 0x73, 0x2e, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x76, 0x61, 0x6c, 0x75,
+  0x65, 0x20, 0x3d, 0x20, 0x6d, 0x61, 0x78, 0x28, 0x63, 0x6f, 0x6c, 0x2e,
+  0x72, 0x2c, 0x20, 0x6d, 0x61, 0x78, 0x28, 0x63, 0x6f, 0x6c, 0x2e, 0x67,
+  0x2c, 0x20, 0x63, 0x6f, 0x6c, 0x2e, 0x62, 0x29, 0x29, 0x3b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x63, 0x68, 0x72,
+  0x6f, 0x6d, 0x61, 0x3d, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x2d,
+  0x20, 0x6d, 0x69, 0x6e, 0x28, 0x63, 0x6f, 0x6c, 0x2e, 0x72, 0x2c, 0x20,
+  0x6d, 0x69, 0x6e, 0x28, 0x63, 0x6f, 0x6c, 0x2e, 0x67, 0x2c, 0x20, 0x63,
+  0x6f, 0x6c, 0x2e, 0x62, 0x29, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x73, 0x61, 0x74, 0x20, 0x3d, 0x20,
+  0x28, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x3e, 0x20, 0x30, 0x2e, 0x30,
+  0x20, 0x3f, 0x20, 0x28, 0x63, 0x68, 0x72, 0x6f, 0x6d, 0x61, 0x20, 0x2f,
+  0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x29, 0x20, 0x3a, 0x20, 0x30, 0x2e,
+  0x30, 0x29, 0x3b, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f,
+  0x61, 0x74, 0x20, 0x62, 0x61, 0x6c, 0x6c, 0x66, 0x69, 0x6c, 0x74, 0x65,
+  0x72, 0x20, 0x3d, 0x20, 0x30, 0x2e, 0x30, 0x3b, 0x20, 0x2f, 0x2f, 0x20,
+  0x30, 0x2e, 0x38, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f,
+  0x61, 0x74, 0x20, 0x67, 0x72, 0x65, 0x65, 0x6e, 0x66, 0x69, 0x6c, 0x74,
+  0x65, 0x72, 0x20, 0x3d, 0x20, 0x30, 0x2e, 0x30, 0x3b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x63, 0x6f, 0x6c, 0x2e, 0x72, 0x20,
+  0x3d, 0x3d, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x29, 0x20, 0x7b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28,
+  0x73, 0x61, 0x74, 0x20, 0x3e, 0x20, 0x30, 0x2e, 0x33, 0x35, 0x20, 0x26,
+  0x26, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x3e, 0x20, 0x30, 0x2e,
+  0x31, 0x35, 0x20, 0x26, 0x26, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20,
+  0x3c, 0x20, 0x30, 0x2e, 0x39, 0x35, 0x20, 0x29, 0x20, 0x7b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66,
+  0x6c, 0x6f, 0x61, 0x74, 0x20, 0x68, 0x75, 0x65, 0x20, 0x3d, 0x20, 0x28,
+  0x63, 0x6f, 0x6c, 0x2e, 0x67, 0x20, 0x2d, 0x20, 0x63, 0x6f, 0x6c, 0x2e,
+  0x62, 0x29, 0x20, 0x2f, 0x20, 0x63, 0x68, 0x72, 0x6f, 0x6d, 0x61, 0x3b,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x2f, 0x2f, 0x20, 0x48, 0x75, 0x65, 0x20, 0x75, 0x70, 0x70, 0x65,
+  0x72, 0x20, 0x62, 0x6f, 0x75, 0x6e, 0x64, 0x20, 0x6f, 0x66, 0x20, 0x31,
+  0x2e, 0x30, 0x20, 0x69, 0x73, 0x20, 0x61, 0x75, 0x74, 0x6f, 0x6d, 0x61,
+  0x74, 0x69, 0x63, 0x2e, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x68, 0x75, 0x65,
+  0x20, 0x3e, 0x20, 0x30, 0x2e, 0x37, 0x30, 0x29, 0x20, 0x7b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x62, 0x61, 0x6c, 0x6c, 0x66, 0x69, 0x6c, 0x74, 0x65,
+  0x72, 0x20, 0x3d, 0x20, 0x31, 0x2e, 0x30, 0x3b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2f,
+  0x2f, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x69, 0x66, 0x20, 0x28, 0x68, 0x75,
+  0x65, 0x20, 0x3c, 0x20, 0x30, 0x2e, 0x33, 0x30, 0x29, 0x20, 0x7b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x2f, 0x2f, 0x20, 0x20, 0x20, 0x20, 0x62, 0x61, 0x6c, 0x6c, 0x66, 0x69,
+  0x6c, 0x74, 0x65, 0x72, 0x20, 0x3d, 0x20, 0x30, 0x2e, 0x30, 0x3b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x2f, 0x2f, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x65, 0x6c, 0x73, 0x65,
+  0x20, 0x69, 0x66, 0x20, 0x28, 0x63, 0x6f, 0x6c, 0x2e, 0x67, 0x20, 0x3d,
+  0x3d, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x29, 0x20, 0x7b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74,
+  0x20, 0x68, 0x75, 0x65, 0x20, 0x3d, 0x20, 0x28, 0x63, 0x6f, 0x6c, 0x2e,
+  0x62, 0x20, 0x2d, 0x20, 0x63, 0x6f, 0x6c, 0x2e, 0x72, 0x29, 0x20, 0x2f,
+  0x20, 0x63, 0x68, 0x72, 0x6f, 0x6d, 0x61, 0x3b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x68, 0x75, 0x65,
+  0x20, 0x3e, 0x20, 0x30, 0x2e, 0x30, 0x20, 0x26, 0x26, 0x20, 0x68, 0x75,
+  0x65, 0x20, 0x3c, 0x20, 0x30, 0x2e, 0x39, 0x20, 0x26, 0x26, 0x20, 0x73,
+  0x61, 0x74, 0x20, 0x3e, 0x20, 0x30, 0x2e, 0x31, 0x35, 0x20, 0x26, 0x26,
+  0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x3e, 0x20, 0x30, 0x2e, 0x31,
+  0x30, 0x20, 0x26, 0x26, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x3c,
+  0x20, 0x30, 0x2e, 0x37, 0x30, 0x20, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x67, 0x72, 0x65,
+  0x65, 0x6e, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x20, 0x3d, 0x20, 0x31,
+  0x2e, 0x30, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x76, 0x65, 0x63, 0x32, 0x28,
+  0x62, 0x61, 0x6c, 0x6c, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x2c, 0x20,
+  0x67, 0x72, 0x65, 0x65, 0x6e, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x29,
+  0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d,
+  0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x45, 0x78, 0x74, 0x65,
+  0x72, 0x6e, 0x61, 0x6c, 0x4f, 0x45, 0x53, 0x20, 0x74, 0x65, 0x78, 0x3b,
+  0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x76, 0x65, 0x63,
+  0x32, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3b, 0x0a,
+  0x76, 0x61, 0x72, 0x79, 0x69, 0x6e, 0x67, 0x20, 0x76, 0x65, 0x63, 0x32,
+  0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x76,
+  0x6f, 0x69, 0x64, 0x20, 0x6d, 0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f, 0x69,
+  0x64, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63,
+  0x34, 0x20, 0x63, 0x6f, 0x6c, 0x31, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78,
+  0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x2c, 0x20,
+  0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x2d, 0x20, 0x76,
+  0x65, 0x63, 0x32, 0x28, 0x31, 0x2c, 0x30, 0x29, 0x20, 0x2a, 0x20, 0x74,
+  0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x29, 0x3b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x63, 0x6f, 0x6c, 0x32, 0x20,
+  0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28,
+  0x74, 0x65, 0x78, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72,
+  0x64, 0x20, 0x2b, 0x20, 0x76, 0x65, 0x63, 0x32, 0x28, 0x31, 0x2c, 0x30,
+  0x29, 0x20, 0x2a, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74,
+  0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72,
+  0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x72, 0x67, 0x20, 0x3d,
+  0x20, 0x67, 0x65, 0x74, 0x46, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x28, 0x63,
+  0x6f, 0x6c, 0x31, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c,
+  0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x62,
+  0x61, 0x20, 0x3d, 0x20, 0x67, 0x65, 0x74, 0x46, 0x69, 0x6c, 0x74, 0x65,
+  0x72, 0x28, 0x63, 0x6f, 0x6c, 0x32, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x00
+};
+unsigned int phase1_frag_len = 3180;
+unsigned char phase2_frag[] = {
+  0x2f, 0x2f, 0x20, 0x42, 0x61, 0x6c, 0x6c, 0x74, 0x72, 0x61, 0x63, 0x6b,
+  0x20, 0x73, 0x68, 0x61, 0x64, 0x65, 0x72, 0x20, 0x73, 0x65, 0x63, 0x6f,
+  0x6e, 0x64, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x0a, 0x2f, 0x2f, 0x20,
+  0x4f, 0x75, 0x70, 0x75, 0x74, 0x20, 0x69, 0x73, 0x20, 0x38, 0x58, 0x20,
+  0x73, 0x6d, 0x61, 0x6c, 0x6c, 0x65, 0x72, 0x20, 0x69, 0x6e, 0x20, 0x62,
+  0x6f, 0x74, 0x68, 0x20, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x69, 0x6f,
+  0x6e, 0x73, 0x21, 0x0a, 0x2f, 0x2f, 0x20, 0x57, 0x65, 0x20, 0x77, 0x69,
+  0x6c, 0x6c, 0x20, 0x75, 0x73, 0x65, 0x20, 0x47, 0x4c, 0x5f, 0x4c, 0x49,
+  0x4e, 0x45, 0x41, 0x52, 0x20, 0x73, 0x6f, 0x20, 0x74, 0x68, 0x61, 0x74,
+  0x20, 0x74, 0x68, 0x65, 0x20, 0x47, 0x50, 0x55, 0x20, 0x73, 0x61, 0x6d,
+  0x70, 0x6c, 0x65, 0x73, 0x20, 0x34, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c,
+  0x73, 0x20, 0x61, 0x74, 0x20, 0x6f, 0x6e, 0x63, 0x65, 0x2e, 0x0a, 0x2f,
+  0x2f, 0x20, 0x54, 0x68, 0x65, 0x20, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72,
+  0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6f, 0x75, 0x74, 0x70,
+  0x75, 0x74, 0x20, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x20, 0x28, 0x3d, 0x74,
+  0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x20, 0x69, 0x73, 0x20,
+  0x61, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6e, 0x74, 0x65, 0x72,
+  0x73, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x0a, 0x2f, 0x2f, 0x20, 0x6f,
+  0x66, 0x20, 0x66, 0x6f, 0x75, 0x72, 0x20, 0x69, 0x6e, 0x70, 0x75, 0x74,
+  0x20, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x73, 0x2e, 0x0a, 0x2f, 0x2f, 0x20,
+  0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x20, 0x69, 0x73, 0x20,
+  0x73, 0x69, 0x7a, 0x65, 0x20, 0x6f, 0x66, 0x20, 0x69, 0x6e, 0x70, 0x75,
+  0x74, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c, 0x0a, 0x2f, 0x2f, 0x20, 0x4e,
+  0x4f, 0x54, 0x45, 0x3a, 0x20, 0x54, 0x72, 0x79, 0x69, 0x6e, 0x67, 0x20,
+  0x74, 0x6f, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x20, 0x31, 0x36,
+  0x78, 0x31, 0x36, 0x20, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x73, 0x20, 0x79,
+  0x69, 0x65, 0x6c, 0x64, 0x73, 0x20, 0x61, 0x6e, 0x20, 0x6f, 0x75, 0x74,
+  0x2d, 0x6f, 0x66, 0x2d, 0x6d, 0x65, 0x6d, 0x6f, 0x72, 0x79, 0x20, 0x65,
+  0x72, 0x72, 0x6f, 0x72, 0x21, 0x20, 0x31, 0x32, 0x78, 0x31, 0x32, 0x20,
+  0x73, 0x74, 0x69, 0x6c, 0x6c, 0x20, 0x77, 0x6f, 0x72, 0x6b, 0x73, 0x21,
+  0x0a, 0x2f, 0x2f, 0x20, 0x49, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x68,
+  0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x64, 0x69, 0x6d, 0x65, 0x6e, 0x73,
+  0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x77, 0x68, 0x65, 0x72, 0x65, 0x20, 0x77,
+  0x65, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20, 0x6f, 0x6e, 0x65, 0x20, 0x6f,
+  0x75, 0x74, 0x70, 0x75, 0x74, 0x3a, 0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65,
+  0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3a, 0x2d, 0x38, 0x20, 0x2d, 0x37,
+  0x20, 0x2d, 0x36, 0x20, 0x2d, 0x35, 0x20, 0x2d, 0x34, 0x20, 0x2d, 0x33,
+  0x20, 0x2d, 0x32, 0x20, 0x2d, 0x31, 0x20, 0x20, 0x30, 0x20, 0x20, 0x31,
+  0x20, 0x20, 0x32, 0x20, 0x20, 0x33, 0x20, 0x20, 0x34, 0x20, 0x20, 0x35,
+  0x20, 0x20, 0x36, 0x20, 0x20, 0x37, 0x20, 0x20, 0x38, 0x0a, 0x2f, 0x2f,
+  0x20, 0x49, 0x6e, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x7c,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c,
+  0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64,
+  0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c,
+  0x65, 0x73, 0x31, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x73, 0x61,
+  0x6d, 0x70, 0x6c, 0x65, 0x73, 0x32, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2a,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2a,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2a,
+  0x2d, 0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x0a, 0x2f, 0x2f, 0x20, 0x49, 0x6e,
+  0x20, 0x74, 0x68, 0x65, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x20, 0x64,
+  0x69, 0x6d, 0x65, 0x6e, 0x73, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x77, 0x68,
+  0x65, 0x72, 0x65, 0x20, 0x77, 0x65, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20,
+  0x74, 0x77, 0x6f, 0x20, 0x2a, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x73,
+  0x2a, 0x3a, 0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e,
+  0x69, 0x74, 0x3a, 0x2d, 0x36, 0x20, 0x20, 0x20, 0x20, 0x2d, 0x35, 0x20,
+  0x20, 0x20, 0x20, 0x2d, 0x34, 0x20, 0x20, 0x20, 0x20, 0x2d, 0x33, 0x20,
+  0x20, 0x20, 0x20, 0x2d, 0x32, 0x20, 0x20, 0x20, 0x20, 0x2d, 0x31, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x30, 0x20, 0x20, 0x20, 0x20, 0x20, 0x31, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x32, 0x20, 0x20, 0x20, 0x20, 0x20, 0x33, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x34, 0x20, 0x20, 0x20, 0x20, 0x20, 0x35, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x36, 0x0a, 0x2f, 0x2f, 0x20, 0x49, 0x6e, 0x70,
+  0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x52, 0x47, 0x7c, 0x42,
+  0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42,
+  0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42,
+  0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42,
+  0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42,
+  0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42,
+  0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x0a, 0x2f, 0x2f, 0x20,
+  0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x0a,
+  0x2f, 0x2f, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x31, 0x3a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+  0x73, 0x32, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x0a,
+  0x2f, 0x2f, 0x20, 0x4f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x3c, 0x2d, 0x2d, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x52, 0x20, 0x47, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x2d, 0x2d, 0x3e, 0x7c, 0x0a, 0x2f, 0x2f, 0x20,
+  0x4f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x7c, 0x3c, 0x2d, 0x2d, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x42, 0x20, 0x41,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x2d, 0x2d, 0x3e, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x4f, 0x6e, 0x65,
+  0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x78, 0x2d, 0x73, 0x61,
+  0x6d, 0x70, 0x6c, 0x65, 0x20, 0x70, 0x6f, 0x69, 0x6e, 0x74, 0x73, 0x20,
+  0x69, 0x73, 0x20, 0x75, 0x73, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x20, 0x62,
+  0x6f, 0x74, 0x68, 0x20, 0x72, 0x65, 0x73, 0x75, 0x6c, 0x74, 0x73, 0x21,
+  0x0a, 0x2f, 0x2f, 0x20, 0x4f, 0x4f, 0x4d, 0x3a, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x7c, 0x20, 0x28, 0x6f, 0x75, 0x74, 0x2d, 0x6f, 0x66, 0x2d,
+  0x6d, 0x65, 0x6d, 0x6f, 0x72, 0x79, 0x29, 0x0a, 0x70, 0x72, 0x65, 0x63,
+  0x69, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x6d, 0x65, 0x64, 0x69, 0x75, 0x6d,
+  0x70, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x3b, 0x0a, 0x75, 0x6e, 0x69,
+  0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72,
+  0x32, 0x44, 0x20, 0x74, 0x65, 0x78, 0x3b, 0x0a, 0x76, 0x61, 0x72, 0x79,
+  0x69, 0x6e, 0x67, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20, 0x74, 0x65, 0x78,
+  0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f,
+  0x72, 0x6d, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20, 0x74, 0x65, 0x78, 0x5f,
+  0x75, 0x6e, 0x69, 0x74, 0x3b, 0x0a, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x6d,
+  0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f, 0x69, 0x64, 0x29, 0x20, 0x7b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x61, 0x76, 0x67,
+  0x31, 0x20, 0x3d, 0x20, 0x76, 0x65, 0x63, 0x34, 0x28, 0x30, 0x2c, 0x30,
+  0x2c, 0x30, 0x2c, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76,
+  0x65, 0x63, 0x34, 0x20, 0x61, 0x76, 0x67, 0x32, 0x20, 0x3d, 0x20, 0x76,
+  0x65, 0x63, 0x34, 0x28, 0x30, 0x2c, 0x30, 0x2c, 0x30, 0x2c, 0x30, 0x29,
+  0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x61,
+  0x76, 0x67, 0x62, 0x6f, 0x74, 0x68, 0x3d, 0x20, 0x76, 0x65, 0x63, 0x34,
+  0x28, 0x30, 0x2c, 0x30, 0x2c, 0x30, 0x2c, 0x30, 0x29, 0x3b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x20,
+  0x6a, 0x20, 0x3d, 0x20, 0x2d, 0x35, 0x3b, 0x20, 0x6a, 0x20, 0x3c, 0x3d,
+  0x20, 0x35, 0x3b, 0x20, 0x6a, 0x20, 0x2b, 0x3d, 0x20, 0x32, 0x29, 0x20,
+  0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x76,
+  0x67, 0x62, 0x6f, 0x74, 0x68, 0x20, 0x2b, 0x3d, 0x20, 0x74, 0x65, 0x78,
+  0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x2c, 0x20,
+  0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x2b, 0x20, 0x76,
+  0x65, 0x63, 0x32, 0x28, 0x30, 0x2c, 0x6a, 0x29, 0x20, 0x2a, 0x20, 0x74,
+  0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x29, 0x3b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, 0x20,
+  0x28, 0x69, 0x6e, 0x74, 0x20, 0x69, 0x20, 0x3d, 0x20, 0x2d, 0x34, 0x3b,
+  0x20, 0x69, 0x20, 0x3c, 0x3d, 0x2d, 0x32, 0x3b, 0x20, 0x69, 0x20, 0x2b,
+  0x3d, 0x20, 0x32, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x20,
+  0x6a, 0x20, 0x3d, 0x20, 0x2d, 0x35, 0x3b, 0x20, 0x6a, 0x20, 0x3c, 0x3d,
+  0x20, 0x35, 0x3b, 0x20, 0x6a, 0x20, 0x2b, 0x3d, 0x20, 0x32, 0x29, 0x20,
+  0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x61, 0x76, 0x67, 0x31, 0x20, 0x2b, 0x3d, 0x20, 0x74, 0x65,
+  0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x2c,
+  0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x2b, 0x20,
+  0x76, 0x65, 0x63, 0x32, 0x28, 0x69, 0x2c, 0x6a, 0x29, 0x20, 0x2a, 0x20,
+  0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x29, 0x3b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x28,
+  0x69, 0x6e, 0x74, 0x20, 0x69, 0x20, 0x3d, 0x20, 0x20, 0x32, 0x3b, 0x20,
+  0x69, 0x20, 0x3c, 0x3d, 0x20, 0x34, 0x3b, 0x20, 0x69, 0x20, 0x2b, 0x3d,
+  0x20, 0x32, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x20, 0x6a,
+  0x20, 0x3d, 0x20, 0x2d, 0x35, 0x3b, 0x20, 0x6a, 0x20, 0x3c, 0x3d, 0x20,
+  0x35, 0x3b, 0x20, 0x6a, 0x20, 0x2b, 0x3d, 0x20, 0x32, 0x29, 0x20, 0x7b,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x61, 0x76, 0x67, 0x32, 0x20, 0x2b, 0x3d, 0x20, 0x74, 0x65, 0x78,
+  0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x2c, 0x20,
+  0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x2b, 0x20, 0x76,
+  0x65, 0x63, 0x32, 0x28, 0x69, 0x2c, 0x6a, 0x29, 0x20, 0x2a, 0x20, 0x74,
+  0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x29, 0x3b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x61, 0x76, 0x67, 0x31, 0x20, 0x2b,
+  0x3d, 0x20, 0x61, 0x76, 0x67, 0x62, 0x6f, 0x74, 0x68, 0x3b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x61, 0x76, 0x67, 0x32, 0x20, 0x2b, 0x3d, 0x20, 0x61,
+  0x76, 0x67, 0x62, 0x6f, 0x74, 0x68, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72,
+  0x2e, 0x72, 0x67, 0x20, 0x3d, 0x20, 0x28, 0x31, 0x2e, 0x30, 0x2f, 0x33,
+  0x36, 0x2e, 0x30, 0x29, 0x20, 0x2a, 0x20, 0x28, 0x61, 0x76, 0x67, 0x31,
+  0x2e, 0x72, 0x67, 0x20, 0x2b, 0x20, 0x61, 0x76, 0x67, 0x31, 0x2e, 0x62,
+  0x61, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46,
+  0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x62, 0x61, 0x20,
+  0x3d, 0x20, 0x28, 0x31, 0x2e, 0x30, 0x2f, 0x33, 0x36, 0x2e, 0x30, 0x29,
+  0x20, 0x2a, 0x20, 0x28, 0x61, 0x76, 0x67, 0x32, 0x2e, 0x72, 0x67, 0x20,
+  0x2b, 0x20, 0x61, 0x76, 0x67, 0x32, 0x2e, 0x62, 0x61, 0x29, 0x3b, 0x0a,
+  0x7d, 0x0a, 0x00
+};
+unsigned int phase2_frag_len = 2271;
+unsigned char phase2_dilatered_frag[] = {
+  0x2f, 0x2f, 0x20, 0x42, 0x61, 0x6c, 0x6c, 0x74, 0x72, 0x61, 0x63, 0x6b,
+  0x20, 0x73, 0x68, 0x61, 0x64, 0x65, 0x72, 0x20, 0x73, 0x65, 0x63, 0x6f,
+  0x6e, 0x64, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x0a, 0x2f, 0x2f, 0x20,
+  0x4f, 0x75, 0x70, 0x75, 0x74, 0x20, 0x69, 0x73, 0x20, 0x34, 0x58, 0x20,
+  0x73, 0x6d, 0x61, 0x6c, 0x6c, 0x65, 0x72, 0x20, 0x69, 0x6e, 0x20, 0x62,
+  0x6f, 0x74, 0x68, 0x20, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x69, 0x6f,
+  0x6e, 0x73, 0x0a, 0x2f, 0x2f, 0x20, 0x57, 0x65, 0x20, 0x77, 0x69, 0x6c,
+  0x6c, 0x20, 0x75, 0x73, 0x65, 0x20, 0x47, 0x4c, 0x5f, 0x4c, 0x49, 0x4e,
+  0x45, 0x41, 0x52, 0x20, 0x73, 0x6f, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20,
+  0x74, 0x68, 0x65, 0x20, 0x47, 0x50, 0x55, 0x20, 0x73, 0x61, 0x6d, 0x70,
+  0x6c, 0x65, 0x73, 0x20, 0x34, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c, 0x73,
+  0x20, 0x61, 0x74, 0x20, 0x6f, 0x6e, 0x63, 0x65, 0x2e, 0x0a, 0x2f, 0x2f,
+  0x0a, 0x2f, 0x2f, 0x20, 0x49, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x68,
+  0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x64, 0x69, 0x6d, 0x65, 0x6e, 0x73,
+  0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x77, 0x68, 0x65, 0x72, 0x65, 0x20, 0x77,
+  0x65, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20, 0x6f, 0x6e, 0x65, 0x20, 0x6f,
+  0x75, 0x74, 0x70, 0x75, 0x74, 0x3a, 0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65,
+  0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3a, 0x2d, 0x38, 0x20, 0x2d, 0x37,
+  0x20, 0x2d, 0x36, 0x20, 0x2d, 0x35, 0x20, 0x2d, 0x34, 0x20, 0x2d, 0x33,
+  0x20, 0x2d, 0x32, 0x20, 0x2d, 0x31, 0x20, 0x20, 0x30, 0x20, 0x20, 0x31,
+  0x20, 0x20, 0x32, 0x20, 0x20, 0x33, 0x20, 0x20, 0x34, 0x20, 0x20, 0x35,
+  0x20, 0x20, 0x36, 0x20, 0x20, 0x37, 0x20, 0x20, 0x38, 0x0a, 0x2f, 0x2f,
+  0x20, 0x49, 0x6e, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x7c,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c,
+  0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64,
+  0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x0a, 0x2f, 0x2f,
+  0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x3a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c,
+  0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x0a, 0x2f, 0x2f,
+  0x20, 0x49, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x77, 0x69, 0x64, 0x74,
+  0x68, 0x20, 0x64, 0x69, 0x6d, 0x65, 0x6e, 0x73, 0x69, 0x6f, 0x6e, 0x2c,
+  0x20, 0x77, 0x68, 0x65, 0x72, 0x65, 0x20, 0x77, 0x65, 0x20, 0x68, 0x61,
+  0x76, 0x65, 0x20, 0x74, 0x77, 0x6f, 0x20, 0x2a, 0x6f, 0x75, 0x74, 0x70,
+  0x75, 0x74, 0x73, 0x2a, 0x3a, 0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78,
+  0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3a, 0x2d, 0x36, 0x20, 0x20, 0x20, 0x20,
+  0x2d, 0x35, 0x20, 0x20, 0x20, 0x20, 0x2d, 0x34, 0x20, 0x20, 0x20, 0x20,
+  0x2d, 0x33, 0x20, 0x20, 0x20, 0x20, 0x2d, 0x32, 0x20, 0x20, 0x20, 0x20,
+  0x2d, 0x31, 0x20, 0x20, 0x20, 0x20, 0x20, 0x30, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x31, 0x20, 0x20, 0x20, 0x20, 0x20, 0x32, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x33, 0x20, 0x20, 0x20, 0x20, 0x20, 0x34, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x35, 0x20, 0x20, 0x20, 0x20, 0x20, 0x36, 0x0a, 0x2f, 0x2f, 0x20,
+  0x49, 0x6e, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x0a,
+  0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x52, 0x2d, 0x47, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x42, 0x2d, 0x41, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x4f, 0x75, 0x74, 0x70, 0x75, 0x74,
+  0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x7c, 0x3c, 0x2d, 0x2d, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x52, 0x20, 0x47,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x2d, 0x2d, 0x3e, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x4f, 0x75, 0x74,
+  0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x3c, 0x2d, 0x2d, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x42, 0x20, 0x41, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x2d, 0x2d, 0x3e, 0x7c, 0x0a, 0x2f, 0x2f, 0x20,
+  0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x3a, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x0a,
+  0x70, 0x72, 0x65, 0x63, 0x69, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x6d, 0x65,
+  0x64, 0x69, 0x75, 0x6d, 0x70, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x3b,
+  0x0a, 0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61,
+  0x6d, 0x70, 0x6c, 0x65, 0x72, 0x32, 0x44, 0x20, 0x74, 0x65, 0x78, 0x3b,
+  0x0a, 0x76, 0x61, 0x72, 0x79, 0x69, 0x6e, 0x67, 0x20, 0x76, 0x65, 0x63,
+  0x32, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3b, 0x20,
+  0x2f, 0x2f, 0x20, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x20, 0x6f, 0x66,
+  0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x20, 0x70, 0x69, 0x78, 0x65,
+  0x6c, 0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x76, 0x65,
+  0x63, 0x32, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3b,
+  0x20, 0x2f, 0x2f, 0x20, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6f, 0x66, 0x20,
+  0x69, 0x6e, 0x70, 0x75, 0x74, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c, 0x0a,
+  0x76, 0x6f, 0x69, 0x64, 0x20, 0x6d, 0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f,
+  0x69, 0x64, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x6f,
+  0x6f, 0x6c, 0x20, 0x66, 0x6f, 0x75, 0x6e, 0x64, 0x52, 0x65, 0x64, 0x20,
+  0x3d, 0x20, 0x66, 0x61, 0x6c, 0x73, 0x65, 0x3b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x61, 0x76, 0x67, 0x31, 0x20, 0x3d,
+  0x20, 0x76, 0x65, 0x63, 0x34, 0x28, 0x30, 0x2c, 0x30, 0x2c, 0x30, 0x2c,
+  0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34,
+  0x20, 0x61, 0x76, 0x67, 0x32, 0x20, 0x3d, 0x20, 0x76, 0x65, 0x63, 0x34,
+  0x28, 0x30, 0x2c, 0x30, 0x2c, 0x30, 0x2c, 0x30, 0x29, 0x3b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x20,
+  0x69, 0x20, 0x3d, 0x20, 0x2d, 0x33, 0x3b, 0x20, 0x69, 0x20, 0x3c, 0x3d,
+  0x20, 0x33, 0x3b, 0x20, 0x69, 0x20, 0x2b, 0x3d, 0x20, 0x32, 0x29, 0x20,
+  0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f,
+  0x72, 0x20, 0x28, 0x69, 0x6e, 0x74, 0x20, 0x6a, 0x20, 0x3d, 0x20, 0x2d,
+  0x35, 0x3b, 0x20, 0x6a, 0x20, 0x3c, 0x3d, 0x20, 0x35, 0x3b, 0x20, 0x6a,
+  0x20, 0x2b, 0x3d, 0x20, 0x32, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63,
+  0x34, 0x20, 0x63, 0x6f, 0x6c, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x74,
+  0x75, 0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x2c, 0x20, 0x74,
+  0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x2b, 0x20, 0x76, 0x65,
+  0x63, 0x32, 0x28, 0x69, 0x2c, 0x6a, 0x29, 0x20, 0x2a, 0x20, 0x74, 0x65,
+  0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20,
+  0x28, 0x6d, 0x69, 0x6e, 0x28, 0x63, 0x6f, 0x6c, 0x2e, 0x72, 0x2c, 0x63,
+  0x6f, 0x6c, 0x2e, 0x62, 0x29, 0x20, 0x3c, 0x20, 0x30, 0x2e, 0x37, 0x38,
+  0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6f, 0x75, 0x6e,
+  0x64, 0x52, 0x65, 0x64, 0x20, 0x3d, 0x20, 0x74, 0x72, 0x75, 0x65, 0x3b,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20, 0x49, 0x20, 0x2a, 0x72, 0x65, 0x61,
+  0x6c, 0x6c, 0x79, 0x2a, 0x20, 0x68, 0x6f, 0x70, 0x65, 0x20, 0x69, 0x74,
+  0x20, 0x75, 0x6e, 0x72, 0x6f, 0x6c, 0x6c, 0x73, 0x20, 0x74, 0x68, 0x69,
+  0x73, 0x20, 0x6c, 0x6f, 0x6f, 0x70, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x6a,
+  0x20, 0x3d, 0x3d, 0x20, 0x2d, 0x31, 0x20, 0x7c, 0x7c, 0x20, 0x6a, 0x20,
+  0x3d, 0x3d, 0x20, 0x31, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x69, 0x66, 0x20, 0x28, 0x69, 0x20, 0x3d, 0x3d, 0x20, 0x2d, 0x31, 0x29,
+  0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61,
+  0x76, 0x67, 0x31, 0x20, 0x2b, 0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x3b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x69,
+  0x66, 0x20, 0x28, 0x69, 0x20, 0x3d, 0x3d, 0x20, 0x31, 0x29, 0x20, 0x7b,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x76, 0x67,
+  0x32, 0x20, 0x2b, 0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x3b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c,
+  0x6f, 0x72, 0x2e, 0x72, 0x67, 0x20, 0x3d, 0x20, 0x28, 0x31, 0x2e, 0x30,
+  0x2f, 0x34, 0x2e, 0x30, 0x29, 0x20, 0x2a, 0x20, 0x28, 0x61, 0x76, 0x67,
+  0x31, 0x2e, 0x72, 0x67, 0x20, 0x2b, 0x20, 0x61, 0x76, 0x67, 0x31, 0x2e,
+  0x62, 0x61, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f,
+  0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x62, 0x61,
+  0x20, 0x3d, 0x20, 0x28, 0x31, 0x2e, 0x30, 0x2f, 0x34, 0x2e, 0x30, 0x29,
+  0x20, 0x2a, 0x20, 0x28, 0x61, 0x76, 0x67, 0x32, 0x2e, 0x72, 0x67, 0x20,
+  0x2b, 0x20, 0x61, 0x76, 0x67, 0x32, 0x2e, 0x62, 0x61, 0x29, 0x3b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x20, 0x28, 0x66, 0x6f, 0x75, 0x6e,
+  0x64, 0x52, 0x65, 0x64, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43,
+  0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x72, 0x20, 0x3d, 0x20, 0x30, 0x2e, 0x30,
+  0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c,
+  0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x62,
+  0x20, 0x3d, 0x20, 0x30, 0x2e, 0x30, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x7d, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20, 0x53, 0x63, 0x61, 0x6c,
+  0x65, 0x20, 0x5b, 0x30, 0x2e, 0x38, 0x2c, 0x31, 0x5d, 0x20, 0x74, 0x6f,
+  0x20, 0x5b, 0x30, 0x2c, 0x31, 0x5d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20, 0x35, 0x2e, 0x30, 0x20, 0x2a, 0x20,
+  0x72, 0x20, 0x2d, 0x20, 0x34, 0x2e, 0x30, 0x20, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x20, 0x77, 0x68, 0x65, 0x72,
+  0x65, 0x20, 0x72, 0x20, 0x3d, 0x20, 0x28, 0x61, 0x76, 0x67, 0x2e, 0x72,
+  0x20, 0x2b, 0x20, 0x61, 0x76, 0x67, 0x2e, 0x62, 0x29, 0x20, 0x2f, 0x20,
+  0x34, 0x2e, 0x30, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f,
+  0x72, 0x2e, 0x72, 0x20, 0x3d, 0x20, 0x35, 0x2e, 0x30, 0x20, 0x2a, 0x20,
+  0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72,
+  0x2e, 0x72, 0x20, 0x2d, 0x20, 0x34, 0x2e, 0x30, 0x3b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61,
+  0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x62, 0x20, 0x3d, 0x20, 0x35,
+  0x2e, 0x30, 0x20, 0x2a, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67,
+  0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x62, 0x20, 0x2d, 0x20, 0x34, 0x2e,
+  0x30, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0a, 0x7d, 0x0a, 0x00
+};
+unsigned int phase2_dilatered_frag_len = 2124;
+unsigned char phase2_h_frag[] = {
+  0x2f, 0x2f, 0x20, 0x42, 0x61, 0x6c, 0x6c, 0x74, 0x72, 0x61, 0x63, 0x6b,
+  0x20, 0x73, 0x68, 0x61, 0x64, 0x65, 0x72, 0x20, 0x73, 0x65, 0x63, 0x6f,
+  0x6e, 0x64, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x2c, 0x20, 0x68, 0x6f,
+  0x72, 0x69, 0x7a, 0x6f, 0x6e, 0x74, 0x61, 0x6c, 0x20, 0x68, 0x61, 0x6c,
+  0x66, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x65, 0x70,
+  0x61, 0x72, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x76, 0x65, 0x72, 0x73, 0x69,
+  0x6f, 0x6e, 0x0a, 0x2f, 0x2f, 0x20, 0x53, 0x61, 0x6d, 0x65, 0x20, 0x31,
+  0x32, 0x78, 0x31, 0x32, 0x20, 0x61, 0x76, 0x65, 0x72, 0x61, 0x67, 0x65,
+  0x20, 0x61, 0x73, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x32, 0x2e, 0x66,
+  0x72, 0x61, 0x67, 0x2c, 0x20, 0x73, 0x70, 0x6c, 0x69, 0x74, 0x20, 0x69,
+  0x6e, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x69, 0x73, 0x20, 0x70, 0x61, 0x73,
+  0x73, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x32,
+  0x5f, 0x76, 0x2e, 0x66, 0x72, 0x61, 0x67, 0x2e, 0x0a, 0x2f, 0x2f, 0x20,
+  0x4f, 0x75, 0x70, 0x75, 0x74, 0x20, 0x69, 0x73, 0x20, 0x38, 0x58, 0x20,
+  0x73, 0x6d, 0x61, 0x6c, 0x6c, 0x65, 0x72, 0x20, 0x69, 0x6e, 0x20, 0x77,
+  0x69, 0x64, 0x74, 0x68, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x32, 0x58, 0x20,
+  0x73, 0x6d, 0x61, 0x6c, 0x6c, 0x65, 0x72, 0x20, 0x69, 0x6e, 0x20, 0x68,
+  0x65, 0x69, 0x67, 0x68, 0x74, 0x2e, 0x0a, 0x2f, 0x2f, 0x20, 0x57, 0x65,
+  0x20, 0x77, 0x69, 0x6c, 0x6c, 0x20, 0x75, 0x73, 0x65, 0x20, 0x47, 0x4c,
+  0x5f, 0x4c, 0x49, 0x4e, 0x45, 0x41, 0x52, 0x20, 0x73, 0x6f, 0x20, 0x74,
+  0x68, 0x61, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x47, 0x50, 0x55, 0x20,
+  0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x20, 0x34, 0x20, 0x74, 0x65,
+  0x78, 0x65, 0x6c, 0x73, 0x20, 0x61, 0x74, 0x20, 0x6f, 0x6e, 0x63, 0x65,
+  0x2c, 0x20, 0x73, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x0a, 0x2f, 0x2f, 0x20,
+  0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x68, 0x61, 0x6c, 0x76, 0x69,
+  0x6e, 0x67, 0x20, 0x63, 0x6f, 0x6d, 0x65, 0x73, 0x20, 0x66, 0x6f, 0x72,
+  0x20, 0x66, 0x72, 0x65, 0x65, 0x2e, 0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65,
+  0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x20, 0x69, 0x73, 0x20, 0x73, 0x69,
+  0x7a, 0x65, 0x20, 0x6f, 0x66, 0x20, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x20,
+  0x74, 0x65, 0x78, 0x65, 0x6c, 0x0a, 0x2f, 0x2f, 0x20, 0x49, 0x6e, 0x20,
+  0x74, 0x68, 0x65, 0x20, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x64,
+  0x69, 0x6d, 0x65, 0x6e, 0x73, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x77, 0x68,
+  0x65, 0x72, 0x65, 0x20, 0x77, 0x65, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20,
+  0x6f, 0x6e, 0x65, 0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x3a, 0x0a,
+  0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3a,
+  0x2d, 0x31, 0x20, 0x20, 0x30, 0x20, 0x20, 0x31, 0x0a, 0x2f, 0x2f, 0x20,
+  0x49, 0x6e, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d,
+  0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78,
+  0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3a, 0x20, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d,
+  0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+  0x73, 0x3a, 0x20, 0x20, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x0a,
+  0x2f, 0x2f, 0x0a, 0x2f, 0x2f, 0x20, 0x49, 0x6e, 0x20, 0x74, 0x68, 0x65,
+  0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x20, 0x64, 0x69, 0x6d, 0x65, 0x6e,
+  0x73, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x77, 0x68, 0x65, 0x72, 0x65, 0x20,
+  0x77, 0x65, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20, 0x74, 0x77, 0x6f, 0x20,
+  0x2a, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x73, 0x2a, 0x2c, 0x20, 0x61,
+  0x73, 0x20, 0x69, 0x6e, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x32, 0x2e,
+  0x66, 0x72, 0x61, 0x67, 0x3a, 0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78,
+  0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3a, 0x2d, 0x36, 0x20, 0x20, 0x20, 0x20,
+  0x2d, 0x35, 0x20, 0x20, 0x20, 0x20, 0x2d, 0x34, 0x20, 0x20, 0x20, 0x20,
+  0x2d, 0x33, 0x20, 0x20, 0x20, 0x20, 0x2d, 0x32, 0x20, 0x20, 0x20, 0x20,
+  0x2d, 0x31, 0x20, 0x20, 0x20, 0x20, 0x20, 0x30, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x31, 0x20, 0x20, 0x20, 0x20, 0x20, 0x32, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x33, 0x20, 0x20, 0x20, 0x20, 0x20, 0x34, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x35, 0x20, 0x20, 0x20, 0x20, 0x20, 0x36, 0x0a, 0x2f, 0x2f, 0x20,
+  0x49, 0x6e, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52,
+  0x47, 0x7c, 0x42, 0x41, 0x7c, 0x52, 0x47, 0x7c, 0x42, 0x41, 0x7c, 0x0a,
+  0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x7c, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d,
+  0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+  0x73, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x0a,
+  0x2f, 0x2f, 0x20, 0x4f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x3c, 0x2d, 0x2d, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x52, 0x20, 0x47, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x2d, 0x2d, 0x3e, 0x7c, 0x0a, 0x2f, 0x2f, 0x20,
+  0x4f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x7c, 0x3c, 0x2d, 0x2d, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x42, 0x20, 0x41,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x2d, 0x2d, 0x3e, 0x7c, 0x0a, 0x70, 0x72, 0x65, 0x63, 0x69, 0x73,
+  0x69, 0x6f, 0x6e, 0x20, 0x6d, 0x65, 0x64, 0x69, 0x75, 0x6d, 0x70, 0x20,
+  0x66, 0x6c, 0x6f, 0x61, 0x74, 0x3b, 0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f,
+  0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x32, 0x44,
+  0x20, 0x74, 0x65, 0x78, 0x3b, 0x0a, 0x76, 0x61, 0x72, 0x79, 0x69, 0x6e,
+  0x67, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f,
+  0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d,
+  0x20, 0x76, 0x65, 0x63, 0x32, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e,
+  0x69, 0x74, 0x3b, 0x0a, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x6d, 0x61, 0x69,
+  0x6e, 0x28, 0x76, 0x6f, 0x69, 0x64, 0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x62, 0x6f, 0x74, 0x68, 0x20,
+  0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28,
+  0x74, 0x65, 0x78, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72,
+  0x64, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34,
+  0x20, 0x61, 0x76, 0x67, 0x31, 0x20, 0x3d, 0x20, 0x62, 0x6f, 0x74, 0x68,
+  0x20, 0x2b, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x44,
+  0x28, 0x74, 0x65, 0x78, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f,
+  0x72, 0x64, 0x20, 0x2b, 0x20, 0x76, 0x65, 0x63, 0x32, 0x28, 0x2d, 0x34,
+  0x2c, 0x30, 0x29, 0x20, 0x2a, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e,
+  0x69, 0x74, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x2b, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x44,
+  0x28, 0x74, 0x65, 0x78, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f,
+  0x72, 0x64, 0x20, 0x2b, 0x20, 0x76, 0x65, 0x63, 0x32, 0x28, 0x2d, 0x32,
+  0x2c, 0x30, 0x29, 0x20, 0x2a, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e,
+  0x69, 0x74, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63,
+  0x34, 0x20, 0x61, 0x76, 0x67, 0x32, 0x20, 0x3d, 0x20, 0x62, 0x6f, 0x74,
+  0x68, 0x20, 0x2b, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32,
+  0x44, 0x28, 0x74, 0x65, 0x78, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f,
+  0x6f, 0x72, 0x64, 0x20, 0x2b, 0x20, 0x76, 0x65, 0x63, 0x32, 0x28, 0x20,
+  0x32, 0x2c, 0x30, 0x29, 0x20, 0x2a, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75,
+  0x6e, 0x69, 0x74, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x2b, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32,
+  0x44, 0x28, 0x74, 0x65, 0x78, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f,
+  0x6f, 0x72, 0x64, 0x20, 0x2b, 0x20, 0x76, 0x65, 0x63, 0x32, 0x28, 0x20,
+  0x34, 0x2c, 0x30, 0x29, 0x20, 0x2a, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75,
+  0x6e, 0x69, 0x74, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c,
+  0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x72,
+  0x67, 0x20, 0x3d, 0x20, 0x28, 0x31, 0x2e, 0x30, 0x2f, 0x36, 0x2e, 0x30,
+  0x29, 0x20, 0x2a, 0x20, 0x28, 0x61, 0x76, 0x67, 0x31, 0x2e, 0x72, 0x67,
+  0x20, 0x2b, 0x20, 0x61, 0x76, 0x67, 0x31, 0x2e, 0x62, 0x61, 0x29, 0x3b,
+  0x0a, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67,
+  0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x2e, 0x62, 0x61, 0x20, 0x3d, 0x20, 0x28,
+  0x31, 0x2e, 0x30, 0x2f, 0x36, 0x2e, 0x30, 0x29, 0x20, 0x2a, 0x20, 0x28,
+  0x61, 0x76, 0x67, 0x32, 0x2e, 0x72, 0x67, 0x20, 0x2b, 0x20, 0x61, 0x76,
+  0x67, 0x32, 0x2e, 0x62, 0x61, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x00
+};
+unsigned int phase2_h_frag_len = 1595;
+unsigned char phase2_v_frag[] = {
+  0x2f, 0x2f, 0x20, 0x42, 0x61, 0x6c, 0x6c, 0x74, 0x72, 0x61, 0x63, 0x6b,
+  0x20, 0x73, 0x68, 0x61, 0x64, 0x65, 0x72, 0x20, 0x73, 0x65, 0x63, 0x6f,
+  0x6e, 0x64, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x2c, 0x20, 0x76, 0x65,
+  0x72, 0x74, 0x69, 0x63, 0x61, 0x6c, 0x20, 0x68, 0x61, 0x6c, 0x66, 0x20,
+  0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x65, 0x70, 0x61, 0x72,
+  0x61, 0x62, 0x6c, 0x65, 0x20, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e,
+  0x0a, 0x2f, 0x2f, 0x20, 0x4f, 0x75, 0x70, 0x75, 0x74, 0x20, 0x69, 0x73,
+  0x20, 0x34, 0x58, 0x20, 0x73, 0x6d, 0x61, 0x6c, 0x6c, 0x65, 0x72, 0x20,
+  0x69, 0x6e, 0x20, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x2c, 0x20, 0x69,
+  0x6e, 0x70, 0x75, 0x74, 0x20, 0x69, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20,
+  0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x20, 0x6f, 0x66, 0x20, 0x70, 0x68,
+  0x61, 0x73, 0x65, 0x32, 0x5f, 0x68, 0x2e, 0x66, 0x72, 0x61, 0x67, 0x2e,
+  0x0a, 0x2f, 0x2f, 0x20, 0x57, 0x65, 0x20, 0x77, 0x69, 0x6c, 0x6c, 0x20,
+  0x75, 0x73, 0x65, 0x20, 0x47, 0x4c, 0x5f, 0x4c, 0x49, 0x4e, 0x45, 0x41,
+  0x52, 0x20, 0x73, 0x6f, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x74, 0x68,
+  0x65, 0x20, 0x47, 0x50, 0x55, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+  0x73, 0x20, 0x32, 0x20, 0x72, 0x6f, 0x77, 0x73, 0x20, 0x61, 0x74, 0x20,
+  0x6f, 0x6e, 0x63, 0x65, 0x2e, 0x0a, 0x2f, 0x2f, 0x20, 0x54, 0x68, 0x65,
+  0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x20, 0x77, 0x69, 0x64, 0x74,
+  0x68, 0x20, 0x69, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6e, 0x70,
+  0x75, 0x74, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x2c, 0x20, 0x73, 0x6f,
+  0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x69, 0x73,
+  0x20, 0x61, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63, 0x65, 0x6e, 0x74,
+  0x65, 0x72, 0x20, 0x6f, 0x66, 0x0a, 0x2f, 0x2f, 0x20, 0x61, 0x6e, 0x20,
+  0x69, 0x6e, 0x70, 0x75, 0x74, 0x20, 0x74, 0x65, 0x78, 0x65, 0x6c, 0x20,
+  0x69, 0x6e, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x64, 0x69, 0x72, 0x65,
+  0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x74, 0x68,
+  0x65, 0x20, 0x70, 0x61, 0x63, 0x6b, 0x65, 0x64, 0x20, 0x70, 0x61, 0x69,
+  0x72, 0x73, 0x20, 0x73, 0x74, 0x61, 0x79, 0x20, 0x61, 0x70, 0x61, 0x72,
+  0x74, 0x2e, 0x0a, 0x2f, 0x2f, 0x20, 0x49, 0x6e, 0x20, 0x74, 0x68, 0x65,
+  0x20, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x20, 0x64, 0x69, 0x6d, 0x65,
+  0x6e, 0x73, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x77, 0x68, 0x65, 0x72, 0x65,
+  0x20, 0x77, 0x65, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20, 0x6f, 0x6e, 0x65,
+  0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x3a, 0x0a, 0x2f, 0x2f, 0x20,
+  0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3a, 0x2d, 0x34, 0x20,
+  0x2d, 0x33, 0x20, 0x2d, 0x32, 0x20, 0x2d, 0x31, 0x20, 0x20, 0x30, 0x20,
+  0x20, 0x31, 0x20, 0x20, 0x32, 0x20, 0x20, 0x33, 0x20, 0x20, 0x34, 0x0a,
+  0x2f, 0x2f, 0x20, 0x49, 0x6e, 0x70, 0x75, 0x74, 0x3a, 0x20, 0x20, 0x20,
+  0x20, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x7c, 0x0a, 0x2f, 0x2f, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f,
+  0x72, 0x64, 0x3a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d,
+  0x2d, 0x2d, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x2d, 0x2d, 0x2d, 0x7c, 0x0a,
+  0x2f, 0x2f, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x3a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x2d,
+  0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x2d, 0x2d, 0x2a, 0x2d, 0x2d, 0x7c, 0x0a,
+  0x70, 0x72, 0x65, 0x63, 0x69, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x6d, 0x65,
+  0x64, 0x69, 0x75, 0x6d, 0x70, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x3b,
+  0x0a, 0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d,
+  0x70, 0x6c, 0x65, 0x72, 0x32, 0x44, 0x20, 0x74, 0x65, 0x78, 0x3b, 0x0a,
+  0x76, 0x61, 0x72, 0x79, 0x69, 0x6e, 0x67, 0x20, 0x76, 0x65, 0x63, 0x32,
+  0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x75,
+  0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20,
+  0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x3b, 0x0a, 0x76, 0x6f,
+  0x69, 0x64, 0x20, 0x6d, 0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f, 0x69, 0x64,
+  0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34,
+  0x20, 0x61, 0x76, 0x67, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75,
+  0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x2c, 0x20, 0x74, 0x65,
+  0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x20, 0x2b, 0x20, 0x76, 0x65, 0x63,
+  0x32, 0x28, 0x30, 0x2c, 0x2d, 0x32, 0x29, 0x20, 0x2a, 0x20, 0x74, 0x65,
+  0x78, 0x5f, 0x75, 0x6e, 0x69, 0x74, 0x29, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2b, 0x20, 0x74,
+  0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78,
+  0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x2b, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x44,
+  0x28, 0x74, 0x65, 0x78, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f,
+  0x72, 0x64, 0x20, 0x2b, 0x20, 0x76, 0x65, 0x63, 0x32, 0x28, 0x30, 0x2c,
+  0x20, 0x32, 0x29, 0x20, 0x2a, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x6e,
+  0x69, 0x74, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f,
+  0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x20, 0x3d, 0x20,
+  0x28, 0x31, 0x2e, 0x30, 0x2f, 0x33, 0x2e, 0x30, 0x29, 0x20, 0x2a, 0x20,
+  0x61, 0x76, 0x67, 0x3b, 0x0a, 0x7d, 0x0a, 0x00
+};
+unsigned int phase2_v_frag_len = 872;
+unsigned char plain_frag[] = {
+  0x23, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x47,
+  0x4c, 0x5f, 0x4f, 0x45, 0x53, 0x5f, 0x45, 0x47, 0x4c, 0x5f, 0x69, 0x6d,
+  0x61, 0x67, 0x65, 0x5f, 0x65, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c,
+  0x20, 0x3a, 0x20, 0x72, 0x65, 0x71, 0x75, 0x69, 0x72, 0x65, 0x0a, 0x70,
+  0x72, 0x65, 0x63, 0x69, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x6d, 0x65, 0x64,
+  0x69, 0x75, 0x6d, 0x70, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x3b, 0x0a,
+  0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d, 0x70,
+  0x6c, 0x65, 0x72, 0x45, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c, 0x4f,
+  0x45, 0x53, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x72, 0x67, 0x62, 0x3b, 0x0a,
+  0x75, 0x6e, 0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d, 0x70,
+  0x6c, 0x65, 0x72, 0x45, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c, 0x4f,
+  0x45, 0x53, 0x20, 0x74, 0x65, 0x78, 0x5f, 0x79, 0x3b, 0x0a, 0x75, 0x6e,
+  0x69, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+  0x72, 0x45, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c, 0x4f, 0x45, 0x53,
+  0x20, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x3b, 0x0a, 0x75, 0x6e, 0x69, 0x66,
+  0x6f, 0x72, 0x6d, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x72, 0x45,
+  0x78, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c, 0x4f, 0x45, 0x53, 0x20, 0x74,
+  0x65, 0x78, 0x5f, 0x76, 0x3b, 0x0a, 0x76, 0x61, 0x72, 0x79, 0x69, 0x6e,
+  0x67, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f,
+  0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x0a, 0x2f, 0x2f, 0x20, 0x54, 0x72, 0x61,
+  0x6e, 0x73, 0x70, 0x6f, 0x73, 0x65, 0x20, 0x6f, 0x66, 0x20, 0x61, 0x63,
+  0x74, 0x75, 0x61, 0x6c, 0x20, 0x6d, 0x61, 0x74, 0x72, 0x69, 0x78, 0x0a,
+  0x6d, 0x61, 0x74, 0x34, 0x20, 0x59, 0x55, 0x56, 0x74, 0x6f, 0x52, 0x47,
+  0x42, 0x20, 0x3d, 0x20, 0x6d, 0x61, 0x74, 0x34, 0x28, 0x20, 0x31, 0x2e,
+  0x31, 0x36, 0x34, 0x2c, 0x20, 0x20, 0x31, 0x2e, 0x31, 0x36, 0x34, 0x2c,
+  0x20, 0x31, 0x2e, 0x31, 0x36, 0x34, 0x2c, 0x20, 0x30, 0x2c, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x30, 0x2c, 0x20, 0x2d, 0x30, 0x2e, 0x33, 0x39, 0x31, 0x2c, 0x20,
+  0x32, 0x2e, 0x30, 0x31, 0x38, 0x2c, 0x20, 0x30, 0x2c, 0x0a, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x31, 0x2e, 0x35, 0x39,
+  0x36, 0x2c, 0x20, 0x2d, 0x30, 0x2e, 0x38, 0x31, 0x33, 0x2c, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x30, 0x2c, 0x20, 0x30, 0x2c, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2d, 0x30, 0x2e, 0x38, 0x37, 0x31,
+  0x2c, 0x20, 0x20, 0x30, 0x2e, 0x35, 0x32, 0x39, 0x2c, 0x2d, 0x31, 0x2e,
+  0x30, 0x38, 0x32, 0x2c, 0x20, 0x31, 0x29, 0x3b, 0x0a, 0x0a, 0x76, 0x6f,
+  0x69, 0x64, 0x20, 0x6d, 0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f, 0x69, 0x64,
+  0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34,
+  0x20, 0x63, 0x6f, 0x6c, 0x20, 0x20, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78,
+  0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x5f, 0x72,
+  0x67, 0x62, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64,
+  0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20,
+  0x63, 0x6f, 0x6c, 0x5f, 0x79, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x74,
+  0x75, 0x72, 0x65, 0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x5f, 0x79, 0x2c,
+  0x20, 0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x63, 0x6f, 0x6c,
+  0x5f, 0x75, 0x20, 0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65,
+  0x32, 0x44, 0x28, 0x74, 0x65, 0x78, 0x5f, 0x75, 0x2c, 0x20, 0x74, 0x65,
+  0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x63, 0x6f, 0x6c, 0x5f, 0x76, 0x20,
+  0x3d, 0x20, 0x74, 0x65, 0x78, 0x74, 0x75, 0x72, 0x65, 0x32, 0x44, 0x28,
+  0x74, 0x65, 0x78, 0x5f, 0x76, 0x2c, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f,
+  0x6f, 0x72, 0x64, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x76, 0x65,
+  0x63, 0x34, 0x20, 0x79, 0x75, 0x76, 0x20, 0x3d, 0x20, 0x76, 0x65, 0x63,
+  0x34, 0x28, 0x63, 0x6f, 0x6c, 0x5f, 0x79, 0x2e, 0x72, 0x2c, 0x20, 0x63,
+  0x6f, 0x6c, 0x5f, 0x75, 0x2e, 0x72, 0x2c, 0x20, 0x63, 0x6f, 0x6c, 0x5f,
+  0x76, 0x2e, 0x72, 0x2c, 0x20, 0x31, 0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x76, 0x65, 0x63, 0x34, 0x20, 0x72, 0x67, 0x62, 0x20,
+  0x3d, 0x20, 0x59, 0x55, 0x56, 0x74, 0x6f, 0x52, 0x47, 0x42, 0x20, 0x2a,
+  0x20, 0x79, 0x75, 0x76, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x72, 0x67,
+  0x62, 0x20, 0x3d, 0x20, 0x63, 0x6c, 0x61, 0x6d, 0x70, 0x28, 0x72, 0x67,
+  0x62, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x2c, 0x20, 0x31, 0x2e, 0x30, 0x29,
+  0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x66, 0x6c, 0x6f, 0x61,
+  0x74, 0x20, 0x42, 0x20, 0x3d, 0x20, 0x63, 0x6c, 0x61, 0x6d, 0x70, 0x28,
+  0x31, 0x2e, 0x31, 0x36, 0x34, 0x20, 0x2a, 0x20, 0x28, 0x59, 0x20, 0x2d,
+  0x20, 0x30, 0x2e, 0x30, 0x36, 0x32, 0x35, 0x29, 0x20, 0x2b, 0x20, 0x32,
+  0x2e, 0x30, 0x31, 0x38, 0x20, 0x2a, 0x20, 0x28, 0x55, 0x20, 0x2d, 0x20,
+  0x30, 0x2e, 0x35, 0x29, 0x20, 0x20, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x2c,
+  0x31, 0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f,
+  0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20, 0x47, 0x20, 0x3d, 0x20, 0x63, 0x6c,
+  0x61, 0x6d, 0x70, 0x28, 0x31, 0x2e, 0x31, 0x36, 0x34, 0x20, 0x2a, 0x20,
+  0x28, 0x59, 0x20, 0x2d, 0x20, 0x30, 0x2e, 0x30, 0x36, 0x32, 0x35, 0x29,
+  0x20, 0x2d, 0x20, 0x30, 0x2e, 0x38, 0x31, 0x33, 0x20, 0x2a, 0x20, 0x28,
+  0x56, 0x20, 0x2d, 0x20, 0x30, 0x2e, 0x35, 0x29, 0x20, 0x2d, 0x20, 0x30,
+  0x2e, 0x33, 0x39, 0x31, 0x20, 0x2a, 0x20, 0x28, 0x55, 0x20, 0x2d, 0x20,
+  0x30, 0x2e, 0x35, 0x29, 0x20, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x2c, 0x31,
+  0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x66,
+  0x6c, 0x6f, 0x61, 0x74, 0x20, 0x52, 0x20, 0x3d, 0x20, 0x63, 0x6c, 0x61,
+  0x6d, 0x70, 0x28, 0x31, 0x2e, 0x31, 0x36, 0x34, 0x20, 0x2a, 0x20, 0x28,
+  0x59, 0x20, 0x2d, 0x20, 0x30, 0x2e, 0x30, 0x36, 0x32, 0x35, 0x29, 0x20,
+  0x2b, 0x20, 0x31, 0x2e, 0x35, 0x39, 0x36, 0x20, 0x2a, 0x20, 0x28, 0x56,
+  0x20, 0x2d, 0x20, 0x30, 0x2e, 0x35, 0x29, 0x20, 0x20, 0x2c, 0x20, 0x30,
+  0x2e, 0x30, 0x2c, 0x31, 0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x2f, 0x2f, 0x67, 0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f,
+  0x6c, 0x6f, 0x72, 0x20, 0x3d, 0x20, 0x76, 0x65, 0x63, 0x34, 0x28, 0x61,
+  0x62, 0x73, 0x28, 0x52, 0x20, 0x2d, 0x20, 0x63, 0x6f, 0x6c, 0x2e, 0x72,
+  0x29, 0x2c, 0x20, 0x61, 0x62, 0x73, 0x28, 0x47, 0x20, 0x2d, 0x20, 0x63,
+  0x6f, 0x6c, 0x2e, 0x67, 0x29, 0x2c, 0x20, 0x61, 0x62, 0x73, 0x28, 0x42,
+  0x20, 0x2d, 0x20, 0x63, 0x6f, 0x6c, 0x2e, 0x62, 0x29, 0x2c, 0x20, 0x31,
+  0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2f, 0x67,
+  0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x20,
+  0x3d, 0x20, 0x72, 0x67, 0x62, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x67,
+  0x6c, 0x5f, 0x46, 0x72, 0x61, 0x67, 0x43, 0x6f, 0x6c, 0x6f, 0x72, 0x20,
+  0x3d, 0x20, 0x63, 0x6f, 0x6c, 0x3b, 0x0a, 0x7d, 0x0a, 0x0a, 0x0a, 0x00
+};
+unsigned int plain_frag_len = 1152;
+unsigned char vshader_vert[] = {
+  0x61, 0x74, 0x74, 0x72, 0x69, 0x62, 0x75, 0x74, 0x65, 0x20, 0x76, 0x65,
+  0x63, 0x32, 0x20, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x3b, 0x0a, 0x76,
+  0x61, 0x72, 0x79, 0x69, 0x6e, 0x67, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20,
+  0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x76, 0x6f,
+  0x69, 0x64, 0x20, 0x6d, 0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f, 0x69, 0x64,
+  0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f,
+  0x6f, 0x72, 0x64, 0x20, 0x3d, 0x20, 0x30, 0x2e, 0x35, 0x20, 0x2a, 0x20,
+  0x28, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x20, 0x2b, 0x20, 0x31, 0x2e,
+  0x30, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x50, 0x6f,
+  0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x3d, 0x20, 0x76, 0x65, 0x63,
+  0x34, 0x28, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x2c, 0x20, 0x30, 0x2e,
+  0x30, 0x2c, 0x20, 0x31, 0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x00
+};
+unsigned int vshader_vert_len = 144;
+unsigned char vshader_yflip_vert[] = {
+  0x61, 0x74, 0x74, 0x72, 0x69, 0x62, 0x75, 0x74, 0x65, 0x20, 0x76, 0x65,
+  0x63, 0x32, 0x20, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x3b, 0x0a, 0x76,
+  0x61, 0x72, 0x79, 0x69, 0x6e, 0x67, 0x20, 0x76, 0x65, 0x63, 0x32, 0x20,
+  0x74, 0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x3b, 0x0a, 0x76, 0x6f,
+  0x69, 0x64, 0x20, 0x6d, 0x61, 0x69, 0x6e, 0x28, 0x76, 0x6f, 0x69, 0x64,
+  0x29, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x65, 0x78, 0x63, 0x6f,
+  0x6f, 0x72, 0x64, 0x2e, 0x78, 0x20, 0x3d, 0x20, 0x30, 0x2e, 0x35, 0x20,
+  0x2a, 0x20, 0x28, 0x31, 0x2e, 0x30, 0x20, 0x2b, 0x20, 0x76, 0x65, 0x72,
+  0x74, 0x65, 0x78, 0x2e, 0x78, 0x29, 0x3b, 0x0a, 0x20, 0x20, 0x20, 0x74,
+  0x65, 0x78, 0x63, 0x6f, 0x6f, 0x72, 0x64, 0x2e, 0x79, 0x20, 0x3d, 0x20,
+  0x30, 0x2e, 0x35, 0x20, 0x2a, 0x20, 0x28, 0x31, 0x2e, 0x30, 0x20, 0x2d,
+  0x20, 0x76, 0x65, 0x72, 0x74, 0x65, 0x78, 0x2e, 0x79, 0x29, 0x3b, 0x0a,
+  0x20, 0x20, 0x20, 0x67, 0x6c, 0x5f, 0x50, 0x6f, 0x73, 0x69, 0x74, 0x69,
+  0x6f, 0x6e, 0x20, 0x3d, 0x20, 0x76, 0x65, 0x63, 0x34, 0x28, 0x76, 0x65,
+  0x72, 0x74, 0x65, 0x78, 0x2c, 0x20, 0x30, 0x2e, 0x30, 0x2c, 0x20, 0x31,
+  0x2e, 0x30, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x00
+};
+unsigned int vshader_yflip_vert_len = 188;
@@ -1,4 +1,5 @@
 #extension GL_OES_EGL_image_external : require
+precision mediump float;
 uniform samplerExternalOES tex1;
 uniform sampler2D tex2;
 varying vec2 texcoord;
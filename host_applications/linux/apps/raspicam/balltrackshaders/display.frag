@@ -1,4 +1,5 @@
 #extension GL_OES_EGL_image_external : require
+precision mediump float;
 uniform samplerExternalOES tex_camera;
 uniform vec2 tex_unit;
 uniform sampler2D tex_filter;
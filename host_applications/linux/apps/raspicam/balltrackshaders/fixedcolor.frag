@@ -1,3 +1,4 @@
+precision mediump float;
 uniform vec4 col;
 varying vec2 texcoord;
 void main(void) {
@@ -39,6 +39,7 @@
 // Hue [0-360] : 4     6    7     8     9     10    11    12   14    15    16    17    18   45
 // Hue [0-6]   : 0.067 0.10 0.117 0.133 0.150 0.167 0.183 0.20 0.233 0.250 0.267 0.283 0.30 0.75
 #extension GL_OES_EGL_image_external : require
+precision mediump float;
 
 vec2 getFilter(vec4 col) {
     // We use a piecewise definition for Hue.
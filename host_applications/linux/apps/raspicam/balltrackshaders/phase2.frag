@@ -22,6 +22,7 @@
 // Output:                                 |<--             B A             -->|
 // One of the x-sample points is used in both results!
 // OOM:      |-----*-----|-----*-----|-----*-----|-----*-----|-----*-----|-----*-----| (out-of-memory)
+precision mediump float;
 uniform sampler2D tex;
 varying vec2 texcoord;
 uniform vec2 tex_unit;
@@ -15,6 +15,7 @@
 // Output:               |<--             R G             -->|
 // Output:                           |<--             B A             -->|
 // samples:              |-----*-----|-----*-----|-----*-----|-----*-----|
+precision mediump float;
 
 uniform sampler2D tex;
 varying vec2 texcoord; // center of output pixel
@@ -0,0 +1,32 @@
+// Balltrack shader second phase, horizontal half of the separable version
+// Same 12x12 average as phase2.frag, split into this pass and phase2_v.frag.
+// Ouput is 8X smaller in width and 2X smaller in height.
+// We will use GL_LINEAR so that the GPU samples 4 texels at once, so the
+// height halving comes for free.
+// tex_unit is size of input texel
+// In the height dimension, where we have one output:
+// tex_unit:-1  0  1
+// Input:    |--|--|
+// texcoord: |--*--|
+// samples:  |--*--|
+//
+// In the width dimension, where we have two *outputs*, as in phase2.frag:
+// tex_unit:-6    -5    -4    -3    -2    -1     0     1     2     3     4     5     6
+// Input:    |RG|BA|RG|BA|RG|BA|RG|BA|RG|BA|RG|BA|RG|BA|RG|BA|RG|BA|RG|BA|RG|BA|RG|BA|
+// texcoord:             |-----------------------*-----------------------|
+// samples:        |-----*-----|-----*-----|-----*-----|-----*-----|-----*-----|
+// Output:         |<--             R G             -->|
+// Output:                                 |<--             B A             -->|
+precision mediump float;
+uniform sampler2D tex;
+varying vec2 texcoord;
+uniform vec2 tex_unit;
+void main(void) {
+    vec4 both = texture2D(tex, texcoord);
+    vec4 avg1 = both + texture2D(tex, texcoord + vec2(-4,0) * tex_unit)
+                     + texture2D(tex, texcoord + vec2(-2,0) * tex_unit);
+    vec4 avg2 = both + texture2D(tex, texcoord + vec2( 2,0) * tex_unit)
+                     + texture2D(tex, texcoord + vec2( 4,0) * tex_unit);
+    gl_FragColor.rg = (1.0/6.0) * (avg1.rg + avg1.ba);
+    gl_FragColor.ba = (1.0/6.0) * (avg2.rg + avg2.ba);
+}
@@ -0,0 +1,20 @@
+// Balltrack shader second phase, vertical half of the separable version
+// Ouput is 4X smaller in height, input is the output of phase2_h.frag.
+// We will use GL_LINEAR so that the GPU samples 2 rows at once.
+// The output width is the input width, so texcoord is at the center of
+// an input texel in that direction and the packed pairs stay apart.
+// In the height dimension, where we have one output:
+// tex_unit:-4 -3 -2 -1  0  1  2  3  4
+// Input:    |--|--|--|--|--|--|--|--|
+// texcoord:       |-----*-----|
+// samples:     |--*--|--*--|--*--|
+precision mediump float;
+uniform sampler2D tex;
+varying vec2 texcoord;
+uniform vec2 tex_unit;
+void main(void) {
+    vec4 avg = texture2D(tex, texcoord + vec2(0,-2) * tex_unit)
+             + texture2D(tex, texcoord)
+             + texture2D(tex, texcoord + vec2(0, 2) * tex_unit);
+    gl_FragColor = (1.0/3.0) * avg;
+}
@@ -1,4 +1,5 @@
 #extension GL_OES_EGL_image_external : require
+precision mediump float;
 uniform samplerExternalOES tex_rgb;
 uniform samplerExternalOES tex_y;
 uniform samplerExternalOES tex_u;
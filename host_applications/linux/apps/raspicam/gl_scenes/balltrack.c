@@ -27,14 +27,26 @@ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "Balltracker.h"
 #include "BalltrackCore.h"
+#include "BalltrackGovernor.h"
+#include "balltrack.h"
 #include "RaspiTex.h"
 #include "RaspiTexUtil.h"
 #include <GLES2/gl2.h>
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
+#include <string.h>
 
 
+// GLES backend on the camera texture
+static BALLTRACKER* tracker = 0;
+
+BALLTRACKER* balltrack_get_tracker()
+{
+    return tracker;
+}
+
 static const EGLint balltrack_egl_config_attribs[] =
 {
    EGL_RED_SIZE,   8,
@@ -58,7 +70,7 @@ static int balltrack_init(RASPITEX_STATE *raspitex_state)
     if (rc != 0)
         return rc;
 
-    return balltrack_core_init(1, 0);
+    return balltracker_init(tracker);
 }
 
 /* Redraws the scene with the latest luma buffer.
@@ -76,13 +88,39 @@ static int balltrack_redraw(RASPITEX_STATE* state)
     GLCHK(glActiveTexture(GL_TEXTURE4));
     GLCHK(glBindTexture(GL_TEXTURE_EXTERNAL_OES, state->v_texture));
 #endif
-    return balltrack_core_redraw(state->width, state->height, state->texture, GL_TEXTURE_EXTERNAL_OES);
+    BALLTRACK_FRAME frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.width = frame.view_width = state->width;
+    frame.height = frame.view_height = state->height;
+    frame.texture = state->texture;
+    frame.target = GL_TEXTURE_EXTERNAL_OES;
+    frame.pts = state->preview_buf ? state->preview_buf->pts : MMAL_TIME_UNKNOWN;
+    int rc = balltracker_process(tracker, &frame, NULL);
+    governor_update();
+    return rc;
+}
+
+static void balltrack_gl_term(RASPITEX_STATE* state)
+{
+    balltracker_term(tracker);
+    raspitexutil_gl_term(state);
 }
 
 int balltrack_open(RASPITEX_STATE *state)
 {
+   BALLTRACK_CONFIG config;
+
+   if (!tracker)
+      tracker = balltracker_create(&balltrack_backend_gles);
+   if (!tracker)
+      return -1;
+   balltracker_get_config(tracker, &config);
+   config.external_sampler = 1;
+   balltracker_set_config(tracker, &config);
+
    state->ops.gl_init = balltrack_init;
    state->ops.redraw = balltrack_redraw;
+   state->ops.gl_term = balltrack_gl_term;
 #ifdef DO_YUV
    state->ops.update_y_texture = raspitexutil_update_y_texture;
    state->ops.update_u_texture = raspitexutil_update_u_texture;
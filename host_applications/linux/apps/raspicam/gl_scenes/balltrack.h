@@ -32,7 +32,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "RaspiTex.h"
 
+#include "Balltracker.h"
+
 // Called from RaspiBalls.c
 int balltrack_open(RASPITEX_STATE *state);
 
+// The tracker on the camera frames, created by balltrack_open. Its config
+// can be changed until the GL thread starts, and sinks added at any time.
+// Results carry the camera timestamp of the analysed preview frame.
+BALLTRACKER* balltrack_get_tracker();
+
 #endif /* BALLTRACK_H */
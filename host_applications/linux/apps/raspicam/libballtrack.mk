@@ -0,0 +1,19 @@
+# libballtrack for the Makefile builds, such as hello_balltrack.
+# Set BALLTRACK_DIR to this directory before including it.
+# Keep BALLTRACK_SRCS in sync with BALLTRACK_SOURCES in CMakeLists.txt.
+BALLTRACK_SRCS=Balltracker.c BalltrackSource.c BalltrackBackendGLES.c BalltrackBackendCPU.c BalltrackCore.c BalltrackUtil.c BalltrackGrid.c BallAnalysis.c BalltrackCapture.c BalltrackReference.c BalltrackEGL.c
+BALLTRACK_OBJS=$(patsubst %.c, $(BALLTRACK_DIR)/%.o, $(BALLTRACK_SRCS))
+BALLTRACK_LIB=$(BALLTRACK_DIR)/libballtrack.a
+
+$(BALLTRACK_LIB): $(BALLTRACK_OBJS)
+	$(AR) rcs $@ $^
+
+# The shaders are compiled into BalltrackCore
+$(BALLTRACK_DIR)/BalltrackCore.o: $(BALLTRACK_DIR)/balltrackshaders/allshaders.h
+
+$(BALLTRACK_DIR)/balltrackshaders/allshaders.h: $(wildcard $(BALLTRACK_DIR)/balltrackshaders/*.frag $(BALLTRACK_DIR)/balltrackshaders/*.vert)
+	$(MAKE) -C $(BALLTRACK_DIR)/balltrackshaders allshaders.h
+
+.PHONY: balltrack_clean
+balltrack_clean:
+	rm -f $(BALLTRACK_OBJS) $(BALLTRACK_LIB)
@@ -0,0 +1,217 @@
+/**
+ * \file test_balltrack.c
+ * Test for the tracker library without GL.
+ *
+ * The CPU backend has to follow the ball of the synthetic source to
+ * within a grid cell, the sinks have to see every frame in order and
+ * nothing after they are removed, preloaded sources have to give the same
+ * frames again after a rewind, and the I420 conversion has to match BT.601.
+ * The goal detection has to wait for the same time when only every fourth
+ * frame is analysed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../Balltracker.h"
+#include "../BalltrackSource.h"
+#include "test_check.h"
+
+#define SYNTHETIC_FRAMES 24
+
+/// One grid cell is 2/80 wide and 2/45 high in [-1,1] units
+#define MAX_ERROR 0.05f
+
+typedef struct
+{
+   int frames;
+   int64_t last_pts;
+   int in_order;
+} SINK_STATE;
+
+static void sink_frame(const BALLTRACK_FRAME *frame, const BALLTRACK_RESULT *result, void *userdata)
+{
+   SINK_STATE *state = (SINK_STATE *)userdata;
+
+   if (state->frames && result->pts != state->last_pts + 1)
+      state->in_order = 0;
+   state->last_pts = result->pts;
+   state->frames++;
+   CHECK(frame->rgba != NULL, "Frame without pixels");
+}
+
+static void test_cpu_backend(int separable)
+{
+   BALLTRACK_SOURCE *source = balltrack_source_synthetic(SYNTHETIC_FRAMES);
+   BALLTRACKER *tracker = balltracker_create(&balltrack_backend_cpu);
+   BALLTRACK_CONFIG config;
+   BALLTRACKER_STATS stats;
+   SINK_STATE state = { 0, 0, 1 };
+   BALLTRACK_SINK sink = { sink_frame, NULL, &state, NULL };
+   int frames;
+
+   CHECK(source && tracker, "Unable to create the tracker");
+   if (!source || !tracker)
+      return;
+
+   balltracker_get_config(tracker, &config);
+   config.separable = separable;
+   CHECK(balltracker_set_config(tracker, &config) == 0, "Config refused before init");
+   CHECK(balltracker_init(tracker) == 0, "CPU backend init failed");
+   CHECK(balltracker_set_config(tracker, &config) != 0, "Config accepted after init");
+   balltracker_add_sink(tracker, &sink);
+
+   frames = balltracker_run(tracker, source, 0);
+   CHECK(frames == SYNTHETIC_FRAMES, "Ran %d frames", frames);
+   balltracker_get_stats(tracker, &stats);
+   CHECK(stats.analysed == SYNTHETIC_FRAMES, "%u frames analysed", stats.analysed);
+   CHECK(stats.truths == SYNTHETIC_FRAMES, "%u frames with ground truth", stats.truths);
+   CHECK(stats.misses == 0, "Ball missed in %u frames", stats.misses);
+   CHECK(stats.error_max < MAX_ERROR, "Ball off by up to %.4f", stats.error_max);
+   CHECK(state.frames == SYNTHETIC_FRAMES && state.in_order, "Sink saw %d frames, in order %d", state.frames,
+         state.in_order);
+   printf("CPU backend, %s grid: mean error %.4f, max %.4f, %.1f ms per frame\n", separable ? "separable" : "fused",
+          stats.truths ? stats.error_sum / stats.truths : 0.0, stats.error_max,
+          stats.frames ? stats.track_us / 1000.0 / stats.frames : 0.0);
+
+   // Removed sinks see nothing
+   balltracker_remove_sink(tracker, &sink);
+   source->close(source);
+   source = balltrack_source_synthetic(2);
+   balltracker_run(tracker, source, 0);
+   CHECK(state.frames == SYNTHETIC_FRAMES, "Removed sink still called");
+
+   source->close(source);
+   balltracker_destroy(tracker);
+}
+
+static void test_wrong_size(void)
+{
+   BALLTRACKER *tracker = balltracker_create(&balltrack_backend_cpu);
+   BALLTRACK_FRAME frame;
+   uint8_t rgba[16 * 16 * 4];
+
+   memset(&frame, 0, sizeof(frame));
+   memset(rgba, 0, sizeof(rgba));
+   frame.width = 16;
+   frame.height = 16;
+   frame.rgba = rgba;
+   CHECK(balltracker_process(tracker, &frame, NULL) != 0, "Frame processed before init");
+   balltracker_init(tracker);
+   CHECK(balltracker_process(tracker, &frame, NULL) != 0, "CPU backend took a 16x16 frame");
+   balltracker_destroy(tracker);
+}
+
+static void test_preload(void)
+{
+   BALLTRACK_SOURCE *source = balltrack_source_preload(balltrack_source_synthetic(0), 3, 2);
+   BALLTRACK_FRAME first, frame;
+   int count = 0;
+
+   CHECK(source != NULL, "Preload failed");
+   if (!source)
+      return;
+
+   CHECK(source->read(source, &first) == 1, "No first frame");
+   count = 1;
+   while (source->read(source, &frame) == 1)
+      count++;
+   CHECK(count == 6, "%d frames for 3 frames twice", count);
+
+   balltrack_source_rewind(source);
+   CHECK(source->read(source, &frame) == 1 && frame.rgba == first.rgba && frame.truth.x == first.truth.x,
+         "Rewind does not start at the first frame");
+   source->close(source);
+}
+
+static int goal_events;
+
+static void count_goals(const char *event, void *userdata)
+{
+   (void)userdata;
+   if (!strcmp(event, "RG\n") || !strcmp(event, "BG\n"))
+      goal_events++;
+}
+
+/// Shoots the ball into the right goal and leaves it there for `missing` frames.
+/// Returns the number of frames without the ball until the only goal, -1 if there is none.
+static int frames_to_goal(int missing)
+{
+   FIELD field = { -0.8f, 0.8f, -0.8f, 0.8f };
+   POINT ball = { 0.0f, 0.0f };
+   int i, frames = -1, events = goal_events;
+
+   for (i = 0; i <= 8; i++)
+   {
+      ball.x = 0.1f * i;
+      analysis_update(field, ball, 1);
+   }
+   for (i = 1; i <= missing; i++)
+   {
+      analysis_update(field, ball, 0);
+      if (goal_events == events + 1 && frames < 0)
+         frames = i;
+   }
+   return goal_events == events + 1 ? frames : -1;
+}
+
+static void test_analysis_scale(void)
+{
+   int frames;
+
+   analysis_init();
+   analysis_set_debug_fifo(NULL);
+   analysis_set_event_callback(count_goals, NULL);
+
+   // Goals in the first 50 frames are ignored, like goals less than 50 frames apart
+   CHECK(frames_to_goal(50) < 0, "Goal in the first 50 frames");
+   frames = frames_to_goal(50);
+   CHECK(frames == 8, "Goal confirmed after %d frames at the full rate", frames);
+
+   // A quarter of the rate, like the idle profile of the governor.
+   // 8 frames without the ball are 32 at the full rate, 14 are past the
+   // 50 frames between goals.
+   analysis_set_frame_scale(4.0f);
+   frames = frames_to_goal(8);
+   CHECK(frames == 2, "Goal confirmed after %d frames at a quarter of the rate", frames);
+   frames = frames_to_goal(8);
+   CHECK(frames == 2, "Second goal confirmed after %d frames at a quarter of the rate", frames);
+
+   analysis_set_frame_scale(1.0f);
+   analysis_set_event_callback(NULL, NULL);
+}
+
+static void test_yuv(void)
+{
+   // 2x2 frame: white, black, mid grey and a saturated red, one chroma sample
+   uint8_t yuv[6] = { 235, 16, 126, 82, 128, 128 };
+   uint8_t rgba[16];
+
+   balltrack_yuv_to_rgba(yuv, 2, 2, rgba);
+   CHECK(rgba[0] == 255 && rgba[1] == 255 && rgba[2] == 255 && rgba[3] == 255, "White is %d,%d,%d", rgba[0],
+         rgba[1], rgba[2]);
+   CHECK(rgba[4] == 0 && rgba[5] == 0 && rgba[6] == 0, "Black is %d,%d,%d", rgba[4], rgba[5], rgba[6]);
+   CHECK(abs(rgba[8] - 128) <= 1 && rgba[8] == rgba[9] && rgba[9] == rgba[10], "Grey is %d,%d,%d", rgba[8],
+         rgba[9], rgba[10]);
+
+   // Y, U, V of pure red in BT.601 limited range
+   yuv[0] = yuv[1] = yuv[2] = yuv[3] = 82;
+   yuv[4] = 90;
+   yuv[5] = 240;
+   balltrack_yuv_to_rgba(yuv, 2, 2, rgba);
+   CHECK(rgba[0] >= 253 && rgba[1] <= 2 && rgba[2] <= 2, "Red is %d,%d,%d", rgba[0], rgba[1], rgba[2]);
+}
+
+int main(int argc, char **argv)
+{
+   test_yuv();
+   test_preload();
+   test_analysis_scale();
+   test_wrong_size();
+   test_cpu_backend(0);
+   test_cpu_backend(1);
+
+   return test_result();
+}
@@ -0,0 +1,448 @@
+/**
+ * \file test_capture.c
+ * Test for the frame capture ring of raspiballs.
+ *
+ * The GL side of BalltrackCore is played by this test: the ring textures
+ * are buffers in memory, filled with a pattern of the frame number, and
+ * read back the way balltrack_capture_readback does once per frame. Dumps
+ * are requested at different points and the files the writer thread saves
+ * are checked against the pattern. PNG files are decoded again to check
+ * the stored deflate stream and the checksums.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "../BalltrackCapture.h"
+#include "test_check.h"
+
+#define SLOTS 8
+
+static char directory[] = "/tmp/test_capture_XXXXXX";
+static char prefix[128];
+
+static uint8_t *textures[SLOTS];
+static int width, height;
+static uint32_t frame_number;
+static uint32_t max_call_us;       /// Longest capture call on the render side
+static int skip_readback;
+
+static uint64_t now_us(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint8_t pattern(uint32_t frame, size_t i)
+{
+   return (uint8_t)(frame * 37 + i * 7 + (i >> 12));
+}
+
+static void time_call(uint64_t start)
+{
+   uint64_t elapsed = now_us() - start;
+
+   if (elapsed > max_call_us)
+      max_call_us = (uint32_t)elapsed;
+}
+
+/// One redraw of BalltrackCore: read back a frozen slot, then capture the new frame
+static void render_frame(void)
+{
+   uint64_t start;
+   uint8_t *pixels;
+   size_t size = (size_t)width * height * 4, i;
+   int slot = -1;
+
+   if (!skip_readback)
+   {
+      start = now_us();
+      slot = capture_next_readback(&pixels);
+      time_call(start);
+   }
+   if (slot >= 0)
+   {
+      memcpy(pixels, textures[slot], size);
+      start = now_us();
+      capture_readback_done(slot, 0);
+      time_call(start);
+   }
+
+   frame_number++;
+   start = now_us();
+   slot = capture_begin_frame(frame_number);
+   time_call(start);
+   if (slot >= 0)
+   {
+      for (i = 0; i < size; i++)
+         textures[slot][i] = pattern(frame_number, i);
+   }
+}
+
+static int wait_written(uint32_t written, int timeout_ms)
+{
+   CAPTURE_STATS stats;
+
+   while (timeout_ms-- > 0)
+   {
+      capture_get_stats(&stats);
+      if (stats.written + stats.failed >= written)
+         return 1;
+      usleep(1000);
+   }
+   return 0;
+}
+
+static int setup(int kind, int format, const char *file_prefix)
+{
+   int i;
+
+   if (capture_init(SLOTS, kind, format, file_prefix) != 0)
+      return -1;
+   capture_get_size(&width, &height);
+   for (i = 0; i < SLOTS; i++)
+      textures[i] = malloc((size_t)width * height * 4);
+   frame_number = 0;
+   return 0;
+}
+
+static void teardown(void)
+{
+   int i;
+
+   capture_destroy();
+   for (i = 0; i < SLOTS; i++)
+      free(textures[i]);
+}
+
+static uint8_t *read_file(const char *filename, size_t *size)
+{
+   FILE *f = fopen(filename, "rb");
+   uint8_t *data;
+   long length;
+
+   if (!f)
+      return NULL;
+   fseek(f, 0, SEEK_END);
+   length = ftell(f);
+   fseek(f, 0, SEEK_SET);
+   data = malloc(length ? length : 1);
+   if (data && fread(data, 1, length, f) != (size_t)length)
+   {
+      free(data);
+      data = NULL;
+   }
+   fclose(f);
+   *size = length;
+   return data;
+}
+
+static int check_raw(uint32_t frame)
+{
+   char filename[256];
+   size_t size, i;
+   uint8_t *data;
+   int ok;
+
+   snprintf(filename, sizeof(filename), "%s%06u.rgba", prefix, frame);
+   data = read_file(filename, &size);
+   if (!data)
+      return 0;
+   ok = size == (size_t)width * height * 4;
+   for (i = 0; ok && i < size; i++)
+      ok = data[i] == pattern(frame, i);
+   free(data);
+   unlink(filename);
+   return ok;
+}
+
+static uint32_t be32(const uint8_t *p)
+{
+   return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint32_t crc32_bitwise(const uint8_t *data, size_t size)
+{
+   uint32_t crc = 0xffffffffu;
+   size_t i;
+   int k;
+
+   for (i = 0; i < size; i++)
+   {
+      crc ^= data[i];
+      for (k = 0; k < 8; k++)
+         crc = (crc >> 1) ^ (0xedb88320u & -(crc & 1));
+   }
+   return ~crc;
+}
+
+/**
+ * Decode a PNG of capture_encode_png, checking all chunk CRCs and the
+ * Adler-32 of the stored deflate stream, into top-first RGBA rows.
+ */
+static int decode_png(const uint8_t *png, size_t size, int w, int h, uint8_t *rgba)
+{
+   static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+   size_t offset = 8, raw_size = (size_t)h * (w * 4 + 1), got = 0, i;
+   uint8_t *raw = malloc(raw_size);
+   uint32_t s1 = 1, s2 = 0;
+   int ended = 0, ok = 1;
+
+   if (!raw || size < 8 || memcmp(png, signature, 8))
+      ok = 0;
+
+   while (ok && !ended && offset + 12 <= size)
+   {
+      uint32_t length = be32(png + offset);
+      const uint8_t *type = png + offset + 4;
+      const uint8_t *data = png + offset + 8;
+
+      if (offset + 12 + length > size || crc32_bitwise(type, length + 4) != be32(data + length))
+      {
+         ok = 0;
+         break;
+      }
+
+      if (!memcmp(type, "IHDR", 4))
+         ok = length == 13 && be32(data) == (uint32_t)w && be32(data + 4) == (uint32_t)h && data[8] == 8 && data[9] == 6;
+      else if (!memcmp(type, "IDAT", 4))
+      {
+         const uint8_t *p = data + 2, *end = data + length - 4;
+         int last = 0;
+
+         ok = length > 6 && data[0] == 0x78 && ((data[0] << 8) | data[1]) % 31 == 0;
+         while (ok && !last && p + 5 <= end)
+         {
+            uint32_t n = p[1] | (p[2] << 8);
+
+            last = p[0] & 1;
+            ok = (p[0] >> 1) == 0 && (n ^ (p[3] | (p[4] << 8))) == 0xffff && p + 5 + n <= end && got + n <= raw_size;
+            if (ok)
+            {
+               memcpy(raw + got, p + 5, n);
+               got += n;
+               p += 5 + n;
+            }
+         }
+         for (i = 0; ok && i < got; i++)
+         {
+            s1 = (s1 + raw[i]) % 65521;
+            s2 = (s2 + s1) % 65521;
+         }
+         ok = ok && last && p == end && be32(end) == ((s2 << 16) | s1);
+      }
+      else if (!memcmp(type, "IEND", 4))
+         ended = 1;
+      offset += 12 + length;
+   }
+   ok = ok && ended && offset == size && got == raw_size;
+
+   for (i = 0; ok && i < (size_t)h; i++)
+   {
+      ok = raw[i * (w * 4 + 1)] == 0;
+      memcpy(rgba + i * w * 4, raw + i * (w * 4 + 1) + 1, w * 4);
+   }
+
+   free(raw);
+   return ok;
+}
+
+static void test_png(void)
+{
+   static const int sizes[][2] = { { 1, 1 }, { 7, 5 }, { 320, 360 }, { 640, 360 } };
+   unsigned k;
+
+   for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+   {
+      int w = sizes[k][0], h = sizes[k][1], y;
+      size_t image = (size_t)w * h * 4, i, size = capture_png_size(w, h), encoded;
+      uint8_t *rgba = malloc(image), *decoded = malloc(image), *png = malloc(size);
+      uint64_t start;
+
+      for (i = 0; i < image; i++)
+         rgba[i] = pattern(k, i);
+
+      CHECK(capture_encode_png(rgba, w, h, png, size - 1) == 0, "Encoded %dx%d into a short buffer", w, h);
+      start = now_us();
+      encoded = capture_encode_png(rgba, w, h, png, size);
+      if (w == CAPTURE_SOURCE_WIDTH)
+         printf("PNG of %dx%d: %zu bytes in %llu us\n", w, h, encoded, (unsigned long long)(now_us() - start));
+      CHECK(encoded == size, "PNG of %dx%d is %zu bytes, expected %zu", w, h, encoded, size);
+      CHECK(decode_png(png, encoded, w, h, decoded), "PNG of %dx%d does not decode", w, h);
+
+      // GL rows are bottom first, PNG rows top first
+      for (y = 0; y < h; y++)
+         CHECK(!memcmp(decoded + (size_t)y * w * 4, rgba + (size_t)(h - 1 - y) * w * 4, w * 4),
+               "Row %d of the %dx%d PNG is wrong", y, w, h);
+
+      free(rgba);
+      free(decoded);
+      free(png);
+   }
+}
+
+static void test_dump(void)
+{
+   CAPTURE_STATS stats;
+   uint32_t frame;
+   int i, n;
+
+   CHECK(setup(CAPTURE_FILTER, CAPTURE_RAW, prefix) == 0, "Unable to set up the ring");
+   CHECK(width == CAPTURE_FILTER_WIDTH && height == CAPTURE_FILTER_HEIGHT, "Filter frames are %dx%d", width, height);
+   CHECK(capture_get_slots() == SLOTS && capture_get_kind() == CAPTURE_FILTER, "Ring set up wrong");
+   CHECK(capture_request(4, 0) == 0, "Dumped from an empty ring");
+
+   for (i = 0; i < 20; i++)
+      render_frame();
+
+   // Frames 15 to 18, two before the newest
+   n = capture_request(4, 2);
+   CHECK(n == 4, "Request of 4 frames froze %d", n);
+   CHECK(capture_request(4, 2) == 0, "Frozen frames were requested again");
+   CHECK(capture_request(4, SLOTS) == 0, "Frames that left the ring were requested");
+   for (i = 0; i < 10; i++)
+      render_frame();
+   CHECK(wait_written(4, 5000), "Dump not written");
+   for (frame = 15; frame <= 18; frame++)
+      CHECK(check_raw(frame), "Frame %u not dumped correctly", frame);
+   CHECK(!check_raw(14) && !check_raw(19), "Frames outside the request were dumped");
+
+   // Freeze the whole ring, new frames are skipped until it is read back
+   n = capture_request(SLOTS, 0);
+   CHECK(n == SLOTS, "Whole ring request froze %d", n);
+   frame = frame_number;
+   skip_readback = 1;
+   for (i = 0; i < 3; i++)
+      render_frame();
+   skip_readback = 0;
+   for (i = 0; i < 3 * SLOTS; i++)
+      render_frame();
+   CHECK(wait_written(4 + SLOTS, 5000), "Whole ring not written");
+   for (i = 0; i < SLOTS; i++)
+      CHECK(check_raw(frame - i), "Frame %u of the whole ring not dumped correctly", frame - i);
+
+   capture_get_stats(&stats);
+   CHECK(stats.captured + stats.missed == frame_number, "%u captured and %u missed of %u frames",
+         stats.captured, stats.missed, frame_number);
+   // A readback may also be put off to the next frame while the writer has the lock
+   CHECK(stats.missed >= 3, "%u frames missed while the ring was frozen, expected 3", stats.missed);
+   CHECK(stats.requested == 4 + SLOTS && stats.written == 4 + SLOTS && stats.failed == 0,
+         "%u requested, %u written, %u failed", stats.requested, stats.written, stats.failed);
+
+   // The newest frame is captured again once its slot is free
+   n = capture_request(1, 0);
+   CHECK(n == 1, "Newest frame not requested after the ring was read back");
+   render_frame();
+   render_frame();
+   CHECK(wait_written(5 + SLOTS, 5000) && check_raw(frame_number - 2), "Newest frame not dumped");
+
+   teardown();
+}
+
+static void test_slow_writer(void)
+{
+   char bad_prefix[256];
+   CAPTURE_STATS stats;
+   int i, requested = 0;
+
+   // Writes fail, the render side must not notice
+   snprintf(bad_prefix, sizeof(bad_prefix), "%s/missing/frame", directory);
+   CHECK(setup(CAPTURE_SOURCE, CAPTURE_PNG, bad_prefix) == 0, "Unable to set up the ring");
+   CHECK(width == CAPTURE_SOURCE_WIDTH && height == CAPTURE_SOURCE_HEIGHT, "Source frames are %dx%d", width, height);
+
+   max_call_us = 0;
+   for (i = 0; i < 60; i++)
+   {
+      if (i % 10 == 0)
+         requested += capture_request(SLOTS, 0);
+      render_frame();
+   }
+
+   // Keep rendering until everything requested went through the writer
+   for (i = 0; i < 1000; i++)
+   {
+      capture_get_stats(&stats);
+      if (stats.written + stats.failed == stats.requested)
+         break;
+      render_frame();
+      usleep(1000);
+   }
+   CHECK(stats.written == 0 && stats.failed > 0, "%u written and %u failed to a missing directory",
+         stats.written, stats.failed);
+   CHECK(stats.requested == (uint32_t)requested, "%u requested, expected %d", stats.requested, requested);
+   printf("Longest capture call on the render thread: %u us\n", max_call_us);
+
+   teardown();
+}
+
+static void test_png_files(void)
+{
+   char filename[256];
+   size_t size;
+   uint8_t *data, *decoded;
+   uint32_t frame;
+   int i, y;
+
+   CHECK(setup(CAPTURE_SOURCE, CAPTURE_PNG, prefix) == 0, "Unable to set up the ring");
+   for (i = 0; i < 5; i++)
+      render_frame();
+   CHECK(capture_request(2, 0) == 2, "PNG request");
+   for (i = 0; i < 3; i++)
+      render_frame();
+   CHECK(wait_written(2, 5000), "PNG dump not written");
+
+   decoded = malloc((size_t)width * height * 4);
+   for (frame = 4; frame <= 5; frame++)
+   {
+      snprintf(filename, sizeof(filename), "%s%06u.png", prefix, frame);
+      data = read_file(filename, &size);
+      CHECK(data && size == capture_png_size(width, height), "PNG of frame %u missing or wrong size", frame);
+      if (data && decode_png(data, size, width, height, decoded))
+      {
+         for (y = 0; y < height; y++)
+         {
+            size_t row = (size_t)(height - 1 - y) * width * 4, x;
+            for (x = 0; x < (size_t)width * 4; x++)
+               if (decoded[(size_t)y * width * 4 + x] != pattern(frame, row + x))
+                  break;
+            if (x < (size_t)width * 4)
+            {
+               CHECK(0, "Row %d of the PNG of frame %u is wrong", y, frame);
+               break;
+            }
+         }
+      }
+      else
+         CHECK(0, "PNG of frame %u does not decode", frame);
+      free(data);
+      unlink(filename);
+   }
+   free(decoded);
+
+   teardown();
+}
+
+int main(int argc, char **argv)
+{
+   if (!mkdtemp(directory))
+   {
+      fprintf(stderr, "Unable to create %s\n", directory);
+      return 1;
+   }
+   snprintf(prefix, sizeof(prefix), "%s/frame", directory);
+
+   test_png();
+   test_dump();
+   test_slow_writer();
+   test_png_files();
+
+   rmdir(directory);
+
+   return test_result();
+}
@@ -0,0 +1,29 @@
+/**
+ * \file test_check.h
+ * Checks shared by the raspiballs tests.
+ */
+
+#ifndef TEST_CHECK_H_
+#define TEST_CHECK_H_
+
+#include <stdio.h>
+
+/// Number of failed checks
+static int error_count = 0;
+
+/// Report a failed check with a printf style message and carry on
+#define CHECK(cond, ...) \
+   do { if (!(cond)) { fprintf(stderr, "*** " __VA_ARGS__); fprintf(stderr, "\n"); error_count++; } } while (0)
+
+/// Print the outcome of the checks, to be returned from main
+static int test_result(void)
+{
+   if (error_count)
+      fprintf(stderr, "*** %d errors reported\n", error_count);
+   else
+      printf("All tests passed\n");
+
+   return error_count;
+}
+
+#endif
@@ -0,0 +1,302 @@
+/**
+ * \file test_highlights.c
+ * Test for the highlight index of raspiballs.
+ *
+ * Records two games of synthetic keyframes and events into an index,
+ * with a crash in between that leaves a partial entry, and checks that
+ * every event is found again by type and number and by time. The games
+ * record to different video files, and every event must point into the
+ * video of its own game. A large
+ * index is used to time the lookups.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include "interface/vcos/vcos.h"
+
+#include "../RaspiHighlights.h"
+#include "test_check.h"
+
+#define FRAME_US        25000
+#define INTRA_PERIOD    10
+#define FRAME_BYTES     1000
+#define SEGMENT_FRAMES  400
+#define GAME_FRAMES     3000
+#define MAX_EVENTS      1024
+#define BIG_EVENTS      200000
+
+static char directory[] = "/tmp/test_highlights_XXXXXX";
+static char index_name[128];
+static char video_pattern[2][128];
+
+typedef struct
+{
+   uint32_t game;
+   int type;
+   int team;
+   uint32_t n;
+   int64_t pts;
+   uint32_t segment;
+   uint64_t offset;
+   const char *video;
+} EVENT_T;
+
+static EVENT_T events[MAX_EVENTS];
+static int event_count;
+
+/// Event of a frame, if any. Frames can have at most one event here.
+static int frame_event(int frame, int *type, int *team, float *speed)
+{
+   *team = 0;
+   *speed = 0.0f;
+   if (frame % 37 == 5)
+   {
+      *type = RASPIHIGHLIGHT_GOAL;
+      *team = 1 + (frame / 37) % 2;
+      return 1;
+   }
+   if (frame % 23 == 7)
+   {
+      *type = RASPIHIGHLIGHT_SAVE;
+      return 1;
+   }
+   if (frame % 29 == 11)
+   {
+      *type = RASPIHIGHLIGHT_SHOT;
+      *speed = (frame % 100) / 100.0f;
+      return 1;
+   }
+   return 0;
+}
+
+/// Records one game, the way the encoder and tracker callbacks of raspiballs do
+static void record_game(uint32_t game, const char *video)
+{
+   RASPIHIGHLIGHT_T *highlight = raspihighlight_open(index_name, video);
+   uint32_t count[RASPIHIGHLIGHT_TYPES] = { 0 };
+   int frame;
+
+   CHECK(highlight != NULL, "Unable to open %s for game %u", index_name, game);
+   if (!highlight)
+      return;
+
+   // No keyframe yet, the event is not indexed
+   CHECK(raspihighlight_add(highlight, RASPIHIGHLIGHT_SAVE, 0, 0, 0.0f) < 0, "Event before the first keyframe indexed");
+
+   for (frame = 0; frame < GAME_FRAMES; frame++)
+   {
+      int64_t pts = (int64_t)frame * FRAME_US;
+      uint32_t segment = 1 + frame / SEGMENT_FRAMES;
+      int type, team;
+      float speed;
+
+      if (frame % INTRA_PERIOD == 0)
+         raspihighlight_keyframe(highlight, segment, (uint64_t)(frame % SEGMENT_FRAMES) * FRAME_BYTES, pts);
+
+      if (frame_event(frame, &type, &team, &speed) && event_count < MAX_EVENTS)
+      {
+         EVENT_T *event = &events[event_count++];
+
+         // The tracker reports events a few frames after the encoder saw the frame
+         CHECK(raspihighlight_add(highlight, type, team, pts, speed) == 0, "Unable to add event of frame %d", frame);
+         event->game = game;
+         event->type = type;
+         event->team = team;
+         event->n = ++count[type];
+         event->pts = pts;
+         event->segment = segment;
+         event->offset = (uint64_t)(frame / INTRA_PERIOD * INTRA_PERIOD % SEGMENT_FRAMES) * FRAME_BYTES;
+         event->video = video;
+      }
+   }
+
+   raspihighlight_close(highlight);
+}
+
+static void check_index(void)
+{
+   RASPIHIGHLIGHT_INDEX_T index;
+   int i;
+
+   CHECK(raspihighlight_map(index_name, &index) == 0, "Unable to map %s", index_name);
+   if (!index.map)
+      return;
+
+   CHECK(index.count == event_count, "%d entries for %d events", index.count, event_count);
+   for (i = 0; i < event_count && i < index.count; i++)
+   {
+      const RASPIHIGHLIGHT_ENTRY_T *entry = &index.entries[i];
+      const EVENT_T *event = &events[i];
+      char filename[256], expected[256];
+      int found;
+
+      CHECK(entry->game == event->game && entry->type == event->type && entry->team == event->team &&
+            entry->count[event->type] == event->n && entry->pts == event->pts,
+            "Entry %d is game %u type %d %u at %lld", i, entry->game, entry->type,
+            entry->count[entry->type % RASPIHIGHLIGHT_TYPES], (long long)entry->pts);
+      CHECK(entry->segment == event->segment && entry->keyframe_offset == event->offset,
+            "Entry %d points to segment %u offset %llu, expected %u offset %llu", i, entry->segment,
+            (unsigned long long)entry->keyframe_offset, event->segment, (unsigned long long)event->offset);
+      CHECK(entry->keyframe_pts <= entry->pts && entry->pts - entry->keyframe_pts < INTRA_PERIOD * FRAME_US,
+            "Entry %d keyframe at %lld for event at %lld", i, (long long)entry->keyframe_pts, (long long)entry->pts);
+
+      found = raspihighlight_find_event(&index, event->game, event->type, event->n);
+      CHECK(found == i, "Event %d of type %d in game %u found at %d, expected %d", event->n, event->type, event->game, found, i);
+      found = raspihighlight_find_pts(&index, event->game, event->pts + FRAME_US / 2);
+      CHECK(found == i, "Event at %lld us in game %u found at %d, expected %d", (long long)event->pts, event->game, found, i);
+
+      raspihighlight_segment_filename(&index, entry, filename, sizeof(filename));
+      snprintf(expected, sizeof(expected), event->video, (int)event->segment);
+      CHECK(!strcmp(filename, expected), "Entry %d in %s, expected %s", i, filename, expected);
+   }
+
+   CHECK(raspihighlight_find_event(&index, 1, RASPIHIGHLIGHT_GOAL, 1000) < 0, "Found a goal that was not scored");
+   CHECK(raspihighlight_find_event(&index, 3, RASPIHIGHLIGHT_GOAL, 1) < 0, "Found a goal in a game not played");
+   CHECK(raspihighlight_find_event(&index, 1, RASPIHIGHLIGHT_GOAL, 0) < 0, "Found goal 0");
+   CHECK(raspihighlight_find_pts(&index, 2, -1) < 0, "Found an event before the game");
+   CHECK(index.game_count == 2, "%d game records for 2 games", index.game_count);
+
+   raspihighlight_unmap(&index);
+}
+
+/// An index written before game records existed uses the video of the header
+static void check_old_index(void)
+{
+   RASPIHIGHLIGHT_INDEX_T index;
+   char games[160], filename[256], expected[256];
+
+   snprintf(games, sizeof(games), "%s" RASPIHIGHLIGHT_GAMES_SUFFIX, index_name);
+   unlink(games);
+
+   CHECK(raspihighlight_map(index_name, &index) == 0, "Unable to map %s", index_name);
+   if (!index.map)
+      return;
+   CHECK(index.games == NULL && index.count == event_count, "%d game records without a game file", index.game_count);
+   if (index.count > 0)
+   {
+      raspihighlight_segment_filename(&index, &index.entries[index.count - 1], filename, sizeof(filename));
+      snprintf(expected, sizeof(expected), video_pattern[0], (int)events[event_count - 1].segment);
+      CHECK(!strcmp(filename, expected), "Entry of an old index in %s, expected %s", filename, expected);
+   }
+   raspihighlight_unmap(&index);
+}
+
+static void test_parse(void)
+{
+   RASPIHIGHLIGHT_TYPE_T type;
+   int team;
+   float speed;
+
+   CHECK(raspihighlight_parse_event("RG\n", &type, &team, &speed) && type == RASPIHIGHLIGHT_GOAL && team == 1, "RG");
+   CHECK(raspihighlight_parse_event("BG\n", &type, &team, &speed) && type == RASPIHIGHLIGHT_GOAL && team == 2, "BG");
+   CHECK(raspihighlight_parse_event("SAVE\n", &type, &team, &speed) && type == RASPIHIGHLIGHT_SAVE, "SAVE");
+   CHECK(raspihighlight_parse_event("SHOT 0.2500\n", &type, &team, &speed) && type == RASPIHIGHLIGHT_SHOT &&
+         speed == 0.25f, "SHOT");
+   CHECK(!raspihighlight_parse_event("GOAL CANCEL\n", &type, &team, &speed), "GOAL CANCEL");
+   CHECK(!raspihighlight_parse_event("SCOREDBY 3\n", &type, &team, &speed), "SCOREDBY");
+}
+
+/// Times lookups in an index of many games
+static void test_big(void)
+{
+   char big_name[128];
+   RASPIHIGHLIGHT_INDEX_T index;
+   RASPIHIGHLIGHT_T *highlight = NULL;
+   struct timespec start, end;
+   double elapsed;
+   int i, lookups = 100000, misses = 0;
+
+   snprintf(big_name, sizeof(big_name), "%s/big.hli", directory);
+   for (i = 0; i < BIG_EVENTS; i++)
+   {
+      // 100 goals a game
+      if (i % 100 == 0)
+      {
+         raspihighlight_close(highlight);
+         highlight = raspihighlight_open(big_name, "video.h264");
+         CHECK(highlight != NULL, "Unable to open %s", big_name);
+         if (!highlight)
+            return;
+         raspihighlight_keyframe(highlight, 1, 0, 0);
+      }
+      raspihighlight_add(highlight, RASPIHIGHLIGHT_GOAL, 1, (int64_t)i * FRAME_US, 0.0f);
+   }
+   raspihighlight_close(highlight);
+
+   CHECK(raspihighlight_map(big_name, &index) == 0, "Unable to map %s", big_name);
+   if (!index.map)
+      return;
+   CHECK(index.count == BIG_EVENTS, "%d entries in big index", index.count);
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   for (i = 0; i < lookups; i++)
+   {
+      uint32_t game = 1 + (uint32_t)(i * 7919) % (BIG_EVENTS / 100);
+      uint32_t n = 1 + (uint32_t)(i * 31) % 100;
+
+      if (raspihighlight_find_event(&index, game, RASPIHIGHLIGHT_GOAL, n) != (int)((game - 1) * 100 + n - 1))
+         misses++;
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   CHECK(misses == 0, "%d lookups in big index failed", misses);
+
+   elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+   printf("%d lookups in %d entries: %.3f us per lookup\n", lookups, index.count, 1e6 * elapsed / lookups);
+
+   raspihighlight_unmap(&index);
+   unlink(big_name);
+   strcat(big_name, RASPIHIGHLIGHT_GAMES_SUFFIX);
+   unlink(big_name);
+}
+
+int main(int argc, char **argv)
+{
+   char partial[10], games[160];
+   int fd;
+
+   (void)argc;
+   (void)argv;
+
+   vcos_init();
+
+   if (!mkdtemp(directory))
+   {
+      fprintf(stderr, "Unable to create %s\n", directory);
+      return 1;
+   }
+   snprintf(index_name, sizeof(index_name), "%s/highlights.hli", directory);
+   snprintf(video_pattern[0], sizeof(video_pattern[0]), "%s/video%%04d.h264", directory);
+   snprintf(video_pattern[1], sizeof(video_pattern[1]), "%s/game2_%%04d.h264", directory);
+
+   test_parse();
+
+   record_game(1, video_pattern[0]);
+
+   // A crash in the middle of writing an entry
+   memset(partial, 0xff, sizeof(partial));
+   fd = open(index_name, O_WRONLY | O_APPEND);
+   CHECK(fd >= 0 && write(fd, partial, sizeof(partial)) == sizeof(partial), "Unable to append partial entry");
+   if (fd >= 0)
+      close(fd);
+
+   // Reopened with other video files
+   record_game(2, video_pattern[1]);
+   check_index();
+
+   CHECK(raspihighlight_open(index_name, "video%s.h264") == NULL, "Opened with an unsafe video filename");
+   check_old_index();
+
+   test_big();
+
+   unlink(index_name);
+   snprintf(games, sizeof(games), "%s" RASPIHIGHLIGHT_GAMES_SUFFIX, index_name);
+   unlink(games);
+   rmdir(directory);
+
+   return test_result();
+}
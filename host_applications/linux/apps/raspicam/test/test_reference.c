@@ -0,0 +1,229 @@
+/**
+ * \file test_reference.c
+ * Test for the CPU reference model of the balltrack filter passes.
+ *
+ * The fused phase 2 and the separable phase 2 have to give the same grid
+ * up to the rounding of the intermediate render target, on a synthetic
+ * table and on noise. The fused grid is also checked against a plain
+ * 12x12 box filter of the phase 1 pixels, which is what the sample
+ * positions in phase2.frag work out to, and the ball has to show up in
+ * the grid cell it was drawn in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "../BalltrackReference.h"
+#include "test_check.h"
+
+#define BALL_X      600
+#define BALL_Y      300
+#define BALL_RADIUS 10
+
+/// Intermediate rounding is at most half a step in each of the two
+/// separable passes, on top of the final rounding both versions share
+#define SEPARABLE_TOLERANCE (1.5f / 255.0f)
+#define BOX_TOLERANCE       (0.6f / 255.0f)
+
+static uint64_t now_us(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void set_pixel(uint8_t *rgba, int x, int y, uint8_t r, uint8_t g, uint8_t b)
+{
+   uint8_t *p = rgba + 4 * (y * REFERENCE_SOURCE_WIDTH + x);
+
+   p[0] = r;
+   p[1] = g;
+   p[2] = b;
+   p[3] = 255;
+}
+
+/// Dark border, green field, two red players and a yellow-orange ball
+static void draw_table(uint8_t *rgba)
+{
+   int x, y;
+
+   for (y = 0; y < REFERENCE_SOURCE_HEIGHT; y++)
+   {
+      for (x = 0; x < REFERENCE_SOURCE_WIDTH; x++)
+      {
+         int dx = x - BALL_X, dy = y - BALL_Y;
+
+         if (dx * dx + dy * dy <= BALL_RADIUS * BALL_RADIUS)
+            set_pixel(rgba, x, y, 230, 180, 30);
+         else if ((x >= 300 && x < 330 && y >= 200 && y < 260) || (x >= 900 && x < 930 && y >= 400 && y < 460))
+            set_pixel(rgba, x, y, 200, 30, 40);
+         else if (x >= 100 && x < 1180 && y >= 60 && y < 660)
+            set_pixel(rgba, x, y, 40, 140, 60);
+         else
+            set_pixel(rgba, x, y, 20, 20, 20);
+      }
+   }
+}
+
+static void draw_noise(uint8_t *rgba)
+{
+   int i;
+
+   srand(1234);
+   for (i = 0; i < REFERENCE_SOURCE_WIDTH * REFERENCE_SOURCE_HEIGHT * 4; i++)
+      rgba[i] = rand() & 0xff;
+}
+
+/// Largest difference between two grids, leaving out `border` cells at the edges
+static float max_difference(const REFERENCE_TEXTURE *a, const REFERENCE_TEXTURE *b, int border)
+{
+   float diff = 0.0f;
+   int x, y, c;
+
+   for (y = border; y < a->height - border; y++)
+      for (x = border; x < a->width - border; x++)
+         for (c = 0; c < 4; c++)
+         {
+            float d = fabsf(a->data[4 * (y * a->width + x) + c] - b->data[4 * (y * b->width + x) + c]);
+            if (d > diff)
+               diff = d;
+         }
+   return diff;
+}
+
+/// Filter value `channel` (0 ball, 1 field) of unpacked pixel x,y of a packed texture
+static float unpacked(const REFERENCE_TEXTURE *tex, int x, int y, int channel)
+{
+   if (x < 0) x = 0;
+   if (y < 0) y = 0;
+   if (x > 2 * tex->width - 1) x = 2 * tex->width - 1;
+   if (y > tex->height - 1) y = tex->height - 1;
+   return tex->data[4 * (y * tex->width + x / 2) + 2 * (x & 1) + channel];
+}
+
+/// Each grid pixel averages 12x12 phase 1 pixels around its own 8x8
+static void check_box_filter(const REFERENCE_TEXTURE *phase1, const REFERENCE_TEXTURE *grid)
+{
+   float diff = 0.0f;
+   int x, y, i, j, c;
+
+   for (y = 1; y < grid->height - 1; y++)
+      for (x = 2; x < 2 * grid->width - 2; x++)
+         for (c = 0; c < 2; c++)
+         {
+            float sum = 0.0f, d;
+
+            for (j = -2; j < 10; j++)
+               for (i = -2; i < 10; i++)
+                  sum += unpacked(phase1, 8 * x + i, 8 * y + j, c);
+            d = fabsf(sum / 144.0f - unpacked(grid, x, y, c));
+            if (d > diff)
+               diff = d;
+         }
+
+   CHECK(diff <= BOX_TOLERANCE, "Fused grid differs from a 12x12 box filter by %.4f", diff);
+}
+
+static void find_ball(const REFERENCE_TEXTURE *grid, int *bx, int *by)
+{
+   float best = -1.0f;
+   int x, y;
+
+   for (y = 0; y < grid->height; y++)
+      for (x = 0; x < 2 * grid->width; x++)
+         if (unpacked(grid, x, y, 0) > best)
+         {
+            best = unpacked(grid, x, y, 0);
+            *bx = x;
+            *by = y;
+         }
+}
+
+static void test_frame(const char *name, const uint8_t *rgba, int table)
+{
+   REFERENCE_TEXTURE source, phase1, fused, separable;
+   uint64_t t0, t1, t2;
+   float diff;
+   int bx = -1, by = -1;
+
+   reference_texture_init(&source, REFERENCE_SOURCE_WIDTH, REFERENCE_SOURCE_HEIGHT);
+   reference_texture_init(&phase1, REFERENCE_PHASE1_WIDTH, REFERENCE_PHASE1_HEIGHT);
+   reference_texture_init(&fused, REFERENCE_GRID_WIDTH, REFERENCE_GRID_HEIGHT);
+   reference_texture_init(&separable, REFERENCE_GRID_WIDTH, REFERENCE_GRID_HEIGHT);
+
+   t0 = now_us();
+   CHECK(reference_grid(rgba, 0, &fused) == 0, "%s: fused grid failed", name);
+   t1 = now_us();
+   CHECK(reference_grid(rgba, 1, &separable) == 0, "%s: separable grid failed", name);
+   t2 = now_us();
+   printf("%s: fused %.1f ms, separable %.1f ms on the CPU\n", name, (t1 - t0) / 1000.0, (t2 - t1) / 1000.0);
+
+   diff = max_difference(&fused, &separable, 1);
+   CHECK(diff <= SEPARABLE_TOLERANCE, "%s: separable grid differs by %.4f", name, diff);
+   printf("%s: separable grid differs by %.1f/255 inside, %.1f/255 at the edges\n", name, diff * 255.0f,
+          max_difference(&fused, &separable, 0) * 255.0f);
+
+   reference_texture_from_rgba(&source, rgba);
+   reference_phase1(&source, &phase1);
+   check_box_filter(&phase1, &fused);
+
+   if (table)
+   {
+      find_ball(&fused, &bx, &by);
+      CHECK(bx == BALL_X / 16 && by == BALL_Y / 16, "%s: fused grid has the ball at %d,%d", name, bx, by);
+      find_ball(&separable, &bx, &by);
+      CHECK(bx == BALL_X / 16 && by == BALL_Y / 16, "%s: separable grid has the ball at %d,%d", name, bx, by);
+      CHECK(unpacked(&fused, 40, 12, 1) > 0.99f, "%s: no field in the grid", name);
+      CHECK(unpacked(&fused, 0, 0, 1) == 0.0f, "%s: field outside the table", name);
+   }
+
+   reference_texture_free(&source);
+   reference_texture_free(&phase1);
+   reference_texture_free(&fused);
+   reference_texture_free(&separable);
+}
+
+/// GL_LINEAR at texel corners averages the four texels, clamped at the edges
+static void test_sample(void)
+{
+   REFERENCE_TEXTURE tex;
+   float rgba[4];
+   int i;
+
+   reference_texture_init(&tex, 4, 2);
+   for (i = 0; i < 8; i++)
+      tex.data[4 * i] = (float)i;
+
+   reference_sample(&tex, 1.0f / 4.0f, 0.5f, rgba);
+   CHECK(fabsf(rgba[0] - 2.5f) < 1e-5f, "Corner sample is %f", rgba[0]);
+   reference_sample(&tex, 0.5f / 4.0f, 0.25f, rgba);
+   CHECK(fabsf(rgba[0] - 0.0f) < 1e-5f, "Center sample is %f", rgba[0]);
+   reference_sample(&tex, -1.0f, 2.0f, rgba);
+   CHECK(fabsf(rgba[0] - 4.0f) < 1e-5f, "Clamped sample is %f", rgba[0]);
+
+   reference_texture_free(&tex);
+}
+
+int main(int argc, char **argv)
+{
+   uint8_t *rgba = malloc(REFERENCE_SOURCE_WIDTH * REFERENCE_SOURCE_HEIGHT * 4);
+
+   if (!rgba)
+      return 1;
+
+   test_sample();
+
+   draw_table(rgba);
+   test_frame("Table", rgba, 1);
+
+   draw_noise(rgba);
+   test_frame("Noise", rgba, 0);
+
+   free(rgba);
+
+   return test_result();
+}
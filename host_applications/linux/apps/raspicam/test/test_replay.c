@@ -0,0 +1,654 @@
+/**
+ * \file test_replay.c
+ * Test for the keyframe index and the replay ring used by the circular
+ * buffer and replay modes of raspiballs.
+ *
+ * Streams synthetic H264 NAL units through the ring at 25 Mbit/s,
+ * 40 fps and an intra period of 10, the way the encoder callback does,
+ * and checks the index and exported clips while the ring wraps.
+ *
+ * MP4 clips are read back with the containers library, which needs the
+ * MP4 reader and writer plugins to be installed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "interface/vcos/vcos.h"
+#include "containers/containers.h"
+#include "containers/containers_codecs.h"
+
+#include "../RaspiKeyframeIndex.h"
+#include "../RaspiReplay.h"
+#include "test_check.h"
+
+#define BITRATE        25000000
+#define FRAMERATE      40
+#define INTRA_PERIOD   10
+#define ENCODER_BUFFER 65536        /// Largest buffer the encoder hands out
+#define STREAM_SECONDS 60
+
+#define NAL_SPS   0x67
+#define NAL_PPS   0x68
+#define NAL_IDR   0x65
+#define NAL_SLICE 0x41
+
+static uint8_t frame_data[8 * BITRATE / 8 / FRAMERATE];
+
+/// Builds one NAL unit carrying the frame number, without zero bytes after the start code
+static int make_nal(uint8_t *data, int type, uint32_t frame, int length)
+{
+   int i;
+
+   data[0] = 0; data[1] = 0; data[2] = 0; data[3] = 1;
+   data[4] = type;
+   for (i = 0; i < 4; i++)
+      data[5 + i] = 0x80 | ((frame >> (7 * i)) & 0x7f);
+   for (i = 9; i < length; i++)
+      data[i] = 0x80 | (i & 0x7f);
+   return length;
+}
+
+static uint32_t nal_frame(const uint8_t *nal)
+{
+   uint32_t frame = 0;
+   int i;
+
+   for (i = 0; i < 4; i++)
+      frame |= (uint32_t)(nal[5 + i] & 0x7f) << (7 * i);
+   return frame;
+}
+
+/// Feeds one encoded frame to the ring in encoder sized buffers
+static void stream_frame(RASPIREPLAY_T *replay, uint32_t frame, int64_t pts)
+{
+   int keyframe = (frame % INTRA_PERIOD) == 0;
+   // Keyframes take about a third of the bitrate of a GOP
+   int gop_bytes = BITRATE / 8 / FRAMERATE * INTRA_PERIOD;
+   int length = keyframe ? gop_bytes / 3 : (gop_bytes - gop_bytes / 3) / (INTRA_PERIOD - 1);
+   int offset = 0;
+
+   // Some jitter in the frame sizes
+   length += (rand() % (length / 4)) - length / 8;
+
+   if (keyframe)
+   {
+      uint8_t header[32];
+      int header_len = make_nal(header, NAL_SPS, frame, 14);
+      header_len += make_nal(header + header_len, NAL_PPS, frame, 10);
+      raspireplay_add(replay, header, header_len, pts, RASPIREPLAY_FLAG_CONFIG);
+   }
+
+   make_nal(frame_data, keyframe ? NAL_IDR : NAL_SLICE, frame, length);
+   while (offset < length)
+   {
+      int chunk = length - offset > ENCODER_BUFFER ? ENCODER_BUFFER : length - offset;
+      int flags = keyframe ? RASPIREPLAY_FLAG_KEYFRAME : 0;
+
+      if (offset + chunk == length)
+         flags |= RASPIREPLAY_FLAG_FRAME_END;
+      raspireplay_add(replay, frame_data + offset, chunk, pts, flags);
+      offset += chunk;
+   }
+}
+
+/**
+ * Exports a clip and checks that it starts with SPS, PPS and an IDR of a
+ * keyframe at least duration before the last frame, and that it contains
+ * every frame up to the last one exactly once.
+ */
+static void check_export(RASPIREPLAY_T *replay, int64_t duration_us, uint32_t last_frame, int64_t frame_us)
+{
+   FILE *file = tmpfile();
+   long size;
+   uint8_t *clip;
+   uint32_t expected;
+   int pos, result;
+
+   result = raspireplay_export(replay, fileno(file), duration_us);
+   CHECK(result > 0, "Export of %lld us after frame %u failed", (long long)duration_us, last_frame);
+   if (result <= 0)
+   {
+      fclose(file);
+      return;
+   }
+
+   fseek(file, 0, SEEK_END);
+   size = ftell(file);
+   CHECK(size == result, "Export returned %d but wrote %ld bytes", result, size);
+   clip = malloc(size);
+   fseek(file, 0, SEEK_SET);
+   if (fread(clip, 1, size, file) != (size_t)size)
+      CHECK(0, "Unable to read back clip");
+   fclose(file);
+
+   expected = nal_frame(clip + 0);
+   CHECK(clip[4] == NAL_SPS, "Clip starts with NAL type 0x%02x", clip[4]);
+   CHECK(expected % INTRA_PERIOD == 0, "Clip starts at frame %u, not a keyframe", expected);
+   if (duration_us)
+   {
+      CHECK((int64_t)(last_frame - expected) * frame_us >= duration_us,
+            "Clip starts at frame %u, too late for %lld us before %u", expected, (long long)duration_us, last_frame);
+      CHECK((int64_t)(last_frame - expected) * frame_us < duration_us + INTRA_PERIOD * frame_us,
+            "Clip starts at frame %u, too early for %lld us before %u", expected, (long long)duration_us, last_frame);
+   }
+
+   // Walk the NAL units, they are found by their start codes
+   for (pos = 0; pos + 9 <= size; )
+   {
+      int type = clip[pos + 4];
+      uint32_t frame = nal_frame(clip + pos);
+      int next;
+
+      CHECK(clip[pos] == 0 && clip[pos + 1] == 0 && clip[pos + 2] == 0 && clip[pos + 3] == 1,
+            "Missing start code at %d", pos);
+      if (type == NAL_IDR || type == NAL_SLICE)
+      {
+         CHECK(frame == expected, "Frame %u where %u was expected", frame, expected);
+         CHECK((type == NAL_IDR) == (frame % INTRA_PERIOD == 0), "Wrong NAL type for frame %u", frame);
+         expected = frame + 1;
+      }
+
+      for (next = pos + 4; next + 4 <= size; next++)
+         if (clip[next] == 0 && clip[next + 1] == 0 && clip[next + 2] == 0 && clip[next + 3] == 1)
+            break;
+      pos = next + 4 <= size ? next : size;
+   }
+   CHECK(expected == last_frame + 1, "Clip ends before frame %u (next %u)", last_frame, expected);
+
+   free(clip);
+}
+
+/// Ball position the test tracker reports for a frame, found on two of three frames
+static int frame_ball(uint32_t frame, float *x, float *y)
+{
+   *x = (frame % 200) / 100.0f - 1.0f;
+   *y = 0.5f;
+   return frame % 3 != 0;
+}
+
+/**
+ * Exports an MP4 clip and reads it back. The video track must hold every
+ * frame from a keyframe up to the last one, with the encoder timestamps
+ * and keyframe flags, and the metadata track the matching ball positions.
+ */
+static void check_export_mp4(RASPIREPLAY_T *replay, int64_t duration_us, uint32_t last_frame, int64_t frame_us)
+{
+   char filename[] = "/tmp/test_replay_XXXXXX.mp4";
+   VC_CONTAINER_T *reader;
+   VC_CONTAINER_STATUS_T status;
+   VC_CONTAINER_PACKET_T packet;
+   static uint8_t buffer[sizeof(frame_data) + 1024];
+   int fd, frames, video = 0, meta = 0, track, i;
+   uint32_t expected = 0;
+   int64_t seek_time;
+
+   fd = mkstemps(filename, 4);
+   CHECK(fd >= 0, "Unable to create %s", filename);
+   if (fd < 0)
+      return;
+   close(fd);
+
+   frames = raspireplay_export_file(replay, filename, duration_us, NULL);
+   CHECK(frames > 0, "MP4 export of %lld us after frame %u failed", (long long)duration_us, last_frame);
+   if (frames <= 0)
+   {
+      unlink(filename);
+      return;
+   }
+
+   reader = vc_container_open_reader(filename, &status, 0, 0);
+   CHECK(reader != NULL, "Unable to read back %s (%d)", filename, status);
+   if (!reader)
+   {
+      unlink(filename);
+      return;
+   }
+
+   for (track = 0; track < (int)reader->tracks_num; track++)
+      if (reader->tracks[track]->format->es_type == VC_CONTAINER_ES_TYPE_VIDEO)
+         break;
+   CHECK(track < (int)reader->tracks_num, "No video track in MP4 clip");
+   CHECK(reader->tracks_num == 2, "%d tracks in MP4 clip", reader->tracks_num);
+
+   while (track < (int)reader->tracks_num)
+   {
+      memset(&packet, 0, sizeof(packet));
+      packet.data = buffer;
+      packet.buffer_size = sizeof(buffer);
+      if (vc_container_read(reader, &packet, 0) != VC_CONTAINER_SUCCESS)
+         break;
+
+      if ((int)packet.track == track)
+      {
+         // Samples are length prefixed, the frame number follows the NAL header
+         uint32_t frame = 0;
+         for (i = 0; i < 4; i++)
+            frame |= (uint32_t)(buffer[4 + 1 + i] & 0x7f) << (7 * i);
+
+         if (!video)
+         {
+            expected = frame;
+            CHECK(frame % INTRA_PERIOD == 0, "MP4 clip starts at frame %u, not a keyframe", frame);
+            CHECK(packet.flags & VC_CONTAINER_PACKET_FLAG_KEYFRAME, "First MP4 sample is not a sync sample");
+         }
+         CHECK(frame == expected, "MP4 frame %u where %u was expected", frame, expected);
+         CHECK(!(packet.flags & VC_CONTAINER_PACKET_FLAG_KEYFRAME) == !(frame % INTRA_PERIOD == 0),
+               "Wrong sync flag for MP4 frame %u", frame);
+         // Timestamps are stored in milliseconds
+         CHECK(packet.pts / 1000 == (int64_t)video * frame_us / 1000,
+               "MP4 frame %u at %lld us, expected %lld", frame, (long long)packet.pts, (long long)(video * frame_us));
+         expected = frame + 1;
+         video++;
+      }
+      else
+      {
+         float x, y;
+         char text[64];
+
+         buffer[packet.size < sizeof(buffer) ? packet.size : sizeof(buffer) - 1] = 0;
+         if (frame_ball(expected - 1, &x, &y))
+            snprintf(text, sizeof(text), "{\"x\":%.4f,\"y\":%.4f}", x, y);
+         else
+            snprintf(text, sizeof(text), "{}");
+         CHECK(!strcmp((char *)buffer, text), "Ball track %s for frame %u, expected %s", (char *)buffer, expected - 1, text);
+         meta++;
+      }
+   }
+
+   CHECK(video == frames, "Read %d MP4 frames, %d written", video, frames);
+   CHECK(meta == frames, "Read %d ball track samples for %d frames", meta, frames);
+   CHECK(expected == last_frame + 1, "MP4 clip ends before frame %u (next %u)", last_frame, expected);
+
+   // Seeking lands on a keyframe at or before the requested time
+   seek_time = (frames / 2) * frame_us;
+   status = vc_container_seek(reader, &seek_time, VC_CONTAINER_SEEK_MODE_TIME, 0);
+   CHECK(status == VC_CONTAINER_SUCCESS, "Seek in MP4 clip failed (%d)", status);
+   CHECK(seek_time <= (frames / 2) * frame_us && seek_time % (INTRA_PERIOD * frame_us) < 1000,
+         "Seek to %lld us landed at %lld us", (long long)((frames / 2) * frame_us), (long long)seek_time);
+
+   vc_container_close(reader);
+   unlink(filename);
+}
+
+static void test_index(void)
+{
+   RASPIKEYFRAME_INDEX_T index;
+   int i;
+
+   CHECK(raspikeyframe_index_init(&index, 8) == 0, "Unable to create index");
+   CHECK(raspikeyframe_index_find(&index, 0) == NULL, "Empty index found a keyframe");
+
+   // Overfill, the oldest are dropped
+   for (i = 0; i < 12; i++)
+      raspikeyframe_index_push(&index, i * 1000, i * 100, 0);
+   CHECK(raspikeyframe_index_count(&index) == 8, "Count %d after overfill", raspikeyframe_index_count(&index));
+   CHECK(raspikeyframe_index_get(&index, 0)->offset == 4000, "Oldest offset %lld",
+         (long long)raspikeyframe_index_get(&index, 0)->offset);
+
+   CHECK(raspikeyframe_index_find(&index, 0)->pts == 400, "Find before oldest");
+   CHECK(raspikeyframe_index_find(&index, 750)->pts == 700, "Find in the middle");
+   CHECK(raspikeyframe_index_find(&index, 100000)->pts == 1100, "Find after newest");
+
+   raspikeyframe_index_trim(&index, 6500);
+   CHECK(raspikeyframe_index_count(&index) == 5, "Count %d after trim", raspikeyframe_index_count(&index));
+   raspikeyframe_index_trim(&index, 20000);
+   CHECK(raspikeyframe_index_count(&index) == 0, "Count %d after overtake", raspikeyframe_index_count(&index));
+
+   raspikeyframe_index_free(&index);
+}
+
+static void test_stream(int ring_seconds, int test_mp4)
+{
+   RASPIREPLAY_T *replay = raspireplay_create(ring_seconds * BITRATE / 8);
+   int64_t frame_us = 1000000 / FRAMERATE;
+   uint32_t frame;
+   struct timespec start, end;
+   double elapsed;
+
+   CHECK(replay != NULL, "Unable to create replay ring");
+   if (!replay)
+      return;
+
+   CHECK(raspireplay_export(replay, -1, 0) < 0, "Export from empty ring succeeded");
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   for (frame = 0; frame < STREAM_SECONDS * FRAMERATE; frame++)
+   {
+      float x, y;
+      int found = frame_ball(frame, &x, &y);
+
+      raspireplay_add_ball(replay, frame * frame_us, x, y, found);
+      stream_frame(replay, frame, frame * frame_us);
+
+      // Check a clip every simulated second, once the ring has some history
+      if (frame % FRAMERATE == FRAMERATE - 1 && frame >= 2 * INTRA_PERIOD)
+      {
+         check_export(replay, frame_us * INTRA_PERIOD, frame, frame_us);
+         check_export(replay, 0, frame, frame_us);
+         if (test_mp4)
+            check_export_mp4(replay, frame_us * INTRA_PERIOD, frame, frame_us);
+      }
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+   printf("%d s ring: streamed %d s of 25 Mbit/s in %.3f s (%.1f us per frame)\n",
+          ring_seconds, STREAM_SECONDS, elapsed, 1e6 * elapsed / (STREAM_SECONDS * FRAMERATE));
+
+   raspireplay_destroy(replay);
+}
+
+/// Time between two frames of a slow motion clip made of frames frame_us apart
+static int64_t slowmo_delta(const RASPIREPLAY_SLOWMO_T *slowmo, int64_t pts, int64_t frame_us)
+{
+   if (pts - frame_us >= slowmo->start_pts && pts <= slowmo->end_pts)
+      return frame_us * slowmo->factor;
+   return frame_us;
+}
+
+/**
+ * Exports slow motion clips of a short recording. The raw clip must come
+ * with a timecode file and the MP4 clip with stretched sample times, both
+ * slowed down only inside the window.
+ */
+static void test_slowmo(int test_mp4)
+{
+   RASPIREPLAY_T *replay = raspireplay_create(4 * BITRATE / 8);
+   int64_t frame_us = 1000000 / FRAMERATE;
+   RASPIREPLAY_SLOWMO_T slowmo;
+   char filename[] = "/tmp/test_replay_XXXXXX";
+   char ptsname[sizeof(filename) + 4];
+   char line[64];
+   FILE *file;
+   int64_t last = -1;
+   uint32_t frame;
+   int fd, frames = 0;
+
+   CHECK(replay != NULL, "Unable to create replay ring");
+   if (!replay)
+      return;
+
+   for (frame = 0; frame < 3 * FRAMERATE; frame++)
+   {
+      float x, y;
+      int found = frame_ball(frame, &x, &y);
+
+      raspireplay_add_ball(replay, frame * frame_us, x, y, found);
+      stream_frame(replay, frame, frame * frame_us);
+   }
+   CHECK(raspireplay_ball_pts(replay, 0) == (frame - 1) * frame_us, "Newest ball at %lld us",
+         (long long)raspireplay_ball_pts(replay, 0));
+   CHECK(raspireplay_ball_pts(replay, 10) == (frame - 11) * frame_us, "Ball 10 frames ago at %lld us",
+         (long long)raspireplay_ball_pts(replay, 10));
+   CHECK(raspireplay_last_pts(replay) == (frame - 1) * frame_us, "Newest frame at %lld us",
+         (long long)raspireplay_last_pts(replay));
+
+   // Clips start at frame 60, frames 70 to 90 play at quarter speed
+   slowmo.start_pts = 70 * frame_us;
+   slowmo.end_pts = 90 * frame_us;
+   slowmo.factor = 4;
+
+   fd = mkstemp(filename);
+   CHECK(fd >= 0, "Unable to create %s", filename);
+   if (fd < 0)
+   {
+      raspireplay_destroy(replay);
+      return;
+   }
+   close(fd);
+   snprintf(ptsname, sizeof(ptsname), "%s.pts", filename);
+
+   CHECK(raspireplay_export_file(replay, filename, 50 * frame_us, &slowmo) > 0, "Slow motion raw export failed");
+   file = fopen(ptsname, "r");
+   CHECK(file != NULL, "No timecodes for slow motion raw clip");
+   if (file)
+   {
+      CHECK(fgets(line, sizeof(line), file) && !strcmp(line, "# timecode format v2\n"), "Bad timecode header");
+      while (fgets(line, sizeof(line), file))
+      {
+         double ms;
+         int64_t t;
+
+         CHECK(sscanf(line, "%lf", &ms) == 1, "Bad timecode line %s", line);
+         t = (int64_t)(ms * 1000 + 0.5);
+         if (frames)
+            CHECK(t - last == slowmo_delta(&slowmo, (60 + frames) * frame_us, frame_us),
+                  "Raw frame %d at %lld us after %lld us", 60 + frames, (long long)t, (long long)last);
+         else
+            CHECK(t == 0, "Raw clip starts at %lld us", (long long)t);
+         last = t;
+         frames++;
+      }
+      fclose(file);
+      CHECK(frames == 60, "%d timecodes for 60 frames", frames);
+   }
+   unlink(ptsname);
+   unlink(filename);
+
+   if (test_mp4)
+   {
+      char mp4name[] = "/tmp/test_replay_XXXXXX.mp4";
+      static uint8_t buffer[sizeof(frame_data) + 1024];
+      VC_CONTAINER_STATUS_T status;
+      VC_CONTAINER_PACKET_T packet;
+      VC_CONTAINER_T *reader;
+
+      fd = mkstemps(mp4name, 4);
+      CHECK(fd >= 0, "Unable to create %s", mp4name);
+      if (fd < 0)
+      {
+         raspireplay_destroy(replay);
+         return;
+      }
+      close(fd);
+
+      CHECK(raspireplay_export_file(replay, mp4name, 50 * frame_us, &slowmo) == 60, "Slow motion MP4 export failed");
+      reader = vc_container_open_reader(mp4name, &status, 0, 0);
+      CHECK(reader != NULL, "Unable to read back %s (%d)", mp4name, status);
+      frames = 0;
+      while (reader)
+      {
+         memset(&packet, 0, sizeof(packet));
+         packet.data = buffer;
+         packet.buffer_size = sizeof(buffer);
+         if (vc_container_read(reader, &packet, 0) != VC_CONTAINER_SUCCESS)
+            break;
+         if (reader->tracks[packet.track]->format->es_type != VC_CONTAINER_ES_TYPE_VIDEO)
+            continue;
+
+         // Timestamps are stored in milliseconds
+         if (frames)
+            CHECK(packet.pts / 1000 - last / 1000 == slowmo_delta(&slowmo, (60 + frames) * frame_us, frame_us) / 1000,
+                  "MP4 frame %d at %lld us after %lld us", 60 + frames, (long long)packet.pts, (long long)last);
+         last = packet.pts;
+         frames++;
+      }
+      CHECK(frames == 60, "Read %d slow motion MP4 frames", frames);
+      CHECK(last / 1000 == (59 + 20 * 3) * frame_us / 1000, "Slow motion MP4 ends at %lld us", (long long)last);
+      if (reader)
+         vc_container_close(reader);
+      unlink(mp4name);
+   }
+
+   raspireplay_destroy(replay);
+}
+
+/// Export callback of test_exporter
+static void export_done(void *userdata, const char *filename, int result)
+{
+   (void)filename;
+   *(int *)userdata = result;
+}
+
+/// Clips asked for with raspireplay_request_file are written by the export thread
+static void test_exporter(void)
+{
+   RASPIREPLAY_T *replay = raspireplay_create(BITRATE / 8);
+   char filename[] = "/tmp/test_replay_XXXXXX";
+   int64_t frame_us = 1000000 / FRAMERATE;
+   int result = 0, i, fd;
+   uint32_t frame;
+
+   CHECK(replay != NULL, "Unable to create replay ring");
+   if (!replay)
+      return;
+
+   fd = mkstemp(filename);
+   CHECK(fd >= 0, "Unable to create %s", filename);
+   if (fd >= 0)
+      close(fd);
+
+   for (frame = 0; frame < 2 * FRAMERATE; frame++)
+      stream_frame(replay, frame, frame * frame_us);
+
+   CHECK(raspireplay_request_file(replay, filename, 0, NULL) < 0, "Request without an export thread succeeded");
+   CHECK(raspireplay_start_exporter(replay, export_done, &result) == 0, "Unable to start the export thread");
+   CHECK(raspireplay_request_file(replay, filename, frame_us * INTRA_PERIOD, NULL) == 0, "Request failed");
+
+   // The export thread writes the clip and calls back with its size
+   for (i = 0; i < 500 && !result; i++)
+      vcos_sleep(10);
+   CHECK(result > 0, "Requested clip not written (%d)", result);
+
+   raspireplay_destroy(replay);
+   unlink(filename);
+}
+
+/// Send one command to the control socket and return the first line of the answer
+static void control_command(const char *socket_path, const char *command, char *reply, int size)
+{
+   struct sockaddr_un addr;
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   ssize_t len = -1;
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+   if (fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+       write(fd, command, strlen(command)) == (ssize_t)strlen(command))
+      len = read(fd, reply, size - 1);
+   reply[len > 0 ? len : 0] = 0;
+   if (fd >= 0)
+      close(fd);
+}
+
+/// The control socket is private and REPLAY requests stay in the replay directory
+static void test_control(void)
+{
+   RASPIREPLAY_T *replay = raspireplay_create(BITRATE / 8);
+   char dir[] = "/tmp/test_replay_XXXXXX";
+   char socket_dir[64], socket_path[96], clip[96], reply[64];
+   int64_t frame_us = 1000000 / FRAMERATE;
+   struct stat st;
+   uint32_t frame;
+
+   CHECK(replay != NULL, "Unable to create replay ring");
+   if (!replay || !mkdtemp(dir))
+      return;
+   snprintf(socket_dir, sizeof(socket_dir), "%s/control", dir);
+   snprintf(socket_path, sizeof(socket_path), "%s/replay.sock", socket_dir);
+   snprintf(clip, sizeof(clip), "%s/clip.h264", dir);
+
+   for (frame = 0; frame < 2 * FRAMERATE; frame++)
+      stream_frame(replay, frame, frame * frame_us);
+
+   CHECK(raspireplay_start_control(replay, socket_path, dir) == 0, "Unable to start the control socket");
+   CHECK(stat(socket_dir, &st) == 0 && (st.st_mode & 0777) == 0700,
+         "Socket directory mode %o", (unsigned)st.st_mode & 0777);
+   CHECK(stat(socket_path, &st) == 0 && (st.st_mode & 0777) == 0600,
+         "Socket mode %o", (unsigned)st.st_mode & 0777);
+
+   control_command(socket_path, "REPLAY 250 clip.h264\n", reply, sizeof(reply));
+   CHECK(!strncmp(reply, "OK ", 3), "REPLAY of a plain name answered %s", reply);
+   CHECK(access(clip, F_OK) == 0, "Clip not written to the replay directory");
+
+   control_command(socket_path, "REPLAY 250 ../escape.h264\n", reply, sizeof(reply));
+   CHECK(!strcmp(reply, "ERROR\n"), "REPLAY with a parent directory answered %s", reply);
+   control_command(socket_path, "REPLAY 250 /tmp/test_replay_escape.h264\n", reply, sizeof(reply));
+   CHECK(!strcmp(reply, "ERROR\n"), "REPLAY with an absolute path answered %s", reply);
+   CHECK(access("/tmp/test_replay_escape.h264", F_OK) != 0, "Clip written outside the replay directory");
+
+   raspireplay_destroy(replay);
+   CHECK(access(socket_path, F_OK) != 0, "Socket left behind");
+
+   // An existing directory that others can enter is refused
+   replay = raspireplay_create(BITRATE / 8);
+   if (replay)
+   {
+      chmod(socket_dir, 0755);
+      CHECK(raspireplay_start_control(replay, socket_path, dir) < 0, "Socket created in a shared directory");
+      raspireplay_destroy(replay);
+   }
+
+   // A path that does not fit in a socket address is refused, not truncated
+   replay = raspireplay_create(BITRATE / 8);
+   if (replay)
+   {
+      char long_path[160];
+
+      memset(long_path, 'a', sizeof(long_path) - 1);
+      long_path[0] = '/';
+      long_path[sizeof(long_path) - 1] = 0;
+      CHECK(raspireplay_start_control(replay, long_path, dir) < 0, "Socket path of %d characters accepted",
+            (int)strlen(long_path));
+      raspireplay_destroy(replay);
+   }
+
+   unlink(clip);
+   rmdir(socket_dir);
+   rmdir(dir);
+}
+
+/// Whether the containers library can write MP4
+static int mp4_available(void)
+{
+   VC_CONTAINER_STATUS_T status;
+   char filename[] = "/tmp/test_replay_XXXXXX.mp4";
+   VC_CONTAINER_T *writer;
+   int fd = mkstemps(filename, 4);
+
+   if (fd < 0)
+      return 0;
+   close(fd);
+
+   writer = vc_container_open_writer(filename, &status, 0, 0);
+   if (writer)
+      vc_container_close(writer);
+   unlink(filename);
+   return writer != NULL;
+}
+
+int main(int argc, char **argv)
+{
+   (void)argc;
+   (void)argv;
+
+   vcos_init();
+
+   test_index();
+   // A ring that holds only a few GOPs, so keyframes are overtaken all the time
+   test_stream(1, 0);
+   test_stream(4, 0);
+   test_exporter();
+   test_control();
+
+   if (mp4_available())
+   {
+      test_stream(4, 1);
+      test_slowmo(1);
+   }
+   else
+   {
+      printf("MP4 writer plugin not installed, MP4 export not tested\n");
+      test_slowmo(0);
+   }
+
+   return test_result();
+}
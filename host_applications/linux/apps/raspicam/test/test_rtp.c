@@ -0,0 +1,368 @@
+/**
+ * \file test_rtp.c
+ * Test for the RTP output of raspiballs.
+ *
+ * Synthetic H264 access units of all sizes are sent over the loopback
+ * interface and received with the containers RTP reader, which undoes
+ * the packetization. Every NAL unit must come back unchanged, with the
+ * frame ends and timestamps of the encoder output. Half way the reader
+ * is reopened with the URI that the sender describes the stream with.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "interface/vcos/vcos.h"
+#include "containers/containers.h"
+
+#include "../RaspiRtp.h"
+#include "test_check.h"
+
+#define FRAMES          60
+#define INTRA_PERIOD    10
+#define FRAME_US        33333
+#define START_US        1000000
+#define MAX_NALS        8
+
+typedef struct
+{
+   uint8_t data[512];
+   int bit;
+} BITS_T;
+
+static void put_bits(BITS_T *bits, uint32_t value, int count)
+{
+   while (count--)
+   {
+      if ((value >> count) & 1)
+         bits->data[bits->bit / 8] |= 0x80 >> (bits->bit % 8);
+      bits->bit++;
+   }
+}
+
+static void put_ue(BITS_T *bits, uint32_t value)
+{
+   int length = 0;
+
+   while ((value + 1) >> (length + 1))
+      length++;
+   put_bits(bits, 0, length);
+   put_bits(bits, value + 1, length + 1);
+}
+
+/// Baseline SPS for 640x480, as the encoder would send it
+static int make_sps(uint8_t *sps)
+{
+   BITS_T bits;
+
+   memset(&bits, 0, sizeof(bits));
+   put_bits(&bits, 0x67, 8);        // NAL header
+   put_bits(&bits, 66, 8);          // profile_idc
+   put_bits(&bits, 0xc0, 8);        // constraint flags
+   put_bits(&bits, 30, 8);          // level_idc
+   put_ue(&bits, 0);                // seq_parameter_set_id
+   put_ue(&bits, 0);                // log2_max_frame_num_minus4
+   put_ue(&bits, 2);                // pic_order_cnt_type
+   put_ue(&bits, 1);                // max_num_ref_frames
+   put_bits(&bits, 0, 1);           // gaps_in_frame_num_value_allowed_flag
+   put_ue(&bits, 640 / 16 - 1);     // pic_width_in_mbs_minus1
+   put_ue(&bits, 480 / 16 - 1);     // pic_height_in_map_units_minus1
+   put_bits(&bits, 1, 1);           // frame_mbs_only_flag
+   put_bits(&bits, 1, 1);           // direct_8x8_inference_flag
+   put_bits(&bits, 0, 1);           // frame_cropping_flag
+   put_bits(&bits, 0, 1);           // vui_parameters_present_flag
+   put_bits(&bits, 1, 1);           // rbsp_stop_one_bit
+   memcpy(sps, bits.data, (bits.bit + 7) / 8);
+   return (bits.bit + 7) / 8;
+}
+
+static const uint8_t pps[] = { 0x68, 0xce, 0x3c, 0x80 };
+
+typedef struct
+{
+   uint8_t data[MAX_NALS][40000];
+   int length[MAX_NALS];
+   int count;
+} FRAME_T;
+
+/// NAL units of a frame. Payload bytes are never zero, so there are no start codes in them.
+static void make_frame(int n, FRAME_T *frame)
+{
+   static const int sizes[] = { 20, 200, 1300, 1455, 1456, 3000, 1000, 60, 9000 };
+   uint32_t seed = n * 2654435761u;
+   int i, j;
+
+   frame->count = 0;
+   if (n % INTRA_PERIOD == 0)
+   {
+      frame->length[0] = make_sps(frame->data[0]);
+      memcpy(frame->data[1], pps, sizeof(pps));
+      frame->length[1] = sizeof(pps);
+      frame->data[2][0] = 0x06;     // SEI
+      frame->length[2] = 12;
+      frame->data[3][0] = 0x65;     // IDR slice
+      frame->length[3] = 20000 + n * 100;
+      frame->count = 4;
+   }
+   else
+   {
+      // A few slices, some small enough to aggregate
+      for (i = 0; i < 1 + n % 3; i++)
+      {
+         frame->data[i][0] = 0x41;
+         frame->length[i] = sizes[(n + i) % (sizeof(sizes) / sizeof(sizes[0]))];
+      }
+      frame->count = i;
+   }
+
+   for (i = 0; i < frame->count; i++)
+   {
+      // SPS and PPS are real, the rest is numbered filler
+      if (n % INTRA_PERIOD == 0 && i < 2)
+         continue;
+      frame->data[i][1] = 1 + n;
+      for (j = 2; j < frame->length[i]; j++)
+      {
+         seed = seed * 1103515245u + 12345u;
+         frame->data[i][j] = 1 + (seed >> 16) % 255;
+      }
+   }
+}
+
+/// Hands a frame to the sender the way the encoder callback does, headers first
+static void send_frame(RASPIRTP_T *rtp, int n, const FRAME_T *frame)
+{
+   static uint8_t buffer[MAX_NALS * 40004];
+   static const uint8_t start_code[] = { 0, 0, 0, 1 };
+   int i, length = 0, first = 0;
+   int64_t pts = START_US + (int64_t)n * FRAME_US;
+
+   if (n % INTRA_PERIOD == 0)
+   {
+      for (i = 0; i < 2; i++)
+      {
+         memcpy(buffer + length, start_code, 4);
+         memcpy(buffer + length + 4, frame->data[i], frame->length[i]);
+         length += 4 + frame->length[i];
+      }
+      raspirtp_send(rtp, buffer, length, -1, RASPIRTP_FLAG_CONFIG);
+      length = 0;
+      first = 2;
+   }
+
+   for (i = first; i < frame->count; i++)
+   {
+      // Mix 3 and 4 byte start codes
+      int skip = (n + i) % 2;
+
+      memcpy(buffer + length, start_code + skip, 4 - skip);
+      memcpy(buffer + length + 4 - skip, frame->data[i], frame->length[i]);
+      length += 4 - skip + frame->length[i];
+   }
+
+   // Large frames come in more than one buffer
+   if (length > 10000)
+   {
+      raspirtp_send(rtp, buffer, 7000, pts, 0);
+      raspirtp_send(rtp, buffer + 7000, length - 7000, pts, RASPIRTP_FLAG_FRAME_END);
+   }
+   else
+   {
+      raspirtp_send(rtp, buffer, length, pts, RASPIRTP_FLAG_FRAME_END);
+   }
+}
+
+static const uint8_t *next_nal(const uint8_t *data, int length, int *pos, int *nal_len)
+{
+   int i = *pos, start;
+
+   while (i + 3 <= length && !(data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1))
+      i++;
+   if (i + 3 > length)
+      return NULL;
+   start = i + 3;
+   for (i = start; i + 3 <= length; i++)
+      if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+         break;
+   *pos = i + 3 <= length ? i : length;
+   i = *pos;
+   while (i > start && data[i - 1] == 0)
+      i--;
+   *nal_len = i - start;
+   return data + start;
+}
+
+/// Reads one access unit and compares it with what was sent
+static void receive_frame(VC_CONTAINER_T *reader, int n, const FRAME_T *frame, int64_t *first_pts)
+{
+   static uint8_t buffer[MAX_NALS * 40004];
+   VC_CONTAINER_PACKET_T packet;
+   VC_CONTAINER_STATUS_T status;
+   int length = 0, pos = 0, count = 0, nal_len;
+   int64_t pts = -1;
+   const uint8_t *nal;
+
+   while (1)
+   {
+      memset(&packet, 0, sizeof(packet));
+      packet.data = buffer + length;
+      packet.buffer_size = sizeof(buffer) - length;
+      status = vc_container_read(reader, &packet, 0);
+      if (status != VC_CONTAINER_SUCCESS)
+      {
+         CHECK(0, "Frame %d not received (%d)", n, status);
+         return;
+      }
+      if (pts < 0)
+         pts = packet.pts;
+      length += packet.size;
+      if (packet.flags & VC_CONTAINER_PACKET_FLAG_FRAME_END)
+         break;
+   }
+
+   if (*first_pts < 0)
+      *first_pts = pts - (int64_t)n * FRAME_US;
+   CHECK(llabs(pts - *first_pts - (int64_t)n * FRAME_US) < 20, "Frame %d at %lld us, expected %lld us", n,
+         (long long)(pts - *first_pts), (long long)n * FRAME_US);
+
+   while ((nal = next_nal(buffer, length, &pos, &nal_len)) != NULL)
+   {
+      if (count < frame->count)
+         CHECK(nal_len == frame->length[count] && !memcmp(nal, frame->data[count], nal_len),
+               "NAL unit %d of frame %d differs (%d bytes, expected %d)", count, n, nal_len, frame->length[count]);
+      count++;
+   }
+   CHECK(count == frame->count, "%d NAL units in frame %d, expected %d", count, n, frame->count);
+}
+
+static VC_CONTAINER_T *open_reader(const char *uri)
+{
+   VC_CONTAINER_STATUS_T status;
+   VC_CONTAINER_T *reader = vc_container_open_reader(uri, &status, 0, 0);
+
+   CHECK(reader != NULL, "Unable to open %s (%d)", uri, status);
+   if (!reader)
+      return NULL;
+
+   vc_container_control(reader, VC_CONTAINER_CONTROL_IO_SET_READ_TIMEOUT_MS, 1000);
+   CHECK(reader->tracks_num == 1 && reader->tracks[0]->format->type->video.width == 640 &&
+         reader->tracks[0]->format->type->video.height == 480, "Stream is not 640x480");
+   return reader;
+}
+
+static int free_port(void)
+{
+   struct sockaddr_in addr;
+   socklen_t length = sizeof(addr);
+   int sock = socket(AF_INET, SOCK_DGRAM, 0), port = 0;
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   if (sock >= 0 && bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+       getsockname(sock, (struct sockaddr *)&addr, &length) == 0)
+      port = ntohs(addr.sin_port);
+   if (sock >= 0)
+      close(sock);
+   return port;
+}
+
+static void base64(const uint8_t *data, int length, char *out)
+{
+   static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+   int i;
+
+   for (i = 0; i < length; i += 3)
+   {
+      uint32_t v = data[i] << 16 | (i + 1 < length ? data[i + 1] << 8 : 0) | (i + 2 < length ? data[i + 2] : 0);
+
+      *out++ = table[(v >> 18) & 0x3f];
+      *out++ = table[(v >> 12) & 0x3f];
+      *out++ = i + 1 < length ? table[(v >> 6) & 0x3f] : '=';
+      *out++ = i + 2 < length ? table[v & 0x3f] : '=';
+   }
+   *out = 0;
+}
+
+int main(int argc, char **argv)
+{
+   static FRAME_T frame;
+   RASPIRTP_T *rtp;
+   RASPIRTP_STATS_T stats;
+   VC_CONTAINER_T *reader;
+   char port[16], uri[1024], sprop[128], sdp[1024];
+   uint8_t sps[64];
+   int64_t first_pts = -1;
+   int n;
+
+   (void)argc;
+   (void)argv;
+
+   vcos_init();
+
+   snprintf(port, sizeof(port), "%d", free_port());
+   rtp = raspirtp_create("127.0.0.1", port, RASPIRTP_DEFAULT_MTU);
+   CHECK(rtp != NULL, "Unable to create RTP sender for port %s", port);
+   if (!rtp)
+      return 1;
+   CHECK(raspirtp_get_uri(rtp, uri, sizeof(uri)) != 0, "URI before the headers were sent");
+
+   // The receiver has to know the parameter sets before the first packet
+   base64(sps, make_sps(sps), sprop);
+   strcat(sprop, ",");
+   base64(pps, sizeof(pps), sprop + strlen(sprop));
+   raspirtp_get_stats(rtp, &stats);
+   snprintf(uri, sizeof(uri), "rtp://:%s?rtppt=%d&mime-type=video/H264&sprop-parameter-sets=%s&seq=%u",
+            port, RASPIRTP_PAYLOAD_TYPE, sprop, (uint16_t)(stats.next_seq - 1));
+   reader = open_reader(uri);
+   if (!reader)
+   {
+      raspirtp_destroy(rtp);
+      return 1;
+   }
+
+   for (n = 0; n < FRAMES; n++)
+   {
+      make_frame(n, &frame);
+      send_frame(rtp, n, &frame);
+      raspirtp_drain(rtp);
+      receive_frame(reader, n, &frame, &first_pts);
+
+      if (n == FRAMES / 2 - 1)
+      {
+         // Continue with the description from the sender
+         CHECK(raspirtp_get_uri(rtp, uri, sizeof(uri)) == 0, "No URI after the headers were sent");
+         CHECK(strstr(uri, sprop) != NULL, "URI %s does not have %s", uri, sprop);
+         raspirtp_get_stats(rtp, &stats);
+         snprintf(uri + strlen(uri), sizeof(uri) - strlen(uri), "&seq=%u", (uint16_t)(stats.next_seq - 1));
+         vc_container_close(reader);
+         reader = open_reader(uri);
+         if (!reader)
+            break;
+         first_pts = -1;
+      }
+   }
+
+   CHECK(raspirtp_get_sdp(rtp, sdp, sizeof(sdp)) == 0, "No SDP");
+   CHECK(strstr(sdp, "a=rtpmap:96 H264/90000") && strstr(sdp, "profile-level-id=42c01e") && strstr(sdp, sprop),
+         "Unexpected SDP:\n%s", sdp);
+
+   raspirtp_get_stats(rtp, &stats);
+   CHECK(stats.frames == FRAMES, "%llu frames sent", (unsigned long long)stats.frames);
+   CHECK(stats.dropped_frames == 0 && stats.send_errors == 0, "%u frames dropped, %u send errors",
+         stats.dropped_frames, stats.send_errors);
+   CHECK(stats.stap_packets > 0 && stats.fu_packets > 0, "%u STAP-A and %u FU-A packets",
+         stats.stap_packets, stats.fu_packets);
+   printf("%llu packets in %llu sendmmsg calls, %u STAP-A, %u FU-A, longest frame %u us\n",
+          (unsigned long long)stats.packets, (unsigned long long)stats.send_calls, stats.stap_packets,
+          stats.fu_packets, stats.max_frame_us);
+
+   if (reader)
+      vc_container_close(reader);
+   raspirtp_destroy(rtp);
+
+   return test_result();
+}
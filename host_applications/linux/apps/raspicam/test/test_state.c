@@ -0,0 +1,335 @@
+/**
+ * \file test_state.c
+ * Test for the shared memory tracker state of raspiballs.
+ *
+ * The main thread publishes records whose fields all follow from the frame
+ * number, as fast as it can, while reader threads with mappings of their
+ * own check every latest record and ring record they copy for tearing and
+ * order. Followers sleep on the futex and time how long after publishing
+ * they wake up. Closing the writer has to wake all of them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "interface/vcos/vcos.h"
+
+#include "../RaspiTrackerState.h"
+#include "test_check.h"
+
+#define STRESS_FRAMES   300000
+#define TIMING_FRAMES   1000000
+#define FOLLOW_FRAMES   200
+#define READERS         4
+#define FOLLOWERS       4
+
+static char name[64];
+
+typedef struct
+{
+   VCOS_THREAD_T thread;
+   RASPISTATE_T *state;
+   volatile int *done;
+   int torn;
+   int disorder;
+   uint64_t records;
+   uint64_t lost;
+   uint64_t wakeups;
+   uint64_t latency_us;
+   int closed;
+} READER_T;
+
+static int64_t now_us(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void fill_record(RASPISTATE_RECORD_T *record, uint32_t frame)
+{
+   memset(record, 0, sizeof(*record));
+   record->pts = (int64_t)frame * 1000;
+   record->x = (float)(frame & 0xffff);
+   record->y = -(float)(frame & 0xffff);
+   record->found = frame & 1;
+   record->goals[0] = frame;
+   record->goals[1] = ~frame;
+   record->saves = frame * 7;
+   record->reserved[1] = frame ^ 0x5a5a5a5a;
+}
+
+static int record_ok(const RASPISTATE_RECORD_T *record)
+{
+   uint32_t frame = record->frame;
+
+   return record->pts == (int64_t)frame * 1000 &&
+          record->x == (float)(frame & 0xffff) && record->y == -(float)(frame & 0xffff) &&
+          record->found == (frame & 1) && record->goals[0] == frame && record->goals[1] == ~frame &&
+          record->saves == frame * 7 && record->reserved[1] == (frame ^ 0x5a5a5a5a);
+}
+
+static void *reader_thread(void *arg)
+{
+   READER_T *reader = (READER_T *)arg;
+   RASPISTATE_RECORD_T records[32], latest;
+   uint32_t next = 0, last = 0, last_latest = 0;
+   int i, n;
+
+   while (!*reader->done)
+   {
+      if (raspistate_latest(reader->state, &latest) > 0)
+      {
+         if (!record_ok(&latest))
+            reader->torn++;
+         if (latest.frame < last_latest)
+            reader->disorder++;
+         last_latest = latest.frame;
+      }
+
+      n = raspistate_read(reader->state, &next, records, 32);
+      for (i = 0; i < n; i++)
+      {
+         if (!record_ok(&records[i]))
+            reader->torn++;
+         if (last && records[i].frame <= last)
+            reader->disorder++;
+         else if (last)
+            reader->lost += records[i].frame - last - 1;
+         last = records[i].frame;
+      }
+      reader->records += n;
+   }
+
+   return NULL;
+}
+
+static void *follower_thread(void *arg)
+{
+   READER_T *reader = (READER_T *)arg;
+   RASPISTATE_RECORD_T latest;
+   uint32_t frame = 0;
+   int rc;
+
+   if (raspistate_latest(reader->state, &latest) > 0)
+      frame = latest.frame;
+
+   while ((rc = raspistate_wait(reader->state, frame, 2000)) > 0)
+   {
+      int64_t woken = now_us();
+
+      if (raspistate_latest(reader->state, &latest) <= 0)
+         continue;
+      // The writer puts its publish time in the paced records
+      if (latest.time)
+      {
+         reader->latency_us += woken - latest.time;
+         reader->wakeups++;
+      }
+      frame = latest.frame;
+   }
+   reader->closed = rc < 0;
+
+   return NULL;
+}
+
+/// Permissions of a segment, -1 if it does not exist
+static int segment_mode(const char *segment, const char *suffix)
+{
+   char path[80];
+   struct stat st;
+   int fd;
+
+   snprintf(path, sizeof(path), "%s%s", segment, suffix);
+   fd = shm_open(path, O_RDONLY, 0);
+   if (fd < 0)
+      return -1;
+   if (fstat(fd, &st) < 0)
+      st.st_mode = 0;
+   close(fd);
+   return (int)(st.st_mode & 0777);
+}
+
+static void test_basic(void)
+{
+   RASPISTATE_T *writer, *reader;
+   RASPISTATE_RECORD_T record, records[RASPISTATE_RING_SIZE];
+   uint32_t next = 0;
+   int i, n;
+
+   CHECK(raspistate_open(name) == NULL, "Opened a segment that does not exist");
+
+   writer = raspistate_create(name);
+   CHECK(writer != NULL, "Unable to create segment: %s", strerror(errno));
+   if (!writer)
+      return;
+
+   errno = 0;
+   CHECK(raspistate_create(name) == NULL && errno == EBUSY, "Created a segment with a live writer");
+
+   CHECK(segment_mode(name, "") == 0644, "Segment mode %o", segment_mode(name, ""));
+   CHECK(segment_mode(name, RASPISTATE_WAITERS_SUFFIX) == 0666, "Waiters segment mode %o",
+         segment_mode(name, RASPISTATE_WAITERS_SUFFIX));
+
+   reader = raspistate_open(name);
+   CHECK(reader != NULL, "Unable to open segment: %s", strerror(errno));
+   if (!reader)
+   {
+      raspistate_destroy(writer);
+      return;
+   }
+
+   CHECK(raspistate_latest(reader, &record) == 0, "Latest record before the first frame");
+   CHECK(raspistate_read(reader, &next, records, 16) == 0 && next == 1, "Ring records before the first frame");
+   CHECK(raspistate_wait(reader, 0, 20) == 0, "Wait did not time out");
+   CHECK(!raspistate_closed(reader), "Segment closed while the writer is there");
+
+   for (i = 1; i <= 10; i++)
+   {
+      fill_record(&record, i);
+      raspistate_publish(writer, &record);
+   }
+
+   CHECK(raspistate_latest(reader, &record) == 1 && record.frame == 10 && record_ok(&record),
+         "Latest record is frame %u", record.frame);
+   CHECK(raspistate_wait(reader, 9, 0) == 1, "Wait missed a published frame");
+
+   n = raspistate_read(reader, &next, records, 4);
+   CHECK(n == 4 && records[0].frame == 1 && records[3].frame == 4 && next == 5, "Read 4 got %d from %u", n,
+         n ? records[0].frame : 0);
+   n = raspistate_read(reader, &next, records, 16);
+   CHECK(n == 6 && records[5].frame == 10 && next == 11, "Read the rest got %d", n);
+
+   // Overrun the ring, the reader skips to the oldest readable frame
+   for (i = 11; i <= 10 + 3 * RASPISTATE_RING_SIZE; i++)
+   {
+      fill_record(&record, i);
+      raspistate_publish(writer, &record);
+   }
+   n = raspistate_read(reader, &next, records, RASPISTATE_RING_SIZE);
+   CHECK(n == RASPISTATE_RING_SIZE - 1, "Read %d records after an overrun", n);
+   CHECK(n && records[0].frame == 10 + 2 * RASPISTATE_RING_SIZE + 2 && records[n - 1].frame == 10 + 3 * RASPISTATE_RING_SIZE,
+         "Read frames %u to %u after an overrun", records[0].frame, records[n - 1].frame);
+   for (i = 0; i < n; i++)
+      CHECK(record_ok(&records[i]), "Ring record %d is wrong", i);
+
+   next = 0;
+   n = raspistate_read(reader, &next, records, RASPISTATE_RING_SIZE);
+   CHECK(n == RASPISTATE_RING_SIZE - 1, "Read %d records from the oldest", n);
+
+   raspistate_destroy(writer);
+   CHECK(raspistate_closed(reader), "Segment not closed after the writer went");
+   CHECK(raspistate_wait(reader, 10 + 3 * RASPISTATE_RING_SIZE, 1000) == -1, "Wait after close");
+   CHECK(raspistate_latest(reader, &record) == 1, "Latest record gone with the writer");
+   raspistate_close(reader);
+
+   CHECK(raspistate_open(name) == NULL, "Segment still there after close");
+}
+
+static void test_stress(void)
+{
+   RASPISTATE_T *writer;
+   RASPISTATE_RECORD_T record;
+   READER_T readers[READERS + FOLLOWERS];
+   volatile int done = 0;
+   uint64_t wakeups = 0, latency_us = 0;
+   int64_t start;
+   uint32_t i;
+   int r;
+
+   writer = raspistate_create(name);
+   CHECK(writer != NULL, "Unable to create segment: %s", strerror(errno));
+   if (!writer)
+      return;
+
+   // Publishing with nobody waiting must stay in user space
+   start = now_us();
+   for (i = 1; i <= TIMING_FRAMES; i++)
+   {
+      fill_record(&record, i);
+      raspistate_publish(writer, &record);
+   }
+   printf("Publish without waiters: %.1f ns per frame\n", (now_us() - start) * 1000.0 / TIMING_FRAMES);
+   raspistate_destroy(writer);
+
+   writer = raspistate_create(name);
+   CHECK(writer != NULL, "Unable to create segment again: %s", strerror(errno));
+   if (!writer)
+      return;
+
+   memset(readers, 0, sizeof(readers));
+   for (r = 0; r < READERS + FOLLOWERS; r++)
+   {
+      readers[r].state = raspistate_open(name);
+      readers[r].done = &done;
+      CHECK(readers[r].state != NULL, "Unable to open reader %d", r);
+      if (!readers[r].state)
+         continue;
+      vcos_thread_create(&readers[r].thread, "reader", NULL, r < READERS ? reader_thread : follower_thread, &readers[r]);
+   }
+
+   for (i = 1; i <= STRESS_FRAMES; i++)
+   {
+      fill_record(&record, i);
+      raspistate_publish(writer, &record);
+   }
+
+   // Followers at frame rate, to time the wake ups
+   for (; i <= STRESS_FRAMES + FOLLOW_FRAMES; i++)
+   {
+      vcos_sleep(2);
+      fill_record(&record, i);
+      record.time = now_us();
+      raspistate_publish(writer, &record);
+   }
+
+   done = 1;
+   raspistate_destroy(writer);
+
+   for (r = 0; r < READERS + FOLLOWERS; r++)
+   {
+      if (!readers[r].state)
+         continue;
+      vcos_thread_join(&readers[r].thread, NULL);
+      CHECK(!readers[r].torn, "Reader %d copied %d torn records", r, readers[r].torn);
+      CHECK(!readers[r].disorder, "Reader %d saw %d records out of order", r, readers[r].disorder);
+      if (r < READERS)
+      {
+         CHECK(readers[r].records > 0, "Reader %d read nothing", r);
+         printf("Reader %d: %llu records, %llu lost\n", r, (unsigned long long)readers[r].records,
+                (unsigned long long)readers[r].lost);
+      }
+      else
+      {
+         CHECK(readers[r].closed, "Follower %d did not see the close", r);
+         CHECK(readers[r].wakeups >= FOLLOW_FRAMES / 2, "Follower %d woke up %llu times", r,
+               (unsigned long long)readers[r].wakeups);
+         wakeups += readers[r].wakeups;
+         latency_us += readers[r].latency_us;
+      }
+      raspistate_close(readers[r].state);
+   }
+
+   if (wakeups)
+      printf("Follower wake up latency: %.1f us average\n", (double)latency_us / wakeups);
+}
+
+int main(int argc, char **argv)
+{
+   vcos_init();
+
+   snprintf(name, sizeof(name), "/test_raspistate_%d", (int)getpid());
+
+   test_basic();
+   test_stress();
+
+   return test_result();
+}
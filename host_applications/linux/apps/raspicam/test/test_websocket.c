@@ -0,0 +1,352 @@
+/**
+ * \file test_websocket.c
+ * Test for the WebSocket server of raspiballs.
+ *
+ * Loopback clients connect to the server, check the handshake against the
+ * example of RFC 6455 and receive posted events in order. The event
+ * latency is measured from posting to the last client receiving it. The
+ * commands, ping, close, the heartbeat timeout and the stop when the last
+ * client leaves are checked as well.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "interface/vcos/vcos.h"
+
+#include "../RaspiWebSocket.h"
+#include "test_check.h"
+
+#define CLIENTS         8
+#define ROUNDS          200
+#define BURST           200
+#define HEARTBEAT_MS    300
+
+static VCOS_MUTEX_T command_lock;
+static RASPIWS_COMMAND_T commands[64];
+static int command_count;
+
+static void command_callback(void *userdata, RASPIWS_COMMAND_T command)
+{
+   (void)userdata;
+
+   vcos_mutex_lock(&command_lock);
+   if (command_count < (int)(sizeof(commands) / sizeof(commands[0])))
+      commands[command_count] = command;
+   command_count++;
+   vcos_mutex_unlock(&command_lock);
+}
+
+/// Waits up to timeout_ms for command number n, returns it or -1
+static int wait_command(int n, int timeout_ms)
+{
+   int result = -1, waited;
+
+   for (waited = 0; waited <= timeout_ms; waited++)
+   {
+      vcos_mutex_lock(&command_lock);
+      if (command_count > n)
+         result = commands[n];
+      vcos_mutex_unlock(&command_lock);
+      if (result >= 0)
+         break;
+      vcos_sleep(1);
+   }
+   return result;
+}
+
+static int connect_server(int port)
+{
+   struct sockaddr_in addr;
+   struct timeval timeout = { 2, 0 };
+   int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_port = htons(port);
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+   {
+      if (fd >= 0)
+         close(fd);
+      return -1;
+   }
+   setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+   return fd;
+}
+
+static int read_fully(int fd, uint8_t *data, int length)
+{
+   int done = 0;
+
+   while (done < length)
+   {
+      ssize_t result = recv(fd, data + done, length - done, 0);
+
+      if (result <= 0)
+         return -1;
+      done += result;
+   }
+   return 0;
+}
+
+/// Reads the HTTP response header
+static int read_response(int fd, char *response, int size)
+{
+   int length = 0;
+
+   while (length < size - 1)
+   {
+      if (recv(fd, response + length, 1, 0) != 1)
+         break;
+      length++;
+      response[length] = 0;
+      if (length >= 4 && !strcmp(response + length - 4, "\r\n\r\n"))
+         return 0;
+   }
+   response[length] = 0;
+   return -1;
+}
+
+/// Connects and completes the handshake, with the key of the RFC 6455 example
+static int open_client(int port)
+{
+   static const char request[] =
+      "GET /chat HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "Upgrade: websocket\r\n"
+      "Connection: Upgrade\r\n"
+      "sec-websocket-key:  dGhlIHNhbXBsZSBub25jZQ==\r\n"
+      "Sec-WebSocket-Version: 13\r\n\r\n";
+   char response[512];
+   int fd = connect_server(port), ok;
+
+   CHECK(fd >= 0, "Unable to connect to port %d", port);
+   if (fd < 0)
+      return -1;
+
+   // Split over two writes, the server must wait for the whole request
+   ok = send(fd, request, 20, 0) == 20;
+   vcos_sleep(5);
+   ok = ok && send(fd, request + 20, sizeof(request) - 21, 0) == (ssize_t)sizeof(request) - 21;
+   ok = ok && read_response(fd, response, sizeof(response)) == 0;
+   if (!ok)
+   {
+      CHECK(0, "Handshake failed");
+      close(fd);
+      return -1;
+   }
+
+   CHECK(!strncmp(response, "HTTP/1.1 101", 12), "Handshake response %s", response);
+   CHECK(strstr(response, "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n") != NULL,
+         "Wrong accept key in %s", response);
+   return fd;
+}
+
+/// Sends a masked client frame
+static void send_frame(int fd, int opcode, const char *payload, int length)
+{
+   static const uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+   uint8_t frame[256];
+   int i;
+
+   frame[0] = 0x80 | opcode;
+   frame[1] = 0x80 | length;
+   memcpy(frame + 2, mask, 4);
+   for (i = 0; i < length; i++)
+      frame[6 + i] = payload[i] ^ mask[i % 4];
+   CHECK(send(fd, frame, 6 + length, 0) == 6 + length, "Unable to send frame");
+}
+
+/// Reads a server frame, returns the payload length or -1
+static int read_frame(int fd, int *opcode, char *payload, int size)
+{
+   uint8_t header[4];
+   int length;
+
+   if (read_fully(fd, header, 2) != 0)
+      return -1;
+   CHECK(!(header[1] & 0x80), "Server frame is masked");
+   *opcode = header[0] & 0x0f;
+   length = header[1] & 0x7f;
+   if (length == 126)
+   {
+      if (read_fully(fd, header + 2, 2) != 0)
+         return -1;
+      length = header[2] << 8 | header[3];
+   }
+   if (length >= size || read_fully(fd, (uint8_t *)payload, length) != 0)
+      return -1;
+   payload[length] = 0;
+   return length;
+}
+
+static void wait_clients(RASPIWS_T *ws, int clients)
+{
+   RASPIWS_STATS_T stats;
+   int waited;
+
+   for (waited = 0; waited < 2000; waited++)
+   {
+      raspiws_get_stats(ws, &stats);
+      if (stats.clients == clients)
+         return;
+      vcos_sleep(1);
+   }
+   CHECK(0, "%d clients, expected %d", stats.clients, clients);
+}
+
+static void test_bad_request(int port)
+{
+   static const char request[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+   char response[256];
+   int fd = connect_server(port);
+
+   CHECK(fd >= 0, "Unable to connect for bad request");
+   if (fd < 0)
+      return;
+   send(fd, request, sizeof(request) - 1, 0);
+   CHECK(read_response(fd, response, sizeof(response)) == 0 && !strncmp(response, "HTTP/1.1 400", 12),
+         "Request without key answered with %s", response);
+   CHECK(recv(fd, response, 1, 0) == 0, "Connection not closed after bad request");
+   close(fd);
+}
+
+int main(int argc, char **argv)
+{
+   RASPIWS_T *ws;
+   RASPIWS_STATS_T stats;
+   int fds[CLIENTS];
+   int64_t total_us = 0, max_us = 0;
+   char text[256], expected[64];
+   int i, n, opcode, length, port;
+
+   (void)argc;
+   (void)argv;
+
+   vcos_init();
+   vcos_mutex_create(&command_lock, "test_websocket");
+
+   ws = raspiws_create(0, HEARTBEAT_MS, command_callback, NULL);
+   CHECK(ws != NULL, "Unable to create server");
+   if (!ws)
+      return 1;
+   port = raspiws_get_port(ws);
+
+   test_bad_request(port);
+
+   for (i = 0; i < CLIENTS; i++)
+      fds[i] = open_client(port);
+   wait_clients(ws, CLIENTS);
+
+   // One event at a time, for the latency
+   for (n = 0; n < ROUNDS; n++)
+   {
+      int64_t start = vcos_getmicrosecs64(), latency;
+
+      snprintf(expected, sizeof(expected), "EVENT %d", n);
+      snprintf(text, sizeof(text), "%s\n", expected);
+      CHECK(raspiws_post(ws, text) == 0, "Unable to post event %d", n);
+      for (i = 0; i < CLIENTS; i++)
+      {
+         length = fds[i] >= 0 ? read_frame(fds[i], &opcode, text, sizeof(text)) : -1;
+         CHECK(length >= 0 && opcode == 1 && !strcmp(text, expected), "Client %d got '%s' for '%s'", i,
+               length >= 0 ? text : "", expected);
+      }
+      latency = vcos_getmicrosecs64() - start;
+      total_us += latency;
+      if (latency > max_us)
+         max_us = latency;
+   }
+   printf("Event latency to %d clients: %.1f us average, %lld us max\n", CLIENTS, (double)total_us / ROUNDS,
+          (long long)max_us);
+
+   // A burst, every client gets all events in order
+   for (n = 0; n < BURST; n++)
+   {
+      snprintf(text, sizeof(text), "BURST %d", n);
+      CHECK(raspiws_post(ws, text) == 0, "Unable to post burst event %d", n);
+   }
+   for (i = 0; i < CLIENTS; i++)
+   {
+      for (n = 0; n < BURST; n++)
+      {
+         snprintf(expected, sizeof(expected), "BURST %d", n);
+         length = fds[i] >= 0 ? read_frame(fds[i], &opcode, text, sizeof(text)) : -1;
+         if (length < 0 || strcmp(text, expected))
+         {
+            CHECK(0, "Client %d got '%s' for '%s'", i, length >= 0 ? text : "", expected);
+            break;
+         }
+      }
+   }
+
+   // Commands, in the order they were sent
+   send_frame(fds[0], 1, "start", 5);
+   send_frame(fds[1], 1, "replay", 6);
+   CHECK(wait_command(0, 2000) == RASPIWS_COMMAND_START, "No start command");
+   CHECK(wait_command(1, 2000) == RASPIWS_COMMAND_REPLAY, "No replay command");
+   send_frame(fds[0], 1, "stop", 4);
+   CHECK(wait_command(2, 2000) == RASPIWS_COMMAND_STOP, "No stop command");
+   send_frame(fds[1], 1, "dump", 4);
+   CHECK(wait_command(3, 2000) == RASPIWS_COMMAND_DUMP, "No dump command");
+   send_frame(fds[0], 1, "hello", 5);
+
+   send_frame(fds[2], 9, "ping!", 5);
+   length = read_frame(fds[2], &opcode, text, sizeof(text));
+   CHECK(length == 5 && opcode == 0xa && !strcmp(text, "ping!"), "No pong for ping");
+
+   // Heartbeats stop tracking when they stop coming
+   send_frame(fds[3], 1, "heartbeat", 9);
+   vcos_sleep(HEARTBEAT_MS / 2);
+   send_frame(fds[3], 1, "heartbeat", 9);
+   vcos_sleep(HEARTBEAT_MS / 2);
+   vcos_mutex_lock(&command_lock);
+   n = command_count;
+   vcos_mutex_unlock(&command_lock);
+   CHECK(n == 4, "%d commands before the heartbeat timeout", n);
+   CHECK(wait_command(4, 4 * HEARTBEAT_MS) == RASPIWS_COMMAND_STOP, "No stop after the heartbeat timeout");
+
+   // Close handshake
+   send_frame(fds[4], 8, "\x03\xe8", 2);
+   length = read_frame(fds[4], &opcode, text, sizeof(text));
+   CHECK(length == 2 && opcode == 8, "No close frame back");
+   CHECK(recv(fds[4], text, 1, 0) == 0, "Connection not closed after close frame");
+   close(fds[4]);
+   fds[4] = -1;
+   wait_clients(ws, CLIENTS - 1);
+
+   // Stop once the last client leaves, not before
+   for (i = 0; i < CLIENTS; i++)
+   {
+      if (fds[i] >= 0)
+         close(fds[i]);
+   }
+   wait_clients(ws, 0);
+   CHECK(wait_command(5, 2000) == RASPIWS_COMMAND_STOP, "No stop after the last client left");
+   vcos_sleep(10);
+   vcos_mutex_lock(&command_lock);
+   n = command_count;
+   vcos_mutex_unlock(&command_lock);
+   CHECK(n == 6, "%d commands, expected 6", n);
+
+   raspiws_get_stats(ws, &stats);
+   CHECK(stats.connections == CLIENTS && stats.events == ROUNDS + BURST && stats.dropped_events == 0 &&
+         stats.messages == (uint64_t)CLIENTS * (ROUNDS + BURST) && stats.slow_clients == 0,
+         "Stats: %llu connections, %llu events, %u dropped, %llu messages, %u slow clients",
+         (unsigned long long)stats.connections, (unsigned long long)stats.events, stats.dropped_events,
+         (unsigned long long)stats.messages, stats.slow_clients);
+   printf("Server: %llu events, %.1f us average and %u us max from post to the last client write\n",
+          (unsigned long long)stats.events, (double)stats.total_latency_us / stats.events, stats.max_latency_us);
+
+   raspiws_destroy(ws);
+   vcos_mutex_delete(&command_lock);
+
+   return test_result();
+}
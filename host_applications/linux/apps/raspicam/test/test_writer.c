@@ -0,0 +1,242 @@
+/**
+ * \file test_writer.c
+ * Test for the asynchronous encoder file writer of raspiballs.
+ *
+ * Queues a numbered byte stream in encoder sized buffers with segment
+ * rollovers in between, using a blocking staging ring small enough to
+ * stall, and checks that every segment file holds exactly its part of the
+ * stream. Then checks that a writer which is not blocking drops whole
+ * buffers when its file does not keep up.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "interface/vcos/vcos.h"
+
+#include "../RaspiWriter.h"
+#include "test_check.h"
+
+#define SEGMENTS       8
+#define SEGMENT_BYTES  (3 * 1024 * 1024)
+#define RING_SIZE      (256 * 1024)
+#define MAX_BUFFER     65536
+
+static char directory[] = "/tmp/test_writer_XXXXXX";
+
+static void segment_name(char *name, size_t size, RASPIWRITER_STREAM_T stream, int segment)
+{
+   snprintf(name, size, "%s/%s%04d", directory, stream == RASPIWRITER_VIDEO ? "video" : "pts", segment);
+}
+
+static FILE *open_segment(void *userdata, RASPIWRITER_STREAM_T stream, int segment)
+{
+   char name[128];
+
+   (void)userdata;
+   // Opening is slow on real storage, make sure the producer does not notice
+   usleep(2000);
+   segment_name(name, sizeof(name), stream, segment);
+   return fopen(name, "wb");
+}
+
+static uint8_t stream_byte(int segment, long pos)
+{
+   return (uint8_t)(segment * 31 + pos * 7 + (pos >> 9));
+}
+
+static void check_segment(int segment)
+{
+   char name[128];
+   FILE *file;
+   uint8_t buffer[4096];
+   long pos = 0;
+   size_t n, i;
+   int frames;
+
+   segment_name(name, sizeof(name), RASPIWRITER_VIDEO, segment);
+   file = fopen(name, "rb");
+   CHECK(file != NULL, "Segment %d was not written", segment);
+   if (!file)
+      return;
+
+   while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+   {
+      for (i = 0; i < n; i++)
+         if (buffer[i] != stream_byte(segment, pos + i))
+         {
+            CHECK(0, "Segment %d differs at %ld", segment, pos + (long)i);
+            break;
+         }
+      pos += n;
+   }
+   fclose(file);
+   CHECK(pos == SEGMENT_BYTES, "Segment %d has %ld bytes", segment, pos);
+
+   segment_name(name, sizeof(name), RASPIWRITER_PTS, segment);
+   file = fopen(name, "r");
+   CHECK(file != NULL, "Timestamps of segment %d were not written", segment);
+   if (!file)
+      return;
+   for (frames = 0; fgets((char *)buffer, sizeof(buffer), file); frames++)
+      CHECK(atoi((char *)buffer) == segment * 1000 + frames, "Timestamp %d of segment %d is %s",
+            frames, segment, (char *)buffer);
+   fclose(file);
+}
+
+/// A pipe nobody reads yet stands in for storage that does not keep up
+static void test_drop(void)
+{
+   RASPIWRITER_T *writer = raspiwriter_create(RING_SIZE, NULL, NULL);
+   RASPIWRITER_STATS_T stats;
+   static uint8_t data[MAX_BUFFER], expected[64 * MAX_BUFFER];
+   int fds[2], i, queued = 0, dropped = 0, length = MAX_BUFFER / 2;
+   long expected_len = 0, pos = 0;
+   FILE *file;
+
+   CHECK(writer != NULL, "Unable to create writer");
+   if (!writer || pipe(fds) != 0)
+      return;
+   file = fdopen(fds[1], "wb");
+   setvbuf(file, NULL, _IONBF, 0);
+   raspiwriter_set_file(writer, RASPIWRITER_VIDEO, file);
+
+   for (i = 0; i < 64; i++)
+   {
+      int result;
+
+      memset(data, i + 1, length);
+      result = raspiwriter_write(writer, RASPIWRITER_VIDEO, data, length);
+      CHECK(result >= 0, "Write %d failed", i);
+      if (result == 0)
+      {
+         memcpy(expected + expected_len, data, length);
+         expected_len += length;
+         queued++;
+      }
+      else
+         dropped++;
+   }
+   CHECK(dropped > 0, "Nothing dropped with the file blocked");
+   CHECK(queued * length >= RING_SIZE / 2, "Only %d buffers queued", queued);
+
+   // Whatever was queued comes out in order, without parts of dropped buffers
+   while (pos < expected_len)
+   {
+      ssize_t n = read(fds[0], data, sizeof(data));
+      if (n <= 0)
+         break;
+      CHECK(pos + n <= expected_len && !memcmp(data, expected + pos, n), "Output differs at %ld", pos);
+      pos += n;
+   }
+   CHECK(pos == expected_len, "%ld bytes written of %ld queued", pos, expected_len);
+
+   raspiwriter_drain(writer);
+   raspiwriter_get_stats(writer, &stats);
+   CHECK(stats.dropped == dropped && stats.dropped_bytes == (uint64_t)dropped * length,
+         "%d buffers of %llu bytes counted as dropped, %d dropped", stats.dropped,
+         (unsigned long long)stats.dropped_bytes, dropped);
+   CHECK(stats.stalls == 0, "%d stalls without blocking", stats.stalls);
+   printf("not blocking: %d buffers queued, %d dropped\n", queued, dropped);
+
+   raspiwriter_destroy(writer);
+   fclose(file);
+   close(fds[0]);
+}
+
+int main(int argc, char **argv)
+{
+   RASPIWRITER_T *writer;
+   RASPIWRITER_STATS_T stats;
+   static uint8_t data[MAX_BUFFER];
+   int segment;
+
+   (void)argc;
+   (void)argv;
+
+   vcos_init();
+
+   if (!mkdtemp(directory))
+   {
+      fprintf(stderr, "Unable to create a temporary directory\n");
+      return 1;
+   }
+
+   writer = raspiwriter_create(RING_SIZE, open_segment, NULL);
+   CHECK(writer != NULL, "Unable to create writer");
+   if (!writer)
+      return error_count;
+
+   // Every byte has to arrive, wait for the slow segment opens
+   raspiwriter_set_blocking(writer, 1);
+   raspiwriter_set_prealloc(writer, SEGMENT_BYTES);
+   raspiwriter_set_file(writer, RASPIWRITER_VIDEO, open_segment(NULL, RASPIWRITER_VIDEO, 0));
+   raspiwriter_set_file(writer, RASPIWRITER_PTS, open_segment(NULL, RASPIWRITER_PTS, 0));
+   CHECK(raspiwriter_write(writer, RASPIWRITER_VIDEO, data, RING_SIZE + 1) < 0, "Oversized write was accepted");
+
+   for (segment = 0; segment < SEGMENTS; segment++)
+   {
+      long pos = 0;
+      int frame = 0, buffers = 0;
+
+      if (segment)
+         raspiwriter_split(writer, segment);
+
+      while (pos < SEGMENT_BYTES)
+      {
+         int length = 1 + rand() % MAX_BUFFER;
+         char line[32];
+         int i;
+
+         if (length > SEGMENT_BYTES - pos)
+            length = SEGMENT_BYTES - pos;
+         for (i = 0; i < length; i++)
+            data[i] = stream_byte(segment, pos + i);
+         raspiwriter_write(writer, RASPIWRITER_VIDEO, data, length);
+         pos += length;
+
+         // The buffer is free for reuse as soon as the write returns
+         memset(data, 0, length);
+
+         // A frame spans a few encoder buffers, its timestamp follows the last one
+         if (++buffers % 4 == 0 || pos == SEGMENT_BYTES)
+         {
+            i = snprintf(line, sizeof(line), "%d\n", segment * 1000 + frame++);
+            raspiwriter_write(writer, RASPIWRITER_PTS, line, i);
+         }
+      }
+   }
+
+   raspiwriter_drain(writer);
+   raspiwriter_get_stats(writer, &stats);
+   CHECK(!raspiwriter_failed(writer), "Writer reported a failed write");
+   CHECK(stats.segments == SEGMENTS - 1, "%d segments opened", stats.segments);
+   CHECK(stats.writes < stats.jobs, "No writes were merged");
+   CHECK(stats.high_water <= RING_SIZE, "High water %d above the ring size", stats.high_water);
+
+   fclose(raspiwriter_get_file(writer, RASPIWRITER_VIDEO));
+   fclose(raspiwriter_get_file(writer, RASPIWRITER_PTS));
+   raspiwriter_destroy(writer);
+
+   printf("%llu bytes in %llu writes for %llu buffers, high water %d, slowest write %u us, %d stalls for %llu us\n",
+          (unsigned long long)stats.bytes, (unsigned long long)stats.writes, (unsigned long long)stats.jobs,
+          stats.high_water, stats.max_write_us, stats.stalls, (unsigned long long)stats.stall_us);
+
+   for (segment = 0; segment < SEGMENTS; segment++)
+   {
+      char name[128];
+
+      check_segment(segment);
+      segment_name(name, sizeof(name), RASPIWRITER_VIDEO, segment);
+      unlink(name);
+      segment_name(name, sizeof(name), RASPIWRITER_PTS, segment);
+      unlink(name);
+   }
+   rmdir(directory);
+
+   test_drop();
+
+   return test_result();
+}
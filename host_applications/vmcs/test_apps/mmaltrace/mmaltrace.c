@@ -0,0 +1,419 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Converts a trace file written by mmal_trace_write() to the JSON of the
+ * Chrome trace event format, which chrome://tracing and ui.perfetto.dev open.
+ *
+ * Sends and callbacks become slices on the thread they happened on, nested
+ * the way the calls were. Queue operations and releases are short slices. Every
+ * buffer header gets an async track from its first event to the release which
+ * returns it to its owner, and a flow arrow whenever it moves to another thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "interface/mmal/mmal_trace.h"
+
+/** Duration of the slices of the events which have none, in us. A flow can
+ * only start or end on a slice, and viewers hide empty ones. */
+#define INSTANT_DURATION 0.001
+
+typedef struct
+{
+   MMAL_TRACE_EVENT_T event;
+   uint32_t thread;   /**< Index of the thread it comes from */
+   uint32_t order;    /**< Position in the thread, to keep the order on equal times */
+} EVENT_T;
+
+typedef struct
+{
+   MMAL_TRACE_THREAD_T info;
+   unsigned int depth;     /**< Slices open on the thread */
+} THREAD_T;
+
+/** What the last event of a buffer header was */
+typedef struct
+{
+   uint64_t buffer;
+   uint32_t thread;
+   uint64_t time;
+   int alive;              /**< Its async slice is open */
+} BUFFER_T;
+
+static MMAL_TRACE_NAME_T *names;
+static unsigned int names_num;
+static THREAD_T *threads;
+static unsigned int threads_num;
+static EVENT_T *events;
+static unsigned int events_num;
+static BUFFER_T *buffers;
+static unsigned int buffers_size;
+static uint32_t pid;
+static uint64_t time_origin;
+static FILE *out;
+static int first_output = 1;
+
+static int compare_names(const void *a, const void *b)
+{
+   uint64_t x = ((const MMAL_TRACE_NAME_T *)a)->object, y = ((const MMAL_TRACE_NAME_T *)b)->object;
+   return x < y ? -1 : x > y;
+}
+
+static int compare_events(const void *a, const void *b)
+{
+   const EVENT_T *x = (const EVENT_T *)a, *y = (const EVENT_T *)b;
+   if (x->event.time != y->event.time)
+      return x->event.time < y->event.time ? -1 : 1;
+   if (x->thread != y->thread)
+      return x->thread < y->thread ? -1 : 1;
+   return x->order < y->order ? -1 : x->order > y->order;
+}
+
+static const char *object_name(uint64_t object)
+{
+   MMAL_TRACE_NAME_T key, *name;
+
+   key.object = object;
+   name = bsearch(&key, names, names_num, sizeof(*names), compare_names);
+   return name ? name->name : NULL;
+}
+
+/** Finds the slot of a buffer header, buffers_size is a power of two */
+static BUFFER_T *buffer_state(uint64_t buffer)
+{
+   unsigned int slot = (unsigned int)(buffer >> 4) & (buffers_size - 1);
+
+   while (buffers[slot].buffer && buffers[slot].buffer != buffer)
+      slot = (slot + 1) & (buffers_size - 1);
+   buffers[slot].buffer = buffer;
+   return &buffers[slot];
+}
+
+static void print_string(const char *string)
+{
+   fputc('"', out);
+   for (; *string; string++)
+   {
+      if (*string == '"' || *string == '\\')
+         fprintf(out, "\\%c", *string);
+      else if ((unsigned char)*string < 0x20)
+         fprintf(out, "\\u%04x", *string);
+      else
+         fputc(*string, out);
+   }
+   fputc('"', out);
+}
+
+/** Starts a trace event, the caller adds its own fields and closes it */
+static void print_event(const char *phase, const char *name, uint32_t thread, uint64_t time)
+{
+   fprintf(out, "%s\n{\"ph\":\"%s\",\"pid\":%" PRIu32 ",\"tid\":%" PRIu32 ",\"ts\":%.3f,\"name\":",
+           first_output ? "" : ",", phase, pid, threads[thread].info.tid,
+           (time - time_origin) / 1000.0);
+   print_string(name);
+   first_output = 0;
+}
+
+static void print_buffer_args(const MMAL_TRACE_EVENT_T *event)
+{
+   fprintf(out, ",\"args\":{\"buffer\":\"0x%" PRIx64 "\",\"length\":%" PRIu32 ",\"flags\":\"0x%" PRIx32 "\"",
+           event->buffer, event->length, event->flags);
+   if (event->pts != MMAL_TIME_UNKNOWN)
+      fprintf(out, ",\"pts\":%" PRId64, event->pts);
+   if (event->index)
+      fprintf(out, ",\"index\":%u", event->index);
+}
+
+static void print_slice(const EVENT_T *e)
+{
+   const MMAL_TRACE_EVENT_T *event = &e->event;
+   THREAD_T *thread = &threads[e->thread];
+   const char *object = object_name(event->object);
+   char name[MMAL_TRACE_NAME_MAX + 32];
+
+   if (object)
+      snprintf(name, sizeof(name), "%s", object);
+   else
+      snprintf(name, sizeof(name), "0x%" PRIx64, event->object);
+
+   switch (event->type)
+   {
+   case MMAL_TRACE_SEND_BEGIN:
+   case MMAL_TRACE_CALLBACK_BEGIN:
+   {
+      char slice[sizeof(name) + 16];
+      int send = event->type == MMAL_TRACE_SEND_BEGIN;
+
+      snprintf(slice, sizeof(slice), "%s %s", send ? "send" : event->arg ? "event" : "callback", name);
+      /* The other buffer headers of a chain were sent by the same call */
+      if (send && event->index)
+      {
+         print_event("X", slice, e->thread, event->time);
+         fprintf(out, ",\"dur\":%.3f,\"cat\":\"send\"", INSTANT_DURATION);
+      }
+      else
+      {
+         print_event("B", slice, e->thread, event->time);
+         fprintf(out, ",\"cat\":\"%s\"", send ? "send" : "callback");
+         thread->depth++;
+      }
+      print_buffer_args(event);
+      if (event->arg)
+         fprintf(out, ",\"cmd\":\"0x%" PRIx32 "\"", event->arg);
+      fprintf(out, "}}");
+      break;
+   }
+   case MMAL_TRACE_SEND_END:
+   case MMAL_TRACE_CALLBACK_END:
+      /* The beginning can have been overwritten in the ring */
+      if (!thread->depth)
+         break;
+      thread->depth--;
+      print_event("E", "", e->thread, event->time);
+      if (event->type == MMAL_TRACE_SEND_END && event->arg)
+         fprintf(out, ",\"args\":{\"status\":%" PRIu32 "}", event->arg);
+      fprintf(out, "}");
+      break;
+   case MMAL_TRACE_RELEASE:
+      print_event("X", "release", e->thread, event->time);
+      fprintf(out, ",\"dur\":%.3f,\"cat\":\"buffer\"", INSTANT_DURATION);
+      print_buffer_args(event);
+      fprintf(out, ",\"refcount\":%" PRIu32 ",\"owner\":", event->arg);
+      print_string(name);
+      fprintf(out, "}}");
+      break;
+   case MMAL_TRACE_QUEUE_PUT:
+   case MMAL_TRACE_QUEUE_GET:
+      print_event("X", event->type == MMAL_TRACE_QUEUE_GET ? "get" :
+                  event->arg ? "put back" : "put", e->thread, event->time);
+      fprintf(out, ",\"dur\":%.3f,\"cat\":\"queue\"", INSTANT_DURATION);
+      print_buffer_args(event);
+      fprintf(out, ",\"queue\":");
+      print_string(name);
+      fprintf(out, "}}");
+      break;
+   default:
+      break;
+   }
+}
+
+/** Lifetime and handoffs of the buffer header of an event */
+static void print_buffer(const EVENT_T *e, unsigned int *flows)
+{
+   const MMAL_TRACE_EVENT_T *event = &e->event;
+   BUFFER_T *buffer;
+   char name[32];
+
+   if (!event->buffer)
+      return;
+   buffer = buffer_state(event->buffer);
+   snprintf(name, sizeof(name), "buffer 0x%" PRIx64, event->buffer);
+
+   if (!buffer->alive)
+   {
+      print_event("b", name, e->thread, event->time);
+      fprintf(out, ",\"cat\":\"buffer\",\"id\":\"0x%" PRIx64 "\"", event->buffer);
+      if (event->pts != MMAL_TIME_UNKNOWN)
+         fprintf(out, ",\"args\":{\"pts\":%" PRId64 "}", event->pts);
+      fprintf(out, "}");
+      buffer->alive = 1;
+   }
+   else if (buffer->thread != e->thread)
+   {
+      print_event("s", "handoff", buffer->thread, buffer->time);
+      fprintf(out, ",\"cat\":\"handoff\",\"id\":%u}", *flows);
+      print_event("f", "handoff", e->thread, event->time);
+      fprintf(out, ",\"cat\":\"handoff\",\"id\":%u,\"bp\":\"e\"}", *flows);
+      (*flows)++;
+   }
+
+   if (event->type == MMAL_TRACE_RELEASE && !event->arg)
+   {
+      print_event("e", name, e->thread, event->time);
+      fprintf(out, ",\"cat\":\"buffer\",\"id\":\"0x%" PRIx64 "\"}", event->buffer);
+      buffer->alive = 0;
+   }
+   buffer->thread = e->thread;
+   buffer->time = event->time;
+}
+
+static int read_trace(FILE *file)
+{
+   MMAL_TRACE_FILE_HEADER_T header;
+   unsigned int i, j;
+
+   if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != MMAL_TRACE_FILE_MAGIC)
+   {
+      fprintf(stderr, "not a MMAL trace file\n");
+      return -1;
+   }
+   if (header.version != MMAL_TRACE_FILE_VERSION || header.event_size != sizeof(MMAL_TRACE_EVENT_T))
+   {
+      fprintf(stderr, "trace file version %u with events of %u bytes, expected version %u and %u bytes\n",
+              header.version, header.event_size, MMAL_TRACE_FILE_VERSION, (unsigned int)sizeof(MMAL_TRACE_EVENT_T));
+      return -1;
+   }
+
+   pid = header.pid;
+   names_num = header.names;
+   threads_num = header.threads;
+   names = calloc(names_num + 1, sizeof(*names));
+   threads = calloc(threads_num + 1, sizeof(*threads));
+   if (!names || !threads || fread(names, sizeof(*names), names_num, file) != names_num)
+      goto error;
+   for (i = 0; i < names_num; i++)
+      names[i].name[sizeof(names[i].name) - 1] = 0;
+   qsort(names, names_num, sizeof(*names), compare_names);
+
+   for (i = 0; i < threads_num; i++)
+   {
+      MMAL_TRACE_THREAD_T *info = &threads[i].info;
+      EVENT_T *more;
+
+      if (fread(info, sizeof(*info), 1, file) != 1)
+         goto error;
+      info->name[sizeof(info->name) - 1] = 0;
+      more = realloc(events, (events_num + info->events + 1) * sizeof(*events));
+      if (!more)
+         goto error;
+      events = more;
+      for (j = 0; j < info->events; j++)
+      {
+         EVENT_T *e = &events[events_num + j];
+         if (fread(&e->event, sizeof(e->event), 1, file) != 1)
+            goto error;
+         e->thread = i;
+         e->order = j;
+      }
+      events_num += info->events;
+   }
+   return 0;
+
+error:
+   fprintf(stderr, "truncated trace file\n");
+   return -1;
+}
+
+int main(int argc, char **argv)
+{
+   unsigned int i, flows = 0, buffers_num = 0;
+   uint64_t dropped = 0, time_end;
+   FILE *file;
+
+   if (argc < 2 || argc > 3)
+   {
+      fprintf(stderr, "usage: %s trace.bin [trace.json]\n"
+              "Converts a MMAL trace to JSON for chrome://tracing or ui.perfetto.dev.\n", argv[0]);
+      return 1;
+   }
+
+   file = fopen(argv[1], "rb");
+   if (!file)
+   {
+      fprintf(stderr, "unable to open %s\n", argv[1]);
+      return 1;
+   }
+   if (read_trace(file))
+   {
+      fclose(file);
+      return 1;
+   }
+   fclose(file);
+
+   qsort(events, events_num, sizeof(*events), compare_events);
+   time_origin = events_num ? events[0].event.time : 0;
+   time_end = events_num ? events[events_num - 1].event.time : 0;
+
+   /* At most one slot per event, and the table never more than half full */
+   for (buffers_size = 16; buffers_size < 2 * events_num; buffers_size <<= 1);
+   buffers = calloc(buffers_size, sizeof(*buffers));
+   if (!buffers)
+   {
+      fprintf(stderr, "out of memory\n");
+      return 1;
+   }
+
+   out = stdout;
+   if (argc > 2 && !(out = fopen(argv[2], "w")))
+   {
+      fprintf(stderr, "unable to create %s\n", argv[2]);
+      return 1;
+   }
+
+   fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+   print_event("M", "process_name", 0, time_origin);
+   fprintf(out, ",\"args\":{\"name\":\"mmal\"}}");
+   for (i = 0; i < threads_num; i++)
+   {
+      print_event("M", "thread_name", i, time_origin);
+      fprintf(out, ",\"args\":{\"name\":");
+      print_string(threads[i].info.name[0] ? threads[i].info.name : "thread");
+      fprintf(out, "}}");
+      dropped += threads[i].info.dropped;
+   }
+
+   for (i = 0; i < events_num; i++)
+   {
+      print_slice(&events[i]);
+      print_buffer(&events[i], &flows);
+   }
+
+   /* Close what the end of the trace cut short */
+   for (i = 0; i < threads_num; i++)
+      for (; threads[i].depth; threads[i].depth--)
+      {
+         print_event("E", "", i, time_end);
+         fprintf(out, "}");
+      }
+   for (i = 0; i < buffers_size; i++)
+   {
+      char name[32];
+
+      if (!buffers[i].buffer)
+         continue;
+      buffers_num++;
+      if (!buffers[i].alive)
+         continue;
+      snprintf(name, sizeof(name), "buffer 0x%" PRIx64, buffers[i].buffer);
+      print_event("e", name, buffers[i].thread, time_end);
+      fprintf(out, ",\"cat\":\"buffer\",\"id\":\"0x%" PRIx64 "\"}", buffers[i].buffer);
+   }
+   fprintf(out, "\n]}\n");
+
+   if (out != stdout && fclose(out))
+   {
+      fprintf(stderr, "unable to write %s\n", argv[2]);
+      return 1;
+   }
+
+   fprintf(stderr, "%u threads, %u events (%" PRIu64 " overwritten), %u buffer headers, %u handoffs, %.3f ms\n",
+           threads_num, events_num, dropped, buffers_num, flows, (time_end - time_origin) / 1000000.0);
+   return 0;
+}
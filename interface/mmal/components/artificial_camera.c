@@ -25,12 +25,14 @@ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <math.h>
 #include "mmal.h"
 #include "core/mmal_component_private.h"
 #include "core/mmal_port_private.h"
 #include "mmal_logging.h"
 
 #define ARTIFICIAL_CAMERA_PORTS_NUM 3
+#define ARTIFICIAL_CAMERA_CLOCK_PORTS_NUM 1
 
 /* Buffering requirements */
 #define OUTPUT_MIN_BUFFER_NUM 1
@@ -38,15 +40,68 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define DEFAULT_WIDTH 320
 #define DEFAULT_HEIGHT 240
+#define DEFAULT_FRAME_RATE 30
+
+/* Geometry of the foosball scene, as fractions of the frame width (x) and
+ * height (y). The ball path is measured with the nominal aspect ratio of the
+ * table so it doesn't depend on the frame size at all. */
+#define SCENE_ASPECT        (16.0f / 9.0f)
+#define SCENE_FIELD_LEFT    0.08f
+#define SCENE_FIELD_RIGHT   0.92f
+#define SCENE_FIELD_TOP     0.085f
+#define SCENE_FIELD_BOTTOM  0.915f
+#define SCENE_GOAL_DEPTH    0.02f
+#define SCENE_GOAL_HEIGHT   0.24f
+#define SCENE_LINE_WIDTH    0.003f
+#define SCENE_CIRCLE_RADIUS 0.12f
+#define SCENE_RODS_NUM      8
+#define SCENE_ROD_WIDTH     0.005f
+#define SCENE_FIGURE_WIDTH  0.022f
+#define SCENE_FIGURE_HEIGHT 0.07f
+#define SCENE_BALL_RADIUS   (1.0f / 128)
+#define SCENE_BALL_MARGIN   0.02f
+
+/* Samples of the ball path over the exposure time for the motion blur */
+#define SCENE_BLUR_SAMPLES_MAX 32
+
+/* Figures on each rod from left to right, and which team they play for */
+static const unsigned int scene_rod_figures[SCENE_RODS_NUM] = { 1, 2, 3, 5, 5, 3, 2, 1 };
+static const unsigned int scene_rod_team[SCENE_RODS_NUM] = { 0, 0, 1, 0, 1, 0, 1, 1 };
+
+/* Colours of the scene, the same as the table of the synthetic tracker source */
+static const float scene_colour_surround[3] = { 20, 20, 20 };
+static const float scene_colour_goal[3] = { 5, 5, 5 };
+static const float scene_colour_field[3] = { 40, 140, 60 };
+static const float scene_colour_line[3] = { 70, 160, 85 };
+static const float scene_colour_rod[3] = { 150, 150, 160 };
+static const float scene_colour_team[2][3] = { { 200, 30, 40 }, { 30, 60, 200 } };
+static const float scene_colour_ball[3] = { 230, 180, 30 };
 
 /*****************************************************************************/
+/** One straight leg of the ball path, between two waypoints */
+typedef struct ARTIFICIAL_SCENE_LEG_T
+{
+   uint32_t index;   /**< Leg number from the start of the path */
+   double start;     /**< Time at which the ball leaves the first waypoint in seconds */
+   double duration;  /**< Time to the second waypoint in seconds */
+   float x[2], y[2]; /**< Waypoints in fractions of the frame size */
+
+} ARTIFICIAL_SCENE_LEG_T;
+
 typedef struct MMAL_PORT_MODULE_T
 {
    MMAL_BUFFER_HEADER_VIDEO_SPECIFIC_T frame;
    unsigned int frame_size;
    int count;
 
-   MMAL_QUEUE_T *queue;
+   MMAL_QUEUE_T *queue;             /**< Buffers waiting to be filled */
+   MMAL_QUEUE_T *ready;             /**< Buffers the clock says are due */
+   MMAL_BUFFER_HEADER_T *scheduled; /**< Buffer waiting for the clock */
+   int64_t pts_base;                /**< Media time of the first frame */
+
+   MMAL_PARAMETER_ARTIFICIAL_SCENE_T scene;
+   uint8_t *background;             /**< The table without the ball, in the port format */
+   ARTIFICIAL_SCENE_LEG_T leg;      /**< Current leg of the ball path */
 
 } MMAL_PORT_MODULE_T;
 
@@ -57,58 +112,519 @@ typedef struct MMAL_COMPONENT_MODULE_T
 } MMAL_COMPONENT_MODULE_T;
 
 /*****************************************************************************/
-static void artificial_camera_do_processing(MMAL_COMPONENT_T *component)
+/** Frame rate of a port, with a default for formats which don't have one */
+static MMAL_RATIONAL_T artificial_camera_frame_rate(MMAL_PORT_T *port)
 {
-   MMAL_COMPONENT_MODULE_T *module = component->priv->module;
-   MMAL_BUFFER_HEADER_T *buffer;
+   MMAL_RATIONAL_T frame_rate = port->format->es->video.frame_rate;
+
+   if (!frame_rate.num || !frame_rate.den)
+   {
+      frame_rate.num = DEFAULT_FRAME_RATE;
+      frame_rate.den = 1;
+   }
+   return frame_rate;
+}
+
+static uint32_t scene_hash(uint32_t seed, uint32_t value)
+{
+   uint32_t hash = (seed * 0x9e3779b9) ^ value;
+   hash ^= hash >> 16;
+   hash *= 0x7feb352d;
+   hash ^= hash >> 15;
+   hash *= 0x846ca68b;
+   hash ^= hash >> 16;
+   return hash;
+}
+
+/** Random number in [0,1) which only depends on the seed and value */
+static float scene_random(uint32_t seed, uint32_t value)
+{
+   return (scene_hash(seed, value) >> 8) / 16777216.0f;
+}
+
+/** Set up a leg of the ball path from the seed */
+static void scene_leg_set(const MMAL_PARAMETER_ARTIFICIAL_SCENE_T *scene, ARTIFICIAL_SCENE_LEG_T *leg,
+   uint32_t index, double start)
+{
+   float xmin = SCENE_FIELD_LEFT + SCENE_BALL_MARGIN, xmax = SCENE_FIELD_RIGHT - SCENE_BALL_MARGIN;
+   float ymin = SCENE_FIELD_TOP + SCENE_BALL_MARGIN, ymax = SCENE_FIELD_BOTTOM - SCENE_BALL_MARGIN;
+   float distance, speed;
    unsigned int i;
 
-   if (module->status != MMAL_SUCCESS)
+   for (i = 0; i < 2; i++)
+   {
+      leg->x[i] = xmin + (xmax - xmin) * scene_random(scene->seed, 3 * (index + i));
+      leg->y[i] = ymin + (ymax - ymin) * scene_random(scene->seed, 3 * (index + i) + 1);
+   }
+
+   /* Every kick is somewhere between half and one and a half times the speed */
+   distance = hypotf(leg->x[1] - leg->x[0], (leg->y[1] - leg->y[0]) / SCENE_ASPECT) /
+      (SCENE_FIELD_RIGHT - SCENE_FIELD_LEFT);
+   speed = scene->ball_speed / 100.0f * (0.5f + scene_random(scene->seed, 3 * index + 2));
+
+   leg->index = index;
+   leg->start = start;
+   leg->duration = MMAL_MAX(distance / speed, 0.001f);
+}
+
+/** Where the ball is at a time, in fractions of the frame size */
+static void scene_ball_position(MMAL_PORT_MODULE_T *port_module, double time, float *x, float *y)
+{
+   const MMAL_PARAMETER_ARTIFICIAL_SCENE_T *scene = &port_module->scene;
+   ARTIFICIAL_SCENE_LEG_T *leg = &port_module->leg;
+   float progress;
+
+   if (!scene->ball_speed || time <= 0)
+   {
+      ARTIFICIAL_SCENE_LEG_T first;
+      scene_leg_set(scene, &first, 0, 0);
+      *x = first.x[0];
+      *y = first.y[0];
       return;
+   }
 
-   /* Loop through all the ports */
-   for (i = 0; i < component->output_num; i++)
+   /* Frames only go forward but the exposure can reach into the previous leg */
+   while (time >= leg->start + leg->duration)
+      scene_leg_set(scene, leg, leg->index + 1, leg->start + leg->duration);
+   while (time < leg->start && leg->index)
    {
-      MMAL_PORT_T *port = component->output[i];
+      scene_leg_set(scene, leg, leg->index - 1, leg->start);
+      leg->start -= leg->duration;
+   }
+
+   progress = (float)((time - leg->start) / leg->duration);
+   *x = leg->x[0] + (leg->x[1] - leg->x[0]) * progress;
+   *y = leg->y[0] + (leg->y[1] - leg->y[0]) * progress;
+}
+
+/** Light falling on the table, 1.0 for the nominal colours */
+static float scene_light(const MMAL_PARAMETER_ARTIFICIAL_SCENE_T *scene, float x, float y)
+{
+   /* The falloff is quadratic from the centre to the corners */
+   float r2 = ((x - 0.5f) * (x - 0.5f) + (y - 0.5f) * (y - 0.5f)) * 2.0f;
+   float light = scene->brightness / 100.0f * (1.0f - scene->vignetting / 100.0f * r2);
+   return MMAL_MAX(light, 0.0f);
+}
+
+/** BT.601 limited range, the inverse of what the tracker uses */
+static void scene_rgb_to_yuv(const float rgb[3], float light, uint8_t yuv[3])
+{
+   float r = MMAL_MIN(rgb[0] * light, 255.0f);
+   float g = MMAL_MIN(rgb[1] * light, 255.0f);
+   float b = MMAL_MIN(rgb[2] * light, 255.0f);
+
+   yuv[0] = (uint8_t)(16.5f + 0.256788f * r + 0.504129f * g + 0.097906f * b);
+   yuv[1] = (uint8_t)(128.5f - 0.148223f * r - 0.290993f * g + 0.439216f * b);
+   yuv[2] = (uint8_t)(128.5f + 0.439216f * r - 0.367788f * g - 0.071427f * b);
+}
 
-      buffer = mmal_queue_get(port->priv->module->queue);
-      if (!buffer)
+/** Colour of the table without the ball at a point, in fractions of the frame size */
+static const float *scene_table_colour(float x, float y, float aspect)
+{
+   float field_width = SCENE_FIELD_RIGHT - SCENE_FIELD_LEFT;
+   float field_height = SCENE_FIELD_BOTTOM - SCENE_FIELD_TOP;
+   const float *colour = scene_colour_surround;
+   float dx, dy;
+   unsigned int i, j;
+
+   if (fabsf(y - 0.5f) < SCENE_GOAL_HEIGHT / 2 &&
+       ((x >= SCENE_FIELD_LEFT - SCENE_GOAL_DEPTH && x < SCENE_FIELD_LEFT) ||
+        (x >= SCENE_FIELD_RIGHT && x < SCENE_FIELD_RIGHT + SCENE_GOAL_DEPTH)))
+      colour = scene_colour_goal;
+
+   if (x >= SCENE_FIELD_LEFT && x < SCENE_FIELD_RIGHT && y >= SCENE_FIELD_TOP && y < SCENE_FIELD_BOTTOM)
+   {
+      colour = scene_colour_field;
+
+      /* Centre line and circle */
+      dx = (x - 0.5f) * aspect;
+      dy = y - 0.5f;
+      if (fabsf(x - 0.5f) < SCENE_LINE_WIDTH / 2 ||
+          fabsf(sqrtf(dx * dx + dy * dy) - SCENE_CIRCLE_RADIUS) < SCENE_LINE_WIDTH * aspect / 2)
+         colour = scene_colour_line;
+   }
+
+   /* The rods go across the whole table with the figures on top */
+   for (i = 0; i < SCENE_RODS_NUM; i++)
+   {
+      float rod_x = SCENE_FIELD_LEFT + field_width * (i + 0.5f) / SCENE_RODS_NUM;
+
+      if (fabsf(x - rod_x) >= SCENE_FIGURE_WIDTH / 2)
          continue;
+      if (fabsf(x - rod_x) < SCENE_ROD_WIDTH / 2)
+         colour = scene_colour_rod;
 
-      /* Sanity check the buffer size */
-      if (buffer->alloc_size < port->priv->module->frame_size)
+      for (j = 0; j < scene_rod_figures[i]; j++)
       {
-         LOG_ERROR("buffer too small (%i/%i)",
-                   buffer->alloc_size, port->priv->module->frame_size);
-         module->status = MMAL_EINVAL;
-         mmal_queue_put_back(port->priv->module->queue, buffer);
-         mmal_event_error_send(component, module->status);
-         return;
+         float figure_y = SCENE_FIELD_TOP + field_height * (j + 0.5f) / scene_rod_figures[i];
+         if (fabsf(y - figure_y) < SCENE_FIGURE_HEIGHT / 2)
+            colour = scene_colour_team[scene_rod_team[i]];
       }
-      module->status = mmal_buffer_header_mem_lock(buffer);
-      if (module->status != MMAL_SUCCESS)
+   }
+
+   return colour;
+}
+
+/** Chroma shift of the vertical subsampling of the port format */
+static unsigned int scene_chroma_shift_y(MMAL_PORT_T *port)
+{
+   return port->format->encoding == MMAL_ENCODING_I422 ? 0 : 1;
+}
+
+/** Address of a U (plane 0) or V (plane 1) chroma sample in a frame */
+static uint8_t *scene_chroma(MMAL_PORT_MODULE_T *port_module, uint8_t *data, unsigned int plane,
+   unsigned int x, unsigned int y)
+{
+   MMAL_BUFFER_HEADER_VIDEO_SPECIFIC_T *frame = &port_module->frame;
+
+   /* NV21 has interleaved chroma with V first */
+   if (frame->planes == 2)
+      return data + frame->offset[1] + y * frame->pitch[1] + x * 2 + !plane;
+   return data + frame->offset[1 + plane] + y * frame->pitch[1 + plane] + x;
+}
+
+/** Render the table without the ball in the port format */
+static MMAL_STATUS_T scene_background_render(MMAL_PORT_T *port)
+{
+   MMAL_PORT_MODULE_T *port_module = port->priv->module;
+   unsigned int width = port->format->es->video.width;
+   unsigned int height = port->format->es->video.height;
+   unsigned int shift_y = scene_chroma_shift_y(port);
+   float aspect = (float)width / height;
+   uint8_t *data, yuv[3];
+   unsigned int x, y;
+
+   data = vcos_calloc(1, port_module->frame_size, "artificial scene");
+   if (!data)
+      return MMAL_ENOMEM;
+
+   for (y = 0; y < height; y++)
+   {
+      for (x = 0; x < width; x++)
       {
-         LOG_ERROR("invalid buffer (%p, %p)", buffer, buffer->data);
-         mmal_queue_put_back(port->priv->module->queue, buffer);
-         mmal_event_error_send(component, module->status);
-         return;
+         float fx = (x + 0.5f) / width, fy = (y + 0.5f) / height;
+         scene_rgb_to_yuv(scene_table_colour(fx, fy, aspect), scene_light(&port_module->scene, fx, fy), yuv);
+         data[y * port_module->frame.pitch[0] + x] = yuv[0];
+      }
+   }
+
+   for (y = 0; y < height >> shift_y; y++)
+   {
+      for (x = 0; x < width / 2; x++)
+      {
+         float fx = (2 * x + 1.0f) / width, fy = (y + 0.5f) * (1 << shift_y) / height;
+         scene_rgb_to_yuv(scene_table_colour(fx, fy, aspect), scene_light(&port_module->scene, fx, fy), yuv);
+         *scene_chroma(port_module, data, 0, x, y) = yuv[1];
+         *scene_chroma(port_module, data, 1, x, y) = yuv[2];
+      }
+   }
+
+   port_module->background = data;
+   return MMAL_SUCCESS;
+}
+
+/** How much of a pixel the ball covers, averaged over the exposure */
+static float scene_ball_coverage(const float *ball_x, const float *ball_y, unsigned int samples,
+   float radius, float x, float y)
+{
+   float coverage = 0;
+   unsigned int i;
+
+   for (i = 0; i < samples; i++)
+   {
+      float dx = x - ball_x[i], dy = y - ball_y[i];
+      float edge = radius + 0.5f - sqrtf(dx * dx + dy * dy);
+      coverage += edge <= 0 ? 0 : edge >= 1 ? 1 : edge;
+   }
+   return coverage / samples;
+}
+
+static uint8_t scene_blend(uint8_t from, uint8_t to, float alpha)
+{
+   return (uint8_t)(from + (to - from) * alpha + 0.5f);
+}
+
+/** Add uniform noise to every byte of a frame */
+static void scene_noise(uint8_t *data, unsigned int size, unsigned int amplitude, uint32_t state)
+{
+   uint32_t random = 0;
+   unsigned int i;
+
+   state |= 1;
+   for (i = 0; i < size; i++)
+   {
+      int value;
+
+      /* xorshift32, 4 bytes at a time */
+      if (!(i & 3))
+      {
+         state ^= state << 13;
+         state ^= state >> 17;
+         state ^= state << 5;
+         random = state;
       }
+      value = data[i] + (int)(((random & 0xff) * (2 * amplitude + 1)) >> 8) - (int)amplitude;
+      data[i] = value < 0 ? 0 : value > 255 ? 255 : value;
+      random >>= 8;
+   }
+}
 
-      buffer->offset = 0;
-      buffer->length = port->priv->module->frame_size;
-      buffer->type->video = port->priv->module->frame;
+/** Render a frame of the foosball scene, with the ball where it is at the frame time */
+static MMAL_STATUS_T scene_render(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
+{
+   MMAL_PORT_MODULE_T *port_module = port->priv->module;
+   const MMAL_PARAMETER_ARTIFICIAL_SCENE_T *scene = &port_module->scene;
+   MMAL_RATIONAL_T frame_rate = artificial_camera_frame_rate(port);
+   unsigned int width = port->format->es->video.width;
+   unsigned int height = port->format->es->video.height;
+   unsigned int shift_y = scene_chroma_shift_y(port);
+   float ball_x[SCENE_BLUR_SAMPLES_MAX], ball_y[SCENE_BLUR_SAMPLES_MAX];
+   float radius = SCENE_BALL_RADIUS * width, blur, xmin, xmax, ymin, ymax;
+   MMAL_METADATA_BALL_TRUTH_T truth;
+   double time, exposure;
+   unsigned int samples, i;
+   int x, y;
+   uint8_t yuv[3];
+
+   if (!port_module->background)
+   {
+      MMAL_STATUS_T status = scene_background_render(port);
+      if (status != MMAL_SUCCESS)
+         return status;
+   }
+   memcpy(buffer->data, port_module->background, port_module->frame_size);
+
+   time = (double)port_module->count * frame_rate.den / frame_rate.num;
+   exposure = scene->exposure / 100.0 * frame_rate.den / frame_rate.num;
+
+   /* Where the ball is at the frame time, which is the middle of the exposure */
+   memset(&truth, 0, sizeof(truth));
+   truth.id = MMAL_METADATA_BALL_TRUTH;
+   truth.size = sizeof(truth) - sizeof(MMAL_METADATA_T);
+   scene_ball_position(port_module, time, &truth.x, &truth.y);
+   scene_rgb_to_yuv(scene_colour_ball, scene_light(scene, truth.x, truth.y), yuv);
+
+   /* Enough samples over the exposure for them to be less than half a radius
+    * apart, so the ball is smeared rather than repeated */
+   samples = 1;
+   if (exposure > 0)
+   {
+      float start_x, start_y, end_x, end_y;
+      scene_ball_position(port_module, time - exposure / 2, &start_x, &start_y);
+      scene_ball_position(port_module, time + exposure / 2, &end_x, &end_y);
+      blur = hypotf((end_x - start_x) * width, (end_y - start_y) * height);
+      samples = MMAL_MIN((unsigned int)(2 * blur / radius) + 1, SCENE_BLUR_SAMPLES_MAX);
+   }
+   xmin = ymin = 1e9f;
+   xmax = ymax = -1e9f;
+   for (i = 0; i < samples; i++)
+   {
+      double t = samples == 1 ? time : time - exposure / 2 + exposure * i / (samples - 1);
+      scene_ball_position(port_module, t, &ball_x[i], &ball_y[i]);
+      ball_x[i] *= width;
+      ball_y[i] *= height;
+      xmin = MMAL_MIN(xmin, ball_x[i] - radius - 1);
+      xmax = MMAL_MAX(xmax, ball_x[i] + radius + 1);
+      ymin = MMAL_MIN(ymin, ball_y[i] - radius - 1);
+      ymax = MMAL_MAX(ymax, ball_y[i] + radius + 1);
+   }
+   xmin = MMAL_MAX(xmin, 0);
+   ymin = MMAL_MAX(ymin, 0);
+   xmax = MMAL_MIN(xmax, width - 1);
+   ymax = MMAL_MIN(ymax, height - 1);
 
+   for (y = (int)ymin; y <= (int)ymax; y++)
+   {
+      for (x = (int)xmin; x <= (int)xmax; x++)
+      {
+         float alpha = scene_ball_coverage(ball_x, ball_y, samples, radius, x + 0.5f, y + 0.5f);
+         uint8_t *p = buffer->data + y * port_module->frame.pitch[0] + x;
+         if (alpha > 0)
+            *p = scene_blend(*p, yuv[0], alpha);
+      }
+   }
+   for (y = (int)ymin >> shift_y; y <= (int)ymax >> shift_y; y++)
+   {
+      for (x = (int)xmin / 2; x <= (int)xmax / 2; x++)
+      {
+         float alpha = scene_ball_coverage(ball_x, ball_y, samples, radius, 2 * x + 1.0f,
+                                           (y + 0.5f) * (1 << shift_y));
+         uint8_t *u = scene_chroma(port_module, buffer->data, 0, x, y);
+         uint8_t *v = scene_chroma(port_module, buffer->data, 1, x, y);
+         if (alpha <= 0)
+            continue;
+         *u = scene_blend(*u, yuv[1], alpha);
+         *v = scene_blend(*v, yuv[2], alpha);
+      }
+   }
+
+   if (scene->noise)
+      scene_noise(buffer->data, port_module->frame_size, MMAL_MIN(scene->noise, 127),
+                  scene_hash(scene->seed ^ 0x6e6f6973, port_module->count));
+
+   /* In the [-1,1] coordinates of the tracker */
+   truth.x = 2 * truth.x - 1;
+   truth.y = 2 * truth.y - 1;
+   truth.radius = 2 * SCENE_BALL_RADIUS;
+   truth.frame = port_module->count;
+   return mmal_metadata_set(buffer, (MMAL_METADATA_T *)&truth);
+}
+
+/*****************************************************************************/
+/** Presentation time of a frame of a port */
+static int64_t artificial_camera_frame_pts(MMAL_PORT_T *port, int frame)
+{
+   MMAL_RATIONAL_T frame_rate = artificial_camera_frame_rate(port);
+   return port->priv->module->pts_base + (int64_t)frame * 1000000 * frame_rate.den / frame_rate.num;
+}
+
+/** Fill a buffer with the next frame and send it */
+static MMAL_STATUS_T artificial_camera_send_frame(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
+{
+   MMAL_PORT_MODULE_T *port_module = port->priv->module;
+   MMAL_STATUS_T status;
+
+   /* Sanity check the buffer size */
+   if (buffer->alloc_size < port_module->frame_size)
+   {
+      LOG_ERROR("buffer too small (%i/%i)", buffer->alloc_size, port_module->frame_size);
+      return MMAL_EINVAL;
+   }
+   status = mmal_buffer_header_mem_lock(buffer);
+   if (status != MMAL_SUCCESS)
+   {
+      LOG_ERROR("invalid buffer (%p, %p)", buffer, buffer->data);
+      return status;
+   }
+
+   buffer->offset = 0;
+   buffer->length = port_module->frame_size;
+   buffer->type->video = port_module->frame;
+   buffer->pts = buffer->dts = artificial_camera_frame_pts(port, port_module->count);
+
+   if (port_module->scene.scene == MMAL_PARAM_ARTIFICIAL_SCENE_FOOSBALL)
+   {
+      status = scene_render(port, buffer);
+   }
+   else
+   {
       memset(buffer->data, 0xff, buffer->length);
       if (buffer->type->video.planes > 1)
-         memset(buffer->data + buffer->type->video.offset[1],
-                0x7f - port->priv->module->count++,
+         memset(buffer->data + buffer->type->video.offset[1], 0x7f - port_module->count,
                 buffer->length - buffer->type->video.offset[1]);
+   }
 
-      mmal_buffer_header_mem_unlock(buffer);
-      mmal_port_buffer_header_callback(port, buffer);
+   mmal_buffer_header_mem_unlock(buffer);
+   if (status != MMAL_SUCCESS)
+      return status;
+
+   port_module->count++;
+   mmal_port_buffer_header_callback(port, buffer);
+   return MMAL_SUCCESS;
+}
+
+/** Invoked by the clock when a frame is due, or when the requests are flushed */
+static void artificial_camera_clock_cb(MMAL_PORT_T *clock, int64_t media_time, void *cb_data)
+{
+   MMAL_PORT_T *port = (MMAL_PORT_T *)cb_data;
+   MMAL_BUFFER_HEADER_T *buffer = port->priv->module->scheduled;
+   MMAL_PARAM_UNUSED(clock);
+
+   /* This runs with the clock locked so leave the rest to the action */
+   buffer->dts = media_time;
+   mmal_queue_put(port->priv->module->ready, buffer);
+   mmal_component_action_trigger(port->component);
+}
+
+/** Ask the clock for a callback when the next frame of a port is due */
+static void artificial_camera_schedule(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
+{
+   MMAL_PORT_MODULE_T *port_module = port->priv->module;
+   MMAL_PORT_T *clock = port->component->clock[0];
+
+   /* Without a connection to a clock component we run the clock ourselves.
+    * It starts at the first frame and ports enabled later carry on from the
+    * media time. */
+   if (!port_module->count && !clock->is_enabled)
+   {
+      port_module->pts_base = 0;
+      if (!mmal_port_clock_active_get(clock))
+      {
+         mmal_port_clock_media_time_set(clock, 0);
+         mmal_port_clock_active_set(clock, MMAL_TRUE);
+      }
+      else
+         port_module->pts_base = mmal_port_clock_media_time_get(clock);
    }
 
-   vcos_sleep(10); /* Make sure we don't peg all the resources */
+   buffer->pts = artificial_camera_frame_pts(port, port_module->count);
+   port_module->scheduled = buffer;
+   if (mmal_port_clock_request_add(clock, buffer->pts, artificial_camera_clock_cb, port) != MMAL_SUCCESS)
+   {
+      /* Don't hold on to the frame if the clock can't take the request */
+      LOG_DEBUG("no clock request for frame %i of %s", port_module->count, port->name);
+      port_module->scheduled = NULL;
+      buffer->dts = buffer->pts;
+      mmal_queue_put(port_module->ready, buffer);
+      mmal_component_action_trigger(port->component);
+   }
+}
+
+static void artificial_camera_do_processing(MMAL_COMPONENT_T *component)
+{
+   MMAL_COMPONENT_MODULE_T *module = component->priv->module;
+   MMAL_BUFFER_HEADER_T *buffer;
+   unsigned int i;
+
+   /* Loop through all the ports */
+   for (i = 0; i < component->output_num; i++)
+   {
+      MMAL_PORT_T *port = component->output[i];
+      MMAL_PORT_MODULE_T *port_module = port->priv->module;
+
+      if (module->status != MMAL_SUCCESS)
+         return;
+
+      /* Send the frames the clock says are due */
+      while ((buffer = mmal_queue_get(port_module->ready)) != NULL)
+      {
+         if (buffer == port_module->scheduled)
+            port_module->scheduled = NULL;
+
+         /* The clock requests were flushed before the frame was due */
+         if (buffer->dts < buffer->pts)
+         {
+            mmal_queue_put_back(port_module->queue, buffer);
+            continue;
+         }
+
+         module->status = artificial_camera_send_frame(port, buffer);
+         if (module->status != MMAL_SUCCESS)
+         {
+            mmal_queue_put_back(port_module->queue, buffer);
+            mmal_event_error_send(component, module->status);
+            return;
+         }
+      }
+
+      /* Frames are paced by the clock, one at a time */
+      while (!port_module->scheduled && (buffer = mmal_queue_get(port_module->queue)) != NULL)
+      {
+         if (!port_module->scene.free_running)
+         {
+            artificial_camera_schedule(port, buffer);
+            continue;
+         }
+
+         module->status = artificial_camera_send_frame(port, buffer);
+         if (module->status != MMAL_SUCCESS)
+         {
+            mmal_queue_put_back(port_module->queue, buffer);
+            mmal_event_error_send(component, module->status);
+            return;
+         }
+      }
+   }
 }
 
 /** Destroy a previously created component */
@@ -117,11 +633,19 @@ static MMAL_STATUS_T artificial_camera_component_destroy(MMAL_COMPONENT_T *compo
    unsigned int i;
 
    for (i = 0; i < component->output_num; i++)
-      if (component->output[i]->priv->module->queue)
-         mmal_queue_destroy(component->output[i]->priv->module->queue);
+   {
+      MMAL_PORT_MODULE_T *port_module = component->output[i]->priv->module;
+      if (port_module->queue)
+         mmal_queue_destroy(port_module->queue);
+      if (port_module->ready)
+         mmal_queue_destroy(port_module->ready);
+      vcos_free(port_module->background);
+   }
 
    if(component->output_num)
       mmal_ports_free(component->output, component->output_num);
+   if (component->clock_num)
+      mmal_ports_clock_free(component->clock, component->clock_num);
 
    vcos_free(component->priv->module);
    return MMAL_SUCCESS;
@@ -130,22 +654,59 @@ static MMAL_STATUS_T artificial_camera_component_destroy(MMAL_COMPONENT_T *compo
 /** Enable processing on a port */
 static MMAL_STATUS_T artificial_camera_port_enable(MMAL_PORT_T *port, MMAL_PORT_BH_CB_T cb)
 {
-   MMAL_PARAM_UNUSED(port);
+   MMAL_PORT_MODULE_T *port_module = port->priv->module;
    MMAL_PARAM_UNUSED(cb);
+
+   /* Every time the port is enabled the ball starts its path again */
+   port_module->count = 0;
+   port_module->pts_base = 0;
+   scene_leg_set(&port_module->scene, &port_module->leg, 0, 0);
    return MMAL_SUCCESS;
 }
 
 /** Flush a port */
 static MMAL_STATUS_T artificial_camera_port_flush(MMAL_PORT_T *port)
 {
-   MMAL_PARAM_UNUSED(port);
+   MMAL_PORT_MODULE_T *port_module = port->priv->module;
+   MMAL_BUFFER_HEADER_T *buffer, *next;
+
+   /* The core holds the action lock so nothing gets scheduled meanwhile.
+    * This moves the buffer waiting for the clock to the ready queue. The ones
+    * of the other ports are scheduled again by the action. */
+   mmal_port_clock_request_flush(port->component->clock[0]);
+   mmal_component_action_trigger(port->component);
+
+   /* Return the buffers we haven't filled yet, the ready ones first */
+   for (buffer = mmal_queue_get_batch(port_module->ready, 0); buffer; buffer = next)
+   {
+      next = buffer->next;
+      mmal_port_buffer_header_callback(port, buffer);
+   }
+   for (buffer = mmal_queue_get_batch(port_module->queue, 0); buffer; buffer = next)
+   {
+      next = buffer->next;
+      mmal_port_buffer_header_callback(port, buffer);
+   }
+   port_module->scheduled = NULL;
    return MMAL_SUCCESS;
 }
 
 /** Disable processing on a port */
 static MMAL_STATUS_T artificial_camera_port_disable(MMAL_PORT_T *port)
 {
-   MMAL_PARAM_UNUSED(port);
+   MMAL_COMPONENT_T *component = port->component;
+   unsigned int i;
+
+   /* The core waits for all the buffers to come back */
+   artificial_camera_port_flush(port);
+
+   /* Stop the clock we run ourselves once no port needs it, so it starts
+    * from 0 again */
+   for (i = 0; i < component->output_num; i++)
+      if (component->output[i]->is_enabled)
+         return MMAL_SUCCESS;
+   if (!component->clock[0]->is_enabled)
+      mmal_port_clock_active_set(component->clock[0], MMAL_FALSE);
    return MMAL_SUCCESS;
 }
 
@@ -158,6 +719,14 @@ static MMAL_STATUS_T artificial_camera_port_send(MMAL_PORT_T *port, MMAL_BUFFER_
    return MMAL_SUCCESS;
 }
 
+/** Send a chain of buffer headers to a port */
+static MMAL_STATUS_T artificial_camera_port_send_buffers(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffers)
+{
+   mmal_queue_put_batch(port->priv->module->queue, buffers);
+   mmal_component_action_trigger(port->component);
+   return MMAL_SUCCESS;
+}
+
 /** Set format on a port */
 static MMAL_STATUS_T artificial_camera_port_format_commit(MMAL_PORT_T *port)
 {
@@ -200,15 +769,39 @@ static MMAL_STATUS_T artificial_camera_port_format_commit(MMAL_PORT_T *port)
    }
 
    port->buffer_size_min = port->buffer_size_recommended = port_module->frame_size;
+
+   /* The scene gets rendered again for the new format */
+   mmal_component_action_lock(port->component);
+   vcos_free(port_module->background);
+   port_module->background = NULL;
+   mmal_component_action_unlock(port->component);
    return MMAL_SUCCESS;
 }
 
 /** Set parameter on a port */
 static MMAL_STATUS_T artificial_port_parameter_set(MMAL_PORT_T *port, const MMAL_PARAMETER_HEADER_T *param)
 {
-   MMAL_PARAM_UNUSED(port);
+   MMAL_PORT_MODULE_T *port_module = port->priv->module;
+
    switch (param->id)
    {
+   case MMAL_PARAMETER_ARTIFICIAL_SCENE:
+      {
+         const MMAL_PARAMETER_ARTIFICIAL_SCENE_T *scene = (const MMAL_PARAMETER_ARTIFICIAL_SCENE_T *)param;
+         if (param->size < sizeof(*scene))
+            return MMAL_EINVAL;
+         if (scene->scene > MMAL_PARAM_ARTIFICIAL_SCENE_FOOSBALL || scene->noise > 127 ||
+             scene->exposure > 100 || scene->vignetting > 100)
+            return MMAL_EINVAL;
+
+         mmal_component_action_lock(port->component);
+         port_module->scene = *scene;
+         scene_leg_set(&port_module->scene, &port_module->leg, 0, 0);
+         vcos_free(port_module->background);
+         port_module->background = NULL;
+         mmal_component_action_unlock(port->component);
+         return MMAL_SUCCESS;
+      }
    default:
       return MMAL_ENOSYS;
    }
@@ -217,9 +810,16 @@ static MMAL_STATUS_T artificial_port_parameter_set(MMAL_PORT_T *port, const MMAL
 /** Get parameter on a port */
 static MMAL_STATUS_T artificial_port_parameter_get(MMAL_PORT_T *port, MMAL_PARAMETER_HEADER_T *param)
 {
-   MMAL_PARAM_UNUSED(port);
+   MMAL_PORT_MODULE_T *port_module = port->priv->module;
+
    switch (param->id)
    {
+   case MMAL_PARAMETER_ARTIFICIAL_SCENE:
+      if (param->size < sizeof(port_module->scene))
+         return MMAL_EINVAL;
+      memcpy((uint8_t *)param + sizeof(*param), (uint8_t *)&port_module->scene + sizeof(*param),
+             sizeof(port_module->scene) - sizeof(*param));
+      return MMAL_SUCCESS;
    default:
       return MMAL_ENOSYS;
    }
@@ -246,13 +846,21 @@ static MMAL_STATUS_T mmal_component_create_artificial_camera(const char *name, M
       goto error;
    component->output_num = ARTIFICIAL_CAMERA_PORTS_NUM;
 
+   /* The clock port paces the frames (clock ports are managed by the framework) */
+   component->clock = mmal_ports_clock_alloc(component, ARTIFICIAL_CAMERA_CLOCK_PORTS_NUM, 0, NULL);
+   if (!component->clock)
+      goto error;
+   component->clock_num = ARTIFICIAL_CAMERA_CLOCK_PORTS_NUM;
+
    for (i = 0; i < component->output_num; i++)
    {
+      MMAL_PORT_MODULE_T *port_module = component->output[i]->priv->module;
+
       component->output[i]->priv->pf_enable = artificial_camera_port_enable;
       component->output[i]->priv->pf_disable = artificial_camera_port_disable;
       component->output[i]->priv->pf_flush = artificial_camera_port_flush;
       component->output[i]->priv->pf_send = artificial_camera_port_send;
-      component->output[i]->priv->pf_send = artificial_camera_port_send;
+      component->output[i]->priv->pf_send_buffers = artificial_camera_port_send_buffers;
       component->output[i]->priv->pf_set_format = artificial_camera_port_format_commit;
       component->output[i]->priv->pf_parameter_set = artificial_port_parameter_set;
       component->output[i]->priv->pf_parameter_get = artificial_port_parameter_get;
@@ -260,12 +868,25 @@ static MMAL_STATUS_T mmal_component_create_artificial_camera(const char *name, M
       component->output[i]->format->encoding = MMAL_ENCODING_I420;
       component->output[i]->format->es->video.width = DEFAULT_WIDTH;
       component->output[i]->format->es->video.height = DEFAULT_HEIGHT;
+      component->output[i]->format->es->video.frame_rate.num = DEFAULT_FRAME_RATE;
+      component->output[i]->format->es->video.frame_rate.den = 1;
       component->output[i]->buffer_num_min = OUTPUT_MIN_BUFFER_NUM;
       component->output[i]->buffer_num_recommended = OUTPUT_RECOMMENDED_BUFFER_NUM;
       artificial_camera_port_format_commit(component->output[i]);
 
-      component->output[i]->priv->module->queue = mmal_queue_create();
-      if (!component->output[i]->priv->module->queue)
+      port_module->scene.hdr.id = MMAL_PARAMETER_ARTIFICIAL_SCENE;
+      port_module->scene.hdr.size = sizeof(port_module->scene);
+      port_module->scene.scene = MMAL_PARAM_ARTIFICIAL_SCENE_PATTERN;
+      port_module->scene.ball_speed = 60;
+      port_module->scene.brightness = 100;
+
+      /* Buffers are only taken out by the action and by flush, which both
+       * hold the action lock */
+      port_module->queue = mmal_queue_create_with_type(MMAL_QUEUE_TYPE_MPSC);
+      if (!port_module->queue)
+         goto error;
+      port_module->ready = mmal_queue_create_with_type(MMAL_QUEUE_TYPE_MPSC);
+      if (!port_module->ready)
          goto error;
    }
 
@@ -0,0 +1,558 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "mmal.h"
+#include "core/mmal_component_private.h"
+#include "core/mmal_port_private.h"
+#include "mmal_logging.h"
+#include "host_applications/linux/apps/raspicam/Balltracker.h"
+#include "host_applications/linux/apps/raspicam/BalltrackReference.h"
+#include "host_applications/linux/apps/raspicam/BalltrackSource.h"
+
+/* The cpu backend of the tracker only takes frames of the camera size */
+#define BALLTRACK_WIDTH  REFERENCE_SOURCE_WIDTH
+#define BALLTRACK_HEIGHT REFERENCE_SOURCE_HEIGHT
+
+#define BALLTRACK_RESULTS_BUFFER_NUM 4
+
+/*****************************************************************************/
+typedef struct MMAL_COMPONENT_MODULE_T
+{
+   MMAL_STATUS_T status; /**< current status of the component */
+   BALLTRACKER *tracker; /**< tracker with the cpu backend */
+   uint8_t *rgba;        /**< I420 frames converted for the tracker */
+   uint32_t frame_size;  /**< size of a frame in the input format */
+
+} MMAL_COMPONENT_MODULE_T;
+
+typedef struct MMAL_PORT_MODULE_T
+{
+   MMAL_QUEUE_T *queue; /**< queue for the buffers sent to the ports */
+   MMAL_BOOL_T needs_configuring; /**< port is waiting for a format commit */
+
+} MMAL_PORT_MODULE_T;
+
+/* The cpu backend keeps its state in statics so there can only be one instance */
+static MMAL_BOOL_T balltrack_instance;
+
+/*****************************************************************************/
+
+/** Run the tracker on one frame */
+static MMAL_STATUS_T balltrack_track(MMAL_COMPONENT_T *component, MMAL_BUFFER_HEADER_T *in,
+   MMAL_METADATA_BALLTRACK_T *result)
+{
+   MMAL_COMPONENT_MODULE_T *module = component->priv->module;
+   MMAL_METADATA_BALL_TRUTH_T *truth;
+   BALLTRACK_FRAME frame;
+   BALLTRACK_RESULT tracked;
+   MMAL_STATUS_T status;
+
+   if (in->length < module->frame_size)
+   {
+      LOG_ERROR("buffer too small for a frame (%i/%i)", in->length, module->frame_size);
+      return MMAL_EINVAL;
+   }
+
+   memset(&frame, 0, sizeof(frame));
+   frame.width = BALLTRACK_WIDTH;
+   frame.height = BALLTRACK_HEIGHT;
+   frame.pts = in->pts;
+
+   /* Frames of the artificial_camera scene say where the ball is */
+   truth = (MMAL_METADATA_BALL_TRUTH_T *)mmal_metadata_get(in, MMAL_METADATA_BALL_TRUTH);
+   if (truth)
+   {
+      frame.has_truth = 1;
+      frame.truth.x = truth->x;
+      frame.truth.y = truth->y;
+   }
+
+   status = mmal_buffer_header_mem_lock(in);
+   if (status != MMAL_SUCCESS)
+      return status;
+   if (component->input[0]->format->encoding == MMAL_ENCODING_I420)
+   {
+      balltrack_yuv_to_rgba(in->data + in->offset, BALLTRACK_WIDTH, BALLTRACK_HEIGHT, module->rgba);
+      frame.rgba = module->rgba;
+   }
+   else
+      frame.rgba = in->data + in->offset;
+   if (balltracker_process(module->tracker, &frame, &tracked) != 0)
+      status = MMAL_EINVAL;
+   mmal_buffer_header_mem_unlock(in);
+   if (status != MMAL_SUCCESS)
+      return status;
+
+   memset(result, 0, sizeof(*result));
+   result->id = MMAL_METADATA_BALLTRACK;
+   result->size = sizeof(*result) - sizeof(MMAL_METADATA_T);
+   result->pts = tracked.pts;
+   if (tracked.analysed)
+      result->flags |= MMAL_METADATA_BALLTRACK_FLAG_ANALYSED;
+   if (tracked.found)
+      result->flags |= MMAL_METADATA_BALLTRACK_FLAG_FOUND;
+   result->x = tracked.ball.x;
+   result->y = tracked.ball.y;
+   result->track_us = tracked.track_us;
+   if (tracked.has_truth)
+   {
+      result->flags |= MMAL_METADATA_BALLTRACK_FLAG_TRUTH;
+      result->truth_x = tracked.truth.x;
+      result->truth_y = tracked.truth.y;
+   }
+   return MMAL_SUCCESS;
+}
+
+/** Actual processing function */
+static MMAL_BOOL_T balltrack_do_processing(MMAL_COMPONENT_T *component)
+{
+   MMAL_COMPONENT_MODULE_T *module = component->priv->module;
+   MMAL_PORT_T *port_in = component->input[0];
+   MMAL_PORT_T *port_out = component->output[0];
+   MMAL_PORT_T *port_results = component->output[1];
+   MMAL_BUFFER_HEADER_T *in, *out = NULL, *results = NULL;
+   MMAL_METADATA_BALLTRACK_T result;
+
+   if (port_out->priv->module->needs_configuring)
+      return 0;
+
+   in = mmal_queue_get(port_in->priv->module->queue);
+   if (!in)
+      return 0;
+
+   /* Handle event buffers */
+   if (in->cmd)
+   {
+      MMAL_EVENT_FORMAT_CHANGED_T *event = mmal_event_format_changed_get(in);
+      if (event)
+      {
+         module->status = mmal_format_full_copy(port_in->format, event->format);
+         if (module->status == MMAL_SUCCESS)
+            module->status = port_in->priv->pf_set_format(port_in);
+         if (module->status != MMAL_SUCCESS)
+         {
+            LOG_ERROR("format not set on port %s %p (%i)", port_in->name, port_in, module->status);
+            if (mmal_event_error_send(component, module->status) != MMAL_SUCCESS)
+               LOG_ERROR("unable to send an error event buffer");
+         }
+      }
+      else
+      {
+         LOG_ERROR("discarding event %i on port %s %p", (int)in->cmd, port_in->name, port_in);
+      }
+
+      in->length = 0;
+      mmal_port_buffer_header_callback(port_in, in);
+      return 1;
+   }
+
+   /* Don't do anything if we've already seen an error */
+   if (module->status != MMAL_SUCCESS)
+      goto wait;
+
+   /* We need a buffer on each of the enabled output ports */
+   if (port_out->is_enabled && !(out = mmal_queue_get(port_out->priv->module->queue)))
+      goto wait;
+   if (port_results->is_enabled && !(results = mmal_queue_get(port_results->priv->module->queue)))
+      goto wait;
+
+   if (in->length)
+      module->status = balltrack_track(component, in, &result);
+
+   if (module->status == MMAL_SUCCESS && results)
+   {
+      /* Clear what the buffer carried the last time round */
+      mmal_buffer_header_reset(results);
+      if (in->length)
+         module->status = mmal_metadata_set(results, (MMAL_METADATA_T *)&result);
+      results->flags = in->flags;
+      results->pts = in->pts;
+      results->dts = in->dts;
+   }
+
+   /* The video frames carry the result as well */
+   if (module->status == MMAL_SUCCESS && out)
+      module->status = mmal_buffer_header_replicate(out, in);
+   if (module->status == MMAL_SUCCESS && out && in->length)
+      module->status = mmal_metadata_set(out, (MMAL_METADATA_T *)&result);
+
+   if (module->status != MMAL_SUCCESS)
+   {
+      if (mmal_event_error_send(component, module->status) != MMAL_SUCCESS)
+         LOG_ERROR("unable to send an error event buffer");
+      goto wait;
+   }
+
+   /* Send buffers back. The video output references the input buffer so it
+    * won't be recycled before the output is. */
+   if (results)
+      mmal_port_buffer_header_callback(port_results, results);
+   if (out)
+      mmal_port_buffer_header_callback(port_out, out);
+   in->length = 0;
+   mmal_port_buffer_header_callback(port_in, in);
+   return 1;
+
+ wait:
+   if (results)
+      mmal_queue_put_back(port_results->priv->module->queue, results);
+   if (out)
+      mmal_queue_put_back(port_out->priv->module->queue, out);
+   mmal_queue_put_back(port_in->priv->module->queue, in);
+   return 0;
+}
+
+/*****************************************************************************/
+static void balltrack_do_processing_loop(MMAL_COMPONENT_T *component)
+{
+   while (balltrack_do_processing(component));
+}
+
+/** Destroy a previously created component */
+static MMAL_STATUS_T balltrack_component_destroy(MMAL_COMPONENT_T *component)
+{
+   MMAL_COMPONENT_MODULE_T *module = component->priv->module;
+   unsigned int i;
+
+   for(i = 0; i < component->input_num; i++)
+      if(component->input[i]->priv->module->queue)
+         mmal_queue_destroy(component->input[i]->priv->module->queue);
+   if(component->input_num)
+      mmal_ports_free(component->input, component->input_num);
+
+   for(i = 0; i < component->output_num; i++)
+      if(component->output[i]->priv->module->queue)
+         mmal_queue_destroy(component->output[i]->priv->module->queue);
+   if(component->output_num)
+      mmal_ports_free(component->output, component->output_num);
+
+   if (module->tracker)
+   {
+      BALLTRACKER_STATS stats;
+      balltracker_get_stats(module->tracker, &stats);
+      if (stats.frames)
+         LOG_INFO("%u frames, ball found in %u, %u us per frame", stats.frames, stats.found,
+                  (unsigned int)(stats.track_us / stats.frames));
+      balltracker_destroy(module->tracker);
+   }
+   vcos_free(module->rgba);
+   vcos_free(module);
+
+   vcos_global_lock();
+   balltrack_instance = 0;
+   vcos_global_unlock();
+   return MMAL_SUCCESS;
+}
+
+/** Enable processing on a port */
+static MMAL_STATUS_T balltrack_port_enable(MMAL_PORT_T *port, MMAL_PORT_BH_CB_T cb)
+{
+   MMAL_PARAM_UNUSED(cb);
+
+   /* We need to propagate the buffer requirements when the input port is
+    * enabled */
+   if (port->type == MMAL_PORT_TYPE_INPUT)
+      return port->priv->pf_set_format(port);
+
+   return MMAL_SUCCESS;
+}
+
+/** Flush a port */
+static MMAL_STATUS_T balltrack_port_flush(MMAL_PORT_T *port)
+{
+   MMAL_PORT_MODULE_T *port_module = port->priv->module;
+   MMAL_BUFFER_HEADER_T *buffer, *next;
+
+   /* Flush buffers that our component is holding on to */
+   buffer = mmal_queue_get_batch(port_module->queue, 0);
+   while(buffer)
+   {
+      next = buffer->next;
+      mmal_port_buffer_header_callback(port, buffer);
+      buffer = next;
+   }
+
+   return MMAL_SUCCESS;
+}
+
+/** Disable processing on a port */
+static MMAL_STATUS_T balltrack_port_disable(MMAL_PORT_T *port)
+{
+   /* We just need to flush our internal queue */
+   return balltrack_port_flush(port);
+}
+
+/** Send a buffer header to a port */
+static MMAL_STATUS_T balltrack_port_send(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
+{
+   mmal_queue_put(port->priv->module->queue, buffer);
+   mmal_component_action_trigger(port->component);
+   return MMAL_SUCCESS;
+}
+
+/** Send a chain of buffer headers to a port */
+static MMAL_STATUS_T balltrack_port_send_buffers(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffers)
+{
+   mmal_queue_put_batch(port->priv->module->queue, buffers);
+   mmal_component_action_trigger(port->component);
+   return MMAL_SUCCESS;
+}
+
+/** Set format on input port */
+static MMAL_STATUS_T balltrack_input_port_format_commit(MMAL_PORT_T *in)
+{
+   MMAL_COMPONENT_T *component = in->component;
+   MMAL_COMPONENT_MODULE_T *module = component->priv->module;
+   MMAL_PORT_T *out = component->output[0];
+   MMAL_EVENT_FORMAT_CHANGED_T *event;
+   MMAL_BUFFER_HEADER_T *buffer;
+   MMAL_STATUS_T status;
+
+   /* The frames go to the tracker as they are so they need to be the size
+    * it works on, without any padding */
+   switch (in->format->encoding)
+   {
+   case MMAL_ENCODING_I420:
+      module->frame_size = BALLTRACK_WIDTH * BALLTRACK_HEIGHT * 3 / 2;
+      break;
+   case MMAL_ENCODING_RGBA:
+      module->frame_size = BALLTRACK_WIDTH * BALLTRACK_HEIGHT * 4;
+      break;
+   default:
+      LOG_ERROR("unsupported encoding %4.4s", (char *)&in->format->encoding);
+      return MMAL_ENOSYS;
+   }
+   if (in->format->es->video.width != BALLTRACK_WIDTH || in->format->es->video.height != BALLTRACK_HEIGHT)
+   {
+      LOG_ERROR("frames need to be %ix%i, not %ix%i", BALLTRACK_WIDTH, BALLTRACK_HEIGHT,
+                in->format->es->video.width, in->format->es->video.height);
+      return MMAL_EINVAL;
+   }
+   in->buffer_size_min = module->frame_size;
+
+   /* Check if there's anything to propagate to the output port */
+   /* The format of the output port needs to match the input port */
+   if (!mmal_format_compare(in->format, out->format) &&
+       out->buffer_size_min == out->buffer_size_recommended &&
+       out->buffer_size_min == MMAL_MAX(in->buffer_size_min, in->buffer_size))
+      return MMAL_SUCCESS;
+
+   /* If the output port is not enabled we just need to update its format.
+    * Otherwise we'll have to trigger a format changed event for it. */
+   if (!out->is_enabled)
+   {
+      out->buffer_size_min = out->buffer_size_recommended =
+         MMAL_MAX(in->buffer_size, in->buffer_size_min);
+      return mmal_format_full_copy(out->format, in->format);
+   }
+
+   /* Send an event on the output port */
+   status = mmal_port_event_get(out, &buffer, MMAL_EVENT_FORMAT_CHANGED);
+   if (status != MMAL_SUCCESS)
+   {
+      LOG_ERROR("unable to get an event buffer");
+      return status;
+   }
+
+   event = mmal_event_format_changed_get(buffer);
+   mmal_format_copy(event->format, in->format);
+
+   /* Pass on the buffer requirements */
+   event->buffer_num_min = out->buffer_num_min;
+   event->buffer_num_recommended = out->buffer_num_recommended;
+   event->buffer_size_min = event->buffer_size_recommended =
+      MMAL_MAX(in->buffer_size_min, in->buffer_size);
+
+   out->priv->module->needs_configuring = 1;
+   mmal_port_event_send(out, buffer);
+   return status;
+}
+
+/** Set format on output port */
+static MMAL_STATUS_T balltrack_output_port_format_commit(MMAL_PORT_T *out)
+{
+   MMAL_COMPONENT_T *component = out->component;
+   MMAL_PORT_T *in = component->input[0];
+
+   /* The results port only sends metadata */
+   if (out->index == 1)
+      return out->format->encoding == MMAL_ENCODING_METADATA ? MMAL_SUCCESS : MMAL_EINVAL;
+
+   /* The format of the video output port needs to match the input port */
+   if (mmal_format_compare(out->format, in->format))
+      return MMAL_EINVAL;
+
+   out->priv->module->needs_configuring = 0;
+   mmal_component_action_trigger(out->component);
+   return MMAL_SUCCESS;
+}
+
+/** Set parameter on a port */
+static MMAL_STATUS_T balltrack_port_parameter_set(MMAL_PORT_T *port, const MMAL_PARAMETER_HEADER_T *param)
+{
+   MMAL_COMPONENT_T *component = port->component;
+   MMAL_PORT_T *in = component->input[0], *out = component->output[0];
+
+   switch (param->id)
+   {
+   case MMAL_PARAMETER_BUFFER_REQUIREMENTS:
+      {
+         /* The video output holds on to the input buffers so the requirements
+          * apply to both ports */
+         const MMAL_PARAMETER_BUFFER_REQUIREMENTS_T *req = (const MMAL_PARAMETER_BUFFER_REQUIREMENTS_T *)param;
+         if (port == component->output[1])
+            return MMAL_ENOSYS;
+         in->buffer_num_min = out->buffer_num_min =
+            MMAL_MAX(port->buffer_num_min, req->buffer_num_min);
+         in->buffer_num_recommended = out->buffer_num_recommended =
+            MMAL_MAX(port->buffer_num_recommended, req->buffer_num_recommended);
+      }
+      return MMAL_SUCCESS;
+
+   default:
+      return MMAL_ENOSYS;
+   }
+}
+
+/** Create an instance of a component  */
+static MMAL_STATUS_T mmal_component_create_balltrack(const char *name, MMAL_COMPONENT_T *component)
+{
+   MMAL_COMPONENT_MODULE_T *module;
+   MMAL_STATUS_T status = MMAL_ENOMEM;
+   MMAL_BOOL_T busy;
+   unsigned int i;
+   MMAL_PARAM_UNUSED(name);
+
+   vcos_global_lock();
+   busy = balltrack_instance;
+   balltrack_instance = 1;
+   vcos_global_unlock();
+   if (busy)
+   {
+      LOG_ERROR("only one balltrack component can exist at a time");
+      return MMAL_ENOSPC;
+   }
+
+   /* Allocate the context for our module */
+   component->priv->module = module = vcos_calloc(1, sizeof(*module), "mmal module");
+   if (!module)
+   {
+      vcos_global_lock();
+      balltrack_instance = 0;
+      vcos_global_unlock();
+      return MMAL_ENOMEM;
+   }
+
+   component->priv->pf_destroy = balltrack_component_destroy;
+
+   module->tracker = balltracker_create(&balltrack_backend_cpu);
+   if (!module->tracker)
+      goto error;
+   if (balltracker_init(module->tracker) != 0)
+   {
+      status = MMAL_ENOSYS;
+      goto error;
+   }
+   /* Results only go to the ports, not to the websocket server of raspiballs */
+   analysis_set_debug_fifo(NULL);
+   module->rgba = vcos_malloc(BALLTRACK_WIDTH * BALLTRACK_HEIGHT * 4, "balltrack rgba");
+   if (!module->rgba)
+      goto error;
+
+   /* Allocate and initialise all the ports for this component */
+   component->input = mmal_ports_alloc(component, 1, MMAL_PORT_TYPE_INPUT, sizeof(MMAL_PORT_MODULE_T));
+   if(!component->input)
+      goto error;
+   component->input_num = 1;
+   component->input[0]->priv->pf_enable = balltrack_port_enable;
+   component->input[0]->priv->pf_disable = balltrack_port_disable;
+   component->input[0]->priv->pf_flush = balltrack_port_flush;
+   component->input[0]->priv->pf_send = balltrack_port_send;
+   component->input[0]->priv->pf_send_buffers = balltrack_port_send_buffers;
+   component->input[0]->priv->pf_set_format = balltrack_input_port_format_commit;
+   component->input[0]->priv->pf_parameter_set = balltrack_port_parameter_set;
+   component->input[0]->format->type = MMAL_ES_TYPE_VIDEO;
+   component->input[0]->format->encoding = MMAL_ENCODING_I420;
+   component->input[0]->format->es->video.width = BALLTRACK_WIDTH;
+   component->input[0]->format->es->video.height = BALLTRACK_HEIGHT;
+   component->input[0]->buffer_num_min = 1;
+   component->input[0]->buffer_num_recommended = 0;
+   /* The port queues are only read by the action and by flush, which both
+    * hold the action lock */
+   component->input[0]->priv->module->queue = mmal_queue_create_with_type(MMAL_QUEUE_TYPE_MPSC);
+   if(!component->input[0]->priv->module->queue)
+      goto error;
+
+   /* Output 0 passes the video through, output 1 sends the results */
+   component->output = mmal_ports_alloc(component, 2, MMAL_PORT_TYPE_OUTPUT, sizeof(MMAL_PORT_MODULE_T));
+   if(!component->output)
+      goto error;
+   component->output_num = 2;
+   for (i = 0; i < component->output_num; i++)
+   {
+      component->output[i]->priv->pf_enable = balltrack_port_enable;
+      component->output[i]->priv->pf_disable = balltrack_port_disable;
+      component->output[i]->priv->pf_flush = balltrack_port_flush;
+      component->output[i]->priv->pf_send = balltrack_port_send;
+      component->output[i]->priv->pf_send_buffers = balltrack_port_send_buffers;
+      component->output[i]->priv->pf_set_format = balltrack_output_port_format_commit;
+      component->output[i]->priv->pf_parameter_set = balltrack_port_parameter_set;
+      component->output[i]->buffer_num_min = 1;
+      component->output[i]->priv->module->queue = mmal_queue_create_with_type(MMAL_QUEUE_TYPE_MPSC);
+      if(!component->output[i]->priv->module->queue)
+         goto error;
+   }
+   component->output[0]->buffer_num_recommended = 0;
+   component->output[0]->capabilities = MMAL_PORT_CAPABILITY_PASSTHROUGH;
+   component->output[1]->format->type = MMAL_ES_TYPE_UNKNOWN;
+   component->output[1]->format->encoding = MMAL_ENCODING_METADATA;
+   component->output[1]->buffer_num_recommended = BALLTRACK_RESULTS_BUFFER_NUM;
+   /* The results travel in the metadata of the buffer headers but the core
+    * only takes buffers with a payload */
+   component->output[1]->buffer_size_min = component->output[1]->buffer_size_recommended =
+      sizeof(MMAL_METADATA_BALLTRACK_T);
+
+   status = balltrack_input_port_format_commit(component->input[0]);
+   if (status != MMAL_SUCCESS)
+      goto error;
+
+   status = mmal_component_action_register(component, balltrack_do_processing_loop);
+   if (status != MMAL_SUCCESS)
+      goto error;
+
+   return MMAL_SUCCESS;
+
+ error:
+   balltrack_component_destroy(component);
+   return status;
+}
+
+MMAL_CONSTRUCTOR(mmal_register_component_balltrack);
+void mmal_register_component_balltrack(void)
+{
+   mmal_component_supplier_register("balltrack", mmal_component_create_balltrack);
+}
@@ -173,14 +173,15 @@ static MMAL_STATUS_T copy_port_enable(MMAL_PORT_T *port, MMAL_PORT_BH_CB_T cb)
 static MMAL_STATUS_T copy_port_flush(MMAL_PORT_T *port)
 {
    MMAL_PORT_MODULE_T *port_module = port->priv->module;
-   MMAL_BUFFER_HEADER_T *buffer;
+   MMAL_BUFFER_HEADER_T *buffer, *next;
 
    /* Flush buffers that our component is holding on to */
-   buffer = mmal_queue_get(port_module->queue);
+   buffer = mmal_queue_get_batch(port_module->queue, 0);
    while(buffer)
    {
+      next = buffer->next;
       mmal_port_buffer_header_callback(port, buffer);
-      buffer = mmal_queue_get(port_module->queue);
+      buffer = next;
    }
 
    return MMAL_SUCCESS;
@@ -201,6 +202,14 @@ static MMAL_STATUS_T copy_port_send(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buf
    return MMAL_SUCCESS;
 }
 
+/** Send a chain of buffer headers to a port */
+static MMAL_STATUS_T copy_port_send_buffers(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffers)
+{
+   mmal_queue_put_batch(port->priv->module->queue, buffers);
+   mmal_component_action_trigger(port->component);
+   return MMAL_SUCCESS;
+}
+
 /** Set format on input port */
 static MMAL_STATUS_T copy_input_port_format_commit(MMAL_PORT_T *in)
 {
@@ -287,6 +296,7 @@ static MMAL_STATUS_T mmal_component_create_copy(const char *name, MMAL_COMPONENT
    component->input[0]->priv->pf_disable = copy_port_disable;
    component->input[0]->priv->pf_flush = copy_port_flush;
    component->input[0]->priv->pf_send = copy_port_send;
+   component->input[0]->priv->pf_send_buffers = copy_port_send_buffers;
    component->input[0]->priv->pf_set_format = copy_input_port_format_commit;
    component->input[0]->buffer_num_min = 1;
    component->input[0]->buffer_num_recommended = 0;
@@ -302,6 +312,7 @@ static MMAL_STATUS_T mmal_component_create_copy(const char *name, MMAL_COMPONENT
    component->output[0]->priv->pf_disable = copy_port_disable;
    component->output[0]->priv->pf_flush = copy_port_flush;
    component->output[0]->priv->pf_send = copy_port_send;
+   component->output[0]->priv->pf_send_buffers = copy_port_send_buffers;
    component->output[0]->priv->pf_set_format = copy_output_port_format_commit;
    component->output[0]->buffer_num_min = 1;
    component->output[0]->buffer_num_recommended = 0;
@@ -106,14 +106,15 @@ static MMAL_STATUS_T splitter_port_enable(MMAL_PORT_T *port, MMAL_PORT_BH_CB_T c
 static MMAL_STATUS_T splitter_port_flush(MMAL_PORT_T *port)
 {
    MMAL_PORT_MODULE_T *port_module = port->priv->module;
-   MMAL_BUFFER_HEADER_T *buffer;
+   MMAL_BUFFER_HEADER_T *buffer, *next;
 
    /* Flush buffers that our component is holding on to */
-   buffer = mmal_queue_get(port_module->queue);
+   buffer = mmal_queue_get_batch(port_module->queue, 0);
    while(buffer)
    {
+      next = buffer->next;
       mmal_port_buffer_header_callback(port, buffer);
-      buffer = mmal_queue_get(port_module->queue);
+      buffer = next;
    }
 
    if (port->type == MMAL_PORT_TYPE_INPUT)
@@ -28,10 +28,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "mmal.h"
 #include "mmal_buffer.h"
 #include "core/mmal_buffer_private.h"
+#include "core/mmal_trace_private.h"
 #include "mmal_logging.h"
 
 #define ROUND_UP(s,align) ((((unsigned long)(s)) & ~((align)-1)) + (align))
-#define DEFAULT_COMMAND_SIZE 256 /**< 256 bytes of space for commands */
 #define ALIGN  8
 
 /** Acquire a buffer header */
@@ -51,6 +51,7 @@ void mmal_buffer_header_reset(MMAL_BUFFER_HEADER_T *header)
    header->flags = 0;
    header->pts = MMAL_TIME_UNKNOWN;
    header->dts = MMAL_TIME_UNKNOWN;
+   header->priv->metadata_size = 0;
 }
 
 /** Release a buffer header */
@@ -60,7 +61,9 @@ void mmal_buffer_header_release(MMAL_BUFFER_HEADER_T *header)
    LOG_TRACE("%p (%i)", header, (int)header->priv->refcount-1);
 #endif
 
-   if(--header->priv->refcount != 0)
+   --header->priv->refcount;
+   MMAL_TRACE(MMAL_TRACE_RELEASE, header->priv->owner, NULL, header, (uint32_t)header->priv->refcount);
+   if(header->priv->refcount != 0)
       return;
 
    if (header->priv->pf_pre_release)
@@ -105,6 +108,7 @@ MMAL_STATUS_T mmal_buffer_header_replicate(MMAL_BUFFER_HEADER_T *dest,
    dest->pts        = src->pts;
    dest->dts        = src->dts;
    *dest->type      = *src->type;
+   mmal_buffer_header_metadata_copy(dest, src);
    return MMAL_SUCCESS;
 }
 
@@ -115,8 +119,8 @@ unsigned int mmal_buffer_header_size(MMAL_BUFFER_HEADER_T *header)
 
    header_size = ROUND_UP(sizeof(*header), ALIGN);
    header_size += ROUND_UP(sizeof(*header->type), ALIGN);
-   header_size += ROUND_UP(DEFAULT_COMMAND_SIZE, ALIGN);
    header_size += ROUND_UP(sizeof(*header->priv), ALIGN);
+   header_size += ROUND_UP(MMAL_BUFFER_METADATA_SIZE, ALIGN);
    return header_size;
 }
 
@@ -143,6 +147,21 @@ MMAL_DRIVER_BUFFER_T *mmal_buffer_header_driver_data(MMAL_BUFFER_HEADER_T *heade
    return (MMAL_DRIVER_BUFFER_T *)header->priv->driver_area;
 }
 
+/** Return a pointer to the metadata area of a buffer header */
+uint8_t *mmal_buffer_header_metadata(MMAL_BUFFER_HEADER_T *header)
+{
+   /* The metadata area comes last, after the private area */
+   return (uint8_t *)header + mmal_buffer_header_size(header) - ROUND_UP(MMAL_BUFFER_METADATA_SIZE, ALIGN);
+}
+
+/** Copy the metadata items of a buffer header */
+void mmal_buffer_header_metadata_copy(MMAL_BUFFER_HEADER_T *dest, MMAL_BUFFER_HEADER_T *src)
+{
+   dest->priv->metadata_size = src->priv->metadata_size;
+   if (src->priv->metadata_size)
+      memcpy(mmal_buffer_header_metadata(dest), mmal_buffer_header_metadata(src), src->priv->metadata_size);
+}
+
 /** Return a pointer to a referenced buffer header */
 MMAL_BUFFER_HEADER_T *mmal_buffer_header_reference(MMAL_BUFFER_HEADER_T *header)
 {
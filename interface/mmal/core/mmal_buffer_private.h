@@ -34,6 +34,9 @@ typedef struct MMAL_DRIVER_BUFFER_T MMAL_DRIVER_BUFFER_T;
 /** Size of the private area the framework reserves for the driver / communication layer */
 #define MMAL_DRIVER_BUFFER_SIZE 32
 
+/** Size of the area in the buffer header which holds the metadata items */
+#define MMAL_BUFFER_METADATA_SIZE 256
+
 /** Typedef for the framework's private area in the buffer header */
 typedef struct MMAL_BUFFER_HEADER_PRIVATE_T
 {
@@ -62,6 +65,9 @@ typedef struct MMAL_BUFFER_HEADER_PRIVATE_T
 
    void *component_data;      /**< Field reserved for use by the component */
    void *payload_handle;      /**< Field reserved for mmal_buffer_header_mem_lock */
+   uint32_t metadata_size;    /**< Bytes used by the metadata items in the metadata area */
+   uint32_t port_time;        /**< Time (us) the core sent the buffer header to a port, 0 if it
+                                   didn't, for the latency statistics */
 
    uint8_t driver_area[MMAL_DRIVER_BUFFER_SIZE];
 
@@ -77,6 +83,15 @@ MMAL_BUFFER_HEADER_T *mmal_buffer_header_initialise(void *mem, unsigned int leng
   */
 MMAL_DRIVER_BUFFER_T *mmal_buffer_header_driver_data(MMAL_BUFFER_HEADER_T *);
 
+/** Return a pointer to the area holding the metadata items of a buffer header.
+ * The area is MMAL_BUFFER_METADATA_SIZE bytes long and priv->metadata_size of them
+ * are in use.
+ */
+uint8_t *mmal_buffer_header_metadata(MMAL_BUFFER_HEADER_T *header);
+
+/** Copy the metadata items of a buffer header to another one, replacing its own */
+void mmal_buffer_header_metadata_copy(MMAL_BUFFER_HEADER_T *dest, MMAL_BUFFER_HEADER_T *src);
+
 /** Return a pointer to a referenced buffer header.
  * It is the caller's responsibility to ensure that the reference is still
  * valid when using it.
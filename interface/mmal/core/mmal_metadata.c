@@ -0,0 +1,82 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "mmal.h"
+#include "mmal_metadata.h"
+#include "core/mmal_buffer_private.h"
+
+/* Items are padded so the next one stays 8 bytes aligned, for 64 bits fields */
+#define METADATA_ITEM_SIZE(size) ((sizeof(MMAL_METADATA_T) + (size) + 7) & ~7)
+
+/** Get metadata item from buffer header */
+MMAL_METADATA_T *mmal_metadata_get(MMAL_BUFFER_HEADER_T *header, uint32_t id)
+{
+   uint8_t *data = mmal_buffer_header_metadata(header);
+   uint32_t length = header->priv->metadata_size;
+   uint32_t pos = 0;
+
+   while (pos + sizeof(MMAL_METADATA_T) <= length)
+   {
+      MMAL_METADATA_T *item = (MMAL_METADATA_T *)(data + pos);
+
+      if (item->id == id)
+         return item;
+      pos += METADATA_ITEM_SIZE(item->size);
+   }
+
+   return NULL;
+}
+
+/** Set metadata item in buffer header */
+MMAL_STATUS_T mmal_metadata_set(MMAL_BUFFER_HEADER_T *header, MMAL_METADATA_T *metadata)
+{
+   uint8_t *data = mmal_buffer_header_metadata(header);
+   uint32_t item_size = METADATA_ITEM_SIZE(metadata->size);
+   MMAL_METADATA_T *item = mmal_metadata_get(header, metadata->id);
+
+   if (item && item->size == metadata->size)
+   {
+      memcpy(item, metadata, sizeof(MMAL_METADATA_T) + metadata->size);
+      return MMAL_SUCCESS;
+   }
+
+   if (item)
+   {
+      /* The new item has a different size so the old one goes */
+      uint8_t *next = (uint8_t *)item + METADATA_ITEM_SIZE(item->size);
+      memmove(item, next, data + header->priv->metadata_size - next);
+      header->priv->metadata_size -= next - (uint8_t *)item;
+   }
+
+   if (header->priv->metadata_size + item_size > MMAL_BUFFER_METADATA_SIZE)
+      return MMAL_ENOMEM;
+
+   item = (MMAL_METADATA_T *)(data + header->priv->metadata_size);
+   memcpy(item, metadata, sizeof(MMAL_METADATA_T) + metadata->size);
+   header->priv->metadata_size += item_size;
+   return MMAL_SUCCESS;
+}
@@ -30,6 +30,29 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "core/mmal_buffer_private.h"
 #include "mmal_logging.h"
 
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#define POOL_ARENA_MMAP
+#endif
+
+/** Payload arena of a pool created with mmal_pool_create_arena.
+ * This is the context of the arena allocator, which hands out the
+ * payloads one stride after the other. */
+typedef struct MMAL_POOL_ARENA_T
+{
+   uint32_t flags;      /**< Flags asked for on creation */
+   uint32_t flags_got;  /**< Flags the current mapping actually got */
+   int fd;              /**< memfd of a shared arena, -1 otherwise */
+   MMAL_BOOL_T fd_huge; /**< Whether the memfd is backed by huge pages */
+
+   uint8_t *base;       /**< Start of the mapping */
+   size_t size;         /**< Size of the mapping */
+   uint32_t stride;     /**< Distance between two payloads */
+   size_t offset;       /**< Offset of the next payload to hand out */
+   unsigned int live;   /**< Number of payloads handed out and not freed yet */
+} MMAL_POOL_ARENA_T;
+
 /** Definition of a pool */
 typedef struct MMAL_POOL_PRIVATE_T
 {
@@ -47,11 +70,17 @@ typedef struct MMAL_POOL_PRIVATE_T
 
    unsigned int headers_alloc_num; /**< Number of buffer headers allocated as part of the private structure */
 
+   MMAL_POOL_ARENA_T *arena; /**< Payload arena, NULL unless created with mmal_pool_create_arena */
+
 } MMAL_POOL_PRIVATE_T;
 
 #define ROUND_UP(s,align) ((((unsigned long)(s)) & ~((align)-1)) + (align))
 #define ALIGN  8
 
+#define ARENA_ROUND_UP(s,align) (((s) + (align) - 1) & ~((size_t)(align) - 1))
+/** Size of the huge pages asked for, the usual one on ARM and x86 */
+#define ARENA_HUGE_PAGE_SIZE (2 << 20)
+
 static void mmal_pool_buffer_header_release(MMAL_BUFFER_HEADER_T *header);
 
 static void *mmal_pool_allocator_default_alloc(void *context, uint32_t size)
@@ -66,6 +95,233 @@ static void mmal_pool_allocator_default_free(void *context, void *mem)
    vcos_free(mem);
 }
 
+/*****************************************************************************
+ * Payload arena
+ *****************************************************************************/
+static size_t mmal_pool_arena_page_size(void)
+{
+#ifdef POOL_ARENA_MMAP
+   long size = sysconf(_SC_PAGESIZE);
+   if (size > 0)
+      return (size_t)size;
+#endif
+   return 4096;
+}
+
+static void mmal_pool_arena_unmap(MMAL_POOL_ARENA_T *arena)
+{
+   if (!arena->base)
+      return;
+#ifdef POOL_ARENA_MMAP
+   munmap(arena->base, arena->size);
+#else
+   vcos_free(arena->base);
+#endif
+   arena->base = NULL;
+   arena->size = 0;
+}
+
+#ifdef POOL_ARENA_MMAP
+static void *mmal_pool_arena_map_shared(MMAL_POOL_ARENA_T *arena, size_t *size, MMAL_BOOL_T huge)
+{
+#ifdef MFD_CLOEXEC
+   size_t length = ARENA_ROUND_UP(*size, huge ? ARENA_HUGE_PAGE_SIZE : mmal_pool_arena_page_size());
+   int fd = arena->fd;
+   void *mem = MAP_FAILED;
+
+   if (fd < 0)
+      fd = memfd_create("mmal_pool", MFD_CLOEXEC | (huge ? MFD_HUGETLB : 0));
+   if (fd < 0)
+      return MAP_FAILED;
+
+   if (!ftruncate(fd, length))
+      mem = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (mem == MAP_FAILED)
+   {
+      if (fd != arena->fd)
+         close(fd);
+      return MAP_FAILED;
+   }
+
+   arena->fd = fd;
+   arena->fd_huge = huge;
+   arena->flags_got |= MMAL_POOL_ARENA_SHARED | (huge ? MMAL_POOL_ARENA_HUGE_PAGES : 0);
+   *size = length;
+   return mem;
+#else
+   MMAL_PARAM_UNUSED(arena);
+   MMAL_PARAM_UNUSED(size);
+   MMAL_PARAM_UNUSED(huge);
+   return MAP_FAILED;
+#endif
+}
+
+static void *mmal_pool_arena_map_private(MMAL_POOL_ARENA_T *arena, size_t *size, MMAL_BOOL_T huge)
+{
+   size_t length;
+   void *mem;
+
+#ifdef MAP_HUGETLB
+   if (huge)
+   {
+      length = ARENA_ROUND_UP(*size, ARENA_HUGE_PAGE_SIZE);
+      mem = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (mem != MAP_FAILED)
+      {
+         arena->flags_got |= MMAL_POOL_ARENA_HUGE_PAGES;
+         *size = length;
+         return mem;
+      }
+   }
+#endif
+
+   length = ARENA_ROUND_UP(*size, mmal_pool_arena_page_size());
+   mem = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+   /* No huge pages reserved, transparent ones are the next best thing */
+   if (huge && mem != MAP_FAILED)
+      madvise(mem, length, MADV_HUGEPAGE);
+#endif
+   *size = length;
+   return mem;
+}
+#endif /* POOL_ARENA_MMAP */
+
+static MMAL_STATUS_T mmal_pool_arena_map(MMAL_POOL_ARENA_T *arena, size_t size)
+{
+   MMAL_BOOL_T huge = (arena->flags & MMAL_POOL_ARENA_HUGE_PAGES) && size >= ARENA_HUGE_PAGE_SIZE / 2;
+   void *mem;
+
+   arena->flags_got &= MMAL_POOL_ARENA_PAGE_STRIDE;
+
+#ifdef POOL_ARENA_MMAP
+   mem = MAP_FAILED;
+   if (arena->flags & MMAL_POOL_ARENA_SHARED)
+   {
+      /* A memfd can't switch between normal and huge pages, so a shared
+       * arena keeps what its first mapping got */
+      if (arena->fd >= 0)
+      {
+         mem = mmal_pool_arena_map_shared(arena, &size, arena->fd_huge);
+         if (mem == MAP_FAILED)
+         {
+            LOG_ERROR("failed to map %u bytes of shared arena", (unsigned int)size);
+            return MMAL_ENOMEM;
+         }
+      }
+      else
+      {
+         if (huge)
+            mem = mmal_pool_arena_map_shared(arena, &size, 1);
+         if (mem == MAP_FAILED)
+            mem = mmal_pool_arena_map_shared(arena, &size, 0);
+         if (mem == MAP_FAILED)
+            LOG_INFO("no memfd for the arena, it will not be shared");
+      }
+   }
+   if (mem == MAP_FAILED)
+      mem = mmal_pool_arena_map_private(arena, &size, huge);
+   if (mem == MAP_FAILED)
+      mem = NULL;
+#else
+   MMAL_PARAM_UNUSED(huge);
+   size = ARENA_ROUND_UP(size, mmal_pool_arena_page_size());
+   mem = vcos_malloc_aligned(size, mmal_pool_arena_page_size(), "mmal_pool arena");
+#endif
+
+   if (!mem)
+   {
+      LOG_ERROR("failed to allocate %u bytes of arena", (unsigned int)size);
+      return MMAL_ENOMEM;
+   }
+
+   LOG_TRACE("arena of %u bytes at %p, flags %x", (unsigned int)size, mem, arena->flags_got);
+   arena->base = (uint8_t *)mem;
+   arena->size = size;
+   return MMAL_SUCCESS;
+}
+
+/** Make room in the arena for the payloads of a pool.
+ * All the payloads of the previous size have to be freed by now. */
+static MMAL_STATUS_T mmal_pool_arena_reserve(MMAL_POOL_ARENA_T *arena, unsigned int headers, uint32_t payload_size)
+{
+   size_t align = (arena->flags & MMAL_POOL_ARENA_PAGE_STRIDE) ?
+      mmal_pool_arena_page_size() : MMAL_POOL_ARENA_ALIGN;
+   size_t size;
+
+   if (arena->live)
+   {
+      LOG_ERROR("%u payloads of the arena still allocated", arena->live);
+      return MMAL_EINVAL;
+   }
+
+   arena->offset = 0;
+   arena->stride = payload_size ? ARENA_ROUND_UP(payload_size, align) : 0;
+   size = (size_t)arena->stride * headers;
+   if (arena->stride && size / arena->stride != headers)
+      return MMAL_ENOMEM;
+
+   /* Keep the mapping as long as the payloads fit and use at least half of it.
+    * A memfd never shrinks, a peer which mapped it would fault past the new end. */
+   if (arena->base && size <= arena->size &&
+       (size > arena->size / 2 || (arena->flags_got & MMAL_POOL_ARENA_SHARED)))
+      return MMAL_SUCCESS;
+
+   mmal_pool_arena_unmap(arena);
+   if (!size)
+      return MMAL_SUCCESS;
+   return mmal_pool_arena_map(arena, size);
+}
+
+static MMAL_POOL_ARENA_T *mmal_pool_arena_create(uint32_t flags)
+{
+   MMAL_POOL_ARENA_T *arena = vcos_calloc(1, sizeof(*arena), "mmal_pool arena");
+   if (!arena)
+      return NULL;
+   arena->flags = flags;
+   arena->flags_got = flags & MMAL_POOL_ARENA_PAGE_STRIDE;
+   arena->fd = -1;
+   return arena;
+}
+
+static void mmal_pool_arena_destroy(MMAL_POOL_ARENA_T *arena)
+{
+   mmal_pool_arena_unmap(arena);
+#ifdef POOL_ARENA_MMAP
+   if (arena->fd >= 0)
+      close(arena->fd);
+#endif
+   vcos_free(arena);
+}
+
+static void *mmal_pool_arena_alloc(void *context, uint32_t size)
+{
+   MMAL_POOL_ARENA_T *arena = (MMAL_POOL_ARENA_T *)context;
+   uint8_t *mem;
+
+   if (size > arena->stride || arena->offset + arena->stride > arena->size)
+   {
+      LOG_ERROR("no room for %u bytes in the arena (%u/%u used)", size,
+                (unsigned int)arena->offset, (unsigned int)arena->size);
+      return NULL;
+   }
+
+   mem = arena->base + arena->offset;
+   arena->offset += arena->stride;
+   arena->live++;
+   return mem;
+}
+
+static void mmal_pool_arena_free(void *context, void *mem)
+{
+   MMAL_POOL_ARENA_T *arena = (MMAL_POOL_ARENA_T *)context;
+   MMAL_PARAM_UNUSED(mem);
+
+   /* Payloads only ever go away all together, on resize or destroy */
+   if (arena->live && !--arena->live)
+      arena->offset = 0;
+}
+
 static MMAL_STATUS_T mmal_pool_initialise_buffer_headers(MMAL_POOL_T *pool, unsigned int headers,
                                                          MMAL_BOOL_T reinitialise)
 {
@@ -191,6 +447,37 @@ MMAL_POOL_T *mmal_pool_create_with_allocator(unsigned int headers, uint32_t payl
    return pool;
 }
 
+/** Create a pool of MMAL_BUFFER_HEADER_T with its payloads in one arena */
+MMAL_POOL_T *mmal_pool_create_arena(unsigned int headers, uint32_t payload_size, uint32_t flags)
+{
+   MMAL_POOL_ARENA_T *arena;
+   MMAL_POOL_T *pool;
+
+   arena = mmal_pool_arena_create(flags);
+   if (!arena)
+   {
+      LOG_ERROR("failed to allocate arena");
+      return NULL;
+   }
+
+   if (mmal_pool_arena_reserve(arena, headers, payload_size) != MMAL_SUCCESS)
+   {
+      mmal_pool_arena_destroy(arena);
+      return NULL;
+   }
+
+   pool = mmal_pool_create_with_allocator(headers, payload_size, arena,
+             mmal_pool_arena_alloc, mmal_pool_arena_free);
+   if (!pool)
+   {
+      mmal_pool_arena_destroy(arena);
+      return NULL;
+   }
+
+   ((MMAL_POOL_PRIVATE_T *)pool)->arena = arena;
+   return pool;
+}
+
 /** Destroy a pool of MMAL_BUFFER_HEADER_T */
 void mmal_pool_destroy(MMAL_POOL_T *pool)
 {
@@ -212,6 +499,9 @@ void mmal_pool_destroy(MMAL_POOL_T *pool)
    if (pool->header)
       vcos_free(pool->header);
 
+   if (((MMAL_POOL_PRIVATE_T *)pool)->arena)
+      mmal_pool_arena_destroy(((MMAL_POOL_PRIVATE_T *)pool)->arena);
+
    if(pool->queue) mmal_queue_destroy(pool->queue);
    vcos_free(pool);
 }
@@ -252,6 +542,10 @@ MMAL_STATUS_T mmal_pool_resize(MMAL_POOL_T *pool, unsigned int headers, uint32_t
       private->headers_alloc_num = headers;
    }
 
+   /* Make room for the new payloads in the arena, the old ones are all gone */
+   if (private->arena && mmal_pool_arena_reserve(private->arena, headers, payload_size) != MMAL_SUCCESS)
+      return MMAL_ENOMEM;
+
    /* Allocate the new payloads */
    private->payload_size = payload_size;
    mmal_pool_initialise_buffer_headers(pool, headers, 1);
@@ -263,6 +557,38 @@ MMAL_STATUS_T mmal_pool_resize(MMAL_POOL_T *pool, unsigned int headers, uint32_t
    return MMAL_SUCCESS;
 }
 
+/** Get the statistics of a pool */
+MMAL_STATUS_T mmal_pool_get_stats(MMAL_POOL_T *pool, MMAL_POOL_STATS_T *stats)
+{
+   MMAL_POOL_PRIVATE_T *private = (MMAL_POOL_PRIVATE_T *)pool;
+   MMAL_POOL_ARENA_T *arena;
+   unsigned int queued;
+
+   if (!pool || !stats)
+      return MMAL_EINVAL;
+
+   memset(stats, 0, sizeof(*stats));
+   queued = mmal_queue_length(pool->queue);
+   stats->headers_num = pool->headers_num;
+   stats->headers_in_use = pool->headers_num > queued ? pool->headers_num - queued : 0;
+   stats->payload_size = private->payload_size;
+   stats->bytes_allocated = (uint64_t)stats->headers_num * private->payload_size;
+   stats->bytes_in_use = (uint64_t)stats->headers_in_use * private->payload_size;
+   stats->arena_fd = -1;
+
+   arena = private->arena;
+   if (!arena)
+      return MMAL_SUCCESS;
+
+   stats->payload_stride = arena->stride;
+   stats->arena_flags = arena->flags_got;
+   stats->arena_fd = arena->fd;
+   stats->arena_base = arena->base;
+   stats->arena_size = arena->size;
+   stats->bytes_wasted = arena->size - stats->bytes_allocated;
+   return MMAL_SUCCESS;
+}
+
 /** Buffer header release callback.
  * Call out to a further client callback and put the buffer back in the queue
  * so it can be reused, unless the client callback prevents it. */
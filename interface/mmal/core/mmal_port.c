@@ -29,6 +29,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "util/mmal_util.h"
 #include "core/mmal_component_private.h"
 #include "core/mmal_port_private.h"
+#include "core/mmal_buffer_private.h"
+#include "core/mmal_trace_private.h"
 #include "interface/vcos/vcos.h"
 #include "mmal_logging.h"
 #include "interface/mmal/util/mmal_util.h"
@@ -39,8 +41,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "vcfw/rtos/common/rtos_common_mem.h" /* mem_alloc */
 #endif
 
-/** Only collect port stats if enabled in build. Performance could be
- * affected on an ARM since gettimeofday() involves a system call.
+/** Only collect TX port stats by default if enabled in build. Performance could
+ * be affected on an ARM since gettimeofday() involves a system call. Clients can
+ * still turn them on per port with MMAL_PARAMETER_CORE_LATENCY_TX.
  */
 #if defined(MMAL_COLLECT_PORT_STATS)
 # define MMAL_COLLECT_PORT_STATS_ENABLED 1
@@ -48,6 +51,40 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 # define MMAL_COLLECT_PORT_STATS_ENABLED 0
 #endif
 
+/** Port statistics are updated from the threads sending buffers and from the
+ * threads of the components sending them back, and read by anyone, without a
+ * lock. Each counter is updated atomically but a read is not a snapshot of all
+ * of them, which is fine for statistics.
+ */
+#if defined(__ATOMIC_RELAXED)
+# define STATS_ADD(a,v) __atomic_fetch_add(&(a), (v), __ATOMIC_RELAXED)
+# define STATS_SUB(a,v) __atomic_fetch_sub(&(a), (v), __ATOMIC_RELAXED)
+# define STATS_STORE(a,v) __atomic_store_n(&(a), (v), __ATOMIC_RELAXED)
+# define STATS_XCHG(a,v) __atomic_exchange_n(&(a), (v), __ATOMIC_RELAXED)
+# define STATS_LOAD(a) __atomic_load_n(&(a), __ATOMIC_RELAXED)
+# define STATS_CAS(a,o,v) __atomic_compare_exchange_n(&(a), &(o), (v), 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#else
+# define STATS_ADD(a,v) ((a) += (v))
+# define STATS_SUB(a,v) ((a) -= (v))
+# define STATS_STORE(a,v) ((a) = (v))
+# define STATS_XCHG(a,v) mmal_port_stats_xchg(&(a), (v))
+# define STATS_LOAD(a) (a)
+# define STATS_CAS(a,o,v) ((a) == (o) ? ((a) = (v), 1) : ((o) = (a), 0))
+static uint32_t mmal_port_stats_xchg(uint32_t *a, uint32_t v)
+{
+   uint32_t old = *a;
+   *a = v;
+   return old;
+}
+#endif
+
+/** Statistics of one direction of a port */
+typedef struct MMAL_PORT_STATS_T
+{
+   MMAL_CORE_LATENCY_T latency;
+   uint32_t max_delay; /**< Longest time between buffers, for MMAL_PARAMETER_CORE_STATISTICS */
+} MMAL_PORT_STATS_T;
+
 static MMAL_STATUS_T mmal_port_private_parameter_get(MMAL_PORT_T *port,
                                                      MMAL_PARAMETER_HEADER_T *param);
 
@@ -62,7 +99,6 @@ typedef struct MMAL_PORT_PRIVATE_CORE_T
 {
    VCOS_MUTEX_T lock; /**< Used to lock access to the port */
    VCOS_MUTEX_T send_lock; /**< Used to lock access while sending buffer to the port */
-   VCOS_MUTEX_T stats_lock; /**< Used to lock access to the stats */
    VCOS_MUTEX_T connection_lock; /**< Used to lock access to a connection */
 
    /** Callback set by client to call when buffer headers need to be returned */
@@ -92,8 +128,10 @@ typedef struct MMAL_PORT_PRIVATE_CORE_T
    /** Queue for buffers received from the client when in paused state */
    MMAL_BUFFER_HEADER_T** queue_last;
 
-   /** Per-port statistics collected directly by the MMAL core */
-   MMAL_CORE_PORT_STATISTICS_T stats;
+   /** Per-port statistics collected directly by the MMAL core, indexed by MMAL_CORE_STATS_DIR */
+   MMAL_PORT_STATS_T stats[2];
+   /** Collect the MMAL_CORE_STATS_TX statistics, see MMAL_PARAMETER_CORE_LATENCY_TX */
+   MMAL_BOOL_T stats_tx;
 
    char *name; /**< Port name */
    unsigned int name_size; /** Size of the memory area reserved for the name string */
@@ -116,7 +154,10 @@ static void mmal_port_connected_output_cb(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_
 static MMAL_BOOL_T mmal_port_connected_pool_cb(MMAL_POOL_T *pool, MMAL_BUFFER_HEADER_T *buffer, void *userdata);
 
 static void mmal_port_name_update(MMAL_PORT_T *port);
-static void mmal_port_update_port_stats(MMAL_PORT_T *port, MMAL_CORE_STATS_DIR direction);
+static uint32_t mmal_port_stats_time(void);
+static unsigned int mmal_port_stats_bucket(uint32_t us);
+static void mmal_port_update_port_stats(MMAL_PORT_T *port, MMAL_CORE_STATS_DIR direction,
+   uint32_t now, unsigned int count, uint32_t bytes);
 
 /*****************************************************************************/
 
@@ -144,6 +185,17 @@ static void mmal_port_update_port_stats(MMAL_PORT_T *port, MMAL_CORE_STATS_DIR d
    if (!--(a)->priv->core->transit_buffer_headers) \
       vcos_semaphore_post(&(a)->priv->core->transit_sema); \
    vcos_mutex_unlock(&(a)->priv->core->transit_lock)
+#define IN_TRANSIT_ADD(a,n) \
+   vcos_mutex_lock(&(a)->priv->core->transit_lock); \
+   if (!(a)->priv->core->transit_buffer_headers) \
+      vcos_semaphore_wait(&(a)->priv->core->transit_sema); \
+   (a)->priv->core->transit_buffer_headers += (n); \
+   vcos_mutex_unlock(&(a)->priv->core->transit_lock)
+#define IN_TRANSIT_SUB(a,n) \
+   vcos_mutex_lock(&(a)->priv->core->transit_lock); \
+   if (!((a)->priv->core->transit_buffer_headers -= (n))) \
+      vcos_semaphore_post(&(a)->priv->core->transit_sema); \
+   vcos_mutex_unlock(&(a)->priv->core->transit_lock)
 #define IN_TRANSIT_WAIT(a) \
    vcos_semaphore_wait(&(a)->priv->core->transit_sema); \
    vcos_semaphore_post(&(a)->priv->core->transit_sema)
@@ -163,7 +215,7 @@ MMAL_PORT_T *mmal_port_alloc(MMAL_COMPONENT_T *component, MMAL_PORT_TYPE_T type,
    unsigned int size = sizeof(*port) + sizeof(MMAL_PORT_PRIVATE_T) +
       sizeof(MMAL_PORT_PRIVATE_CORE_T) + name_size + extra_size;
    MMAL_BOOL_T lock = 0, lock_send = 0, lock_transit = 0, sema_transit = 0;
-   MMAL_BOOL_T lock_stats = 0, lock_connection = 0;
+   MMAL_BOOL_T lock_connection = 0;
 
    LOG_TRACE("component:%s type:%u extra:%u", component->name, type, extra_size);
 
@@ -191,13 +243,12 @@ MMAL_PORT_T *mmal_port_alloc(MMAL_COMPONENT_T *component, MMAL_PORT_TYPE_T type,
    lock_send = vcos_mutex_create(&port->priv->core->send_lock, "mmal port send lock") == VCOS_SUCCESS;
    lock_transit = vcos_mutex_create(&port->priv->core->transit_lock, "mmal port transit lock") == VCOS_SUCCESS;
    sema_transit = vcos_semaphore_create(&port->priv->core->transit_sema, "mmal port transit sema", 1) == VCOS_SUCCESS;
-   lock_stats = vcos_mutex_create(&port->priv->core->stats_lock, "mmal stats lock") == VCOS_SUCCESS;
    lock_connection = vcos_mutex_create(&port->priv->core->connection_lock, "mmal connection lock") == VCOS_SUCCESS;
 
-   if (!lock || !lock_send || !lock_transit || !sema_transit || !lock_stats || !lock_connection)
+   if (!lock || !lock_send || !lock_transit || !sema_transit || !lock_connection)
    {
-      LOG_ERROR("%s: failed to create sync objects (%u,%u,%u,%u,%u,%u)",
-            port->name, lock, lock_send, lock_transit, sema_transit, lock_stats, lock_connection);
+      LOG_ERROR("%s: failed to create sync objects (%u,%u,%u,%u,%u)",
+            port->name, lock, lock_send, lock_transit, sema_transit, lock_connection);
       goto error;
    }
 
@@ -208,6 +259,7 @@ MMAL_PORT_T *mmal_port_alloc(MMAL_COMPONENT_T *component, MMAL_PORT_TYPE_T type,
       goto error;
    }
    port->priv->core->format_ptr_copy = port->format;
+   port->priv->core->stats_tx = MMAL_COLLECT_PORT_STATS_ENABLED;
 
    LOG_TRACE("%s: created at %p", port->name, port);
    return port;
@@ -217,7 +269,6 @@ MMAL_PORT_T *mmal_port_alloc(MMAL_COMPONENT_T *component, MMAL_PORT_TYPE_T type,
    if (lock_send) vcos_mutex_delete(&port->priv->core->send_lock);
    if (lock_transit) vcos_mutex_delete(&port->priv->core->transit_lock);
    if (sema_transit) vcos_semaphore_delete(&port->priv->core->transit_sema);
-   if (lock_stats) vcos_mutex_delete(&port->priv->core->stats_lock);
    if (lock_connection) vcos_mutex_delete(&port->priv->core->connection_lock);
    if (port->format) mmal_format_free(port->format);
    vcos_free(port);
@@ -235,7 +286,6 @@ void mmal_port_free(MMAL_PORT_T *port)
    vcos_assert(port->format == port->priv->core->format_ptr_copy);
    mmal_format_free(port->priv->core->format_ptr_copy);
    vcos_mutex_delete(&port->priv->core->connection_lock);
-   vcos_mutex_delete(&port->priv->core->stats_lock);
    vcos_semaphore_delete(&port->priv->core->transit_sema);
    vcos_mutex_delete(&port->priv->core->transit_lock);
    vcos_mutex_delete(&port->priv->core->send_lock);
@@ -710,6 +760,7 @@ MMAL_STATUS_T mmal_port_send_buffer(MMAL_PORT_T *port,
    MMAL_BUFFER_HEADER_T *buffer)
 {
    MMAL_STATUS_T status = MMAL_SUCCESS;
+   uint32_t now, length;
 
    if (!port || !port->priv)
    {
@@ -747,6 +798,13 @@ MMAL_STATUS_T mmal_port_send_buffer(MMAL_PORT_T *port,
       buffer->length = 0;
    }
 
+   /* The buffer can come back before pf_send returns, so take what the stats
+    * need from it now */
+   now = mmal_port_stats_time();
+   buffer->priv->port_time = now;
+   length = buffer->length;
+   MMAL_TRACE(MMAL_TRACE_SEND_BEGIN, port, port->name, buffer, 0);
+
    /* coverity[lock] transit_sema is used for signalling, and is not a lock */
    /* coverity[lock_order] since transit_sema is not a lock, there is no ordering conflict */
    IN_TRANSIT_INCREMENT(port);
@@ -763,6 +821,7 @@ MMAL_STATUS_T mmal_port_send_buffer(MMAL_PORT_T *port,
       /* Send buffer to component */
       status = port->priv->pf_send(port, buffer);
    }
+   MMAL_TRACE(MMAL_TRACE_SEND_END, port, NULL, NULL, status);
 
    if (status != MMAL_SUCCESS)
    {
@@ -771,13 +830,123 @@ MMAL_STATUS_T mmal_port_send_buffer(MMAL_PORT_T *port,
    }
    else
    {
-      mmal_port_update_port_stats(port, MMAL_CORE_STATS_RX);
+      mmal_port_update_port_stats(port, MMAL_CORE_STATS_RX, now, 1, length);
    }
 
    UNLOCK_SENDING(port);
    return status;
 }
 
+/** Send a chain of buffer headers to a port */
+MMAL_STATUS_T mmal_port_send_buffers(MMAL_PORT_T *port,
+   MMAL_BUFFER_HEADER_T **buffers)
+{
+   MMAL_STATUS_T status = MMAL_SUCCESS;
+   MMAL_BUFFER_HEADER_T *buffer, *next;
+   unsigned int count = 0, sent = 0, i;
+   uint32_t now, length, bytes = 0, sent_bytes = 0;
+   MMAL_BOOL_T trace;
+
+   if (!port || !port->priv || !buffers)
+   {
+      LOG_ERROR("invalid port");
+      return MMAL_EINVAL;
+   }
+
+   if (!*buffers)
+      return MMAL_SUCCESS;
+
+   /* Check the whole chain first so none is sent if one is invalid */
+   for (buffer = *buffers; buffer; buffer = buffer->next, count++)
+   {
+      if (!buffer->data && !(port->capabilities & MMAL_PORT_CAPABILITY_PASSTHROUGH))
+      {
+         LOG_ERROR("%s(%p) received invalid buffer header", port->name, port);
+         return MMAL_EINVAL;
+      }
+   }
+
+   LOG_TRACE("%s(%i:%i) port %p, %u buffers from %p", port->component->name,
+             (int)port->type, (int)port->index, port, count, *buffers);
+
+   if (!port->priv->pf_send)
+      return MMAL_ENOSYS;
+
+   LOCK_SENDING(port);
+
+   if (!port->is_enabled)
+   {
+      UNLOCK_SENDING(port);
+      return MMAL_EINVAL;
+   }
+
+   now = mmal_port_stats_time();
+   trace = !!MMAL_TRACE_ACTIVE(MMAL_TRACE_SEND_BEGIN);
+   for (buffer = *buffers, i = 0; buffer; buffer = buffer->next, i++)
+   {
+      if (port->type == MMAL_PORT_TYPE_OUTPUT)
+         buffer->length = 0;
+      buffer->priv->port_time = now;
+      bytes += buffer->length;
+      if (trace)
+         mmal_trace_record(MMAL_TRACE_SEND_BEGIN, port, port->name, buffer, 0, i);
+   }
+
+   /* coverity[lock] transit_sema is used for signalling, and is not a lock */
+   IN_TRANSIT_ADD(port, count);
+
+   if (port->priv->core->is_paused)
+   {
+      /* Add the buffers to our internal queue */
+      *port->priv->core->queue_last = *buffers;
+      for (buffer = *buffers; buffer->next; buffer = buffer->next);
+      port->priv->core->queue_last = &buffer->next;
+      *buffers = NULL;
+      sent = count;
+      sent_bytes = bytes;
+   }
+   else if (port->priv->pf_send_buffers)
+   {
+      status = port->priv->pf_send_buffers(port, *buffers);
+      if (status == MMAL_SUCCESS)
+      {
+         *buffers = NULL;
+         sent = count;
+         sent_bytes = bytes;
+      }
+   }
+   else
+   {
+      for (buffer = *buffers; buffer; buffer = next)
+      {
+         next = buffer->next;
+         length = buffer->length;
+         status = port->priv->pf_send(port, buffer);
+         if (status != MMAL_SUCCESS)
+         {
+            buffer->next = next;
+            break;
+         }
+         sent++;
+         sent_bytes += length;
+      }
+      *buffers = buffer;
+   }
+   MMAL_TRACE(MMAL_TRACE_SEND_END, port, NULL, NULL, status);
+
+   if (status != MMAL_SUCCESS)
+   {
+      IN_TRANSIT_SUB(port, count - sent);
+      LOG_ERROR("%s: send failed after %u of %u buffers: %s", port->name, sent, count,
+                mmal_status_to_string(status));
+   }
+   if (sent)
+      mmal_port_update_port_stats(port, MMAL_CORE_STATS_RX, now, sent, sent_bytes);
+
+   UNLOCK_SENDING(port);
+   return status;
+}
+
 /** Flush a port */
 MMAL_STATUS_T mmal_port_flush(MMAL_PORT_T *port)
 {
@@ -851,6 +1020,10 @@ MMAL_STATUS_T mmal_port_parameter_set(MMAL_PORT_T *port,
              (int)port->type, (int)port->index, port,
              param, param ? param->id : 0, param ? (int)param->size : 0);
 
+   /* Only the host core knows this one, and it needs no lock */
+   if (param->id == MMAL_PARAMETER_CORE_LATENCY_TX)
+      return mmal_port_private_parameter_set(port, param);
+
    LOCK_PORT(port);
    if (port->priv->pf_parameter_set)
       status = port->priv->pf_parameter_set(port, param);
@@ -879,6 +1052,10 @@ MMAL_STATUS_T mmal_port_parameter_get(MMAL_PORT_T *port,
    if (!param)
       return MMAL_EINVAL;
 
+   /* Only the host core knows this one, and it needs no lock */
+   if (param->id == MMAL_PARAMETER_CORE_LATENCY)
+      return mmal_port_private_parameter_get(port, param);
+
    LOCK_PORT(port);
    if (port->priv->pf_parameter_get)
       status = port->priv->pf_parameter_get(port, param);
@@ -895,6 +1072,8 @@ MMAL_STATUS_T mmal_port_parameter_get(MMAL_PORT_T *port,
 /** Buffer header callback. */
 void mmal_port_buffer_header_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
 {
+   uint32_t now;
+
 #ifdef ENABLE_MMAL_EXTRA_LOGGING
    LOG_TRACE("%s(%i:%i) port %p, buffer %p (%i,%p,%i,%i)",
              port->component->name, (int)port->type, (int)port->index, port, buffer,
@@ -905,12 +1084,19 @@ void mmal_port_buffer_header_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *b
    if (!vcos_verify(IN_TRANSIT_COUNT(port) >= 0))
       LOG_ERROR("%s: buffer headers in transit < 0 (%d)", port->name, (int)IN_TRANSIT_COUNT(port));
 
-   if (MMAL_COLLECT_PORT_STATS_ENABLED)
+   if (STATS_LOAD(port->priv->core->stats_tx))
    {
-      mmal_port_update_port_stats(port, MMAL_CORE_STATS_TX);
+      now = mmal_port_stats_time();
+      if (buffer->priv->port_time)
+         STATS_ADD(port->priv->core->stats[MMAL_CORE_STATS_TX].latency.latency[
+            mmal_port_stats_bucket(now - buffer->priv->port_time)], 1);
+      mmal_port_update_port_stats(port, MMAL_CORE_STATS_TX, now, 1, buffer->length);
    }
+   buffer->priv->port_time = 0;
 
+   MMAL_TRACE(MMAL_TRACE_CALLBACK_BEGIN, port, port->name, buffer, buffer->cmd);
    port->priv->core->buffer_header_callback(port, buffer);
+   MMAL_TRACE(MMAL_TRACE_CALLBACK_END, port, NULL, NULL, 0);
 
    IN_TRANSIT_DECREMENT(port);
 }
@@ -920,7 +1106,9 @@ void mmal_port_event_send(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
 {
    if (port->priv->core->buffer_header_callback)
    {
+      MMAL_TRACE(MMAL_TRACE_CALLBACK_BEGIN, port, port->name, buffer, buffer->cmd);
       port->priv->core->buffer_header_callback(port, buffer);
+      MMAL_TRACE(MMAL_TRACE_CALLBACK_END, port, NULL, NULL, 0);
    }
    else
    {
@@ -1236,9 +1424,9 @@ static MMAL_STATUS_T mmal_port_populate_clock_ports(MMAL_PORT_T* output, MMAL_PO
 /** Populate an output port with a pool of buffers */
 static MMAL_STATUS_T mmal_port_populate_from_pool(MMAL_PORT_T* port, MMAL_POOL_T* pool)
 {
-   MMAL_STATUS_T status = MMAL_SUCCESS;
+   MMAL_STATUS_T status = MMAL_SUCCESS, send_status;
    uint32_t buffer_idx;
-   MMAL_BUFFER_HEADER_T *buffer;
+   MMAL_BUFFER_HEADER_T *buffer, *buffers;
 
    if (!port->priv->pf_send)
       return MMAL_ENOSYS;
@@ -1246,23 +1434,27 @@ static MMAL_STATUS_T mmal_port_populate_from_pool(MMAL_PORT_T* port, MMAL_POOL_T
    LOG_TRACE("%s port %p, pool: %p", port->name, port, pool);
 
    /* Populate port from pool */
-   for (buffer_idx = 0; buffer_idx < port->buffer_num; buffer_idx++)
+   buffers = mmal_queue_get_batch(pool->queue, port->buffer_num);
+   for (buffer = buffers, buffer_idx = 0; buffer; buffer = buffer->next)
+      buffer_idx++;
+   if (buffer_idx < port->buffer_num)
    {
-      buffer = mmal_queue_get(pool->queue);
-      if (!buffer)
-      {
-         LOG_ERROR("too few buffers in the pool");
-         status = MMAL_ENOMEM;
-         break;
-      }
+      LOG_ERROR("too few buffers in the pool");
+      status = MMAL_ENOMEM;
+   }
 
-      status = mmal_port_send_buffer(port, buffer);
-      if (status != MMAL_SUCCESS)
-      {
-         LOG_ERROR("failed to send buffer to port");
-         mmal_buffer_header_release(buffer);
-         break;
-      }
+   send_status = mmal_port_send_buffers(port, &buffers);
+   if (send_status != MMAL_SUCCESS)
+   {
+      LOG_ERROR("failed to send buffer to port");
+      status = send_status;
+   }
+
+   /* Give back what the port didn't take */
+   for (buffer = buffers; buffer; buffer = buffers)
+   {
+      buffers = buffer->next;
+      mmal_buffer_header_release(buffer);
    }
 
    return status;
@@ -1391,50 +1583,121 @@ static MMAL_STATUS_T mmal_port_get_core_stats(MMAL_PORT_T *port, MMAL_PARAMETER_
 {
    MMAL_PARAMETER_CORE_STATISTICS_T *stats_param = (MMAL_PARAMETER_CORE_STATISTICS_T*)param;
    MMAL_CORE_STATISTICS_T *stats = &stats_param->stats;
-   MMAL_CORE_STATISTICS_T *src_stats;
-   MMAL_PORT_PRIVATE_CORE_T *core = port->priv->core;
-   vcos_mutex_lock(&core->stats_lock);
-   switch (stats_param->dir)
-   {
-   case MMAL_CORE_STATS_RX:
-      src_stats = &port->priv->core->stats.rx;
-      break;
-   default:
-      src_stats = &port->priv->core->stats.tx;
-      break;
-   }
-   *stats = *src_stats;
+   MMAL_PORT_STATS_T *src_stats;
+
+   src_stats = &port->priv->core->stats[stats_param->dir == MMAL_CORE_STATS_RX ?
+      MMAL_CORE_STATS_RX : MMAL_CORE_STATS_TX];
+   stats->buffer_count = STATS_LOAD(src_stats->latency.buffer_count);
+   stats->first_buffer_time = STATS_LOAD(src_stats->latency.first_buffer_time);
+   stats->last_buffer_time = STATS_LOAD(src_stats->latency.last_buffer_time);
+   stats->max_delay = STATS_LOAD(src_stats->max_delay);
    if (stats_param->reset)
-      memset(src_stats, 0, sizeof(*src_stats));
-   vcos_mutex_unlock(&core->stats_lock);
+   {
+      STATS_SUB(src_stats->latency.buffer_count, stats->buffer_count);
+      STATS_STORE(src_stats->latency.first_buffer_time, 0);
+      STATS_STORE(src_stats->latency.last_buffer_time, 0);
+      STATS_STORE(src_stats->max_delay, 0);
+   }
    return MMAL_SUCCESS;
 }
 
-/** Update the port stats, called per buffer.
- *
- */
-static void mmal_port_update_port_stats(MMAL_PORT_T *port, MMAL_CORE_STATS_DIR direction)
+static MMAL_STATUS_T mmal_port_get_core_latency(MMAL_PORT_T *port, MMAL_PARAMETER_HEADER_T *param)
 {
-   MMAL_PORT_PRIVATE_CORE_T *core = port->priv->core;
-   MMAL_CORE_STATISTICS_T *stats;
-   unsigned stc = vcos_getmicrosecs();
+   MMAL_PARAMETER_CORE_LATENCY_T *stats_param = (MMAL_PARAMETER_CORE_LATENCY_T*)param;
+   MMAL_CORE_LATENCY_T *stats = &stats_param->stats;
+   MMAL_CORE_LATENCY_T *src_stats;
+   unsigned int i;
 
-   vcos_mutex_lock(&core->stats_lock);
+   if (param->size < sizeof(*stats_param))
+      return MMAL_EINVAL;
 
-   stats = direction == MMAL_CORE_STATS_RX ? &core->stats.rx : &core->stats.tx;
+   src_stats = &port->priv->core->stats[stats_param->dir == MMAL_CORE_STATS_RX ?
+      MMAL_CORE_STATS_RX : MMAL_CORE_STATS_TX].latency;
+   stats->buffer_count = STATS_LOAD(src_stats->buffer_count);
+   stats->first_buffer_time = STATS_LOAD(src_stats->first_buffer_time);
+   stats->last_buffer_time = STATS_LOAD(src_stats->last_buffer_time);
+   stats->in_transit_max = STATS_LOAD(src_stats->in_transit_max);
+   stats->bytes = STATS_LOAD(src_stats->bytes);
+   for (i = 0; i < MMAL_CORE_LATENCY_BUCKETS; i++)
+   {
+      stats->interval[i] = STATS_LOAD(src_stats->interval[i]);
+      stats->latency[i] = STATS_LOAD(src_stats->latency[i]);
+   }
+   if (!stats_param->reset)
+      return MMAL_SUCCESS;
 
-   stats->buffer_count++;
+   /* Take away what was read rather than zeroing the counters, so buffers
+    * counted in the meantime are not lost */
+   STATS_SUB(src_stats->buffer_count, stats->buffer_count);
+   STATS_SUB(src_stats->bytes, stats->bytes);
+   for (i = 0; i < MMAL_CORE_LATENCY_BUCKETS; i++)
+   {
+      STATS_SUB(src_stats->interval[i], stats->interval[i]);
+      STATS_SUB(src_stats->latency[i], stats->latency[i]);
+   }
+   STATS_STORE(src_stats->first_buffer_time, 0);
+   STATS_STORE(src_stats->last_buffer_time, 0);
+   STATS_STORE(src_stats->in_transit_max, 0);
+   return MMAL_SUCCESS;
+}
 
-   if (!stats->first_buffer_time)
+/** Time for the port stats, in us. Never 0, which means no time. */
+static uint32_t mmal_port_stats_time(void)
+{
+   uint32_t now = vcos_getmicrosecs();
+   return now ? now : 1;
+}
+
+/** Histogram bucket of a time, see MMAL_CORE_LATENCY_SUB_BITS */
+static unsigned int mmal_port_stats_bucket(uint32_t us)
+{
+   unsigned int log2 = MMAL_CORE_LATENCY_SUB_BITS, bucket;
+
+   if (us < (1u << MMAL_CORE_LATENCY_SUB_BITS))
+      return us;
+   while (us >> (log2 + 1))
+      log2++;
+   bucket = ((log2 - MMAL_CORE_LATENCY_SUB_BITS + 1) << MMAL_CORE_LATENCY_SUB_BITS) +
+      ((us >> (log2 - MMAL_CORE_LATENCY_SUB_BITS)) & ((1u << MMAL_CORE_LATENCY_SUB_BITS) - 1));
+   return vcos_min(bucket, MMAL_CORE_LATENCY_BUCKETS - 1);
+}
+
+/** Raise a statistic to at least a value */
+static void mmal_port_stats_max(uint32_t *stat, uint32_t value)
+{
+   uint32_t old = STATS_LOAD(*stat);
+
+   while (old < value && !STATS_CAS(*stat, old, value))
+      continue;
+}
+
+/** Update the port stats, called per buffer or per chain of buffers sent at once.
+ * Only the first buffer of a chain has a time since the previous one.
+ */
+static void mmal_port_update_port_stats(MMAL_PORT_T *port, MMAL_CORE_STATS_DIR direction,
+   uint32_t now, unsigned int count, uint32_t bytes)
+{
+   MMAL_PORT_STATS_T *stats = &port->priv->core->stats[direction];
+   uint32_t last, first = 0;
+
+   STATS_ADD(stats->latency.buffer_count, count);
+   STATS_ADD(stats->latency.bytes, bytes);
+
+   last = STATS_XCHG(stats->latency.last_buffer_time, now);
+   if (!last)
    {
-      stats->last_buffer_time = stats->first_buffer_time = stc;
+      STATS_CAS(stats->latency.first_buffer_time, first, now);
    }
    else
    {
-      stats->max_delay = vcos_max(stats->max_delay, stc-stats->last_buffer_time);
-      stats->last_buffer_time = stc;
+      STATS_ADD(stats->latency.interval[mmal_port_stats_bucket(now - last)], 1);
+      mmal_port_stats_max(&stats->max_delay, now - last);
    }
-   vcos_mutex_unlock(&core->stats_lock);
+   if (count > 1)
+      STATS_ADD(stats->latency.interval[0], count - 1);
+
+   if (direction == MMAL_CORE_STATS_RX)
+      mmal_port_stats_max(&stats->latency.in_transit_max, IN_TRANSIT_COUNT(port));
 }
 
 static MMAL_STATUS_T mmal_port_private_parameter_get(MMAL_PORT_T *port,
@@ -1444,6 +1707,8 @@ static MMAL_STATUS_T mmal_port_private_parameter_get(MMAL_PORT_T *port,
    {
    case MMAL_PARAMETER_CORE_STATISTICS:
       return mmal_port_get_core_stats(port, param);
+   case MMAL_PARAMETER_CORE_LATENCY:
+      return mmal_port_get_core_latency(port, param);
    default:
       return MMAL_ENOSYS;
    }
@@ -1452,9 +1717,13 @@ static MMAL_STATUS_T mmal_port_private_parameter_get(MMAL_PORT_T *port,
 static MMAL_STATUS_T mmal_port_private_parameter_set(MMAL_PORT_T *port,
                                                      const MMAL_PARAMETER_HEADER_T *param)
 {
-   (void)port;
    switch (param->id)
    {
+   case MMAL_PARAMETER_CORE_LATENCY_TX:
+      if (param->size < sizeof(MMAL_PARAMETER_BOOLEAN_T))
+         return MMAL_EINVAL;
+      STATS_STORE(port->priv->core->stats_tx, ((const MMAL_PARAMETER_BOOLEAN_T *)param)->enable);
+      return MMAL_SUCCESS;
    default:
       return MMAL_ENOSYS;
    }
@@ -50,6 +50,9 @@ typedef struct MMAL_PORT_PRIVATE_T
    MMAL_STATUS_T (*pf_enable)(MMAL_PORT_T *port, MMAL_PORT_BH_CB_T);
    MMAL_STATUS_T (*pf_disable)(MMAL_PORT_T *port);
    MMAL_STATUS_T (*pf_send)(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *);
+   /** Optional. Takes either all or none of a chain of buffer headers linked
+    * through their next field. pf_send is used for each of them otherwise. */
+   MMAL_STATUS_T (*pf_send_buffers)(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *);
    MMAL_STATUS_T (*pf_flush)(MMAL_PORT_T *port);
    MMAL_STATUS_T (*pf_parameter_set)(MMAL_PORT_T *port, const MMAL_PARAMETER_HEADER_T *param);
    MMAL_STATUS_T (*pf_parameter_get)(MMAL_PORT_T *port, MMAL_PARAMETER_HEADER_T *param);
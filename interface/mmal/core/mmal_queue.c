@@ -27,15 +27,37 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "mmal.h"
 #include "mmal_queue.h"
+#include "core/mmal_trace_private.h"
+
+/* The lock-free queue needs the atomic builtins of gcc and clang */
+#if defined(__ATOMIC_SEQ_CST)
+# define MMAL_QUEUE_LOCKFREE 1
+#endif
+
+/** Consumer and producer fields of the lock-free queue are this far apart so
+ * they don't share a cache line */
+#define MMAL_QUEUE_CACHE_LINE 64
 
 /** Definition of the QUEUE */
 struct MMAL_QUEUE_T
 {
+   MMAL_QUEUE_TYPE_T type;
    VCOS_MUTEX_T lock;
    unsigned int length;
    MMAL_BUFFER_HEADER_T *first;
    MMAL_BUFFER_HEADER_T **last;
    VCOS_SEMAPHORE_T semaphore;
+
+#ifdef MMAL_QUEUE_LOCKFREE
+   /* MPSC queue. The buffers go from first to tail through their next field.
+    * first is only used by the consumer, tail by the producers. The stub is in
+    * the list whenever it would otherwise be empty, so a producer never has
+    * to touch first. length is only changed after a buffer is linked. */
+   unsigned int waiting;     /**< Consumer is about to wait on the semaphore */
+   char pad[MMAL_QUEUE_CACHE_LINE];
+   MMAL_BUFFER_HEADER_T *tail;
+   MMAL_BUFFER_HEADER_T stub;
+#endif
 };
 
 // Only sanity check if asserts are enabled
@@ -55,12 +77,149 @@ static void mmal_queue_sanity_check(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *b
 #define mmal_queue_sanity_check(q,b)
 #endif
 
+#ifdef MMAL_QUEUE_LOCKFREE
+/** Link a chain of buffers, which ends with last, at the tail of a MPSC queue.
+ * Any thread. */
+static void mmal_queue_mpsc_link_chain(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *first,
+   MMAL_BUFFER_HEADER_T *last)
+{
+   MMAL_BUFFER_HEADER_T *prev;
+
+   last->next = 0;
+   prev = __atomic_exchange_n(&queue->tail, last, __ATOMIC_ACQ_REL);
+   /* Until this store the consumer can't see past prev */
+   __atomic_store_n(&prev->next, first, __ATOMIC_RELEASE);
+}
+
+/** Link a buffer at the tail of a MPSC queue. Any thread. */
+static void mmal_queue_mpsc_link(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffer)
+{
+   mmal_queue_mpsc_link_chain(queue, buffer, buffer);
+}
+
+/** Unlink the buffer at the head of a MPSC queue. Consumer only.
+ * @return NULL if the queue is empty or a producer is half way through a put */
+static MMAL_BUFFER_HEADER_T *mmal_queue_mpsc_unlink(MMAL_QUEUE_T *queue)
+{
+   MMAL_BUFFER_HEADER_T *first = queue->first;
+   MMAL_BUFFER_HEADER_T *next = __atomic_load_n(&first->next, __ATOMIC_ACQUIRE);
+
+   if (first == &queue->stub)
+   {
+      if (!next)
+         return NULL;
+      queue->first = first = next;
+      next = __atomic_load_n(&first->next, __ATOMIC_ACQUIRE);
+   }
+
+   if (next)
+   {
+      queue->first = next;
+      return first;
+   }
+
+   if (first != __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE))
+      return NULL;
+
+   /* first is the last buffer, so put the stub behind it to take it out */
+   mmal_queue_mpsc_link(queue, &queue->stub);
+   next = __atomic_load_n(&first->next, __ATOMIC_ACQUIRE);
+   if (!next)
+      return NULL;
+   queue->first = next;
+   return first;
+}
+
+/** Count buffers put into a MPSC queue and wake up the consumer if it is waiting */
+static void mmal_queue_mpsc_count(MMAL_QUEUE_T *queue, unsigned int count)
+{
+   __atomic_add_fetch(&queue->length, count, __ATOMIC_SEQ_CST);
+   /* Either the consumer sees the new length before it waits or we see it
+    * waiting. A post for a consumer that didn't wait after all only costs it
+    * a spurious wake-up. */
+   if (__atomic_load_n(&queue->waiting, __ATOMIC_SEQ_CST) &&
+       __atomic_exchange_n(&queue->waiting, 0, __ATOMIC_SEQ_CST))
+      vcos_semaphore_post(&queue->semaphore);
+}
+
+/** Get up to max buffers from a MPSC queue as a chain. Consumer only. */
+static MMAL_BUFFER_HEADER_T *mmal_queue_mpsc_get_batch(MMAL_QUEUE_T *queue, unsigned int max)
+{
+   MMAL_BUFFER_HEADER_T *first = NULL, **last = &first;
+   unsigned int count = __atomic_load_n(&queue->length, __ATOMIC_SEQ_CST), i;
+
+   if (max && count > max)
+      count = max;
+
+   for (i = 0; i < count; i++)
+   {
+      /* The length says there is a buffer, but a producer which started its
+       * put earlier may still have to link its own in front of it */
+      while ((*last = mmal_queue_mpsc_unlink(queue)) == NULL)
+         vcos_sleep(0);
+      MMAL_TRACE(MMAL_TRACE_QUEUE_GET, queue, NULL, *last, 0);
+      last = &(*last)->next;
+   }
+   *last = NULL;
+
+   if (count)
+      __atomic_sub_fetch(&queue->length, count, __ATOMIC_SEQ_CST);
+   return first;
+}
+
+/** Get a buffer from a MPSC queue. Consumer only. */
+static MMAL_BUFFER_HEADER_T *mmal_queue_mpsc_get(MMAL_QUEUE_T *queue)
+{
+   return mmal_queue_mpsc_get_batch(queue, 1);
+}
+
+/** Wait for a buffer from a MPSC queue. Consumer only.
+ * @param timeout Timeout in ms, or -1 to wait forever */
+static MMAL_BUFFER_HEADER_T *mmal_queue_mpsc_wait(MMAL_QUEUE_T *queue, int64_t timeout)
+{
+   int64_t deadline = timeout < 0 ? 0 : vcos_getmicrosecs64() + timeout * 1000;
+   MMAL_BUFFER_HEADER_T *buffer;
+   VCOS_STATUS_T status;
+
+   while ((buffer = mmal_queue_mpsc_get(queue)) == NULL)
+   {
+      __atomic_store_n(&queue->waiting, 1, __ATOMIC_SEQ_CST);
+      buffer = mmal_queue_mpsc_get(queue);
+      if (buffer)
+         break;
+
+      if (timeout < 0)
+      {
+         status = vcos_semaphore_wait(&queue->semaphore);
+      }
+      else
+      {
+         int64_t left = deadline - (int64_t)vcos_getmicrosecs64();
+         if (left <= 0)
+            break;
+         status = vcos_semaphore_wait_timeout(&queue->semaphore, (VCOS_UNSIGNED)((left + 999) / 1000));
+      }
+      if (status != VCOS_SUCCESS && timeout < 0)
+         break;
+   }
+
+   __atomic_store_n(&queue->waiting, 0, __ATOMIC_RELAXED);
+   return buffer;
+}
+#endif /* MMAL_QUEUE_LOCKFREE */
+
 /** Create a QUEUE of MMAL_BUFFER_HEADER_T */
 MMAL_QUEUE_T *mmal_queue_create(void)
+{
+   return mmal_queue_create_with_type(MMAL_QUEUE_TYPE_LOCKED);
+}
+
+/** Create a QUEUE of MMAL_BUFFER_HEADER_T of a given type */
+MMAL_QUEUE_T *mmal_queue_create_with_type(MMAL_QUEUE_TYPE_T type)
 {
    MMAL_QUEUE_T *queue;
 
-   queue = vcos_malloc(sizeof(*queue), "MMAL queue");
+   queue = vcos_calloc(1, sizeof(*queue), "MMAL queue");
    if(!queue) return 0;
 
    if(vcos_mutex_create(&queue->lock, "MMAL queue lock") != VCOS_SUCCESS )
@@ -83,6 +242,17 @@ MMAL_QUEUE_T *mmal_queue_create(void)
    mmal_queue_sanity_check(queue, NULL);
    /* gratuitous unlock for coverity */ vcos_mutex_unlock(&queue->lock);
 
+   queue->type = MMAL_QUEUE_TYPE_LOCKED;
+#ifdef MMAL_QUEUE_LOCKFREE
+   if (type == MMAL_QUEUE_TYPE_MPSC)
+   {
+      queue->type = type;
+      queue->first = queue->tail = &queue->stub;
+   }
+#else
+   MMAL_PARAM_UNUSED(type);
+#endif
+
    return queue;
 }
 
@@ -91,6 +261,16 @@ void mmal_queue_put(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffer)
 {
    vcos_assert(queue && buffer);
    if(!queue || !buffer) return;
+   MMAL_TRACE(MMAL_TRACE_QUEUE_PUT, queue, NULL, buffer, 0);
+
+#ifdef MMAL_QUEUE_LOCKFREE
+   if (queue->type == MMAL_QUEUE_TYPE_MPSC)
+   {
+      mmal_queue_mpsc_link(queue, buffer);
+      mmal_queue_mpsc_count(queue, 1);
+      return;
+   }
+#endif
 
    vcos_mutex_lock(&queue->lock);
    mmal_queue_sanity_check(queue, buffer);
@@ -115,6 +295,19 @@ void mmal_queue_put(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffer)
 void mmal_queue_put_back(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffer)
 {
    if(!queue || !buffer) return;
+   MMAL_TRACE(MMAL_TRACE_QUEUE_PUT, queue, NULL, buffer, 1);
+
+#ifdef MMAL_QUEUE_LOCKFREE
+   if (queue->type == MMAL_QUEUE_TYPE_MPSC)
+   {
+      /* Only the consumer touches first, so this is the same as for the
+       * locked queue. The list is never empty because of the stub. */
+      buffer->next = queue->first;
+      queue->first = buffer;
+      mmal_queue_mpsc_count(queue, 1);
+      return;
+   }
+#endif
 
    vcos_mutex_lock(&queue->lock);
    mmal_queue_sanity_check(queue, buffer);
@@ -127,6 +320,43 @@ void mmal_queue_put_back(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffer)
 }
 
 
+/** Put a chain of MMAL_BUFFER_HEADER_T into a QUEUE */
+void mmal_queue_put_batch(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffers)
+{
+   MMAL_BUFFER_HEADER_T *last;
+   unsigned int count = 1, i;
+
+   vcos_assert(queue);
+   if(!queue || !buffers) return;
+
+   if (MMAL_TRACE_ACTIVE(MMAL_TRACE_QUEUE_PUT))
+      for (last = buffers, i = 0; last; last = last->next, i++)
+         mmal_trace_record(MMAL_TRACE_QUEUE_PUT, queue, NULL, last, 0, i);
+
+   for (last = buffers; last->next; last = last->next)
+      count++;
+
+#ifdef MMAL_QUEUE_LOCKFREE
+   if (queue->type == MMAL_QUEUE_TYPE_MPSC)
+   {
+      mmal_queue_mpsc_link_chain(queue, buffers, last);
+      mmal_queue_mpsc_count(queue, count);
+      return;
+   }
+#endif
+
+   vcos_mutex_lock(&queue->lock);
+   mmal_queue_sanity_check(queue, buffers);
+   queue->length += count;
+   *queue->last = buffers;
+   queue->last = &last->next;
+   /* Posted under the lock for the same reason as in mmal_queue_put. Only
+    * the first post can find the consumer waiting. */
+   for (i = 0; i < count; i++)
+      vcos_semaphore_post(&queue->semaphore);
+   vcos_mutex_unlock(&queue->lock);
+}
+
 /** Get a MMAL_BUFFER_HEADER_T from a QUEUE. Semaphore already claimed */
 static MMAL_BUFFER_HEADER_T *mmal_queue_get_core(MMAL_QUEUE_T *queue)
 {
@@ -143,6 +373,7 @@ static MMAL_BUFFER_HEADER_T *mmal_queue_get_core(MMAL_QUEUE_T *queue)
    queue->length--;
    vcos_mutex_unlock(&queue->lock);
 
+   MMAL_TRACE(MMAL_TRACE_QUEUE_GET, queue, NULL, buffer, 0);
    return buffer;
 }
 
@@ -152,17 +383,68 @@ MMAL_BUFFER_HEADER_T *mmal_queue_get(MMAL_QUEUE_T *queue)
    vcos_assert(queue);
    if(!queue) return 0;
 
+#ifdef MMAL_QUEUE_LOCKFREE
+   if (queue->type == MMAL_QUEUE_TYPE_MPSC)
+      return mmal_queue_mpsc_get(queue);
+#endif
+
    if(vcos_semaphore_trywait(&queue->semaphore) != VCOS_SUCCESS)
        return NULL;
 
    return mmal_queue_get_core(queue);
 }
 
+/** Get several MMAL_BUFFER_HEADER_T from a QUEUE. */
+MMAL_BUFFER_HEADER_T *mmal_queue_get_batch(MMAL_QUEUE_T *queue, unsigned int max)
+{
+   MMAL_BUFFER_HEADER_T *first, *last;
+   unsigned int count = 0, i;
+
+   vcos_assert(queue);
+   if(!queue) return 0;
+
+#ifdef MMAL_QUEUE_LOCKFREE
+   if (queue->type == MMAL_QUEUE_TYPE_MPSC)
+      return mmal_queue_mpsc_get_batch(queue, max);
+#endif
+
+   /* Claim the buffers first, like mmal_queue_get does */
+   while ((!max || count < max) && vcos_semaphore_trywait(&queue->semaphore) == VCOS_SUCCESS)
+      count++;
+   if (!count)
+      return NULL;
+
+   vcos_mutex_lock(&queue->lock);
+   mmal_queue_sanity_check(queue, NULL);
+   first = last = queue->first;
+   for (i = 1; i < count; i++)
+      last = last->next;
+   vcos_assert(last != NULL);
+
+   queue->first = last->next;
+   if(!queue->first) queue->last = &queue->first;
+   last->next = 0;
+
+   queue->length -= count;
+   vcos_mutex_unlock(&queue->lock);
+
+   if (MMAL_TRACE_ACTIVE(MMAL_TRACE_QUEUE_GET))
+      for (last = first, i = 0; last; last = last->next, i++)
+         mmal_trace_record(MMAL_TRACE_QUEUE_GET, queue, NULL, last, 0, i);
+
+   return first;
+}
+
 /** Wait for a MMAL_BUFFER_HEADER_T from a QUEUE. */
 MMAL_BUFFER_HEADER_T *mmal_queue_wait(MMAL_QUEUE_T *queue)
 {
 	if(!queue) return 0;
 
+#ifdef MMAL_QUEUE_LOCKFREE
+   if (queue->type == MMAL_QUEUE_TYPE_MPSC)
+      return mmal_queue_mpsc_wait(queue, -1);
+#endif
+
    if (vcos_semaphore_wait(&queue->semaphore) != VCOS_SUCCESS)
        return NULL;
 
@@ -174,6 +456,11 @@ MMAL_BUFFER_HEADER_T *mmal_queue_timedwait(MMAL_QUEUE_T *queue, VCOS_UNSIGNED ti
     if (!queue)
         return NULL;
 
+#ifdef MMAL_QUEUE_LOCKFREE
+    if (queue->type == MMAL_QUEUE_TYPE_MPSC)
+        return mmal_queue_mpsc_wait(queue, timeout);
+#endif
+
     if (vcos_semaphore_wait_timeout(&queue->semaphore, timeout) != VCOS_SUCCESS)
         return NULL;
 
@@ -185,6 +472,11 @@ unsigned int mmal_queue_length(MMAL_QUEUE_T *queue)
 {
 	if(!queue) return 0;
 
+#ifdef MMAL_QUEUE_LOCKFREE
+	if (queue->type == MMAL_QUEUE_TYPE_MPSC)
+		return __atomic_load_n(&queue->length, __ATOMIC_SEQ_CST);
+#endif
+
 	return queue->length;
 }
 
@@ -0,0 +1,320 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "mmal.h"
+#include "mmal_trace.h"
+#include "core/mmal_trace_private.h"
+#include "mmal_logging.h"
+
+#ifdef MMAL_TRACE_SUPPORTED
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+#define TRACE_EVENTS_DEFAULT 16384
+#define TRACE_EVENTS_MAX     (1 << 22)
+/** Objects each thread remembers having named, so it doesn't take the
+ * lock of the name table for every event. Power of two. */
+#define TRACE_NAMED_CACHE    64
+#define TRACE_NAMES_MAX      1024
+
+/** Ring of events of one thread.
+ * Only the owner thread writes to the ring and resets it when tracing starts
+ * again. The owner sets exited on its way out, after which the ring can be
+ * handed to a new thread once its events are no longer wanted. */
+typedef struct MMAL_TRACE_RING_T
+{
+   struct MMAL_TRACE_RING_T *next; /**< All the rings, for writing them out */
+   uint32_t generation;            /**< Tracing session the events belong to */
+   uint32_t exited;                /**< Owner thread has exited */
+   uint32_t tid;                   /**< Owner thread */
+   char name[16];                  /**< Name of the owner thread */
+   uint32_t size;                  /**< Number of events, power of two */
+   uint32_t written;               /**< Events written in this session */
+   const void *named[TRACE_NAMED_CACHE]; /**< Objects already in the name table */
+   MMAL_TRACE_EVENT_T event[1];    /**< The events, size of them */
+} MMAL_TRACE_RING_T;
+
+uint32_t mmal_trace_mask;
+
+static struct
+{
+   pthread_mutex_t lock;          /**< Protects everything below but the generation */
+   pthread_once_t once;
+   pthread_key_t key;             /**< Tells a ring its thread exited */
+   uint32_t generation;           /**< Incremented on every start */
+   uint32_t size;                 /**< Size of the rings in this session */
+   MMAL_TRACE_RING_T *rings;
+   MMAL_TRACE_NAME_T names[TRACE_NAMES_MAX];
+   unsigned int names_num;
+} trace = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_ONCE_INIT };
+
+static __thread MMAL_TRACE_RING_T *trace_ring;
+
+static void mmal_trace_thread_exit(void *ring)
+{
+   __atomic_store_n(&((MMAL_TRACE_RING_T *)ring)->exited, 1, __ATOMIC_RELEASE);
+}
+
+static void mmal_trace_init(void)
+{
+   if (pthread_key_create(&trace.key, mmal_trace_thread_exit))
+      LOG_ERROR("no key for the trace rings, they will not be reused");
+}
+
+/** Give the calling thread an empty ring of the current session. Lock held. */
+static MMAL_TRACE_RING_T *mmal_trace_ring_attach(MMAL_TRACE_RING_T *ring, uint32_t generation)
+{
+   /* The ring of the previous session can be reused if it is the right size */
+   if (ring && ring->size != trace.size)
+   {
+      ring->exited = 1;
+      ring = NULL;
+   }
+
+   if (!ring)
+   {
+      for (ring = trace.rings; ring; ring = ring->next)
+         if (__atomic_load_n(&ring->exited, __ATOMIC_ACQUIRE) && ring->generation != generation &&
+             ring->size == trace.size)
+            break;
+   }
+
+   if (!ring)
+   {
+      ring = vcos_calloc(1, sizeof(*ring) + (trace.size - 1) * sizeof(ring->event[0]), "mmal trace ring");
+      if (!ring)
+         return NULL;
+      ring->size = trace.size;
+      ring->next = trace.rings;
+      trace.rings = ring;
+   }
+
+   ring->exited = 0;
+   ring->generation = generation;
+   ring->written = 0;
+   ring->tid = (uint32_t)syscall(SYS_gettid);
+   memset(ring->name, 0, sizeof(ring->name));
+   prctl(PR_GET_NAME, ring->name, 0, 0, 0);
+   memset(ring->named, 0, sizeof(ring->named));
+   pthread_setspecific(trace.key, ring);
+   return ring;
+}
+
+/** Add an object to the name table unless it is there already */
+static void mmal_trace_name(MMAL_TRACE_RING_T *ring, const void *object, const char *name)
+{
+   unsigned int slot = ((uintptr_t)object >> 4) & (TRACE_NAMED_CACHE - 1), i;
+
+   if (ring->named[slot] == object)
+      return;
+   ring->named[slot] = object;
+
+   pthread_mutex_lock(&trace.lock);
+   for (i = 0; i < trace.names_num; i++)
+      if (trace.names[i].object == (uintptr_t)object)
+         break;
+   if (i == trace.names_num && i < TRACE_NAMES_MAX)
+   {
+      trace.names[i].object = (uintptr_t)object;
+      strncpy(trace.names[i].name, name, sizeof(trace.names[i].name) - 1);
+      trace.names_num++;
+   }
+   pthread_mutex_unlock(&trace.lock);
+}
+
+/** Record an event in the ring of the calling thread */
+void mmal_trace_record(MMAL_TRACE_TYPE_T type, const void *object, const char *name,
+                       const MMAL_BUFFER_HEADER_T *buffer, uint32_t arg, unsigned int index)
+{
+   uint32_t generation = __atomic_load_n(&trace.generation, __ATOMIC_ACQUIRE);
+   MMAL_TRACE_RING_T *ring = trace_ring;
+   MMAL_TRACE_EVENT_T *event;
+   struct timespec now;
+
+   if (!ring || ring->generation != generation)
+   {
+      pthread_mutex_lock(&trace.lock);
+      ring = trace_ring = mmal_trace_ring_attach(ring, generation);
+      pthread_mutex_unlock(&trace.lock);
+      if (!ring)
+         return;
+   }
+
+   if (name)
+      mmal_trace_name(ring, object, name);
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   event = &ring->event[ring->written & (ring->size - 1)];
+   event->time = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+   event->object = (uintptr_t)object;
+   event->buffer = (uintptr_t)buffer;
+   event->pts = buffer ? buffer->pts : MMAL_TIME_UNKNOWN;
+   event->length = buffer ? buffer->length : 0;
+   event->flags = buffer ? buffer->flags : 0;
+   event->arg = arg;
+   event->type = type;
+   event->index = index;
+   __atomic_store_n(&ring->written, ring->written + 1, __ATOMIC_RELEASE);
+}
+
+/** Start tracing */
+MMAL_STATUS_T mmal_trace_start(unsigned int events, uint32_t mask)
+{
+   unsigned int size = 1;
+
+   if (!events)
+      events = TRACE_EVENTS_DEFAULT;
+   if (events > TRACE_EVENTS_MAX)
+      events = TRACE_EVENTS_MAX;
+   while (size < events)
+      size <<= 1;
+
+   pthread_once(&trace.once, mmal_trace_init);
+
+   pthread_mutex_lock(&trace.lock);
+   __atomic_store_n(&mmal_trace_mask, 0, __ATOMIC_RELAXED);
+   trace.size = size;
+   trace.names_num = 0;
+   /* Every thread starts its ring over when it sees the new generation */
+   __atomic_add_fetch(&trace.generation, 1, __ATOMIC_RELEASE);
+   __atomic_store_n(&mmal_trace_mask, mask ? mask & MMAL_TRACE_ALL : MMAL_TRACE_ALL, __ATOMIC_RELEASE);
+   pthread_mutex_unlock(&trace.lock);
+
+   LOG_TRACE("tracing %u events per thread, mask %x", size, mmal_trace_mask);
+   return MMAL_SUCCESS;
+}
+
+/** Stop tracing */
+void mmal_trace_stop(void)
+{
+   __atomic_store_n(&mmal_trace_mask, 0, __ATOMIC_RELEASE);
+}
+
+/** Write the events of one ring, oldest first */
+static int mmal_trace_write_ring(FILE *file, MMAL_TRACE_RING_T *ring)
+{
+   uint32_t written = __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE);
+   uint32_t count = written < ring->size ? written : ring->size;
+   uint32_t first = (written - count) & (ring->size - 1);
+   uint32_t head = count < ring->size - first ? count : ring->size - first;
+   MMAL_TRACE_THREAD_T thread;
+
+   memset(&thread, 0, sizeof(thread));
+   thread.tid = ring->tid;
+   thread.events = count;
+   thread.dropped = written - count;
+   memcpy(thread.name, ring->name, sizeof(thread.name));
+
+   if (fwrite(&thread, sizeof(thread), 1, file) != 1 ||
+       fwrite(&ring->event[first], sizeof(ring->event[0]), head, file) != head ||
+       fwrite(&ring->event[0], sizeof(ring->event[0]), count - head, file) != count - head)
+      return -1;
+   return 0;
+}
+
+/** Write the events recorded since tracing started to a file */
+MMAL_STATUS_T mmal_trace_write(const char *path)
+{
+   MMAL_STATUS_T status = MMAL_SUCCESS;
+   MMAL_TRACE_FILE_HEADER_T header;
+   MMAL_TRACE_RING_T *ring;
+   uint32_t generation;
+   FILE *file;
+
+   file = fopen(path, "wb");
+   if (!file)
+   {
+      LOG_ERROR("unable to open %s", path);
+      return MMAL_EIO;
+   }
+
+   pthread_mutex_lock(&trace.lock);
+   generation = __atomic_load_n(&trace.generation, __ATOMIC_ACQUIRE);
+
+   memset(&header, 0, sizeof(header));
+   header.magic = MMAL_TRACE_FILE_MAGIC;
+   header.version = MMAL_TRACE_FILE_VERSION;
+   header.event_size = sizeof(MMAL_TRACE_EVENT_T);
+   header.pid = (uint32_t)getpid();
+   header.names = trace.names_num;
+   for (ring = trace.rings; ring; ring = ring->next)
+      if (ring->generation == generation)
+         header.threads++;
+
+   if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+       fwrite(trace.names, sizeof(trace.names[0]), trace.names_num, file) != trace.names_num)
+      status = MMAL_EIO;
+
+   for (ring = trace.rings; ring && status == MMAL_SUCCESS; ring = ring->next)
+      if (ring->generation == generation && mmal_trace_write_ring(file, ring))
+         status = MMAL_EIO;
+   pthread_mutex_unlock(&trace.lock);
+
+   if (fclose(file) && status == MMAL_SUCCESS)
+      status = MMAL_EIO;
+   if (status != MMAL_SUCCESS)
+      LOG_ERROR("unable to write %s", path);
+   return status;
+}
+
+#else /* MMAL_TRACE_SUPPORTED */
+
+void mmal_trace_record(MMAL_TRACE_TYPE_T type, const void *object, const char *name,
+                       const MMAL_BUFFER_HEADER_T *buffer, uint32_t arg, unsigned int index)
+{
+   MMAL_PARAM_UNUSED(type);
+   MMAL_PARAM_UNUSED(object);
+   MMAL_PARAM_UNUSED(name);
+   MMAL_PARAM_UNUSED(buffer);
+   MMAL_PARAM_UNUSED(arg);
+   MMAL_PARAM_UNUSED(index);
+}
+
+MMAL_STATUS_T mmal_trace_start(unsigned int events, uint32_t mask)
+{
+   MMAL_PARAM_UNUSED(events);
+   MMAL_PARAM_UNUSED(mask);
+   return MMAL_ENOSYS;
+}
+
+void mmal_trace_stop(void)
+{
+}
+
+MMAL_STATUS_T mmal_trace_write(const char *path)
+{
+   MMAL_PARAM_UNUSED(path);
+   return MMAL_ENOSYS;
+}
+
+#endif /* MMAL_TRACE_SUPPORTED */
@@ -0,0 +1,63 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MMAL_TRACE_PRIVATE_H
+#define MMAL_TRACE_PRIVATE_H
+
+#include "mmal_trace.h"
+
+/* The rings are per thread and the tracing switch is read without a lock */
+#if defined(__linux__) && defined(__ATOMIC_RELAXED)
+# define MMAL_TRACE_SUPPORTED 1
+#endif
+
+#ifdef MMAL_TRACE_SUPPORTED
+/** Mask of the event types being recorded, 0 while tracing is off */
+extern uint32_t mmal_trace_mask;
+/** Whether events of this type are being recorded */
+# define MMAL_TRACE_ACTIVE(type) (__atomic_load_n(&mmal_trace_mask, __ATOMIC_RELAXED) & MMAL_TRACE_MASK(type))
+#else
+# define MMAL_TRACE_ACTIVE(type) 0
+#endif
+
+/** Record an event in the ring of the calling thread.
+ *
+ * @param type   Type of the event
+ * @param object Port or queue the event happened on
+ * @param name   Name of the object, or NULL if it has none
+ * @param buffer Buffer header, or NULL if it may be gone by now
+ * @param arg    Argument of the event, see \ref MMAL_TRACE_TYPE_T
+ * @param index  Index of the buffer header in a chain
+ */
+void mmal_trace_record(MMAL_TRACE_TYPE_T type, const void *object, const char *name,
+                       const MMAL_BUFFER_HEADER_T *buffer, uint32_t arg, unsigned int index);
+
+/** Record an event if tracing is on and the type is in the mask */
+#define MMAL_TRACE(type, object, name, buffer, arg) \
+   do { if (MMAL_TRACE_ACTIVE(type)) mmal_trace_record(type, object, name, buffer, arg, 0); } while (0)
+
+#endif /* MMAL_TRACE_PRIVATE_H */
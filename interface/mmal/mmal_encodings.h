@@ -215,6 +215,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define MMAL_ENCODING_MP4V_DIVX_DRM    MMAL_FOURCC('M','4','V','D')
 /* @} */
 
+/** \name Pre-defined other encodings */
+/* @{ */
+/** A stream of buffers which only carry metadata items (see \ref MmalMetadata),
+ * for instance the results of an analysis component. The payload is unused.
+ */
+#define MMAL_ENCODING_METADATA         MMAL_FOURCC('M','E','T','A')
+/* @} */
+
 /* @} MmalEncodings List */
 
 /** \defgroup MmalEncodingVariants List of pre-defined encoding variants
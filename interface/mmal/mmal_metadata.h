@@ -38,6 +38,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /** \name Pre-defined metadata FourCCs */
 /* @{ */
 #define MMAL_METADATA_HELLO_WORLD             MMAL_FOURCC('H','E','L','O')
+#define MMAL_METADATA_BALLTRACK               MMAL_FOURCC('B','T','R','K')
+#define MMAL_METADATA_BALL_TRUTH              MMAL_FOURCC('B','T','R','U')
 /* @} */
 
 /** Generic metadata type. All metadata structures need to begin with these fields. */
@@ -56,6 +58,42 @@ typedef struct MMAL_METATDATA_HELLO_WORLD_T
    uint32_t myvalue; /**< Metadata value */
 } MMAL_METADATA_HELLO_WORLD_T;
 
+/** \name Ball tracker result flags */
+/* @{ */
+#define MMAL_METADATA_BALLTRACK_FLAG_ANALYSED (1<<0) /**< The frame went through the tracker */
+#define MMAL_METADATA_BALLTRACK_FLAG_FOUND    (1<<1) /**< The ball was found in the frame */
+#define MMAL_METADATA_BALLTRACK_FLAG_TRUTH    (1<<2) /**< The frame came with a ground truth */
+/* @} */
+
+/** Ball tracker result for one video frame, as sent by the balltrack component. */
+typedef struct MMAL_METADATA_BALLTRACK_T
+{
+   uint32_t id;    /**< Metadata id. This is a FourCC */
+   uint32_t size;  /**< Size in bytes of the following metadata (not including id and size) */
+
+   int64_t pts;       /**< Presentation timestamp of the frame the result is for */
+   uint32_t flags;    /**< Result flags (MMAL_METADATA_BALLTRACK_FLAG_*) */
+   float x;           /**< Ball position in the [-1,1] table coordinates of the tracker */
+   float y;           /**< Ball position in the [-1,1] table coordinates of the tracker */
+   uint32_t track_us; /**< Time spent in the tracker for this frame in microseconds */
+   float truth_x;     /**< Ground truth of the frame if MMAL_METADATA_BALLTRACK_FLAG_TRUTH is set */
+   float truth_y;     /**< Ground truth of the frame if MMAL_METADATA_BALLTRACK_FLAG_TRUTH is set */
+} MMAL_METADATA_BALLTRACK_T;
+
+/** Where the ball really is in a synthetic video frame, as rendered by the artificial_camera
+ * component. The position is in the coordinates of the ball tracker, [-1,1] over the whole
+ * frame with -1 at the left and at the first row, and does not depend on the resolution. */
+typedef struct MMAL_METADATA_BALL_TRUTH_T
+{
+   uint32_t id;    /**< Metadata id. This is a FourCC */
+   uint32_t size;  /**< Size in bytes of the following metadata (not including id and size) */
+
+   float x;        /**< Centre of the ball at the pts of the frame */
+   float y;        /**< Centre of the ball at the pts of the frame */
+   float radius;   /**< Radius of the ball in the same units as x */
+   uint32_t frame; /**< Index of the frame since the port was enabled */
+} MMAL_METADATA_BALL_TRUTH_T;
+
 /** Get metadata item from buffer header.
  * This will search through all the metadata in the buffer header and return a pointer to the
  * first instance of the requested metadata id.
@@ -70,6 +108,11 @@ MMAL_METADATA_T *mmal_metadata_get(MMAL_BUFFER_HEADER_T *header, uint32_t id);
 /** Set metadata item in buffer header.
  * This will store the metadata item into the buffer header. This operation can fail if not
  * enough memory is available in the data section of the buffer header.
+ * Items are stored one after the other in a metadata area of the buffer header, each one
+ * taking its size rounded up to 8 bytes, so they don't use the payload and travel with
+ * video frames. An item with the same id replaces the existing one.
+ * The items are cleared when the buffer header is released and copied along by
+ * mmal_buffer_header_replicate and mmal_buffer_header_copy_header.
  *
  * @param header   buffer header to store the metadata into
  * @param metadata metadata item to store in buffer header
@@ -51,6 +51,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define MMAL_PARAMETER_GROUP_CLOCK             (4<<16)
 /** Miracast-specific parameter ID group. */
 #define MMAL_PARAMETER_GROUP_MIRACAST       (5<<16)
+/** Parameter ID group of the components which only exist on the host. */
+#define MMAL_PARAMETER_GROUP_HOST              (6<<16)
 
 
 /**@}*/
@@ -0,0 +1,123 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MMAL_PARAMETERS_HOST_H
+#define MMAL_PARAMETERS_HOST_H
+
+#include "mmal_parameters_common.h"
+
+/*************************************************
+ * ALWAYS ADD NEW ENUMS AT THE END OF THIS LIST! *
+ ************************************************/
+
+/** Parameter IDs of the components and of the core which only exist on the host.
+ * @ingroup MMAL_PARAMETER_IDS
+ */
+enum
+{
+   MMAL_PARAMETER_ARTIFICIAL_SCENE          /**< Takes a MMAL_PARAMETER_ARTIFICIAL_SCENE_T */
+      = MMAL_PARAMETER_GROUP_HOST,
+   MMAL_PARAMETER_CORE_LATENCY,             /**< Takes a MMAL_PARAMETER_CORE_LATENCY_T */
+   MMAL_PARAMETER_CORE_LATENCY_TX,          /**< Takes a MMAL_PARAMETER_BOOLEAN_T. Set only */
+};
+
+/** What the artificial_camera component renders */
+typedef enum MMAL_PARAM_ARTIFICIAL_SCENE_T
+{
+   MMAL_PARAM_ARTIFICIAL_SCENE_PATTERN,     /**< White frames with a chroma level which changes every frame */
+   MMAL_PARAM_ARTIFICIAL_SCENE_FOOSBALL,    /**< A foosball table with a ball moving over it */
+   MMAL_PARAM_ARTIFICIAL_SCENE_MAX = 0x7fffffff
+} MMAL_PARAM_ARTIFICIAL_SCENE_T;
+
+/** Scene of an output port of the artificial_camera component.
+ * The ball of the foosball scene follows a path which only depends on the seed, in
+ * coordinates relative to the frame, and frame n shows it where it is at n times the frame
+ * time of the port format, so the same seed and frame rate give the same ball positions at
+ * any resolution. Every frame of the scene carries the ball position as a
+ * MMAL_METADATA_BALL_TRUTH_T metadata item.
+ */
+typedef struct MMAL_PARAMETER_ARTIFICIAL_SCENE_T
+{
+   MMAL_PARAMETER_HEADER_T hdr;
+
+   MMAL_PARAM_ARTIFICIAL_SCENE_T scene; /**< What the frames show */
+   uint32_t seed;           /**< Seed of the ball path and of the noise */
+   uint32_t ball_speed;     /**< Speed of the ball in percent of the field length per second */
+   uint32_t noise;          /**< Amplitude of the sensor noise in 8 bit levels, 0 for none */
+   uint32_t exposure;       /**< Exposure time in percent of the frame time. The ball is smeared
+                                 over the path it covers in that time, 0 for a sharp ball */
+   uint32_t brightness;     /**< Scene brightness in percent, 100 for the nominal colours */
+   uint32_t vignetting;     /**< How much darker the corners are than the centre, in percent */
+   MMAL_BOOL_T free_running; /**< Send frames as soon as buffers come back instead of when the
+                                  clock reaches their pts */
+} MMAL_PARAMETER_ARTIFICIAL_SCENE_T;
+
+/** The histograms of MMAL_CORE_LATENCY_T split each power of 2 of us into
+ * 2^MMAL_CORE_LATENCY_SUB_BITS buckets of the same width, so a bucket is at most
+ * 1/8 of its time wide. The first 8 buckets are 1us wide, and the last one
+ * counts everything from about 16 seconds up.
+ */
+#define MMAL_CORE_LATENCY_SUB_BITS 3
+/** Number of buckets in the histograms of MMAL_CORE_LATENCY_T */
+#define MMAL_CORE_LATENCY_BUCKETS (22 << MMAL_CORE_LATENCY_SUB_BITS)
+
+/** Statistics the host core keeps for one direction of a port.
+ * Buffers go in (MMAL_CORE_STATS_RX) when they are sent to the port and out
+ * (MMAL_CORE_STATS_TX) when the component sends them back. Times are in us.
+ */
+typedef struct MMAL_CORE_LATENCY_T
+{
+   uint32_t buffer_count;        /**< Number of buffers */
+   uint32_t first_buffer_time;   /**< Time of the first buffer */
+   uint32_t last_buffer_time;    /**< Time of the most recent buffer */
+   uint32_t in_transit_max;      /**< Most buffers the component held at once. RX only. A buffer
+                                      whose callback sends it straight back counts twice */
+   uint64_t bytes;               /**< Sum of the lengths of the buffers */
+   uint32_t interval[MMAL_CORE_LATENCY_BUCKETS]; /**< Time between buffers */
+   uint32_t latency[MMAL_CORE_LATENCY_BUCKETS];  /**< Time from a buffer going in to coming
+                                                      out again, which is how long the
+                                                      component kept it. TX only */
+} MMAL_CORE_LATENCY_T;
+
+/** Statistics of a port kept by the host core.
+ * Unlike MMAL_PARAMETER_CORE_STATISTICS this is only answered by the host core, so
+ * on ports of components running on VideoCore it describes the buffers exchanged
+ * with the host, and tunnelled connections don't show up at all.
+ * MMAL_CORE_STATS_TX costs a clock read per buffer coming back, so it stays at zero
+ * until MMAL_PARAMETER_CORE_LATENCY_TX turns it on for the port, unless the core
+ * was built with MMAL_COLLECT_PORT_STATS.
+ */
+typedef struct MMAL_PARAMETER_CORE_LATENCY_T
+{
+   MMAL_PARAMETER_HEADER_T hdr;
+
+   MMAL_CORE_STATS_DIR dir;      /**< Direction to get */
+   MMAL_BOOL_T reset;            /**< Reset to zero after reading */
+   MMAL_CORE_LATENCY_T stats;    /**< The statistics */
+} MMAL_PARAMETER_CORE_LATENCY_T;
+
+#endif /* MMAL_PARAMETERS_HOST_H */
@@ -102,6 +102,41 @@ MMAL_POOL_T *mmal_pool_create_with_allocator(unsigned int headers, uint32_t payl
                               void *allocator_context, mmal_pool_allocator_alloc_t allocator_alloc,
                               mmal_pool_allocator_free_t allocator_free);
 
+/** \name Pool arena flags
+ * Flags for \ref mmal_pool_create_arena. */
+/* @{ */
+#define MMAL_POOL_ARENA_PAGE_STRIDE (1<<0) /**< Start every payload on a page instead of a cache line */
+#define MMAL_POOL_ARENA_HUGE_PAGES  (1<<1) /**< Back the arena with huge pages when the system has some */
+#define MMAL_POOL_ARENA_SHARED      (1<<2) /**< Back the arena with a memfd which another process can map */
+/* @} */
+
+/** Alignment of the payload buffers of a pool created with \ref mmal_pool_create_arena */
+#define MMAL_POOL_ARENA_ALIGN 64
+
+/** Create a pool of MMAL_BUFFER_HEADER_T with all the payload buffers in one arena.
+ * The payload buffers are carved out of a single page aligned mapping, one after the
+ * other and in the order of the pool's header array, so each starts on a cache line
+ * (\ref MMAL_POOL_ARENA_ALIGN) or, with \ref MMAL_POOL_ARENA_PAGE_STRIDE, on a page.
+ *
+ * With \ref MMAL_POOL_ARENA_SHARED the arena is a memfd, which mmal_pool_get_stats()
+ * returns together with the base of the mapping, so the offset of a payload can be
+ * passed to another process which mapped the same fd. Huge pages and memfds are only
+ * used where the system provides them; mmal_pool_get_stats() tells what the arena got.
+ *
+ * mmal_pool_resize() carves the new payload buffers out of the same arena. The arena
+ * only grows when the new payloads don't fit in it, in which case the mapping moves
+ * but a memfd stays the same, and it shrinks when more than half of it would be unused.
+ * A memfd never shrinks, so a peer which mapped it keeps a valid mapping; it only has
+ * to map it again after the arena grew.
+ *
+ * @param headers      Number of buffer headers to be allocated with the pool.
+ * @param payload_size Size of the payload buffer that will be allocated in
+ *                     each of the buffer headers.
+ * @param flags        Combination of the MMAL_POOL_ARENA_ flags.
+ * @return Pointer to the newly created pool or NULL on failure.
+ */
+MMAL_POOL_T *mmal_pool_create_arena(unsigned int headers, uint32_t payload_size, uint32_t flags);
+
 /** Destroy a pool of MMAL_BUFFER_HEADER_T.
  * This will also deallocate all of the memory which was allocated when creating or
  * resizing the pool.
@@ -128,6 +163,35 @@ void mmal_pool_destroy(MMAL_POOL_T *pool);
  */
 MMAL_STATUS_T mmal_pool_resize(MMAL_POOL_T *pool, unsigned int headers, uint32_t payload_size);
 
+/** Statistics of a pool, see \ref mmal_pool_get_stats.
+ * The arena fields are zero, and arena_fd is -1, for a pool without an arena. */
+typedef struct MMAL_POOL_STATS_T
+{
+   uint32_t headers_num;     /**< Number of buffer headers in the pool */
+   uint32_t headers_in_use;  /**< Number of buffer headers out of the pool's queue */
+   uint32_t payload_size;    /**< Size of each payload buffer */
+   uint32_t payload_stride;  /**< Distance between two payload buffers in the arena */
+
+   uint32_t arena_flags;     /**< MMAL_POOL_ARENA_ flags the arena actually got */
+   int arena_fd;             /**< memfd of a shared arena */
+   uint8_t *arena_base;      /**< Start of the arena, payload offsets are relative to it */
+   uint64_t arena_size;      /**< Size of the arena mapping in bytes */
+
+   uint64_t bytes_allocated; /**< Bytes of payload buffers in the pool */
+   uint64_t bytes_in_use;    /**< Bytes of payload buffers out of the pool's queue */
+   uint64_t bytes_wasted;    /**< Bytes of the arena which are not part of any payload buffer,
+                                  the padding up to the stride and the unused end of the arena */
+} MMAL_POOL_STATS_T;
+
+/** Get the statistics of a pool.
+ * The fragmentation of the arena is bytes_wasted / arena_size.
+ *
+ * @param pool  Pointer to the pool
+ * @param stats Statistics to fill in
+ * @return MMAL_SUCCESS or MMAL_EINVAL if the pool is NULL.
+ */
+MMAL_STATUS_T mmal_pool_get_stats(MMAL_POOL_T *pool, MMAL_POOL_STATS_T *stats);
+
 /** Definition of the callback used by a pool to signal back to the user that a buffer header
  * has been released back to the pool.
  *
@@ -216,6 +216,20 @@ MMAL_STATUS_T mmal_port_parameter_get(MMAL_PORT_T *port,
 MMAL_STATUS_T mmal_port_send_buffer(MMAL_PORT_T *port,
    MMAL_BUFFER_HEADER_T *buffer);
 
+/** Send a chain of buffer headers to a port.
+ * The buffer headers are linked through their next field, as returned by
+ * \ref mmal_queue_get_batch, and are sent in order with one lock for the whole
+ * chain. Sending stops at the first buffer header the port refuses.
+ *
+ * @param port The port to which the buffer headers are to be sent.
+ * @param buffers Pointer to the first buffer header of the chain. On return it
+ * points to the chain of buffer headers which were not sent, or NULL if all of
+ * them were.
+ * @return MMAL_SUCCESS on success
+ */
+MMAL_STATUS_T mmal_port_send_buffers(MMAL_PORT_T *port,
+   MMAL_BUFFER_HEADER_T **buffers);
+
 /** Connect an output port to an input port.
  *
  * When connected and enabled, buffers will automatically progress from the
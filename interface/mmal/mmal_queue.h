@@ -42,12 +42,33 @@ extern "C" {
 
 typedef struct MMAL_QUEUE_T MMAL_QUEUE_T;
 
+/** Kinds of queue */
+typedef enum MMAL_QUEUE_TYPE_T
+{
+   MMAL_QUEUE_TYPE_LOCKED, /**< Any thread can use the queue. Every operation takes a mutex
+                                and every put posts a semaphore */
+   MMAL_QUEUE_TYPE_MPSC,   /**< Any thread can put buffer headers but only one thread at a
+                                time may get them or put them back, such as the action
+                                thread of a component. Puts and gets don't take any lock and
+                                the semaphore is only used when the consumer has to wait */
+} MMAL_QUEUE_TYPE_T;
+
 /** Create a queue of MMAL_BUFFER_HEADER_T
  *
  * @return Pointer to the newly created queue or NULL on failure.
  */
 MMAL_QUEUE_T *mmal_queue_create(void);
 
+/** Create a queue of MMAL_BUFFER_HEADER_T of a given type.
+ * All types behave the same for the length, put_back and the waits. On platforms
+ * without atomic operations every type is a locked queue.
+ *
+ * @param type Which kind of queue to create
+ *
+ * @return Pointer to the newly created queue or NULL on failure.
+ */
+MMAL_QUEUE_T *mmal_queue_create_with_type(MMAL_QUEUE_TYPE_T type);
+
 /** Put a MMAL_BUFFER_HEADER_T into a queue
  *
  * @param queue  Pointer to a queue
@@ -64,6 +85,17 @@ void mmal_queue_put(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffer);
  */
 void mmal_queue_put_back(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffer);
 
+/** Put a chain of MMAL_BUFFER_HEADER_T into a queue
+ * The buffer headers are linked through their next field and the last one has
+ * a NULL next, as returned by \ref mmal_queue_get_batch. They are added in order
+ * after the ones already in the queue, with one lock and one wake-up for the
+ * whole chain.
+ *
+ * @param queue   Pointer to a queue
+ * @param buffers Pointer to the first MMAL_BUFFER_HEADER_T of the chain
+ */
+void mmal_queue_put_batch(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffers);
+
 /** Get a MMAL_BUFFER_HEADER_T from a queue
  *
  * @param queue  Pointer to a queue
@@ -72,6 +104,17 @@ void mmal_queue_put_back(MMAL_QUEUE_T *queue, MMAL_BUFFER_HEADER_T *buffer);
  */
 MMAL_BUFFER_HEADER_T *mmal_queue_get(MMAL_QUEUE_T *queue);
 
+/** Get several MMAL_BUFFER_HEADER_T from a queue at once
+ * The buffer headers are taken with one lock and returned as a chain linked
+ * through their next field, in the order they were queued.
+ *
+ * @param queue  Pointer to a queue
+ * @param max    Maximum number of buffer headers to get, 0 for all of them
+ *
+ * @return pointer to the first MMAL_BUFFER_HEADER_T of the chain or NULL if the queue is empty.
+ */
+MMAL_BUFFER_HEADER_T *mmal_queue_get_batch(MMAL_QUEUE_T *queue, unsigned int max);
+
 /** Wait for a MMAL_BUFFER_HEADER_T from a queue.
  * This is the same as a get except that this will block until a buffer header is
  * available.
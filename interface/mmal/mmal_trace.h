@@ -0,0 +1,152 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MMAL_TRACE_H
+#define MMAL_TRACE_H
+
+#include "mmal_types.h"
+#include "mmal_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \defgroup MmalTrace Buffer flow tracing
+ * The MMAL core can record what happens to buffer headers, as binary events in
+ * one ring buffer per thread. Tracing is off until mmal_trace_start() is called,
+ * and costs a single load and branch per event while it is off.
+ *
+ * The events are the sending of buffer headers to ports, the buffer header
+ * callbacks of ports, the releases of buffer headers and the queue operations.
+ * mmal_trace_write() saves the rings to a file, which the mmaltrace tool turns
+ * into Chrome trace / Perfetto JSON, with the lifetime of every buffer header
+ * and its handoffs from one thread to another.
+ *
+ * Objects are identified by their address, so a port which is destroyed and a
+ * new one allocated at the same address share their name in the trace.
+ */
+/* @{ */
+
+/** Types of trace events */
+typedef enum MMAL_TRACE_TYPE_T
+{
+   MMAL_TRACE_SEND_BEGIN,     /**< A buffer header is sent to a port, once per buffer in a chain */
+   MMAL_TRACE_SEND_END,       /**< Sending returned, arg is the status */
+   MMAL_TRACE_CALLBACK_BEGIN, /**< A port calls back with a buffer header, arg is its cmd */
+   MMAL_TRACE_CALLBACK_END,   /**< The callback returned */
+   MMAL_TRACE_RELEASE,        /**< A buffer header is released, arg is what is left of its refcount */
+   MMAL_TRACE_QUEUE_PUT,      /**< A buffer header is put in a queue, arg is 1 if put back at the front */
+   MMAL_TRACE_QUEUE_GET,      /**< A buffer header is taken from a queue */
+   MMAL_TRACE_TYPE_MAX
+} MMAL_TRACE_TYPE_T;
+
+/** Mask of all the event types for mmal_trace_start() */
+#define MMAL_TRACE_ALL ((1u << MMAL_TRACE_TYPE_MAX) - 1)
+/** Mask of an event type for mmal_trace_start() */
+#define MMAL_TRACE_MASK(type) (1u << (type))
+
+/** A trace event as stored in the rings and in trace files */
+typedef struct MMAL_TRACE_EVENT_T
+{
+   uint64_t time;     /**< CLOCK_MONOTONIC time in ns */
+   uint64_t object;   /**< Address of the port or queue, or of the pool of a released buffer header */
+   uint64_t buffer;   /**< Address of the buffer header, 0 for the _END events */
+   int64_t pts;       /**< Presentation timestamp of the buffer header */
+   uint32_t length;   /**< Length of the payload */
+   uint32_t flags;    /**< Flags of the buffer header */
+   uint32_t arg;      /**< Depends on the type, see \ref MMAL_TRACE_TYPE_T */
+   uint16_t type;     /**< One of \ref MMAL_TRACE_TYPE_T */
+   uint16_t index;    /**< Index of the buffer header in the chain it was sent or put with */
+} MMAL_TRACE_EVENT_T;
+
+/** \name Trace file
+ * A trace file is a MMAL_TRACE_FILE_HEADER_T, the names of the objects as
+ * MMAL_TRACE_NAME_T, then for each thread a MMAL_TRACE_THREAD_T followed by
+ * its events, oldest first. All in the byte order of the machine which wrote it. */
+/* @{ */
+#define MMAL_TRACE_FILE_MAGIC   MMAL_FOURCC('M','T','R','C')
+#define MMAL_TRACE_FILE_VERSION 1
+#define MMAL_TRACE_NAME_MAX     64
+
+typedef struct MMAL_TRACE_FILE_HEADER_T
+{
+   uint32_t magic;      /**< MMAL_TRACE_FILE_MAGIC */
+   uint32_t version;    /**< MMAL_TRACE_FILE_VERSION */
+   uint32_t event_size; /**< sizeof(MMAL_TRACE_EVENT_T) */
+   uint32_t pid;        /**< Process which was traced */
+   uint32_t names;      /**< Number of MMAL_TRACE_NAME_T */
+   uint32_t threads;    /**< Number of MMAL_TRACE_THREAD_T */
+} MMAL_TRACE_FILE_HEADER_T;
+
+typedef struct MMAL_TRACE_NAME_T
+{
+   uint64_t object;                  /**< Address of the object */
+   char name[MMAL_TRACE_NAME_MAX];   /**< Its name when it was first traced */
+} MMAL_TRACE_NAME_T;
+
+typedef struct MMAL_TRACE_THREAD_T
+{
+   uint32_t tid;        /**< Thread id */
+   uint32_t events;     /**< Number of events following */
+   uint64_t dropped;    /**< Older events overwritten in the ring */
+   char name[16];       /**< Name of the thread */
+} MMAL_TRACE_THREAD_T;
+/* @} */
+
+/** Start tracing.
+ * Every thread gets its own ring the first time it records an event. Starting
+ * again discards what was recorded so far.
+ *
+ * @param events Number of events in the ring of each thread, rounded up to a power
+ *               of two, 0 for the default of 16384
+ * @param mask   Event types to record, combination of MMAL_TRACE_MASK(), 0 for all
+ * @return MMAL_SUCCESS, or MMAL_ENOSYS if tracing is not available on this platform.
+ */
+MMAL_STATUS_T mmal_trace_start(unsigned int events, uint32_t mask);
+
+/** Stop tracing.
+ * The events recorded so far are kept until tracing starts again.
+ */
+void mmal_trace_stop(void);
+
+/** Write the events recorded since tracing started to a file.
+ * Tracing should be stopped first, otherwise the events being recorded while
+ * the rings are written can end up garbled in the file.
+ *
+ * @param path Name of the file
+ * @return MMAL_SUCCESS, MMAL_EIO if the file could not be written, or MMAL_ENOSYS
+ *         if tracing is not available on this platform.
+ */
+MMAL_STATUS_T mmal_trace_write(const char *path);
+
+/* @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MMAL_TRACE_H */
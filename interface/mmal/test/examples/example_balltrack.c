@@ -0,0 +1,361 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Runs the balltrack component on x86 in a graph such as
+ *    container_reader -> avcodec.video_decode -> balltrack -> null_sink
+ * or, without a file, artificial_camera -> balltrack -> null_sink, and prints
+ * the tracker results and the frame rate of the whole graph. The artificial
+ * camera renders its foosball scene, which says where the ball really is, so
+ * the results are compared against that as well. With -stats the port
+ * statistics of the core show where in the graph the time goes, and with
+ * -trace the buffer flow is traced to a file for the mmaltrace tool. */
+
+#include "mmal.h"
+#include "util/mmal_graph.h"
+#include "util/mmal_default_components.h"
+#include "util/mmal_util_params.h"
+#include "util/mmal_util.h"
+#include "util/mmal_util_stats.h"
+#include "mmal_trace.h"
+#include "interface/vcos/vcos.h"
+#include <stdio.h>
+#include <math.h>
+
+#define CHECK_STATUS(status, msg) if (status != MMAL_SUCCESS) { fprintf(stderr, msg"\n"); goto error; }
+
+#define RESULTS_BUFFER_NUM 4
+
+/** Context for our application */
+static struct CONTEXT_T {
+   VCOS_SEMAPHORE_T done;
+   MMAL_STATUS_T status;
+   unsigned int max_frames;
+   MMAL_BOOL_T verbose;
+   unsigned int stats_ms;
+
+   unsigned int frames, found;
+   unsigned int truths, misses;
+   double error_sum, error_max;
+   uint64_t track_us;
+   int64_t start, end;
+} context;
+
+/** Get the components of the graph */
+static unsigned int graph_components(MMAL_GRAPH_T *graph, MMAL_COMPONENT_T **components, unsigned int max)
+{
+   unsigned int count = 0;
+
+   while (count < max && (components[count] = mmal_graph_get_component(graph, count)) != NULL)
+      count++;
+   return count;
+}
+
+/** Collect the port statistics of buffers coming back from all the components of the graph */
+static void enable_port_stats(MMAL_GRAPH_T *graph)
+{
+   MMAL_COMPONENT_T *components[8];
+   unsigned int count = graph_components(graph, components, MMAL_COUNTOF(components));
+
+   if (mmal_util_enable_port_latency(components, count, MMAL_TRUE) != MMAL_SUCCESS)
+      fprintf(stderr, "not collecting the statistics of all ports\n");
+}
+
+/** Print the port statistics of all the components of the graph */
+static void print_port_stats(MMAL_GRAPH_T *graph, MMAL_BOOL_T reset)
+{
+   MMAL_COMPONENT_T *components[8];
+   unsigned int count = graph_components(graph, components, MMAL_COUNTOF(components));
+
+   mmal_util_dump_port_latency(stdout, components, count, reset);
+   printf("\n");
+}
+
+/** Callback from the control ports of the graph */
+static void graph_event_callback(MMAL_GRAPH_T *graph, MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer,
+   void *cb_data)
+{
+   struct CONTEXT_T *ctx = (struct CONTEXT_T *)cb_data;
+   MMAL_PARAM_UNUSED(graph);
+
+   if (buffer->cmd == MMAL_EVENT_ERROR)
+   {
+      ctx->status = *(MMAL_STATUS_T *)buffer->data;
+      fprintf(stderr, "error %i from %s\n", ctx->status, port->name);
+      vcos_semaphore_post(&ctx->done);
+   }
+   else if (buffer->cmd == MMAL_EVENT_EOS)
+   {
+      vcos_semaphore_post(&ctx->done);
+   }
+   mmal_buffer_header_release(buffer);
+}
+
+/** Callback from the results port of the balltrack component */
+static void results_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
+{
+   struct CONTEXT_T *ctx = (struct CONTEXT_T *)port->userdata;
+   MMAL_METADATA_BALLTRACK_T *result;
+   MMAL_BOOL_T done = MMAL_FALSE;
+
+   mmal_buffer_header_mem_lock(buffer);
+   result = (MMAL_METADATA_BALLTRACK_T *)mmal_metadata_get(buffer, MMAL_METADATA_BALLTRACK);
+   if (result)
+   {
+      if (!ctx->frames)
+         ctx->start = vcos_getmicrosecs64();
+      ctx->end = vcos_getmicrosecs64();
+      ctx->frames++;
+      ctx->track_us += result->track_us;
+      if (result->flags & MMAL_METADATA_BALLTRACK_FLAG_FOUND)
+         ctx->found++;
+      if ((result->flags & MMAL_METADATA_BALLTRACK_FLAG_TRUTH) &&
+          (result->flags & MMAL_METADATA_BALLTRACK_FLAG_ANALYSED))
+      {
+         ctx->truths++;
+         if (result->flags & MMAL_METADATA_BALLTRACK_FLAG_FOUND)
+         {
+            double error = hypot(result->x - result->truth_x, result->y - result->truth_y);
+            ctx->error_sum += error;
+            ctx->error_max = MMAL_MAX(ctx->error_max, error);
+         }
+         else
+            ctx->misses++;
+      }
+      if (ctx->verbose)
+         fprintf(stderr, "pts %lld: %s %.3f %.3f, %u us\n", (long long)result->pts,
+                 result->flags & MMAL_METADATA_BALLTRACK_FLAG_FOUND ? "ball" : "none",
+                 result->x, result->y, result->track_us);
+   }
+   mmal_buffer_header_mem_unlock(buffer);
+
+   if ((buffer->flags & MMAL_BUFFER_HEADER_FLAG_EOS) ||
+       (ctx->max_frames && ctx->frames == ctx->max_frames))
+      done = MMAL_TRUE;
+
+   /* Send the buffer back for the next result. The flush on disable gives it
+    * back as it is so it must not carry this one any more. */
+   mmal_buffer_header_reset(buffer);
+   if (port->is_enabled && mmal_port_send_buffer(port, buffer) != MMAL_SUCCESS)
+      mmal_buffer_header_release(buffer);
+
+   if (done)
+      vcos_semaphore_post(&ctx->done);
+}
+
+int main(int argc, char **argv)
+{
+   MMAL_STATUS_T status = MMAL_EINVAL;
+   MMAL_GRAPH_T *graph = 0;
+   MMAL_COMPONENT_T *source = 0, *decoder = 0, *tracker = 0, *sink = 0;
+   MMAL_POOL_T *pool = 0;
+   MMAL_PORT_T *results;
+   const char *uri = NULL, *decoder_name = "avcodec.video_decode", *trace_path = NULL;
+   MMAL_PARAMETER_ARTIFICIAL_SCENE_T scene = {{MMAL_PARAMETER_ARTIFICIAL_SCENE, sizeof(scene)},
+      MMAL_PARAM_ARTIFICIAL_SCENE_FOOSBALL, 0, 60, 0, 0, 100, 0, MMAL_FALSE};
+   int fps = 30;
+   MMAL_BUFFER_HEADER_T *buffer;
+   int i;
+
+   context.max_frames = 100;
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-frames") && i + 1 < argc)
+         context.max_frames = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-decoder") && i + 1 < argc)
+         decoder_name = argv[++i];
+      else if (!strcmp(argv[i], "-fps") && i + 1 < argc)
+         fps = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-seed") && i + 1 < argc)
+         scene.seed = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-speed") && i + 1 < argc)
+         scene.ball_speed = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-noise") && i + 1 < argc)
+         scene.noise = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-blur") && i + 1 < argc)
+         scene.exposure = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-light") && i + 1 < argc)
+         scene.brightness = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-vignetting") && i + 1 < argc)
+         scene.vignetting = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-stats") && i + 1 < argc)
+         context.stats_ms = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-trace") && i + 1 < argc)
+         trace_path = argv[++i];
+      else if (!strcmp(argv[i], "-v"))
+         context.verbose = MMAL_TRUE;
+      else if (argv[i][0] != '-')
+         uri = argv[i];
+      else
+      {
+         fprintf(stderr, "usage: %s [-frames N] [-decoder NAME] [-stats MS] [-trace FILE] [-v] [uri]\n"
+                 "scene of the artificial camera without an uri:\n"
+                 "  [-fps N, 0 for as fast as possible] [-seed N] [-speed PERCENT_PER_SECOND]\n"
+                 "  [-noise LEVELS] [-blur EXPOSURE_PERCENT] [-light PERCENT] [-vignetting PERCENT]\n",
+                 argv[0]);
+         return -1;
+      }
+   }
+
+   vcos_semaphore_create(&context.done, "example", 0);
+
+   /* Create the graph */
+   status = mmal_graph_create(&graph, 0);
+   CHECK_STATUS(status, "failed to create graph");
+
+   /* Add the components */
+   if (uri)
+   {
+      status = mmal_graph_new_component(graph, MMAL_COMPONENT_DEFAULT_CONTAINER_READER, &source);
+      CHECK_STATUS(status, "failed to create reader");
+      status = mmal_graph_new_component(graph, decoder_name, &decoder);
+      CHECK_STATUS(status, "failed to create decoder");
+      status = mmal_util_port_set_uri(source->control, uri);
+      CHECK_STATUS(status, "failed to set uri");
+   }
+   else
+   {
+      /* The tracker needs frames of the camera size */
+      status = mmal_graph_new_component(graph, "artificial_camera", &source);
+      CHECK_STATUS(status, "failed to create camera");
+      source->output[0]->format->es->video.width = 1280;
+      source->output[0]->format->es->video.height = 720;
+      source->output[0]->format->es->video.frame_rate.num = fps > 0 ? fps : 30;
+      source->output[0]->format->es->video.frame_rate.den = 1;
+      status = mmal_port_format_commit(source->output[0]);
+      CHECK_STATUS(status, "failed to set camera format");
+      scene.free_running = fps <= 0;
+      status = mmal_port_parameter_set(source->output[0], &scene.hdr);
+      CHECK_STATUS(status, "failed to set camera scene");
+   }
+
+   status = mmal_graph_new_component(graph, "balltrack", &tracker);
+   CHECK_STATUS(status, "failed to create balltrack");
+   status = mmal_graph_new_component(graph, "null_sink", &sink);
+   CHECK_STATUS(status, "failed to create sink");
+
+   /* connect them up - this propagates port settings from outputs to inputs */
+   if (decoder)
+   {
+      status = mmal_graph_new_connection(graph, source->output[0], decoder->input[0], 0, NULL);
+      CHECK_STATUS(status, "failed to connect reader to decoder");
+      status = mmal_graph_new_connection(graph, decoder->output[0], tracker->input[0], 0, NULL);
+      CHECK_STATUS(status, "failed to connect decoder to balltrack");
+   }
+   else
+   {
+      status = mmal_graph_new_connection(graph, source->output[0], tracker->input[0], 0, NULL);
+      CHECK_STATUS(status, "failed to connect camera to balltrack");
+   }
+   status = mmal_graph_new_connection(graph, tracker->output[0], sink->input[0], 0, NULL);
+   CHECK_STATUS(status, "failed to connect balltrack to sink");
+
+   /* The results port isn't connected, we read the results ourselves */
+   results = tracker->output[1];
+   results->buffer_num = MMAL_MAX(results->buffer_num_recommended, RESULTS_BUFFER_NUM);
+   results->buffer_size = results->buffer_size_recommended;
+   pool = mmal_port_pool_create(results, results->buffer_num, results->buffer_size);
+   if (!pool)
+   {
+      status = MMAL_ENOMEM;
+      CHECK_STATUS(status, "failed to create results pool");
+   }
+   results->userdata = (void *)&context;
+   status = mmal_port_enable(results, results_callback);
+   CHECK_STATUS(status, "failed to enable results port");
+   while ((buffer = mmal_queue_get(pool->queue)) != NULL)
+   {
+      status = mmal_port_send_buffer(results, buffer);
+      CHECK_STATUS(status, "failed to send results buffer");
+   }
+
+   if (trace_path && mmal_trace_start(0, 0) != MMAL_SUCCESS)
+      fprintf(stderr, "tracing not available\n");
+
+   if (context.stats_ms)
+      enable_port_stats(graph);
+
+   /* Start processing */
+   fprintf(stderr, "start tracking\n");
+   status = mmal_graph_enable(graph, graph_event_callback, &context);
+   CHECK_STATUS(status, "failed to enable graph");
+
+   if (context.stats_ms)
+   {
+      while (vcos_semaphore_wait_timeout(&context.done, context.stats_ms) != VCOS_SUCCESS)
+         print_port_stats(graph, MMAL_TRUE);
+   }
+   else
+      vcos_semaphore_wait(&context.done);
+
+   /* Stop everything */
+   mmal_graph_disable(graph);
+   mmal_port_disable(results);
+   status = context.status;
+
+   if (trace_path)
+   {
+      mmal_trace_stop();
+      if (mmal_trace_write(trace_path) == MMAL_SUCCESS)
+         fprintf(stderr, "trace written to %s\n", trace_path);
+   }
+
+   if (context.frames)
+   {
+      double seconds = (context.end - context.start) / 1000000.0;
+      printf("%u frames, ball found in %u, %.2f ms tracking per frame", context.frames, context.found,
+             context.track_us / 1000.0 / context.frames);
+      if (context.frames > 1 && seconds > 0)
+         printf(", %.1f fps end to end", (context.frames - 1) / seconds);
+      printf("\n");
+      if (context.truths)
+      {
+         unsigned int hits = context.truths - context.misses;
+         printf("ground truth: %u missed of %u, mean error %.4f, max %.4f\n", context.misses,
+                context.truths, hits ? context.error_sum / hits : 0.0, context.error_max);
+      }
+   }
+   if (context.stats_ms)
+      print_port_stats(graph, MMAL_FALSE);
+
+ error:
+   /* Cleanup everything */
+   if (source)
+      mmal_component_release(source);
+   if (decoder)
+      mmal_component_release(decoder);
+   if (tracker)
+      mmal_component_release(tracker);
+   if (sink)
+      mmal_component_release(sink);
+   if (graph)
+      mmal_graph_destroy(graph);
+   if (pool)
+      mmal_pool_destroy(pool);
+   vcos_semaphore_delete(&context.done);
+
+   return status == MMAL_SUCCESS ? 0 : -1;
+}
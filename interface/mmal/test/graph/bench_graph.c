@@ -0,0 +1,250 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Benchmark for the threads of mmal_graph_set_threads. The graph
+ *    container_reader -> decoder -> copy -> null_sink
+ * or, without an uri, artificial_camera -> copy -> copy -> null_sink, runs
+ * with 1 up to N threads moving the buffers between the components, and
+ * every run prints the frame rate at the sink and the speed-up over the
+ * single worker thread. The components do their own processing on their
+ * action threads either way, the threads of the graph only move the buffers,
+ * so the speed-up is that of the hand-offs. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "mmal.h"
+#include "util/mmal_graph.h"
+#include "util/mmal_default_components.h"
+#include "util/mmal_util_params.h"
+#include "interface/vcos/vcos.h"
+
+#define CHECK_STATUS(status, msg) if (status != MMAL_SUCCESS) { fprintf(stderr, msg"\n"); goto error; }
+
+/* Frames of the artificial camera */
+#define BENCH_WIDTH  1280
+#define BENCH_HEIGHT 720
+
+/* Give up on a run which doesn't get its frames */
+#define RUN_TIMEOUT_MS 60000
+
+typedef struct
+{
+   VCOS_SEMAPHORE_T done;
+   VCOS_MUTEX_T lock;
+   MMAL_CONNECTION_T *last;   /* connection into the sink */
+   unsigned int frames, max_frames;
+   int64_t start, end;
+   MMAL_STATUS_T status;
+} BENCH_T;
+
+static long context_switches(void)
+{
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+   return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+static void graph_event_callback(MMAL_GRAPH_T *graph, MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer,
+   void *cb_data)
+{
+   BENCH_T *bench = (BENCH_T *)cb_data;
+   MMAL_PARAM_UNUSED(graph);
+
+   if (buffer->cmd == MMAL_EVENT_ERROR)
+   {
+      bench->status = *(MMAL_STATUS_T *)buffer->data;
+      fprintf(stderr, "error %i from %s\n", bench->status, port->name);
+      vcos_semaphore_post(&bench->done);
+   }
+   else if (buffer->cmd == MMAL_EVENT_EOS)
+   {
+      vcos_semaphore_post(&bench->done);
+   }
+   mmal_buffer_header_release(buffer);
+}
+
+/** Counts the frames going into the sink */
+static MMAL_STATUS_T graph_connection_buffer(MMAL_GRAPH_T *graph, MMAL_CONNECTION_T *connection,
+   MMAL_BUFFER_HEADER_T *buffer)
+{
+   BENCH_T *bench = *(BENCH_T **)graph->userdata;
+
+   if (connection != bench->last || buffer->cmd)
+      return MMAL_ENOSYS;
+
+   vcos_mutex_lock(&bench->lock);
+   if (!bench->frames)
+      bench->start = vcos_getmicrosecs64();
+   if (bench->frames++ < bench->max_frames)
+      bench->end = vcos_getmicrosecs64();
+   if (bench->frames == bench->max_frames)
+      vcos_semaphore_post(&bench->done);
+   vcos_mutex_unlock(&bench->lock);
+   return MMAL_ENOSYS;
+}
+
+/** Runs the graph once, returns the frame rate */
+static double run(const char *uri, const char *decoder_name, unsigned int threads, unsigned int frames,
+   long *switches)
+{
+   MMAL_STATUS_T status;
+   MMAL_GRAPH_T *graph = 0;
+   MMAL_COMPONENT_T *source = 0, *middle = 0, *copy = 0, *sink = 0;
+   BENCH_T bench;
+   double fps = 0.0;
+   long switches_start = context_switches();
+
+   memset(&bench, 0, sizeof(bench));
+   bench.max_frames = frames;
+   vcos_semaphore_create(&bench.done, "bench", 0);
+   vcos_mutex_create(&bench.lock, "bench");
+
+   status = mmal_graph_create(&graph, sizeof(BENCH_T *));
+   CHECK_STATUS(status, "failed to create graph");
+   *(BENCH_T **)graph->userdata = &bench;
+   graph->pf_connection_buffer = graph_connection_buffer;
+   status = mmal_graph_set_threads(graph, threads);
+   CHECK_STATUS(status, "failed to set the threads");
+
+   if (uri)
+   {
+      status = mmal_graph_new_component(graph, MMAL_COMPONENT_DEFAULT_CONTAINER_READER, &source);
+      CHECK_STATUS(status, "failed to create reader");
+      status = mmal_util_port_set_uri(source->control, uri);
+      CHECK_STATUS(status, "failed to set uri");
+      status = mmal_graph_new_component(graph, decoder_name, &middle);
+      CHECK_STATUS(status, "failed to create decoder");
+   }
+   else
+   {
+      MMAL_PARAMETER_ARTIFICIAL_SCENE_T scene = {{MMAL_PARAMETER_ARTIFICIAL_SCENE, sizeof(scene)},
+         MMAL_PARAM_ARTIFICIAL_SCENE_PATTERN, 0, 0, 0, 0, 100, 0, MMAL_TRUE};
+
+      status = mmal_graph_new_component(graph, "artificial_camera", &source);
+      CHECK_STATUS(status, "failed to create camera");
+      source->output[0]->format->es->video.width = BENCH_WIDTH;
+      source->output[0]->format->es->video.height = BENCH_HEIGHT;
+      status = mmal_port_format_commit(source->output[0]);
+      CHECK_STATUS(status, "failed to set camera format");
+      status = mmal_port_parameter_set(source->output[0], &scene.hdr);
+      CHECK_STATUS(status, "failed to set camera scene");
+      status = mmal_graph_new_component(graph, "copy", &middle);
+      CHECK_STATUS(status, "failed to create copy");
+   }
+   status = mmal_graph_new_component(graph, "copy", &copy);
+   CHECK_STATUS(status, "failed to create copy");
+   status = mmal_graph_new_component(graph, "null_sink", &sink);
+   CHECK_STATUS(status, "failed to create sink");
+
+   status = mmal_graph_new_connection(graph, source->output[0], middle->input[0], 0, NULL);
+   CHECK_STATUS(status, "failed to connect the source");
+   status = mmal_graph_new_connection(graph, middle->output[0], copy->input[0], 0, NULL);
+   CHECK_STATUS(status, "failed to connect the copy");
+   status = mmal_graph_new_connection(graph, copy->output[0], sink->input[0], 0, &bench.last);
+   CHECK_STATUS(status, "failed to connect the sink");
+
+   status = mmal_graph_enable(graph, graph_event_callback, &bench);
+   CHECK_STATUS(status, "failed to enable graph");
+   if (vcos_semaphore_wait_timeout(&bench.done, RUN_TIMEOUT_MS) != VCOS_SUCCESS)
+      fprintf(stderr, "timed out after %u frames\n", bench.frames);
+   mmal_graph_disable(graph);
+
+   if (bench.status == MMAL_SUCCESS && bench.frames > 1 && bench.end > bench.start)
+      fps = (MMAL_MIN(bench.frames, frames) - 1) * 1000000.0 / (bench.end - bench.start);
+   *switches = context_switches() - switches_start;
+
+ error:
+   if (source)
+      mmal_component_release(source);
+   if (middle)
+      mmal_component_release(middle);
+   if (copy)
+      mmal_component_release(copy);
+   if (sink)
+      mmal_component_release(sink);
+   if (graph)
+      mmal_graph_destroy(graph);
+   vcos_mutex_delete(&bench.lock);
+   vcos_semaphore_delete(&bench.done);
+   return fps;
+}
+
+static void usage(const char *name)
+{
+   fprintf(stderr, "usage: %s [-frames N] [-threads MAX] [-decoder NAME] [uri]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+   const char *uri = NULL, *decoder_name = "avcodec.video_decode";
+   unsigned int frames = 1000, threads = 4, i;
+   double base = 0.0;
+   int j;
+
+   for (j = 1; j < argc; j++)
+   {
+      if (!strcmp(argv[j], "-frames") && j + 1 < argc)
+         frames = atoi(argv[++j]);
+      else if (!strcmp(argv[j], "-threads") && j + 1 < argc)
+         threads = atoi(argv[++j]);
+      else if (!strcmp(argv[j], "-decoder") && j + 1 < argc)
+         decoder_name = argv[++j];
+      else if (argv[j][0] != '-')
+         uri = argv[j];
+      else
+      {
+         usage(argv[0]);
+         return 1;
+      }
+   }
+   if (frames < 2 || !threads)
+   {
+      usage(argv[0]);
+      return 1;
+   }
+
+   vcos_init();
+   printf("threads   frames        fps  speed-up  switches/frame\n");
+   for (i = 1; i <= threads; i++)
+   {
+      long switches = 0;
+      double fps = run(uri, decoder_name, i, frames, &switches);
+
+      if (fps <= 0.0)
+      {
+         printf("%7u   failed\n", i);
+         return 1;
+      }
+      if (i == 1)
+         base = fps;
+      printf("%7u %8u %10.1f %9.2f %15.1f\n", i, frames, fps, fps / base, (double)switches / frames);
+   }
+   return 0;
+}
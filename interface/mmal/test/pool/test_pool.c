@@ -0,0 +1,274 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Test for the payload arena of mmal_pool_create_arena. The payloads have to
+ * be aligned to the stride, one after the other in the arena without
+ * overlapping, and still so after mmal_pool_resize; the statistics have to
+ * add up, and a shared arena has to be visible through a second mapping of
+ * its memfd, as another process would see it. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "mmal.h"
+#include "mmal_pool.h"
+#include "interface/vcos/vcos.h"
+#include "../test_check.h"
+
+/* Checks that the payloads follow each other in the arena and fills each
+ * with its index, then checks no payload overwrote another */
+static void check_payloads(MMAL_POOL_T *pool, const char *name)
+{
+   MMAL_POOL_STATS_T stats;
+   unsigned int i;
+   uint32_t j;
+
+   mmal_pool_get_stats(pool, &stats);
+   for (i = 0; i < pool->headers_num; i++)
+   {
+      MMAL_BUFFER_HEADER_T *buffer = pool->header[i];
+      CHECK(buffer->data == stats.arena_base + (size_t)i * stats.payload_stride,
+            "%s: payload %u at offset %ld, stride %u", name, i,
+            (long)(buffer->data - stats.arena_base), stats.payload_stride);
+      CHECK(((uintptr_t)buffer->data & (MMAL_POOL_ARENA_ALIGN - 1)) == 0, "%s: payload %u misaligned", name, i);
+      CHECK(buffer->alloc_size == stats.payload_size, "%s: payload %u of %u bytes", name, i, buffer->alloc_size);
+      CHECK(buffer->data + buffer->alloc_size <= stats.arena_base + stats.arena_size,
+            "%s: payload %u beyond the arena", name, i);
+      memset(buffer->data, i + 1, buffer->alloc_size);
+   }
+   for (i = 0; i < pool->headers_num; i++)
+   {
+      MMAL_BUFFER_HEADER_T *buffer = pool->header[i];
+      for (j = 0; j < buffer->alloc_size; j++)
+         if (buffer->data[j] != (uint8_t)(i + 1))
+            break;
+      CHECK(j == buffer->alloc_size, "%s: payload %u overwritten at %u", name, i, j);
+   }
+}
+
+static void check_stats(MMAL_POOL_T *pool, unsigned int headers, uint32_t payload_size, const char *name)
+{
+   MMAL_POOL_STATS_T stats;
+
+   CHECK(mmal_pool_get_stats(pool, &stats) == MMAL_SUCCESS, "%s: no stats", name);
+   CHECK(stats.headers_num == headers && stats.payload_size == payload_size,
+         "%s: %u headers of %u bytes", name, stats.headers_num, stats.payload_size);
+   CHECK(stats.bytes_allocated == (uint64_t)headers * payload_size, "%s: %llu bytes allocated", name,
+         (unsigned long long)stats.bytes_allocated);
+   CHECK(stats.arena_size >= (uint64_t)headers * stats.payload_stride, "%s: arena of %llu bytes too small", name,
+         (unsigned long long)stats.arena_size);
+   CHECK(stats.bytes_wasted == stats.arena_size - stats.bytes_allocated, "%s: %llu bytes wasted", name,
+         (unsigned long long)stats.bytes_wasted);
+}
+
+static void test_default_pool(void)
+{
+   MMAL_POOL_T *pool = mmal_pool_create(3, 1000);
+   MMAL_POOL_STATS_T stats;
+   MMAL_BUFFER_HEADER_T *buffer;
+
+   CHECK(pool != NULL, "default: unable to create the pool");
+   if (!pool)
+      return;
+
+   buffer = mmal_queue_get(pool->queue);
+   mmal_pool_get_stats(pool, &stats);
+   CHECK(stats.headers_num == 3 && stats.headers_in_use == 1, "default: %u of %u headers in use",
+         stats.headers_in_use, stats.headers_num);
+   CHECK(stats.bytes_allocated == 3000 && stats.bytes_in_use == 1000, "default: %llu of %llu bytes in use",
+         (unsigned long long)stats.bytes_in_use, (unsigned long long)stats.bytes_allocated);
+   CHECK(stats.arena_fd == -1 && !stats.arena_base && !stats.arena_size && !stats.payload_stride &&
+         !stats.bytes_wasted, "default: arena stats without arena");
+   mmal_buffer_header_release(buffer);
+   mmal_pool_destroy(pool);
+}
+
+static void test_arena(uint32_t flags, const char *name)
+{
+   uint32_t align = (flags & MMAL_POOL_ARENA_PAGE_STRIDE) ? (uint32_t)sysconf(_SC_PAGESIZE) : MMAL_POOL_ARENA_ALIGN;
+   MMAL_POOL_T *pool = mmal_pool_create_arena(5, 1000, flags);
+   MMAL_POOL_STATS_T stats;
+   MMAL_BUFFER_HEADER_T *buffer;
+   uint8_t *base;
+
+   CHECK(pool != NULL, "%s: unable to create the pool", name);
+   if (!pool)
+      return;
+
+   mmal_pool_get_stats(pool, &stats);
+   CHECK(stats.payload_stride == (1000 + align - 1) / align * align, "%s: stride %u", name, stats.payload_stride);
+   CHECK(((uintptr_t)stats.arena_base & (sysconf(_SC_PAGESIZE) - 1)) == 0, "%s: arena not on a page", name);
+   CHECK((stats.arena_flags & MMAL_POOL_ARENA_PAGE_STRIDE) == (flags & MMAL_POOL_ARENA_PAGE_STRIDE),
+         "%s: arena flags %x", name, stats.arena_flags);
+   CHECK(!(stats.arena_flags & ~flags), "%s: arena got flags %x it did not ask for", name, stats.arena_flags);
+   check_stats(pool, 5, 1000, name);
+   check_payloads(pool, name);
+
+   buffer = mmal_queue_get(pool->queue);
+   mmal_pool_get_stats(pool, &stats);
+   CHECK(stats.headers_in_use == 1 && stats.bytes_in_use == 1000, "%s: %u headers in use", name,
+         stats.headers_in_use);
+   mmal_buffer_header_release(buffer);
+
+   /* Same size again, nothing to do */
+   base = stats.arena_base;
+   CHECK(mmal_pool_resize(pool, 5, 1000) == MMAL_SUCCESS, "%s: resize to the same size failed", name);
+   mmal_pool_get_stats(pool, &stats);
+   CHECK(stats.arena_base == base, "%s: arena moved without resize", name);
+
+   /* Fewer, smaller payloads which still use most of the arena stay in it */
+   CHECK(mmal_pool_resize(pool, 4, 1000) == MMAL_SUCCESS, "%s: resize to 4 headers failed", name);
+   check_stats(pool, 4, 1000, name);
+   check_payloads(pool, name);
+
+   /* More and bigger payloads need a bigger arena */
+   CHECK(mmal_pool_resize(pool, 8, 300000) == MMAL_SUCCESS, "%s: resize to 8 headers failed", name);
+   CHECK(mmal_queue_length(pool->queue) == 8, "%s: %u headers queued after resize", name,
+         mmal_queue_length(pool->queue));
+   check_stats(pool, 8, 300000, name);
+   check_payloads(pool, name);
+
+   /* Much smaller payloads get a smaller arena, so little of it is wasted, unless
+    * the arena is a memfd another process may have mapped */
+   CHECK(mmal_pool_resize(pool, 8, 5000) == MMAL_SUCCESS, "%s: resize to 5000 bytes failed", name);
+   check_stats(pool, 8, 5000, name);
+   check_payloads(pool, name);
+   mmal_pool_get_stats(pool, &stats);
+   CHECK(stats.arena_size <= 2 * (uint64_t)stats.payload_stride * stats.headers_num ||
+         (stats.arena_flags & (MMAL_POOL_ARENA_HUGE_PAGES | MMAL_POOL_ARENA_SHARED)), "%s: arena of %llu bytes for %u * %u bytes", name,
+         (unsigned long long)stats.arena_size, stats.headers_num, stats.payload_stride);
+   printf("%s: %u * %u bytes, stride %u, arena %llu bytes, %.1f%% fragmentation, flags %x\n", name,
+          stats.headers_num, stats.payload_size, stats.payload_stride, (unsigned long long)stats.arena_size,
+          stats.arena_size ? 100.0 * stats.bytes_wasted / stats.arena_size : 0.0, stats.arena_flags);
+
+   /* No payloads at all */
+   CHECK(mmal_pool_resize(pool, 2, 0) == MMAL_SUCCESS, "%s: resize to no payload failed", name);
+   CHECK(pool->header[0]->data == NULL && pool->header[1]->data == NULL, "%s: payload of 0 bytes", name);
+   mmal_pool_get_stats(pool, &stats);
+   CHECK(stats.payload_stride == 0 && stats.bytes_allocated == 0, "%s: stride %u without payloads", name,
+         stats.payload_stride);
+
+   CHECK(mmal_pool_resize(pool, 3, 1000) == MMAL_SUCCESS, "%s: resize after no payload failed", name);
+   check_stats(pool, 3, 1000, name);
+   check_payloads(pool, name);
+
+   mmal_pool_destroy(pool);
+}
+
+static void test_shared(uint32_t flags)
+{
+   MMAL_POOL_T *pool = mmal_pool_create_arena(4, 100000, MMAL_POOL_ARENA_SHARED | flags);
+   MMAL_POOL_STATS_T stats;
+   uint64_t arena_size;
+   uint8_t *peer;
+   int fd;
+
+   CHECK(pool != NULL, "shared: unable to create the pool");
+   if (!pool)
+      return;
+
+   mmal_pool_get_stats(pool, &stats);
+   if (!(stats.arena_flags & MMAL_POOL_ARENA_SHARED))
+   {
+      CHECK(stats.arena_fd == -1, "shared: fd %d without shared arena", stats.arena_fd);
+      printf("shared: no memfd on this system, arena is private\n");
+      mmal_pool_destroy(pool);
+      return;
+   }
+   CHECK(stats.arena_fd >= 0, "shared: no fd");
+   fd = stats.arena_fd;
+
+   /* What another process would do with the fd and the payload offsets */
+   peer = mmap(NULL, stats.arena_size, PROT_READ, MAP_SHARED, fd, 0);
+   CHECK(peer != MAP_FAILED, "shared: unable to map the fd");
+   if (peer != MAP_FAILED)
+   {
+      MMAL_BUFFER_HEADER_T *buffer = pool->header[2];
+      memcpy(buffer->data, "ball", 5);
+      CHECK(!memcmp(peer + (buffer->data - stats.arena_base), "ball", 5), "shared: payload not in the fd");
+      munmap(peer, stats.arena_size);
+   }
+
+   /* Growing keeps the fd, the peer maps it again with the new size */
+   CHECK(mmal_pool_resize(pool, 16, 400000) == MMAL_SUCCESS, "shared: resize failed");
+   mmal_pool_get_stats(pool, &stats);
+   CHECK(stats.arena_fd == fd && (stats.arena_flags & MMAL_POOL_ARENA_SHARED), "shared: fd %d after resize, was %d",
+         stats.arena_fd, fd);
+   check_stats(pool, 16, 400000, "shared");
+   check_payloads(pool, "shared");
+   peer = mmap(NULL, stats.arena_size, PROT_READ, MAP_SHARED, fd, 0);
+   CHECK(peer != MAP_FAILED, "shared: unable to map the fd after resize");
+   if (peer != MAP_FAILED)
+   {
+      MMAL_BUFFER_HEADER_T *buffer = pool->header[15];
+      CHECK(peer[buffer->data - stats.arena_base + buffer->alloc_size - 1] == 16, "shared: last payload not in the fd");
+      munmap(peer, stats.arena_size);
+   }
+
+   /* Shrinking keeps the whole memfd and mapping, the peer mapping stays valid */
+   peer = mmap(NULL, stats.arena_size, PROT_READ, MAP_SHARED, fd, 0);
+   CHECK(peer != MAP_FAILED, "shared: unable to map the fd before shrinking");
+   arena_size = stats.arena_size;
+   CHECK(mmal_pool_resize(pool, 2, 1000) == MMAL_SUCCESS, "shared: shrink failed");
+   mmal_pool_get_stats(pool, &stats);
+   CHECK(stats.arena_fd == fd && stats.arena_size == arena_size, "shared: arena of %llu bytes, fd %d after shrink, was %llu, fd %d",
+         (unsigned long long)stats.arena_size, stats.arena_fd, (unsigned long long)arena_size, fd);
+   check_payloads(pool, "shared shrunk");
+   if (peer != MAP_FAILED)
+   {
+      MMAL_BUFFER_HEADER_T *buffer = pool->header[1];
+      memcpy(buffer->data, "goal", 5);
+      CHECK(!memcmp(peer + (buffer->data - stats.arena_base), "goal", 5), "shared: payload not in the fd after shrink");
+      /* Would fault if the memfd had been truncated */
+      CHECK(peer[arena_size - 1] == stats.arena_base[arena_size - 1], "shared: end of the fd differs");
+      munmap(peer, arena_size);
+   }
+
+   printf("shared: %u * %u bytes, arena %llu bytes, fd %d, flags %x\n", stats.headers_num, stats.payload_size,
+          (unsigned long long)stats.arena_size, stats.arena_fd, stats.arena_flags);
+   mmal_pool_destroy(pool);
+}
+
+int main(int argc, char **argv)
+{
+   MMAL_PARAM_UNUSED(argc);
+   MMAL_PARAM_UNUSED(argv);
+   vcos_init();
+
+   test_default_pool();
+   test_arena(0, "cache line");
+   test_arena(MMAL_POOL_ARENA_PAGE_STRIDE, "page");
+   test_arena(MMAL_POOL_ARENA_HUGE_PAGES, "huge pages");
+   test_arena(MMAL_POOL_ARENA_SHARED | MMAL_POOL_ARENA_PAGE_STRIDE, "shared page");
+   test_shared(0);
+   test_shared(MMAL_POOL_ARENA_HUGE_PAGES);
+
+   return test_result();
+}
@@ -0,0 +1,190 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Microbenchmark for the queue types of mmal_queue_create_with_type. Buffers
+ * go round between a pool queue per producer and one port queue, the way
+ * they do between a pool and a component, and every case prints the time per
+ * put/get pair and the context switches per thousand pairs:
+ *  - uncontended: one thread puts and gets on its own, one buffer at a time
+ *    or the whole pool at once with put_batch and get_batch
+ *  - N producers: N threads put into the port queue, one consumer waits on it
+ *    and puts each buffer back into the pool queue of its producer */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "mmal.h"
+#include "mmal_queue.h"
+#include "interface/vcos/vcos.h"
+
+#define BENCH_POOL_SIZE   16
+#define BENCH_MAX_THREADS 16
+
+typedef struct
+{
+   MMAL_QUEUE_T *port;
+   MMAL_QUEUE_T *pool;
+   MMAL_BUFFER_HEADER_T buffers[BENCH_POOL_SIZE];
+   unsigned int id;
+   unsigned int count;
+   VCOS_THREAD_T thread;
+} PRODUCER_T;
+
+static long context_switches(void)
+{
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+   return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+static void *producer_thread(void *arg)
+{
+   PRODUCER_T *producer = (PRODUCER_T *)arg;
+   unsigned int i;
+
+   for (i = 0; i < producer->count; i++)
+   {
+      MMAL_BUFFER_HEADER_T *buffer = mmal_queue_wait(producer->pool);
+      buffer->offset = producer->id;
+      mmal_queue_put(producer->port, buffer);
+   }
+   return NULL;
+}
+
+static void bench(MMAL_QUEUE_TYPE_T type, unsigned int threads, unsigned int count, int batch)
+{
+   PRODUCER_T *producers = calloc(threads ? threads : 1, sizeof(*producers));
+   MMAL_QUEUE_T *port = mmal_queue_create_with_type(type);
+   unsigned int i, j, pairs;
+   int64_t start, elapsed;
+   long switches;
+
+   if (!producers || !port)
+      goto end;
+   for (i = 0; i < (threads ? threads : 1); i++)
+   {
+      producers[i].port = port;
+      producers[i].pool = mmal_queue_create_with_type(type);
+      producers[i].id = i;
+      producers[i].count = count / (threads ? threads : 1);
+      if (!producers[i].pool)
+         goto end;
+      for (j = 0; j < BENCH_POOL_SIZE; j++)
+         mmal_queue_put(producers[i].pool, &producers[i].buffers[j]);
+   }
+
+   switches = context_switches();
+   start = vcos_getmicrosecs64();
+   if (batch)
+   {
+      for (i = 0; i < producers->count / BENCH_POOL_SIZE; i++)
+      {
+         mmal_queue_put_batch(port, mmal_queue_get_batch(producers->pool, 0));
+         mmal_queue_put_batch(producers->pool, mmal_queue_get_batch(port, 0));
+      }
+      pairs = 2 * i * BENCH_POOL_SIZE;
+   }
+   else if (!threads)
+   {
+      for (i = 0; i < producers->count; i++)
+      {
+         mmal_queue_put(port, mmal_queue_get(producers->pool));
+         mmal_queue_put(producers->pool, mmal_queue_get(port));
+      }
+      pairs = 2 * producers->count;
+   }
+   else
+   {
+      for (i = 0; i < threads; i++)
+         vcos_thread_create(&producers[i].thread, "producer", NULL, producer_thread, &producers[i]);
+      pairs = 0;
+      for (i = 0; i < threads * producers->count; i++)
+      {
+         MMAL_BUFFER_HEADER_T *buffer = mmal_queue_wait(port);
+         mmal_queue_put(producers[buffer->offset].pool, buffer);
+      }
+      for (i = 0; i < threads; i++)
+         vcos_thread_join(&producers[i].thread, NULL);
+      pairs = 2 * threads * producers->count;
+   }
+   elapsed = vcos_getmicrosecs64() - start;
+   switches = context_switches() - switches;
+
+   printf("%-6s %-5s %9u %8u %10.1f %12.2f\n", type == MMAL_QUEUE_TYPE_MPSC ? "mpsc" : "locked",
+          batch ? "batch" : "", threads, pairs,
+          elapsed * 1000.0 / pairs, switches * 1000.0 / pairs);
+
+end:
+   for (i = 0; producers && i < (threads ? threads : 1); i++)
+      mmal_queue_destroy(producers[i].pool);
+   mmal_queue_destroy(port);
+   free(producers);
+}
+
+static void usage(const char *name)
+{
+   printf("Usage: %s [-count N] [-threads N]\n"
+          "  -count N    Buffers sent per case, 1000000 by default\n"
+          "  -threads N  Most producer threads, 4 by default\n", name);
+}
+
+int main(int argc, char **argv)
+{
+   unsigned int count = 1000000, threads = 4, i;
+   int j;
+
+   for (j = 1; j < argc; j++)
+   {
+      if (!strcmp(argv[j], "-count") && j + 1 < argc)
+         count = atoi(argv[++j]);
+      else if (!strcmp(argv[j], "-threads") && j + 1 < argc)
+         threads = atoi(argv[++j]);
+      else
+      {
+         usage(argv[0]);
+         return 1;
+      }
+   }
+   if (!count || threads > BENCH_MAX_THREADS)
+   {
+      usage(argv[0]);
+      return 1;
+   }
+
+   vcos_init();
+   printf("type         producers    pairs    ns/pair  switches/1k\n");
+   bench(MMAL_QUEUE_TYPE_LOCKED, 0, count, 1);
+   bench(MMAL_QUEUE_TYPE_MPSC, 0, count, 1);
+   for (i = 0; i <= threads; i = i ? i * 2 : 1)
+   {
+      bench(MMAL_QUEUE_TYPE_LOCKED, i, count, 0);
+      bench(MMAL_QUEUE_TYPE_MPSC, i, count, 0);
+   }
+   return 0;
+}
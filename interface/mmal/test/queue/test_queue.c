@@ -0,0 +1,275 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Test for the queue types of mmal_queue_create_with_type. Both types have to
+ * keep the same order, length, put_back and wait semantics, and with several
+ * producers the consumer has to get every buffer exactly once, in the order
+ * each producer put them, whatever mix of get, get_batch, wait, timedwait and
+ * put_back it uses, and whether the producers put one buffer or a chain. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mmal.h"
+#include "mmal_queue.h"
+#include "interface/vcos/vcos.h"
+#include "../test_check.h"
+
+#define STRESS_PRODUCERS 4
+#define STRESS_BUFFERS   50000
+/* Producers don't get further ahead, as if their buffers came from a pool.
+ * This also keeps the sanity check of the locked queue short in debug builds. */
+#define STRESS_DEPTH     256
+
+static const char *type_name(MMAL_QUEUE_TYPE_T type)
+{
+   return type == MMAL_QUEUE_TYPE_MPSC ? "mpsc" : "locked";
+}
+
+static void test_semantics(MMAL_QUEUE_TYPE_T type)
+{
+   MMAL_QUEUE_T *queue = mmal_queue_create_with_type(type);
+   MMAL_BUFFER_HEADER_T buffers[4], *chain;
+   int64_t start;
+
+   CHECK(queue != NULL, "%s: unable to create the queue", type_name(type));
+   if (!queue)
+      return;
+   memset(buffers, 0, sizeof(buffers));
+
+   CHECK(mmal_queue_get(queue) == NULL, "%s: buffer from an empty queue", type_name(type));
+   CHECK(mmal_queue_length(queue) == 0, "%s: empty queue of length %u", type_name(type), mmal_queue_length(queue));
+
+   mmal_queue_put(queue, &buffers[0]);
+   mmal_queue_put(queue, &buffers[1]);
+   mmal_queue_put(queue, &buffers[2]);
+   CHECK(mmal_queue_length(queue) == 3, "%s: length %u after 3 puts", type_name(type), mmal_queue_length(queue));
+   CHECK(mmal_queue_get(queue) == &buffers[0], "%s: not first in first out", type_name(type));
+   mmal_queue_put_back(queue, &buffers[3]);
+   CHECK(mmal_queue_length(queue) == 3, "%s: length %u after put_back", type_name(type), mmal_queue_length(queue));
+   CHECK(mmal_queue_wait(queue) == &buffers[3], "%s: put_back buffer not first", type_name(type));
+   CHECK(mmal_queue_timedwait(queue, 0) == &buffers[1], "%s: wrong buffer after put_back", type_name(type));
+   CHECK(mmal_queue_get(queue) == &buffers[2], "%s: last buffer lost", type_name(type));
+   CHECK(mmal_queue_get(queue) == NULL && mmal_queue_length(queue) == 0, "%s: not empty", type_name(type));
+
+   /* put_back into an empty queue, and after the queue has been emptied */
+   mmal_queue_put_back(queue, &buffers[0]);
+   mmal_queue_put(queue, &buffers[1]);
+   CHECK(mmal_queue_get(queue) == &buffers[0] && mmal_queue_get(queue) == &buffers[1],
+         "%s: put_back into an empty queue", type_name(type));
+
+   /* Chains */
+   buffers[0].next = &buffers[1];
+   buffers[1].next = &buffers[2];
+   buffers[2].next = NULL;
+   mmal_queue_put(queue, &buffers[3]);
+   mmal_queue_put_batch(queue, &buffers[0]);
+   CHECK(mmal_queue_length(queue) == 4, "%s: length %u after put_batch", type_name(type), mmal_queue_length(queue));
+   chain = mmal_queue_get_batch(queue, 2);
+   CHECK(chain == &buffers[3] && chain->next == &buffers[0] && !buffers[0].next, "%s: wrong chain of 2",
+         type_name(type));
+   CHECK(mmal_queue_length(queue) == 2, "%s: length %u after get_batch", type_name(type), mmal_queue_length(queue));
+   mmal_queue_put_back(queue, &buffers[0]);
+   chain = mmal_queue_get_batch(queue, 0);
+   CHECK(chain == &buffers[0] && chain->next == &buffers[1] && buffers[1].next == &buffers[2] && !buffers[2].next,
+         "%s: wrong chain of all buffers", type_name(type));
+   CHECK(mmal_queue_get_batch(queue, 0) == NULL && mmal_queue_length(queue) == 0, "%s: not empty after get_batch",
+         type_name(type));
+
+   start = vcos_getmicrosecs64();
+   CHECK(mmal_queue_timedwait(queue, 50) == NULL, "%s: timedwait on an empty queue", type_name(type));
+   CHECK(vcos_getmicrosecs64() - start >= 40000, "%s: timedwait returned after %d us", type_name(type),
+         (int)(vcos_getmicrosecs64() - start));
+
+   mmal_queue_destroy(queue);
+}
+
+typedef struct
+{
+   MMAL_QUEUE_T *queue;
+   MMAL_BUFFER_HEADER_T *buffers;
+   unsigned int id;
+   VCOS_THREAD_T thread;
+} PRODUCER_T;
+
+static void *producer_thread(void *arg)
+{
+   PRODUCER_T *producer = (PRODUCER_T *)arg;
+   unsigned int i;
+
+   for (i = 0; i < STRESS_BUFFERS; i++)
+   {
+      producer->buffers[i].offset = producer->id;
+      producer->buffers[i].pts = i;
+   }
+
+   for (i = 0; i < STRESS_BUFFERS; i++)
+   {
+      while (mmal_queue_length(producer->queue) > STRESS_DEPTH)
+         vcos_sleep(0);
+      /* Every fifth put is a chain of three */
+      if (i % 5 == 1 && i + 3 <= STRESS_BUFFERS)
+      {
+         producer->buffers[i].next = &producer->buffers[i + 1];
+         producer->buffers[i + 1].next = &producer->buffers[i + 2];
+         producer->buffers[i + 2].next = NULL;
+         mmal_queue_put_batch(producer->queue, &producer->buffers[i]);
+         i += 2;
+      }
+      else
+         mmal_queue_put(producer->queue, &producer->buffers[i]);
+      /* Now and then give the consumer a chance to run dry and wait */
+      if (!(i % 5000))
+         vcos_sleep(1);
+   }
+   return NULL;
+}
+
+static void test_stress(MMAL_QUEUE_TYPE_T type)
+{
+   MMAL_QUEUE_T *queue = mmal_queue_create_with_type(type);
+   PRODUCER_T producers[STRESS_PRODUCERS];
+   int64_t next[STRESS_PRODUCERS];
+   unsigned int received = 0, out_of_order = 0, i;
+   int64_t start;
+
+   CHECK(queue != NULL, "%s: unable to create the queue", type_name(type));
+   if (!queue)
+      return;
+
+   for (i = 0; i < STRESS_PRODUCERS; i++)
+   {
+      producers[i].queue = queue;
+      producers[i].id = i;
+      producers[i].buffers = calloc(STRESS_BUFFERS, sizeof(MMAL_BUFFER_HEADER_T));
+      next[i] = 0;
+   }
+   start = vcos_getmicrosecs64();
+   for (i = 0; i < STRESS_PRODUCERS; i++)
+      vcos_thread_create(&producers[i].thread, "producer", NULL, producer_thread, &producers[i]);
+
+   while (received < STRESS_PRODUCERS * STRESS_BUFFERS)
+   {
+      MMAL_BUFFER_HEADER_T *buffer, *chain;
+      unsigned int length;
+
+      switch (received % 5)
+      {
+      case 0: buffer = mmal_queue_get(queue); break;
+      case 1: buffer = mmal_queue_timedwait(queue, 1); break;
+      case 2: buffer = mmal_queue_get_batch(queue, 4); break;
+      default: buffer = mmal_queue_timedwait(queue, 1000); break;
+      }
+      /* Only get_batch ends its chain, get leaves next as it was in the queue */
+      if (buffer && received % 5 != 2)
+         buffer->next = NULL;
+
+      for (; buffer; buffer = chain)
+      {
+         chain = buffer->next;
+
+         /* Hand back one buffer in seven, it has to be the next one we get */
+         if (buffer->pts % 7 == 3 && !buffer->flags)
+         {
+            buffer->flags = 1;
+            length = mmal_queue_length(queue);
+            mmal_queue_put_back(queue, buffer);
+            CHECK(mmal_queue_length(queue) >= length + 1, "%s: length did not grow with put_back", type_name(type));
+            CHECK(mmal_queue_get(queue) == buffer, "%s: put_back buffer not first", type_name(type));
+         }
+
+         if (buffer->offset >= STRESS_PRODUCERS || buffer->pts != next[buffer->offset])
+            out_of_order++;
+         else
+            next[buffer->offset]++;
+         received++;
+      }
+   }
+
+   for (i = 0; i < STRESS_PRODUCERS; i++)
+      vcos_thread_join(&producers[i].thread, NULL);
+
+   CHECK(!out_of_order, "%s: %u buffers out of order", type_name(type), out_of_order);
+   for (i = 0; i < STRESS_PRODUCERS; i++)
+      CHECK(next[i] == STRESS_BUFFERS, "%s: %d buffers from producer %u", type_name(type), (int)next[i], i);
+   CHECK(mmal_queue_get(queue) == NULL && mmal_queue_length(queue) == 0, "%s: not empty at the end",
+         type_name(type));
+   printf("%s: %u buffers from %d producers in %d ms\n", type_name(type), received, STRESS_PRODUCERS,
+          (int)((vcos_getmicrosecs64() - start) / 1000));
+
+   for (i = 0; i < STRESS_PRODUCERS; i++)
+      free(producers[i].buffers);
+   mmal_queue_destroy(queue);
+}
+
+/* The consumer is asleep in mmal_queue_wait when the buffer comes */
+static void *late_producer_thread(void *arg)
+{
+   PRODUCER_T *producer = (PRODUCER_T *)arg;
+   vcos_sleep(20);
+   mmal_queue_put(producer->queue, producer->buffers);
+   return NULL;
+}
+
+static void test_wakeup(MMAL_QUEUE_TYPE_T type)
+{
+   MMAL_BUFFER_HEADER_T buffer;
+   PRODUCER_T producer;
+   int i;
+
+   memset(&buffer, 0, sizeof(buffer));
+   producer.queue = mmal_queue_create_with_type(type);
+   producer.buffers = &buffer;
+   if (!producer.queue)
+      return;
+
+   for (i = 0; i < 20; i++)
+   {
+      vcos_thread_create(&producer.thread, "producer", NULL, late_producer_thread, &producer);
+      CHECK((i % 2 ? mmal_queue_wait(producer.queue) : mmal_queue_timedwait(producer.queue, 5000)) == &buffer,
+            "%s: consumer not woken up", type_name(type));
+      vcos_thread_join(&producer.thread, NULL);
+   }
+   mmal_queue_destroy(producer.queue);
+}
+
+int main(int argc, char **argv)
+{
+   MMAL_PARAM_UNUSED(argc);
+   MMAL_PARAM_UNUSED(argv);
+   vcos_init();
+
+   test_semantics(MMAL_QUEUE_TYPE_LOCKED);
+   test_semantics(MMAL_QUEUE_TYPE_MPSC);
+   test_wakeup(MMAL_QUEUE_TYPE_LOCKED);
+   test_wakeup(MMAL_QUEUE_TYPE_MPSC);
+   test_stress(MMAL_QUEUE_TYPE_LOCKED);
+   test_stress(MMAL_QUEUE_TYPE_MPSC);
+
+   return test_result();
+}
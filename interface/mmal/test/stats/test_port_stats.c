@@ -0,0 +1,205 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Test for the port statistics of the core, MMAL_PARAMETER_CORE_LATENCY.
+ * A free running artificial_camera feeds a null_sink. Every buffer the camera
+ * sends back has to be in its latency histogram, every buffer after the first
+ * one in its interval histogram, the byte count has to match the frames, and
+ * a reset has to start the counts again without losing MMAL_PARAMETER_CORE_STATISTICS. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mmal.h"
+#include "util/mmal_connection.h"
+#include "util/mmal_util_params.h"
+#include "util/mmal_util_stats.h"
+#include "interface/vcos/vcos.h"
+#include "../test_check.h"
+
+#define RUN_MS 300
+
+static uint32_t histogram_sum(const uint32_t *histogram)
+{
+   uint32_t sum = 0;
+   unsigned int i;
+
+   for (i = 0; i < MMAL_CORE_LATENCY_BUCKETS; i++)
+      sum += histogram[i];
+   return sum;
+}
+
+/** Rows of the table of mmal_util_dump_port_latency, without the header */
+static int count_table_rows(MMAL_COMPONENT_T *camera, MMAL_COMPONENT_T *sink, MMAL_BOOL_T reset)
+{
+   MMAL_COMPONENT_T *components[2] = { camera, sink };
+   FILE *out = tmpfile();
+   char line[256];
+   int rows = 0;
+
+   if (!out)
+      return -1;
+   mmal_util_dump_port_latency(out, components, 2, reset);
+   rewind(out);
+   while (fgets(line, sizeof(line), out))
+      rows++;
+   fclose(out);
+   return rows - 2;
+}
+
+static void test_percentile(void)
+{
+   uint32_t histogram[MMAL_CORE_LATENCY_BUCKETS];
+   uint32_t value;
+
+   memset(histogram, 0, sizeof(histogram));
+   CHECK(mmal_util_latency_percentile(histogram, 50) == 0, "Empty histogram has a percentile");
+
+   /* 1us buckets at the bottom */
+   histogram[3] = 10;
+   CHECK(mmal_util_latency_percentile(histogram, 50) == 3, "3us is %u",
+         mmal_util_latency_percentile(histogram, 50));
+
+   /* 99 values in the bucket of 32768us and one much later */
+   histogram[3] = 0;
+   histogram[(13 << MMAL_CORE_LATENCY_SUB_BITS)] = 99;
+   histogram[MMAL_CORE_LATENCY_BUCKETS - 1] = 1;
+   value = mmal_util_latency_percentile(histogram, 50);
+   CHECK(value >= 32768 && value < 32768 + 4096, "32768us is %u", value);
+   CHECK(mmal_util_latency_percentile(histogram, 99) == value, "p99 is not p50");
+   CHECK(mmal_util_latency_percentile(histogram, 100) > 15000000, "Longest is %u",
+         mmal_util_latency_percentile(histogram, 100));
+}
+
+static void test_pipeline(void)
+{
+   MMAL_COMPONENT_T *camera = NULL, *sink = NULL;
+   MMAL_CONNECTION_T *connection = NULL;
+   MMAL_PARAMETER_ARTIFICIAL_SCENE_T scene = {{MMAL_PARAMETER_ARTIFICIAL_SCENE, sizeof(scene)},
+      MMAL_PARAM_ARTIFICIAL_SCENE_PATTERN, 0, 0, 0, 0, 100, 0, MMAL_TRUE};
+   MMAL_CORE_LATENCY_T rx, tx;
+   MMAL_CORE_STATISTICS_T core;
+   MMAL_PORT_T *out;
+   MMAL_STATUS_T status;
+
+   status = mmal_component_create("artificial_camera", &camera);
+   CHECK(status == MMAL_SUCCESS, "Unable to create artificial_camera");
+   status = mmal_component_create("null_sink", &sink);
+   CHECK(status == MMAL_SUCCESS, "Unable to create null_sink");
+   if (!camera || !sink)
+      goto end;
+
+   out = camera->output[0];
+   status = mmal_port_parameter_set(out, &scene.hdr);
+   CHECK(status == MMAL_SUCCESS, "Unable to set the scene");
+   status = mmal_connection_create(&connection, out, sink->input[0], MMAL_CONNECTION_FLAG_TUNNELLING);
+   CHECK(status == MMAL_SUCCESS, "Unable to connect");
+   if (status != MMAL_SUCCESS)
+      goto end;
+   status = mmal_util_enable_port_latency(&camera, 1, MMAL_TRUE);
+   CHECK(status == MMAL_SUCCESS, "Unable to collect TX statistics");
+   status = mmal_connection_enable(connection);
+   CHECK(status == MMAL_SUCCESS, "Unable to enable the connection");
+   vcos_sleep(RUN_MS);
+   mmal_connection_disable(connection);
+
+   /* Nothing is in transit after the disable */
+   CHECK(mmal_util_get_core_port_latency(out, MMAL_CORE_STATS_RX, MMAL_FALSE, &rx) == MMAL_SUCCESS,
+         "No RX statistics");
+   CHECK(mmal_util_get_core_port_latency(out, MMAL_CORE_STATS_TX, MMAL_FALSE, &tx) == MMAL_SUCCESS,
+         "No TX statistics");
+   printf("%u buffers in, %u out, %llu bytes, most in transit %u\n", rx.buffer_count, tx.buffer_count,
+          (unsigned long long)tx.bytes, rx.in_transit_max);
+   CHECK(tx.buffer_count > 1, "Only %u buffers out", tx.buffer_count);
+   CHECK(rx.buffer_count == tx.buffer_count, "%u buffers in, %u out", rx.buffer_count, tx.buffer_count);
+   CHECK(histogram_sum(tx.latency) == tx.buffer_count, "%u latencies for %u buffers",
+         histogram_sum(tx.latency), tx.buffer_count);
+   CHECK(histogram_sum(tx.interval) == tx.buffer_count - 1, "%u intervals for %u buffers",
+         histogram_sum(tx.interval), tx.buffer_count);
+   CHECK(histogram_sum(rx.interval) == rx.buffer_count - 1, "%u intervals for %u buffers",
+         histogram_sum(rx.interval), rx.buffer_count);
+   CHECK(histogram_sum(rx.latency) == 0, "Latencies going in");
+   CHECK(rx.bytes == 0, "Output buffers sent with %llu bytes", (unsigned long long)rx.bytes);
+   CHECK(tx.bytes == (uint64_t)tx.buffer_count * out->buffer_size, "%llu bytes in %u buffers of %u",
+         (unsigned long long)tx.bytes, tx.buffer_count, out->buffer_size);
+   /* The connection sends buffers back from the callback, which still counts them */
+   CHECK(rx.in_transit_max >= 1 && rx.in_transit_max <= out->buffer_num + 1, "%u in transit of %u buffers",
+         rx.in_transit_max, out->buffer_num);
+   CHECK(tx.last_buffer_time - tx.first_buffer_time <= RUN_MS * 1000 * 2, "Buffers over %u us",
+         tx.last_buffer_time - tx.first_buffer_time);
+
+#if !defined(MMAL_COLLECT_PORT_STATS)
+   /* The sink kept the default and only counts buffers going in */
+   CHECK(mmal_util_get_core_port_latency(sink->input[0], MMAL_CORE_STATS_RX, MMAL_FALSE, &rx) == MMAL_SUCCESS &&
+         rx.buffer_count > 0, "No RX statistics on the sink");
+   CHECK(mmal_util_get_core_port_latency(sink->input[0], MMAL_CORE_STATS_TX, MMAL_FALSE, &tx) == MMAL_SUCCESS &&
+         tx.buffer_count == 0, "%u buffers out of the sink without MMAL_PARAMETER_CORE_LATENCY_TX",
+         tx.buffer_count);
+   CHECK(mmal_util_get_core_port_latency(out, MMAL_CORE_STATS_TX, MMAL_FALSE, &tx) == MMAL_SUCCESS,
+         "No TX statistics");
+#endif
+
+   /* The older statistics come from the same counters */
+   CHECK(mmal_util_get_core_port_stats(out, MMAL_CORE_STATS_TX, MMAL_TRUE, &core) == MMAL_SUCCESS,
+         "No core statistics");
+   CHECK(core.buffer_count == tx.buffer_count, "%u buffers in the core statistics", core.buffer_count);
+   CHECK(core.max_delay >= mmal_util_latency_percentile(tx.interval, 50) / 2, "Longest interval %u",
+         core.max_delay);
+
+   /* Reset */
+   CHECK(mmal_util_get_core_port_latency(out, MMAL_CORE_STATS_TX, MMAL_TRUE, &tx) == MMAL_SUCCESS,
+         "No TX statistics");
+   CHECK(mmal_util_get_core_port_latency(out, MMAL_CORE_STATS_TX, MMAL_FALSE, &tx) == MMAL_SUCCESS,
+         "No TX statistics");
+   CHECK(tx.buffer_count == 0 && tx.bytes == 0 && !histogram_sum(tx.interval) && !histogram_sum(tx.latency) &&
+         !tx.first_buffer_time, "Reset left %u buffers", tx.buffer_count);
+
+   /* A table with reset leaves nothing for the next one, not even in the core statistics
+    * the ports without host counters fall back to */
+   CHECK(count_table_rows(camera, sink, MMAL_TRUE) > 0, "Empty table");
+   CHECK(count_table_rows(camera, sink, MMAL_FALSE) == 0, "Rows after a reset");
+
+ end:
+   if (connection)
+      mmal_connection_destroy(connection);
+   if (camera)
+      mmal_component_release(camera);
+   if (sink)
+      mmal_component_release(sink);
+}
+
+int main(int argc, char **argv)
+{
+   MMAL_PARAM_UNUSED(argc);
+   MMAL_PARAM_UNUSED(argv);
+
+   test_percentile();
+   test_pipeline();
+
+   return test_result();
+}
@@ -0,0 +1,337 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Test for the buffer flow tracing of mmal_trace.h. Nothing is recorded while
+ * tracing is off; while it is on, a buffer header sent to a port shows up in the
+ * file with the send, the callback and the release nested as they were called,
+ * every thread gets its own ring, and a full ring keeps the newest events. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "mmal.h"
+#include "mmal_trace.h"
+#include "util/mmal_default_components.h"
+#include "interface/vcos/vcos.h"
+#include "../test_check.h"
+
+#define RING_EVENTS  64
+#define WRAP_BUFFERS 1000
+#define THREAD_PUTS  10
+
+/** A trace file read back */
+typedef struct
+{
+   MMAL_TRACE_FILE_HEADER_T header;
+   MMAL_TRACE_NAME_T names[64];
+   MMAL_TRACE_THREAD_T threads[8];
+   MMAL_TRACE_EVENT_T *events[8];
+} TRACE_T;
+
+static char trace_path[64];
+
+/* Same thread ids as the rings, gettid() is too recent for some C libraries */
+static uint32_t thread_id(void)
+{
+   return (uint32_t)syscall(SYS_gettid);
+}
+
+static void trace_free(TRACE_T *trace)
+{
+   unsigned int i;
+   for (i = 0; i < 8; i++)
+      free(trace->events[i]);
+   memset(trace, 0, sizeof(*trace));
+}
+
+static int trace_read(TRACE_T *trace)
+{
+   FILE *file;
+   unsigned int i;
+
+   memset(trace, 0, sizeof(*trace));
+   if (mmal_trace_write(trace_path) != MMAL_SUCCESS)
+      return -1;
+   file = fopen(trace_path, "rb");
+   if (!file)
+      return -1;
+
+   if (fread(&trace->header, sizeof(trace->header), 1, file) != 1 ||
+       trace->header.magic != MMAL_TRACE_FILE_MAGIC || trace->header.version != MMAL_TRACE_FILE_VERSION ||
+       trace->header.event_size != sizeof(MMAL_TRACE_EVENT_T) || trace->header.names > 64 ||
+       trace->header.threads > 8 ||
+       fread(trace->names, sizeof(trace->names[0]), trace->header.names, file) != trace->header.names)
+      goto error;
+
+   for (i = 0; i < trace->header.threads; i++)
+   {
+      if (fread(&trace->threads[i], sizeof(trace->threads[i]), 1, file) != 1)
+         goto error;
+      trace->events[i] = calloc(trace->threads[i].events + 1, sizeof(MMAL_TRACE_EVENT_T));
+      if (!trace->events[i] ||
+          fread(trace->events[i], sizeof(MMAL_TRACE_EVENT_T), trace->threads[i].events, file) !=
+             trace->threads[i].events)
+         goto error;
+   }
+
+   fclose(file);
+   return 0;
+
+error:
+   fclose(file);
+   trace_free(trace);
+   return -1;
+}
+
+/** Index of the thread with this tid in the trace, or -1 */
+static int trace_thread(const TRACE_T *trace, uint32_t tid)
+{
+   unsigned int i;
+   for (i = 0; i < trace->header.threads; i++)
+      if (trace->threads[i].tid == tid)
+         return (int)i;
+   return -1;
+}
+
+static unsigned int trace_count(const TRACE_T *trace, MMAL_TRACE_TYPE_T type)
+{
+   unsigned int i, j, count = 0;
+   for (i = 0; i < trace->header.threads; i++)
+      for (j = 0; j < trace->threads[i].events; j++)
+         count += trace->events[i][j].type == type;
+   return count;
+}
+
+static void input_callback(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
+{
+   MMAL_PARAM_UNUSED(port);
+   mmal_buffer_header_release(buffer);
+}
+
+static void test_send(void)
+{
+   static const MMAL_TRACE_TYPE_T expected[] =
+   {
+      MMAL_TRACE_QUEUE_GET, MMAL_TRACE_SEND_BEGIN, MMAL_TRACE_CALLBACK_BEGIN, MMAL_TRACE_RELEASE,
+      MMAL_TRACE_QUEUE_PUT, MMAL_TRACE_CALLBACK_END, MMAL_TRACE_SEND_END
+   };
+   MMAL_COMPONENT_T *sink = NULL;
+   MMAL_BUFFER_HEADER_T *buffer, *traced;
+   MMAL_POOL_T *pool;
+   MMAL_PORT_T *input;
+   TRACE_T trace;
+   unsigned int i, j;
+   int thread;
+
+   CHECK(mmal_component_create("null_sink", &sink) == MMAL_SUCCESS, "send: unable to create null_sink");
+   if (!sink)
+      return;
+   input = sink->input[0];
+   pool = mmal_pool_create(2, 1024);
+   CHECK(pool && mmal_port_enable(input, input_callback) == MMAL_SUCCESS, "send: unable to enable %s",
+         input->name);
+
+   /* Off, nothing recorded */
+   buffer = mmal_queue_get(pool->queue);
+   mmal_buffer_header_release(buffer);
+
+   CHECK(mmal_trace_start(RING_EVENTS, 0) == MMAL_SUCCESS, "send: unable to start tracing");
+   traced = mmal_queue_get(pool->queue);
+   traced->length = 100;
+   traced->pts = 1234;
+   CHECK(mmal_port_send_buffer(input, traced) == MMAL_SUCCESS, "send: unable to send the buffer");
+   mmal_trace_stop();
+
+   /* Stopped, nothing recorded either */
+   buffer = mmal_queue_get(pool->queue);
+   mmal_buffer_header_release(buffer);
+
+   CHECK(trace_read(&trace) == 0, "send: unable to read the trace back");
+   thread = trace_thread(&trace, thread_id());
+   CHECK(thread >= 0, "send: no ring for this thread");
+   if (thread >= 0)
+   {
+      const MMAL_TRACE_EVENT_T *events = trace.events[thread];
+
+      CHECK(trace.threads[thread].events == sizeof(expected) / sizeof(expected[0]) &&
+            !trace.threads[thread].dropped, "send: %u events, %llu dropped", trace.threads[thread].events,
+            (unsigned long long)trace.threads[thread].dropped);
+      for (i = 0; i < trace.threads[thread].events && i < sizeof(expected) / sizeof(expected[0]); i++)
+      {
+         CHECK(events[i].type == expected[i], "send: event %u of type %u instead of %u", i, events[i].type,
+               expected[i]);
+         CHECK(!i || events[i].time >= events[i - 1].time, "send: event %u before the previous one", i);
+         if (events[i].type == MMAL_TRACE_SEND_END || events[i].type == MMAL_TRACE_CALLBACK_END)
+            continue;
+         CHECK(events[i].buffer == (uintptr_t)traced, "send: event %u about buffer 0x%llx", i,
+               (unsigned long long)events[i].buffer);
+      }
+      CHECK(events[1].object == (uintptr_t)input && events[1].length == 100 && events[1].pts == 1234,
+            "send: send of %u bytes at pts %lld", events[1].length, (long long)events[1].pts);
+      CHECK(events[3].arg == 0 && events[3].object == (uintptr_t)pool, "send: release leaves refcount %u",
+            events[3].arg);
+      CHECK(events[0].object == (uintptr_t)pool->queue && events[4].object == (uintptr_t)pool->queue,
+            "send: buffer not taken from and put back in the pool");
+      CHECK(events[6].arg == MMAL_SUCCESS, "send: send returned %u", events[6].arg);
+
+      for (j = 0; j < trace.header.names; j++)
+         if (trace.names[j].object == (uintptr_t)input)
+            break;
+      CHECK(j < trace.header.names && !strcmp(trace.names[j].name, input->name), "send: port not named %s",
+            input->name);
+   }
+   trace_free(&trace);
+
+   mmal_port_disable(input);
+   mmal_pool_destroy(pool);
+   mmal_component_release(sink);
+}
+
+static void *put_thread(void *arg)
+{
+   MMAL_QUEUE_T *queue = (MMAL_QUEUE_T *)arg;
+   MMAL_BUFFER_HEADER_T buffers[THREAD_PUTS];
+   unsigned int i;
+
+   memset(buffers, 0, sizeof(buffers));
+   for (i = 0; i < THREAD_PUTS; i++)
+      mmal_queue_put(queue, &buffers[i]);
+   for (i = 0; i < THREAD_PUTS; i++)
+      mmal_queue_get(queue);
+   return (void *)(uintptr_t)thread_id();
+}
+
+static void test_threads(void)
+{
+   MMAL_QUEUE_T *queue = mmal_queue_create();
+   MMAL_BUFFER_HEADER_T buffer;
+   VCOS_THREAD_T thread;
+   void *tid = NULL;
+   TRACE_T trace;
+   int index;
+
+   memset(&buffer, 0, sizeof(buffer));
+   CHECK(mmal_trace_start(RING_EVENTS, MMAL_TRACE_MASK(MMAL_TRACE_QUEUE_PUT)) == MMAL_SUCCESS,
+         "threads: unable to start tracing");
+   mmal_queue_put(queue, &buffer);
+   mmal_queue_get(queue);
+   CHECK(vcos_thread_create(&thread, "trace test", NULL, put_thread, queue) == VCOS_SUCCESS,
+         "threads: unable to create thread");
+   vcos_thread_join(&thread, &tid);
+   mmal_trace_stop();
+
+   CHECK(trace_read(&trace) == 0, "threads: unable to read the trace back");
+   CHECK(trace.header.threads == 2, "threads: %u rings", trace.header.threads);
+   CHECK(trace_count(&trace, MMAL_TRACE_QUEUE_GET) == 0, "threads: event not in the mask recorded");
+   index = trace_thread(&trace, thread_id());
+   CHECK(index >= 0 && trace.threads[index].events == 1, "threads: %u events on this thread",
+         index >= 0 ? trace.threads[index].events : 0);
+   /* The ring of a thread which exited stays in the trace */
+   index = trace_thread(&trace, (uint32_t)(uintptr_t)tid);
+   CHECK(index >= 0 && trace.threads[index].events == THREAD_PUTS && !strcmp(trace.threads[index].name, "trace test"),
+         "threads: %u events on the other thread", index >= 0 ? trace.threads[index].events : 0);
+   trace_free(&trace);
+
+   /* Starting again drops the rings of the exited threads */
+   CHECK(mmal_trace_start(RING_EVENTS, 0) == MMAL_SUCCESS, "threads: unable to start tracing again");
+   mmal_queue_put(queue, &buffer);
+   mmal_trace_stop();
+   mmal_queue_get(queue);
+   CHECK(trace_read(&trace) == 0, "threads: unable to read the second trace back");
+   CHECK(trace.header.threads == 1 && trace.threads[0].events == 1, "threads: %u rings in the second trace",
+         trace.header.threads);
+   trace_free(&trace);
+
+   mmal_queue_destroy(queue);
+}
+
+static void test_wrap(void)
+{
+   MMAL_QUEUE_T *queue = mmal_queue_create();
+   MMAL_BUFFER_HEADER_T buffers[WRAP_BUFFERS];
+   const MMAL_TRACE_EVENT_T *last;
+   TRACE_T trace;
+   unsigned int i;
+
+   memset(buffers, 0, sizeof(buffers));
+   CHECK(mmal_trace_start(RING_EVENTS, 0) == MMAL_SUCCESS, "wrap: unable to start tracing");
+   for (i = 0; i < WRAP_BUFFERS; i++)
+   {
+      mmal_queue_put(queue, &buffers[i]);
+      mmal_queue_get(queue);
+   }
+   mmal_trace_stop();
+
+   CHECK(trace_read(&trace) == 0 && trace.header.threads == 1, "wrap: unable to read the trace back");
+   if (trace.header.threads == 1)
+   {
+      CHECK(trace.threads[0].events == RING_EVENTS && trace.threads[0].dropped == 2 * WRAP_BUFFERS - RING_EVENTS,
+            "wrap: %u events, %llu dropped", trace.threads[0].events,
+            (unsigned long long)trace.threads[0].dropped);
+      last = &trace.events[0][trace.threads[0].events - 1];
+      CHECK(last->type == MMAL_TRACE_QUEUE_GET && last->buffer == (uintptr_t)&buffers[WRAP_BUFFERS - 1],
+            "wrap: newest event lost");
+      for (i = 1; i < trace.threads[0].events; i++)
+         CHECK(trace.events[0][i].time >= trace.events[0][i - 1].time, "wrap: event %u out of order", i);
+   }
+   trace_free(&trace);
+   mmal_queue_destroy(queue);
+}
+
+int main(int argc, char **argv)
+{
+   int fd;
+
+   MMAL_PARAM_UNUSED(argc);
+   MMAL_PARAM_UNUSED(argv);
+   vcos_init();
+
+   strcpy(trace_path, "/tmp/mmal_test_trace.XXXXXX");
+   fd = mkstemp(trace_path);
+   CHECK(fd >= 0, "unable to create a temporary file");
+   if (fd < 0)
+      return error_count;
+   close(fd);
+
+   if (mmal_trace_start(0, 0) == MMAL_ENOSYS)
+   {
+      printf("Tracing not available on this platform\n");
+      unlink(trace_path);
+      return 0;
+   }
+   mmal_trace_stop();
+
+   test_send();
+   test_threads();
+   test_wrap();
+   unlink(trace_path);
+
+   return test_result();
+}
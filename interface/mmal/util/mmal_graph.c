@@ -35,6 +35,47 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define GRAPH_CONNECTIONS_MAX 16
 #define PROCESSING_TIME_MAX 20000
 
+/** Several threads need atomics for the task states */
+#if defined(__ATOMIC_SEQ_CST)
+# define GRAPH_SCHEDULER
+#endif
+#define GRAPH_THREADS_MAX 8
+#define GRAPH_TASKS_MAX (2*GRAPH_CONNECTIONS_MAX)
+
+/** States of a task of the scheduler */
+enum {
+   GRAPH_TASK_IDLE,     /**< waiting for buffers */
+   GRAPH_TASK_QUEUED,   /**< in a run queue */
+   GRAPH_TASK_RUNNING,  /**< being run by a thread */
+   GRAPH_TASK_RERUN     /**< being run and needs to run again */
+};
+
+/** Task moving the buffers into and out of one component */
+typedef struct GRAPH_TASK_T
+{
+   MMAL_COMPONENT_T *component;
+   uint32_t state;         /**< GRAPH_TASK_IDLE etc. */
+   unsigned int home;      /**< thread whose run queue the task goes to */
+} GRAPH_TASK_T;
+
+/** Run queue of a thread of the scheduler.
+ * A task is in at most one run queue, so it never fills up. */
+typedef struct GRAPH_RUN_QUEUE_T
+{
+   VCOS_MUTEX_T lock;
+   unsigned int task[GRAPH_TASKS_MAX];
+   unsigned int first, count;
+} GRAPH_RUN_QUEUE_T;
+
+/** Thread of the scheduler */
+typedef struct GRAPH_THREAD_T
+{
+   struct MMAL_COMPONENT_MODULE_T *graph;
+   unsigned int index;
+   VCOS_THREAD_T thread;
+   GRAPH_RUN_QUEUE_T queue;
+} GRAPH_THREAD_T;
+
 /*****************************************************************************/
 
 /** Private context for our graph.
@@ -64,6 +105,18 @@ typedef struct MMAL_COMPONENT_MODULE_T
    VCOS_THREAD_T thread;         /**< worker thread which processes all internal connections */
    VCOS_SEMAPHORE_T sema;        /**< informs the worker thread that buffers are available */
 
+   /* Scheduler, used instead of the worker thread with more than one thread */
+   unsigned int threads_num;     /**< threads asked for, 0 or 1 for the worker thread */
+   unsigned int threads_running; /**< threads of the scheduler started */
+   uint32_t threads_sleeping;    /**< threads of the scheduler waiting on sema */
+   GRAPH_THREAD_T threads[GRAPH_THREADS_MAX];
+   GRAPH_TASK_T task[GRAPH_TASKS_MAX];
+   unsigned int task_num;
+   unsigned int connection_in_task[GRAPH_CONNECTIONS_MAX];  /**< task of the input port of a connection */
+   unsigned int connection_out_task[GRAPH_CONNECTIONS_MAX]; /**< task of the output port of a connection */
+   /** Event of the output port of a connection, waiting for the task of that port */
+   MMAL_BUFFER_HEADER_T *connection_event[GRAPH_CONNECTIONS_MAX];
+
    MMAL_GRAPH_EVENT_CB event_cb; /**< callback for sending control port events to the client */
    void *event_cb_data;          /**< callback data supplied by the client */
 
@@ -76,6 +129,10 @@ static MMAL_STATUS_T mmal_component_create_from_graph(const char *name, MMAL_COM
 static MMAL_BOOL_T graph_do_processing(MMAL_GRAPH_PRIVATE_T *graph);
 static void graph_process_buffer(MMAL_GRAPH_PRIVATE_T *graph_private,
    MMAL_CONNECTION_T *connection, MMAL_BUFFER_HEADER_T *buffer);
+static void graph_scheduler_connection(MMAL_GRAPH_PRIVATE_T *graph, MMAL_CONNECTION_T *connection);
+static MMAL_STATUS_T graph_scheduler_start(MMAL_GRAPH_PRIVATE_T *graph);
+static void graph_scheduler_start_tasks(MMAL_GRAPH_PRIVATE_T *graph);
+static void graph_scheduler_stop(MMAL_GRAPH_PRIVATE_T *graph);
 
 /*****************************************************************************/
 static void graph_control_cb(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
@@ -110,7 +167,10 @@ static void graph_connection_cb(MMAL_CONNECTION_T *connection)
       return;
    }
 
-   vcos_semaphore_post(&graph->sema);
+   if (graph->threads_running)
+      graph_scheduler_connection(graph, connection);
+   else
+      vcos_semaphore_post(&graph->sema);
 }
 
 /*****************************************************************************/
@@ -134,6 +194,12 @@ static void* graph_worker_thread(void* ctx)
 /*****************************************************************************/
 static void graph_stop_worker_thread(MMAL_GRAPH_PRIVATE_T *graph)
 {
+   if (graph->threads_running)
+   {
+      graph_scheduler_stop(graph);
+      return;
+   }
+
    graph->stop_thread = MMAL_TRUE;
    vcos_semaphore_post(&graph->sema);
    vcos_thread_join(&graph->thread, NULL);
@@ -143,6 +209,7 @@ static void graph_stop_worker_thread(MMAL_GRAPH_PRIVATE_T *graph)
 MMAL_STATUS_T mmal_graph_create(MMAL_GRAPH_T **graph, unsigned int userdata_size)
 {
    MMAL_GRAPH_PRIVATE_T *private;
+   unsigned int i;
 
    LOG_TRACE("graph %p, userdata_size %u", graph, userdata_size);
 
@@ -164,6 +231,21 @@ MMAL_STATUS_T mmal_graph_create(MMAL_GRAPH_T **graph, unsigned int userdata_size
       return MMAL_ENOSPC;
    }
 
+   /* The run queues of the scheduler outlive its threads, as the connections
+    * can still call back while the threads stop */
+   for (i = 0; i < GRAPH_THREADS_MAX; i++)
+   {
+      if (vcos_mutex_create(&private->threads[i].queue.lock, "mmal graph run queue") != VCOS_SUCCESS)
+      {
+         LOG_ERROR("failed to create run queues %p", graph);
+         while (i--)
+            vcos_mutex_delete(&private->threads[i].queue.lock);
+         vcos_semaphore_delete(&private->sema);
+         vcos_free(private);
+         return MMAL_ENOSPC;
+      }
+   }
+
    return MMAL_SUCCESS;
 }
 
@@ -188,6 +270,8 @@ MMAL_STATUS_T mmal_graph_destroy(MMAL_GRAPH_T *graph)
    for (i = 0; i < private->component_num; i++)
       mmal_component_release(private->component[i]);
 
+   for (i = 0; i < GRAPH_THREADS_MAX; i++)
+      vcos_mutex_delete(&private->threads[i].queue.lock);
    vcos_semaphore_delete(&private->sema);
 
    vcos_free(graph);
@@ -388,8 +472,14 @@ MMAL_STATUS_T mmal_graph_enable(MMAL_GRAPH_T *graph, MMAL_GRAPH_EVENT_CB cb, voi
 
    LOG_TRACE("graph: %p", graph);
 
-   if (vcos_thread_create(&private->thread, "mmal graph thread", NULL,
-                          graph_worker_thread, private) != VCOS_SUCCESS)
+   if (private->threads_num > 1)
+   {
+      status = graph_scheduler_start(private);
+      if (status != MMAL_SUCCESS)
+         return status;
+   }
+   else if (vcos_thread_create(&private->thread, "mmal graph thread", NULL,
+                               graph_worker_thread, private) != VCOS_SUCCESS)
    {
       LOG_ERROR("failed to create worker thread %p", graph);
       return MMAL_ENOSPC;
@@ -421,7 +511,10 @@ MMAL_STATUS_T mmal_graph_enable(MMAL_GRAPH_T *graph, MMAL_GRAPH_EVENT_CB cb, voi
    }
 
    /* Trigger the worker thread to populate the output ports with empty buffers */
-   vcos_semaphore_post(&private->sema);
+   if (private->threads_running)
+      graph_scheduler_start_tasks(private);
+   else
+      vcos_semaphore_post(&private->sema);
    return status;
 
  error:
@@ -440,8 +533,10 @@ MMAL_STATUS_T mmal_graph_disable(MMAL_GRAPH_T *graph)
 
    graph_stop_worker_thread(private);
 
-   /* Disable all our connections */
-   for (i = 0; i < private->connection_num; i++)
+   /* Disable all our connections, the last one first. Buffers replicated by a
+    * pass-through component hold references on the buffers of the connection
+    * before it, so those only come back once the later connections are flushed. */
+   for (i = private->connection_num; i-- > 0; )
    {
       status = mmal_connection_disable(private->connection[i]);
       if (status != MMAL_SUCCESS)
@@ -645,6 +740,363 @@ static void graph_do_processing_loop(MMAL_COMPONENT_T *component)
    while (graph_do_processing((MMAL_GRAPH_PRIVATE_T *)component->priv->module));
 }
 
+/*****************************************************************************/
+#ifdef GRAPH_SCHEDULER
+
+/** Put a task in the run queue of a thread and wake up a thread if they all sleep */
+static void graph_scheduler_push(MMAL_GRAPH_PRIVATE_T *graph, unsigned int thread, unsigned int task)
+{
+   GRAPH_RUN_QUEUE_T *queue = &graph->threads[thread].queue;
+
+   vcos_mutex_lock(&queue->lock);
+   queue->task[(queue->first + queue->count++) % GRAPH_TASKS_MAX] = task;
+   vcos_mutex_unlock(&queue->lock);
+   if (__atomic_load_n(&graph->threads_sleeping, __ATOMIC_SEQ_CST))
+      vcos_semaphore_post(&graph->sema);
+}
+
+/** Take the oldest task of a thread's own run queue, or the newest one of another thread */
+static MMAL_BOOL_T graph_scheduler_pop(GRAPH_RUN_QUEUE_T *queue, MMAL_BOOL_T steal, unsigned int *task)
+{
+   MMAL_BOOL_T found = MMAL_FALSE;
+
+   vcos_mutex_lock(&queue->lock);
+   if (queue->count)
+   {
+      queue->count--;
+      if (steal)
+      {
+         *task = queue->task[(queue->first + queue->count) % GRAPH_TASKS_MAX];
+      }
+      else
+      {
+         *task = queue->task[queue->first];
+         queue->first = (queue->first + 1) % GRAPH_TASKS_MAX;
+      }
+      found = MMAL_TRUE;
+   }
+   vcos_mutex_unlock(&queue->lock);
+   return found;
+}
+
+/** Make sure a task runs, once it isn't already waiting to */
+static void graph_scheduler_wake(MMAL_GRAPH_PRIVATE_T *graph, unsigned int index)
+{
+   GRAPH_TASK_T *task = &graph->task[index];
+   uint32_t state = __atomic_load_n(&task->state, __ATOMIC_SEQ_CST);
+
+   while (1)
+   {
+      if (state == GRAPH_TASK_IDLE)
+      {
+         if (__atomic_compare_exchange_n(&task->state, &state, GRAPH_TASK_QUEUED, 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+         {
+            graph_scheduler_push(graph, task->home, index);
+            return;
+         }
+      }
+      else if (state == GRAPH_TASK_RUNNING)
+      {
+         /* The thread running it will run it again */
+         if (__atomic_compare_exchange_n(&task->state, &state, GRAPH_TASK_RERUN, 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+            return;
+      }
+      else
+         return;
+   }
+}
+
+/** Wake up the tasks a connection has work for */
+static void graph_scheduler_connection(MMAL_GRAPH_PRIVATE_T *graph, MMAL_CONNECTION_T *connection)
+{
+   unsigned int i;
+
+   for (i = 0; i < graph->connection_num; i++)
+      if (graph->connection[i] == connection)
+         break;
+   if (i == graph->connection_num)
+      return;
+
+   if (mmal_queue_length(connection->queue))
+      graph_scheduler_wake(graph, graph->connection_in_task[i]);
+   if (connection->pool && mmal_queue_length(connection->pool->queue))
+      graph_scheduler_wake(graph, graph->connection_out_task[i]);
+}
+
+/** Move the buffers of the connections of one component: events and empty
+ * buffers to its output ports and queued buffers to its input ports.
+ * Events come from the output port but are queued with the buffers for the
+ * input port, so the task of the input port hands them over to the task of
+ * the output port. A format change resizes the pool of the connection and
+ * reconfigures the output port, which must not race with that task sending
+ * it buffers. The input port gets no more buffers until the event is handled.
+ * @return whether it stopped before the queues were empty */
+static MMAL_BOOL_T graph_scheduler_run(MMAL_GRAPH_PRIVATE_T *graph, unsigned int task)
+{
+   int64_t start = vcos_getmicrosecs64();
+   MMAL_BUFFER_HEADER_T *buffer;
+   MMAL_STATUS_T status;
+   unsigned int i;
+
+   for (i = 0; i < graph->connection_num; i++)
+   {
+      MMAL_CONNECTION_T *connection = graph->connection[i];
+
+      if ((connection->flags & MMAL_CONNECTION_FLAG_TUNNELLING) ||
+          graph->connection_out_task[i] != task)
+         continue;
+
+      buffer = __atomic_load_n(&graph->connection_event[i], __ATOMIC_SEQ_CST);
+      if (buffer)
+      {
+         graph_process_buffer(graph, connection, buffer);
+         __atomic_store_n(&graph->connection_event[i], NULL, __ATOMIC_SEQ_CST);
+         graph_scheduler_wake(graph, graph->connection_in_task[i]);
+      }
+
+      if (!connection->pool)
+         continue;
+
+      buffer = mmal_queue_get_batch(connection->pool->queue, 0);
+      if (!buffer)
+         continue;
+      status = mmal_port_send_buffers(connection->out, &buffer);
+      if (status != MMAL_SUCCESS)
+      {
+         if (connection->out->is_enabled)
+            LOG_ERROR("mmal_port_send_buffers failed (%i)", status);
+         mmal_queue_put_batch(connection->pool->queue, buffer);
+      }
+   }
+
+   for (i = 0; i < graph->connection_num; i++)
+   {
+      MMAL_CONNECTION_T *connection = graph->connection[i];
+
+      if (connection->flags & (MMAL_CONNECTION_FLAG_TUNNELLING | MMAL_CONNECTION_FLAG_DIRECT) ||
+          graph->connection_in_task[i] != task ||
+          __atomic_load_n(&graph->connection_event[i], __ATOMIC_SEQ_CST))
+         continue;
+
+      /* No task can keep a thread for longer than the others */
+      while ((buffer = mmal_queue_get(connection->queue)) != NULL)
+      {
+         if (buffer->cmd && graph->connection_out_task[i] != task)
+         {
+            __atomic_store_n(&graph->connection_event[i], buffer, __ATOMIC_SEQ_CST);
+            graph_scheduler_wake(graph, graph->connection_out_task[i]);
+            break;
+         }
+         graph_process_buffer(graph, connection, buffer);
+         if (vcos_getmicrosecs64() - start >= PROCESSING_TIME_MAX)
+            return MMAL_TRUE;
+      }
+   }
+
+   return MMAL_FALSE;
+}
+
+/** Find a task for a thread, in its own run queue first, then in the others */
+static MMAL_BOOL_T graph_scheduler_find(MMAL_GRAPH_PRIVATE_T *graph, GRAPH_THREAD_T *thread, unsigned int *task)
+{
+   unsigned int i;
+
+   if (graph_scheduler_pop(&thread->queue, MMAL_FALSE, task))
+      return MMAL_TRUE;
+   for (i = 1; i < graph->threads_num; i++)
+      if (graph_scheduler_pop(&graph->threads[(thread->index + i) % graph->threads_num].queue,
+                              MMAL_TRUE, task))
+         return MMAL_TRUE;
+   return MMAL_FALSE;
+}
+
+static void *graph_scheduler_thread(void *ctx)
+{
+   GRAPH_THREAD_T *thread = (GRAPH_THREAD_T *)ctx;
+   MMAL_GRAPH_PRIVATE_T *graph = thread->graph;
+   unsigned int task;
+   uint32_t state;
+
+   while (!__atomic_load_n(&graph->stop_thread, __ATOMIC_SEQ_CST))
+   {
+      if (!graph_scheduler_find(graph, thread, &task))
+      {
+         /* Look again once counted as sleeping, so a push either sees this
+          * thread sleeping or is seen here */
+         __atomic_add_fetch(&graph->threads_sleeping, 1, __ATOMIC_SEQ_CST);
+         if (!graph_scheduler_find(graph, thread, &task))
+         {
+            if (!__atomic_load_n(&graph->stop_thread, __ATOMIC_SEQ_CST))
+               vcos_semaphore_wait(&graph->sema);
+            __atomic_sub_fetch(&graph->threads_sleeping, 1, __ATOMIC_SEQ_CST);
+            continue;
+         }
+         __atomic_sub_fetch(&graph->threads_sleeping, 1, __ATOMIC_SEQ_CST);
+      }
+
+      __atomic_store_n(&graph->task[task].state, GRAPH_TASK_RUNNING, __ATOMIC_SEQ_CST);
+      state = GRAPH_TASK_RUNNING;
+      if (graph_scheduler_run(graph, task) ||
+          !__atomic_compare_exchange_n(&graph->task[task].state, &state, GRAPH_TASK_IDLE, 0,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+      {
+         /* Out of time, or woken up again while running. Queue it behind the
+          * others of this thread, where another thread can steal it. */
+         __atomic_store_n(&graph->task[task].state, GRAPH_TASK_QUEUED, __ATOMIC_SEQ_CST);
+         graph_scheduler_push(graph, thread->index, task);
+      }
+   }
+
+   LOG_TRACE("scheduler thread %u exit %p", thread->index, graph);
+   return 0;
+}
+
+/** Task of a component, added if it has none yet */
+static unsigned int graph_scheduler_task(MMAL_GRAPH_PRIVATE_T *graph, MMAL_COMPONENT_T *component)
+{
+   unsigned int i;
+
+   for (i = 0; i < graph->task_num; i++)
+      if (graph->task[i].component == component)
+         return i;
+
+   graph->task[i].component = component;
+   graph->task[i].state = GRAPH_TASK_IDLE;
+   graph->task[i].home = i % graph->threads_num;
+   graph->task_num++;
+   return i;
+}
+
+static MMAL_STATUS_T graph_scheduler_start(MMAL_GRAPH_PRIVATE_T *graph)
+{
+   unsigned int i;
+
+   graph->task_num = 0;
+   for (i = 0; i < graph->connection_num; i++)
+   {
+      graph->connection_in_task[i] = graph_scheduler_task(graph, graph->connection[i]->in->component);
+      graph->connection_out_task[i] = graph_scheduler_task(graph, graph->connection[i]->out->component);
+      graph->connection_event[i] = NULL;
+   }
+
+   graph->stop_thread = MMAL_FALSE;
+   graph->threads_sleeping = 0;
+   for (i = 0; i < graph->threads_num; i++)
+   {
+      GRAPH_THREAD_T *thread = &graph->threads[i];
+
+      thread->graph = graph;
+      thread->index = i;
+      thread->queue.first = thread->queue.count = 0;
+   }
+
+   for (i = 0; i < graph->threads_num; i++)
+   {
+      if (vcos_thread_create(&graph->threads[i].thread, "mmal graph thread", NULL,
+                             graph_scheduler_thread, &graph->threads[i]) != VCOS_SUCCESS)
+         break;
+      __atomic_store_n(&graph->threads_running, i + 1, __ATOMIC_SEQ_CST);
+   }
+   if (i < graph->threads_num)
+   {
+      LOG_ERROR("failed to create scheduler threads %p", graph);
+      graph_scheduler_stop(graph);
+      return MMAL_ENOSPC;
+   }
+
+   return MMAL_SUCCESS;
+}
+
+static void graph_scheduler_start_tasks(MMAL_GRAPH_PRIVATE_T *graph)
+{
+   unsigned int i;
+
+   for (i = 0; i < graph->task_num; i++)
+      graph_scheduler_wake(graph, i);
+}
+
+static void graph_scheduler_stop(MMAL_GRAPH_PRIVATE_T *graph)
+{
+   unsigned int i, threads = graph->threads_running;
+
+   __atomic_store_n(&graph->stop_thread, MMAL_TRUE, __ATOMIC_SEQ_CST);
+   for (i = 0; i < threads; i++)
+      vcos_semaphore_post(&graph->sema);
+   for (i = 0; i < threads; i++)
+      vcos_thread_join(&graph->threads[i].thread, NULL);
+   graph->threads_running = 0;
+
+   /* Wake ups of the stopped threads are left in the semaphore */
+   while (vcos_semaphore_trywait(&graph->sema) == VCOS_SUCCESS)
+      continue;
+
+   /* Events the threads stopped before handling */
+   for (i = 0; i < graph->connection_num; i++)
+   {
+      if (graph->connection_event[i])
+         mmal_buffer_header_release(graph->connection_event[i]);
+      graph->connection_event[i] = NULL;
+   }
+}
+
+#else /* GRAPH_SCHEDULER */
+
+static void graph_scheduler_connection(MMAL_GRAPH_PRIVATE_T *graph, MMAL_CONNECTION_T *connection)
+{
+   MMAL_PARAM_UNUSED(connection);
+   vcos_semaphore_post(&graph->sema);
+}
+
+static MMAL_STATUS_T graph_scheduler_start(MMAL_GRAPH_PRIVATE_T *graph)
+{
+   MMAL_PARAM_UNUSED(graph);
+   return MMAL_ENOSYS;
+}
+
+static void graph_scheduler_start_tasks(MMAL_GRAPH_PRIVATE_T *graph)
+{
+   MMAL_PARAM_UNUSED(graph);
+}
+
+static void graph_scheduler_stop(MMAL_GRAPH_PRIVATE_T *graph)
+{
+   MMAL_PARAM_UNUSED(graph);
+}
+
+#endif /* GRAPH_SCHEDULER */
+
+/*****************************************************************************/
+MMAL_STATUS_T mmal_graph_set_threads(MMAL_GRAPH_T *graph, unsigned int threads)
+{
+   MMAL_GRAPH_PRIVATE_T *private = (MMAL_GRAPH_PRIVATE_T *)graph;
+
+   LOG_TRACE("graph: %p, threads: %u", graph, threads);
+
+   if (!graph || private->threads_running)
+      return MMAL_EINVAL;
+
+#if defined(_SC_NPROCESSORS_ONLN)
+   if (!threads)
+   {
+      long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+      threads = cpus > 0 ? (unsigned int)cpus : 1;
+   }
+#endif
+   if (!threads)
+      threads = 1;
+   threads = MMAL_MIN(threads, GRAPH_THREADS_MAX);
+
+#ifndef GRAPH_SCHEDULER
+   if (threads > 1)
+      return MMAL_ENOSYS;
+#endif
+
+   private->threads_num = threads;
+   return MMAL_SUCCESS;
+}
+
 /*****************************************************************************/
 static MMAL_PORT_T *find_port_from_graph(MMAL_GRAPH_PRIVATE_T *graph, MMAL_PORT_T *port)
 {
@@ -1558,3 +2010,12 @@ MMAL_PORT_T *mmal_graph_find_port(MMAL_GRAPH_T *graph,
    LOG_INFO("port %s:%d not found", name, index);
    return NULL;
 }
+
+MMAL_COMPONENT_T *mmal_graph_get_component(MMAL_GRAPH_T *graph, unsigned int index)
+{
+   MMAL_GRAPH_PRIVATE_T *private = (MMAL_GRAPH_PRIVATE_T *)graph;
+
+   if (!graph || index >= private->component_num)
+      return NULL;
+   return private->component[index];
+}
@@ -86,7 +86,8 @@ typedef struct MMAL_GRAPH_T
    /** Optional callback that the client can set to intercept component_enable/disable calls made to the graph */
    MMAL_STATUS_T (*pf_graph_enable)(struct MMAL_GRAPH_T *, MMAL_BOOL_T enable);
    /** Optional callback that the client can set to intercept buffers going through internal connections.
-    * This will only be triggered if the connection is not tunnelled */
+    * This will only be triggered if the connection is not tunnelled. With more than one
+    * thread it can be called concurrently, see mmal_graph_set_threads */
    MMAL_STATUS_T (*pf_connection_buffer)(struct MMAL_GRAPH_T *, MMAL_CONNECTION_T *connection, MMAL_BUFFER_HEADER_T *buffer);
 
 } MMAL_GRAPH_T;
@@ -191,6 +192,29 @@ typedef void (*MMAL_GRAPH_EVENT_CB)(MMAL_GRAPH_T *graph, MMAL_PORT_T *port, MMAL
  */
 MMAL_STATUS_T mmal_graph_enable(MMAL_GRAPH_T *graph, MMAL_GRAPH_EVENT_CB cb, void *cb_data);
 
+/** Set the number of threads moving buffers between the components of the graph.
+ * By default a single thread goes through all the connections of the graph.
+ * With more threads, each component of the graph gets a task which moves the
+ * buffers of its connections, and the tasks are run by a pool of threads which
+ * steal tasks from each other when idle. A task only ever runs on one thread
+ * at a time so no component is entered from two tasks at once.
+ * pf_connection_buffer is called from these tasks, for the buffers and the events
+ * of the connections alike. The calls for one connection never overlap and keep
+ * their order, but calls for different connections can run at the same time on
+ * different threads, even for connections of the same component. A
+ * pf_connection_buffer which shares state between connections has to lock it.
+ * The threads only move buffers, the components still process them on their own
+ * threads, so more threads only help graphs whose hand-offs are the bottleneck.
+ * mmal_bench_graph measures the speed-up of a graph on the target.
+ * Must be called before mmal_graph_enable.
+ *
+ * @param graph   the graph
+ * @param threads number of threads, 0 for one per CPU
+ *
+ * @return MMAL_SUCCESS on success, MMAL_ENOSYS if the platform only allows one thread
+ */
+MMAL_STATUS_T mmal_graph_set_threads(MMAL_GRAPH_T *graph, unsigned int threads);
+
 MMAL_STATUS_T mmal_graph_disable(MMAL_GRAPH_T *graph);
 
 /** Find a port in the graph.
@@ -207,6 +231,15 @@ MMAL_PORT_T *mmal_graph_find_port(MMAL_GRAPH_T *graph,
                                   MMAL_PORT_TYPE_T type,
                                   unsigned index);
 
+/** Get a component of the graph, in the order they were added.
+ *
+ * @param graph graph instance
+ * @param index index of the component
+ *
+ * @return component, or NULL past the last one
+ */
+MMAL_COMPONENT_T *mmal_graph_get_component(MMAL_GRAPH_T *graph, unsigned int index);
+
 /** Create an instance of a component from a graph.
  * The newly created component will expose input and output ports to the client.
  * Not that all the exposed ports will be in a disabled state by default.
@@ -28,6 +28,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "mmal_encodings.h"
 #include "mmal_util.h"
 #include "mmal_logging.h"
+#include "core/mmal_buffer_private.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -273,6 +274,7 @@ void mmal_buffer_header_copy_header(MMAL_BUFFER_HEADER_T *dest, const MMAL_BUFFE
    dest->pts    = src->pts;
    dest->dts    = src->dts;
    *dest->type = *src->type;
+   mmal_buffer_header_metadata_copy(dest, (MMAL_BUFFER_HEADER_T *)src);
 }
 
 /** Create a pool of MMAL_BUFFER_HEADER_T */
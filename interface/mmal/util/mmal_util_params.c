@@ -221,3 +221,51 @@ MMAL_STATUS_T mmal_util_get_core_port_stats(MMAL_PORT_T *port,
       *stats = param.stats;
    return ret;
 }
+
+MMAL_STATUS_T mmal_util_get_core_port_latency(MMAL_PORT_T *port,
+                                              MMAL_CORE_STATS_DIR dir,
+                                              MMAL_BOOL_T reset,
+                                              MMAL_CORE_LATENCY_T *stats)
+{
+   MMAL_PARAMETER_CORE_LATENCY_T param;
+   MMAL_STATUS_T ret;
+
+   memset(&param, 0, sizeof(param));
+   param.hdr.id = MMAL_PARAMETER_CORE_LATENCY;
+   param.hdr.size = sizeof(param);
+   param.dir = dir;
+   param.reset = reset;
+   ret = mmal_port_parameter_get(port, &param.hdr);
+   if (ret == MMAL_SUCCESS)
+      *stats = param.stats;
+   return ret;
+}
+
+uint32_t mmal_util_latency_percentile(const uint32_t *histogram, unsigned int percent)
+{
+   uint64_t total = 0, sum = 0, target;
+   unsigned int i, shift;
+
+   for (i = 0; i < MMAL_CORE_LATENCY_BUCKETS; i++)
+      total += histogram[i];
+   if (!total)
+      return 0;
+
+   target = (total * percent + 99) / 100;
+   if (!target)
+      target = 1;
+   for (i = 0; i < MMAL_CORE_LATENCY_BUCKETS - 1; i++)
+   {
+      sum += histogram[i];
+      if (sum >= target)
+         break;
+   }
+
+   /* Buckets below 1 << MMAL_CORE_LATENCY_SUB_BITS are 1us each */
+   shift = i >> MMAL_CORE_LATENCY_SUB_BITS;
+   if (!shift)
+      return i;
+   shift--;
+   return ((i & ((1u << MMAL_CORE_LATENCY_SUB_BITS) - 1)) + (1u << MMAL_CORE_LATENCY_SUB_BITS)) << shift |
+      ((1u << shift) >> 1);
+}
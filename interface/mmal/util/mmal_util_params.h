@@ -203,6 +203,27 @@ MMAL_STATUS_T mmal_util_camera_use_stc_timestamp(MMAL_PORT_T *port, MMAL_CAMERA_
 MMAL_STATUS_T mmal_util_get_core_port_stats(MMAL_PORT_T *port, MMAL_CORE_STATS_DIR dir, MMAL_BOOL_T reset,
                                             MMAL_CORE_STATISTICS_T *stats);
 
+/** Get the histograms and rates the host MMAL core keeps for a given port.
+ *
+ * @param port  port to query
+ * @param dir   port direction
+ * @param reset reset the stats as well
+ * @param stats filled in with results
+ * @return MMAL_SUCCESS or error
+ */
+MMAL_STATUS_T mmal_util_get_core_port_latency(MMAL_PORT_T *port, MMAL_CORE_STATS_DIR dir, MMAL_BOOL_T reset,
+                                              MMAL_CORE_LATENCY_T *stats);
+
+/** Time below which a share of the values of a MMAL_CORE_LATENCY_T histogram lie.
+ * This is the middle of the bucket the value falls in, so it is within 1/16
+ * of the real value.
+ *
+ * @param histogram  MMAL_CORE_LATENCY_BUCKETS counts
+ * @param percent    share of the values, 0 to 100. 100 gives the largest value.
+ * @return time in us, 0 if the histogram is empty
+ */
+uint32_t mmal_util_latency_percentile(const uint32_t *histogram, unsigned int percent);
+
 #ifdef __cplusplus
 }
 #endif
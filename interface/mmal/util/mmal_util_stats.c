@@ -0,0 +1,156 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include "interface/mmal/mmal.h"
+#include "interface/mmal/util/mmal_util_params.h"
+#include "interface/mmal/util/mmal_util_stats.h"
+
+/** Longest port name printed */
+#define PORT_NAME_WIDTH 36
+
+/** Print the row of a port whose host counters are empty, from MMAL_PARAMETER_CORE_STATISTICS.
+ * Components on VideoCore answer it for their tunnelled ports too, but only with the buffer
+ * count and the longest interval. */
+static void dump_port_core(FILE *out, MMAL_PORT_T *port, unsigned int dir, MMAL_BOOL_T reset)
+{
+   static const char *dir_name[] = { "in", "out" };
+   MMAL_CORE_STATISTICS_T stats;
+   uint32_t span;
+   double fps = 0.0;
+
+   if (mmal_util_get_core_port_stats(port, (MMAL_CORE_STATS_DIR)dir, reset, &stats) != MMAL_SUCCESS ||
+       !stats.buffer_count)
+      return;
+
+   span = stats.last_buffer_time - stats.first_buffer_time;
+   if (span)
+      fps = (stats.buffer_count - 1) * 1000000.0 / span;
+
+   fprintf(out, "%-*.*s %-3s %8u %7.1f %9s %8s %8s %8.2f %8s %8s %5s\n",
+           PORT_NAME_WIDTH, PORT_NAME_WIDTH, port->name, dir_name[dir], stats.buffer_count, fps, "-",
+           "-", "-", stats.max_delay / 1000.0, "-", "-", "");
+}
+
+static void dump_port(FILE *out, MMAL_PORT_T *port, MMAL_BOOL_T reset)
+{
+   static const char *dir_name[] = { "in", "out" };
+   MMAL_CORE_LATENCY_T stats;
+   unsigned int dir;
+
+   for (dir = MMAL_CORE_STATS_RX; dir <= MMAL_CORE_STATS_TX; dir++)
+   {
+      uint32_t span;
+      double fps = 0.0, kbps = 0.0;
+
+      if (mmal_util_get_core_port_latency(port, (MMAL_CORE_STATS_DIR)dir, reset, &stats) != MMAL_SUCCESS)
+         continue;
+      if (!stats.buffer_count)
+      {
+         /* Tunnelled ports of VideoCore components never see the host */
+         if (port->type == MMAL_PORT_TYPE_INPUT || port->type == MMAL_PORT_TYPE_OUTPUT)
+            dump_port_core(out, port, dir, reset);
+         continue;
+      }
+
+      span = stats.last_buffer_time - stats.first_buffer_time;
+      if (span)
+      {
+         fps = (stats.buffer_count - 1) * 1000000.0 / span;
+         kbps = stats.bytes * 1000000.0 / 1024.0 / span;
+      }
+
+      fprintf(out, "%-*.*s %-3s %8u %7.1f %9.1f %8.2f %8.2f %8.2f",
+              PORT_NAME_WIDTH, PORT_NAME_WIDTH, port->name, dir_name[dir], stats.buffer_count, fps, kbps,
+              mmal_util_latency_percentile(stats.interval, 50) / 1000.0,
+              mmal_util_latency_percentile(stats.interval, 99) / 1000.0,
+              mmal_util_latency_percentile(stats.interval, 100) / 1000.0);
+      if (dir == MMAL_CORE_STATS_TX)
+         fprintf(out, " %8.2f %8.2f\n",
+                 mmal_util_latency_percentile(stats.latency, 50) / 1000.0,
+                 mmal_util_latency_percentile(stats.latency, 99) / 1000.0);
+      else
+         fprintf(out, " %8s %8s %5u\n", "", "", stats.in_transit_max);
+   }
+}
+
+void mmal_util_dump_port_latency(FILE *out, MMAL_COMPONENT_T **components, unsigned int count,
+                                 MMAL_BOOL_T reset)
+{
+   unsigned int i, j;
+
+   fprintf(out, "%-*s %-3s %8s %7s %9s %26s %17s %5s\n", PORT_NAME_WIDTH, "", "", "",
+           "", "", "interval (ms)", "latency (ms)", "");
+   fprintf(out, "%-*s %-3s %8s %7s %9s %8s %8s %8s %8s %8s %5s\n", PORT_NAME_WIDTH, "port", "dir",
+           "buffers", "fps", "kB/s", "p50", "p99", "max", "p50", "p99", "depth");
+
+   for (i = 0; i < count; i++)
+   {
+      MMAL_COMPONENT_T *component = components[i];
+
+      if (!component)
+         continue;
+      dump_port(out, component->control, reset);
+      for (j = 0; j < component->input_num; j++)
+         dump_port(out, component->input[j], reset);
+      for (j = 0; j < component->output_num; j++)
+         dump_port(out, component->output[j], reset);
+      for (j = 0; j < component->clock_num; j++)
+         dump_port(out, component->clock[j], reset);
+   }
+}
+
+static void enable_port(MMAL_PORT_T *port, MMAL_BOOL_T enable, MMAL_STATUS_T *status)
+{
+   MMAL_STATUS_T port_status = mmal_port_parameter_set_boolean(port, MMAL_PARAMETER_CORE_LATENCY_TX, enable);
+
+   if (port_status != MMAL_SUCCESS && *status == MMAL_SUCCESS)
+      *status = port_status;
+}
+
+MMAL_STATUS_T mmal_util_enable_port_latency(MMAL_COMPONENT_T **components, unsigned int count,
+                                            MMAL_BOOL_T enable)
+{
+   MMAL_STATUS_T status = MMAL_SUCCESS;
+   unsigned int i, j;
+
+   for (i = 0; i < count; i++)
+   {
+      MMAL_COMPONENT_T *component = components[i];
+
+      if (!component)
+         continue;
+      enable_port(component->control, enable, &status);
+      for (j = 0; j < component->input_num; j++)
+         enable_port(component->input[j], enable, &status);
+      for (j = 0; j < component->output_num; j++)
+         enable_port(component->output[j], enable, &status);
+      for (j = 0; j < component->clock_num; j++)
+         enable_port(component->clock[j], enable, &status);
+   }
+   return status;
+}
@@ -0,0 +1,79 @@
+/*
+Copyright (c) 2026, Tom Bannink
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MMAL_UTIL_STATS_H
+#define MMAL_UTIL_STATS_H
+
+#include <stdio.h>
+#include "interface/mmal/mmal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * Utility functions to print the statistics the MMAL core keeps per port.
+ */
+
+/** Print a table of the port statistics of a set of components.
+ * There is one row for each direction of each port which has seen buffers,
+ * with the rate of buffers and bytes, the time between buffers and, for buffers
+ * coming back from the component, the time the component kept them.
+ * Comparing the rows of the components of a pipeline shows which of them
+ * adds the latency.
+ * Input and output ports the host core has seen no buffers on, such as the
+ * tunnelled ports of components running on VideoCore, get their row from
+ * MMAL_PARAMETER_CORE_STATISTICS instead. It only has the buffer count, the rate
+ * and the longest interval, the other columns show "-".
+ *
+ * @param out        where to print the table
+ * @param components components to print the ports of
+ * @param count      number of components
+ * @param reset      reset the statistics, so the next table covers the time since this one
+ */
+void mmal_util_dump_port_latency(FILE *out, MMAL_COMPONENT_T **components, unsigned int count,
+                                 MMAL_BOOL_T reset);
+
+/** Turn the collection of the MMAL_CORE_STATS_TX statistics on or off for all the
+ * ports of a set of components, see MMAL_PARAMETER_CORE_LATENCY_TX.
+ * Without it the table of mmal_util_dump_port_latency only has the rows of buffers
+ * going in, unless the core was built with MMAL_COLLECT_PORT_STATS.
+ *
+ * @param components components to change the ports of
+ * @param count      number of components
+ * @param enable     collect the statistics or not
+ * @return MMAL_SUCCESS, or the error of the first port which failed
+ */
+MMAL_STATUS_T mmal_util_enable_port_latency(MMAL_COMPONENT_T **components, unsigned int count,
+                                            MMAL_BOOL_T enable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
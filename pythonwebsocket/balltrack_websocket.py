@@ -3,6 +3,7 @@
 from websocket_server import WebsocketServer
 
 import os
+import socket
 import threading
 import time
 
@@ -47,10 +48,29 @@ def stopTracking():
         camprocess.terminate()
     camprocess = None
 
+REPLAY_SOCKET = "/tmp/raspiballs/replay.sock"
+# raspiballs only writes into the directory of its own -replay-file
+REPLAY_FILE = "/dev/shm/replay/replay.h264"
+REPLAY_MS = 1400
+
+def generateReplay():
+    """Ask raspiballs to write the last REPLAY_MS of video to REPLAY_FILE"""
+    try:
+        s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        s.connect(REPLAY_SOCKET)
+        s.sendall(("REPLAY %d %s\n" % (REPLAY_MS, os.path.basename(REPLAY_FILE))).encode("utf-8"))
+        reply = s.recv(64).decode("utf-8").strip()
+        s.close()
+    except OSError as e:
+        print("Replay request failed: %s" % e)
+        return False
+    print("Replay: %s" % reply)
+    return reply.startswith("OK")
+
 def doReplay():
     global replayprocess
     print("Replay request!")
-    call_and_log(["./generate-replay.sh"])
+    generateReplay()
     # replayprocess.terminate()
     replayprocess = subprocess.Popen(["./replay.sh"])
 